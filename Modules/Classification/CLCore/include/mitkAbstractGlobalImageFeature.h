@@ -22,6 +22,7 @@ found in the LICENSE file.
 #include <mitkCommandLineParser.h>
 
 #include <mitkIntensityQuantifier.h>
+#include <mitkTextureMatrixEngine.h>
 
 // STD Includes
 
@@ -219,6 +220,16 @@ public:
   itkSetMacro(EncodeParameters, bool);
   itkGetConstMacro(EncodeParameters, bool);
 
+  /**
+  * \brief Sets the engine that provides the quantized image and the texture matrices.
+  *
+  * Set the same engine to several feature classes in order to share the cropped and quantized image
+  * and the texture matrices of an image / mask pair between them. If no engine is set, the
+  * feature class creates its own engine on first use.
+  */
+  void SetTextureMatrixEngine(TextureMatrixEngine *engine);
+  TextureMatrixEngine *GetTextureMatrixEngine();
+
   std::string GetOptionPrefix() const
   {
     if (m_Prefix.length() > 0)
@@ -283,6 +294,7 @@ private:
   bool m_CalculateWithParameter = false;
 
   mitk::Image::Pointer m_MorphMask = nullptr;
+  TextureMatrixEngine::Pointer m_TextureMatrixEngine;
 //#endif // Skip Doxygen
 
 };
@@ -0,0 +1,192 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+
+#ifndef mitkTextureMatrixEngine_h
+#define mitkTextureMatrixEngine_h
+
+#include <MitkCLCoreExports.h>
+
+#include <mitkCommon.h>
+#include <mitkImage.h>
+#include <mitkIntensityQuantifier.h>
+
+#include <itkObject.h>
+#include <itkOffset.h>
+#include <itkSize.h>
+#include <itkIndex.h>
+
+#include <Eigen/Dense>
+
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace mitk
+{
+/**
+* \brief Shared preprocessing and texture matrix accumulation for the global image features.
+*
+* Most texture feature classes (co-occurrence, size zone, neighbourhood grey tone difference and neighbouring
+* grey level dependence) need the same preprocessed representation of an image / mask pair: the image restricted
+* to the bounding box of the mask, quantized to the bins of an IntensityQuantifier. This class creates this
+* representation once (see GetQuantizedImage()) and caches it as long as image, mask and quantifier do not change.
+*
+* Based on the quantized image the texture matrices are accumulated in fused, multi-threaded traversals:
+* - GetCooccurrenceMatrices() fills the co-occurrence matrices of all requested offsets in one traversal.
+* - GetNeighbourhoodMatrices() fills the NGTDM vectors and the NGLDM matrix of a neighbourhood in one traversal.
+* - GetSizeZoneMatrix() labels all zones in one traversal.
+* - GetRunLengthMatrices() follows the runs of all requested offsets in one traversal.
+* The results are cached as well, so feature classes sharing one engine (see
+* AbstractGlobalImageFeature::SetTextureMatrixEngine()) do not repeat a traversal with identical parameters.
+*
+* Images are handled as 3D images; 2D images have a size of 1 in z direction.
+* The engine is not thread-safe, it uses several threads internally. Use one engine per thread.
+*/
+class MITKCLCORE_EXPORT TextureMatrixEngine : public itk::Object
+{
+public:
+  mitkClassMacroItkParent(TextureMatrixEngine, itk::Object);
+  itkFactorylessNewMacro(Self);
+
+  typedef itk::Offset<3> OffsetType;
+  typedef std::vector<OffsetType> OffsetVectorType;
+  typedef itk::Size<3> RadiusType;
+
+  /** Bin index of voxels that are not part of the mask.*/
+  static const int OutsideMask = -1;
+  /** Bin index of masked voxels with a NaN intensity.*/
+  static const int NotANumber = -2;
+
+  /**
+  * \brief Image cropped to the bounding box of the mask with the bin index of every voxel.
+  */
+  struct MITKCLCORE_EXPORT QuantizedImage
+  {
+    unsigned int Dimension = 3;
+    unsigned int NumberOfBins = 0;
+    /** Size of the original image*/
+    itk::Size<3> ImageSize;
+    /** First voxel of the cropped region within the original image*/
+    itk::Index<3> CropIndex;
+    /** Size of the cropped region*/
+    itk::Size<3> Size;
+    /** Bin indices of the cropped region (x runs fastest), OutsideMask or NotANumber.*/
+    std::vector<int> BinIndices;
+    std::size_t NumberOfMaskedVoxels = 0;
+    /** Marks the masked voxels with the mask value 1 and an intensity within the range of the quantifier
+    * (same layout as BinIndices). Only these voxels are part of runs.*/
+    std::vector<bool> IsRunLengthVoxel;
+
+    bool IsInsideImage(long x, long y, long z) const;
+    /** Returns the bin index of a voxel given in cropped coordinates. Voxels outside of the cropped region
+    * but inside of the image are returned as OutsideMask; the position must be inside of the image.*/
+    int GetBinIndex(long x, long y, long z) const;
+    /** Like GetBinIndex(), but returns OutsideMask for voxels that are not part of runs.*/
+    int GetRunLengthBinIndex(long x, long y, long z) const;
+  };
+  typedef std::shared_ptr<const QuantizedImage> QuantizedImageConstPointer;
+
+  /**
+  * \brief Accumulated neighbourhood statistics of one neighbourhood radius.
+  */
+  struct MITKCLCORE_EXPORT NeighbourhoodMatrices
+  {
+    /** NGTDM: number of voxels n_i per bin. Neighbours outside of the image are replaced by the closest
+    * voxel of the image (zero flux boundary).*/
+    std::vector<double> VoxelCounts;
+    /** NGTDM: sum of the absolute differences s_i between the bin and the mean bin of the neighbourhood.*/
+    std::vector<double> DifferenceSums;
+    unsigned long NumberOfVoxels = 0;
+
+    /** NGLDM: number of neighbourhoods per bin (rows) and number of dependent neighbours (columns).*/
+    Eigen::MatrixXd DependenceMatrix;
+    unsigned int NeighbourhoodSize = 0;
+    unsigned long NumberOfNeighbourVoxels = 0;
+    unsigned long NumberOfDependenceNeighbourVoxels = 0;
+    unsigned long NumberOfNeighbourhoods = 0;
+    unsigned long NumberOfCompleteNeighbourhoods = 0;
+  };
+
+  /**
+  * \brief Returns the quantized representation of the image / mask pair.
+  *
+  * All voxels with a mask value greater than zero are treated as masked. The representation is cached
+  * until image, mask or the parameters of the quantifier change.
+  */
+  QuantizedImageConstPointer GetQuantizedImage(const Image* image, const Image* mask, const IntensityQuantifier* quantifier);
+
+  /**
+  * \brief Returns one symmetric co-occurrence matrix (bins x bins) per offset.
+  *
+  * A pair of voxels is counted if both voxels are masked and have a valid intensity.
+  */
+  std::vector<Eigen::MatrixXd> GetCooccurrenceMatrices(const QuantizedImageConstPointer& image, const OffsetVectorType& offsets);
+
+  /**
+  * \brief Returns the NGTDM and NGLDM statistics for the given neighbourhood radius.
+  *
+  * A neighbour is dependent (NGLDM) if its bin differs by at most alpha from the bin of the center voxel.
+  */
+  std::shared_ptr<const NeighbourhoodMatrices> GetNeighbourhoodMatrices(const QuantizedImageConstPointer& image, const RadiusType& radius, int alpha);
+
+  /**
+  * \brief Returns the grey level size zone matrix (bins x size of the largest zone).
+  *
+  * Zones are connected via the given offsets (and their negation).
+  */
+  Eigen::MatrixXd GetSizeZoneMatrix(const QuantizedImageConstPointer& image, const OffsetVectorType& offsets);
+
+  /**
+  * \brief Returns one grey level run length matrix (bins x length of the longest run) per offset.
+  *
+  * A run is a maximal line of voxels with the same bin along the offset; it is counted once, independent of
+  * the sign of the offset. Like the ITK filter that was used before, runs only consist of voxels with the mask
+  * value 1 and an intensity within the range of the quantifier (see QuantizedImage::IsRunLengthVoxel), voxels
+  * outside of the range are skipped instead of clamped. All matrices have the same number of columns.
+  */
+  std::vector<Eigen::MatrixXd> GetRunLengthMatrices(const QuantizedImageConstPointer& image, const OffsetVectorType& offsets);
+
+  /** Releases all cached images and matrices.*/
+  void ClearCache();
+
+  /** Number of threads used for the traversals. 0 (default) uses the global default of ITK.*/
+  itkSetMacro(NumberOfThreads, unsigned int);
+  itkGetConstMacro(NumberOfThreads, unsigned int);
+
+  /** Number of quantized images that have been created since construction, mainly for diagnostics.*/
+  itkGetConstMacro(NumberOfQuantizations, unsigned int);
+  /** Number of traversals of quantized images that have been performed since construction.*/
+  itkGetConstMacro(NumberOfTraversals, unsigned int);
+
+  /** Maximum number of image / mask pairs that are kept in the cache. Default is 4.*/
+  itkSetMacro(MaximumCacheSize, unsigned int);
+  itkGetConstMacro(MaximumCacheSize, unsigned int);
+
+protected:
+  TextureMatrixEngine();
+  ~TextureMatrixEngine() override;
+
+private:
+  struct CacheEntry;
+  CacheEntry* FindEntry(const QuantizedImageConstPointer& image);
+  unsigned int GetEffectiveNumberOfThreads() const;
+
+  std::vector<std::unique_ptr<CacheEntry>> m_Cache;
+  unsigned int m_NumberOfThreads;
+  unsigned int m_NumberOfQuantizations;
+  unsigned int m_NumberOfTraversals;
+  unsigned int m_MaximumCacheSize;
+};
+}
+
+#endif //mitkTextureMatrixEngine_h
@@ -269,6 +269,24 @@ void  mitk::AbstractGlobalImageFeature::InitializeQuantifier(const Image::Pointe
     m_Quantifier->InitializeByImageRegion(feature, mask, defaultBins);
 }
 
+void mitk::AbstractGlobalImageFeature::SetTextureMatrixEngine(TextureMatrixEngine *engine)
+{
+  if (m_TextureMatrixEngine != engine)
+  {
+    m_TextureMatrixEngine = engine;
+    this->Modified();
+  }
+}
+
+mitk::TextureMatrixEngine *mitk::AbstractGlobalImageFeature::GetTextureMatrixEngine()
+{
+  if (m_TextureMatrixEngine.IsNull())
+  {
+    m_TextureMatrixEngine = TextureMatrixEngine::New();
+  }
+  return m_TextureMatrixEngine;
+}
+
 std::string mitk::AbstractGlobalImageFeature::GetCurrentFeatureEncoding()
 {
   return "";
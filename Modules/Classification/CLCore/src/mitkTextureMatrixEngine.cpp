@@ -0,0 +1,788 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <mitkTextureMatrixEngine.h>
+
+// MITK
+#include <mitkExceptionMacro.h>
+#include <mitkImageAccessByItk.h>
+#include <mitkImageCast.h>
+
+// ITK
+#include <itkImageRegionConstIterator.h>
+#include <itkImageRegionConstIteratorWithIndex.h>
+#include <itkMultiThreader.h>
+
+// STL
+#include <algorithm>
+#include <cmath>
+
+struct mitk::TextureMatrixEngine::CacheEntry
+{
+  Image::ConstPointer InputImage;
+  itk::ModifiedTimeType ImageMTime = 0;
+  Image::ConstPointer InputMask;
+  itk::ModifiedTimeType MaskMTime = 0;
+  double Minimum = 0;
+  double Maximum = 0;
+  double Binsize = 0;
+  unsigned int Bins = 0;
+
+  QuantizedImageConstPointer Quantized;
+  std::map<std::vector<long>, std::vector<Eigen::MatrixXd> > CooccurrenceCache;
+  std::map<std::vector<long>, std::shared_ptr<const NeighbourhoodMatrices> > NeighbourhoodCache;
+  std::map<std::vector<long>, Eigen::MatrixXd> SizeZoneCache;
+  std::map<std::vector<long>, std::vector<Eigen::MatrixXd> > RunLengthCache;
+};
+
+namespace
+{
+  typedef mitk::TextureMatrixEngine::QuantizedImage QuantizedImage;
+
+  template <typename TFunction>
+  struct ParallelForRowsData
+  {
+    TFunction *Function;
+    std::size_t NumberOfRows;
+  };
+
+  template <typename TFunction>
+  ITK_THREAD_RETURN_TYPE ParallelForRowsCallback(void *arg)
+  {
+    typedef itk::MultiThreader::ThreadInfoStruct ThreadInfoType;
+    ThreadInfoType *infoStruct = static_cast<ThreadInfoType *>(arg);
+    ParallelForRowsData<TFunction> *data = static_cast<ParallelForRowsData<TFunction> *>(infoStruct->UserData);
+
+    const unsigned int threadID = infoStruct->ThreadID;
+    const std::size_t firstRow = data->NumberOfRows * threadID / infoStruct->NumberOfThreads;
+    const std::size_t endRow = data->NumberOfRows * (threadID + 1) / infoStruct->NumberOfThreads;
+    (*data->Function)(threadID, firstRow, endRow);
+    return ITK_THREAD_RETURN_VALUE;
+  }
+
+  /** Calls function(threadID, firstRow, endRow) for contiguous blocks of rows on an itk::MultiThreader. The blocks
+  * only depend on the number of threads, so the accumulated results are reproducible.*/
+  template <typename TFunction>
+  void ParallelForRows(unsigned int numberOfThreads, std::size_t numberOfRows, TFunction function)
+  {
+    numberOfThreads = static_cast<unsigned int>(std::max<std::size_t>(1, std::min<std::size_t>(numberOfThreads, numberOfRows)));
+    if (numberOfThreads == 1)
+    {
+      function(0u, std::size_t(0), numberOfRows);
+      return;
+    }
+
+    ParallelForRowsData<TFunction> data;
+    data.Function = &function;
+    data.NumberOfRows = numberOfRows;
+
+    itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+    threader->SetNumberOfThreads(numberOfThreads);
+    threader->SetSingleMethod(ParallelForRowsCallback<TFunction>, &data);
+    threader->SingleMethodExecute();
+  }
+
+  std::vector<long> OffsetsToKey(const mitk::TextureMatrixEngine::OffsetVectorType &offsets)
+  {
+    std::vector<long> key;
+    for (const auto &offset : offsets)
+    {
+      key.insert(key.end(), { offset[0], offset[1], offset[2] });
+    }
+    return key;
+  }
+
+  template<typename TPixel, unsigned int VImageDimension>
+  void QuantizeImage(const itk::Image<TPixel, VImageDimension> *itkImage,
+                     const mitk::Image *mask,
+                     double minimum,
+                     double maximum,
+                     double binsize,
+                     unsigned int bins,
+                     QuantizedImage &result)
+  {
+    typedef itk::Image<TPixel, VImageDimension> ImageType;
+    typedef itk::Image<unsigned short, VImageDimension> MaskType;
+
+    typename MaskType::Pointer itkMask = MaskType::New();
+    mitk::CastToItkImage(mask, itkMask);
+
+    auto imageRegion = itkImage->GetLargestPossibleRegion();
+    auto maskRegion = itkMask->GetLargestPossibleRegion();
+    if (imageRegion.GetSize() != maskRegion.GetSize())
+    {
+      mitkThrow() << "Cannot quantize image. Image and mask have different sizes.";
+    }
+
+    result.Dimension = VImageDimension;
+    result.NumberOfBins = bins;
+    result.ImageSize.Fill(1);
+    result.CropIndex.Fill(0);
+    result.Size.Fill(0);
+    result.BinIndices.clear();
+    result.NumberOfMaskedVoxels = 0;
+    result.IsRunLengthVoxel.clear();
+    for (unsigned int i = 0; i < VImageDimension; ++i)
+    {
+      result.ImageSize[i] = imageRegion.GetSize()[i];
+    }
+
+    // Bounding box of the mask, relative to the start of the region
+    itk::Index<VImageDimension> lower;
+    itk::Index<VImageDimension> upper;
+    for (unsigned int i = 0; i < VImageDimension; ++i)
+    {
+      lower[i] = imageRegion.GetSize()[i];
+      upper[i] = -1;
+    }
+    itk::ImageRegionConstIteratorWithIndex<MaskType> boxIter(itkMask, maskRegion);
+    while (!boxIter.IsAtEnd())
+    {
+      if (boxIter.Value() > 0)
+      {
+        auto index = boxIter.GetIndex();
+        for (unsigned int i = 0; i < VImageDimension; ++i)
+        {
+          const auto position = index[i] - maskRegion.GetIndex()[i];
+          lower[i] = std::min(lower[i], position);
+          upper[i] = std::max(upper[i], position);
+        }
+        ++result.NumberOfMaskedVoxels;
+      }
+      ++boxIter;
+    }
+
+    if (result.NumberOfMaskedVoxels == 0)
+    {
+      return;
+    }
+
+    typename ImageType::RegionType imageCropRegion;
+    typename MaskType::RegionType maskCropRegion;
+    std::size_t numberOfVoxels = 1;
+    for (unsigned int i = 0; i < VImageDimension; ++i)
+    {
+      result.CropIndex[i] = lower[i];
+      result.Size[i] = upper[i] - lower[i] + 1;
+      numberOfVoxels *= result.Size[i];
+      imageCropRegion.SetIndex(i, imageRegion.GetIndex()[i] + lower[i]);
+      imageCropRegion.SetSize(i, result.Size[i]);
+      maskCropRegion.SetIndex(i, maskRegion.GetIndex()[i] + lower[i]);
+      maskCropRegion.SetSize(i, result.Size[i]);
+    }
+    for (unsigned int i = VImageDimension; i < 3; ++i)
+    {
+      result.Size[i] = 1;
+    }
+
+    result.BinIndices.resize(numberOfVoxels, mitk::TextureMatrixEngine::OutsideMask);
+    result.IsRunLengthVoxel.resize(numberOfVoxels, false);
+    // The run length range is compared in the pixel type, like in itk::EnhancedScalarImageToRunLengthMatrixFilter
+    const TPixel runLengthMinimum = static_cast<TPixel>(minimum);
+    const TPixel runLengthMaximum = static_cast<TPixel>(maximum);
+    itk::ImageRegionConstIterator<ImageType> imageIter(itkImage, imageCropRegion);
+    itk::ImageRegionConstIterator<MaskType> maskIter(itkMask, maskCropRegion);
+    for (std::size_t i = 0; i < numberOfVoxels; ++i, ++imageIter, ++maskIter)
+    {
+      if (maskIter.Value() < 1)
+      {
+        continue;
+      }
+      const double value = imageIter.Value();
+      if (value != value)
+      {
+        result.BinIndices[i] = mitk::TextureMatrixEngine::NotANumber;
+        continue;
+      }
+      // Same binning as mitk::IntensityQuantifier::IntensityToIndex
+      const double index = std::floor((value - minimum) / binsize);
+      result.BinIndices[i] = static_cast<int>(std::max<double>(0, std::min<double>(index, bins - 1)));
+      result.IsRunLengthVoxel[i] = maskIter.Value() == 1 &&
+        imageIter.Value() >= runLengthMinimum && imageIter.Value() <= runLengthMaximum;
+    }
+  }
+
+  std::vector<Eigen::MatrixXd> CalculateCooccurrenceMatrices(const QuantizedImage &image,
+                                                             const mitk::TextureMatrixEngine::OffsetVectorType &offsets,
+                                                             unsigned int numberOfThreads)
+  {
+    const auto bins = image.NumberOfBins;
+    const auto rowCount = image.Size[1] * image.Size[2];
+    numberOfThreads = static_cast<unsigned int>(std::max<std::size_t>(1, std::min<std::size_t>(numberOfThreads, rowCount)));
+
+    std::vector<std::vector<Eigen::MatrixXd> > threadMatrices(numberOfThreads,
+      std::vector<Eigen::MatrixXd>(offsets.size(), Eigen::MatrixXd::Zero(bins, bins)));
+
+    ParallelForRows(numberOfThreads, rowCount, [&](unsigned int threadID, std::size_t firstRow, std::size_t endRow)
+    {
+      auto &matrices = threadMatrices[threadID];
+      for (std::size_t row = firstRow; row < endRow; ++row)
+      {
+        const long y = row % image.Size[1];
+        const long z = row / image.Size[1];
+        const int *binIndices = image.BinIndices.data() + row * image.Size[0];
+        for (long x = 0; x < static_cast<long>(image.Size[0]); ++x)
+        {
+          const int i = binIndices[x];
+          if (i < 0)
+          {
+            continue;
+          }
+          for (std::size_t k = 0; k < offsets.size(); ++k)
+          {
+            const long nx = x + offsets[k][0];
+            const long ny = y + offsets[k][1];
+            const long nz = z + offsets[k][2];
+            if (!image.IsInsideImage(nx, ny, nz))
+            {
+              continue;
+            }
+            const int j = image.GetBinIndex(nx, ny, nz);
+            if (j < 0)
+            {
+              continue;
+            }
+            matrices[k](i, j) += 1;
+            matrices[k](j, i) += 1;
+          }
+        }
+      }
+    });
+
+    std::vector<Eigen::MatrixXd> result = threadMatrices[0];
+    for (unsigned int threadID = 1; threadID < numberOfThreads; ++threadID)
+    {
+      for (std::size_t k = 0; k < offsets.size(); ++k)
+      {
+        result[k] += threadMatrices[threadID][k];
+      }
+    }
+    return result;
+  }
+
+  mitk::TextureMatrixEngine::NeighbourhoodMatrices CalculateNeighbourhoodMatrices(const QuantizedImage &image,
+                                                                                  const mitk::TextureMatrixEngine::RadiusType &radius,
+                                                                                  int alpha,
+                                                                                  unsigned int numberOfThreads)
+  {
+    typedef mitk::TextureMatrixEngine::NeighbourhoodMatrices NeighbourhoodMatrices;
+
+    std::vector<mitk::TextureMatrixEngine::OffsetType> neighbours;
+    for (long dz = -static_cast<long>(radius[2]); dz <= static_cast<long>(radius[2]); ++dz)
+      for (long dy = -static_cast<long>(radius[1]); dy <= static_cast<long>(radius[1]); ++dy)
+        for (long dx = -static_cast<long>(radius[0]); dx <= static_cast<long>(radius[0]); ++dx)
+        {
+          if (dx != 0 || dy != 0 || dz != 0)
+          {
+            mitk::TextureMatrixEngine::OffsetType offset = { { dx, dy, dz } };
+            neighbours.push_back(offset);
+          }
+        }
+
+    const auto bins = image.NumberOfBins;
+    const auto rowCount = image.Size[1] * image.Size[2];
+    numberOfThreads = static_cast<unsigned int>(std::max<std::size_t>(1, std::min<std::size_t>(numberOfThreads, rowCount)));
+
+    NeighbourhoodMatrices initial;
+    initial.VoxelCounts.resize(bins, 0);
+    initial.DifferenceSums.resize(bins, 0);
+    initial.NeighbourhoodSize = static_cast<unsigned int>(neighbours.size());
+    initial.DependenceMatrix = Eigen::MatrixXd::Zero(bins, neighbours.size() + 1);
+    std::vector<NeighbourhoodMatrices> threadResults(numberOfThreads, initial);
+
+    const long maxX = image.ImageSize[0] - 1;
+    const long maxY = image.ImageSize[1] - 1;
+    const long maxZ = image.ImageSize[2] - 1;
+
+    ParallelForRows(numberOfThreads, rowCount, [&](unsigned int threadID, std::size_t firstRow, std::size_t endRow)
+    {
+      auto &result = threadResults[threadID];
+      for (std::size_t row = firstRow; row < endRow; ++row)
+      {
+        const long y = row % image.Size[1];
+        const long z = row / image.Size[1];
+        const int *binIndices = image.BinIndices.data() + row * image.Size[0];
+        for (long x = 0; x < static_cast<long>(image.Size[0]); ++x)
+        {
+          const int centerBin = binIndices[x];
+          if (centerBin == mitk::TextureMatrixEngine::OutsideMask)
+          {
+            continue;
+          }
+
+          // NGTDM: NaN intensities are mapped to the first bin, as done by the IntensityQuantifier
+          const int i = std::max(centerBin, 0);
+          const bool validCenter = centerBin >= 0;
+          int localCount = 0;
+          double localMean = 0;
+          int sameValues = 0;
+          bool completeNeighbourhood = true;
+
+          for (const auto &neighbour : neighbours)
+          {
+            const long nx = x + neighbour[0];
+            const long ny = y + neighbour[1];
+            const long nz = z + neighbour[2];
+
+            if (image.IsInsideImage(nx, ny, nz))
+            {
+              const int j = image.GetBinIndex(nx, ny, nz);
+              if (j != mitk::TextureMatrixEngine::OutsideMask)
+              {
+                ++localCount;
+                localMean += std::max(j, 0) + 1;
+              }
+              if (j < 0)
+              {
+                completeNeighbourhood = false;
+              }
+              else if (validCenter)
+              {
+                result.NumberOfNeighbourVoxels += 1;
+                if (std::abs(i - j) <= alpha)
+                {
+                  result.NumberOfDependenceNeighbourVoxels += 1;
+                  ++sameValues;
+                }
+              }
+            }
+            else
+            {
+              completeNeighbourhood = false;
+              // Zero flux boundary: use the closest voxel of the image
+              const long cx = std::min(std::max(nx + static_cast<long>(image.CropIndex[0]), 0l), maxX) - image.CropIndex[0];
+              const long cy = std::min(std::max(ny + static_cast<long>(image.CropIndex[1]), 0l), maxY) - image.CropIndex[1];
+              const long cz = std::min(std::max(nz + static_cast<long>(image.CropIndex[2]), 0l), maxZ) - image.CropIndex[2];
+              const int j = image.GetBinIndex(cx, cy, cz);
+              if (j != mitk::TextureMatrixEngine::OutsideMask)
+              {
+                ++localCount;
+                localMean += std::max(j, 0) + 1;
+              }
+            }
+          }
+
+          if (localCount > 0)
+          {
+            localMean /= localCount;
+          }
+          result.VoxelCounts[i] += 1;
+          result.DifferenceSums[i] += std::abs<double>(i + 1 - localMean);
+          result.NumberOfVoxels += 1;
+
+          if (validCenter)
+          {
+            result.DependenceMatrix(i, sameValues) += 1;
+            result.NumberOfNeighbourhoods += 1;
+            if (completeNeighbourhood)
+            {
+              result.NumberOfCompleteNeighbourhoods += 1;
+            }
+          }
+        }
+      }
+    });
+
+    NeighbourhoodMatrices result = threadResults[0];
+    for (unsigned int threadID = 1; threadID < numberOfThreads; ++threadID)
+    {
+      const auto &partial = threadResults[threadID];
+      for (unsigned int bin = 0; bin < bins; ++bin)
+      {
+        result.VoxelCounts[bin] += partial.VoxelCounts[bin];
+        result.DifferenceSums[bin] += partial.DifferenceSums[bin];
+      }
+      result.NumberOfVoxels += partial.NumberOfVoxels;
+      result.DependenceMatrix += partial.DependenceMatrix;
+      result.NumberOfNeighbourVoxels += partial.NumberOfNeighbourVoxels;
+      result.NumberOfDependenceNeighbourVoxels += partial.NumberOfDependenceNeighbourVoxels;
+      result.NumberOfNeighbourhoods += partial.NumberOfNeighbourhoods;
+      result.NumberOfCompleteNeighbourhoods += partial.NumberOfCompleteNeighbourhoods;
+    }
+    return result;
+  }
+
+  Eigen::MatrixXd CalculateSizeZoneMatrix(const QuantizedImage &image, const mitk::TextureMatrixEngine::OffsetVectorType &offsets)
+  {
+    const long sizeX = image.Size[0];
+    const long sizeY = image.Size[1];
+    const long sizeZ = image.Size[2];
+
+    std::vector<mitk::TextureMatrixEngine::OffsetType> connectivity;
+    for (const auto &offset : offsets)
+    {
+      mitk::TextureMatrixEngine::OffsetType negativeOffset = { { -offset[0], -offset[1], -offset[2] } };
+      connectivity.push_back(offset);
+      connectivity.push_back(negativeOffset);
+    }
+
+    std::vector<char> visited(image.BinIndices.size(), 0);
+    std::vector<std::pair<int, std::size_t> > zones;
+    std::vector<std::size_t> stack;
+    std::size_t largestZone = 0;
+
+    for (std::size_t start = 0; start < image.BinIndices.size(); ++start)
+    {
+      const int bin = image.BinIndices[start];
+      if (bin < 0 || visited[start])
+      {
+        continue;
+      }
+
+      std::size_t zoneSize = 0;
+      visited[start] = 1;
+      stack.push_back(start);
+      while (!stack.empty())
+      {
+        const std::size_t current = stack.back();
+        stack.pop_back();
+        ++zoneSize;
+
+        const long x = current % sizeX;
+        const long y = (current / sizeX) % sizeY;
+        const long z = current / (sizeX * sizeY);
+        for (const auto &offset : connectivity)
+        {
+          const long nx = x + offset[0];
+          const long ny = y + offset[1];
+          const long nz = z + offset[2];
+          // Voxels outside of the cropped region are not masked
+          if (nx < 0 || ny < 0 || nz < 0 || nx >= sizeX || ny >= sizeY || nz >= sizeZ)
+          {
+            continue;
+          }
+          const std::size_t neighbour = nx + sizeX * (ny + sizeY * nz);
+          if (!visited[neighbour] && image.BinIndices[neighbour] == bin)
+          {
+            visited[neighbour] = 1;
+            stack.push_back(neighbour);
+          }
+        }
+      }
+      zones.emplace_back(bin, zoneSize);
+      largestZone = std::max(largestZone, zoneSize);
+    }
+
+    Eigen::MatrixXd matrix = Eigen::MatrixXd::Zero(image.NumberOfBins, largestZone);
+    for (const auto &zone : zones)
+    {
+      matrix(zone.first, zone.second - 1) += 1;
+    }
+    return matrix;
+  }
+
+  std::vector<Eigen::MatrixXd> CalculateRunLengthMatrices(const QuantizedImage &image,
+                                                          const mitk::TextureMatrixEngine::OffsetVectorType &offsets,
+                                                          unsigned int numberOfThreads)
+  {
+    for (const auto &offset : offsets)
+    {
+      if (offset[0] == 0 && offset[1] == 0 && offset[2] == 0)
+      {
+        mitkThrow() << "Cannot calculate run length matrices. The offsets must not be zero.";
+      }
+    }
+
+    const auto bins = image.NumberOfBins;
+    const auto rowCount = image.Size[1] * image.Size[2];
+    numberOfThreads = static_cast<unsigned int>(std::max<std::size_t>(1, std::min<std::size_t>(numberOfThreads, rowCount)));
+
+    // The matrices of every thread grow with the longest run found so far
+    std::vector<std::vector<Eigen::MatrixXd> > threadMatrices(numberOfThreads,
+      std::vector<Eigen::MatrixXd>(offsets.size(), Eigen::MatrixXd::Zero(bins, 1)));
+
+    ParallelForRows(numberOfThreads, rowCount, [&](unsigned int threadID, std::size_t firstRow, std::size_t endRow)
+    {
+      auto &matrices = threadMatrices[threadID];
+      for (std::size_t row = firstRow; row < endRow; ++row)
+      {
+        const long y = row % image.Size[1];
+        const long z = row / image.Size[1];
+        for (long x = 0; x < static_cast<long>(image.Size[0]); ++x)
+        {
+          const int bin = image.GetRunLengthBinIndex(x, y, z);
+          if (bin < 0)
+          {
+            continue;
+          }
+          for (std::size_t k = 0; k < offsets.size(); ++k)
+          {
+            const auto &offset = offsets[k];
+            // Only the first voxel of a run follows it, so every run is counted once
+            if (image.GetRunLengthBinIndex(x - offset[0], y - offset[1], z - offset[2]) == bin)
+            {
+              continue;
+            }
+            long length = 1;
+            while (image.GetRunLengthBinIndex(x + length * offset[0], y + length * offset[1], z + length * offset[2]) == bin)
+            {
+              ++length;
+            }
+            auto &matrix = matrices[k];
+            if (length > matrix.cols())
+            {
+              matrix.conservativeResizeLike(Eigen::MatrixXd::Zero(bins, std::max<long>(length, 2 * matrix.cols())));
+            }
+            matrix(bin, length - 1) += 1;
+          }
+        }
+      }
+    });
+
+    long longestRun = 0;
+    for (const auto &matrices : threadMatrices)
+    {
+      for (const auto &matrix : matrices)
+      {
+        for (long column = matrix.cols() - 1; column >= longestRun; --column)
+        {
+          if (matrix.col(column).any())
+          {
+            longestRun = column + 1;
+            break;
+          }
+        }
+      }
+    }
+
+    std::vector<Eigen::MatrixXd> result(offsets.size(), Eigen::MatrixXd::Zero(bins, longestRun));
+    for (const auto &matrices : threadMatrices)
+    {
+      for (std::size_t k = 0; k < offsets.size(); ++k)
+      {
+        const long columns = std::min<long>(longestRun, matrices[k].cols());
+        result[k].leftCols(columns) += matrices[k].leftCols(columns);
+      }
+    }
+    return result;
+  }
+}
+
+const int mitk::TextureMatrixEngine::OutsideMask;
+const int mitk::TextureMatrixEngine::NotANumber;
+
+bool mitk::TextureMatrixEngine::QuantizedImage::IsInsideImage(long x, long y, long z) const
+{
+  x += CropIndex[0];
+  y += CropIndex[1];
+  z += CropIndex[2];
+  return x >= 0 && y >= 0 && z >= 0 &&
+    x < static_cast<long>(ImageSize[0]) && y < static_cast<long>(ImageSize[1]) && z < static_cast<long>(ImageSize[2]);
+}
+
+int mitk::TextureMatrixEngine::QuantizedImage::GetBinIndex(long x, long y, long z) const
+{
+  if (x < 0 || y < 0 || z < 0 ||
+    x >= static_cast<long>(Size[0]) || y >= static_cast<long>(Size[1]) || z >= static_cast<long>(Size[2]))
+  {
+    return OutsideMask;
+  }
+  return BinIndices[x + Size[0] * (y + Size[1] * z)];
+}
+
+int mitk::TextureMatrixEngine::QuantizedImage::GetRunLengthBinIndex(long x, long y, long z) const
+{
+  if (x < 0 || y < 0 || z < 0 ||
+    x >= static_cast<long>(Size[0]) || y >= static_cast<long>(Size[1]) || z >= static_cast<long>(Size[2]))
+  {
+    return OutsideMask;
+  }
+  const std::size_t index = x + Size[0] * (y + Size[1] * z);
+  return IsRunLengthVoxel[index] ? BinIndices[index] : OutsideMask;
+}
+
+mitk::TextureMatrixEngine::TextureMatrixEngine() :
+  m_NumberOfThreads(0),
+  m_NumberOfQuantizations(0),
+  m_NumberOfTraversals(0),
+  m_MaximumCacheSize(4)
+{
+}
+
+mitk::TextureMatrixEngine::~TextureMatrixEngine()
+{
+}
+
+void mitk::TextureMatrixEngine::ClearCache()
+{
+  m_Cache.clear();
+}
+
+unsigned int mitk::TextureMatrixEngine::GetEffectiveNumberOfThreads() const
+{
+  if (m_NumberOfThreads > 0)
+  {
+    return m_NumberOfThreads;
+  }
+  return std::max(1u, itk::MultiThreader::GetGlobalDefaultNumberOfThreads());
+}
+
+mitk::TextureMatrixEngine::CacheEntry* mitk::TextureMatrixEngine::FindEntry(const QuantizedImageConstPointer &image)
+{
+  for (auto &entry : m_Cache)
+  {
+    if (entry->Quantized == image)
+    {
+      return entry.get();
+    }
+  }
+  return nullptr;
+}
+
+mitk::TextureMatrixEngine::QuantizedImageConstPointer
+mitk::TextureMatrixEngine::GetQuantizedImage(const Image *image, const Image *mask, const IntensityQuantifier *quantifier)
+{
+  if (image == nullptr || mask == nullptr || quantifier == nullptr)
+  {
+    mitkThrow() << "Cannot quantize image. Image, mask and quantifier must be set.";
+  }
+  if (image->GetDimension() != mask->GetDimension())
+  {
+    mitkThrow() << "Cannot quantize image. Image and mask have different dimensions.";
+  }
+
+  for (auto iter = m_Cache.begin(); iter != m_Cache.end(); ++iter)
+  {
+    const auto &entry = *iter;
+    if (entry->InputImage == image && entry->ImageMTime == image->GetMTime() &&
+      entry->InputMask == mask && entry->MaskMTime == mask->GetMTime() &&
+      entry->Minimum == quantifier->GetMinimum() && entry->Maximum == quantifier->GetMaximum() &&
+      entry->Binsize == quantifier->GetBinsize() &&
+      entry->Bins == quantifier->GetBins())
+    {
+      // Keep the most recently used entry at the end
+      std::unique_ptr<CacheEntry> usedEntry = std::move(*iter);
+      m_Cache.erase(iter);
+      m_Cache.push_back(std::move(usedEntry));
+      return m_Cache.back()->Quantized;
+    }
+  }
+
+  auto quantized = std::make_shared<QuantizedImage>();
+  AccessByItk_n(image, QuantizeImage, (mask, quantifier->GetMinimum(), quantifier->GetMaximum(), quantifier->GetBinsize(), quantifier->GetBins(), *quantized));
+  ++m_NumberOfQuantizations;
+
+  std::unique_ptr<CacheEntry> entry(new CacheEntry);
+  entry->InputImage = image;
+  entry->ImageMTime = image->GetMTime();
+  entry->InputMask = mask;
+  entry->MaskMTime = mask->GetMTime();
+  entry->Minimum = quantifier->GetMinimum();
+  entry->Maximum = quantifier->GetMaximum();
+  entry->Binsize = quantifier->GetBinsize();
+  entry->Bins = quantifier->GetBins();
+  entry->Quantized = quantized;
+  m_Cache.push_back(std::move(entry));
+  while (m_Cache.size() > std::max(1u, m_MaximumCacheSize))
+  {
+    m_Cache.erase(m_Cache.begin());
+  }
+  return quantized;
+}
+
+std::vector<Eigen::MatrixXd> mitk::TextureMatrixEngine::GetCooccurrenceMatrices(const QuantizedImageConstPointer &image, const OffsetVectorType &offsets)
+{
+  auto entry = this->FindEntry(image);
+  const auto key = OffsetsToKey(offsets);
+  if (entry != nullptr)
+  {
+    auto cached = entry->CooccurrenceCache.find(key);
+    if (cached != entry->CooccurrenceCache.end())
+    {
+      return cached->second;
+    }
+  }
+
+  auto result = CalculateCooccurrenceMatrices(*image, offsets, this->GetEffectiveNumberOfThreads());
+  ++m_NumberOfTraversals;
+  if (entry != nullptr)
+  {
+    entry->CooccurrenceCache[key] = result;
+  }
+  return result;
+}
+
+std::shared_ptr<const mitk::TextureMatrixEngine::NeighbourhoodMatrices>
+mitk::TextureMatrixEngine::GetNeighbourhoodMatrices(const QuantizedImageConstPointer &image, const RadiusType &radius, int alpha)
+{
+  // Dimensions that are not part of the image have no neighbours
+  RadiusType effectiveRadius = radius;
+  for (unsigned int i = image->Dimension; i < 3; ++i)
+  {
+    effectiveRadius[i] = 0;
+  }
+
+  auto entry = this->FindEntry(image);
+  const std::vector<long> key = { static_cast<long>(effectiveRadius[0]), static_cast<long>(effectiveRadius[1]),
+    static_cast<long>(effectiveRadius[2]), alpha };
+  if (entry != nullptr)
+  {
+    auto cached = entry->NeighbourhoodCache.find(key);
+    if (cached != entry->NeighbourhoodCache.end())
+    {
+      return cached->second;
+    }
+  }
+
+  auto result = std::make_shared<const NeighbourhoodMatrices>(
+    CalculateNeighbourhoodMatrices(*image, effectiveRadius, alpha, this->GetEffectiveNumberOfThreads()));
+  ++m_NumberOfTraversals;
+  if (entry != nullptr)
+  {
+    entry->NeighbourhoodCache[key] = result;
+  }
+  return result;
+}
+
+Eigen::MatrixXd mitk::TextureMatrixEngine::GetSizeZoneMatrix(const QuantizedImageConstPointer &image, const OffsetVectorType &offsets)
+{
+  auto entry = this->FindEntry(image);
+  const auto key = OffsetsToKey(offsets);
+  if (entry != nullptr)
+  {
+    auto cached = entry->SizeZoneCache.find(key);
+    if (cached != entry->SizeZoneCache.end())
+    {
+      return cached->second;
+    }
+  }
+
+  auto result = CalculateSizeZoneMatrix(*image, offsets);
+  ++m_NumberOfTraversals;
+  if (entry != nullptr)
+  {
+    entry->SizeZoneCache[key] = result;
+  }
+  return result;
+}
+
+std::vector<Eigen::MatrixXd> mitk::TextureMatrixEngine::GetRunLengthMatrices(const QuantizedImageConstPointer &image, const OffsetVectorType &offsets)
+{
+  auto entry = this->FindEntry(image);
+  const auto key = OffsetsToKey(offsets);
+  if (entry != nullptr)
+  {
+    auto cached = entry->RunLengthCache.find(key);
+    if (cached != entry->RunLengthCache.end())
+    {
+      return cached->second;
+    }
+  }
+
+  auto result = CalculateRunLengthMatrices(*image, offsets, this->GetEffectiveNumberOfThreads());
+  ++m_NumberOfTraversals;
+  if (entry != nullptr)
+  {
+    entry->RunLengthCache[key] = result;
+  }
+  return result;
+}
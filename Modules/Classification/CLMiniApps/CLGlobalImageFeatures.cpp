@@ -21,6 +21,7 @@ found in the LICENSE file.
 
 #include <mitkSplitParameterToVector.h>
 #include <mitkGlobalImageFeaturesParameter.h>
+#include <mitkGlobalImageFeaturesPreprocessing.h>
 
 #include <mitkGIFCooccurenceMatrix.h>
 #include <mitkGIFCooccurenceMatrix2.h>
@@ -38,6 +39,7 @@ found in the LICENSE file.
 #include <mitkGIFIntensityVolumeHistogramFeatures.h>
 #include <mitkGIFNeighbourhoodGreyToneDifferenceFeatures.h>
 #include <mitkGIFNeighbouringGreyLevelDependenceFeatures.h>
+#include <mitkTextureMatrixEngine.h>
 #include <mitkImageAccessByItk.h>
 #include <mitkImageCast.h>
 #include <mitkITKImageImport.h>
@@ -49,12 +51,6 @@ found in the LICENSE file.
 #include <iostream>
 #include <locale>
 
-#include <itkImageDuplicator.h>
-#include <itkImageRegionIterator.h>
-
-
-#include "itkNearestNeighborInterpolateImageFunction.h"
-#include "itkResampleImageFilter.h"
 
 #include <QApplication>
 #include <mitkStandaloneDataStorage.h>
@@ -82,99 +78,6 @@ private:
   charT m_Sep;
 };
 
-template<typename TPixel, unsigned int VImageDimension>
-void
-ResampleImage(itk::Image<TPixel, VImageDimension>* itkImage, float resolution, mitk::Image::Pointer& newImage)
-{
-  typedef itk::Image<TPixel, VImageDimension> ImageType;
-  typedef itk::ResampleImageFilter<ImageType, ImageType> ResampleFilterType;
-
-  typename ResampleFilterType::Pointer resampler = ResampleFilterType::New();
-  auto spacing = itkImage->GetSpacing();
-  auto size = itkImage->GetLargestPossibleRegion().GetSize();
-
-  for (unsigned int i = 0; i < VImageDimension; ++i)
-  {
-    size[i] = size[i] / (1.0*resolution)*(1.0*spacing[i])+1.0;
-  }
-  spacing.Fill(resolution);
-
-  resampler->SetInput(itkImage);
-  resampler->SetSize(size);
-  resampler->SetOutputSpacing(spacing);
-  resampler->SetOutputOrigin(itkImage->GetOrigin());
-  resampler->SetOutputDirection(itkImage->GetDirection());
-  resampler->Update();
-
-  newImage->InitializeByItk(resampler->GetOutput());
-  mitk::GrabItkImageMemory(resampler->GetOutput(), newImage);
-}
-
-
-template<typename TPixel, unsigned int VImageDimension>
-static void
-CreateNoNaNMask(itk::Image<TPixel, VImageDimension>* itkValue, mitk::Image::Pointer mask, mitk::Image::Pointer& newMask)
-{
-  typedef itk::Image< TPixel, VImageDimension>                 LFloatImageType;
-  typedef itk::Image< unsigned short, VImageDimension>          LMaskImageType;
-  typename LMaskImageType::Pointer itkMask = LMaskImageType::New();
-
-  mitk::CastToItkImage(mask, itkMask);
-
-  typedef itk::ImageDuplicator< LMaskImageType > DuplicatorType;
-  typename DuplicatorType::Pointer duplicator = DuplicatorType::New();
-  duplicator->SetInputImage(itkMask);
-  duplicator->Update();
-
-  auto tmpMask = duplicator->GetOutput();
-
-  itk::ImageRegionIterator<LMaskImageType> mask1Iter(itkMask, itkMask->GetLargestPossibleRegion());
-  itk::ImageRegionIterator<LMaskImageType> mask2Iter(tmpMask, tmpMask->GetLargestPossibleRegion());
-  itk::ImageRegionIterator<LFloatImageType> imageIter(itkValue, itkValue->GetLargestPossibleRegion());
-  while (!mask1Iter.IsAtEnd())
-  {
-    mask2Iter.Set(0);
-    if (mask1Iter.Value() > 0)
-    {
-      // Is not NaN
-      if (imageIter.Value() == imageIter.Value())
-      {
-        mask2Iter.Set(1);
-      }
-    }
-    ++mask1Iter;
-    ++mask2Iter;
-    ++imageIter;
-  }
-
-  newMask->InitializeByItk(tmpMask);
-  mitk::GrabItkImageMemory(tmpMask, newMask);
-}
-
-template<typename TPixel, unsigned int VImageDimension>
-static void
-ResampleMask(itk::Image<TPixel, VImageDimension>* itkMoving, mitk::Image::Pointer ref, mitk::Image::Pointer& newMask)
-{
-  typedef itk::Image< TPixel, VImageDimension>          LMaskImageType;
-  typedef itk::NearestNeighborInterpolateImageFunction< LMaskImageType> NearestNeighborInterpolateImageFunctionType;
-  typedef itk::ResampleImageFilter<LMaskImageType, LMaskImageType> ResampleFilterType;
-
-  typename NearestNeighborInterpolateImageFunctionType::Pointer nn_interpolator = NearestNeighborInterpolateImageFunctionType::New();
-  typename LMaskImageType::Pointer itkRef = LMaskImageType::New();
-  mitk::CastToItkImage(ref, itkRef);
-
-
-  typename ResampleFilterType::Pointer resampler = ResampleFilterType::New();
-  resampler->SetInput(itkMoving);
-  resampler->SetReferenceImage(itkRef);
-  resampler->UseReferenceImageOn();
-  resampler->SetInterpolator(nn_interpolator);
-  resampler->Update();
-
-  newMask->InitializeByItk(resampler->GetOutput());
-  mitk::GrabItkImageMemory(resampler->GetOutput(), newMask);
-}
-
 static void
 ExtractSlicesFromImages(mitk::Image::Pointer image, mitk::Image::Pointer mask,
                         mitk::Image::Pointer maskNoNaN, mitk::Image::Pointer morphMask,
@@ -500,7 +403,7 @@ int main(int argc, char* argv[])
   if (param.resampleToFixIsotropic)
   {
     mitk::Image::Pointer newImage = mitk::Image::New();
-    AccessByItk_2(image, ResampleImage, param.resampleResolution, newImage);
+    mitk::cl::ResampleImageToIsotropicResolution(image, param.resampleResolution, newImage);
     image = newImage;
   }
   if ( ! mitk::Equal(mask->GetGeometry(0)->GetOrigin(), image->GetGeometry(0)->GetOrigin()))
@@ -522,7 +425,7 @@ int main(int argc, char* argv[])
   if (param.resampleMask)
   {
     mitk::Image::Pointer newMaskImage = mitk::Image::New();
-    AccessByItk_2(mask, ResampleMask, image, newMaskImage);
+    mitk::cl::ResampleMaskToReference(mask, image, newMaskImage);
     mask = newMaskImage;
   }
 
@@ -553,7 +456,7 @@ int main(int argc, char* argv[])
   MITK_INFO << "Start creating Mask without NaN";
 
   mitk::Image::Pointer maskNoNaN = mitk::Image::New();
-  AccessByItk_2(image, CreateNoNaNMask,  mask, maskNoNaN);
+  mitk::cl::CreateNoNaNMask(image, mask, maskNoNaN);
   //CreateNoNaNMask(mask, image, maskNoNaN);
 
 
@@ -577,6 +480,9 @@ int main(int argc, char* argv[])
     MITK_INFO << "Slice";
   }
 
+  // All feature classes share the cropped and quantized images and the texture matrices
+  mitk::TextureMatrixEngine::Pointer textureMatrixEngine = mitk::TextureMatrixEngine::New();
+
   log << " Configure features -";
   for (auto cFeature : features)
   {
@@ -598,6 +504,7 @@ int main(int argc, char* argv[])
     cFeature->SetParameter(parsedArgs);
     cFeature->SetDirection(direction);
     cFeature->SetEncodeParameters(param.encodeParameter);
+    cFeature->SetTextureMatrixEngine(textureMatrixEngine);
   }
 
   bool addDescription = parsedArgs.count("description");
@@ -672,6 +579,7 @@ int main(int argc, char* argv[])
       cFeature->SetMorphMask(cMorphMask);
       cFeature->CalculateFeaturesUsingParameters(cImage, cMask, cMaskNoNaN, stats);
     }
+    textureMatrixEngine->ClearCache();
 
     for (std::size_t i = 0; i < stats.size(); ++i)
     {
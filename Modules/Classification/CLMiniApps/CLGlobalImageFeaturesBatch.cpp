@@ -0,0 +1,613 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <mitkIOUtil.h>
+#include "mitkCommandLineParser.h"
+
+#include <mitkSplitParameterToVector.h>
+#include <mitkGlobalImageFeaturesParameter.h>
+#include <mitkGlobalImageFeaturesPreprocessing.h>
+#include <mitkCLResultStreamWriter.h>
+
+#include <mitkGIFCooccurenceMatrix.h>
+#include <mitkGIFCooccurenceMatrix2.h>
+#include <mitkGIFGreyLevelRunLength.h>
+#include <mitkGIFFirstOrderStatistics.h>
+#include <mitkGIFFirstOrderHistogramStatistics.h>
+#include <mitkGIFFirstOrderNumericStatistics.h>
+#include <mitkGIFVolumetricStatistics.h>
+#include <mitkGIFVolumetricDensityStatistics.h>
+#include <mitkGIFGreyLevelSizeZone.h>
+#include <mitkGIFGreyLevelDistanceZone.h>
+#include <mitkGIFImageDescriptionFeatures.h>
+#include <mitkGIFLocalIntensity.h>
+#include <mitkGIFCurvatureStatistic.h>
+#include <mitkGIFIntensityVolumeHistogramFeatures.h>
+#include <mitkGIFNeighbourhoodGreyToneDifferenceFeatures.h>
+#include <mitkGIFNeighbouringGreyLevelDependenceFeatures.h>
+#include <mitkTextureMatrixEngine.h>
+#include <mitkConvert2Dto3DImageFilter.h>
+
+#include <itkMultiThreader.h>
+#include <itksys/SystemTools.hxx>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+namespace
+{
+  typedef std::chrono::steady_clock ClockType;
+
+  double MillisecondsSince(const ClockType::time_point &start)
+  {
+    return std::chrono::duration<double, std::milli>(ClockType::now() - start).count();
+  }
+
+  struct BatchCase
+  {
+    std::string CaseId;
+    std::string MaskPath;
+    std::string MorphMaskPath;
+  };
+
+  /** All cases of one image. The image is loaded once and used for all masks.*/
+  struct CaseGroup
+  {
+    std::string ImagePath;
+    std::vector<BatchCase> Cases;
+  };
+
+  /**
+  * Reads the manifest. Each line describes one case: "case;image;mask[;morph-mask]" or just "image;mask".
+  * Empty lines and lines starting with '#' are ignored, relative paths are relative to the manifest.
+  */
+  std::vector<CaseGroup> ReadManifest(const std::string &manifestPath, std::size_t &numberOfCases)
+  {
+    std::ifstream manifest(manifestPath);
+    if (!manifest.good())
+    {
+      mitkThrow() << "Could not read manifest " << manifestPath;
+    }
+    const std::string manifestFolder = itksys::SystemTools::GetFilenamePath(itksys::SystemTools::CollapseFullPath(manifestPath));
+
+    std::vector<CaseGroup> groups;
+    std::unordered_map<std::string, std::size_t> groupOfImage;
+    numberOfCases = 0;
+
+    std::string line;
+    std::size_t lineNumber = 0;
+    while (std::getline(manifest, line))
+    {
+      ++lineNumber;
+      if (!line.empty() && line.back() == '\r')
+      {
+        line.pop_back();
+      }
+      if (line.empty() || line[0] == '#')
+      {
+        continue;
+      }
+
+      std::vector<std::string> columns;
+      std::istringstream lineStream(line);
+      std::string column;
+      while (std::getline(lineStream, column, ';'))
+      {
+        columns.push_back(column);
+      }
+      if (columns.size() < 2 || columns.size() > 4)
+      {
+        mitkThrow() << "Line " << lineNumber << " of the manifest has " << columns.size() << " columns, expected case;image;mask[;morph-mask] or image;mask";
+      }
+      if (columns.size() == 2)
+      {
+        columns.insert(columns.begin(), itksys::SystemTools::GetFilenameWithoutExtension(columns[0]) + "_" + itksys::SystemTools::GetFilenameWithoutExtension(columns[1]));
+      }
+
+      BatchCase batchCase;
+      batchCase.CaseId = columns[0];
+      const std::string imagePath = itksys::SystemTools::CollapseFullPath(columns[1], manifestFolder);
+      batchCase.MaskPath = itksys::SystemTools::CollapseFullPath(columns[2], manifestFolder);
+      if (columns.size() == 4 && !columns[3].empty())
+      {
+        batchCase.MorphMaskPath = itksys::SystemTools::CollapseFullPath(columns[3], manifestFolder);
+      }
+
+      auto group = groupOfImage.find(imagePath);
+      if (group == groupOfImage.end())
+      {
+        group = groupOfImage.emplace(imagePath, groups.size()).first;
+        groups.emplace_back();
+        groups.back().ImagePath = imagePath;
+      }
+      groups[group->second].Cases.push_back(batchCase);
+      ++numberOfCases;
+    }
+    return groups;
+  }
+
+  /**
+  * Limits the estimated memory of the images that are processed at the same time. A worker that would exceed
+  * the budget waits until other workers release their images. A single image is always admitted, even if it
+  * is larger than the budget.
+  */
+  class MemoryBudget
+  {
+  public:
+    explicit MemoryBudget(std::size_t budget) : m_Budget(budget), m_Used(0) {}
+
+    void Acquire(std::size_t bytes)
+    {
+      std::unique_lock<std::mutex> lock(m_Mutex);
+      if (m_Budget > 0)
+      {
+        m_Condition.wait(lock, [this, bytes] { return m_Used == 0 || m_Used + bytes <= m_Budget; });
+      }
+      m_Used += bytes;
+    }
+
+    /** Replaces a reservation, e.g. the estimate before loading by the actual size of the loaded image.*/
+    void Update(std::size_t oldBytes, std::size_t newBytes)
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      m_Used = m_Used - oldBytes + newBytes;
+      m_Condition.notify_all();
+    }
+
+    void Release(std::size_t bytes)
+    {
+      this->Update(bytes, 0);
+    }
+
+  private:
+    std::size_t m_Budget;
+    std::size_t m_Used;
+    std::mutex m_Mutex;
+    std::condition_variable m_Condition;
+  };
+
+  /** Memory of the image plus the working copies created during the feature calculation (double image, masks).*/
+  std::size_t EstimateWorkingSetSize(const mitk::Image *image)
+  {
+    std::size_t numberOfVoxels = 1;
+    for (unsigned int i = 0; i < image->GetDimension(); ++i)
+    {
+      numberOfVoxels *= image->GetDimension(i);
+    }
+    return numberOfVoxels * (image->GetPixelType().GetSize() + sizeof(double) + 2 * sizeof(unsigned short));
+  }
+
+  /** The readers of MITK are not guaranteed to be thread-safe, so files are read one at a time.*/
+  std::mutex s_ReaderMutex;
+
+  mitk::Image::Pointer LoadImage(const std::string &path)
+  {
+    std::lock_guard<std::mutex> lock(s_ReaderMutex);
+    return mitk::IOUtil::Load<mitk::Image>(path);
+  }
+
+  mitk::Image::Pointer ConvertTo3D(mitk::Image::Pointer image)
+  {
+    mitk::Convert2Dto3DImageFilter::Pointer multiFilter = mitk::Convert2Dto3DImageFilter::New();
+    multiFilter->SetInput(image);
+    multiFilter->Update();
+    return multiFilter->GetOutput();
+  }
+
+  /** Restores origin and spacing of an image that is shared by several cases after a case has adapted them.*/
+  class GeometryGuard
+  {
+  public:
+    explicit GeometryGuard(mitk::Image *image) :
+      m_Geometry(image->GetGeometry(0)),
+      m_Origin(m_Geometry->GetOrigin()),
+      m_Spacing(m_Geometry->GetSpacing())
+    {
+    }
+    ~GeometryGuard()
+    {
+      m_Geometry->SetSpacing(m_Spacing);
+      m_Geometry->SetOrigin(m_Origin);
+    }
+  private:
+    mitk::BaseGeometry::Pointer m_Geometry;
+    mitk::Point3D m_Origin;
+    mitk::Vector3D m_Spacing;
+  };
+
+  std::vector<mitk::AbstractGlobalImageFeature::Pointer> CreateFeatureCalculators()
+  {
+    std::vector<mitk::AbstractGlobalImageFeature::Pointer> features;
+    features.push_back(mitk::GIFVolumetricStatistics::New().GetPointer());
+    features.push_back(mitk::GIFVolumetricDensityStatistics::New().GetPointer());
+    features.push_back(mitk::GIFCurvatureStatistic::New().GetPointer());
+    features.push_back(mitk::GIFFirstOrderStatistics::New().GetPointer());
+    features.push_back(mitk::GIFFirstOrderNumericStatistics::New().GetPointer());
+    features.push_back(mitk::GIFFirstOrderHistogramStatistics::New().GetPointer());
+    features.push_back(mitk::GIFIntensityVolumeHistogramFeatures::New().GetPointer());
+    features.push_back(mitk::GIFLocalIntensity::New().GetPointer());
+    features.push_back(mitk::GIFCooccurenceMatrix::New().GetPointer());
+    features.push_back(mitk::GIFCooccurenceMatrix2::New().GetPointer());
+    features.push_back(mitk::GIFNeighbouringGreyLevelDependenceFeature::New().GetPointer());
+    features.push_back(mitk::GIFGreyLevelRunLength::New().GetPointer());
+    features.push_back(mitk::GIFGreyLevelSizeZone::New().GetPointer());
+    features.push_back(mitk::GIFGreyLevelDistanceZone::New().GetPointer());
+    features.push_back(mitk::GIFImageDescriptionFeatures::New().GetPointer());
+    features.push_back(mitk::GIFNeighbourhoodGreyToneDifferenceFeatures::New().GetPointer());
+    return features;
+  }
+
+  /** Settings that are shared by all workers.*/
+  struct BatchSettings
+  {
+    mitk::cl::GlobalImageFeaturesParameter Parameter;
+    std::map<std::string, us::Any> ParsedArguments;
+    int Direction = 0;
+  };
+
+  /** Feature calculators of one worker. The calculators are not thread-safe, so every worker has its own.*/
+  class Worker
+  {
+  public:
+    Worker(const BatchSettings &settings, MemoryBudget &budget, mitk::cl::FeatureResultStreamWriter &writer) :
+      m_Settings(settings), m_Budget(budget), m_Writer(writer)
+    {
+      m_TextureMatrixEngine = mitk::TextureMatrixEngine::New();
+      m_Features = CreateFeatureCalculators();
+      const auto &param = m_Settings.Parameter;
+      for (auto cFeature : m_Features)
+      {
+        if (param.defineGlobalMinimumIntensity)
+        {
+          cFeature->SetMinimumIntensity(param.globalMinimumIntensity);
+          cFeature->SetUseMinimumIntensity(true);
+        }
+        if (param.defineGlobalMaximumIntensity)
+        {
+          cFeature->SetMaximumIntensity(param.globalMaximumIntensity);
+          cFeature->SetUseMaximumIntensity(true);
+        }
+        if (param.defineGlobalNumberOfBins)
+        {
+          cFeature->SetBins(param.globalNumberOfBins);
+        }
+        cFeature->SetParameter(m_Settings.ParsedArguments);
+        cFeature->SetDirection(m_Settings.Direction);
+        cFeature->SetEncodeParameters(param.encodeParameter);
+        cFeature->SetTextureMatrixEngine(m_TextureMatrixEngine);
+      }
+    }
+
+    void ProcessGroup(const CaseGroup &group)
+    {
+      std::size_t estimate = itksys::SystemTools::FileLength(group.ImagePath);
+      for (const auto &batchCase : group.Cases)
+      {
+        estimate = std::max<std::size_t>(estimate, itksys::SystemTools::FileLength(batchCase.MaskPath));
+      }
+      m_Budget.Acquire(estimate);
+
+      mitk::Image::Pointer image;
+      std::string imageError;
+      auto start = ClockType::now();
+      try
+      {
+        image = LoadImage(group.ImagePath);
+        if (m_Settings.Parameter.resampleToFixIsotropic)
+        {
+          mitk::Image::Pointer newImage = mitk::Image::New();
+          mitk::cl::ResampleImageToIsotropicResolution(image, m_Settings.Parameter.resampleResolution, newImage);
+          image = newImage;
+        }
+        m_Budget.Update(estimate, EstimateWorkingSetSize(image));
+        estimate = EstimateWorkingSetSize(image);
+      }
+      catch (const std::exception &e)
+      {
+        imageError = std::string("Could not load image: ") + e.what();
+      }
+      double imageLoadTime = MillisecondsSince(start);
+
+      for (const auto &batchCase : group.Cases)
+      {
+        mitk::cl::FeatureResultStreamWriter::CaseResult result;
+        result.CaseId = batchCase.CaseId;
+        result.ImagePath = group.ImagePath;
+        result.MaskPath = batchCase.MaskPath;
+        // The image is loaded only once, its loading time is accounted to the first case
+        result.LoadTime = imageLoadTime;
+        imageLoadTime = 0.0;
+
+        if (image.IsNull())
+        {
+          result.Message = imageError;
+        }
+        else
+        {
+          try
+          {
+            this->ProcessCase(image, batchCase, result);
+            result.Succeeded = true;
+          }
+          catch (const std::exception &e)
+          {
+            result.Features.clear();
+            result.Message = e.what();
+          }
+        }
+
+        if (!result.Succeeded)
+        {
+          MITK_WARN << "Case " << result.CaseId << " failed: " << result.Message;
+        }
+        m_Writer.AddCase(result);
+      }
+
+      m_TextureMatrixEngine->ClearCache();
+      image = nullptr;
+      m_Budget.Release(estimate);
+    }
+
+  private:
+    void ProcessCase(mitk::Image::Pointer image, const BatchCase &batchCase, mitk::cl::FeatureResultStreamWriter::CaseResult &result)
+    {
+      const auto &param = m_Settings.Parameter;
+      auto start = ClockType::now();
+
+      GeometryGuard geometryGuard(image);
+      mitk::Image::Pointer mask = LoadImage(batchCase.MaskPath);
+      mitk::Image::Pointer morphMask = mask;
+      if (!batchCase.MorphMaskPath.empty())
+      {
+        morphMask = LoadImage(batchCase.MorphMaskPath);
+      }
+
+      if (image->GetDimension() != mask->GetDimension())
+      {
+        MITK_INFO << "Case " << batchCase.CaseId << ": Dimension of image and mask do not match, the 2D image is converted to 3D.";
+        if (image->GetDimension() == 2)
+        {
+          image = ConvertTo3D(image);
+        }
+        if (mask->GetDimension() == 2)
+        {
+          mask = ConvertTo3D(mask);
+        }
+      }
+
+      if (!mitk::Equal(mask->GetGeometry(0)->GetOrigin(), image->GetGeometry(0)->GetOrigin()))
+      {
+        if (!param.ensureSameSpace)
+        {
+          mitkThrow() << "The origin of the input image and the mask do not match.";
+        }
+        MITK_WARN << "Case " << batchCase.CaseId << ": The origin of the input image was set to the origin of the mask.";
+        image->GetGeometry(0)->SetOrigin(mask->GetGeometry(0)->GetOrigin());
+      }
+
+      if (param.resampleMask)
+      {
+        mitk::Image::Pointer newMaskImage = mitk::Image::New();
+        mitk::cl::ResampleMaskToReference(mask, image, newMaskImage);
+        mask = newMaskImage;
+      }
+
+      if (!mitk::Equal(mask->GetGeometry(0)->GetSpacing(), image->GetGeometry(0)->GetSpacing()))
+      {
+        if (!param.ensureSameSpace)
+        {
+          mitkThrow() << "The spacing of the mask and the input images is not equal.";
+        }
+        MITK_WARN << "Case " << batchCase.CaseId << ": The spacing of the input image was set to the spacing of the mask.";
+        image->GetGeometry(0)->SetSpacing(mask->GetGeometry(0)->GetSpacing());
+      }
+
+      mitk::Image::Pointer maskNoNaN = mitk::Image::New();
+      mitk::cl::CreateNoNaNMask(image, mask, maskNoNaN);
+      result.LoadTime += MillisecondsSince(start);
+
+      start = ClockType::now();
+      for (auto cFeature : m_Features)
+      {
+        cFeature->SetMorphMask(morphMask);
+        cFeature->CalculateFeaturesUsingParameters(image, mask, maskNoNaN, result.Features);
+      }
+      result.CalculationTime = MillisecondsSince(start);
+    }
+
+    const BatchSettings &m_Settings;
+    MemoryBudget &m_Budget;
+    mitk::cl::FeatureResultStreamWriter &m_Writer;
+    std::vector<mitk::AbstractGlobalImageFeature::Pointer> m_Features;
+    mitk::TextureMatrixEngine::Pointer m_TextureMatrixEngine;
+  };
+}
+
+int main(int argc, char* argv[])
+{
+  mitkCommandLineParser parser;
+  parser.setArgumentPrefix("--", "-");
+
+  parser.addArgument("manifest", "manifest", mitkCommandLineParser::File, "Manifest", "Text file with one case per line: case;image;mask[;morph-mask] or image;mask", us::Any(), false, false, false, mitkCommandLineParser::Input);
+  parser.addArgument("output", "o", mitkCommandLineParser::File, "Output text file", "Path to output file. The results are appended to this file as soon as a case is finished.", us::Any(), false, false, false, mitkCommandLineParser::Output);
+  parser.addArgument("workers", "workers", mitkCommandLineParser::Int, "Int", "Number of cases that are processed in parallel. Default is the number of cores.", us::Any());
+  parser.addArgument("memory-budget", "memory", mitkCommandLineParser::Int, "Int", "Approximate memory in MB for the images that are processed in parallel. 0 (default) is unlimited.", us::Any());
+  parser.addArgument("output-layout", "layout", mitkCommandLineParser::String, "Text", "'wide' (default): one row per case, 'long': one row per case and feature.", us::Any());
+  parser.addArgument("decimal-point", "decimal", mitkCommandLineParser::String, "Decima Point that is used in Conversion", "", us::Any());
+  parser.addArgument("direction", "dir", mitkCommandLineParser::String, "Int", "Allows to specify the direction for Cooc and RL. 0: All directions, 1: Only single direction (Test purpose), 2,3,4... Without dimension 0,1,2... ", us::Any());
+
+  BatchSettings settings;
+  settings.Parameter.AddFeatureParameter(parser);
+
+  parser.addArgument("--", "-", mitkCommandLineParser::String, "---", "---", us::Any(), true);
+  for (auto cFeature : CreateFeatureCalculators())
+  {
+    cFeature->AddArguments(parser);
+  }
+
+  // Miniapp Infos
+  parser.setCategory("Classification Tools");
+  parser.setTitle("Global Image Feature calculator (Batch)");
+  parser.setDescription("Calculates the global image features of all image / segmentation combinations of a manifest in parallel");
+  parser.setContributor("German Cancer Research Center (DKFZ)");
+
+  std::map<std::string, us::Any> parsedArgs = parser.parseArguments(argc, argv);
+
+  if (parsedArgs.size() == 0)
+  {
+    return EXIT_FAILURE;
+  }
+  if (parsedArgs.count("help") || parsedArgs.count("h"))
+  {
+    return EXIT_SUCCESS;
+  }
+
+  settings.Parameter.ParseFeatureParameter(parsedArgs);
+  settings.ParsedArguments = parsedArgs;
+  if (parsedArgs.count("direction"))
+  {
+    settings.Direction = mitk::cl::splitDouble(parsedArgs["direction"].ToString(), ';')[0];
+  }
+
+  std::size_t numberOfCases = 0;
+  std::vector<CaseGroup> groups;
+  try
+  {
+    groups = ReadManifest(parsedArgs["manifest"].ToString(), numberOfCases);
+  }
+  catch (const std::exception &e)
+  {
+    MITK_ERROR << e.what();
+    return EXIT_FAILURE;
+  }
+
+  unsigned int numberOfWorkers = std::max(1u, std::thread::hardware_concurrency());
+  if (parsedArgs.count("workers"))
+  {
+    numberOfWorkers = std::max(1, us::any_cast<int>(parsedArgs["workers"]));
+  }
+  numberOfWorkers = std::max(1u, std::min<unsigned int>(numberOfWorkers, groups.size()));
+
+  // The workers share the cores, avoid that every worker starts threads for all cores
+  const int itkThreads = itk::MultiThreader::GetGlobalDefaultNumberOfThreads();
+  itk::MultiThreader::SetGlobalDefaultNumberOfThreads(std::max(1, itkThreads / static_cast<int>(numberOfWorkers)));
+
+  std::size_t memoryBudget = 0;
+  if (parsedArgs.count("memory-budget"))
+  {
+    memoryBudget = static_cast<std::size_t>(std::max(0, us::any_cast<int>(parsedArgs["memory-budget"]))) * 1024 * 1024;
+  }
+  MemoryBudget budget(memoryBudget);
+
+  auto layout = mitk::cl::FeatureResultStreamWriter::WideLayout;
+  if (parsedArgs.count("output-layout"))
+  {
+    std::string layoutName = parsedArgs["output-layout"].ToString();
+    if (layoutName == "long")
+    {
+      layout = mitk::cl::FeatureResultStreamWriter::LongLayout;
+    }
+    else if (layoutName != "wide")
+    {
+      MITK_ERROR << "Unknown output layout " << layoutName << ", use 'wide' or 'long'";
+      return EXIT_FAILURE;
+    }
+  }
+
+  MITK_INFO << "Processing " << numberOfCases << " cases of " << groups.size() << " images with " << numberOfWorkers << " workers";
+  auto start = ClockType::now();
+
+  try
+  {
+    mitk::cl::FeatureResultStreamWriter writer(parsedArgs["output"].ToString(), layout);
+    if (parsedArgs.count("decimal-point") && parsedArgs["decimal-point"].ToString().length() > 0)
+    {
+      writer.SetDecimalPoint(parsedArgs["decimal-point"].ToString().at(0));
+    }
+
+    // Largest groups first, so that the batch does not end with one worker on a large image while the others are idle
+    std::vector<std::size_t> order(groups.size());
+    for (std::size_t i = 0; i < order.size(); ++i)
+    {
+      order[i] = i;
+    }
+    std::vector<unsigned long> imageSizes(groups.size());
+    for (std::size_t i = 0; i < groups.size(); ++i)
+    {
+      imageSizes[i] = itksys::SystemTools::FileLength(groups[i].ImagePath) * groups[i].Cases.size();
+    }
+    std::stable_sort(order.begin(), order.end(), [&imageSizes](std::size_t a, std::size_t b) { return imageSizes[a] > imageSizes[b]; });
+
+    // Failures of single cases are written to the results; anything else (e.g. a failing result file) stops
+    // the batch: the other workers finish their current group and the first error is reported after the join
+    std::atomic<std::size_t> nextGroup(0);
+    std::exception_ptr workerError;
+    std::mutex workerErrorMutex;
+    auto workerFunction = [&]()
+    {
+      try
+      {
+        Worker worker(settings, budget, writer);
+        for (std::size_t i = nextGroup++; i < order.size(); i = nextGroup++)
+        {
+          worker.ProcessGroup(groups[order[i]]);
+          MITK_INFO << "Finished " << writer.GetNumberOfWrittenCases() << " of " << numberOfCases << " cases";
+        }
+      }
+      catch (...)
+      {
+        nextGroup = order.size();
+        std::lock_guard<std::mutex> lock(workerErrorMutex);
+        if (!workerError)
+        {
+          workerError = std::current_exception();
+        }
+      }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned int i = 1; i < numberOfWorkers; ++i)
+    {
+      threads.emplace_back(workerFunction);
+    }
+    workerFunction();
+    for (auto &thread : threads)
+    {
+      thread.join();
+    }
+    if (workerError)
+    {
+      std::rethrow_exception(workerError);
+    }
+  }
+  catch (const std::exception &e)
+  {
+    MITK_ERROR << e.what();
+    return EXIT_FAILURE;
+  }
+  catch (...)
+  {
+    MITK_ERROR << "Unknown error while processing the cases";
+    return EXIT_FAILURE;
+  }
+
+  MITK_INFO << "Processed " << numberOfCases << " cases in " << MillisecondsSince(start) / 1000.0 << " s";
+  return EXIT_SUCCESS;
+}
@@ -109,6 +109,8 @@ int main(int argc, char* argv[])
     std::string resultMask = allConfig.Value("Data", "Result Mask");
     std::string resultProb = allConfig.Value("Data", "Result Propability");
     std::string outputFolder = allConfig.Value("General","Output Folder");
+    int blockSize = allConfig.IntValue("Data", "Block Size", 1000000);
+    bool floatProbabilities = allConfig.IntValue("Data", "Float Probabilities", 0);
 
     std::string writeDataFilePath = allConfig.Value("Forest","File to write data to");
 
@@ -333,17 +335,18 @@ int main(int argc, char* argv[])
     //////////////////////////////////////////////////////////////////////////////
     // If required do test
     //////////////////////////////////////////////////////////////////////////////
-    auto testDataX = mitk::DCUtilities::DC3dDToMatrixXd(testCollection,modalities, testMask);
-    auto testDataNewY = forest->Predict(testDataX);
-    auto testDataNewProb = forest->GetPointWiseProbabilities();
-    //MITK_INFO << testDataNewY;
-
     std::vector<std::string> names;
     names.push_back("prob-1");
     names.push_back("prob-2");
 
-    mitk::DCUtilities::MatrixToDC3d(testDataNewY, testCollection, resultMask, testMask);
-    mitk::DCUtilities::MatrixToDC3d(testDataNewProb, testCollection, names, testMask);
+    // Only the features of one block of voxels are kept in memory
+    mitk::DCUtilities::ClassifyDC3dBlockwise(testCollection, modalities, testMask, blockSize,
+      [&forest](const Eigen::MatrixXd &X, Eigen::MatrixXi &Y, Eigen::MatrixXd &P)
+      {
+        Y = forest->Predict(X);
+        P = forest->GetPointWiseProbabilities();
+      },
+      resultMask, names, floatProbabilities);
     //forest.SetMaskName(testMask);
     //forest.SetCollection(testCollection);
     //forest.Test();
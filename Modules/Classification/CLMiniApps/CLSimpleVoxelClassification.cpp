@@ -66,6 +66,10 @@ int main(int argc, char* argv[])
 
   parser.addArgument("classmap", "m", mitkCommandLineParser::String,
                      "name of class that is to be learnt");
+  parser.addArgument("blockSize", "bs", mitkCommandLineParser::Int,
+                     "number of voxels that are classified together (default 1000000)");
+  parser.addArgument("floatProbabilities", "fp", mitkCommandLineParser::Bool,
+                     "store the probabilities as float instead of double images");
 
 
   std::map<std::string, us::Any> parsedArgs = parser.parseArguments(argc, argv);
@@ -78,6 +82,8 @@ int main(int argc, char* argv[])
   // Default values
   unsigned int forestSize = 8;
   unsigned int treeDepth = 10;
+  unsigned int blockSize = 1000000;
+  bool floatProbabilities = false;
   std::string configName = "";
   std::string outputFolder = "";
 
@@ -129,6 +135,14 @@ int main(int argc, char* argv[])
       forestSize = us::any_cast<int>(parsedArgs["forestSize"]);
     }
 
+    if (parsedArgs.count("blockSize") || parsedArgs.count("bs")) {
+      blockSize = us::any_cast<int>(parsedArgs["blockSize"]);
+    }
+
+    if (parsedArgs.count("floatProbabilities") || parsedArgs.count("fp")) {
+      floatProbabilities = us::any_cast<bool>(parsedArgs["floatProbabilities"]);
+    }
+
     if (parsedArgs.count("stats") || parsedArgs.count("s")) {
       experimentFS.open(us::any_cast<std::string>(parsedArgs["stats"]).c_str(),
           std::ios_base::app);
@@ -194,21 +208,19 @@ int main(int argc, char* argv[])
   forest->Train(trainDataX, trainDataY);
 
 
-  // prepare feature matrix for test case
-  auto testDataX = mitk::DCUtilities::DC3dDToMatrixXd(testCollection,features, classMap);
-  auto testDataNewY = forest->Predict(testDataX);
-
-
-  mitk::DCUtilities::MatrixToDC3d(testDataNewY, testCollection, "RESULT", classMap);
-
-  Eigen::MatrixXd Probs = forest->GetPointWiseProbabilities();
-
-
-  Eigen::MatrixXd prob0 = Probs.col(0);
-  Eigen::MatrixXd prob1 = Probs.col(1);
+  // classify the test case block by block, so that only the features of one block are kept in memory
+  std::vector<std::string> probabilityNames;
+  probabilityNames.push_back("prob0");
+  probabilityNames.push_back("prob1");
 
-  mitk::DCUtilities::MatrixToDC3d(prob0, testCollection,"prob0", classMap);
-  mitk::DCUtilities::MatrixToDC3d(prob1, testCollection,"prob1", classMap);
+  auto numberOfVoxels = mitk::DCUtilities::ClassifyDC3dBlockwise(testCollection, features, classMap, blockSize,
+    [&forest](const Eigen::MatrixXd &X, Eigen::MatrixXi &Y, Eigen::MatrixXd &P)
+    {
+      Y = forest->Predict(X);
+      P = forest->GetPointWiseProbabilities();
+    },
+    "RESULT", probabilityNames, floatProbabilities);
+  MITK_INFO << "Classified " << numberOfVoxels << " voxels";
 
 
   std::vector<std::string> outputFilter;
@@ -2,6 +2,7 @@ file(GLOB_RECURSE H_FILES RELATIVE "${CMAKE_CURRENT_SOURCE_DIR}" "${CMAKE_CURREN
 
 set(CPP_FILES
   mitkCLResultWritter.cpp
+  mitkCLResultStreamWriter.cpp
 
   Algorithms/itkLabelSampler.cpp
   Algorithms/itkSmoothedClassProbabilites.cpp
@@ -29,6 +30,7 @@ set(CPP_FILES
   GlobalImageFeatures/mitkGIFCurvatureStatistic.cpp
 
   MiniAppUtils/mitkGlobalImageFeaturesParameter.cpp
+  MiniAppUtils/mitkGlobalImageFeaturesPreprocessing.cpp
   MiniAppUtils/mitkSplitParameterToVector.cpp
 
   mitkCLUtil.cpp
@@ -44,6 +44,7 @@ namespace itk
     typedef typename TInputImage::RegionType RegionType;
     typedef typename TInputImage::SizeType   SizeType;
     typedef typename TInputImage::IndexType  IndexType;
+    typedef typename TInputImage::OffsetType OffsetType;
     typedef typename TInputImage::PixelType  PixelType;
 
     typedef Image<unsigned short, TInputImage::ImageDimension> MaskImageType;
@@ -15,14 +15,12 @@ found in the LICENSE file.
 
 #include <itkLocalIntensityFilter.h>
 
-#include <itkNeighborhoodIterator.h>
-#include <itkImageRegionIterator.h>
-#include <itkImageIterator.h>
+#include <itkNeighborhood.h>
+#include <itkSlidingWindowHelper.h>
 
+#include <cmath>
 #include <limits>
-
-#include "itkImageScanlineIterator.h"
-#include "itkProgressReporter.h"
+#include <vector>
 
 namespace itk
 {
@@ -210,89 +208,159 @@ namespace itk
   {
     typename TInputImage::ConstPointer itkImage = this->GetInput();
     typename MaskImageType::Pointer itkMask = m_Mask;
+    const unsigned int dimension = TInputImage::ImageDimension;
 
     double range = m_Range;
-    double minimumSpacing = 1;
-    typename TInputImage::SizeType regionSize;
-    int offset = std::ceil(range / minimumSpacing);
-    regionSize.Fill(1);
-    for (unsigned int i = 0; i <  TInputImage::ImageDimension; ++i)
+    SizeType regionSize;
+    for (unsigned int i = 0; i < dimension; ++i)
     {
-      minimumSpacing = itkImage->GetSpacing()[i];
-      offset = std::ceil(range / minimumSpacing);
-      regionSize[i] = offset;
+      regionSize[i] = std::ceil(range / itkImage->GetSpacing()[i]);
     }
 
-    itk::ConstNeighborhoodIterator<TInputImage> iter(regionSize, itkImage, outputRegionForThread);
-    itk::ConstNeighborhoodIterator<MaskImageType> iterMask(regionSize, itkMask, outputRegionForThread);
+    // The peak is the mean of all voxels of the image that are closer than range (in mm) to the center.
+    // Every line of this sphere is a contiguous segment along dimension 0, so the sum of each segment is
+    // moved along the lines of the image: the voxel entering and the voxel leaving the segment are
+    // updated at each step. The sphere is determined exactly as with the neighborhood iterator before.
+    struct Segment
+    {
+      OffsetType LineOffset;
+      OffsetValueType Begin;
+      OffsetValueType End;
+    };
+    std::vector<Segment> segments;
+    {
+      Neighborhood<PixelType, TInputImage::ImageDimension> hood;
+      hood.SetRadius(regionSize);
+      typename TInputImage::PointType origin;
+      typename TInputImage::PointType localPoint;
+      const IndexType center = outputRegionForThread.GetIndex();
+      itkImage->TransformIndexToPhysicalPoint(center, origin);
+      bool previousIsInRange = false;
+      for (SizeValueType i = 0; i < hood.Size(); ++i)
+      {
+        const OffsetType offset = hood.GetOffset(i);
+        itkImage->TransformIndexToPhysicalPoint(center + offset, localPoint);
+        const bool isInRange = origin.EuclideanDistanceTo(localPoint) < range;
+        const bool isLineStart = offset[0] == -static_cast<OffsetValueType>(regionSize[0]);
+        if (isInRange && previousIsInRange && !isLineStart)
+        {
+          segments.back().End = offset[0];
+        }
+        else if (isInRange)
+        {
+          Segment segment;
+          segment.LineOffset = offset;
+          segment.LineOffset[0] = 0;
+          segment.Begin = offset[0];
+          segment.End = offset[0];
+          segments.push_back(segment);
+        }
+        previousIsInRange = isInRange;
+      }
+    }
 
-    typename TInputImage::PointType origin;
-    typename TInputImage::PointType localPoint;
-    itk::Index<TInputImage::ImageDimension> index;
+    const RegionType imageRegion = itkImage->GetLargestPossibleRegion();
+    const IndexValueType imageBegin = imageRegion.GetIndex(0);
+    const IndexValueType imageEnd = imageBegin + static_cast<IndexValueType>(imageRegion.GetSize(0));
+    const PixelType *imageBuffer = itkImage->GetBufferPointer();
+    const typename MaskImageType::PixelType *maskBuffer = itkMask->GetBufferPointer();
 
-    double tmpPeakValue;
     double globalPeakValue = std::numeric_limits<double>::lowest();
     double localPeakValue = std::numeric_limits<double>::lowest();
     PixelType localMaximum = std::numeric_limits<PixelType>::lowest();
 
-    std::vector<bool> vectorIsInRange;
-    index = iter.GetIndex();
-    itkImage->TransformIndexToPhysicalPoint(index, origin);
-    for (itk::SizeValueType i = 0; i < iter.Size(); ++i)
+    // Segments of the current line that lie within the image, given by the buffer offset of the voxel with index 0 in dimension 0
+    std::vector<OffsetValueType> lineOffsets;
+    std::vector<const Segment *> lineSegments;
+
+    const IndexValueType lineBegin = outputRegionForThread.GetIndex(0);
+    const IndexValueType lineEnd = lineBegin + static_cast<IndexValueType>(outputRegionForThread.GetSize(0));
+    SlidingWindow::ForEachLine(outputRegionForThread, [&](IndexType lineIndex)
     {
-      itkImage->TransformIndexToPhysicalPoint(iter.GetIndex(i), localPoint);
-      double dist = origin.EuclideanDistanceTo(localPoint);
-      vectorIsInRange.push_back((dist < range));
-    }
+      const OffsetValueType imageLineOffset = itkImage->ComputeOffset(lineIndex) - lineBegin;
+      const OffsetValueType maskLineOffset = itkMask->ComputeOffset(lineIndex) - lineBegin;
+      bool lineIsMasked = false;
+      for (IndexValueType x = lineBegin; x < lineEnd && !lineIsMasked; ++x)
+      {
+        lineIsMasked = maskBuffer[maskLineOffset + x] > 0;
+      }
+      if (!lineIsMasked)
+      {
+        return;
+      }
 
-    int count = 0;
+      lineOffsets.clear();
+      lineSegments.clear();
+      for (const auto &segment : segments)
+      {
+        IndexType index = lineIndex + segment.LineOffset;
+        index[0] = imageBegin;
+        if (imageRegion.IsInside(index))
+        {
+          lineOffsets.push_back(itkImage->ComputeOffset(index) - imageBegin);
+          lineSegments.push_back(&segment);
+        }
+      }
 
-    iter.NeedToUseBoundaryConditionOff();
-    iterMask.NeedToUseBoundaryConditionOff();
+      // Sums of the voxels (without NaN) and the number of voxels and NaN values of the window
+      double sum = 0;
+      long count = 0;
+      long numberOfNaN = 0;
+      auto addVoxel = [&](OffsetValueType lineOffset, IndexValueType x, int sign)
+      {
+        if (x < imageBegin || x >= imageEnd)
+        {
+          return;
+        }
+        const double value = imageBuffer[lineOffset + x];
+        count += sign;
+        if (value != value)
+        {
+          numberOfNaN += sign;
+        }
+        else
+        {
+          sum += sign * value;
+        }
+      };
 
-    auto imageSize = itkImage->GetLargestPossibleRegion().GetSize();
-    unsigned int imageDimension = itkImage->GetImageDimension();
+      for (std::size_t s = 0; s < lineSegments.size(); ++s)
+      {
+        for (IndexValueType x = lineBegin + lineSegments[s]->Begin; x <= lineBegin + lineSegments[s]->End; ++x)
+        {
+          addVoxel(lineOffsets[s], x, 1);
+        }
+      }
 
-    while (!iter.IsAtEnd())
-    {
-      if (iterMask.GetCenterPixel() > 0)
+      for (IndexValueType x = lineBegin; x < lineEnd; ++x)
       {
-        tmpPeakValue = 0;
-        count = 0;
-        for (itk::SizeValueType i = 0; i < iter.Size(); ++i)
+        if (x > lineBegin)
         {
-          if (vectorIsInRange[i])
+          for (std::size_t s = 0; s < lineSegments.size(); ++s)
           {
-            auto localIndex = iter.GetIndex(i);
-            bool calculatePoint = true;
-            for (unsigned int dimension = 0; dimension < imageDimension; ++dimension)
-            {
-              calculatePoint &= (localIndex[dimension] < static_cast<signed int>(imageSize[dimension]));
-              calculatePoint &= (0 <= localIndex[dimension]);
-            }
-            if (calculatePoint)
-            {
-              tmpPeakValue += iter.GetPixel(i);
-              ++count;
-            }
+            addVoxel(lineOffsets[s], x - 1 + lineSegments[s]->Begin, -1);
+            addVoxel(lineOffsets[s], x + lineSegments[s]->End, 1);
           }
         }
-        tmpPeakValue /= count;
-        globalPeakValue = std::max<double>(tmpPeakValue, globalPeakValue);
-        auto currentCenterPixelValue = iter.GetCenterPixel();
-        if (localMaximum == currentCenterPixelValue)
-        {
-          localPeakValue = std::max<double>(tmpPeakValue, localPeakValue);
-        }
-        else if (localMaximum < currentCenterPixelValue)
+
+        if (maskBuffer[maskLineOffset + x] > 0)
         {
-          localMaximum = currentCenterPixelValue;
-          localPeakValue = tmpPeakValue;
+          double tmpPeakValue = (numberOfNaN > 0) ? std::numeric_limits<double>::quiet_NaN() : sum;
+          tmpPeakValue /= count;
+          globalPeakValue = std::max<double>(tmpPeakValue, globalPeakValue);
+          auto currentCenterPixelValue = imageBuffer[imageLineOffset + x];
+          if (localMaximum == currentCenterPixelValue)
+          {
+            localPeakValue = std::max<double>(tmpPeakValue, localPeakValue);
+          }
+          else if (localMaximum < currentCenterPixelValue)
+          {
+            localMaximum = currentCenterPixelValue;
+            localPeakValue = tmpPeakValue;
+          }
         }
       }
-      ++iterMask;
-      ++iter;
-    }
+    });
 
     m_ThreadLocalMaximum[threadId] = localMaximum;
     m_ThreadLocalPeakValue[threadId] = localPeakValue;
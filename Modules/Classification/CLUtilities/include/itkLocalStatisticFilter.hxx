@@ -2,13 +2,13 @@
 #define itkLocalStatisticFilter_cpp
 
 #include <itkLocalStatisticFilter.h>
+#include <itkSlidingWindowHelper.h>
 
-#include <itkNeighborhoodIterator.h>
-#include <itkImageRegionIterator.h>
-#include <itkImageIterator.h>
-#include "itkMinimumMaximumImageCalculator.h"
-
+#include <algorithm>
+#include <cmath>
+#include <deque>
 #include <limits>
+#include <vector>
 
 template< class TInputImageType, class TOuputImageType>
 itk::LocalStatisticFilter<TInputImageType, TOuputImageType>::LocalStatisticFilter():
@@ -38,8 +38,7 @@ template< class TInputImageType, class TOuputImageType>
 void
 itk::LocalStatisticFilter<TInputImageType, TOuputImageType>::ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread, ThreadIdType /*threadId*/)
 {
-  typedef itk::ImageRegionIterator<TInputImageType> IteratorType;
-  typedef itk::ConstNeighborhoodIterator<TInputImageType> ConstIteratorType;
+  typedef typename TOuputImageType::PixelType OutputPixelType;
 
   typename TInputImageType::SizeType size; size.Fill(m_Size);
   InputImagePointer input = this->GetInput(0);
@@ -49,48 +48,108 @@ itk::LocalStatisticFilter<TInputImageType, TOuputImageType>::ThreadedGenerateDat
     size[2] = 0;
   }
 
-//  MITK_INFO << "Creating output iterator";
-  std::vector<IteratorType> iterVector;
+  const auto *inputBuffer = input->GetBufferPointer();
+  const auto bufferedRegion = input->GetBufferedRegion();
+  const IndexValueType bufferedStart = bufferedRegion.GetIndex(0);
+  const SizeValueType bufferedSize = bufferedRegion.GetSize(0);
+  const IndexValueType radius = m_Size;
+  const IndexValueType windowWidth = 2 * radius + 1;
+
+  std::vector<TOuputImageType*> outputs;
   for (int i = 0; i < m_Bins; ++i)
   {
-    IteratorType iter(this->GetOutput(i), outputRegionForThread);
-    iterVector.push_back(iter);
+    outputs.push_back(this->GetOutput(i));
   }
 
-  ConstIteratorType inputIter(size, input, outputRegionForThread);
-  while (!inputIter.IsAtEnd())
+  // Statistics of every face (all voxels of the window with the same x index) are computed once per line.
+  // The window statistics are then updated with the entering and leaving face, minimum and maximum with
+  // monotonic queues of the face minima / maxima.
+  std::vector<double> faceMinimum, faceMaximum, faceSum, faceSquaredSum;
+  std::deque<IndexValueType> minimumQueue, maximumQueue;
+
+  SlidingWindow::ForEachLine(outputRegionForThread, [&](const typename TInputImageType::IndexType &lineIndex)
   {
-    for (int i = 0; i < m_Bins; ++i)
+    const auto lineOffsets = SlidingWindow::ComputeFaceLineOffsets(input.GetPointer(), lineIndex, size);
+    const double numberOfVoxels = static_cast<double>(lineOffsets.size() * windowWidth);
+
+    const IndexValueType firstX = lineIndex[0];
+    const IndexValueType lineLength = static_cast<IndexValueType>(outputRegionForThread.GetSize(0));
+
+    // Face k belongs to index firstX - radius + k
+    const IndexValueType numberOfFaces = lineLength + 2 * radius;
+    faceMinimum.assign(numberOfFaces, std::numeric_limits<double>::max());
+    faceMaximum.assign(numberOfFaces, std::numeric_limits<double>::lowest());
+    faceSum.assign(numberOfFaces, 0.0);
+    faceSquaredSum.assign(numberOfFaces, 0.0);
+    for (IndexValueType k = 0; k < numberOfFaces; ++k)
     {
-      iterVector[i].Set(0);
+      const auto column = SlidingWindow::Clamp(firstX - radius + k, bufferedStart, bufferedSize) - bufferedStart;
+      for (const auto lineOffset : lineOffsets)
+      {
+        const double value = inputBuffer[lineOffset + column];
+        faceMinimum[k] = std::min<double>(faceMinimum[k], value);
+        faceMaximum[k] = std::max<double>(faceMaximum[k], value);
+        faceSum[k] += value;
+        faceSquaredSum[k] += value * value;
+      }
     }
 
-    double min = std::numeric_limits<double>::max();
-    double max = std::numeric_limits<double>::lowest();
-    double mean = 0;
-    double std = 0;
-
-    for (unsigned int i = 0; i < inputIter.Size(); ++i)
+    std::vector<OutputPixelType*> outputPixels;
+    for (auto output : outputs)
     {
-      double value = inputIter.GetPixel(i);
-      min = std::min<double>(min, value);
-      max = std::max<double>(max, value);
-      mean += value / inputIter.Size();
-      std += (value*value) / inputIter.Size();
+      outputPixels.push_back(output->GetBufferPointer() + output->ComputeOffset(lineIndex));
     }
 
-    iterVector[0].Value() = min;
-    iterVector[1].Value() = max;
-    iterVector[2].Value() = mean;
-    iterVector[3].Value() = std::sqrt(std - mean*mean);
-    iterVector[4].Value() = max-min;
-
-    for (int i = 0; i < m_Bins; ++i)
+    minimumQueue.clear();
+    maximumQueue.clear();
+    double sum = 0;
+    double squaredSum = 0;
+    for (IndexValueType k = 0; k < numberOfFaces; ++k)
     {
-      ++(iterVector[i]);
+      while (!minimumQueue.empty() && faceMinimum[minimumQueue.back()] >= faceMinimum[k])
+      {
+        minimumQueue.pop_back();
+      }
+      minimumQueue.push_back(k);
+      while (!maximumQueue.empty() && faceMaximum[maximumQueue.back()] <= faceMaximum[k])
+      {
+        maximumQueue.pop_back();
+      }
+      maximumQueue.push_back(k);
+      sum += faceSum[k];
+      squaredSum += faceSquaredSum[k];
+
+      if (k + 1 < windowWidth)
+      {
+        continue;
+      }
+
+      // The window of the current voxel consists of the faces k - windowWidth + 1 ... k
+      const IndexValueType firstFace = k - windowWidth + 1;
+      if (minimumQueue.front() < firstFace)
+      {
+        minimumQueue.pop_front();
+      }
+      if (maximumQueue.front() < firstFace)
+      {
+        maximumQueue.pop_front();
+      }
+
+      const double min = faceMinimum[minimumQueue.front()];
+      const double max = faceMaximum[maximumQueue.front()];
+      const double mean = sum / numberOfVoxels;
+      const double variance = std::max(0.0, squaredSum / numberOfVoxels - mean * mean);
+
+      *(outputPixels[0]++) = min;
+      *(outputPixels[1]++) = max;
+      *(outputPixels[2]++) = mean;
+      *(outputPixels[3]++) = std::sqrt(variance);
+      *(outputPixels[4]++) = max - min;
+
+      sum -= faceSum[firstFace];
+      squaredSum -= faceSquaredSum[firstFace];
     }
-    ++inputIter;
-  }
+  });
 }
 
 template< class TInputImageType, class TOuputImageType>
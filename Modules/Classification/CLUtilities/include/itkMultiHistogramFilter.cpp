@@ -14,12 +14,13 @@ found in the LICENSE file.
 #define itkMultiHistogramFilter_cpp
 
 #include <itkMultiHistogramFilter.h>
+#include <itkSlidingWindowHelper.h>
 
-#include <itkNeighborhoodIterator.h>
-#include <itkImageRegionIterator.h>
-#include <itkImageIterator.h>
 #include "itkMinimumMaximumImageCalculator.h"
 
+#include <algorithm>
+#include <vector>
+
 template< class TInputImageType, class TOuputImageType>
 itk::MultiHistogramFilter<TInputImageType, TOuputImageType>::MultiHistogramFilter():
 m_Delta(0.6), m_Offset(-3.0), m_Bins(11), m_Size(5), m_UseImageIntensityRange(false)
@@ -61,47 +62,76 @@ template< class TInputImageType, class TOuputImageType>
 void
 itk::MultiHistogramFilter<TInputImageType, TOuputImageType>::ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread, ThreadIdType /*threadId*/)
 {
-  double offset = m_Offset;// -3.0;
-  double delta = m_Delta;// 0.6;
+  typedef typename TOuputImageType::PixelType OutputPixelType;
 
-  typedef itk::ImageRegionIterator<TInputImageType> IteratorType;
-  typedef itk::ConstNeighborhoodIterator<TInputImageType> ConstIteratorType;
+  const double offset = m_Offset;
+  const double delta = m_Delta;
+  const int bins = m_Bins;
+  auto binOfValue = [offset, delta, bins](double value)
+  {
+    value -= offset;
+    value /= delta;
+    auto pos = (int)(value);
+    return std::max(0, std::min(bins - 1, pos));
+  };
 
   typename TInputImageType::SizeType size; size.Fill(m_Size);
   InputImagePointer input = this->GetInput(0);
+  const auto *inputBuffer = input->GetBufferPointer();
+  const auto bufferedRegion = input->GetBufferedRegion();
+  const IndexValueType bufferedStart = bufferedRegion.GetIndex(0);
+  const SizeValueType bufferedSize = bufferedRegion.GetSize(0);
+  const IndexValueType radius = m_Size;
 
-//  MITK_INFO << "Creating output iterator";
-  std::vector<IteratorType> iterVector;
+  std::vector<TOuputImageType*> outputs;
   for (int i = 0; i < m_Bins; ++i)
   {
-    IteratorType iter(this->GetOutput(i), outputRegionForThread);
-    iterVector.push_back(iter);
+    outputs.push_back(this->GetOutput(i));
   }
 
-  ConstIteratorType inputIter(size, input, outputRegionForThread);
-  while (!inputIter.IsAtEnd())
+  // The histogram of the window is updated with the face that enters and the face that leaves
+  // while the window moves along a line, instead of counting the whole window at every voxel.
+  std::vector<long> histogram(m_Bins);
+  SlidingWindow::ForEachLine(outputRegionForThread, [&](const typename TInputImageType::IndexType &lineIndex)
   {
-    for (int i = 0; i < m_Bins; ++i)
+    const auto lineOffsets = SlidingWindow::ComputeFaceLineOffsets(input.GetPointer(), lineIndex, size);
+    auto addFace = [&](IndexValueType x, int sign)
     {
-      iterVector[i].Set(0);
+      const auto column = SlidingWindow::Clamp(x, bufferedStart, bufferedSize) - bufferedStart;
+      for (const auto lineOffset : lineOffsets)
+      {
+        histogram[binOfValue(inputBuffer[lineOffset + column])] += sign;
+      }
+    };
+
+    const IndexValueType firstX = lineIndex[0];
+    const IndexValueType lastX = firstX + static_cast<IndexValueType>(outputRegionForThread.GetSize(0)) - 1;
+
+    std::fill(histogram.begin(), histogram.end(), 0);
+    for (IndexValueType x = firstX - radius; x <= firstX + radius; ++x)
+    {
+      addFace(x, 1);
     }
 
-    for (unsigned int i = 0; i < inputIter.Size(); ++i)
+    std::vector<OutputPixelType*> outputPixels;
+    for (auto output : outputs)
     {
-      double value = inputIter.GetPixel(i);
-      value -=  offset;
-      value /= delta;
-      auto pos = (int)(value);
-      pos = std::max(0, std::min(m_Bins-1, pos));
-      iterVector[pos].Value() += 1;// (iterVector[pos].GetCenterPixel() + 1);
+      outputPixels.push_back(output->GetBufferPointer() + output->ComputeOffset(lineIndex));
     }
 
-    for (int i = 0; i < m_Bins; ++i)
+    for (IndexValueType x = firstX; x <= lastX; ++x)
     {
-      ++(iterVector[i]);
+      for (int i = 0; i < m_Bins; ++i)
+      {
+        *(outputPixels[i]++) = static_cast<OutputPixelType>(histogram[i]);
+      }
+      if (x < lastX)
+      {
+        addFace(x - radius, -1);
+        addFace(x + radius + 1, 1);
+      }
     }
-    ++inputIter;
-  }
+  });
 }
 
 template< class TInputImageType, class TOuputImageType>
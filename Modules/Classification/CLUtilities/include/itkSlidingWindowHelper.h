@@ -0,0 +1,116 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef itkSlidingWindowHelper_h
+#define itkSlidingWindowHelper_h
+
+#include <itkImageRegion.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace itk
+{
+  /**
+  * \brief Helper functions for filters that move a rectangular window along the lines (dimension 0) of an image.
+  *
+  * Instead of visiting the whole neighbourhood at every voxel, these filters update their statistics with the
+  * face of the window that enters and the face that leaves as the window moves by one voxel. A face is the set of
+  * voxels of the window with the same index in dimension 0; it consists of one voxel on each of a fixed set of
+  * image lines, which is computed once per line by ComputeFaceLineOffsets().
+  *
+  * Indices outside of the buffered region are clamped to the closest voxel, which is identical to the
+  * ZeroFluxNeumannBoundaryCondition used by default by the neighborhood iterators.
+  */
+  namespace SlidingWindow
+  {
+    inline IndexValueType Clamp(IndexValueType index, IndexValueType start, SizeValueType size)
+    {
+      return std::min<IndexValueType>(std::max<IndexValueType>(index, start), start + static_cast<IndexValueType>(size) - 1);
+    }
+
+    /**
+    * \brief Returns the buffer offsets of the first buffered voxel of all lines that intersect the window
+    * centered at lineIndex. The value of the face at index x (clamped) is found at offset + x - bufferedStart[0].
+    */
+    template <typename TImage>
+    std::vector<OffsetValueType> ComputeFaceLineOffsets(const TImage *image, const typename TImage::IndexType &lineIndex, const typename TImage::SizeType &radius)
+    {
+      const unsigned int dimension = TImage::ImageDimension;
+      const auto bufferedRegion = image->GetBufferedRegion();
+
+      std::vector<OffsetValueType> lineOffsets;
+      typename TImage::OffsetType faceOffset;
+      faceOffset.Fill(0);
+      for (unsigned int d = 1; d < dimension; ++d)
+      {
+        faceOffset[d] = -static_cast<OffsetValueType>(radius[d]);
+      }
+
+      bool finished = false;
+      while (!finished)
+      {
+        typename TImage::IndexType index;
+        index[0] = bufferedRegion.GetIndex(0);
+        for (unsigned int d = 1; d < dimension; ++d)
+        {
+          index[d] = Clamp(lineIndex[d] + faceOffset[d], bufferedRegion.GetIndex(d), bufferedRegion.GetSize(d));
+        }
+        lineOffsets.push_back(image->ComputeOffset(index));
+
+        finished = true;
+        for (unsigned int d = 1; d < dimension; ++d)
+        {
+          if (faceOffset[d] < static_cast<OffsetValueType>(radius[d]))
+          {
+            ++faceOffset[d];
+            finished = false;
+            break;
+          }
+          faceOffset[d] = -static_cast<OffsetValueType>(radius[d]);
+        }
+      }
+      return lineOffsets;
+    }
+
+    /** Calls function(lineIndex) with the first index of every line (dimension 0) of the region.*/
+    template <unsigned int VDimension, typename TFunction>
+    void ForEachLine(const ImageRegion<VDimension> &region, TFunction function)
+    {
+      if (region.GetNumberOfPixels() == 0)
+      {
+        return;
+      }
+
+      auto lineIndex = region.GetIndex();
+      bool finished = false;
+      while (!finished)
+      {
+        function(lineIndex);
+
+        finished = true;
+        for (unsigned int d = 1; d < VDimension; ++d)
+        {
+          if (lineIndex[d] + 1 < region.GetIndex(d) + static_cast<IndexValueType>(region.GetSize(d)))
+          {
+            ++lineIndex[d];
+            finished = false;
+            break;
+          }
+          lineIndex[d] = region.GetIndex(d);
+        }
+      }
+    }
+  }
+}
+
+#endif // itkSlidingWindowHelper_h
@@ -0,0 +1,101 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef mitkCLResultStreamWriter_h
+#define mitkCLResultStreamWriter_h
+
+#include "MitkCLUtilitiesExports.h"
+
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <mitkAbstractGlobalImageFeature.h>
+
+namespace mitk
+{
+  namespace cl
+  {
+    /**
+    * \brief Writes the features of a cohort case by case, as soon as a case is finished.
+    *
+    * In contrast to FeatureResultWritter, which keeps all results in memory until it is destroyed, every
+    * case is written and flushed immediately. AddCase() may be called from several threads; the rows
+    * appear in the order in which the cases are finished.
+    *
+    * Two layouts are supported:
+    * - WideLayout: one row per case. The feature columns are defined by the first successful case,
+    *   features of later cases are assigned by their name.
+    * - LongLayout: one row per case and feature (Case;Image;Mask;Status;...;Feature;Value), which can be
+    *   loaded directly by column oriented tools.
+    *
+    * If the output file already contains results, new rows are appended and the existing header is reused.
+    */
+    class MITKCLUTILITIES_EXPORT FeatureResultStreamWriter
+    {
+    public:
+      enum Layout
+      {
+        WideLayout,
+        LongLayout
+      };
+
+      struct CaseResult
+      {
+        std::string CaseId;
+        std::string ImagePath;
+        std::string MaskPath;
+        bool Succeeded = false;
+        std::string Message;
+        /** Time for loading and preprocessing in milliseconds*/
+        double LoadTime = 0.0;
+        /** Time for the feature calculation in milliseconds*/
+        double CalculationTime = 0.0;
+        mitk::AbstractGlobalImageFeature::FeatureListType Features;
+      };
+
+      FeatureResultStreamWriter(const std::string &file, Layout layout);
+      ~FeatureResultStreamWriter();
+
+      void SetDecimalPoint(char decimal);
+
+      /** Writes the result of one case. Thread-safe.*/
+      void AddCase(const CaseResult &result);
+
+      std::size_t GetNumberOfWrittenCases() const;
+
+    private:
+      void ReadExistingHeader(const std::string &file);
+      void WriteHeader();
+      void WriteWideRow(const CaseResult &result);
+      void WriteLongRows(const CaseResult &result);
+      void WriteCaseInformation(const CaseResult &result);
+      std::string ToString(double value) const;
+
+      Layout m_Layout;
+      std::string m_Separator;
+      std::ofstream m_Output;
+      bool m_HeaderWritten;
+      std::vector<std::string> m_FeatureNames;
+      std::unordered_map<std::string, std::size_t> m_FeatureColumns;
+      std::vector<CaseResult> m_PendingResults;
+      std::size_t m_NumberOfWrittenCases;
+      bool m_UseSpecialDecimalPoint;
+      char m_DecimalPoint;
+      mutable std::mutex m_Mutex;
+    };
+  }
+}
+
+#endif //mitkCLResultStreamWriter_h
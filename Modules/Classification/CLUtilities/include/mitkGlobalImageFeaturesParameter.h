@@ -28,6 +28,11 @@ namespace mitk
       void AddParameter(mitkCommandLineParser &parser);
       void ParseParameter(std::map<std::string, us::Any> parsedArgs);
 
+      /** Adds / parses only the parameters that control the mask adaptation and the global feature settings,
+      * without the input and output files. Used by applications that process several images.*/
+      void AddFeatureParameter(mitkCommandLineParser &parser);
+      void ParseFeatureParameter(std::map<std::string, us::Any> parsedArgs);
+
       std::string imagePath;
       std::string imageName;
       std::string imageFolder;
@@ -0,0 +1,35 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef mitkGlobalImageFeaturesPreprocessing_h
+#define mitkGlobalImageFeaturesPreprocessing_h
+
+#include "MitkCLUtilitiesExports.h"
+
+#include <mitkImage.h>
+
+namespace mitk
+{
+  namespace cl
+  {
+    /** Resamples the image to an isotropic spacing of resolution mm (linear interpolation).*/
+    void MITKCLUTILITIES_EXPORT ResampleImageToIsotropicResolution(mitk::Image::Pointer image, double resolution, mitk::Image::Pointer &newImage);
+
+    /** Resamples the mask to the geometry of the reference image (nearest neighbour interpolation).*/
+    void MITKCLUTILITIES_EXPORT ResampleMaskToReference(mitk::Image::Pointer mask, mitk::Image::Pointer reference, mitk::Image::Pointer &newMask);
+
+    /** Creates a copy of the mask (unsigned short) that excludes all voxels with a NaN intensity in the image.*/
+    void MITKCLUTILITIES_EXPORT CreateNoNaNMask(mitk::Image::Pointer image, mitk::Image::Pointer mask, mitk::Image::Pointer &newMask);
+  }
+}
+
+#endif //mitkGlobalImageFeaturesPreprocessing_h
@@ -13,14 +13,7 @@ found in the LICENSE file.
 #include <mitkGIFCooccurenceMatrix2.h>
 
 // MITK
-#include <mitkITKImageImport.h>
-#include <mitkImageCast.h>
-#include <mitkImageAccessByItk.h>
-
-// ITK
-#include <itkEnhancedScalarImageToTextureFeaturesFilter.h>
-#include <itkShapedNeighborhoodIterator.h>
-#include <itkImageRegionConstIterator.h>
+#include <mitkTextureMatrixEngine.h>
 
 // STL
 #include <sstream>
@@ -163,56 +156,6 @@ double mitk::CoocurenceMatrixHolder::IndexToMaxIntensity(int index)
   return m_MinimumRange + (index + 1) * m_Stepsize;
 }
 
-template<typename TPixel, unsigned int VImageDimension>
-void
-CalculateCoOcMatrix(itk::Image<TPixel, VImageDimension>* itkImage,
-                    itk::Image<unsigned short, VImageDimension>* mask,
-                    itk::Offset<VImageDimension> offset,
-                    int range,
-                    mitk::CoocurenceMatrixHolder &holder)
-{
-  typedef itk::Image<TPixel, VImageDimension> ImageType;
-  typedef itk::Image<unsigned short, VImageDimension> MaskImageType;
-  typedef itk::ShapedNeighborhoodIterator<ImageType> ShapeIterType;
-  typedef itk::ShapedNeighborhoodIterator<MaskImageType> ShapeMaskIterType;
-  typedef itk::ImageRegionConstIterator<ImageType> ConstIterType;
-  typedef itk::ImageRegionConstIterator<MaskImageType> ConstMaskIterType;
-
-
-  itk::Size<VImageDimension> radius;
-  radius.Fill(range+1);
-  ShapeIterType imageOffsetIter(radius, itkImage, itkImage->GetLargestPossibleRegion());
-  ShapeMaskIterType maskOffsetIter(radius, mask, mask->GetLargestPossibleRegion());
-  imageOffsetIter.ActivateOffset(offset);
-  maskOffsetIter.ActivateOffset(offset);
-  ConstIterType imageIter(itkImage, itkImage->GetLargestPossibleRegion());
-  ConstMaskIterType maskIter(mask, mask->GetLargestPossibleRegion());
-  //  iterator.GetIndex() + ci.GetNeighborhoodOffset()
-  auto region = mask->GetLargestPossibleRegion();
-
-
-  while (!maskIter.IsAtEnd())
-  {
-    auto ciMask = maskOffsetIter.Begin();
-    auto ciValue = imageOffsetIter.Begin();
-    if (maskIter.Value() > 0 &&
-      ciMask.Get() > 0 &&
-      imageIter.Get() == imageIter.Get() &&
-      ciValue.Get() == ciValue.Get() &&
-      region.IsInside(maskOffsetIter.GetIndex() + ciMask.GetNeighborhoodOffset()))
-    {
-      int i = holder.IntensityToIndex(imageIter.Get());
-      int j = holder.IntensityToIndex(ciValue.Get());
-      holder.m_Matrix(i, j) += 1;
-      holder.m_Matrix(j, i) += 1;
-    }
-    ++imageOffsetIter;
-    ++maskOffsetIter;
-    ++imageIter;
-    ++maskIter;
-  }
-}
-
 void CalculateFeatures(
   mitk::CoocurenceMatrixHolder &holder,
   mitk::CoocurenceMatrixFeatures & results
@@ -373,35 +316,32 @@ void CalculateFeatures(
 
 }
 
-template<typename TPixel, unsigned int VImageDimension>
-void
-CalculateCoocurenceFeatures(itk::Image<TPixel, VImageDimension>* itkImage, mitk::Image::Pointer mask, mitk::GIFCooccurenceMatrix2::FeatureListType & featureList, mitk::GIFCooccurenceMatrix2::GIFCooccurenceMatrix2Configuration config)
+static void
+CalculateCoocurenceFeatures(mitk::TextureMatrixEngine* engine, const mitk::TextureMatrixEngine::QuantizedImageConstPointer &quantizedImage, mitk::GIFCooccurenceMatrix2::FeatureListType & featureList, mitk::GIFCooccurenceMatrix2::GIFCooccurenceMatrix2Configuration config)
 {
-  typedef itk::Image<unsigned short, VImageDimension> MaskType;
-  typedef itk::Neighborhood<TPixel, VImageDimension > NeighborhoodType;
-  typedef itk::Offset<VImageDimension> OffsetType;
+  typedef mitk::TextureMatrixEngine::OffsetType OffsetType;
 
   ///////////////////////////////////////////////////////////////////////////////////////////////
   double rangeMin = config.MinimumIntensity;
   double rangeMax = config.MaximumIntensity;
   int numberOfBins = config.Bins;
+  unsigned int dimension = quantizedImage->Dimension;
 
-  typename MaskType::Pointer maskImage = MaskType::New();
-  mitk::CastToItkImage(mask, maskImage);
-
-  //Find possible directions
-  std::vector < itk::Offset<VImageDimension> > offsetVector;
-  NeighborhoodType hood;
-  hood.SetRadius(1);
-  unsigned int        centerIndex = hood.GetCenterNeighborhoodIndex();
-  OffsetType          offset;
+  //Find possible directions, i.e. the first half of a neighbourhood
+  //with radius 1 (in the order of itk::Neighborhood)
+  mitk::TextureMatrixEngine::OffsetVectorType offsetVector;
+  unsigned int centerIndex = static_cast<unsigned int>(std::pow(3, dimension)) / 2;
+  OffsetType offset;
   for (unsigned int d = 0; d < centerIndex; d++)
   {
-    offset = hood.GetOffset(d);
+    offset.Fill(0);
     bool useOffset = true;
-    for (unsigned int i = 0; i < VImageDimension; ++i)
+    unsigned int remainder = d;
+    for (unsigned int i = 0; i < dimension; ++i)
     {
-      offset[i] *= config.range;
+      long hoodOffset = static_cast<long>(remainder % 3) - 1;
+      remainder /= 3;
+      offset[i] = static_cast<long>(hoodOffset * config.range);
       if (config.direction == i + 2 && offset[i] != 0)
       {
         useOffset = false;
@@ -418,26 +358,20 @@ CalculateCoocurenceFeatures(itk::Image<TPixel, VImageDimension>* itkImage, mitk:
     offset[0] = 0;
     offset[1] = 0;
     offset[2] = 1;
+    offsetVector.push_back(offset);
   }
 
+  // All offsets are accumulated in one traversal of the quantized image
+  auto matrices = engine->GetCooccurrenceMatrices(quantizedImage, offsetVector);
+
   std::vector<mitk::CoocurenceMatrixFeatures> resultVector;
   mitk::CoocurenceMatrixHolder holderOverall(rangeMin, rangeMax, numberOfBins);
   mitk::CoocurenceMatrixFeatures overallFeature;
-  for (std::size_t i = 0; i < offsetVector.size(); ++i)
+  for (std::size_t i = 0; i < matrices.size(); ++i)
   {
-    if (config.direction > 1)
-    {
-      if (offsetVector[i][config.direction - 2] != 0)
-      {
-        continue;
-      }
-    }
-
-
-    offset = offsetVector[i];
     mitk::CoocurenceMatrixHolder holder(rangeMin, rangeMax, numberOfBins);
     mitk::CoocurenceMatrixFeatures coocResults;
-    CalculateCoOcMatrix<TPixel, VImageDimension>(itkImage, maskImage, offset, config.range, holder);
+    holder.m_Matrix = matrices[i];
     holderOverall.m_Matrix += holder.m_Matrix;
     CalculateFeatures(holder, coocResults);
     resultVector.push_back(coocResults);
@@ -641,7 +575,9 @@ mitk::GIFCooccurenceMatrix2::FeatureListType mitk::GIFCooccurenceMatrix2::Calcul
   config.Bins = GetQuantifier()->GetBins();
   config.prefix = FeatureDescriptionPrefix();
 
-  AccessByItk_3(image, CalculateCoocurenceFeatures, mask, featureList,config);
+  auto engine = GetTextureMatrixEngine();
+  auto quantizedImage = engine->GetQuantizedImage(image, mask, GetQuantifier());
+  CalculateCoocurenceFeatures(engine, quantizedImage, featureList, config);
 
   return featureList;
 }
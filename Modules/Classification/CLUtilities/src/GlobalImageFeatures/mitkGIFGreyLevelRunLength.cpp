@@ -13,206 +13,228 @@ found in the LICENSE file.
 #include <mitkGIFGreyLevelRunLength.h>
 
 // MITK
-#include <mitkITKImageImport.h>
-#include <mitkImageCast.h>
-#include <mitkImageAccessByItk.h>
-
-// ITK
-#include <itkEnhancedScalarImageToRunLengthFeaturesFilter.h>
+#include <mitkTextureMatrixEngine.h>
 
 // STL
+#include <algorithm>
+#include <cmath>
 #include <sstream>
 
-template<typename TPixel, unsigned int VImageDimension>
-void
-  CalculateGrayLevelRunLengthFeatures(itk::Image<TPixel, VImageDimension>* itkImage, mitk::Image::Pointer mask, mitk::GIFGreyLevelRunLength::FeatureListType & featureList, mitk::GIFGreyLevelRunLength::ParameterStruct params)
+namespace
 {
-  typedef itk::Image<TPixel, VImageDimension> ImageType;
-  typedef itk::Image<TPixel, VImageDimension> MaskType;
-  typedef itk::Statistics::EnhancedScalarImageToRunLengthFeaturesFilter<ImageType> FilterType;
-  typedef typename FilterType::RunLengthFeaturesFilterType TextureFilterType;
+  // Same order as the features of itk::Statistics::EnhancedHistogramToRunLengthFeaturesFilter
+  enum RunLengthFeature
+  {
+    ShortRunEmphasis,
+    LongRunEmphasis,
+    GreyLevelNonuniformity,
+    GreyLevelNonuniformityNormalized,
+    RunLengthNonuniformity,
+    RunLengthNonuniformityNormalized,
+    LowGreyLevelRunEmphasis,
+    HighGreyLevelRunEmphasis,
+    ShortRunLowGreyLevelEmphasis,
+    ShortRunHighGreyLevelEmphasis,
+    LongRunLowGreyLevelEmphasis,
+    LongRunHighGreyLevelEmphasis,
+    RunPercentage,
+    NumberOfRuns,
+    GreyLevelVariance,
+    RunLengthVariance,
+    RunEntropy,
+    NumberOfRunLengthFeatures
+  };
+  const char *RunLengthFeatureNames[] = {
+    "Short run emphasis",
+    "Long run emphasis",
+    "Grey level nonuniformity",
+    "Grey level nonuniformity normalized",
+    "Run length nonuniformity",
+    "Run length nonuniformity normalized",
+    "Low grey level run emphasis",
+    "High grey level run emphasis",
+    "Short run low grey level emphasis",
+    "Short run high grey level emphasis",
+    "Long run low grey level emphasis",
+    "Long run high grey level emphasis",
+    "Run percentage",
+    "Number of runs",
+    "Grey level variance",
+    "Run length variance",
+    "Run length entropy"
+  };
+
+  /** Bins the run lengths like the distance histogram of the former ITK filter: distances (length - 1) in [0, bins]
+  * with one column per distance, the largest distance shares the last column, longer runs are dropped.*/
+  Eigen::MatrixXd ToDistanceHistogram(const Eigen::MatrixXd &runLengthMatrix, int bins)
+  {
+    Eigen::MatrixXd histogram = Eigen::MatrixXd::Zero(runLengthMatrix.rows(), bins);
+    for (long column = 0; column < runLengthMatrix.cols() && column <= bins; ++column)
+    {
+      histogram.col(std::min<long>(column, bins - 1)) += runLengthMatrix.col(column);
+    }
+    return histogram;
+  }
 
-  typename MaskType::Pointer maskImage = MaskType::New();
-  mitk::CastToItkImage(mask, maskImage);
+  std::vector<double> CalculateRunLengthFeatures(const Eigen::MatrixXd &histogram, std::size_t numberOfVoxels)
+  {
+    std::vector<double> features(NumberOfRunLengthFeatures, 0);
+    const double numberOfRuns = histogram.sum();
+    features[NumberOfRuns] = numberOfRuns;
+    if (numberOfRuns <= 0)
+    {
+      return features;
+    }
 
-  typename FilterType::Pointer filter = FilterType::New();
-  typename FilterType::Pointer filter2 = FilterType::New();
+    double mu_i = 0;
+    double mu_j = 0;
+    for (long row = 0; row < histogram.rows(); ++row)
+    {
+      for (long column = 0; column < histogram.cols(); ++column)
+      {
+        const double p_ij = histogram(row, column) / numberOfRuns;
+        mu_i += (row + 1) * p_ij;
+        mu_j += (column + 1) * p_ij;
+      }
+    }
 
-  typename FilterType::OffsetVector::Pointer newOffset = FilterType::OffsetVector::New();
-  auto oldOffsets = filter->GetOffsets();
-  auto oldOffsetsIterator = oldOffsets->Begin();
-  while (oldOffsetsIterator != oldOffsets->End())
+    const double log2 = std::log(2.0);
+    double greyLevelVariance = 0;
+    double runLengthVariance = 0;
+    double runEntropy = 0;
+    double shortRunEmphasis = 0;
+    double longRunEmphasis = 0;
+    double lowGreyLevelRunEmphasis = 0;
+    double highGreyLevelRunEmphasis = 0;
+    double shortRunLowGreyLevelEmphasis = 0;
+    double shortRunHighGreyLevelEmphasis = 0;
+    double longRunLowGreyLevelEmphasis = 0;
+    double longRunHighGreyLevelEmphasis = 0;
+    for (long row = 0; row < histogram.rows(); ++row)
+    {
+      for (long column = 0; column < histogram.cols(); ++column)
+      {
+        const double frequency = histogram(row, column);
+        if (frequency == 0)
+        {
+          continue;
+        }
+        const double i = row + 1;
+        const double j = column + 1;
+        const double i2 = i * i;
+        const double j2 = j * j;
+        const double p_ij = frequency / numberOfRuns;
+
+        greyLevelVariance += (i - mu_i) * (i - mu_i) * p_ij;
+        runLengthVariance += (j - mu_j) * (j - mu_j) * p_ij;
+        runEntropy -= (p_ij > 0.0001) ? p_ij * std::log(p_ij) / log2 : 0;
+
+        shortRunEmphasis += frequency / j2;
+        longRunEmphasis += frequency * j2;
+        lowGreyLevelRunEmphasis += frequency / i2;
+        highGreyLevelRunEmphasis += frequency * i2;
+        shortRunLowGreyLevelEmphasis += frequency / (i2 * j2);
+        shortRunHighGreyLevelEmphasis += frequency * i2 / j2;
+        longRunLowGreyLevelEmphasis += frequency * j2 / i2;
+        longRunHighGreyLevelEmphasis += frequency * i2 * j2;
+      }
+    }
+    const double greyLevelNonuniformity = histogram.rowwise().sum().squaredNorm() / numberOfRuns;
+    const double runLengthNonuniformity = histogram.colwise().sum().squaredNorm() / numberOfRuns;
+
+    features[ShortRunEmphasis] = shortRunEmphasis / numberOfRuns;
+    features[LongRunEmphasis] = longRunEmphasis / numberOfRuns;
+    features[GreyLevelNonuniformity] = greyLevelNonuniformity;
+    features[GreyLevelNonuniformityNormalized] = greyLevelNonuniformity / numberOfRuns;
+    features[RunLengthNonuniformity] = runLengthNonuniformity;
+    features[RunLengthNonuniformityNormalized] = runLengthNonuniformity / numberOfRuns;
+    features[LowGreyLevelRunEmphasis] = lowGreyLevelRunEmphasis / numberOfRuns;
+    features[HighGreyLevelRunEmphasis] = highGreyLevelRunEmphasis / numberOfRuns;
+    features[ShortRunLowGreyLevelEmphasis] = shortRunLowGreyLevelEmphasis / numberOfRuns;
+    features[ShortRunHighGreyLevelEmphasis] = shortRunHighGreyLevelEmphasis / numberOfRuns;
+    features[LongRunLowGreyLevelEmphasis] = longRunLowGreyLevelEmphasis / numberOfRuns;
+    features[LongRunHighGreyLevelEmphasis] = longRunHighGreyLevelEmphasis / numberOfRuns;
+    features[RunPercentage] = numberOfRuns / numberOfVoxels;
+    features[GreyLevelVariance] = greyLevelVariance;
+    features[RunLengthVariance] = runLengthVariance;
+    features[RunEntropy] = runEntropy;
+    return features;
+  }
+}
+
+static void
+CalculateGrayLevelRunLengthFeatures(mitk::TextureMatrixEngine* engine, const mitk::TextureMatrixEngine::QuantizedImageConstPointer &quantizedImage, mitk::GIFGreyLevelRunLength::FeatureListType & featureList, mitk::GIFGreyLevelRunLength::ParameterStruct params)
+{
+  typedef mitk::TextureMatrixEngine::OffsetType OffsetType;
+
+  unsigned int dimension = quantizedImage->Dimension;
+
+  //Find possible directions, i.e. the first half of a neighbourhood
+  //with radius 1 (in the order of itk::Neighborhood)
+  mitk::TextureMatrixEngine::OffsetVectorType offsetVector;
+  unsigned int centerIndex = static_cast<unsigned int>(std::pow(3, dimension)) / 2;
+  OffsetType offset;
+  for (unsigned int d = 0; d < centerIndex; d++)
   {
-    bool continueOuterLoop = false;
-    typename FilterType::OffsetType offset = oldOffsetsIterator->Value();
-    for (unsigned int i = 0; i < VImageDimension; ++i)
+    offset.Fill(0);
+    bool useOffset = true;
+    unsigned int remainder = d;
+    for (unsigned int i = 0; i < dimension; ++i)
     {
+      offset[i] = static_cast<long>(remainder % 3) - 1;
+      remainder /= 3;
       if (params.m_Direction == i + 2 && offset[i] != 0)
       {
-        continueOuterLoop = true;
+        useOffset = false;
       }
     }
-    if (params.m_Direction == 1)
+    if (useOffset)
     {
-      offset[0] = 0;
-      offset[1] = 0;
-      offset[2] = 1;
-      newOffset->push_back(offset);
-      break;
+      offsetVector.push_back(offset);
     }
-
-    oldOffsetsIterator++;
-    if (continueOuterLoop)
-      continue;
-    newOffset->push_back(offset);
   }
-  filter->SetOffsets(newOffset);
-  filter2->SetOffsets(newOffset);
-
-
-  // All features are required
-  typename FilterType::FeatureNameVectorPointer requestedFeatures = FilterType::FeatureNameVector::New();
-  requestedFeatures->push_back(TextureFilterType::ShortRunEmphasis);
-  requestedFeatures->push_back(TextureFilterType::LongRunEmphasis);
-  requestedFeatures->push_back(TextureFilterType::GreyLevelNonuniformity);
-  requestedFeatures->push_back(TextureFilterType::GreyLevelNonuniformityNormalized);
-  requestedFeatures->push_back(TextureFilterType::RunLengthNonuniformity);
-  requestedFeatures->push_back(TextureFilterType::RunLengthNonuniformityNormalized);
-  requestedFeatures->push_back(TextureFilterType::LowGreyLevelRunEmphasis);
-  requestedFeatures->push_back(TextureFilterType::HighGreyLevelRunEmphasis);
-  requestedFeatures->push_back(TextureFilterType::ShortRunLowGreyLevelEmphasis);
-  requestedFeatures->push_back(TextureFilterType::ShortRunHighGreyLevelEmphasis);
-  requestedFeatures->push_back(TextureFilterType::LongRunLowGreyLevelEmphasis);
-  requestedFeatures->push_back(TextureFilterType::LongRunHighGreyLevelEmphasis);
-  requestedFeatures->push_back(TextureFilterType::RunPercentage);
-  requestedFeatures->push_back(TextureFilterType::NumberOfRuns);
-  requestedFeatures->push_back(TextureFilterType::GreyLevelVariance);
-  requestedFeatures->push_back(TextureFilterType::RunLengthVariance);
-  requestedFeatures->push_back(TextureFilterType::RunEntropy);
-
-  filter->SetInput(itkImage);
-  filter->SetMaskImage(maskImage);
-  filter->SetRequestedFeatures(requestedFeatures);
-  filter2->SetInput(itkImage);
-  filter2->SetMaskImage(maskImage);
-  filter2->SetRequestedFeatures(requestedFeatures);
-  int numberOfBins = params.Bins;
-  if (numberOfBins < 2)
-    numberOfBins = 256;
-
-  double minRange = params.MinimumIntensity;
-  double maxRange = params.MaximumIntensity;
-
-  filter->SetPixelValueMinMax(minRange, maxRange);
-  filter->SetNumberOfBinsPerAxis(numberOfBins);
-  filter2->SetPixelValueMinMax(minRange, maxRange);
-  filter2->SetNumberOfBinsPerAxis(numberOfBins);
-
-  filter->SetDistanceValueMinMax(0, numberOfBins);
-  filter2->SetDistanceValueMinMax(0, numberOfBins);
-
-  filter2->CombinedFeatureCalculationOn();
-
-  filter->Update();
-  filter2->Update();
-
-  auto featureMeans = filter->GetFeatureMeans ();
-  auto featureStd = filter->GetFeatureStandardDeviations();
-  auto featureCombined = filter2->GetFeatureMeans();
-
-  for (std::size_t i = 0; i < featureMeans->size(); ++i)
+  if (params.m_Direction == 1)
   {
-    switch (i)
+    offsetVector.clear();
+    offset[0] = 0;
+    offset[1] = 0;
+    offset[2] = 1;
+    offsetVector.push_back(offset);
+  }
+
+  // The runs of all offsets are followed in one traversal of the quantized image
+  auto matrices = engine->GetRunLengthMatrices(quantizedImage, offsetVector);
+
+  const std::size_t numberOfVoxels = quantizedImage->NumberOfMaskedVoxels;
+  Eigen::MatrixXd combinedHistogram = Eigen::MatrixXd::Zero(quantizedImage->NumberOfBins, params.Bins);
+  std::vector<double> featureMeans(NumberOfRunLengthFeatures, 0);
+  std::vector<double> featureDevs(NumberOfRunLengthFeatures, 0);
+  for (std::size_t k = 0; k < matrices.size(); ++k)
+  {
+    auto histogram = ToDistanceHistogram(matrices[k], params.Bins);
+    combinedHistogram += histogram;
+    auto features = CalculateRunLengthFeatures(histogram, numberOfVoxels);
+
+    // Incremental mean and population standard deviation, a la Knuth
+    for (unsigned int i = 0; i < NumberOfRunLengthFeatures; ++i)
     {
-    case TextureFilterType::ShortRunEmphasis :
-      featureList.push_back(std::make_pair(params.featurePrefix + "Short run emphasis Means",featureMeans->ElementAt(i)));
-      featureList.push_back(std::make_pair(params.featurePrefix + "Short run emphasis Std.", featureStd->ElementAt(i)));
-      featureList.push_back(std::make_pair(params.featurePrefix + "Short run emphasis Comb.", featureCombined->ElementAt(i)));
-      break;
-    case TextureFilterType::LongRunEmphasis :
-      featureList.push_back(std::make_pair(params.featurePrefix + "Long run emphasis Means", featureMeans->ElementAt(i)));
-      featureList.push_back(std::make_pair(params.featurePrefix + "Long run emphasis Std.", featureStd->ElementAt(i)));
-      featureList.push_back(std::make_pair(params.featurePrefix + "Long run emphasis Comb.", featureCombined->ElementAt(i)));
-      break;
-    case TextureFilterType::GreyLevelNonuniformity :
-      featureList.push_back(std::make_pair(params.featurePrefix + "Grey level nonuniformity Means", featureMeans->ElementAt(i)));
-      featureList.push_back(std::make_pair(params.featurePrefix + "Grey level nonuniformity Std.", featureStd->ElementAt(i)));
-      featureList.push_back(std::make_pair(params.featurePrefix + "Grey level nonuniformity Comb.", featureCombined->ElementAt(i)));
-      break;
-    case TextureFilterType::GreyLevelNonuniformityNormalized :
-      featureList.push_back(std::make_pair(params.featurePrefix + "Grey level nonuniformity normalized Means", featureMeans->ElementAt(i)));
-      featureList.push_back(std::make_pair(params.featurePrefix + "Grey level nonuniformity normalized Std.", featureStd->ElementAt(i)));
-      featureList.push_back(std::make_pair(params.featurePrefix + "Grey level nonuniformity normalized Comb.", featureCombined->ElementAt(i)));
-      break;
-    case TextureFilterType::RunLengthNonuniformity :
-      featureList.push_back(std::make_pair(params.featurePrefix + "Run length nonuniformity Means", featureMeans->ElementAt(i)));
-      featureList.push_back(std::make_pair(params.featurePrefix + "Run length nonuniformity Std.", featureStd->ElementAt(i)));
-      featureList.push_back(std::make_pair(params.featurePrefix + "Run length nonuniformity Comb.", featureCombined->ElementAt(i)));
-      break;
-    case TextureFilterType::RunLengthNonuniformityNormalized :
-      featureList.push_back(std::make_pair(params.featurePrefix + "Run length nonuniformity normalized Means", featureMeans->ElementAt(i)));
-      featureList.push_back(std::make_pair(params.featurePrefix + "Run length nonuniformity normalized Std.", featureStd->ElementAt(i)));
-      featureList.push_back(std::make_pair(params.featurePrefix + "Run length nonuniformity normalized Comb.", featureCombined->ElementAt(i)));
-      break;
-    case TextureFilterType::LowGreyLevelRunEmphasis :
-      featureList.push_back(std::make_pair(params.featurePrefix + "Low grey level run emphasis Means", featureMeans->ElementAt(i)));
-      featureList.push_back(std::make_pair(params.featurePrefix + "Low grey level run emphasis Std.", featureStd->ElementAt(i)));
-      featureList.push_back(std::make_pair(params.featurePrefix + "Low grey level run emphasis Comb.", featureCombined->ElementAt(i)));
-      break;
-    case TextureFilterType::HighGreyLevelRunEmphasis :
-      featureList.push_back(std::make_pair(params.featurePrefix + "High grey level run emphasis Means", featureMeans->ElementAt(i)));
-      featureList.push_back(std::make_pair(params.featurePrefix + "High grey level run emphasis Std.", featureStd->ElementAt(i)));
-      featureList.push_back(std::make_pair(params.featurePrefix + "High grey level run emphasis Comb.", featureCombined->ElementAt(i)));
-      break;
-    case TextureFilterType::ShortRunLowGreyLevelEmphasis :
-      featureList.push_back(std::make_pair(params.featurePrefix + "Short run low grey level emphasis Means", featureMeans->ElementAt(i)));
-      featureList.push_back(std::make_pair(params.featurePrefix + "Short run low grey level emphasis  Std.", featureStd->ElementAt(i)));
-      featureList.push_back(std::make_pair(params.featurePrefix + "Short run low grey level emphasis  Comb.", featureCombined->ElementAt(i)));
-      break;
-    case TextureFilterType::ShortRunHighGreyLevelEmphasis :
-      featureList.push_back(std::make_pair(params.featurePrefix + "Short run high grey level emphasis Means", featureMeans->ElementAt(i)));
-      featureList.push_back(std::make_pair(params.featurePrefix + "Short run high grey level emphasis Std.", featureStd->ElementAt(i)));
-      featureList.push_back(std::make_pair(params.featurePrefix + "Short run high grey level emphasis Comb.", featureCombined->ElementAt(i)));
-      break;
-    case TextureFilterType::LongRunLowGreyLevelEmphasis :
-      featureList.push_back(std::make_pair(params.featurePrefix + "Long run low grey level emphasis Means", featureMeans->ElementAt(i)));
-      featureList.push_back(std::make_pair(params.featurePrefix + "Long run low grey level emphasis Std.", featureStd->ElementAt(i)));
-      featureList.push_back(std::make_pair(params.featurePrefix + "Long run low grey level emphasis Comb.", featureCombined->ElementAt(i)));
-      break;
-    case TextureFilterType::LongRunHighGreyLevelEmphasis :
-      featureList.push_back(std::make_pair(params.featurePrefix + "Long run high grey level emphasis Means", featureMeans->ElementAt(i)));
-      featureList.push_back(std::make_pair(params.featurePrefix + "Long run high grey level emphasis Std.", featureStd->ElementAt(i)));
-      featureList.push_back(std::make_pair(params.featurePrefix + "Long run high grey level emphasis Comb.", featureCombined->ElementAt(i)));
-      break;
-    case TextureFilterType::RunPercentage :
-      featureList.push_back(std::make_pair(params.featurePrefix + "Run percentage Means", featureMeans->ElementAt(i)));
-      featureList.push_back(std::make_pair(params.featurePrefix + "Run percentage Std.", featureStd->ElementAt(i)));
-      featureList.push_back(std::make_pair(params.featurePrefix + "Run percentage Comb.", featureCombined->ElementAt(i) / newOffset->size()));
-      break;
-    case TextureFilterType::NumberOfRuns :
-      featureList.push_back(std::make_pair(params.featurePrefix + "Number of runs Means", featureMeans->ElementAt(i)));
-      featureList.push_back(std::make_pair(params.featurePrefix + "Number of runs Std.", featureStd->ElementAt(i)));
-      featureList.push_back(std::make_pair(params.featurePrefix + "Number of runs Comb.", featureCombined->ElementAt(i)));
-      break;
-    case TextureFilterType::GreyLevelVariance :
-      featureList.push_back(std::make_pair(params.featurePrefix + "Grey level variance Means", featureMeans->ElementAt(i)));
-      featureList.push_back(std::make_pair(params.featurePrefix + "Grey level variance Std.", featureStd->ElementAt(i)));
-      featureList.push_back(std::make_pair(params.featurePrefix + "Grey level variance Comb.", featureCombined->ElementAt(i)));
-      break;
-    case TextureFilterType::RunLengthVariance :
-      featureList.push_back(std::make_pair(params.featurePrefix + "Run length variance Means", featureMeans->ElementAt(i)));
-      featureList.push_back(std::make_pair(params.featurePrefix + "Run length variance Std.", featureStd->ElementAt(i)));
-      featureList.push_back(std::make_pair(params.featurePrefix + "Run length variance Comb.", featureCombined->ElementAt(i)));
-      break;
-    case TextureFilterType::RunEntropy :
-      featureList.push_back(std::make_pair(params.featurePrefix + "Run length entropy Means", featureMeans->ElementAt(i)));
-      featureList.push_back(std::make_pair(params.featurePrefix + "Run length entropy Std.", featureStd->ElementAt(i)));
-      featureList.push_back(std::make_pair(params.featurePrefix + "Run length entropy Comb.", featureCombined->ElementAt(i)));
-      break;
-    default:
-      break;
+      const double previousMean = featureMeans[i];
+      featureMeans[i] += (features[i] - previousMean) / (k + 1);
+      featureDevs[i] += (features[i] - previousMean) * (features[i] - featureMeans[i]);
     }
   }
+  auto featureCombined = CalculateRunLengthFeatures(combinedHistogram, numberOfVoxels);
+  featureCombined[RunPercentage] /= offsetVector.size();
+
+  for (unsigned int i = 0; i < NumberOfRunLengthFeatures; ++i)
+  {
+    // Keeps the published names of this feature
+    const std::string separator = (i == ShortRunLowGreyLevelEmphasis) ? "  " : " ";
+    const std::string name = params.featurePrefix + RunLengthFeatureNames[i];
+    featureList.push_back(std::make_pair(name + " Means", featureMeans[i]));
+    featureList.push_back(std::make_pair(name + separator + "Std.", std::sqrt(featureDevs[i] / matrices.size())));
+    featureList.push_back(std::make_pair(name + separator + "Comb.", featureCombined[i]));
+  }
 }
 
 mitk::GIFGreyLevelRunLength::GIFGreyLevelRunLength()
@@ -236,12 +258,18 @@ mitk::GIFGreyLevelRunLength::FeatureListType mitk::GIFGreyLevelRunLength::Calcul
   params.Bins = GetQuantifier()->GetBins();
   params.featurePrefix = FeatureDescriptionPrefix();
 
-  MITK_INFO << params.MinimumIntensity;
-  MITK_INFO << params.MaximumIntensity;
-  MITK_INFO << params.m_Direction;
-  MITK_INFO << params.Bins;
+  // A single bin has no runs to distinguish, so the range is split into 256 bins instead
+  mitk::IntensityQuantifier::Pointer quantifier = GetQuantifier();
+  if (params.Bins < 2)
+  {
+    params.Bins = 256;
+    quantifier = mitk::IntensityQuantifier::New();
+    quantifier->InitializeByMinimumMaximum(params.MinimumIntensity, params.MaximumIntensity, params.Bins);
+  }
 
-  AccessByItk_3(image, CalculateGrayLevelRunLengthFeatures, mask, featureList,params);
+  auto engine = GetTextureMatrixEngine();
+  auto quantizedImage = engine->GetQuantizedImage(image, mask, quantifier);
+  CalculateGrayLevelRunLengthFeatures(engine, quantizedImage, featureList, params);
 
   return featureList;
 }
@@ -13,14 +13,10 @@ found in the LICENSE file.
 #include <mitkGIFGreyLevelSizeZone.h>
 
 // MITK
-#include <mitkITKImageImport.h>
-#include <mitkImageCast.h>
-#include <mitkImageAccessByItk.h>
-
-// ITK
-#include <itkImageRegionIteratorWithIndex.h>
+#include <mitkTextureMatrixEngine.h>
 
 // STL
+#include <cmath>
 
 namespace mitk
 {
@@ -125,91 +121,6 @@ double mitk::GreyLevelSizeZoneMatrixHolder::IndexToMaxIntensity(int index)
   return m_MinimumRange + (index + 1) * m_Stepsize;
 }
 
-template<typename TPixel, unsigned int VImageDimension>
-static int
-CalculateGlSZMatrix(itk::Image<TPixel, VImageDimension>* itkImage,
-                    itk::Image<unsigned short, VImageDimension>* mask,
-                    std::vector<itk::Offset<VImageDimension> > offsets,
-                    bool estimateLargestRegion,
-                    mitk::GreyLevelSizeZoneMatrixHolder &holder)
-{
-  typedef itk::Image<TPixel, VImageDimension> ImageType;
-  typedef itk::Image<unsigned short, VImageDimension> MaskImageType;
-  typedef typename ImageType::IndexType IndexType;
-
-  typedef itk::ImageRegionIteratorWithIndex<ImageType> ConstIterType;
-  typedef itk::ImageRegionIteratorWithIndex<MaskImageType> ConstMaskIterType;
-
-  auto region = mask->GetLargestPossibleRegion();
-  typename MaskImageType::RegionType newRegion;
-  newRegion.SetSize(region.GetSize());
-  newRegion.SetIndex(region.GetIndex());
-
-  ConstIterType imageIter(itkImage, itkImage->GetLargestPossibleRegion());
-  ConstMaskIterType maskIter(mask, mask->GetLargestPossibleRegion());
-
-  typename MaskImageType::Pointer visitedImage = MaskImageType::New();
-  visitedImage->SetRegions(newRegion);
-  visitedImage->Allocate();
-  visitedImage->FillBuffer(0);
-
-  int largestRegion = 0;
-
-  while (!maskIter.IsAtEnd())
-  {
-    if (maskIter.Value() > 0 )
-    {
-      auto startIntensityIndex = holder.IntensityToIndex(imageIter.Value());
-      std::vector<IndexType> indices;
-      indices.push_back(maskIter.GetIndex());
-      unsigned int steps = 0;
-
-      while (indices.size() > 0)
-      {
-        auto currentIndex = indices.back();
-        indices.pop_back();
-
-        if (!region.IsInside(currentIndex))
-        {
-          continue;
-        }
-
-        auto wasVisited = visitedImage->GetPixel(currentIndex);
-        auto newIntensityIndex = holder.IntensityToIndex(itkImage->GetPixel(currentIndex));
-        auto isInMask = mask->GetPixel(currentIndex);
-
-        if ((isInMask > 0) &&
-            (newIntensityIndex == startIntensityIndex) &&
-            (wasVisited < 1))
-        {
-          ++steps;
-          visitedImage->SetPixel(currentIndex, 1);
-          for (auto offset : offsets)
-          {
-            auto newIndex = currentIndex + offset;
-            indices.push_back(newIndex);
-            newIndex = currentIndex - offset;
-            indices.push_back(newIndex);
-          }
-
-        }
-      }
-      if (steps > 0)
-      {
-        largestRegion = std::max<int>(steps, largestRegion);
-        steps = std::min<unsigned int>(steps, holder.m_MaximumSize);
-        if (!estimateLargestRegion)
-        {
-          holder.m_Matrix(startIntensityIndex, steps - 1) += 1;
-        }
-      }
-    }
-    ++imageIter;
-    ++maskIter;
-  }
-  return largestRegion;
-}
-
 static void CalculateFeatures(
   mitk::GreyLevelSizeZoneMatrixHolder &holder,
   mitk::GreyLevelSizeZoneFeatures & results
@@ -297,34 +208,31 @@ static void CalculateFeatures(
   results.ZonePercentage = Ns / results.ZonePercentage;
 }
 
-template<typename TPixel, unsigned int VImageDimension>
 static void
-CalculateGreyLevelSizeZoneFeatures(itk::Image<TPixel, VImageDimension>* itkImage, mitk::Image::Pointer mask, mitk::GIFGreyLevelSizeZone::FeatureListType & featureList, mitk::GIFGreyLevelSizeZone::GIFGreyLevelSizeZoneConfiguration config)
+CalculateGreyLevelSizeZoneFeatures(mitk::TextureMatrixEngine* engine, const mitk::TextureMatrixEngine::QuantizedImageConstPointer &quantizedImage, mitk::GIFGreyLevelSizeZone::FeatureListType & featureList, mitk::GIFGreyLevelSizeZone::GIFGreyLevelSizeZoneConfiguration config)
 {
-  typedef itk::Image<unsigned short, VImageDimension> MaskType;
-  typedef itk::Neighborhood<TPixel, VImageDimension > NeighborhoodType;
-  typedef itk::Offset<VImageDimension> OffsetType;
+  typedef mitk::TextureMatrixEngine::OffsetType OffsetType;
 
   ///////////////////////////////////////////////////////////////////////////////////////////////
   double rangeMin = config.MinimumIntensity;
   double rangeMax = config.MaximumIntensity;
   int numberOfBins = config.Bins;
+  unsigned int dimension = quantizedImage->Dimension;
 
-  typename MaskType::Pointer maskImage = MaskType::New();
-  mitk::CastToItkImage(mask, maskImage);
-
-  //Find possible directions
-  std::vector < itk::Offset<VImageDimension> > offsetVector;
-  NeighborhoodType hood;
-  hood.SetRadius(1);
-  unsigned int        centerIndex = hood.GetCenterNeighborhoodIndex();
-  OffsetType          offset;
+  //Find possible directions, i.e. the first half of a neighbourhood
+  //with radius 1 (in the order of itk::Neighborhood)
+  mitk::TextureMatrixEngine::OffsetVectorType offsetVector;
+  unsigned int centerIndex = static_cast<unsigned int>(std::pow(3, dimension)) / 2;
+  OffsetType offset;
   for (unsigned int d = 0; d < centerIndex; d++)
   {
-    offset = hood.GetOffset(d);
+    offset.Fill(0);
     bool useOffset = true;
-    for (unsigned int i = 0; i < VImageDimension; ++i)
+    unsigned int remainder = d;
+    for (unsigned int i = 0; i < dimension; ++i)
     {
+      offset[i] = static_cast<long>(remainder % 3) - 1;
+      remainder /= 3;
       if ((config.direction == i + 2) && offset[i] != 0)
       {
         useOffset = false;
@@ -333,7 +241,6 @@ CalculateGreyLevelSizeZoneFeatures(itk::Image<TPixel, VImageDimension>* itkImage
     if (useOffset)
     {
       offsetVector.push_back(offset);
-      MITK_INFO << offset;
     }
   }
   if (config.direction == 1)
@@ -345,12 +252,11 @@ CalculateGreyLevelSizeZoneFeatures(itk::Image<TPixel, VImageDimension>* itkImage
     offsetVector.push_back(offset);
   }
 
-  std::vector<mitk::GreyLevelSizeZoneFeatures> resultVector;
-  mitk::GreyLevelSizeZoneMatrixHolder tmpHolder(rangeMin, rangeMax, numberOfBins, 3);
-  int largestRegion = CalculateGlSZMatrix<TPixel, VImageDimension>(itkImage, maskImage, offsetVector, true, tmpHolder);
-  mitk::GreyLevelSizeZoneMatrixHolder holderOverall(rangeMin, rangeMax, numberOfBins,largestRegion);
+  // The zones are labeled in a single pass, the number of columns is the size of the largest zone
+  auto matrix = engine->GetSizeZoneMatrix(quantizedImage, offsetVector);
+  mitk::GreyLevelSizeZoneMatrixHolder holderOverall(rangeMin, rangeMax, numberOfBins, static_cast<int>(matrix.cols()));
+  holderOverall.m_Matrix = matrix;
   mitk::GreyLevelSizeZoneFeatures overallFeature;
-  CalculateGlSZMatrix<TPixel, VImageDimension>(itkImage, maskImage, offsetVector, false, holderOverall);
   CalculateFeatures(holderOverall, overallFeature);
 
   MatrixFeaturesTo(overallFeature, config.prefix, featureList);
@@ -403,7 +309,9 @@ mitk::GIFGreyLevelSizeZone::FeatureListType mitk::GIFGreyLevelSizeZone::Calculat
   config.Bins = GetQuantifier()->GetBins();
   config.prefix = FeatureDescriptionPrefix();
 
-  AccessByItk_3(image, CalculateGreyLevelSizeZoneFeatures, mask, featureList, config);
+  auto engine = GetTextureMatrixEngine();
+  auto quantizedImage = engine->GetQuantizedImage(image, mask, GetQuantifier());
+  CalculateGreyLevelSizeZoneFeatures(engine, quantizedImage, featureList, config);
 
   return featureList;
 }
@@ -13,16 +13,10 @@ found in the LICENSE file.
 #include <mitkGIFNeighbourhoodGreyToneDifferenceFeatures.h>
 
 // MITK
-#include <mitkITKImageImport.h>
-#include <mitkImageCast.h>
-#include <mitkImageAccessByItk.h>
-#include <mitkPixelTypeMultiplex.h>
-#include <mitkImagePixelReadAccessor.h>
-
-// ITK
-#include <itkImageRegionIteratorWithIndex.h>
-#include <itkNeighborhoodIterator.h>
+#include <mitkTextureMatrixEngine.h>
+
 // STL
+#include <cmath>
 #include <limits>
 
 struct GIFNeighbourhoodGreyToneDifferenceParameter
@@ -32,60 +26,12 @@ struct GIFNeighbourhoodGreyToneDifferenceParameter
   std::string prefix;
 };
 
-template<typename TPixel, unsigned int VImageDimension>
 static void
-CalculateIntensityPeak(itk::Image<TPixel, VImageDimension>* itkImage, mitk::Image::Pointer mask, GIFNeighbourhoodGreyToneDifferenceParameter params, mitk::GIFNeighbourhoodGreyToneDifferenceFeatures::FeatureListType & featureList)
+CalculateNGTDFeatures(const mitk::TextureMatrixEngine::NeighbourhoodMatrices &matrices, GIFNeighbourhoodGreyToneDifferenceParameter params, mitk::GIFNeighbourhoodGreyToneDifferenceFeatures::FeatureListType & featureList)
 {
-  typedef itk::Image<TPixel, VImageDimension> ImageType;
-  typedef itk::Image<unsigned short, VImageDimension> MaskType;
-
-  typename MaskType::Pointer itkMask = MaskType::New();
-  mitk::CastToItkImage(mask, itkMask);
-
-  typename ImageType::SizeType regionSize;
-  regionSize.Fill(params.Range);
-
-  itk::NeighborhoodIterator<ImageType> iter(regionSize, itkImage, itkImage->GetLargestPossibleRegion());
-  itk::NeighborhoodIterator<MaskType> iterMask(regionSize, itkMask, itkMask->GetLargestPossibleRegion());
-
-  std::vector<double> pVector;
-  std::vector<double> sVector;
-  pVector.resize(params.quantifier->GetBins(), 0);
-  sVector.resize(params.quantifier->GetBins(), 0);
-
-  int count = 0;
-  while (!iter.IsAtEnd())
-  {
-    if (iterMask.GetCenterPixel() > 0)
-    {
-      int localCount = 0;
-      double localMean = 0;
-      unsigned int localIndex = params.quantifier->IntensityToIndex(iter.GetCenterPixel());
-      for (itk::SizeValueType i = 0; i < iter.Size(); ++i)
-      {
-        if (i == (iter.Size() / 2))
-          continue;
-        if (iterMask.GetPixel(i) > 0)
-        {
-          ++localCount;
-          localMean += params.quantifier->IntensityToIndex(iter.GetPixel(i)) + 1;
-        }
-      }
-      if (localCount > 0)
-      {
-        localMean /= localCount;
-      }
-        localMean = std::abs<double>(localIndex + 1 - localMean);
-
-        pVector[localIndex] += 1;
-        sVector[localIndex] += localMean;
-        ++count;
-
-
-    }
-    ++iterMask;
-    ++iter;
-  }
+  std::vector<double> pVector = matrices.VoxelCounts;
+  const std::vector<double> &sVector = matrices.DifferenceSums;
+  double count = matrices.NumberOfVoxels;
 
   unsigned int Ngp = 0;
   for (unsigned int i = 0; i < params.quantifier->GetBins(); ++i)
@@ -163,7 +109,13 @@ mitk::GIFNeighbourhoodGreyToneDifferenceFeatures::FeatureListType mitk::GIFNeigh
   params.quantifier = GetQuantifier();
   params.prefix = FeatureDescriptionPrefix();
 
-  AccessByItk_3(image, CalculateIntensityPeak, mask, params, featureList);
+  auto engine = GetTextureMatrixEngine();
+  auto quantizedImage = engine->GetQuantizedImage(image, mask, GetQuantifier());
+  TextureMatrixEngine::RadiusType radius;
+  radius.Fill(params.Range);
+  auto matrices = engine->GetNeighbourhoodMatrices(quantizedImage, radius, 0);
+
+  CalculateNGTDFeatures(*matrices, params, featureList);
   return featureList;
 }
 
@@ -185,7 +137,7 @@ void mitk::GIFNeighbourhoodGreyToneDifferenceFeatures::AddArguments(mitkCommandL
 }
 
 void
-mitk::GIFNeighbourhoodGreyToneDifferenceFeatures::CalculateFeaturesUsingParameters(const Image::Pointer & feature, const Image::Pointer &mask, const Image::Pointer &, FeatureListType &featureList)
+mitk::GIFNeighbourhoodGreyToneDifferenceFeatures::CalculateFeaturesUsingParameters(const Image::Pointer & feature, const Image::Pointer &, const Image::Pointer &mask, FeatureListType &featureList)
 {
   InitializeQuantifierFromParameters(feature, mask);
   std::string name = GetOptionPrefix();
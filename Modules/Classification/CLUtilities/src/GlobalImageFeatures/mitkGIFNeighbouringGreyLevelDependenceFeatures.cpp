@@ -13,17 +13,10 @@ found in the LICENSE file.
 #include <mitkGIFNeighbouringGreyLevelDependenceFeatures.h>
 
 // MITK
-#include <mitkITKImageImport.h>
-#include <mitkImageCast.h>
-#include <mitkImageAccessByItk.h>
-
-// ITK
-#include <itkEnhancedScalarImageToTextureFeaturesFilter.h>
-#include <itkMinimumMaximumImageCalculator.h>
-#include <itkNeighborhoodIterator.h>
-#include <itkImageRegionConstIterator.h>
+#include <mitkTextureMatrixEngine.h>
 
 // STL
+#include <cmath>
 #include <sstream>
 
 namespace mitk
@@ -155,97 +148,6 @@ double mitk::NGLDMMatrixHolder::IndexToMaxIntensity(int index)
   return m_MinimumRange + (index + 1) * m_Stepsize;
 }
 
-template<typename TPixel, unsigned int VImageDimension>
-void
-CalculateNGLDMMatrix(itk::Image<TPixel, VImageDimension>* itkImage,
-                    itk::Image<unsigned short, VImageDimension>* mask,
-                    int alpha,
-                    int range,
-                    unsigned int direction,
-                    mitk::NGLDMMatrixHolder &holder)
-{
-  typedef itk::Image<TPixel, VImageDimension> ImageType;
-  typedef itk::Image<unsigned short, VImageDimension> MaskImageType;
-  typedef itk::NeighborhoodIterator<ImageType> ShapeIterType;
-  typedef itk::NeighborhoodIterator<MaskImageType> ShapeMaskIterType;
-
-  holder.m_NumberOfCompleteNeighbourhoods = 0;
-  holder.m_NumberOfNeighbourhoods = 0;
-  holder.m_NumberOfNeighbourVoxels = 0;
-  holder.m_NumberOfDependenceNeighbourVoxels = 0;
-
-  itk::Size<VImageDimension> radius;
-  radius.Fill(range);
-
-  if ((direction > 1) && (direction - 2 <VImageDimension))
-  {
-    radius[direction - 2] = 0;
-  }
-
-  ShapeIterType imageIter(radius, itkImage, itkImage->GetLargestPossibleRegion());
-  ShapeMaskIterType maskIter(radius, mask, mask->GetLargestPossibleRegion());
-
-  auto region = mask->GetLargestPossibleRegion();
-
-  auto center = imageIter.Size() / 2;
-  auto iterSize = imageIter.Size();
-  holder.m_NeighbourhoodSize = iterSize-1;
-  while (!maskIter.IsAtEnd())
-  {
-    int sameValues = 0;
-    bool completeNeighbourhood = true;
-
-    int i = holder.IntensityToIndex(imageIter.GetCenterPixel());
-
-    if ((imageIter.GetCenterPixel() != imageIter.GetCenterPixel()) ||
-      (maskIter.GetCenterPixel() < 1))
-    {
-      ++imageIter;
-      ++maskIter;
-      continue;
-    }
-
-    for (unsigned int position = 0; position < iterSize; ++position)
-    {
-      if (position == center)
-      {
-        continue;
-      }
-      if ( ! region.IsInside(maskIter.GetIndex(position)))
-      {
-        completeNeighbourhood = false;
-        continue;
-      }
-      bool isInBounds;
-      auto jIntensity = imageIter.GetPixel(position, isInBounds);
-      auto jMask = maskIter.GetPixel(position, isInBounds);
-      if (jMask < 1 || (jIntensity != jIntensity) || ( ! isInBounds))
-      {
-        completeNeighbourhood = false;
-        continue;
-      }
-
-      int j = holder.IntensityToIndex(jIntensity);
-      holder.m_NumberOfNeighbourVoxels += 1;
-      if (std::abs(i - j) <= alpha)
-      {
-        holder.m_NumberOfDependenceNeighbourVoxels += 1;
-        ++sameValues;
-      }
-    }
-    holder.m_Matrix(i, sameValues) += 1;
-    holder.m_NumberOfNeighbourhoods += 1;
-    if (completeNeighbourhood)
-    {
-      holder.m_NumberOfCompleteNeighbourhoods += 1;
-    }
-
-    ++imageIter;
-    ++maskIter;
-  }
-
-}
-
 void LocalCalculateFeatures(
   mitk::NGLDMMatrixHolder &holder,
   mitk::NGLDMMatrixFeatures & results
@@ -349,27 +251,23 @@ void LocalCalculateFeatures(
   results.PercentageOfDependenceNeighbours = holder.m_NumberOfDependenceNeighbourVoxels / (1.0 * holder.m_NumberOfNeighbourVoxels);
 }
 
-template<typename TPixel, unsigned int VImageDimension>
-void
-CalculateCoocurenceFeatures(itk::Image<TPixel, VImageDimension>* itkImage, mitk::Image::Pointer mask, mitk::GIFNeighbouringGreyLevelDependenceFeature::FeatureListType & featureList, mitk::GIFNeighbouringGreyLevelDependenceFeature::GIFNeighbouringGreyLevelDependenceFeatureConfiguration config)
+static void
+CalculateNGLDMFeatures(const mitk::TextureMatrixEngine::NeighbourhoodMatrices &matrices, mitk::GIFNeighbouringGreyLevelDependenceFeature::FeatureListType & featureList, mitk::GIFNeighbouringGreyLevelDependenceFeature::GIFNeighbouringGreyLevelDependenceFeatureConfiguration config)
 {
-  typedef itk::Image<unsigned short, VImageDimension> MaskType;
-
   double rangeMin = config.MinimumIntensity;
   double rangeMax = config.MaximumIntensity;
   int numberOfBins = config.Bins;
-
-  typename MaskType::Pointer maskImage = MaskType::New();
-  mitk::CastToItkImage(mask, maskImage);
-
-  std::vector<mitk::NGLDMMatrixFeatures> resultVector;
-  int numberofDependency = 37;
-  if (VImageDimension == 2)
-    numberofDependency = 37;
+  int numberofDependency = static_cast<int>(matrices.DependenceMatrix.cols());
 
   mitk::NGLDMMatrixHolder holderOverall(rangeMin, rangeMax, numberOfBins, numberofDependency);
+  holderOverall.m_Matrix = matrices.DependenceMatrix;
+  holderOverall.m_NeighbourhoodSize = matrices.NeighbourhoodSize;
+  holderOverall.m_NumberOfNeighbourVoxels = matrices.NumberOfNeighbourVoxels;
+  holderOverall.m_NumberOfDependenceNeighbourVoxels = matrices.NumberOfDependenceNeighbourVoxels;
+  holderOverall.m_NumberOfNeighbourhoods = matrices.NumberOfNeighbourhoods;
+  holderOverall.m_NumberOfCompleteNeighbourhoods = matrices.NumberOfCompleteNeighbourhoods;
+
   mitk::NGLDMMatrixFeatures overallFeature;
-  CalculateNGLDMMatrix<TPixel, VImageDimension>(itkImage, maskImage, config.alpha, config.range, config.direction, holderOverall);
   LocalCalculateFeatures(holderOverall, overallFeature);
 
   MatrixFeaturesTo(overallFeature, config.FeatureEncoding, featureList);
@@ -435,7 +333,17 @@ mitk::GIFNeighbouringGreyLevelDependenceFeature::FeatureListType mitk::GIFNeighb
 
   config.FeatureEncoding = FeatureDescriptionPrefix();
 
-  AccessByItk_3(image, CalculateCoocurenceFeatures, mask, featureList,config);
+  auto engine = GetTextureMatrixEngine();
+  auto quantizedImage = engine->GetQuantizedImage(image, mask, GetQuantifier());
+  TextureMatrixEngine::RadiusType radius;
+  radius.Fill(static_cast<itk::SizeValueType>(config.range));
+  if ((config.direction > 1) && (config.direction - 2 < image->GetDimension()))
+  {
+    radius[config.direction - 2] = 0;
+  }
+  auto matrices = engine->GetNeighbourhoodMatrices(quantizedImage, radius, config.alpha);
+
+  CalculateNGLDMFeatures(*matrices, featureList, config);
 
   return featureList;
 }
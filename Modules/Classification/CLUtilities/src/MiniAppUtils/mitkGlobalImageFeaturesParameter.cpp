@@ -45,6 +45,11 @@ void mitk::cl::GlobalImageFeaturesParameter::AddParameter(mitkCommandLineParser
   parser.addArgument("first-line-header", "fl-head", mitkCommandLineParser::Bool, "Add Header (Labels) to first line of output", "", us::Any());
   parser.addArgument("decimal-point", "decimal", mitkCommandLineParser::String, "Decima Point that is used in Conversion", "", us::Any());
 
+  AddFeatureParameter(parser);
+}
+
+void mitk::cl::GlobalImageFeaturesParameter::AddFeatureParameter(mitkCommandLineParser &parser)
+{
   parser.addArgument("resample-mask",   "rm", mitkCommandLineParser::Bool,  "Bool",  "Resamples the mask to the resolution of the input image ", us::Any());
   parser.addArgument("same-space",      "sp", mitkCommandLineParser::Bool,  "Bool",  "Set the spacing of all images to equal. Otherwise an error will be thrown. ", us::Any());
   parser.addArgument("fixed-isotropic", "fi", mitkCommandLineParser::Float, "Float", "Input image resampled to fixed isotropic resolution given in mm. Should be used with resample-mask ", us::Any());
@@ -62,6 +67,11 @@ void mitk::cl::GlobalImageFeaturesParameter::ParseParameter(std::map<std::string
   ParseFileLocations(parsedArgs);
   ParseAdditionalOutputs(parsedArgs);
   ParseHeaderInformation(parsedArgs);
+  ParseFeatureParameter(parsedArgs);
+}
+
+void mitk::cl::GlobalImageFeaturesParameter::ParseFeatureParameter(std::map<std::string, us::Any> parsedArgs)
+{
   ParseMaskAdaptation(parsedArgs);
   ParseGlobalFeatureParameter(parsedArgs);
 }
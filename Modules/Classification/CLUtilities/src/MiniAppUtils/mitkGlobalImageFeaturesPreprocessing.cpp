@@ -0,0 +1,129 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <mitkGlobalImageFeaturesPreprocessing.h>
+
+#include <mitkImageAccessByItk.h>
+#include <mitkImageCast.h>
+#include <mitkITKImageImport.h>
+
+#include <itkImageDuplicator.h>
+#include <itkImageRegionIterator.h>
+#include <itkNearestNeighborInterpolateImageFunction.h>
+#include <itkResampleImageFilter.h>
+
+template<typename TPixel, unsigned int VImageDimension>
+static void
+ResampleImage(itk::Image<TPixel, VImageDimension>* itkImage, double resolution, mitk::Image::Pointer& newImage)
+{
+  typedef itk::Image<TPixel, VImageDimension> ImageType;
+  typedef itk::ResampleImageFilter<ImageType, ImageType> ResampleFilterType;
+
+  typename ResampleFilterType::Pointer resampler = ResampleFilterType::New();
+  auto spacing = itkImage->GetSpacing();
+  auto size = itkImage->GetLargestPossibleRegion().GetSize();
+
+  for (unsigned int i = 0; i < VImageDimension; ++i)
+  {
+    size[i] = size[i] / (1.0*resolution)*(1.0*spacing[i])+1.0;
+  }
+  spacing.Fill(resolution);
+
+  resampler->SetInput(itkImage);
+  resampler->SetSize(size);
+  resampler->SetOutputSpacing(spacing);
+  resampler->SetOutputOrigin(itkImage->GetOrigin());
+  resampler->SetOutputDirection(itkImage->GetDirection());
+  resampler->Update();
+
+  newImage->InitializeByItk(resampler->GetOutput());
+  mitk::GrabItkImageMemory(resampler->GetOutput(), newImage);
+}
+
+template<typename TPixel, unsigned int VImageDimension>
+static void
+CreateNoNaNMaskImage(itk::Image<TPixel, VImageDimension>* itkValue, mitk::Image::Pointer mask, mitk::Image::Pointer& newMask)
+{
+  typedef itk::Image< TPixel, VImageDimension>                 LFloatImageType;
+  typedef itk::Image< unsigned short, VImageDimension>          LMaskImageType;
+  typename LMaskImageType::Pointer itkMask = LMaskImageType::New();
+
+  mitk::CastToItkImage(mask, itkMask);
+
+  typedef itk::ImageDuplicator< LMaskImageType > DuplicatorType;
+  typename DuplicatorType::Pointer duplicator = DuplicatorType::New();
+  duplicator->SetInputImage(itkMask);
+  duplicator->Update();
+
+  auto tmpMask = duplicator->GetOutput();
+
+  itk::ImageRegionIterator<LMaskImageType> mask1Iter(itkMask, itkMask->GetLargestPossibleRegion());
+  itk::ImageRegionIterator<LMaskImageType> mask2Iter(tmpMask, tmpMask->GetLargestPossibleRegion());
+  itk::ImageRegionIterator<LFloatImageType> imageIter(itkValue, itkValue->GetLargestPossibleRegion());
+  while (!mask1Iter.IsAtEnd())
+  {
+    mask2Iter.Set(0);
+    if (mask1Iter.Value() > 0)
+    {
+      // Is not NaN
+      if (imageIter.Value() == imageIter.Value())
+      {
+        mask2Iter.Set(1);
+      }
+    }
+    ++mask1Iter;
+    ++mask2Iter;
+    ++imageIter;
+  }
+
+  newMask->InitializeByItk(tmpMask);
+  mitk::GrabItkImageMemory(tmpMask, newMask);
+}
+
+template<typename TPixel, unsigned int VImageDimension>
+static void
+ResampleMask(itk::Image<TPixel, VImageDimension>* itkMoving, mitk::Image::Pointer ref, mitk::Image::Pointer& newMask)
+{
+  typedef itk::Image< TPixel, VImageDimension>          LMaskImageType;
+  typedef itk::NearestNeighborInterpolateImageFunction< LMaskImageType> NearestNeighborInterpolateImageFunctionType;
+  typedef itk::ResampleImageFilter<LMaskImageType, LMaskImageType> ResampleFilterType;
+
+  typename NearestNeighborInterpolateImageFunctionType::Pointer nn_interpolator = NearestNeighborInterpolateImageFunctionType::New();
+  typename LMaskImageType::Pointer itkRef = LMaskImageType::New();
+  mitk::CastToItkImage(ref, itkRef);
+
+
+  typename ResampleFilterType::Pointer resampler = ResampleFilterType::New();
+  resampler->SetInput(itkMoving);
+  resampler->SetReferenceImage(itkRef);
+  resampler->UseReferenceImageOn();
+  resampler->SetInterpolator(nn_interpolator);
+  resampler->Update();
+
+  newMask->InitializeByItk(resampler->GetOutput());
+  mitk::GrabItkImageMemory(resampler->GetOutput(), newMask);
+}
+
+void mitk::cl::ResampleImageToIsotropicResolution(mitk::Image::Pointer image, double resolution, mitk::Image::Pointer &newImage)
+{
+  AccessByItk_2(image, ResampleImage, resolution, newImage);
+}
+
+void mitk::cl::ResampleMaskToReference(mitk::Image::Pointer mask, mitk::Image::Pointer reference, mitk::Image::Pointer &newMask)
+{
+  AccessByItk_2(mask, ResampleMask, reference, newMask);
+}
+
+void mitk::cl::CreateNoNaNMask(mitk::Image::Pointer image, mitk::Image::Pointer mask, mitk::Image::Pointer &newMask)
+{
+  AccessByItk_2(image, CreateNoNaNMaskImage, mask, newMask);
+}
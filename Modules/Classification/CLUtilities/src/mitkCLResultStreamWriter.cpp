@@ -0,0 +1,266 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <mitkCLResultStreamWriter.h>
+
+#include <mitkExceptionMacro.h>
+#include <mitkLogMacros.h>
+
+#include <iostream>
+#include <locale>
+#include <sstream>
+
+namespace
+{
+  template <class charT>
+  class punct_facet : public std::numpunct<charT> {
+  public:
+    punct_facet(charT sep) :
+      m_Sep(sep)
+    {
+
+    }
+  protected:
+    charT do_decimal_point() const override { return m_Sep; }
+  private:
+    charT m_Sep;
+  };
+
+  const char* const CaseInformationColumns[] = { "Case", "Image", "Mask", "Status", "Load time [ms]", "Calculation time [ms]" };
+  const std::size_t NumberOfCaseInformationColumns = sizeof(CaseInformationColumns) / sizeof(CaseInformationColumns[0]);
+
+  /** Removes separators and line breaks from free text, e.g. error messages*/
+  std::string SanitizeText(std::string text)
+  {
+    for (auto &c : text)
+    {
+      if (c == ';' || c == '\n' || c == '\r')
+      {
+        c = ' ';
+      }
+    }
+    return text;
+  }
+}
+
+mitk::cl::FeatureResultStreamWriter::FeatureResultStreamWriter(const std::string &file, Layout layout) :
+m_Layout(layout),
+m_Separator(";"),
+m_HeaderWritten(false),
+m_NumberOfWrittenCases(0),
+m_UseSpecialDecimalPoint(false),
+m_DecimalPoint('.')
+{
+  this->ReadExistingHeader(file);
+
+  m_Output.open(file, std::ios::app);
+  if (!m_Output.is_open())
+  {
+    mitkThrow() << "Could not open result file " << file;
+  }
+}
+
+mitk::cl::FeatureResultStreamWriter::~FeatureResultStreamWriter()
+{
+  // Only failed cases have been added, write them without feature columns
+  if (!m_PendingResults.empty())
+  {
+    this->WriteHeader();
+    for (const auto &result : m_PendingResults)
+    {
+      this->WriteWideRow(result);
+    }
+  }
+  m_Output.close();
+}
+
+void mitk::cl::FeatureResultStreamWriter::SetDecimalPoint(char decimal)
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_UseSpecialDecimalPoint = true;
+  m_DecimalPoint = decimal;
+}
+
+std::size_t mitk::cl::FeatureResultStreamWriter::GetNumberOfWrittenCases() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_NumberOfWrittenCases;
+}
+
+void mitk::cl::FeatureResultStreamWriter::AddCase(const CaseResult &result)
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+
+  if (m_Layout == LongLayout)
+  {
+    if (!m_HeaderWritten)
+    {
+      this->WriteHeader();
+    }
+    this->WriteLongRows(result);
+  }
+  else
+  {
+    if (!m_HeaderWritten)
+    {
+      if (!result.Succeeded)
+      {
+        // The feature columns are not known before the first successful case
+        m_PendingResults.push_back(result);
+        ++m_NumberOfWrittenCases;
+        return;
+      }
+      for (const auto &feature : result.Features)
+      {
+        m_FeatureColumns.emplace(feature.first, m_FeatureNames.size());
+        m_FeatureNames.push_back(feature.first);
+      }
+      this->WriteHeader();
+      for (const auto &pendingResult : m_PendingResults)
+      {
+        this->WriteWideRow(pendingResult);
+      }
+      m_PendingResults.clear();
+    }
+    this->WriteWideRow(result);
+  }
+
+  m_Output.flush();
+  ++m_NumberOfWrittenCases;
+}
+
+void mitk::cl::FeatureResultStreamWriter::ReadExistingHeader(const std::string &file)
+{
+  std::ifstream input(file);
+  std::string header;
+  if (!input.good() || !std::getline(input, header) || header.empty())
+  {
+    return;
+  }
+
+  if (header.back() == '\r')
+  {
+    header.pop_back();
+  }
+
+  // Column names contain spaces, so splitString() cannot be used here
+  std::vector<std::string> columns;
+  std::istringstream headerStream(header);
+  std::string column;
+  while (std::getline(headerStream, column, ';'))
+  {
+    columns.push_back(column);
+  }
+
+  if (columns.size() < NumberOfCaseInformationColumns || columns[0] != CaseInformationColumns[0])
+  {
+    mitkThrow() << "The existing result file " << file << " was not written by a batch feature calculation";
+  }
+  if ((m_Layout == LongLayout) != (columns.back() == "Value"))
+  {
+    mitkThrow() << "The layout of the existing result file " << file << " does not match the requested layout";
+  }
+
+  if (m_Layout == WideLayout)
+  {
+    for (std::size_t i = NumberOfCaseInformationColumns; i < columns.size(); ++i)
+    {
+      m_FeatureColumns.emplace(columns[i], m_FeatureNames.size());
+      m_FeatureNames.push_back(columns[i]);
+    }
+  }
+  m_HeaderWritten = true;
+}
+
+void mitk::cl::FeatureResultStreamWriter::WriteHeader()
+{
+  for (std::size_t i = 0; i < NumberOfCaseInformationColumns; ++i)
+  {
+    m_Output << (i > 0 ? m_Separator : "") << CaseInformationColumns[i];
+  }
+  if (m_Layout == LongLayout)
+  {
+    m_Output << m_Separator << "Feature" << m_Separator << "Value";
+  }
+  else
+  {
+    for (const auto &name : m_FeatureNames)
+    {
+      m_Output << m_Separator << name;
+    }
+  }
+  m_Output << "\n";
+  m_HeaderWritten = true;
+}
+
+void mitk::cl::FeatureResultStreamWriter::WriteCaseInformation(const CaseResult &result)
+{
+  m_Output << SanitizeText(result.CaseId) << m_Separator
+    << SanitizeText(result.ImagePath) << m_Separator
+    << SanitizeText(result.MaskPath) << m_Separator
+    << (result.Succeeded ? std::string("OK") : "Failed: " + SanitizeText(result.Message)) << m_Separator
+    << this->ToString(result.LoadTime) << m_Separator
+    << this->ToString(result.CalculationTime);
+}
+
+void mitk::cl::FeatureResultStreamWriter::WriteWideRow(const CaseResult &result)
+{
+  std::vector<std::string> values(m_FeatureNames.size());
+  std::size_t numberOfUnknownFeatures = 0;
+  for (const auto &feature : result.Features)
+  {
+    auto column = m_FeatureColumns.find(feature.first);
+    if (column == m_FeatureColumns.end())
+    {
+      ++numberOfUnknownFeatures;
+      continue;
+    }
+    values[column->second] = this->ToString(feature.second);
+  }
+  if (numberOfUnknownFeatures > 0)
+  {
+    MITK_WARN << "Case " << result.CaseId << ": " << numberOfUnknownFeatures << " features are not part of the header and are not written.";
+  }
+
+  this->WriteCaseInformation(result);
+  for (const auto &value : values)
+  {
+    m_Output << m_Separator << value;
+  }
+  m_Output << "\n";
+}
+
+void mitk::cl::FeatureResultStreamWriter::WriteLongRows(const CaseResult &result)
+{
+  if (result.Features.empty())
+  {
+    this->WriteCaseInformation(result);
+    m_Output << m_Separator << m_Separator << "\n";
+    return;
+  }
+  for (const auto &feature : result.Features)
+  {
+    this->WriteCaseInformation(result);
+    m_Output << m_Separator << feature.first << m_Separator << this->ToString(feature.second) << "\n";
+  }
+}
+
+std::string mitk::cl::FeatureResultStreamWriter::ToString(double value) const
+{
+  std::ostringstream ss;
+  if (m_UseSpecialDecimalPoint)
+  {
+    ss.imbue(std::locale(std::cout.getloc(), new punct_facet<char>(m_DecimalPoint)));
+  }
+  ss << value;
+  return ss.str();
+}
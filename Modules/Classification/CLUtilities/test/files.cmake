@@ -1,4 +1,5 @@
 set(MODULE_TESTS
+  mitkCLResultStreamWriterTest
   mitkGIFCooc2Test
   mitkGIFCurvatureStatisticTest
   mitkGIFFirstOrderHistogramStatisticsTest
@@ -11,8 +12,10 @@ set(MODULE_TESTS
   mitkGIFLocalIntensityTest
   mitkGIFNeighbourhoodGreyToneDifferenceFeaturesTest
   mitkGIFNeighbouringGreyLevelDependenceFeatureTest
+  mitkGIFTextureMatrixEngineTest
   mitkGIFVolumetricDensityStatisticsTest
   mitkGIFVolumetricStatisticsTest
+  mitkLocalVoxelFeatureFiltersTest
   #mitkSmoothedClassProbabilitesTest.cpp
   #mitkGlobalFeaturesTest.cpp
 )
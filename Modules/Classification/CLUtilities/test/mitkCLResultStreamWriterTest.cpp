@@ -0,0 +1,225 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <mitkTestingMacros.h>
+#include <mitkTestFixture.h>
+#include <mitkIOUtil.h>
+
+#include <mitkCLResultStreamWriter.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
+class mitkCLResultStreamWriterTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkCLResultStreamWriterTestSuite);
+
+  MITK_TEST(WideLayout_FailedCasesBeforeFirstSuccess_AreWrittenBelowHeader);
+  MITK_TEST(WideLayout_FeaturesAreAssignedByName);
+  MITK_TEST(WideLayout_OnlyFailedCases_HeaderWithoutFeatures);
+  MITK_TEST(LongLayout_OneRowPerFeature);
+  MITK_TEST(ExistingFile_RowsAreAppendedToHeader);
+  MITK_TEST(ExistingFile_OtherLayout_Throws);
+  MITK_TEST(DecimalPoint_IsUsedForValues);
+  MITK_TEST(AddCase_FromSeveralThreads_AllRowsAreWritten);
+
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  std::string m_FileName;
+
+  typedef mitk::cl::FeatureResultStreamWriter WriterType;
+
+  WriterType::CaseResult CreateResult(const std::string &caseId, bool succeeded, double value = 0.0)
+  {
+    WriterType::CaseResult result;
+    result.CaseId = caseId;
+    result.ImagePath = caseId + ".nrrd";
+    result.MaskPath = caseId + "_mask.nrrd";
+    result.Succeeded = succeeded;
+    result.LoadTime = 2;
+    result.CalculationTime = succeeded ? 3 : 0;
+    if (succeeded)
+    {
+      result.Features.push_back(std::make_pair("First", value));
+      result.Features.push_back(std::make_pair("Second", 2 * value));
+    }
+    else
+    {
+      result.Message = "not readable;\nreason";
+    }
+    return result;
+  }
+
+  std::vector<std::string> ReadLines()
+  {
+    std::vector<std::string> lines;
+    std::ifstream file(m_FileName);
+    std::string line;
+    while (std::getline(file, line))
+    {
+      lines.push_back(line);
+    }
+    return lines;
+  }
+
+public:
+
+  void setUp() override
+  {
+    m_FileName = mitk::IOUtil::CreateTemporaryFile("CLResultStreamWriterTest_XXXXXX.csv");
+  }
+
+  void tearDown() override
+  {
+    std::remove(m_FileName.c_str());
+  }
+
+  void WideLayout_FailedCasesBeforeFirstSuccess_AreWrittenBelowHeader()
+  {
+    {
+      WriterType writer(m_FileName, WriterType::WideLayout);
+      writer.AddCase(this->CreateResult("A", false));
+      writer.AddCase(this->CreateResult("B", true, 1.5));
+      CPPUNIT_ASSERT_EQUAL(std::size_t(2), writer.GetNumberOfWrittenCases());
+    }
+
+    auto lines = this->ReadLines();
+    CPPUNIT_ASSERT_EQUAL(std::size_t(3), lines.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("Case;Image;Mask;Status;Load time [ms];Calculation time [ms];First;Second"), lines[0]);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Separators and line breaks of the message should be removed",
+      std::string("A;A.nrrd;A_mask.nrrd;Failed: not readable  reason;2;0;;"), lines[1]);
+    CPPUNIT_ASSERT_EQUAL(std::string("B;B.nrrd;B_mask.nrrd;OK;2;3;1.5;3"), lines[2]);
+  }
+
+  void WideLayout_FeaturesAreAssignedByName()
+  {
+    {
+      WriterType writer(m_FileName, WriterType::WideLayout);
+      writer.AddCase(this->CreateResult("A", true, 1));
+      auto result = this->CreateResult("B", true, 2);
+      std::swap(result.Features[0], result.Features[1]);
+      result.Features.push_back(std::make_pair("Unknown", 7.0));
+      writer.AddCase(result);
+    }
+
+    auto lines = this->ReadLines();
+    CPPUNIT_ASSERT_EQUAL(std::size_t(3), lines.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("B;B.nrrd;B_mask.nrrd;OK;2;3;2;4"), lines[2]);
+  }
+
+  void WideLayout_OnlyFailedCases_HeaderWithoutFeatures()
+  {
+    {
+      WriterType writer(m_FileName, WriterType::WideLayout);
+      writer.AddCase(this->CreateResult("A", false));
+    }
+
+    auto lines = this->ReadLines();
+    CPPUNIT_ASSERT_EQUAL(std::size_t(2), lines.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("Case;Image;Mask;Status;Load time [ms];Calculation time [ms]"), lines[0]);
+    CPPUNIT_ASSERT_EQUAL(std::string("A;A.nrrd;A_mask.nrrd;Failed: not readable  reason;2;0"), lines[1]);
+  }
+
+  void LongLayout_OneRowPerFeature()
+  {
+    {
+      WriterType writer(m_FileName, WriterType::LongLayout);
+      writer.AddCase(this->CreateResult("A", false));
+      writer.AddCase(this->CreateResult("B", true, 1));
+    }
+
+    auto lines = this->ReadLines();
+    CPPUNIT_ASSERT_EQUAL(std::size_t(4), lines.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("Case;Image;Mask;Status;Load time [ms];Calculation time [ms];Feature;Value"), lines[0]);
+    CPPUNIT_ASSERT_EQUAL(std::string("A;A.nrrd;A_mask.nrrd;Failed: not readable  reason;2;0;;"), lines[1]);
+    CPPUNIT_ASSERT_EQUAL(std::string("B;B.nrrd;B_mask.nrrd;OK;2;3;First;1"), lines[2]);
+    CPPUNIT_ASSERT_EQUAL(std::string("B;B.nrrd;B_mask.nrrd;OK;2;3;Second;2"), lines[3]);
+  }
+
+  void ExistingFile_RowsAreAppendedToHeader()
+  {
+    {
+      WriterType writer(m_FileName, WriterType::WideLayout);
+      writer.AddCase(this->CreateResult("A", true, 1));
+    }
+    {
+      WriterType writer(m_FileName, WriterType::WideLayout);
+      auto result = this->CreateResult("B", true, 2);
+      std::swap(result.Features[0], result.Features[1]);
+      writer.AddCase(result);
+    }
+
+    auto lines = this->ReadLines();
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("The header should only be written once", std::size_t(3), lines.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("A;A.nrrd;A_mask.nrrd;OK;2;3;1;2"), lines[1]);
+    CPPUNIT_ASSERT_EQUAL(std::string("B;B.nrrd;B_mask.nrrd;OK;2;3;2;4"), lines[2]);
+  }
+
+  void ExistingFile_OtherLayout_Throws()
+  {
+    {
+      WriterType writer(m_FileName, WriterType::WideLayout);
+      writer.AddCase(this->CreateResult("A", true, 1));
+    }
+    CPPUNIT_ASSERT_THROW(WriterType(m_FileName, WriterType::LongLayout), mitk::Exception);
+  }
+
+  void DecimalPoint_IsUsedForValues()
+  {
+    {
+      WriterType writer(m_FileName, WriterType::LongLayout);
+      writer.SetDecimalPoint(',');
+      writer.AddCase(this->CreateResult("A", true, 0.25));
+    }
+
+    auto lines = this->ReadLines();
+    CPPUNIT_ASSERT_EQUAL(std::size_t(3), lines.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("A;A.nrrd;A_mask.nrrd;OK;2;3;First;0,25"), lines[1]);
+    CPPUNIT_ASSERT_EQUAL(std::string("A;A.nrrd;A_mask.nrrd;OK;2;3;Second;0,5"), lines[2]);
+  }
+
+  void AddCase_FromSeveralThreads_AllRowsAreWritten()
+  {
+    const unsigned int numberOfThreads = 4;
+    const unsigned int casesPerThread = 50;
+    {
+      WriterType writer(m_FileName, WriterType::WideLayout);
+      std::vector<std::thread> threads;
+      for (unsigned int thread = 0; thread < numberOfThreads; ++thread)
+      {
+        threads.emplace_back([&, thread]() {
+          for (unsigned int i = 0; i < casesPerThread; ++i)
+          {
+            writer.AddCase(this->CreateResult(std::to_string(thread) + "_" + std::to_string(i), i % 5 != 0, i));
+          }
+        });
+      }
+      for (auto &thread : threads)
+      {
+        thread.join();
+      }
+      CPPUNIT_ASSERT_EQUAL(std::size_t(numberOfThreads * casesPerThread), writer.GetNumberOfWrittenCases());
+    }
+
+    auto lines = this->ReadLines();
+    CPPUNIT_ASSERT_EQUAL(std::size_t(numberOfThreads * casesPerThread + 1), lines.size());
+    for (std::size_t i = 1; i < lines.size(); ++i)
+    {
+      CPPUNIT_ASSERT_EQUAL_MESSAGE("Every row should have all columns", std::size_t(7), std::size_t(std::count(lines[i].begin(), lines[i].end(), ';')));
+    }
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkCLResultStreamWriter)
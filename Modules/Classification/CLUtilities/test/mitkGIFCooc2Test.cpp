@@ -16,6 +16,9 @@ found in the LICENSE file.
 #include <cmath>
 
 #include <mitkGIFCooccurenceMatrix2.h>
+#include <mitkITKImageImport.h>
+
+#include <itkImageRegionIterator.h>
 
 class mitkGIFCooc2TestSuite : public mitk::TestFixture
 {
@@ -23,6 +26,7 @@ class mitkGIFCooc2TestSuite : public mitk::TestFixture
 
   MITK_TEST(ImageDescription_PhantomTest_3D);
   MITK_TEST(ImageDescription_PhantomTest_2D);
+  MITK_TEST(Direction1_SyntheticTest_3D);
 
   CPPUNIT_TEST_SUITE_END();
 
@@ -32,6 +36,21 @@ private:
   mitk::Image::Pointer m_IBSI_Phantom_Mask_Small;
   mitk::Image::Pointer m_IBSI_Phantom_Mask_Large;
 
+  template <typename TPixel>
+  static mitk::Image::Pointer CreateImage(const itk::Size<3> &size, const std::vector<TPixel> &values)
+  {
+    typedef itk::Image<TPixel, 3> ImageType;
+    typename ImageType::Pointer itkImage = ImageType::New();
+    itkImage->SetRegions(size);
+    itkImage->Allocate();
+    itk::ImageRegionIterator<ImageType> iter(itkImage, itkImage->GetLargestPossibleRegion());
+    for (std::size_t i = 0; !iter.IsAtEnd(); ++iter, ++i)
+    {
+      iter.Set(values[i]);
+    }
+    return mitk::GrabItkImageMemory(itkImage);
+  }
+
 public:
 
   void setUp(void) override
@@ -242,6 +261,46 @@ public:
     CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("SliceWise Mean Co-occurenced Based Features::Mean Second Row-Column Entropy with Large IBSI Phantom Image", 2.24761, results["SliceWise Mean Co-occurenced Based Features::Mean Second Row-Column Entropy"], 0.001);
   }
 
+
+  void Direction1_SyntheticTest_3D()
+  {
+    // Image with 2 x 1 x 2 voxels, x runs fastest. Direction 1 only uses the offset in z direction, which
+    // pairs the bins (0, 1) and (1, 1), so the symmetric matrix is p(0,1) = p(1,0) = 0.25 and p(1,1) = 0.5.
+    itk::Size<3> size = { { 2, 1, 2 } };
+    auto image = CreateImage<double>(size, { 1, 2, 2, 2 });
+    auto mask = CreateImage<unsigned short>(size, { 1, 1, 1, 1 });
+
+    mitk::GIFCooccurenceMatrix2::Pointer featureCalculator = mitk::GIFCooccurenceMatrix2::New();
+    featureCalculator->SetUseBinsize(true);
+    featureCalculator->SetBinsize(1.0);
+    featureCalculator->SetUseMinimumIntensity(true);
+    featureCalculator->SetUseMaximumIntensity(true);
+    featureCalculator->SetMinimumIntensity(0.5);
+    featureCalculator->SetMaximumIntensity(2.5);
+    featureCalculator->SetDirection(1);
+
+    auto featureList = featureCalculator->CalculateFeatures(image, mask);
+
+    std::map<std::string, double> results;
+    for (auto valuePair : featureList)
+    {
+      results[valuePair.first] = valuePair.second;
+    }
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Co-occurrence features should calculate 93 features.", std::size_t(93), featureList.size());
+
+    // Calculated by hand
+    CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Co-occurenced Based Features::Overall Joint Maximum with direction 1", 0.5, results["Co-occurenced Based Features::Overall Joint Maximum"], 1e-9);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Co-occurenced Based Features::Overall Joint Average with direction 1", 1.75, results["Co-occurenced Based Features::Overall Joint Average"], 1e-9);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Co-occurenced Based Features::Overall Joint Entropy with direction 1", 1.5, results["Co-occurenced Based Features::Overall Joint Entropy"], 1e-9);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Co-occurenced Based Features::Overall Difference Average with direction 1", 0.5, results["Co-occurenced Based Features::Overall Difference Average"], 1e-9);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Co-occurenced Based Features::Overall Sum Average with direction 1", 3.5, results["Co-occurenced Based Features::Overall Sum Average"], 1e-9);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Co-occurenced Based Features::Overall Angular Second Moment with direction 1", 0.375, results["Co-occurenced Based Features::Overall Angular Second Moment"], 1e-9);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Co-occurenced Based Features::Overall Contrast with direction 1", 0.5, results["Co-occurenced Based Features::Overall Contrast"], 1e-9);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Co-occurenced Based Features::Overall Autocorrelation with direction 1", 3.0, results["Co-occurenced Based Features::Overall Autocorrelation"], 1e-9);
+    // A single offset: the mean equals the overall value, the standard deviation is zero
+    CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Co-occurenced Based Features::Mean Joint Maximum with direction 1", 0.5, results["Co-occurenced Based Features::Mean Joint Maximum"], 1e-9);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Co-occurenced Based Features::Std.Dev. Joint Maximum with direction 1", 0.0, results["Co-occurenced Based Features::Std.Dev. Joint Maximum"], 1e-9);
+  }
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkGIFCooc2 )
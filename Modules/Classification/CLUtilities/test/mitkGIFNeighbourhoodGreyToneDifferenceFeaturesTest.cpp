@@ -16,6 +16,10 @@ found in the LICENSE file.
 #include <cmath>
 
 #include <mitkGIFNeighbourhoodGreyToneDifferenceFeatures.h>
+#include <mitkITKImageImport.h>
+
+#include <itkImageRegionIterator.h>
+#include <limits>
 
 class mitkGIFNeighbourhoodGreyToneDifferenceFeaturesTestSuite : public mitk::TestFixture
 {
@@ -23,6 +27,7 @@ class mitkGIFNeighbourhoodGreyToneDifferenceFeaturesTestSuite : public mitk::Tes
 
   MITK_TEST(ImageDescription_PhantomTest_3D);
   MITK_TEST(ImageDescription_PhantomTest_2D);
+  MITK_TEST(NaNFreeMask_SyntheticTest_3D);
 
   CPPUNIT_TEST_SUITE_END();
 
@@ -32,6 +37,33 @@ private:
   mitk::Image::Pointer m_IBSI_Phantom_Mask_Small;
   mitk::Image::Pointer m_IBSI_Phantom_Mask_Large;
 
+  template <typename TPixel>
+  static mitk::Image::Pointer CreateImage(const itk::Size<3> &size, const std::vector<TPixel> &values)
+  {
+    typedef itk::Image<TPixel, 3> ImageType;
+    typename ImageType::Pointer itkImage = ImageType::New();
+    itkImage->SetRegions(size);
+    itkImage->Allocate();
+    itk::ImageRegionIterator<ImageType> iter(itkImage, itkImage->GetLargestPossibleRegion());
+    for (std::size_t i = 0; !iter.IsAtEnd(); ++iter, ++i)
+    {
+      iter.Set(values[i]);
+    }
+    return mitk::GrabItkImageMemory(itkImage);
+  }
+
+  static mitk::GIFNeighbourhoodGreyToneDifferenceFeatures::Pointer CreateFeatureCalculator()
+  {
+    mitk::GIFNeighbourhoodGreyToneDifferenceFeatures::Pointer featureCalculator = mitk::GIFNeighbourhoodGreyToneDifferenceFeatures::New();
+    featureCalculator->SetUseBinsize(true);
+    featureCalculator->SetBinsize(1.0);
+    featureCalculator->SetUseMinimumIntensity(true);
+    featureCalculator->SetUseMaximumIntensity(true);
+    featureCalculator->SetMinimumIntensity(0.5);
+    featureCalculator->SetMaximumIntensity(2.5);
+    return featureCalculator;
+  }
+
 public:
 
   void setUp(void) override
@@ -102,6 +134,49 @@ public:
     CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("SliceWise Mean Neighbourhood Grey Tone Difference::Strength with Large IBSI Phantom Image", 2.88, results["SliceWise Mean Neighbourhood Grey Tone Difference::Strength"], 0.01);
   }
 
+
+  void NaNFreeMask_SyntheticTest_3D()
+  {
+    // Image with 3 x 1 x 1 voxels, the last one is NaN and excluded by the NaN-free mask
+    itk::Size<3> size = { { 3, 1, 1 } };
+    auto image = CreateImage<double>(size, { 1, 2, std::numeric_limits<double>::quiet_NaN() });
+    auto mask = CreateImage<unsigned short>(size, { 1, 1, 1 });
+    auto maskNoNaN = CreateImage<unsigned short>(size, { 1, 1, 0 });
+
+    auto featureCalculator = CreateFeatureCalculator();
+    mitk::AbstractGlobalImageFeature::ParameterTypes parameter;
+    parameter[featureCalculator->GetLongName()] = us::Any(true);
+    featureCalculator->SetParameter(parameter);
+    mitk::AbstractGlobalImageFeature::FeatureListType featureList;
+    featureCalculator->CalculateFeaturesUsingParameters(image, mask, maskNoNaN, featureList);
+
+    std::map<std::string, double> results;
+    for (auto valuePair : featureList)
+    {
+      results[valuePair.first] = valuePair.second;
+    }
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("NGTD should calculate 5 features.", std::size_t(5), featureList.size());
+
+    // Calculated by hand: neighbours outside of the image are replaced by the closest voxel, so the
+    // neighbourhood means are 35/26 (bin 1) and 25/17 (bin 2), giving s = (9/26, 9/17) and p = (0.5, 0.5).
+    CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Neighbourhood Grey Tone Difference::Coarsness on the NaN-free mask", 2.28423773, results["Neighbourhood Grey Tone Difference::Coarsness"], 1e-6);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Neighbourhood Grey Tone Difference::Contrast on the NaN-free mask", 0.10944570, results["Neighbourhood Grey Tone Difference::Contrast"], 1e-6);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Neighbourhood Grey Tone Difference::Busyness on the NaN-free mask", 0.43778281, results["Neighbourhood Grey Tone Difference::Busyness"], 1e-6);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Neighbourhood Grey Tone Difference::Complexity on the NaN-free mask", 0.43778281, results["Neighbourhood Grey Tone Difference::Complexity"], 1e-6);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Neighbourhood Grey Tone Difference::Strength on the NaN-free mask", 2.28423773, results["Neighbourhood Grey Tone Difference::Strength"], 1e-6);
+
+    // The same values as a direct calculation on the NaN-free mask, but not on the mask with the NaN voxel
+    auto expected = CreateFeatureCalculator()->CalculateFeatures(image, maskNoNaN);
+    auto withNaN = CreateFeatureCalculator()->CalculateFeatures(image, mask);
+    CPPUNIT_ASSERT_EQUAL(expected.size(), featureList.size());
+    bool differsFromNaNMask = false;
+    for (std::size_t i = 0; i < expected.size(); ++i)
+    {
+      CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(expected[i].first, expected[i].second, featureList[i].second, 1e-9);
+      differsFromNaNMask = differsFromNaNMask || std::abs(withNaN[i].second - featureList[i].second) > 1e-6;
+    }
+    CPPUNIT_ASSERT_MESSAGE("NGTD features should not be calculated on the mask with NaN voxels", differsFromNaNMask);
+  }
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkGIFNeighbourhoodGreyToneDifferenceFeatures )
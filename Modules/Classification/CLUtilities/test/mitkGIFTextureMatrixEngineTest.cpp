@@ -0,0 +1,656 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <mitkTestingMacros.h>
+#include <mitkTestFixture.h>
+#include "mitkIOUtil.h"
+#include <cmath>
+#include <sstream>
+
+#include <mitkImageAccessByItk.h>
+#include <mitkImageCast.h>
+#include <mitkTextureMatrixEngine.h>
+#include <mitkGIFCooccurenceMatrix2.h>
+#include <mitkGIFGreyLevelRunLength.h>
+#include <mitkGIFGreyLevelSizeZone.h>
+#include <mitkGIFNeighbourhoodGreyToneDifferenceFeatures.h>
+#include <mitkGIFNeighbouringGreyLevelDependenceFeatures.h>
+
+#include <itkEnhancedScalarImageToRunLengthFeaturesFilter.h>
+#include <itkImageRegionConstIterator.h>
+#include <itkImageRegionIteratorWithIndex.h>
+#include <itkNeighborhoodIterator.h>
+#include <itkShapedNeighborhoodIterator.h>
+
+// Reference implementations: the ITK iterator loops the feature classes used before they were moved to the
+// TextureMatrixEngine. They bin with the IntensityQuantifier; the old loops did not clamp the bin index, which only
+// makes a difference for intensities outside of the range of the quantifier.
+namespace
+{
+  template<typename TPixel, unsigned int VImageDimension>
+  void ReferenceCooccurrenceMatrix(itk::Image<TPixel, VImageDimension>* itkImage, mitk::Image::Pointer mask,
+                                   mitk::TextureMatrixEngine::OffsetType engineOffset, int range,
+                                   mitk::IntensityQuantifier* quantifier, Eigen::MatrixXd &matrix)
+  {
+    typedef itk::Image<TPixel, VImageDimension> ImageType;
+    typedef itk::Image<unsigned short, VImageDimension> MaskImageType;
+
+    typename MaskImageType::Pointer itkMask = MaskImageType::New();
+    mitk::CastToItkImage(mask, itkMask);
+
+    itk::Offset<VImageDimension> offset;
+    for (unsigned int i = 0; i < VImageDimension; ++i)
+    {
+      offset[i] = engineOffset[i];
+    }
+
+    itk::Size<VImageDimension> radius;
+    radius.Fill(range + 1);
+    itk::ShapedNeighborhoodIterator<ImageType> imageOffsetIter(radius, itkImage, itkImage->GetLargestPossibleRegion());
+    itk::ShapedNeighborhoodIterator<MaskImageType> maskOffsetIter(radius, itkMask, itkMask->GetLargestPossibleRegion());
+    imageOffsetIter.ActivateOffset(offset);
+    maskOffsetIter.ActivateOffset(offset);
+    itk::ImageRegionConstIterator<ImageType> imageIter(itkImage, itkImage->GetLargestPossibleRegion());
+    itk::ImageRegionConstIterator<MaskImageType> maskIter(itkMask, itkMask->GetLargestPossibleRegion());
+    auto region = itkMask->GetLargestPossibleRegion();
+
+    matrix = Eigen::MatrixXd::Zero(quantifier->GetBins(), quantifier->GetBins());
+    while (!maskIter.IsAtEnd())
+    {
+      auto ciMask = maskOffsetIter.Begin();
+      auto ciValue = imageOffsetIter.Begin();
+      if (maskIter.Value() > 0 &&
+        ciMask.Get() > 0 &&
+        imageIter.Get() == imageIter.Get() &&
+        ciValue.Get() == ciValue.Get() &&
+        region.IsInside(maskOffsetIter.GetIndex() + ciMask.GetNeighborhoodOffset()))
+      {
+        int i = quantifier->IntensityToIndex(imageIter.Get());
+        int j = quantifier->IntensityToIndex(ciValue.Get());
+        matrix(i, j) += 1;
+        matrix(j, i) += 1;
+      }
+      ++imageOffsetIter;
+      ++maskOffsetIter;
+      ++imageIter;
+      ++maskIter;
+    }
+  }
+
+  template<typename TPixel, unsigned int VImageDimension>
+  void ReferenceNGTDVectors(itk::Image<TPixel, VImageDimension>* itkImage, mitk::Image::Pointer mask, int range,
+                            mitk::IntensityQuantifier* quantifier, std::vector<double> &pVector, std::vector<double> &sVector)
+  {
+    typedef itk::Image<TPixel, VImageDimension> ImageType;
+    typedef itk::Image<unsigned short, VImageDimension> MaskType;
+
+    typename MaskType::Pointer itkMask = MaskType::New();
+    mitk::CastToItkImage(mask, itkMask);
+
+    typename ImageType::SizeType regionSize;
+    regionSize.Fill(range);
+
+    itk::NeighborhoodIterator<ImageType> iter(regionSize, itkImage, itkImage->GetLargestPossibleRegion());
+    itk::NeighborhoodIterator<MaskType> iterMask(regionSize, itkMask, itkMask->GetLargestPossibleRegion());
+
+    pVector.assign(quantifier->GetBins(), 0);
+    sVector.assign(quantifier->GetBins(), 0);
+    while (!iter.IsAtEnd())
+    {
+      if (iterMask.GetCenterPixel() > 0)
+      {
+        int localCount = 0;
+        double localMean = 0;
+        unsigned int localIndex = quantifier->IntensityToIndex(iter.GetCenterPixel());
+        for (itk::SizeValueType i = 0; i < iter.Size(); ++i)
+        {
+          if (i == (iter.Size() / 2))
+            continue;
+          if (iterMask.GetPixel(i) > 0)
+          {
+            ++localCount;
+            localMean += quantifier->IntensityToIndex(iter.GetPixel(i)) + 1;
+          }
+        }
+        if (localCount > 0)
+        {
+          localMean /= localCount;
+        }
+        pVector[localIndex] += 1;
+        sVector[localIndex] += std::abs<double>(localIndex + 1 - localMean);
+      }
+      ++iterMask;
+      ++iter;
+    }
+  }
+
+  template<typename TPixel, unsigned int VImageDimension>
+  void ReferenceNGLDMMatrix(itk::Image<TPixel, VImageDimension>* itkImage, mitk::Image::Pointer mask, int alpha, int range,
+                            unsigned int direction, mitk::IntensityQuantifier* quantifier,
+                            mitk::TextureMatrixEngine::NeighbourhoodMatrices &result)
+  {
+    typedef itk::Image<TPixel, VImageDimension> ImageType;
+    typedef itk::Image<unsigned short, VImageDimension> MaskImageType;
+
+    typename MaskImageType::Pointer itkMask = MaskImageType::New();
+    mitk::CastToItkImage(mask, itkMask);
+
+    itk::Size<VImageDimension> radius;
+    radius.Fill(range);
+    if ((direction > 1) && (direction - 2 < VImageDimension))
+    {
+      radius[direction - 2] = 0;
+    }
+
+    itk::NeighborhoodIterator<ImageType> imageIter(radius, itkImage, itkImage->GetLargestPossibleRegion());
+    itk::NeighborhoodIterator<MaskImageType> maskIter(radius, itkMask, itkMask->GetLargestPossibleRegion());
+    auto region = itkMask->GetLargestPossibleRegion();
+    auto center = imageIter.Size() / 2;
+    auto iterSize = imageIter.Size();
+
+    result.NeighbourhoodSize = iterSize - 1;
+    result.DependenceMatrix = Eigen::MatrixXd::Zero(quantifier->GetBins(), iterSize);
+    while (!maskIter.IsAtEnd())
+    {
+      int sameValues = 0;
+      bool completeNeighbourhood = true;
+
+      if ((imageIter.GetCenterPixel() != imageIter.GetCenterPixel()) ||
+        (maskIter.GetCenterPixel() < 1))
+      {
+        ++imageIter;
+        ++maskIter;
+        continue;
+      }
+      int i = quantifier->IntensityToIndex(imageIter.GetCenterPixel());
+
+      for (unsigned int position = 0; position < iterSize; ++position)
+      {
+        if (position == center)
+        {
+          continue;
+        }
+        if (!region.IsInside(maskIter.GetIndex(position)))
+        {
+          completeNeighbourhood = false;
+          continue;
+        }
+        bool isInBounds;
+        auto jIntensity = imageIter.GetPixel(position, isInBounds);
+        auto jMask = maskIter.GetPixel(position, isInBounds);
+        if (jMask < 1 || (jIntensity != jIntensity) || (!isInBounds))
+        {
+          completeNeighbourhood = false;
+          continue;
+        }
+
+        int j = quantifier->IntensityToIndex(jIntensity);
+        result.NumberOfNeighbourVoxels += 1;
+        if (std::abs(i - j) <= alpha)
+        {
+          result.NumberOfDependenceNeighbourVoxels += 1;
+          ++sameValues;
+        }
+      }
+      result.DependenceMatrix(i, sameValues) += 1;
+      result.NumberOfNeighbourhoods += 1;
+      if (completeNeighbourhood)
+      {
+        result.NumberOfCompleteNeighbourhoods += 1;
+      }
+
+      ++imageIter;
+      ++maskIter;
+    }
+  }
+
+  template<typename TPixel, unsigned int VImageDimension>
+  int ReferenceSizeZonePass(itk::Image<TPixel, VImageDimension>* itkImage, itk::Image<unsigned short, VImageDimension>* mask,
+                              const mitk::TextureMatrixEngine::OffsetVectorType &engineOffsets, bool estimateLargestRegion,
+                              mitk::IntensityQuantifier* quantifier, Eigen::MatrixXd &matrix)
+  {
+    typedef itk::Image<TPixel, VImageDimension> ImageType;
+    typedef itk::Image<unsigned short, VImageDimension> MaskImageType;
+    typedef typename ImageType::IndexType IndexType;
+
+    std::vector<itk::Offset<VImageDimension> > offsets;
+    for (const auto &engineOffset : engineOffsets)
+    {
+      itk::Offset<VImageDimension> offset;
+      for (unsigned int i = 0; i < VImageDimension; ++i)
+      {
+        offset[i] = engineOffset[i];
+      }
+      offsets.push_back(offset);
+    }
+
+    auto region = mask->GetLargestPossibleRegion();
+    itk::ImageRegionIteratorWithIndex<ImageType> imageIter(itkImage, itkImage->GetLargestPossibleRegion());
+    itk::ImageRegionIteratorWithIndex<MaskImageType> maskIter(mask, region);
+
+    typename MaskImageType::Pointer visitedImage = MaskImageType::New();
+    visitedImage->SetRegions(region);
+    visitedImage->Allocate();
+    visitedImage->FillBuffer(0);
+
+    int largestRegion = 0;
+    while (!maskIter.IsAtEnd())
+    {
+      if (maskIter.Value() > 0)
+      {
+        auto startIntensityIndex = quantifier->IntensityToIndex(imageIter.Value());
+        std::vector<IndexType> indices;
+        indices.push_back(maskIter.GetIndex());
+        int steps = 0;
+
+        while (indices.size() > 0)
+        {
+          auto currentIndex = indices.back();
+          indices.pop_back();
+
+          if (!region.IsInside(currentIndex))
+          {
+            continue;
+          }
+
+          if ((mask->GetPixel(currentIndex) > 0) &&
+            (quantifier->IntensityToIndex(itkImage->GetPixel(currentIndex)) == startIntensityIndex) &&
+            (visitedImage->GetPixel(currentIndex) < 1))
+          {
+            ++steps;
+            visitedImage->SetPixel(currentIndex, 1);
+            for (auto offset : offsets)
+            {
+              indices.push_back(currentIndex + offset);
+              indices.push_back(currentIndex - offset);
+            }
+          }
+        }
+        if (steps > 0)
+        {
+          largestRegion = std::max<int>(steps, largestRegion);
+          if (!estimateLargestRegion)
+          {
+            matrix(startIntensityIndex, std::min<int>(steps, matrix.cols()) - 1) += 1;
+          }
+        }
+      }
+      ++imageIter;
+      ++maskIter;
+    }
+    return largestRegion;
+  }
+
+  template<typename TPixel, unsigned int VImageDimension>
+  void ReferenceSizeZoneMatrix(itk::Image<TPixel, VImageDimension>* itkImage, mitk::Image::Pointer mask,
+                               mitk::TextureMatrixEngine::OffsetVectorType offsets,
+                               mitk::IntensityQuantifier* quantifier, Eigen::MatrixXd &matrix)
+  {
+    typedef itk::Image<unsigned short, VImageDimension> MaskImageType;
+    typename MaskImageType::Pointer itkMask = MaskImageType::New();
+    mitk::CastToItkImage(mask, itkMask);
+
+    // The first pass only determines the size of the largest zone
+    int largestRegion = ReferenceSizeZonePass<TPixel, VImageDimension>(itkImage, itkMask, offsets, true, quantifier, matrix);
+    matrix = Eigen::MatrixXd::Zero(quantifier->GetBins(), largestRegion);
+    ReferenceSizeZonePass<TPixel, VImageDimension>(itkImage, itkMask, offsets, false, quantifier, matrix);
+  }
+
+  /** Run length features (mean, standard deviation and combined value per feature) as calculated by the
+  * ITK filter that was used before the texture matrix engine, including the switch to 256 bins for a single bin.*/
+  template<typename TPixel, unsigned int VImageDimension>
+  void ReferenceRunLengthFeatures(itk::Image<TPixel, VImageDimension>* itkImage, mitk::Image::Pointer mask,
+                                  mitk::IntensityQuantifier* quantifier, std::vector<double> &features)
+  {
+    typedef itk::Image<TPixel, VImageDimension> ImageType;
+    typedef itk::Statistics::EnhancedScalarImageToRunLengthFeaturesFilter<ImageType> FilterType;
+    typedef typename FilterType::RunLengthFeaturesFilterType TextureFilterType;
+
+    typename ImageType::Pointer maskImage = ImageType::New();
+    mitk::CastToItkImage(mask, maskImage);
+
+    typename FilterType::FeatureNameVectorPointer requestedFeatures = FilterType::FeatureNameVector::New();
+    for (int feature = TextureFilterType::ShortRunEmphasis; feature <= TextureFilterType::RunEntropy; ++feature)
+    {
+      requestedFeatures->push_back(feature);
+    }
+
+    int numberOfBins = quantifier->GetBins();
+    if (numberOfBins < 2)
+      numberOfBins = 256;
+
+    typename FilterType::Pointer filter = FilterType::New();
+    typename FilterType::Pointer combinedFilter = FilterType::New();
+    for (auto currentFilter : { filter, combinedFilter })
+    {
+      currentFilter->SetInput(itkImage);
+      currentFilter->SetMaskImage(maskImage);
+      currentFilter->SetRequestedFeatures(requestedFeatures);
+      currentFilter->SetPixelValueMinMax(quantifier->GetMinimum(), quantifier->GetMaximum());
+      currentFilter->SetNumberOfBinsPerAxis(numberOfBins);
+      currentFilter->SetDistanceValueMinMax(0, numberOfBins);
+    }
+    combinedFilter->CombinedFeatureCalculationOn();
+    filter->Update();
+    combinedFilter->Update();
+
+    auto featureMeans = filter->GetFeatureMeans();
+    auto featureStd = filter->GetFeatureStandardDeviations();
+    auto featureCombined = combinedFilter->GetFeatureMeans();
+    features.clear();
+    for (std::size_t i = 0; i < featureMeans->size(); ++i)
+    {
+      features.push_back(featureMeans->ElementAt(i));
+      features.push_back(featureStd->ElementAt(i));
+      double combined = featureCombined->ElementAt(i);
+      if (i == TextureFilterType::RunPercentage)
+      {
+        combined /= filter->GetOffsets()->size();
+      }
+      features.push_back(combined);
+    }
+  }
+
+  /** Offsets of the first half of a neighbourhood with radius 1, multiplied by range*/
+  mitk::TextureMatrixEngine::OffsetVectorType HalfNeighbourhoodOffsets(long range)
+  {
+    mitk::TextureMatrixEngine::OffsetVectorType offsets;
+    for (unsigned int d = 0; d < 13; ++d)
+    {
+      mitk::TextureMatrixEngine::OffsetType offset = { { (static_cast<long>(d % 3) - 1) * range,
+        (static_cast<long>((d / 3) % 3) - 1) * range, (static_cast<long>(d / 9) - 1) * range } };
+      offsets.push_back(offset);
+    }
+    return offsets;
+  }
+}
+
+class mitkGIFTextureMatrixEngineTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkGIFTextureMatrixEngineTestSuite);
+
+  MITK_TEST(SharedEngine_PhantomTest_3D);
+  MITK_TEST(NumberOfThreads_PhantomTest_3D);
+  MITK_TEST(Cooccurrence_ReferenceTest_3D);
+  MITK_TEST(Neighbourhood_ReferenceTest_3D);
+  MITK_TEST(SizeZone_ReferenceTest_3D);
+  MITK_TEST(RunLength_ReferenceTest_3D);
+  MITK_TEST(RunLength_OutOfRange_ReferenceTest_3D);
+  MITK_TEST(RunLength_MaskValues_ReferenceTest_3D);
+  MITK_TEST(RunLength_SingleBin_ReferenceTest_3D);
+
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  mitk::Image::Pointer m_IBSI_Phantom_Image_Large;
+  mitk::Image::Pointer m_IBSI_Phantom_Mask_Large;
+
+  static void ConfigureQuantifier(mitk::AbstractGlobalImageFeature *featureCalculator)
+  {
+    featureCalculator->SetUseBinsize(true);
+    featureCalculator->SetBinsize(1.0);
+    featureCalculator->SetUseMinimumIntensity(true);
+    featureCalculator->SetUseMaximumIntensity(true);
+    featureCalculator->SetMinimumIntensity(0.5);
+    featureCalculator->SetMaximumIntensity(6.5);
+  }
+
+  std::vector<mitk::AbstractGlobalImageFeature::Pointer> CreateFeatureCalculators()
+  {
+    std::vector<mitk::AbstractGlobalImageFeature::Pointer> result;
+    result.push_back(mitk::GIFCooccurenceMatrix2::New().GetPointer());
+    result.push_back(mitk::GIFNeighbouringGreyLevelDependenceFeature::New().GetPointer());
+    result.push_back(mitk::GIFNeighbourhoodGreyToneDifferenceFeatures::New().GetPointer());
+    result.push_back(mitk::GIFGreyLevelSizeZone::New().GetPointer());
+    result.push_back(mitk::GIFGreyLevelRunLength::New().GetPointer());
+    for (auto featureCalculator : result)
+    {
+      ConfigureQuantifier(featureCalculator);
+    }
+    return result;
+  }
+
+  static void AssertEqualFeatures(const mitk::AbstractGlobalImageFeature::FeatureListType &expected,
+                                  const mitk::AbstractGlobalImageFeature::FeatureListType &actual)
+  {
+    CPPUNIT_ASSERT_EQUAL(expected.size(), actual.size());
+    for (std::size_t i = 0; i < expected.size(); ++i)
+    {
+      CPPUNIT_ASSERT_EQUAL(expected[i].first, actual[i].first);
+      if (std::isnan(expected[i].second))
+      {
+        CPPUNIT_ASSERT_MESSAGE(actual[i].first, std::isnan(actual[i].second));
+      }
+      else
+      {
+        CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(actual[i].first, expected[i].second, actual[i].second, 1e-9 * (1 + std::abs(expected[i].second)));
+      }
+    }
+  }
+
+  static void AssertEqualMatrices(const std::string &message, const Eigen::MatrixXd &expected, const Eigen::MatrixXd &actual)
+  {
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(message + " rows", expected.rows(), actual.rows());
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(message + " columns", expected.cols(), actual.cols());
+    CPPUNIT_ASSERT_MESSAGE(message, expected.size() == 0 || (expected - actual).cwiseAbs().maxCoeff() < 1e-9);
+  }
+
+  /** Compares the run length features with the ITK filter for the quantifier given by minimum, maximum and binsize.*/
+  static void AssertRunLengthReference(const mitk::Image::Pointer &image, const mitk::Image::Pointer &mask,
+                                       double minimum, double maximum, double binsize)
+  {
+    mitk::IntensityQuantifier::Pointer quantifier = mitk::IntensityQuantifier::New();
+    quantifier->InitializeByBinsizeAndMaximum(minimum, maximum, binsize);
+    std::vector<double> expected;
+    AccessByItk_n(image, ReferenceRunLengthFeatures, (mask, quantifier.GetPointer(), expected));
+
+    mitk::GIFGreyLevelRunLength::Pointer featureCalculator = mitk::GIFGreyLevelRunLength::New();
+    featureCalculator->SetUseBinsize(true);
+    featureCalculator->SetBinsize(binsize);
+    featureCalculator->SetUseMinimumIntensity(true);
+    featureCalculator->SetUseMaximumIntensity(true);
+    featureCalculator->SetMinimumIntensity(minimum);
+    featureCalculator->SetMaximumIntensity(maximum);
+    auto featureList = featureCalculator->CalculateFeatures(image, mask);
+
+    CPPUNIT_ASSERT_EQUAL(expected.size(), featureList.size());
+    for (std::size_t i = 0; i < expected.size(); ++i)
+    {
+      CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(featureList[i].first, expected[i], featureList[i].second, 1e-9 * (1 + std::abs(expected[i])));
+    }
+  }
+
+  mitk::IntensityQuantifier::Pointer CreateQuantifier()
+  {
+    mitk::IntensityQuantifier::Pointer quantifier = mitk::IntensityQuantifier::New();
+    quantifier->InitializeByBinsizeAndMaximum(0.5, 6.5, 1.0);
+    return quantifier;
+  }
+
+public:
+
+  void setUp(void) override
+  {
+    m_IBSI_Phantom_Image_Large = mitk::IOUtil::Load<mitk::Image>(GetTestDataFilePath("Radiomics/IBSI_Phantom_Image_Large.nrrd"));
+    m_IBSI_Phantom_Mask_Large = mitk::IOUtil::Load<mitk::Image>(GetTestDataFilePath("Radiomics/IBSI_Phantom_Mask_Large.nrrd"));
+  }
+
+  void SharedEngine_PhantomTest_3D()
+  {
+    // Every calculator with its own engine
+    mitk::AbstractGlobalImageFeature::FeatureListType expected;
+    for (auto featureCalculator : CreateFeatureCalculators())
+    {
+      auto featureList = featureCalculator->CalculateFeatures(m_IBSI_Phantom_Image_Large, m_IBSI_Phantom_Mask_Large);
+      expected.insert(expected.end(), featureList.begin(), featureList.end());
+    }
+
+    // All calculators share one engine
+    mitk::TextureMatrixEngine::Pointer engine = mitk::TextureMatrixEngine::New();
+    mitk::AbstractGlobalImageFeature::FeatureListType actual;
+    for (auto featureCalculator : CreateFeatureCalculators())
+    {
+      featureCalculator->SetTextureMatrixEngine(engine);
+      auto featureList = featureCalculator->CalculateFeatures(m_IBSI_Phantom_Image_Large, m_IBSI_Phantom_Mask_Large);
+      actual.insert(actual.end(), featureList.begin(), featureList.end());
+    }
+
+    AssertEqualFeatures(expected, actual);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Image should be quantized only once", 1u, engine->GetNumberOfQuantizations());
+    // co-occurrence, neighbourhood (shared by NGLD and NGTD), size zones and run lengths
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Neighbourhood matrices should be shared", 4u, engine->GetNumberOfTraversals());
+
+    // A second run is served from the cache
+    for (auto featureCalculator : CreateFeatureCalculators())
+    {
+      featureCalculator->SetTextureMatrixEngine(engine);
+      featureCalculator->CalculateFeatures(m_IBSI_Phantom_Image_Large, m_IBSI_Phantom_Mask_Large);
+    }
+    CPPUNIT_ASSERT_EQUAL(1u, engine->GetNumberOfQuantizations());
+    CPPUNIT_ASSERT_EQUAL(4u, engine->GetNumberOfTraversals());
+  }
+
+  void NumberOfThreads_PhantomTest_3D()
+  {
+    mitk::AbstractGlobalImageFeature::FeatureListType expected;
+    mitk::AbstractGlobalImageFeature::FeatureListType actual;
+
+    for (unsigned int numberOfThreads : { 1u, 5u })
+    {
+      mitk::TextureMatrixEngine::Pointer engine = mitk::TextureMatrixEngine::New();
+      engine->SetNumberOfThreads(numberOfThreads);
+      auto &featureList = (numberOfThreads == 1) ? expected : actual;
+      for (auto featureCalculator : CreateFeatureCalculators())
+      {
+        featureCalculator->SetTextureMatrixEngine(engine);
+        auto localResults = featureCalculator->CalculateFeatures(m_IBSI_Phantom_Image_Large, m_IBSI_Phantom_Mask_Large);
+        featureList.insert(featureList.end(), localResults.begin(), localResults.end());
+      }
+    }
+
+    AssertEqualFeatures(expected, actual);
+  }
+
+  void Cooccurrence_ReferenceTest_3D()
+  {
+    auto quantifier = CreateQuantifier();
+    mitk::TextureMatrixEngine::Pointer engine = mitk::TextureMatrixEngine::New();
+    auto quantizedImage = engine->GetQuantizedImage(m_IBSI_Phantom_Image_Large, m_IBSI_Phantom_Mask_Large, quantifier);
+
+    for (int range : { 1, 2 })
+    {
+      auto offsets = HalfNeighbourhoodOffsets(range);
+      auto matrices = engine->GetCooccurrenceMatrices(quantizedImage, offsets);
+      CPPUNIT_ASSERT_EQUAL(offsets.size(), matrices.size());
+      for (std::size_t k = 0; k < offsets.size(); ++k)
+      {
+        Eigen::MatrixXd expected;
+        AccessByItk_n(m_IBSI_Phantom_Image_Large, ReferenceCooccurrenceMatrix, (m_IBSI_Phantom_Mask_Large, offsets[k], range, quantifier.GetPointer(), expected));
+        std::ostringstream message;
+        message << "Co-occurrence matrix of offset " << offsets[k];
+        AssertEqualMatrices(message.str(), expected, matrices[k]);
+      }
+    }
+  }
+
+  void Neighbourhood_ReferenceTest_3D()
+  {
+    auto quantifier = CreateQuantifier();
+    mitk::TextureMatrixEngine::Pointer engine = mitk::TextureMatrixEngine::New();
+    auto quantizedImage = engine->GetQuantizedImage(m_IBSI_Phantom_Image_Large, m_IBSI_Phantom_Mask_Large, quantifier);
+
+    mitk::TextureMatrixEngine::RadiusType radius;
+    radius.Fill(1);
+    auto matrices = engine->GetNeighbourhoodMatrices(quantizedImage, radius, 0);
+
+    std::vector<double> pVector;
+    std::vector<double> sVector;
+    AccessByItk_n(m_IBSI_Phantom_Image_Large, ReferenceNGTDVectors, (m_IBSI_Phantom_Mask_Large, 1, quantifier.GetPointer(), pVector, sVector));
+    CPPUNIT_ASSERT_EQUAL(pVector.size(), matrices->VoxelCounts.size());
+    for (std::size_t i = 0; i < pVector.size(); ++i)
+    {
+      CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("NGTD voxel count", pVector[i], matrices->VoxelCounts[i], 1e-9);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("NGTD difference sum", sVector[i], matrices->DifferenceSums[i], 1e-9 * (1 + sVector[i]));
+    }
+
+    // Full neighbourhood and a neighbourhood without the x direction (direction 2)
+    for (unsigned int direction : { 0u, 2u })
+    {
+      radius.Fill(1);
+      if (direction > 1)
+      {
+        radius[direction - 2] = 0;
+      }
+      matrices = engine->GetNeighbourhoodMatrices(quantizedImage, radius, 0);
+
+      mitk::TextureMatrixEngine::NeighbourhoodMatrices expected;
+      AccessByItk_n(m_IBSI_Phantom_Image_Large, ReferenceNGLDMMatrix, (m_IBSI_Phantom_Mask_Large, 0, 1, direction, quantifier.GetPointer(), expected));
+      AssertEqualMatrices("NGLD matrix", expected.DependenceMatrix, matrices->DependenceMatrix);
+      CPPUNIT_ASSERT_EQUAL(expected.NeighbourhoodSize, matrices->NeighbourhoodSize);
+      CPPUNIT_ASSERT_EQUAL(expected.NumberOfNeighbourVoxels, matrices->NumberOfNeighbourVoxels);
+      CPPUNIT_ASSERT_EQUAL(expected.NumberOfDependenceNeighbourVoxels, matrices->NumberOfDependenceNeighbourVoxels);
+      CPPUNIT_ASSERT_EQUAL(expected.NumberOfNeighbourhoods, matrices->NumberOfNeighbourhoods);
+      CPPUNIT_ASSERT_EQUAL(expected.NumberOfCompleteNeighbourhoods, matrices->NumberOfCompleteNeighbourhoods);
+    }
+  }
+
+  void SizeZone_ReferenceTest_3D()
+  {
+    auto quantifier = CreateQuantifier();
+    mitk::TextureMatrixEngine::Pointer engine = mitk::TextureMatrixEngine::New();
+    auto quantizedImage = engine->GetQuantizedImage(m_IBSI_Phantom_Image_Large, m_IBSI_Phantom_Mask_Large, quantifier);
+
+    auto offsets = HalfNeighbourhoodOffsets(1);
+    Eigen::MatrixXd expected;
+    AccessByItk_n(m_IBSI_Phantom_Image_Large, ReferenceSizeZoneMatrix, (m_IBSI_Phantom_Mask_Large, offsets, quantifier.GetPointer(), expected));
+    AssertEqualMatrices("Size zone matrix", expected, engine->GetSizeZoneMatrix(quantizedImage, offsets));
+  }
+
+  void RunLength_ReferenceTest_3D()
+  {
+    AssertRunLengthReference(m_IBSI_Phantom_Image_Large, m_IBSI_Phantom_Mask_Large, 0.5, 6.5, 1.0);
+  }
+
+  void RunLength_OutOfRange_ReferenceTest_3D()
+  {
+    // The intensities 1 and 6 of the phantom are outside of the range and must be skipped, not clamped
+    AssertRunLengthReference(m_IBSI_Phantom_Image_Large, m_IBSI_Phantom_Mask_Large, 2.0, 5.0, 1.0);
+  }
+
+  void RunLength_MaskValues_ReferenceTest_3D()
+  {
+    // Every third masked voxel gets the mask value 2, which is not part of any run
+    typedef itk::Image<unsigned short, 3> MaskType;
+    MaskType::Pointer itkMask = MaskType::New();
+    mitk::CastToItkImage(m_IBSI_Phantom_Mask_Large, itkMask);
+    itk::ImageRegionIteratorWithIndex<MaskType> maskIter(itkMask, itkMask->GetLargestPossibleRegion());
+    for (; !maskIter.IsAtEnd(); ++maskIter)
+    {
+      if (maskIter.Get() > 0 && maskIter.GetIndex()[0] % 3 == 0)
+      {
+        maskIter.Set(2);
+      }
+    }
+    mitk::Image::Pointer mask;
+    mitk::CastToMitkImage(itkMask, mask);
+
+    AssertRunLengthReference(m_IBSI_Phantom_Image_Large, mask, 0.5, 6.5, 1.0);
+  }
+
+  void RunLength_SingleBin_ReferenceTest_3D()
+  {
+    // A single bin is replaced by 256 bins
+    AssertRunLengthReference(m_IBSI_Phantom_Image_Large, m_IBSI_Phantom_Mask_Large, 0.5, 6.5, 6.0);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkGIFTextureMatrixEngine)
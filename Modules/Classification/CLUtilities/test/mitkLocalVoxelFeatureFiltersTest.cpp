@@ -0,0 +1,263 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <mitkTestingMacros.h>
+#include <mitkTestFixture.h>
+
+#include <itkLocalIntensityFilter.h>
+#include <itkLocalStatisticFilter.h>
+#include <itkMultiHistogramFilter.h>
+
+#include <itkConstNeighborhoodIterator.h>
+#include <itkImageRegionIterator.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+class mitkLocalVoxelFeatureFiltersTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkLocalVoxelFeatureFiltersTestSuite);
+
+  MITK_TEST(LocalStatistic_2D);
+  MITK_TEST(LocalStatistic_3D);
+  MITK_TEST(MultiHistogram_2D);
+  MITK_TEST(MultiHistogram_3D);
+  MITK_TEST(LocalIntensity_2D);
+  MITK_TEST(LocalIntensity_3D);
+
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+
+  template <unsigned int VDimension>
+  static typename itk::Image<double, VDimension>::Pointer CreateRandomImage(unsigned int size)
+  {
+    typedef itk::Image<double, VDimension> ImageType;
+    typename ImageType::SizeType imageSize;
+    imageSize.Fill(size);
+    // Use an odd length of the lines and a different size in each direction
+    for (unsigned int i = 0; i < VDimension; ++i)
+    {
+      imageSize[i] += 3 * i + 1;
+    }
+    typename ImageType::Pointer image = ImageType::New();
+    image->SetRegions(imageSize);
+    image->Allocate();
+
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> distribution(-50, 50);
+    itk::ImageRegionIterator<ImageType> iter(image, image->GetLargestPossibleRegion());
+    for (iter.GoToBegin(); !iter.IsAtEnd(); ++iter)
+    {
+      iter.Set(distribution(generator) / 10.0);
+    }
+    return image;
+  }
+
+  /** Reference implementation that visits the full neighbourhood of every voxel.*/
+  template <unsigned int VDimension>
+  static void CheckLocalStatistic(unsigned int imageSize, int radius)
+  {
+    typedef itk::Image<double, VDimension> ImageType;
+    auto image = CreateRandomImage<VDimension>(imageSize);
+
+    typename itk::LocalStatisticFilter<ImageType, ImageType>::Pointer filter = itk::LocalStatisticFilter<ImageType, ImageType>::New();
+    filter->SetInput(image);
+    filter->SetSize(radius);
+    filter->Update();
+
+    typename ImageType::SizeType size;
+    size.Fill(radius);
+    if (VDimension == 3)
+    {
+      size[2] = 0;
+    }
+
+    itk::ConstNeighborhoodIterator<ImageType> inputIter(size, image, image->GetLargestPossibleRegion());
+    for (; !inputIter.IsAtEnd(); ++inputIter)
+    {
+      double min = std::numeric_limits<double>::max();
+      double max = std::numeric_limits<double>::lowest();
+      double mean = 0;
+      double squaredMean = 0;
+      for (unsigned int i = 0; i < inputIter.Size(); ++i)
+      {
+        double value = inputIter.GetPixel(i);
+        min = std::min<double>(min, value);
+        max = std::max<double>(max, value);
+        mean += value / inputIter.Size();
+        squaredMean += (value*value) / inputIter.Size();
+      }
+      const auto index = inputIter.GetIndex();
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(min, filter->GetOutput(0)->GetPixel(index), 1e-12);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(max, filter->GetOutput(1)->GetPixel(index), 1e-12);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(mean, filter->GetOutput(2)->GetPixel(index), 1e-9);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(std::sqrt(std::max(0.0, squaredMean - mean*mean)), filter->GetOutput(3)->GetPixel(index), 1e-6);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(max - min, filter->GetOutput(4)->GetPixel(index), 1e-12);
+    }
+  }
+
+  template <unsigned int VDimension>
+  static void CheckMultiHistogram(unsigned int imageSize, int radius)
+  {
+    typedef itk::Image<double, VDimension> ImageType;
+    auto image = CreateRandomImage<VDimension>(imageSize);
+
+    const double offset = -3.0;
+    const double delta = 0.6;
+    const int bins = 11;
+
+    typename itk::MultiHistogramFilter<ImageType, ImageType>::Pointer filter = itk::MultiHistogramFilter<ImageType, ImageType>::New();
+    filter->SetInput(image);
+    filter->SetSize(radius);
+    filter->Update();
+
+    typename ImageType::SizeType size;
+    size.Fill(radius);
+
+    itk::ConstNeighborhoodIterator<ImageType> inputIter(size, image, image->GetLargestPossibleRegion());
+    for (; !inputIter.IsAtEnd(); ++inputIter)
+    {
+      std::vector<double> histogram(bins, 0);
+      for (unsigned int i = 0; i < inputIter.Size(); ++i)
+      {
+        double value = (inputIter.GetPixel(i) - offset) / delta;
+        auto pos = std::max(0, std::min(bins - 1, (int)(value)));
+        histogram[pos] += 1;
+      }
+      const auto index = inputIter.GetIndex();
+      for (int i = 0; i < bins; ++i)
+      {
+        CPPUNIT_ASSERT_EQUAL(histogram[i], filter->GetOutput(i)->GetPixel(index));
+      }
+    }
+  }
+
+  /** Reference implementation that visits the full spherical neighbourhood of every masked voxel.*/
+  template <unsigned int VDimension>
+  static void CheckLocalIntensity(unsigned int imageSize, double range)
+  {
+    typedef itk::Image<double, VDimension> ImageType;
+    typedef typename itk::LocalIntensityFilter<ImageType>::MaskImageType MaskImageType;
+    auto image = CreateRandomImage<VDimension>(imageSize);
+    typename ImageType::SpacingType spacing;
+    for (unsigned int i = 0; i < VDimension; ++i)
+    {
+      spacing[i] = 0.5 + 0.25 * i;
+    }
+    image->SetSpacing(spacing);
+
+    typename MaskImageType::Pointer mask = MaskImageType::New();
+    mask->CopyInformation(image);
+    mask->SetRegions(image->GetLargestPossibleRegion());
+    mask->Allocate();
+    std::mt19937 generator(7);
+    itk::ImageRegionIterator<MaskImageType> maskIter(mask, mask->GetLargestPossibleRegion());
+    for (maskIter.GoToBegin(); !maskIter.IsAtEnd(); ++maskIter)
+    {
+      maskIter.Set(generator() % 3 == 0 ? 1 : 0);
+    }
+
+    typename itk::LocalIntensityFilter<ImageType>::Pointer filter = itk::LocalIntensityFilter<ImageType>::New();
+    filter->SetInput(image);
+    filter->SetMask(mask);
+    filter->SetRange(range);
+    filter->Update();
+
+    typename ImageType::SizeType size;
+    for (unsigned int i = 0; i < VDimension; ++i)
+    {
+      size[i] = std::ceil(range / spacing[i]);
+    }
+    const auto imageRegion = image->GetLargestPossibleRegion();
+    double globalPeak = std::numeric_limits<double>::lowest();
+    double localPeak = std::numeric_limits<double>::lowest();
+    double localMaximum = std::numeric_limits<double>::lowest();
+    itk::ConstNeighborhoodIterator<ImageType> inputIter(size, image, imageRegion);
+    for (; !inputIter.IsAtEnd(); ++inputIter)
+    {
+      if (mask->GetPixel(inputIter.GetIndex()) == 0)
+      {
+        continue;
+      }
+      typename ImageType::PointType center;
+      image->TransformIndexToPhysicalPoint(inputIter.GetIndex(), center);
+      double peak = 0;
+      int count = 0;
+      for (unsigned int i = 0; i < inputIter.Size(); ++i)
+      {
+        typename ImageType::PointType point;
+        image->TransformIndexToPhysicalPoint(inputIter.GetIndex(i), point);
+        if (center.EuclideanDistanceTo(point) < range && imageRegion.IsInside(inputIter.GetIndex(i)))
+        {
+          peak += inputIter.GetPixel(i);
+          ++count;
+        }
+      }
+      peak /= count;
+      globalPeak = std::max(globalPeak, peak);
+      const double value = inputIter.GetCenterPixel();
+      if (value == localMaximum)
+      {
+        localPeak = std::max(localPeak, peak);
+      }
+      else if (value > localMaximum)
+      {
+        localMaximum = value;
+        localPeak = peak;
+      }
+    }
+
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(globalPeak, filter->GetGlobalPeak(), 1e-9);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(localPeak, filter->GetLocalPeak(), 1e-9);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(localMaximum, filter->GetLocalMaximum(), 1e-12);
+  }
+
+public:
+
+  void LocalStatistic_2D()
+  {
+    CheckLocalStatistic<2>(20, 1);
+    CheckLocalStatistic<2>(20, 6);
+  }
+
+  void LocalStatistic_3D()
+  {
+    CheckLocalStatistic<3>(10, 2);
+  }
+
+  void MultiHistogram_2D()
+  {
+    CheckMultiHistogram<2>(20, 1);
+    CheckMultiHistogram<2>(20, 6);
+  }
+
+  void MultiHistogram_3D()
+  {
+    CheckMultiHistogram<3>(10, 2);
+  }
+
+  void LocalIntensity_2D()
+  {
+    CheckLocalIntensity<2>(20, 1.0);
+    CheckLocalIntensity<2>(20, 3.2);
+  }
+
+  void LocalIntensity_3D()
+  {
+    CheckLocalIntensity<3>(10, 2.0);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkLocalVoxelFeatureFilters)
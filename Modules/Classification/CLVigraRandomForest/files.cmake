@@ -6,6 +6,7 @@ set(CPP_FILES
 
     Classifier/mitkVigraRandomForestClassifier.cpp
     Classifier/mitkPURFClassifier.cpp
+    Classifier/mitkFlatRandomForest.cpp
 
     Algorithm/itkHessianMatrixEigenvalueImageFilter.cpp
     Algorithm/itkStructureTensorEigenvalueImageFilter.cpp
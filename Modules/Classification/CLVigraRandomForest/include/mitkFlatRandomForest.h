@@ -0,0 +1,106 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef mitkFlatRandomForest_h
+#define mitkFlatRandomForest_h
+
+#include <MitkCLVigraRandomForestExports.h>
+
+#include <vigra/random_forest.hxx>
+
+#include <Eigen/Dense>
+#include <itkMultiThreader.h>
+
+#include <vector>
+
+namespace mitk
+{
+  /**
+  * \brief Read-only copy of a trained vigra::RandomForest<int> that is optimized for the prediction of many samples.
+  *
+  * The nodes of all trees are stored in one contiguous array. Every node holds the split feature, the threshold
+  * and the index of its first child; the second child always directly follows the first one. The votes of the
+  * leaves (class weights, multiplied by the number of leaf observations if the forest predicts weighted) are
+  * stored in a second array.
+  *
+  * The samples are processed in blocks. The features of a block are copied to a row-major buffer and the block
+  * is evaluated tree by tree, so that the nodes of a tree stay in the cache while all samples of the block
+  * traverse it. The blocks are distributed to the threads of an itk::MultiThreader.
+  *
+  * The results are identical to vigra::RandomForest::predictProbabilities() / predictLabels() and to
+  * VigraRandomForestClassifier::PredictWeighted(). Only threshold splits and constant probability leaves are
+  * supported, which are the only node types created by mitk::ThresholdSplit and the default vigra splitters.
+  */
+  class MITKCLVIGRARANDOMFOREST_EXPORT FlatRandomForest
+  {
+  public:
+    FlatRandomForest();
+    explicit FlatRandomForest(const vigra::RandomForest<int> &rf);
+
+    /** Converts the forest. Throws an mitk::Exception if the forest contains unsupported node types.*/
+    void Build(const vigra::RandomForest<int> &rf);
+    void Clear();
+    bool IsEmpty() const;
+
+    unsigned int GetNumberOfTrees() const;
+    unsigned int GetNumberOfClasses() const;
+    unsigned int GetNumberOfFeatures() const;
+    std::size_t GetNumberOfNodes() const;
+
+    /** Number of threads used for the prediction. 0 (default) uses the ITK global default.*/
+    void SetNumberOfThreads(unsigned int threads);
+    unsigned int GetNumberOfThreads() const;
+
+    /** Number of samples that are evaluated together against each tree (default 64).*/
+    void SetBlockSize(unsigned int blockSize);
+    unsigned int GetBlockSize() const;
+
+    /**
+    * \brief Same as vigra::RandomForest::predictProbabilities() followed by predictLabels().
+    *
+    * Samples containing NaN get a probability of zero for all classes and the label of the first class.
+    */
+    void PredictProbabilities(const Eigen::MatrixXd &X, Eigen::MatrixXd &probabilities, Eigen::MatrixXi &labels) const;
+
+    /**
+    * \brief Same as VigraRandomForestClassifier::PredictWeighted(): the votes of tree k are multiplied by
+    * treeWeights(k,0) and truncated to integers before they are accumulated.
+    */
+    void PredictWeighted(const Eigen::MatrixXd &X, const Eigen::MatrixXd &treeWeights, Eigen::MatrixXd &probabilities, Eigen::MatrixXi &labels) const;
+
+  private:
+    struct Node
+    {
+      double Threshold;
+      /** Split feature or -1 for leaves*/
+      int Feature;
+      /** Index of the first child, or index of the first vote in m_LeafVotes for leaves*/
+      int Next;
+    };
+
+    struct PredictionData;
+
+    static ITK_THREAD_RETURN_TYPE PredictCallback(void *arg);
+    void Predict(PredictionData &data) const;
+    void PredictBlock(const PredictionData &data, Eigen::Index firstRow, Eigen::Index numberOfRows, std::vector<double> &features, std::vector<double> &votes, std::vector<double> &totalWeights) const;
+
+    std::vector<Node> m_Nodes;
+    std::vector<double> m_LeafVotes;
+    std::vector<int> m_TreeRoots;
+    std::vector<int> m_ClassLabels;
+    unsigned int m_NumberOfFeatures;
+    unsigned int m_NumberOfThreads;
+    unsigned int m_BlockSize;
+  };
+}
+
+#endif //mitkFlatRandomForest_h
@@ -15,6 +15,7 @@ found in the LICENSE file.
 
 #include <MitkCLVigraRandomForestExports.h>
 #include <mitkAbstractClassifier.h>
+#include <mitkFlatRandomForest.h>
 
 //#include <vigra/multi_array.hxx>
 #include <vigra/random_forest.hxx>
@@ -65,6 +66,12 @@ namespace mitk
 
     void PrintParameter(std::ostream &str = std::cout);
 
+    /**
+    * \brief Predict() and PredictWeighted() evaluate a flattened copy of the forest (see FlatRandomForest),
+    * which is created on the first prediction after the forest changed. Enabled by default.
+    */
+    void UseFlatRandomForest(bool);
+
   private:
     // *-------------------
     // * THREADING
@@ -82,6 +89,13 @@ namespace mitk
     Parameter * m_Parameter;
     vigra::RandomForest<int> m_RandomForest;
 
+    FlatRandomForest m_FlatRandomForest;
+    bool m_UseFlatRandomForest;
+    bool m_FlatRandomForestIsOutdated;
+
+    /** Rebuilds the flat forest if necessary. Returns false if the vigra forest has to be used instead.*/
+    bool UpdateFlatRandomForest();
+
     static ITK_THREAD_RETURN_TYPE TrainTreesCallback(void *);
     static ITK_THREAD_RETURN_TYPE PredictCallback(void *);
     static ITK_THREAD_RETURN_TYPE PredictWeightedCallback(void *);
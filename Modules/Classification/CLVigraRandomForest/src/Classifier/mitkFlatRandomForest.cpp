@@ -0,0 +1,370 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <mitkFlatRandomForest.h>
+
+#include <mitkExceptionMacro.h>
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <utility>
+
+struct mitk::FlatRandomForest::PredictionData
+{
+  const Eigen::MatrixXd *Features;
+  /** nullptr for PredictProbabilities()*/
+  const Eigen::MatrixXd *TreeWeights;
+  Eigen::MatrixXd *Probabilities;
+  Eigen::MatrixXi *Labels;
+  Eigen::Index NumberOfBlocks;
+  const FlatRandomForest *Forest;
+};
+
+mitk::FlatRandomForest::FlatRandomForest()
+  : m_NumberOfFeatures(0),
+  m_NumberOfThreads(0),
+  m_BlockSize(64)
+{
+}
+
+mitk::FlatRandomForest::FlatRandomForest(const vigra::RandomForest<int> &rf)
+  : FlatRandomForest()
+{
+  this->Build(rf);
+}
+
+void mitk::FlatRandomForest::Build(const vigra::RandomForest<int> &rf)
+{
+  this->Clear();
+
+  const int numberOfTrees = rf.options_.tree_count_;
+  const int numberOfClasses = rf.ext_param_.class_count_;
+  if (numberOfTrees > static_cast<int>(rf.trees_.size()))
+  {
+    mitkThrow() << "Random forest has " << rf.trees_.size() << " trees, but expects " << numberOfTrees;
+  }
+
+  for (int l = 0; l < numberOfClasses; ++l)
+  {
+    int label;
+    rf.ext_param_.to_classlabel(l, label);
+    m_ClassLabels.push_back(label);
+  }
+
+  const bool isSampleWeighted = rf.options_.predict_weighted_;
+  const int numberOfFeatures = rf.ext_param_.column_count_;
+
+  for (int k = 0; k < numberOfTrees; ++k)
+  {
+    const auto &tree = rf.trees_[k];
+
+    // Convert the tree breadth first, so that the children of a node are stored next to each other.
+    // The root of a vigra tree follows the column and class count at index 2 of the topology.
+    std::deque<std::pair<int, std::size_t>> openNodes;
+    openNodes.emplace_back(2, m_Nodes.size());
+    m_TreeRoots.push_back(static_cast<int>(m_Nodes.size()));
+    m_Nodes.emplace_back();
+
+    while (!openNodes.empty())
+    {
+      const int vigraIndex = openNodes.front().first;
+      const std::size_t flatIndex = openNodes.front().second;
+      openNodes.pop_front();
+
+      const int typeId = vigra::NodeBase(tree.topology_, tree.parameters_, vigraIndex).typeID();
+      if (typeId == vigra::i_ThresholdNode)
+      {
+        vigra::Node<vigra::i_ThresholdNode> split(tree.topology_, tree.parameters_, vigraIndex);
+        if (split.column() < 0 || split.column() >= numberOfFeatures)
+        {
+          mitkThrow() << "Split node of tree " << k << " uses invalid feature " << split.column();
+        }
+
+        Node &node = m_Nodes[flatIndex];
+        node.Threshold = split.threshold();
+        node.Feature = split.column();
+        node.Next = static_cast<int>(m_Nodes.size());
+
+        openNodes.emplace_back(split.child(0), m_Nodes.size());
+        m_Nodes.emplace_back();
+        openNodes.emplace_back(split.child(1), m_Nodes.size());
+        m_Nodes.emplace_back();
+      }
+      else if (typeId == vigra::e_ConstProbNode)
+      {
+        vigra::Node<vigra::e_ConstProbNode> leaf(tree.topology_, tree.parameters_, vigraIndex);
+
+        Node &node = m_Nodes[flatIndex];
+        node.Threshold = 0.0;
+        node.Feature = -1;
+        node.Next = static_cast<int>(m_LeafVotes.size());
+
+        // Same vote as in vigra::RandomForest::predictProbabilities()
+        const double factor = isSampleWeighted ? leaf.weights() : 1.0;
+        for (int l = 0; l < numberOfClasses; ++l)
+        {
+          m_LeafVotes.push_back(leaf.prob_begin()[l] * factor);
+        }
+      }
+      else
+      {
+        this->Clear();
+        mitkThrow() << "Tree " << k << " contains node type " << typeId << ", which is not supported by FlatRandomForest";
+      }
+    }
+  }
+
+  m_NumberOfFeatures = numberOfFeatures;
+}
+
+void mitk::FlatRandomForest::Clear()
+{
+  m_Nodes.clear();
+  m_LeafVotes.clear();
+  m_TreeRoots.clear();
+  m_ClassLabels.clear();
+  m_NumberOfFeatures = 0;
+}
+
+bool mitk::FlatRandomForest::IsEmpty() const
+{
+  return m_TreeRoots.empty() || m_ClassLabels.empty();
+}
+
+unsigned int mitk::FlatRandomForest::GetNumberOfTrees() const
+{
+  return m_TreeRoots.size();
+}
+
+unsigned int mitk::FlatRandomForest::GetNumberOfClasses() const
+{
+  return m_ClassLabels.size();
+}
+
+unsigned int mitk::FlatRandomForest::GetNumberOfFeatures() const
+{
+  return m_NumberOfFeatures;
+}
+
+std::size_t mitk::FlatRandomForest::GetNumberOfNodes() const
+{
+  return m_Nodes.size();
+}
+
+void mitk::FlatRandomForest::SetNumberOfThreads(unsigned int threads)
+{
+  m_NumberOfThreads = threads;
+}
+
+unsigned int mitk::FlatRandomForest::GetNumberOfThreads() const
+{
+  return m_NumberOfThreads;
+}
+
+void mitk::FlatRandomForest::SetBlockSize(unsigned int blockSize)
+{
+  m_BlockSize = std::max(1u, blockSize);
+}
+
+unsigned int mitk::FlatRandomForest::GetBlockSize() const
+{
+  return m_BlockSize;
+}
+
+void mitk::FlatRandomForest::PredictProbabilities(const Eigen::MatrixXd &X, Eigen::MatrixXd &probabilities, Eigen::MatrixXi &labels) const
+{
+  PredictionData data;
+  data.Features = &X;
+  data.TreeWeights = nullptr;
+  data.Probabilities = &probabilities;
+  data.Labels = &labels;
+  this->Predict(data);
+}
+
+void mitk::FlatRandomForest::PredictWeighted(const Eigen::MatrixXd &X, const Eigen::MatrixXd &treeWeights, Eigen::MatrixXd &probabilities, Eigen::MatrixXi &labels) const
+{
+  if (treeWeights.rows() < static_cast<Eigen::Index>(this->GetNumberOfTrees()) || treeWeights.cols() < 1)
+  {
+    mitkThrow() << "Expected " << this->GetNumberOfTrees() << " tree weights, but got " << treeWeights.rows();
+  }
+
+  PredictionData data;
+  data.Features = &X;
+  data.TreeWeights = &treeWeights;
+  data.Probabilities = &probabilities;
+  data.Labels = &labels;
+  this->Predict(data);
+}
+
+void mitk::FlatRandomForest::Predict(PredictionData &data) const
+{
+  if (this->IsEmpty())
+  {
+    mitkThrow() << "Prediction with an empty random forest";
+  }
+  if (data.Features->cols() < static_cast<Eigen::Index>(m_NumberOfFeatures))
+  {
+    mitkThrow() << "Random forest needs " << m_NumberOfFeatures << " features, but got " << data.Features->cols();
+  }
+
+  const Eigen::Index numberOfRows = data.Features->rows();
+  *data.Probabilities = Eigen::MatrixXd::Zero(numberOfRows, this->GetNumberOfClasses());
+  *data.Labels = Eigen::MatrixXi::Zero(numberOfRows, 1);
+  if (numberOfRows == 0)
+  {
+    return;
+  }
+
+  data.NumberOfBlocks = (numberOfRows + m_BlockSize - 1) / m_BlockSize;
+  data.Forest = this;
+
+  unsigned int numberOfThreads = m_NumberOfThreads > 0 ? m_NumberOfThreads : itk::MultiThreader::GetGlobalDefaultNumberOfThreads();
+  numberOfThreads = static_cast<unsigned int>(std::max<Eigen::Index>(1, std::min<Eigen::Index>(numberOfThreads, data.NumberOfBlocks)));
+
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->SetNumberOfThreads(numberOfThreads);
+  threader->SetSingleMethod(PredictCallback, &data);
+  threader->SingleMethodExecute();
+}
+
+ITK_THREAD_RETURN_TYPE mitk::FlatRandomForest::PredictCallback(void *arg)
+{
+  typedef itk::MultiThreader::ThreadInfoStruct ThreadInfoType;
+  ThreadInfoType *infoStruct = static_cast<ThreadInfoType *>(arg);
+  const PredictionData *data = static_cast<PredictionData *>(infoStruct->UserData);
+  const FlatRandomForest *forest = data->Forest;
+
+  // Buffers are reused for all blocks of this thread
+  std::vector<double> features;
+  std::vector<double> votes;
+  std::vector<double> totalWeights;
+
+  const Eigen::Index numberOfRows = data->Features->rows();
+  for (Eigen::Index block = infoStruct->ThreadID; block < data->NumberOfBlocks; block += infoStruct->NumberOfThreads)
+  {
+    const Eigen::Index firstRow = block * forest->m_BlockSize;
+    const Eigen::Index rowsInBlock = std::min<Eigen::Index>(forest->m_BlockSize, numberOfRows - firstRow);
+    forest->PredictBlock(*data, firstRow, rowsInBlock, features, votes, totalWeights);
+  }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+void mitk::FlatRandomForest::PredictBlock(const PredictionData &data,
+  Eigen::Index firstRow,
+  Eigen::Index numberOfRows,
+  std::vector<double> &features,
+  std::vector<double> &votes,
+  std::vector<double> &totalWeights) const
+{
+  const Eigen::MatrixXd &X = *data.Features;
+  const bool useTreeWeights = data.TreeWeights != nullptr;
+  const std::size_t numberOfFeatures = m_NumberOfFeatures;
+  const std::size_t numberOfClasses = m_ClassLabels.size();
+
+  // Copy the samples of the block to a row-major buffer. Eigen stores X column-major, so every sample
+  // would otherwise be spread over numberOfFeatures cache lines.
+  features.resize(numberOfRows * numberOfFeatures);
+  for (std::size_t f = 0; f < numberOfFeatures; ++f)
+  {
+    const double *column = X.data() + f * X.rows() + firstRow;
+    for (Eigen::Index row = 0; row < numberOfRows; ++row)
+    {
+      features[row * numberOfFeatures + f] = column[row];
+    }
+  }
+
+  // vigra::RandomForest::predictProbabilities() does not classify samples that contain NaN in any column.
+  // A negative total weight marks these samples; without tree weights all votes are positive.
+  totalWeights.assign(numberOfRows, 0.0);
+  if (!useTreeWeights)
+  {
+    for (Eigen::Index f = 0; f < X.cols(); ++f)
+    {
+      const double *column = X.data() + f * X.rows() + firstRow;
+      for (Eigen::Index row = 0; row < numberOfRows; ++row)
+      {
+        if (std::isnan(column[row]))
+        {
+          totalWeights[row] = -1.0;
+        }
+      }
+    }
+  }
+
+  votes.assign(numberOfRows * numberOfClasses, 0.0);
+  for (std::size_t k = 0; k < m_TreeRoots.size(); ++k)
+  {
+    const Node *root = m_Nodes.data() + m_TreeRoots[k];
+    const double treeWeight = useTreeWeights ? (*data.TreeWeights)(k, 0) : 1.0;
+
+    for (Eigen::Index row = 0; row < numberOfRows; ++row)
+    {
+      if (!useTreeWeights && totalWeights[row] < 0)
+      {
+        continue;
+      }
+
+      const double *sample = features.data() + row * numberOfFeatures;
+      const Node *node = root;
+      while (node->Feature >= 0)
+      {
+        // NaN values go to the second child, as in vigra
+        node = m_Nodes.data() + node->Next + (sample[node->Feature] < node->Threshold ? 0 : 1);
+      }
+
+      const double *leafVotes = m_LeafVotes.data() + node->Next;
+      double *rowVotes = votes.data() + row * numberOfClasses;
+      if (useTreeWeights)
+      {
+        for (std::size_t l = 0; l < numberOfClasses; ++l)
+        {
+          const double vote = leafVotes[l] * treeWeight;
+          rowVotes[l] += static_cast<int>(vote);
+          totalWeights[row] += vote;
+        }
+      }
+      else
+      {
+        for (std::size_t l = 0; l < numberOfClasses; ++l)
+        {
+          rowVotes[l] += leafVotes[l];
+          totalWeights[row] += leafVotes[l];
+        }
+      }
+    }
+  }
+
+  Eigen::MatrixXd &probabilities = *data.Probabilities;
+  Eigen::MatrixXi &labels = *data.Labels;
+  for (Eigen::Index row = 0; row < numberOfRows; ++row)
+  {
+    if (!useTreeWeights && totalWeights[row] < 0)
+    {
+      labels(firstRow + row, 0) = m_ClassLabels[0];
+      continue;
+    }
+
+    const double *rowVotes = votes.data() + row * numberOfClasses;
+    std::size_t maxClass = 0;
+    for (std::size_t l = 0; l < numberOfClasses; ++l)
+    {
+      probabilities(firstRow + row, l) = rowVotes[l] / totalWeights[row];
+      if (probabilities(firstRow + row, l) > probabilities(firstRow + row, maxClass))
+      {
+        maxClass = l;
+      }
+    }
+    labels(firstRow + row, 0) = m_ClassLabels[maxClass];
+  }
+}
@@ -16,6 +16,7 @@ found in the LICENSE file.
 #include <mitkImpurityLoss.h>
 #include <mitkLinearSplitting.h>
 #include <mitkProperties.h>
+#include <mitkExceptionMacro.h>
 
 // Vigra includes
 #include <vigra/random_forest.hxx>
@@ -94,7 +95,9 @@ struct mitk::VigraRandomForestClassifier::PredictionData
 };
 
 mitk::VigraRandomForestClassifier::VigraRandomForestClassifier()
-  :m_Parameter(nullptr)
+  :m_Parameter(nullptr),
+  m_UseFlatRandomForest(true),
+  m_FlatRandomForestIsOutdated(true)
 {
   itk::SimpleMemberCommand<mitk::VigraRandomForestClassifier>::Pointer command = itk::SimpleMemberCommand<mitk::VigraRandomForestClassifier>::New();
   command->SetCallbackFunction(this, &mitk::VigraRandomForestClassifier::ConvertParameter);
@@ -120,6 +123,7 @@ void mitk::VigraRandomForestClassifier::OnlineTrain(const Eigen::MatrixXd & X_in
   vigra::MultiArrayView<2, double> X(vigra::Shape2(X_in.rows(),X_in.cols()),X_in.data());
   vigra::MultiArrayView<2, int> Y(vigra::Shape2(Y_in.rows(),Y_in.cols()),Y_in.data());
   m_RandomForest.onlineLearn(X,Y,0,true);
+  m_FlatRandomForestIsOutdated = true;
 }
 
 void mitk::VigraRandomForestClassifier::Train(const Eigen::MatrixXd & X_in, const Eigen::MatrixXi &Y_in)
@@ -164,6 +168,7 @@ void mitk::VigraRandomForestClassifier::Train(const Eigen::MatrixXd & X_in, cons
   m_RandomForest.set_options().tree_count(m_Parameter->TreeCount);
   m_RandomForest.ext_param_.class_count_ = data->m_ClassCount;
   m_RandomForest.trees_ = data->trees_;
+  m_FlatRandomForestIsOutdated = true;
 
   // Set Tree Weights to default
   m_TreeWeights = Eigen::MatrixXd(m_Parameter->TreeCount,1);
@@ -186,6 +191,13 @@ Eigen::MatrixXi mitk::VigraRandomForestClassifier::Predict(const Eigen::MatrixXd
   }
 
 
+  if (this->UpdateFlatRandomForest())
+  {
+    m_FlatRandomForest.PredictProbabilities(X_in, m_OutProbability, m_OutLabel);
+    m_Probabilities = vigra::MultiArrayView<2, double>(vigra::Shape2(m_OutProbability.rows(),m_OutProbability.cols()),m_OutProbability.data());
+    return m_OutLabel;
+  }
+
   vigra::MultiArrayView<2, double> P(vigra::Shape2(m_OutProbability.rows(),m_OutProbability.cols()),m_OutProbability.data());
   vigra::MultiArrayView<2, int> Y(vigra::Shape2(m_OutLabel.rows(),m_OutLabel.cols()),m_OutLabel.data());
   vigra::MultiArrayView<2, double> X(vigra::Shape2(X_in.rows(),X_in.cols()),X_in.data());
@@ -218,6 +230,12 @@ Eigen::MatrixXi mitk::VigraRandomForestClassifier::PredictWeighted(const Eigen::
   }
 
 
+  if (this->UpdateFlatRandomForest())
+  {
+    m_FlatRandomForest.PredictWeighted(X_in, m_TreeWeights, m_OutProbability, m_OutLabel);
+    return m_OutLabel;
+  }
+
   vigra::MultiArrayView<2, double> P(vigra::Shape2(m_OutProbability.rows(),m_OutProbability.cols()),m_OutProbability.data());
   vigra::MultiArrayView<2, int> Y(vigra::Shape2(m_OutLabel.rows(),m_OutLabel.cols()),m_OutLabel.data());
   vigra::MultiArrayView<2, double> X(vigra::Shape2(X_in.rows(),X_in.cols()),X_in.data());
@@ -245,6 +263,32 @@ Eigen::MatrixXd mitk::VigraRandomForestClassifier::GetTreeWeights() const
   return m_TreeWeights;
 }
 
+void mitk::VigraRandomForestClassifier::UseFlatRandomForest(bool val)
+{
+  m_UseFlatRandomForest = val;
+}
+
+bool mitk::VigraRandomForestClassifier::UpdateFlatRandomForest()
+{
+  if (!m_UseFlatRandomForest)
+    return false;
+
+  if (m_FlatRandomForestIsOutdated)
+  {
+    m_FlatRandomForestIsOutdated = false;
+    try
+    {
+      m_FlatRandomForest.Build(m_RandomForest);
+    }
+    catch (const mitk::Exception &e)
+    {
+      MITK_WARN("VigraRandomForestClassifier") << "Using vigra prediction: " << e.GetDescription();
+      m_FlatRandomForest.Clear();
+    }
+  }
+  return !m_FlatRandomForest.IsEmpty();
+}
+
 ITK_THREAD_RETURN_TYPE mitk::VigraRandomForestClassifier::TrainTreesCallback(void * arg)
 {
   // Get the ThreadInfoStruct
@@ -439,7 +483,7 @@ void mitk::VigraRandomForestClassifier::VigraPredictWeighted(PredictionData * da
     int maxCol = 0;
     for (int col=0;col<data->m_RandomForest.class_count();++col)
     {
-      if (data->m_Probabilities(row,col) > data->m_Probabilities(row, maxCol))
+      if (P(row,col) > P(row, maxCol))
         maxCol = col;
     }
     data->m_RandomForest.ext_param_.to_classlabel(maxCol, erg);
@@ -581,6 +625,7 @@ void mitk::VigraRandomForestClassifier::SetRandomForest(const vigra::RandomFores
   this->SetSamplesPerTree(rf.options().training_set_proportion_);
   this->UseSampleWithReplacement(rf.options().sample_with_replacement_);
   this->m_RandomForest = rf;
+  m_FlatRandomForestIsOutdated = true;
 }
 
 const vigra::RandomForest<int> & mitk::VigraRandomForestClassifier::GetRandomForest() const
@@ -23,6 +23,8 @@ found in the LICENSE file.
 #include <mitkImageCast.h>
 #include <mitkStandaloneDataStorage.h>
 
+#include <chrono>
+
 class mitkVigraRandomForestTestSuite : public mitk::TestFixture
 {
   CPPUNIT_TEST_SUITE(mitkVigraRandomForestTestSuite  );
@@ -35,6 +37,8 @@ class mitkVigraRandomForestTestSuite : public mitk::TestFixture
   MITK_TEST(TrainThreadedDecisionForest_MatlabDataSet_shouldReturnTrue);
   MITK_TEST(PredictWeightedDecisionForest_SetWeightsToZero_shouldReturnTrue);
   MITK_TEST(TrainThreadedDecisionForest_BreastCancerDataSet_shouldReturnTrue);
+  MITK_TEST(PredictFlatRandomForest_BreastCancerDataSet_EqualsVigraPrediction);
+  MITK_TEST(PredictWeightedFlatRandomForest_RandomWeights_EqualsVigraPrediction);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -172,6 +176,58 @@ public:
   }
 
 
+  // ------------------------------------------------------------------------------------------------------
+  // ------------------------------------------------------------------------------------------------------
+  /*
+  Predict the same samples with the flattened forest and with vigra. The test set is repeated
+  to get a number of samples for which the runtime of both predictors can be compared.
+  */
+  void PredictFlatRandomForest_BreastCancerDataSet_EqualsVigraPrediction()
+  {
+    classifier->Train(FeatureData_Cancer.first, LabelData_Cancer.first);
+    MatrixDoubleType features = FeatureData_Cancer.second.replicate(200, 1);
+
+    classifier->UseFlatRandomForest(false);
+    auto start = std::chrono::steady_clock::now();
+    classifier->Predict(features);
+    auto vigraTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    MatrixDoubleType vigraProbabilities = classifier->GetPointWiseProbabilities();
+
+    classifier->UseFlatRandomForest(true);
+    classifier->Predict(features); // Builds the flat forest
+    start = std::chrono::steady_clock::now();
+    classifier->Predict(features);
+    auto flatTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    MatrixDoubleType flatProbabilities = classifier->GetPointWiseProbabilities();
+
+    MITK_INFO << "Prediction of " << features.rows() << " samples: vigra " << vigraTime << " ms, flat forest " << flatTime << " ms";
+
+    CPPUNIT_ASSERT_EQUAL(vigraProbabilities.rows(), flatProbabilities.rows());
+    CPPUNIT_ASSERT_EQUAL(vigraProbabilities.cols(), flatProbabilities.cols());
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, (vigraProbabilities - flatProbabilities).cwiseAbs().maxCoeff(), 1e-12);
+  }
+
+  // ------------------------------------------------------------------------------------------------------
+  // ------------------------------------------------------------------------------------------------------
+
+  void PredictWeightedFlatRandomForest_RandomWeights_EqualsVigraPrediction()
+  {
+    classifier->Train(FeatureData_Matlab.first, LabelData_Matlab.first);
+    MatrixDoubleType weights = (MatrixDoubleType::Random(classifier->GetRandomForest().tree_count(), 1).array() + 1.0) * 2.0;
+    classifier->SetTreeWeights(weights);
+
+    classifier->UseFlatRandomForest(false);
+    MatrixIntType vigraClasses = classifier->PredictWeighted(FeatureData_Matlab.second);
+    MatrixDoubleType vigraProbabilities = classifier->GetPointWiseProbabilities();
+
+    classifier->UseFlatRandomForest(true);
+    MatrixIntType flatClasses = classifier->PredictWeighted(FeatureData_Matlab.second);
+    MatrixDoubleType flatProbabilities = classifier->GetPointWiseProbabilities();
+
+    CPPUNIT_ASSERT(vigraClasses == flatClasses);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, (vigraProbabilities - flatProbabilities).cwiseAbs().maxCoeff(), 1e-12);
+  }
+
   // ------------------------------------------------------------------------------------------------------
   // ------------------------------------------------------------------------------------------------------
   /*Reading an file, which includes the trainingdataset and the testdataset, and convert the
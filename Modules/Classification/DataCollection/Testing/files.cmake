@@ -1,5 +1,6 @@
 SET(MODULE_TESTS
   mitkDataCollectionImageIteratorTest.cpp
+  mitkDataCollectionUtilitiesTest.cpp
 )
 
 SET(MODULE_CUSTOM_TESTS
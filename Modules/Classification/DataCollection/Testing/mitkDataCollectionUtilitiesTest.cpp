@@ -0,0 +1,147 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <mitkTestingMacros.h>
+#include <mitkTestFixture.h>
+
+#include <mitkDataCollection.h>
+#include <mitkDataCollectionImageIterator.h>
+#include <mitkDataCollectionUtilities.h>
+
+#include <itkImageRegionIterator.h>
+
+#include <random>
+
+class mitkDataCollectionUtilitiesTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkDataCollectionUtilitiesTestSuite);
+  MITK_TEST(ClassifyDC3dBlockwise_DoubleProbabilities_EqualsMatrixClassification);
+  MITK_TEST(ClassifyDC3dBlockwise_FloatProbabilities_EqualsMatrixClassification);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  typedef itk::Image<double, 3> FeatureImageType;
+  typedef itk::Image<unsigned char, 3> MaskImageType;
+
+  mitk::DataCollection::Pointer m_Collection;
+  std::vector<std::string> m_Features;
+
+  template <typename TImageType>
+  typename TImageType::Pointer CreateImage(unsigned int size, std::mt19937 &generator, bool isMask)
+  {
+    typename TImageType::SizeType imageSize;
+    imageSize.Fill(size);
+    typename TImageType::Pointer image = TImageType::New();
+    image->SetRegions(imageSize);
+    image->Allocate();
+
+    std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+    itk::ImageRegionIterator<TImageType> iter(image, image->GetLargestPossibleRegion());
+    for (iter.GoToBegin(); !iter.IsAtEnd(); ++iter)
+    {
+      const double value = distribution(generator);
+      iter.Set(isMask ? (value > 0 ? 1 : 0) : value);
+    }
+    return image;
+  }
+
+  static void Classify(const Eigen::MatrixXd &X, Eigen::MatrixXi &Y, Eigen::MatrixXd &P)
+  {
+    Y = Eigen::MatrixXi(X.rows(), 1);
+    P = Eigen::MatrixXd(X.rows(), 2);
+    for (Eigen::Index row = 0; row < X.rows(); ++row)
+    {
+      Y(row, 0) = X(row, 0) > X(row, 1) ? 1 : 2;
+      P(row, 0) = X(row, 0) + X(row, 2);
+      P(row, 1) = X(row, 1) * X(row, 2);
+    }
+  }
+
+public:
+  void setUp() override
+  {
+    std::mt19937 generator(7);
+    m_Features = { "F1", "F2", "F3" };
+    m_Collection = mitk::DataCollection::New();
+
+    // Two patients with different image sizes
+    for (unsigned int patient = 0; patient < 2; ++patient)
+    {
+      auto patientCollection = mitk::DataCollection::New();
+      for (const auto &feature : m_Features)
+      {
+        FeatureImageType::Pointer image = CreateImage<FeatureImageType>(6 + 3 * patient, generator, false);
+        patientCollection->AddData(image.GetPointer(), feature);
+      }
+      MaskImageType::Pointer mask = CreateImage<MaskImageType>(6 + 3 * patient, generator, true);
+      patientCollection->AddData(mask.GetPointer(), "Mask");
+      m_Collection->AddData(patientCollection.GetPointer(), patient == 0 ? "P1" : "P2");
+    }
+  }
+
+  void tearDown() override
+  {
+    m_Collection = nullptr;
+  }
+
+  void ClassifyDC3dBlockwise_DoubleProbabilities_EqualsMatrixClassification()
+  {
+    Eigen::MatrixXi expectedLabels;
+    Eigen::MatrixXd expectedProbabilities;
+    auto X = mitk::DCUtilities::DC3dDToMatrixXd(m_Collection, m_Features, "Mask");
+    Classify(X, expectedLabels, expectedProbabilities);
+
+    std::vector<std::string> probabilityNames = { "prob0", "prob1" };
+    auto numberOfVoxels = mitk::DCUtilities::ClassifyDC3dBlockwise(m_Collection, m_Features, "Mask", 17, Classify, "Result", probabilityNames, false);
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(X.rows()), numberOfVoxels);
+
+    auto labels = mitk::DCUtilities::DC3dDToMatrixXi(m_Collection, "Result", "Mask");
+    auto probabilities = mitk::DCUtilities::DC3dDToMatrixXd(m_Collection, probabilityNames, "Mask");
+    CPPUNIT_ASSERT(labels == expectedLabels);
+    CPPUNIT_ASSERT(probabilities == expectedProbabilities);
+  }
+
+  void ClassifyDC3dBlockwise_FloatProbabilities_EqualsMatrixClassification()
+  {
+    Eigen::MatrixXi expectedLabels;
+    Eigen::MatrixXd expectedProbabilities;
+    auto X = mitk::DCUtilities::DC3dDToMatrixXd(m_Collection, m_Features, "Mask");
+    Classify(X, expectedLabels, expectedProbabilities);
+
+    std::vector<std::string> probabilityNames = { "prob0" };
+    mitk::DCUtilities::ClassifyDC3dBlockwise(m_Collection, m_Features, "Mask", 1000, Classify, "Result", probabilityNames, true);
+
+    auto labels = mitk::DCUtilities::DC3dDToMatrixXi(m_Collection, "Result", "Mask");
+    CPPUNIT_ASSERT(labels == expectedLabels);
+
+    mitk::DataCollectionImageIterator<unsigned char, 3> maskIter(m_Collection, "Mask");
+    mitk::DataCollectionImageIterator<float, 3> probabilityIter(m_Collection, "prob0");
+    Eigen::Index row = 0;
+    while (!maskIter.IsAtEnd())
+    {
+      if (maskIter.GetVoxel() > 0)
+      {
+        CPPUNIT_ASSERT_EQUAL(static_cast<float>(expectedProbabilities(row, 0)), probabilityIter.GetVoxel());
+        ++row;
+      }
+      else
+      {
+        CPPUNIT_ASSERT_EQUAL(0.0f, probabilityIter.GetVoxel());
+      }
+      ++maskIter;
+      ++probabilityIter;
+    }
+    CPPUNIT_ASSERT_EQUAL(X.rows(), row);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkDataCollectionUtilities)
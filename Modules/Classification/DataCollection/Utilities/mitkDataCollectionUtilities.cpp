@@ -14,8 +14,114 @@ found in the LICENSE file.
 
 #include <mitkDataCollectionImageIterator.h>
 
+#include <mitkExceptionMacro.h>
 #include <mitkImageCast.h>
 
+namespace
+{
+  template <typename TProbabilityType>
+  std::size_t ClassifyBlockwise(mitk::DataCollection::Pointer dc,
+                                const std::vector<std::string> &features,
+                                const std::string &mask,
+                                Eigen::Index blockSize,
+                                const mitk::DCUtilities::BlockClassifierFunction &classify,
+                                const std::string &labelName,
+                                const std::vector<std::string> &probabilityNames)
+  {
+    typedef mitk::DataCollectionImageIterator<double, 3> FeatureIterType;
+    typedef mitk::DataCollectionImageIterator<unsigned char, 3> LabelIterType;
+    typedef mitk::DataCollectionImageIterator<TProbabilityType, 3> ProbabilityIterType;
+
+    const int numberOfFeatures = features.size();
+    const int numberOfProbabilities = probabilityNames.size();
+
+    // The mask is traversed twice: the read iterators collect the features of the next block,
+    // the write iterators follow behind and store the results of the classified block.
+    LabelIterType readMaskIter(dc, mask);
+    std::vector<FeatureIterType> featureIter;
+    for (int i = 0; i < numberOfFeatures; ++i)
+    {
+      FeatureIterType iter(dc, features[i]);
+      featureIter.push_back(iter);
+    }
+
+    LabelIterType writeMaskIter(dc, mask);
+    LabelIterType labelIter(dc, labelName);
+    std::vector<ProbabilityIterType> probabilityIter;
+    for (int i = 0; i < numberOfProbabilities; ++i)
+    {
+      ProbabilityIterType iter(dc, probabilityNames[i]);
+      probabilityIter.push_back(iter);
+    }
+
+    Eigen::MatrixXd blockFeatures(blockSize, numberOfFeatures);
+    Eigen::MatrixXi blockLabels;
+    Eigen::MatrixXd blockProbabilities;
+    std::size_t numberOfVoxels = 0;
+
+    while (!readMaskIter.IsAtEnd())
+    {
+      Eigen::Index rows = 0;
+      while (!readMaskIter.IsAtEnd() && rows < blockSize)
+      {
+        if (readMaskIter.GetVoxel() > 0)
+        {
+          for (int col = 0; col < numberOfFeatures; ++col)
+          {
+            blockFeatures(rows, col) = featureIter[col].GetVoxel();
+          }
+          ++rows;
+        }
+        for (int col = 0; col < numberOfFeatures; ++col)
+        {
+          ++(featureIter[col]);
+        }
+        ++readMaskIter;
+      }
+      if (rows == 0)
+      {
+        break;
+      }
+      if (rows < blockSize)
+      {
+        blockFeatures.conservativeResize(rows, numberOfFeatures);
+      }
+
+      classify(blockFeatures, blockLabels, blockProbabilities);
+      if (blockLabels.rows() != rows || blockLabels.cols() < 1)
+      {
+        mitkThrow() << "Classifier returned " << blockLabels.rows() << " labels for " << rows << " voxels";
+      }
+      if (numberOfProbabilities > 0 && (blockProbabilities.rows() != rows || blockProbabilities.cols() < numberOfProbabilities))
+      {
+        mitkThrow() << "Classifier returned " << blockProbabilities.cols() << " probabilities, but " << numberOfProbabilities << " are stored";
+      }
+
+      Eigen::Index row = 0;
+      while (row < rows)
+      {
+        if (writeMaskIter.GetVoxel() > 0)
+        {
+          labelIter.SetVoxel(blockLabels(row, 0));
+          for (int col = 0; col < numberOfProbabilities; ++col)
+          {
+            probabilityIter[col].SetVoxel(blockProbabilities(row, col));
+          }
+          ++row;
+        }
+        ++labelIter;
+        for (int col = 0; col < numberOfProbabilities; ++col)
+        {
+          ++(probabilityIter[col]);
+        }
+        ++writeMaskIter;
+      }
+      numberOfVoxels += rows;
+    }
+    return numberOfVoxels;
+  }
+}
+
 int mitk::DCUtilities::VoxelInMask(mitk::DataCollection::Pointer dc, std::string mask)
 {
   mitk::DataCollectionImageIterator<unsigned char, 3> maskIter(dc, mask);
@@ -202,6 +308,34 @@ void mitk::DCUtilities::MatrixToDC3d(const Eigen::MatrixXi &matrix, mitk::DataCo
   return MatrixToDC3d(matrix, dc, names, mask);
 }
 
+std::size_t mitk::DCUtilities::ClassifyDC3dBlockwise(mitk::DataCollection::Pointer dc,
+                                                     const std::vector<std::string> &features,
+                                                     std::string mask,
+                                                     std::size_t blockSize,
+                                                     const BlockClassifierFunction &classify,
+                                                     const std::string &labelName,
+                                                     const std::vector<std::string> &probabilityNames,
+                                                     bool floatProbabilities)
+{
+  if (blockSize == 0)
+  {
+    mitkThrow() << "Block size must be larger than 0";
+  }
+
+  EnsureUCharImageInDC(dc, labelName, mask);
+  for (const auto &name : probabilityNames)
+  {
+    if (floatProbabilities)
+      EnsureFloatImageInDC(dc, name, mask);
+    else
+      EnsureDoubleImageInDC(dc, name, mask);
+  }
+
+  if (floatProbabilities)
+    return ClassifyBlockwise<float>(dc, features, mask, blockSize, classify, labelName, probabilityNames);
+  return ClassifyBlockwise<double>(dc, features, mask, blockSize, classify, labelName, probabilityNames);
+}
+
 void mitk::DCUtilities::EnsureUCharImageInDC(mitk::DataCollection::Pointer dc, std::string name, std::string origin)
 {
   typedef itk::Image<unsigned char, 3> FeatureImage;
@@ -277,3 +411,41 @@ void mitk::DCUtilities::EnsureDoubleImageInDC(mitk::DataCollection::Pointer dc,
     }
   }
 }
+
+void mitk::DCUtilities::EnsureFloatImageInDC(mitk::DataCollection::Pointer dc, std::string name, std::string origin)
+{
+  typedef itk::Image<float, 3> FeatureImage;
+  typedef itk::Image<unsigned char, 3> LabelImage;
+
+  mitk::DataCollectionImageIterator<unsigned char , 3> iter( dc, origin);
+  while (!iter.IsAtEnd())
+  {
+    ++iter;
+  }
+
+  if (dc->HasElement(origin))
+  {
+    LabelImage::Pointer originImage = dynamic_cast<LabelImage*>(dc->GetData(origin).GetPointer());
+    if (!dc->HasElement(name) && originImage.IsNotNull())
+    {
+      MITK_INFO << "New float image necessary";
+      FeatureImage::Pointer image = FeatureImage::New();
+      image->SetRegions(originImage->GetLargestPossibleRegion());
+      image->SetSpacing(originImage->GetSpacing());
+      image->SetOrigin(originImage->GetOrigin());
+      image->SetDirection(originImage->GetDirection());
+      image->Allocate();
+      image->FillBuffer(0);
+
+      dc->AddData(dynamic_cast<itk::DataObject*>(image.GetPointer()),name,"");
+    }
+  }
+  for (std::size_t i = 0; i < dc->Size();++i)
+  {
+    mitk::DataCollection* newCol = dynamic_cast<mitk::DataCollection*>(dc->GetData(i).GetPointer());
+    if (newCol != nullptr)
+    {
+      EnsureFloatImageInDC(newCol, name, origin);
+    }
+  }
+}
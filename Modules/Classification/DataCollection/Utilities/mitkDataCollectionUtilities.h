@@ -18,11 +18,16 @@ found in the LICENSE file.
 #include <mitkDataCollection.h>
 #include <Eigen/Dense>
 
+#include <functional>
+
 namespace mitk
 {
   class MITKDATACOLLECTION_EXPORT DCUtilities
   {
   public:
+    /** Classifies the samples in features (one row per voxel) and returns one label and one probability per class for each row.*/
+    typedef std::function<void(const Eigen::MatrixXd &features, Eigen::MatrixXi &labels, Eigen::MatrixXd &probabilities)> BlockClassifierFunction;
+
     static int VoxelInMask(mitk::DataCollection::Pointer dc, std::string mask);
 
     static Eigen::MatrixXd DC3dDToMatrixXd(mitk::DataCollection::Pointer dc, std::string names, std::string mask);
@@ -35,8 +40,26 @@ namespace mitk
     static void MatrixToDC3d(const Eigen::MatrixXd &matrix, mitk::DataCollection::Pointer dc, const std::string &names, std::string mask);
     static void MatrixToDC3d(const Eigen::MatrixXi &matrix, mitk::DataCollection::Pointer dc, const std::string &names, std::string mask);
 
+    /**
+    * \brief Classifies the voxels within mask block by block, without creating the feature matrix of all voxels.
+    *
+    * The features of up to blockSize voxels are collected and passed to classify. Its results are written
+    * to the unsigned char image labelName and to the images probabilityNames (one per class, further classes
+    * are not stored) before the next block is read. The probability images are created as float images if
+    * floatProbabilities is set and as double images otherwise. Returns the number of classified voxels.
+    */
+    static std::size_t ClassifyDC3dBlockwise(mitk::DataCollection::Pointer dc,
+                                             const std::vector<std::string> &features,
+                                             std::string mask,
+                                             std::size_t blockSize,
+                                             const BlockClassifierFunction &classify,
+                                             const std::string &labelName,
+                                             const std::vector<std::string> &probabilityNames,
+                                             bool floatProbabilities);
+
     static void EnsureUCharImageInDC(mitk::DataCollection::Pointer dc, std::string name, std::string origin);
     static void EnsureDoubleImageInDC(mitk::DataCollection::Pointer dc, std::string name, std::string origin);
+    static void EnsureFloatImageInDC(mitk::DataCollection::Pointer dc, std::string name, std::string origin);
   };
 }
 
@@ -0,0 +1,361 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "mitkNavigationDataFilterChain.h"
+#include "mitkNavigationDataTransformFilter.h"
+#include "mitkNavigationDataLandmarkTransformFilter.h"
+#include "mitkNavigationDataDisplacementFilter.h"
+#include "mitkNavigationDataSmoothingFilter.h"
+#include "mitkIGTException.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+  // The kernels work on whole arrays without branches per tool, so the
+  // compiler can vectorize the loops.
+
+  /** q = a * b, i.e. the rotation b followed by the rotation a */
+  inline void MultiplyQuaternions(double ax, double ay, double az, double aw,
+    double bx, double by, double bz, double bw,
+    double& x, double& y, double& z, double& w)
+  {
+    x = aw * bx + ax * bw + ay * bz - az * by;
+    y = aw * by - ax * bz + ay * bw + az * bx;
+    z = aw * bz + ax * by - ay * bx + az * bw;
+    w = aw * bw - ax * bx - ay * by - az * bz;
+  }
+
+  inline double NormalizationFactor(double x, double y, double z, double w)
+  {
+    const double norm = std::sqrt(x * x + y * y + z * z + w * w);
+    return norm > 0.0 ? 1.0 / norm : 0.0;
+  }
+}
+
+void mitk::NavigationDataFilterChain::Poses::Resize(std::size_t numberOfTools)
+{
+  PositionX.resize(numberOfTools);
+  PositionY.resize(numberOfTools);
+  PositionZ.resize(numberOfTools);
+  OrientationX.resize(numberOfTools);
+  OrientationY.resize(numberOfTools);
+  OrientationZ.resize(numberOfTools);
+  OrientationW.resize(numberOfTools);
+}
+
+mitk::NavigationDataFilterChain::NavigationDataFilterChain()
+: mitk::NavigationDataToNavigationDataFilter()
+{
+}
+
+mitk::NavigationDataFilterChain::~NavigationDataFilterChain()
+{
+}
+
+void mitk::NavigationDataFilterChain::AddFilter(NavigationDataToNavigationDataFilter* filter)
+{
+  if (filter == nullptr)
+    mitkThrowException(mitk::IGTException) << "Cannot add a null filter to the chain.";
+
+  Stage stage;
+  stage.Filter = filter;
+  stage.Enabled = true;
+  stage.Precompose = false;
+  stage.NumberOfValues = 0;
+  stage.HistoryIndex = 0;
+
+  // the reference transform filter is a landmark transform filter as well
+  if (dynamic_cast<NavigationDataTransformFilter*>(filter) != nullptr)
+    stage.Type = Stage::RigidTransform;
+  else if (dynamic_cast<NavigationDataLandmarkTransformFilter*>(filter) != nullptr)
+    stage.Type = Stage::LandmarkTransform;
+  else if (dynamic_cast<NavigationDataDisplacementFilter*>(filter) != nullptr)
+    stage.Type = Stage::Displacement;
+  else if (dynamic_cast<NavigationDataSmoothingFilter*>(filter) != nullptr)
+    stage.Type = Stage::Smoothing;
+  else
+    mitkThrowException(mitk::IGTException) << filter->GetNameOfClass() << " cannot be evaluated by a NavigationDataFilterChain.";
+
+  m_Stages.push_back(stage);
+  this->Modified();
+}
+
+void mitk::NavigationDataFilterChain::RemoveAllFilters()
+{
+  m_Stages.clear();
+  this->Modified();
+}
+
+unsigned int mitk::NavigationDataFilterChain::GetNumberOfFilters() const
+{
+  return static_cast<unsigned int>(m_Stages.size());
+}
+
+void mitk::NavigationDataFilterChain::ResetSmoothing()
+{
+  for (auto& stage : m_Stages)
+  {
+    for (auto& history : stage.History)
+      history.clear();
+  }
+}
+
+void mitk::NavigationDataFilterChain::GenerateData()
+{
+  this->CreateOutputsForAllInputs(); // make sure that we have the same number of outputs as inputs
+
+  const std::size_t numberOfTools = this->GetNumberOfIndexedOutputs();
+  m_Poses.Resize(numberOfTools);
+
+  for (std::size_t i = 0; i < numberOfTools; ++i)
+  {
+    const mitk::NavigationData* input = this->GetInput(i);
+    assert(input);
+    const NavigationData::PositionType position = input->GetPosition();
+    const NavigationData::OrientationType orientation = input->GetOrientation();
+    m_Poses.PositionX[i] = position[0];
+    m_Poses.PositionY[i] = position[1];
+    m_Poses.PositionZ[i] = position[2];
+    m_Poses.OrientationX[i] = orientation.x();
+    m_Poses.OrientationY[i] = orientation.y();
+    m_Poses.OrientationZ[i] = orientation.z();
+    m_Poses.OrientationW[i] = orientation.r();
+  }
+
+  for (auto& stage : m_Stages)
+  {
+    this->UpdateStage(stage, numberOfTools);
+    if (!stage.Enabled)
+      continue;
+
+    switch (stage.Type)
+    {
+    case Stage::RigidTransform:
+    case Stage::LandmarkTransform:
+      this->ApplyRigidTransform(stage, numberOfTools);
+      break;
+    case Stage::Displacement:
+      this->ApplyDisplacement(stage, numberOfTools);
+      break;
+    case Stage::Smoothing:
+      this->ApplySmoothing(stage, numberOfTools);
+      break;
+    }
+  }
+
+  for (std::size_t i = 0; i < numberOfTools; ++i)
+  {
+    mitk::NavigationData* output = this->GetOutput(i);
+    assert(output);
+    const mitk::NavigationData* input = this->GetInput(i);
+
+    output->Graft(input); // copies name, time stamp, covariance and the valid flag
+    if (input->IsDataValid() == false)
+      continue;
+
+    NavigationData::PositionType position;
+    FillVector3D(position, m_Poses.PositionX[i], m_Poses.PositionY[i], m_Poses.PositionZ[i]);
+    output->SetPosition(position);
+    output->SetOrientation(NavigationData::OrientationType(m_Poses.OrientationX[i], m_Poses.OrientationY[i],
+      m_Poses.OrientationZ[i], m_Poses.OrientationW[i]));
+  }
+}
+
+void mitk::NavigationDataFilterChain::UpdateStage(Stage& stage, std::size_t numberOfTools)
+{
+  switch (stage.Type)
+  {
+  case Stage::RigidTransform:
+  {
+    auto filter = static_cast<NavigationDataTransformFilter*>(stage.Filter.GetPointer());
+    const NavigationDataTransformFilter::TransformType* transform = filter->GetRigid3DTransform();
+    if (transform == nullptr)
+      mitkThrowException(mitk::IGTException) << "Invalid parameter: Transform was not set! Use SetRigid3DTransform() before updating the chain.";
+
+    const NavigationDataTransformFilter::TransformType::MatrixType& matrix = transform->GetMatrix();
+    const NavigationDataTransformFilter::TransformType::OffsetType& offset = transform->GetOffset();
+    const NavigationDataTransformFilter::TransformType::VersorType& versor = transform->GetVersor();
+    for (unsigned int r = 0; r < 3; ++r)
+    {
+      for (unsigned int c = 0; c < 3; ++c)
+        stage.Matrix[r][c] = matrix[r][c];
+      stage.Translation[r] = offset[r];
+    }
+    stage.Rotation[0] = versor.GetX();
+    stage.Rotation[1] = versor.GetY();
+    stage.Rotation[2] = versor.GetZ();
+    stage.Rotation[3] = versor.GetW();
+    stage.Precompose = filter->GetPrecompose();
+    stage.Enabled = true;
+    break;
+  }
+  case Stage::LandmarkTransform:
+  {
+    auto filter = static_cast<NavigationDataLandmarkTransformFilter*>(stage.Filter.GetPointer());
+    stage.Enabled = filter->IsInitialized(); // without landmarks the filter only grafts its inputs
+    if (!stage.Enabled)
+      break;
+
+    const NavigationDataLandmarkTransformFilter::LandmarkTransformType* transform = filter->GetLandmarkTransform();
+    const NavigationDataLandmarkTransformFilter::LandmarkTransformType::MatrixType& matrix = transform->GetMatrix();
+    const NavigationDataLandmarkTransformFilter::LandmarkTransformType::OffsetType& offset = transform->GetOffset();
+    const NavigationDataLandmarkTransformFilter::LandmarkTransformType::VersorType& versor = transform->GetVersor();
+    for (unsigned int r = 0; r < 3; ++r)
+    {
+      for (unsigned int c = 0; c < 3; ++c)
+        stage.Matrix[r][c] = matrix[r][c];
+      stage.Translation[r] = offset[r];
+    }
+    stage.Rotation[0] = versor.GetX();
+    stage.Rotation[1] = versor.GetY();
+    stage.Rotation[2] = versor.GetZ();
+    stage.Rotation[3] = versor.GetW();
+    stage.Precompose = false;
+    break;
+  }
+  case Stage::Displacement:
+  {
+    auto filter = static_cast<NavigationDataDisplacementFilter*>(stage.Filter.GetPointer());
+    if (filter->GetTransform6DOF())
+      mitkThrowException(mitk::IGTException) << "The Transform6DOF mode of NavigationDataDisplacementFilter combines several tools and cannot be evaluated by a NavigationDataFilterChain.";
+
+    const mitk::Vector3D offset = filter->GetOffset();
+    for (unsigned int r = 0; r < 3; ++r)
+      stage.Translation[r] = offset[r];
+    stage.Enabled = true;
+    break;
+  }
+  case Stage::Smoothing:
+  {
+    auto filter = static_cast<NavigationDataSmoothingFilter*>(stage.Filter.GetPointer());
+    if (filter->GetNumerOfValues() < 1)
+      mitkThrowException(mitk::IGTException) << "The smoothing filter needs at least one value.";
+
+    const unsigned int numberOfValues = filter->GetNumerOfValues();
+    // start with zeros like a new smoothing filter whenever the window or the number of tools changes
+    if (numberOfValues != stage.NumberOfValues || stage.History[0].size() != numberOfValues * numberOfTools)
+    {
+      stage.NumberOfValues = numberOfValues;
+      stage.HistoryIndex = 0;
+      for (auto& history : stage.History)
+        history.assign(numberOfValues * numberOfTools, 0.0);
+    }
+    stage.Enabled = true;
+    break;
+  }
+  }
+}
+
+void mitk::NavigationDataFilterChain::ApplyRigidTransform(const Stage& stage, std::size_t numberOfTools)
+{
+  double* px = m_Poses.PositionX.data();
+  double* py = m_Poses.PositionY.data();
+  double* pz = m_Poses.PositionZ.data();
+  double* qx = m_Poses.OrientationX.data();
+  double* qy = m_Poses.OrientationY.data();
+  double* qz = m_Poses.OrientationZ.data();
+  double* qw = m_Poses.OrientationW.data();
+
+  const double (&m)[3][3] = stage.Matrix;
+  const double tx = stage.Translation[0];
+  const double ty = stage.Translation[1];
+  const double tz = stage.Translation[2];
+  const double rx = stage.Rotation[0];
+  const double ry = stage.Rotation[1];
+  const double rz = stage.Rotation[2];
+  const double rw = stage.Rotation[3];
+
+  if (!stage.Precompose)
+  {
+    // pose followed by the transform: p' = M p + t, q' = r q
+    for (std::size_t i = 0; i < numberOfTools; ++i)
+    {
+      const double x = px[i];
+      const double y = py[i];
+      const double z = pz[i];
+      px[i] = m[0][0] * x + m[0][1] * y + m[0][2] * z + tx;
+      py[i] = m[1][0] * x + m[1][1] * y + m[1][2] * z + ty;
+      pz[i] = m[2][0] * x + m[2][1] * y + m[2][2] * z + tz;
+
+      const double s = NormalizationFactor(qx[i], qy[i], qz[i], qw[i]);
+      MultiplyQuaternions(rx, ry, rz, rw, qx[i] * s, qy[i] * s, qz[i] * s, qw[i] * s, qx[i], qy[i], qz[i], qw[i]);
+    }
+  }
+  else
+  {
+    // transform followed by the pose: p' = R(q) t + p, q' = q r
+    for (std::size_t i = 0; i < numberOfTools; ++i)
+    {
+      const double s = NormalizationFactor(qx[i], qy[i], qz[i], qw[i]);
+      const double x = qx[i] * s;
+      const double y = qy[i] * s;
+      const double z = qz[i] * s;
+      const double w = qw[i] * s;
+
+      // rotate t by q: t' = t + w c + q x c with c = 2 q x t
+      const double cx = 2.0 * (y * tz - z * ty);
+      const double cy = 2.0 * (z * tx - x * tz);
+      const double cz = 2.0 * (x * ty - y * tx);
+      px[i] += tx + w * cx + (y * cz - z * cy);
+      py[i] += ty + w * cy + (z * cx - x * cz);
+      pz[i] += tz + w * cz + (x * cy - y * cx);
+
+      MultiplyQuaternions(x, y, z, w, rx, ry, rz, rw, qx[i], qy[i], qz[i], qw[i]);
+    }
+  }
+}
+
+void mitk::NavigationDataFilterChain::ApplyDisplacement(const Stage& stage, std::size_t numberOfTools)
+{
+  double* px = m_Poses.PositionX.data();
+  double* py = m_Poses.PositionY.data();
+  double* pz = m_Poses.PositionZ.data();
+  const double tx = stage.Translation[0];
+  const double ty = stage.Translation[1];
+  const double tz = stage.Translation[2];
+
+  for (std::size_t i = 0; i < numberOfTools; ++i)
+  {
+    px[i] += tx;
+    py[i] += ty;
+    pz[i] += tz;
+  }
+}
+
+void mitk::NavigationDataFilterChain::ApplySmoothing(Stage& stage, std::size_t numberOfTools)
+{
+  std::vector<double>* positions[3] = { &m_Poses.PositionX, &m_Poses.PositionY, &m_Poses.PositionZ };
+  const double factor = 1.0 / stage.NumberOfValues;
+
+  for (unsigned int d = 0; d < 3; ++d)
+  {
+    double* position = positions[d]->data();
+    double* history = stage.History[d].data();
+
+    // the window is a ring buffer, the current value replaces the oldest one
+    std::copy(position, position + numberOfTools, history + stage.HistoryIndex * numberOfTools);
+
+    std::fill(position, position + numberOfTools, 0.0);
+    for (unsigned int k = 0; k < stage.NumberOfValues; ++k)
+    {
+      const double* values = history + k * numberOfTools;
+      for (std::size_t i = 0; i < numberOfTools; ++i)
+        position[i] += values[i];
+    }
+    for (std::size_t i = 0; i < numberOfTools; ++i)
+      position[i] *= factor;
+  }
+
+  stage.HistoryIndex = (stage.HistoryIndex + 1) % stage.NumberOfValues;
+}
@@ -0,0 +1,134 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef MITKNavigationDataFilterChain_H_HEADER_INCLUDED_
+#define MITKNavigationDataFilterChain_H_HEADER_INCLUDED_
+
+#include <mitkNavigationDataToNavigationDataFilter.h>
+
+#include <vector>
+
+namespace mitk {
+
+  /**Documentation
+  * \brief NavigationDataFilterChain evaluates a chain of navigation data filters for all tools in one pass.
+  *
+  * The filters added with AddFilter() are only used as configuration objects: the chain reads their
+  * parameters on every update, but they are neither connected to an input nor updated themselves.
+  * Instead of one pipeline update per filter and new output objects in every filter, the chain copies
+  * the poses of all inputs into one array per component, lets every stage process all tools in a
+  * tight loop and writes the result into its own outputs, which are created once.
+  *
+  * Supported stages (evaluated in the order they were added):
+  *  - NavigationDataTransformFilter
+  *  - NavigationDataLandmarkTransformFilter and NavigationDataReferenceTransformFilter
+  *    (no change as long as the filter is not initialized)
+  *  - NavigationDataDisplacementFilter without Transform6DOF
+  *  - NavigationDataSmoothingFilter
+  *
+  * Outputs of invalid inputs are marked invalid, as in the single filters.
+  *
+  * Example: chain->AddFilter(transformFilter); chain->AddFilter(smoothingFilter); chain->ConnectTo(trackingDeviceSource);
+  *
+  * \ingroup IGT
+  */
+  class MITKIGT_EXPORT NavigationDataFilterChain : public NavigationDataToNavigationDataFilter
+  {
+  public:
+    mitkClassMacro(NavigationDataFilterChain, NavigationDataToNavigationDataFilter);
+    itkFactorylessNewMacro(Self);
+    itkCloneMacro(Self);
+
+    /**
+    * \brief Appends the given filter as the next stage of the chain.
+    *
+    * \throws mitk::IGTException if the filter type cannot be evaluated by the chain.
+    */
+    void AddFilter(NavigationDataToNavigationDataFilter* filter);
+
+    /**
+    * \brief Removes all stages, the outputs are then copies of the inputs.
+    */
+    void RemoveAllFilters();
+
+    unsigned int GetNumberOfFilters() const;
+
+    /**
+    * \brief Clears the values of the smoothing stages, as a new smoothing filter would start
+    */
+    void ResetSmoothing();
+
+  protected:
+    NavigationDataFilterChain();
+    ~NavigationDataFilterChain() override;
+
+    /**Documentation
+    * \brief filter execute method
+    *
+    * evaluates all stages on the poses of all inputs
+    */
+    void GenerateData() override;
+
+    /**
+    * \brief Poses of all tools, one array per component
+    */
+    struct Poses
+    {
+      void Resize(std::size_t numberOfTools);
+
+      std::vector<double> PositionX;
+      std::vector<double> PositionY;
+      std::vector<double> PositionZ;
+      std::vector<double> OrientationX;
+      std::vector<double> OrientationY;
+      std::vector<double> OrientationZ;
+      std::vector<double> OrientationW;
+    };
+
+    /**
+    * \brief One filter of the chain together with its parameters of the current update
+    */
+    struct Stage
+    {
+      enum StageType
+      {
+        RigidTransform,
+        LandmarkTransform,
+        Displacement,
+        Smoothing
+      };
+
+      NavigationDataToNavigationDataFilter::Pointer Filter;
+      StageType Type;
+
+      bool Enabled;
+      bool Precompose;               ///< applies the transform before the pose instead of after it
+      double Matrix[3][3];           ///< rotation matrix of the transform
+      double Translation[3];         ///< offset of the transform or displacement
+      double Rotation[4];            ///< rotation of the transform as quaternion (x, y, z, w)
+
+      unsigned int NumberOfValues;   ///< smoothing window
+      unsigned int HistoryIndex;     ///< next slot of the smoothing window that is overwritten
+      std::vector<double> History[3];///< last positions, NumberOfValues blocks of one value per tool
+    };
+
+    void UpdateStage(Stage& stage, std::size_t numberOfTools);
+    void ApplyRigidTransform(const Stage& stage, std::size_t numberOfTools);
+    void ApplyDisplacement(const Stage& stage, std::size_t numberOfTools);
+    void ApplySmoothing(Stage& stage, std::size_t numberOfTools);
+
+    std::vector<Stage> m_Stages;
+    Poses m_Poses;
+  };
+} // namespace mitk
+
+#endif /* MITKNavigationDataFilterChain_H_HEADER_INCLUDED_ */
@@ -37,6 +37,7 @@ namespace mitk {
      *         used for smoothing.
      */
     itkSetMacro(NumerOfValues,int);
+    itkGetConstMacro(NumerOfValues,int);
 
   protected:
     NavigationDataSmoothingFilter();
@@ -15,8 +15,77 @@ found in the LICENSE file.
 #include "vnl/vnl_matrix.h"
 #include "vnl/vnl_vector.h"
 #include <vtkMatrix4x4.h>
+#include <itkMultiThreader.h>
 
-mitk::PivotCalibration::PivotCalibration() : m_NavigationDatas(std::vector<mitk::NavigationData::Pointer>()), m_ResultPivotPoint(mitk::Point3D(0.0))
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
+
+namespace
+{
+  /** Shared state of the threads of the robust estimation, which take the blocks of poses one by one */
+  struct BlockProcessingData
+  {
+    std::function<void(unsigned int)> ProcessBlock;
+    unsigned int NumberOfBlocks;
+    std::atomic<unsigned int> NextBlock;
+  };
+
+  ITK_THREAD_RETURN_TYPE ProcessBlocksCallback(void* arg)
+  {
+    typedef itk::MultiThreader::ThreadInfoStruct ThreadInfoType;
+    ThreadInfoType* infoStruct = static_cast<ThreadInfoType*>(arg);
+    BlockProcessingData* data = static_cast<BlockProcessingData*>(infoStruct->UserData);
+
+    for (unsigned int block = data->NextBlock++; block < data->NumberOfBlocks; block = data->NextBlock++)
+      data->ProcessBlock(block);
+    return ITK_THREAD_RETURN_VALUE;
+  }
+}
+
+mitk::PivotCalibration::NormalEquations::NormalEquations()
+  : SumOfWeights(0.0), SumOfSquaredPositions(0.0)
+{
+  std::fill(&SumOfRotations[0][0], &SumOfRotations[0][0] + 9, 0.0);
+  std::fill(SumOfRotatedPositions, SumOfRotatedPositions + 3, 0.0);
+  std::fill(SumOfPositions, SumOfPositions + 3, 0.0);
+}
+
+void mitk::PivotCalibration::NormalEquations::Add(const Pose& pose, double weight)
+{
+  SumOfWeights += weight;
+  for (int i = 0; i < 3; ++i)
+  {
+    for (int j = 0; j < 3; ++j)
+    {
+      SumOfRotations[i][j] += weight * pose.Rotation[i][j];
+      SumOfRotatedPositions[i] += weight * pose.Rotation[j][i] * pose.Position[j];
+    }
+    SumOfPositions[i] += weight * pose.Position[i];
+    SumOfSquaredPositions += weight * pose.Position[i] * pose.Position[i];
+  }
+}
+
+void mitk::PivotCalibration::NormalEquations::Add(const NormalEquations& other)
+{
+  SumOfWeights += other.SumOfWeights;
+  for (int i = 0; i < 3; ++i)
+  {
+    for (int j = 0; j < 3; ++j)
+    {
+      SumOfRotations[i][j] += other.SumOfRotations[i][j];
+    }
+    SumOfRotatedPositions[i] += other.SumOfRotatedPositions[i];
+    SumOfPositions[i] += other.SumOfPositions[i];
+  }
+  SumOfSquaredPositions += other.SumOfSquaredPositions;
+}
+
+mitk::PivotCalibration::PivotCalibration()
+  : m_NumberOfNavigationDatas(0), m_ResultPivotPoint(mitk::Point3D(0.0)), m_ResultPivotPointInTrackingCoordinates(mitk::Point3D(0.0)),
+  m_ResultRMSError(0.0), m_NumberOfOutliers(0), m_RobustEstimation(false), m_OutlierThreshold(1.0), m_MaximumNumberOfIterations(20),
+  m_NumberOfThreads(0)
 {
 
 
@@ -29,7 +98,38 @@ mitk::PivotCalibration::~PivotCalibration()
 
 void mitk::PivotCalibration::AddNavigationData(mitk::NavigationData::Pointer data)
 {
-  m_NavigationDatas.push_back(data);
+  unsigned int index = m_NumberOfNavigationDatas++;
+  if (data.IsNull() || !data->IsDataValid())
+  {
+    MITK_WARN << "Skipping invalid transform " << index << ".";
+    return;
+  }
+
+  Pose pose;
+  // *rotation_matrix_transpose().transpose() is used to obtain original matrix
+  vnl_matrix_fixed<double, 3, 3> R = data->GetOrientation().rotation_matrix_transpose().transpose();
+  for (int i = 0; i < 3; ++i)
+  {
+    for (int j = 0; j < 3; ++j)
+    {
+      pose.Rotation[i][j] = R(i, j);
+    }
+    pose.Position[i] = data->GetPosition()[i];
+  }
+  m_Poses.push_back(pose);
+  m_NormalEquations.Add(pose, 1.0);
+}
+
+void mitk::PivotCalibration::Reset()
+{
+  m_Poses.clear();
+  m_NormalEquations = NormalEquations();
+  m_NumberOfNavigationDatas = 0;
+}
+
+unsigned int mitk::PivotCalibration::GetNumberOfPoses() const
+{
+  return m_Poses.size();
 }
 
 bool mitk::PivotCalibration::ComputePivotResult()
@@ -39,72 +139,166 @@ bool mitk::PivotCalibration::ComputePivotResult()
 
 bool mitk::PivotCalibration::ComputePivotPoint()
 {
-  double defaultThreshold = 1e-1;
-
-  std::vector<mitk::NavigationData::Pointer> _CheckedTransforms;
-  for (size_t i = 0; i < m_NavigationDatas.size(); ++i)
+  if (m_Poses.empty())
   {
-    if (!m_NavigationDatas.at(i)->IsDataValid())
-    {
-      MITK_WARN << "Skipping invalid transform " << i << ".";
-      continue;
-    }
-    _CheckedTransforms.push_back(m_NavigationDatas.at(i));
+    MITK_WARN << "Checked Transforms are empty";
+    return false;
   }
 
-  if (_CheckedTransforms.empty())
+  double x[6];
+  double sumOfSquaredResiduals = 0.0;
+  if (!this->SolveNormalEquations(m_NormalEquations, x, sumOfSquaredResiduals))
   {
-    MITK_WARN << "Checked Transforms are empty";
     return false;
   }
 
-  unsigned int rows = 3 * _CheckedTransforms.size();
-  unsigned int columns = 6;
+  if (m_RobustEstimation)
+  {
+    unsigned int numberOfOutliers = 0;
+    double sumOfSquaredInlierResiduals = 0.0;
+    for (unsigned int iteration = 0; iteration < m_MaximumNumberOfIterations; ++iteration)
+    {
+      NormalEquations reweightedEquations = this->ComputeReweightedNormalEquations(x, numberOfOutliers, sumOfSquaredInlierResiduals);
+      double reweightedX[6];
+      double reweightedSumOfSquaredResiduals;
+      if (!this->SolveNormalEquations(reweightedEquations, reweightedX, reweightedSumOfSquaredResiduals))
+      {
+        break;
+      }
+      double change = 0.0;
+      for (int i = 0; i < 6; ++i)
+      {
+        change = std::max(change, std::abs(reweightedX[i] - x[i]));
+        x[i] = reweightedX[i];
+      }
+      if (change < 1e-6)
+      {
+        break;
+      }
+    }
 
-  vnl_matrix< double > A(rows, columns), minusI(3, 3, 0), R(3, 3);
-  vnl_vector< double > b(rows), x(columns), t(3);
+    // the error is computed from the poses that fit the final pivot point
+    this->ComputeReweightedNormalEquations(x, numberOfOutliers, sumOfSquaredInlierResiduals);
+    unsigned int numberOfInliers = m_Poses.size() - numberOfOutliers;
+    m_NumberOfOutliers = numberOfOutliers;
+    m_ResultRMSError = numberOfInliers > 0 ? std::sqrt(sumOfSquaredInlierResiduals / (3 * numberOfInliers)) : 0.0;
+  }
+  else
+  {
+    m_NumberOfOutliers = 0;
+    m_ResultRMSError = std::sqrt(sumOfSquaredResiduals / (3 * m_Poses.size()));  //the root mean sqaure error of the computation
+  }
 
-  minusI(0, 0) = -1;
-  minusI(1, 1) = -1;
-  minusI(2, 2) = -1;
+  //sets the Pivot Point
+  m_ResultPivotPoint[0] = x[0];
+  m_ResultPivotPoint[1] = x[1];
+  m_ResultPivotPoint[2] = x[2];
+  m_ResultPivotPointInTrackingCoordinates[0] = x[3];
+  m_ResultPivotPointInTrackingCoordinates[1] = x[4];
+  m_ResultPivotPointInTrackingCoordinates[2] = x[5];
 
-  //do the computation and set the internal variables
-  unsigned int currentRow = 0;
+  return true;
+}
 
+bool mitk::PivotCalibration::SolveNormalEquations(const NormalEquations& equations, double x[6], double& sumOfSquaredResiduals) const
+{
+  // threshold for the singular values of the system A * x = b, the singular values of the normal matrix A^T * A are their squares
+  double defaultThreshold = 1e-1;
 
-  for (size_t i = 0; i < _CheckedTransforms.size(); ++i)
+  // A^T * A with A = [R_i | -I] for all poses
+  vnl_matrix< double > N(6, 6, 0.0);
+  vnl_vector< double > c(6);
+  for (int i = 0; i < 3; ++i)
   {
-    t = _CheckedTransforms.at(i)->GetPosition().GetVnlVector();// t = the current position of the tracked sensor
-    t *= -1;
-    b.update(t, currentRow); //b = combines the position for each collected transform in one column vector
-    R = _CheckedTransforms.at(i)->GetOrientation().rotation_matrix_transpose().transpose(); // R = the current rotation of the tracked sensor, *rotation_matrix_transpose().transpose() is used to obtain original matrix
-    A.update(R, currentRow, 0); //A = the matrix which stores the rotations for each collected transform and -I
-    A.update(minusI, currentRow, 3);
-    currentRow += 3;
+    N(i, i) = equations.SumOfWeights;
+    N(i + 3, i + 3) = equations.SumOfWeights;
+    for (int j = 0; j < 3; ++j)
+    {
+      N(i, j + 3) = -equations.SumOfRotations[j][i];
+      N(i + 3, j) = -equations.SumOfRotations[i][j];
+    }
+    // A^T * b with b = -t for all poses
+    c[i] = -equations.SumOfRotatedPositions[i];
+    c[i + 3] = equations.SumOfPositions[i];
   }
-  vnl_svd<double> svdA(A); //The singular value decomposition of matrix A
-  svdA.zero_out_absolute(defaultThreshold);
+
+  vnl_svd<double> svdN(N); //The singular value decomposition of the normal matrix
+  svdN.zero_out_absolute(defaultThreshold * defaultThreshold);
 
   //there is a solution only if rank(A)=6 (columns are linearly
   //independent)
-  if (svdA.rank() < 6)
+  if (svdN.rank() < 6)
   {
     MITK_WARN << "svdA.rank() < 6";
     return false;
   }
-  else
+
+  vnl_vector< double > solution = svdN.solve(c); //the resulting pivot point
+  std::copy(solution.begin(), solution.end(), x);
+
+  // |A * x - b|^2 = x^T * A^T * A * x - 2 * x^T * A^T * b + b^T * b
+  sumOfSquaredResiduals = std::max(0.0, dot_product(N * solution, solution) - 2.0 * dot_product(solution, c) + equations.SumOfSquaredPositions);
+  return true;
+}
+
+mitk::PivotCalibration::NormalEquations mitk::PivotCalibration::ComputeReweightedNormalEquations(const double x[6],
+  unsigned int& numberOfOutliers, double& sumOfSquaredInlierResiduals) const
+{
+  // The poses are processed in blocks whose results are summed up in a fixed order,
+  // so the result does not depend on the number of threads.
+  const std::size_t blockSize = 4096;
+  const unsigned int numberOfBlocks = (m_Poses.size() + blockSize - 1) / blockSize;
+  std::vector<NormalEquations> blockEquations(numberOfBlocks);
+  std::vector<unsigned int> blockOutliers(numberOfBlocks, 0);
+  std::vector<double> blockSumOfSquaredResiduals(numberOfBlocks, 0.0);
+  BlockProcessingData data;
+  data.NumberOfBlocks = numberOfBlocks;
+  data.NextBlock = 0;
+  data.ProcessBlock = [&](unsigned int block)
   {
-    x = svdA.solve(b); //x = the resulting pivot point
+    const std::size_t end = std::min(m_Poses.size(), (block + 1) * blockSize);
+    for (std::size_t p = block * blockSize; p < end; ++p)
+    {
+      const Pose& pose = m_Poses[p];
+      // distance of the tool tip in tracking coordinates to the pivot point
+      double squaredResidual = 0.0;
+      for (int i = 0; i < 3; ++i)
+      {
+        double e = pose.Rotation[i][0] * x[0] + pose.Rotation[i][1] * x[1] + pose.Rotation[i][2] * x[2] - x[3 + i] + pose.Position[i];
+        squaredResidual += e * e;
+      }
+      double residual = std::sqrt(squaredResidual);
 
-    m_ResultRMSError = (A * x - b).rms();  //the root mean sqaure error of the computation
+      double weight = 1.0;
+      if (residual > m_OutlierThreshold)
+      {
+        weight = m_OutlierThreshold / residual;
+        ++blockOutliers[block];
+      }
+      else
+      {
+        blockSumOfSquaredResiduals[block] += squaredResidual;
+      }
+      blockEquations[block].Add(pose, weight);
+    }
+  };
 
-    //sets the Pivot Point
-    m_ResultPivotPoint[0] = x[0];
-    m_ResultPivotPoint[1] = x[1];
-    m_ResultPivotPoint[2] = x[2];
+  unsigned int numberOfThreads = m_NumberOfThreads > 0 ? m_NumberOfThreads : itk::MultiThreader::GetGlobalDefaultNumberOfThreads();
+  numberOfThreads = std::max(1u, std::min(numberOfThreads, numberOfBlocks));
 
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->SetNumberOfThreads(numberOfThreads);
+  threader->SetSingleMethod(ProcessBlocksCallback, &data);
+  threader->SingleMethodExecute();
 
+  NormalEquations equations;
+  numberOfOutliers = 0;
+  sumOfSquaredInlierResiduals = 0.0;
+  for (unsigned int block = 0; block < numberOfBlocks; ++block)
+  {
+    equations.Add(blockEquations[block]);
+    numberOfOutliers += blockOutliers[block];
+    sumOfSquaredInlierResiduals += blockSumOfSquaredResiduals[block];
   }
-  return true;
-
+  return equations;
 }
@@ -26,6 +26,16 @@ found in the LICENSE file.
 namespace mitk {
     /**Documentation
     * \brief Class for performing a pivot calibration out of a set of navigation datas
+    *
+    * The least-squares system of the calibration is not stored. Every added navigation data is
+    * accumulated into the normal equations right away, so ComputePivotResult() takes the same
+    * time for ten or for tens of thousands of poses and can be called after every added pose to
+    * get an immediate estimate of the pivot point and the RMS error. The pose is read when it is
+    * added, invalid navigation datas are skipped.
+    *
+    * Optionally, outliers are handled by iteratively reweighted least squares: poses whose tool tip
+    * is farther than the outlier threshold from the estimated pivot point are downweighted (Huber
+    * weights). The residuals and weights of all poses are computed in parallel.
     * \ingroup IGT
     */
   class MITKIGT_EXPORT PivotCalibration : public itk::Object
@@ -40,22 +50,82 @@ namespace mitk {
         */
       bool ComputePivotResult();
 
+      /** @brief Removes all navigation datas */
+      void Reset();
+
+      /** @brief Returns the number of valid navigation datas used for the calibration */
+      unsigned int GetNumberOfPoses() const;
+
       itkGetMacro(ResultPivotPoint,mitk::Point3D);
       itkGetMacro(ResultRMSError,double);
-
+      /** @brief Position of the pivot point in tracking coordinates, computed together with the result pivot point */
+      itkGetMacro(ResultPivotPointInTrackingCoordinates,mitk::Point3D);
+      /** @brief Number of poses with a residual above the outlier threshold, only computed by the robust estimation */
+      itkGetMacro(NumberOfOutliers,unsigned int);
+
+      /** @brief Enables the iteratively reweighted least squares estimation, which reduces the influence of outliers. Default: off */
+      itkSetMacro(RobustEstimation,bool);
+      itkGetMacro(RobustEstimation,bool);
+      itkBooleanMacro(RobustEstimation);
+      /** @brief Residual in mm above which a pose is considered as outlier. Default: 1 mm */
+      itkSetMacro(OutlierThreshold,double);
+      itkGetMacro(OutlierThreshold,double);
+      /** @brief Maximum number of reweighting iterations of the robust estimation. Default: 20 */
+      itkSetMacro(MaximumNumberOfIterations,unsigned int);
+      itkGetMacro(MaximumNumberOfIterations,unsigned int);
+      /** @brief Number of threads of the robust estimation, 0 uses itk::MultiThreader::GetGlobalDefaultNumberOfThreads(). Default: 0 */
+      itkSetMacro(NumberOfThreads,unsigned int);
+      itkGetMacro(NumberOfThreads,unsigned int);
 
     protected:
       PivotCalibration();
       ~PivotCalibration() override;
 
-      std::vector<mitk::NavigationData::Pointer> m_NavigationDatas;
+      /** @brief One pose of the tracked tool */
+      struct Pose
+      {
+        double Rotation[3][3];
+        double Position[3];
+      };
+
+      /** @brief Sums of the (weighted) normal equations of the poses
+        *
+        * For a pose with rotation R and position t the system is R * p_tool - p_pivot = -t,
+        * so the normal matrix only depends on the sum of the weights and the sum of the rotations.
+        */
+      struct NormalEquations
+      {
+        NormalEquations();
+        void Add(const Pose& pose, double weight);
+        void Add(const NormalEquations& other);
+
+        double SumOfWeights;
+        double SumOfRotations[3][3];
+        double SumOfRotatedPositions[3]; ///< sum of R^T * t
+        double SumOfPositions[3];
+        double SumOfSquaredPositions;
+      };
+
+      std::vector<Pose> m_Poses;
+      NormalEquations m_NormalEquations;
+      unsigned int m_NumberOfNavigationDatas;
 
       bool ComputePivotPoint();
       bool ComputePivotAxis();
+      /** @brief Solves the normal equations, x holds the pivot point in tool and in tracking coordinates */
+      bool SolveNormalEquations(const NormalEquations& equations, double x[6], double& sumOfSquaredResiduals) const;
+      /** @brief Computes the normal equations with the Huber weights of the residuals of the given solution */
+      NormalEquations ComputeReweightedNormalEquations(const double x[6], unsigned int& numberOfOutliers, double& sumOfSquaredInlierResiduals) const;
 
       mitk::Point3D m_ResultPivotPoint;
+      mitk::Point3D m_ResultPivotPointInTrackingCoordinates;
       double m_ResultRMSError;
+      unsigned int m_NumberOfOutliers;
 
+      bool m_RobustEstimation;
+      double m_OutlierThreshold;
+      unsigned int m_MaximumNumberOfIterations;
+      unsigned int m_NumberOfThreads;
     };
 } // Ende Namespace
 #endif
@@ -0,0 +1,151 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef MITKLOCKFREERINGBUFFER_H_HEADER_INCLUDED_
+#define MITKLOCKFREERINGBUFFER_H_HEADER_INCLUDED_
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace mitk
+{
+  /**Documentation
+  * \brief Bounded ring buffer for handing data from exactly one producer thread to exactly one consumer thread
+  * without locks.
+  *
+  * All slots are allocated by the constructor. The producer fills a slot in place (BeginPush(), EndPush()),
+  * so slots holding containers keep their memory and pushing does not allocate once the sizes are stable.
+  * Likewise the consumer can read the oldest slot in place (BeginPop(), EndPop()).
+  * A full buffer rejects new elements instead of overwriting old ones, so it suits streams in which every
+  * element counts. To hand over only the newest value, use mitk::LockFreeTripleBuffer.
+  *
+  * Push methods may only be called by the producer thread, pop methods only by the consumer thread.
+  *
+  * \ingroup IGT
+  */
+  template <typename T>
+  class LockFreeRingBuffer
+  {
+  public:
+    explicit LockFreeRingBuffer(std::size_t capacity)
+      : m_Slots(capacity + 1), m_Head(0), m_Tail(0)
+    {
+    }
+
+    LockFreeRingBuffer(const LockFreeRingBuffer&) = delete;
+    LockFreeRingBuffer& operator=(const LockFreeRingBuffer&) = delete;
+
+    std::size_t GetCapacity() const
+    {
+      return m_Slots.size() - 1;
+    }
+
+    /**
+    * \brief Returns the slot the next element is written to, or nullptr if the buffer is full.
+    * The element becomes visible to the consumer with EndPush(). (producer thread only)
+    */
+    T* BeginPush()
+    {
+      const std::size_t head = m_Head.load(std::memory_order_relaxed);
+      if (this->Next(head) == m_Tail.load(std::memory_order_acquire))
+        return nullptr;
+      return &m_Slots[head];
+    }
+
+    /** \brief Publishes the slot returned by the last successful BeginPush(). (producer thread only) */
+    void EndPush()
+    {
+      m_Head.store(this->Next(m_Head.load(std::memory_order_relaxed)), std::memory_order_release);
+    }
+
+    /** \brief Copies the value into the buffer. Returns false if the buffer is full. (producer thread only) */
+    bool Push(const T& value)
+    {
+      T* slot = this->BeginPush();
+      if (slot == nullptr)
+        return false;
+      *slot = value;
+      this->EndPush();
+      return true;
+    }
+
+    /** \brief Removes the oldest element. Returns false if the buffer is empty. (consumer thread only) */
+    bool Pop(T& value)
+    {
+      const std::size_t tail = m_Tail.load(std::memory_order_relaxed);
+      if (tail == m_Head.load(std::memory_order_acquire))
+        return false;
+      value = m_Slots[tail];
+      m_Tail.store(this->Next(tail), std::memory_order_release);
+      return true;
+    }
+
+    /**
+    * \brief Returns the oldest element without copying it, or nullptr if the buffer is empty.
+    * The element stays valid until it is removed with EndPop(). (consumer thread only)
+    */
+    T* BeginPop()
+    {
+      const std::size_t tail = m_Tail.load(std::memory_order_relaxed);
+      if (tail == m_Head.load(std::memory_order_acquire))
+        return nullptr;
+      return &m_Slots[tail];
+    }
+
+    /** \brief Removes the element returned by the last successful BeginPop(). (consumer thread only) */
+    void EndPop()
+    {
+      m_Tail.store(this->Next(m_Tail.load(std::memory_order_relaxed)), std::memory_order_release);
+    }
+
+    /**
+    * \brief Removes all elements and copies the newest one. Returns false if the buffer is empty.
+    * (consumer thread only)
+    */
+    bool PopLatest(T& value)
+    {
+      const std::size_t head = m_Head.load(std::memory_order_acquire);
+      if (m_Tail.load(std::memory_order_relaxed) == head)
+        return false;
+      value = m_Slots[head == 0 ? m_Slots.size() - 1 : head - 1];
+      m_Tail.store(head, std::memory_order_release);
+      return true;
+    }
+
+    /** \brief Returns the number of elements; exact only if called while the other thread is idle. */
+    std::size_t GetSize() const
+    {
+      const std::size_t head = m_Head.load(std::memory_order_acquire);
+      const std::size_t tail = m_Tail.load(std::memory_order_acquire);
+      return head >= tail ? head - tail : head + m_Slots.size() - tail;
+    }
+
+    bool IsEmpty() const
+    {
+      return m_Head.load(std::memory_order_acquire) == m_Tail.load(std::memory_order_acquire);
+    }
+
+  private:
+    std::size_t Next(std::size_t index) const
+    {
+      return index + 1 == m_Slots.size() ? 0 : index + 1;
+    }
+
+    std::vector<T> m_Slots; ///< one slot more than the capacity to distinguish a full from an empty buffer
+    std::atomic<std::size_t> m_Head; ///< next slot written by the producer
+    char m_Padding[64]; ///< keeps head and tail on different cache lines, each is written by one thread only
+    std::atomic<std::size_t> m_Tail; ///< next slot read by the consumer
+  };
+} // namespace mitk
+
+#endif /* MITKLOCKFREERINGBUFFER_H_HEADER_INCLUDED_ */
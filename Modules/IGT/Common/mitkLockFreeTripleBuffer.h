@@ -0,0 +1,122 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef MITKLOCKFREETRIPLEBUFFER_H_HEADER_INCLUDED_
+#define MITKLOCKFREETRIPLEBUFFER_H_HEADER_INCLUDED_
+
+#include <atomic>
+
+namespace mitk
+{
+  /**Documentation
+  * \brief Hands the newest value from exactly one producer thread to exactly one consumer thread without locks.
+  *
+  * Unlike mitk::LockFreeRingBuffer, a new value always replaces an older value that was not taken yet, so the
+  * consumer gets the newest value, no matter how far it is behind. The buffer consists of three slots: the
+  * producer fills its back slot in place (GetBackSlot(), Publish()), the consumer reads its front slot, and the
+  * third slot holds the last published value. Publishing and taking only exchange slot indices, so slots
+  * holding containers keep their memory and no copy is made inside the buffer.
+  *
+  * Producer methods may only be called by the producer thread, consumer methods only by the consumer thread.
+  *
+  * \ingroup IGT
+  */
+  template <typename T>
+  class LockFreeTripleBuffer
+  {
+  public:
+    LockFreeTripleBuffer()
+      : m_Back(0), m_Middle(1), m_Front(2)
+    {
+    }
+
+    LockFreeTripleBuffer(const LockFreeTripleBuffer&) = delete;
+    LockFreeTripleBuffer& operator=(const LockFreeTripleBuffer&) = delete;
+
+    /**
+    * \brief Returns the slot the next value is written to. It keeps the content of an older value.
+    * The value becomes visible to the consumer with Publish(). (producer thread only)
+    */
+    T* GetBackSlot()
+    {
+      return &m_Slots[m_Back];
+    }
+
+    /**
+    * \brief Publishes the back slot.
+    * @return false if the previously published value was replaced before the consumer took it. (producer thread only)
+    */
+    bool Publish()
+    {
+      const unsigned int previous = m_Middle.exchange(m_Back | NewValueFlag, std::memory_order_acq_rel);
+      m_Back = previous & IndexMask;
+      return (previous & NewValueFlag) == 0;
+    }
+
+    /** \brief Copies the value into the back slot and publishes it. (producer thread only) */
+    bool Publish(const T& value)
+    {
+      *this->GetBackSlot() = value;
+      return this->Publish();
+    }
+
+    /**
+    * \brief Takes the newest published value without copying it, or returns nullptr if no value was
+    * published since the last call. The value stays valid until the next call. (consumer thread only)
+    */
+    const T* TakeLatest()
+    {
+      if ((m_Middle.load(std::memory_order_relaxed) & NewValueFlag) == 0)
+        return nullptr;
+      m_Front = m_Middle.exchange(m_Front, std::memory_order_acq_rel) & IndexMask;
+      return &m_Slots[m_Front];
+    }
+
+    /** \brief Copies the newest published value. Returns false if no value was published since the last call. (consumer thread only) */
+    bool TakeLatest(T& value)
+    {
+      const T* latest = this->TakeLatest();
+      if (latest == nullptr)
+        return false;
+      value = *latest;
+      return true;
+    }
+
+    /**
+    * \brief Discards a published value that was not taken yet. May be called by any thread; a value the
+    * producer publishes concurrently may be discarded as well.
+    */
+    void Clear()
+    {
+      m_Middle.fetch_and(IndexMask, std::memory_order_acq_rel);
+    }
+
+    /** \brief Returns true if a value was published that the consumer did not take yet. */
+    bool HasNewValue() const
+    {
+      return (m_Middle.load(std::memory_order_acquire) & NewValueFlag) != 0;
+    }
+
+  private:
+    static const unsigned int IndexMask = 3;
+    static const unsigned int NewValueFlag = 4;
+
+    T m_Slots[3];
+    unsigned int m_Back; ///< slot written by the producer
+    char m_ProducerPadding[64]; ///< keeps the indices of both threads on different cache lines
+    std::atomic<unsigned int> m_Middle; ///< index of the last published slot, flagged if it was not taken yet
+    char m_ConsumerPadding[64];
+    unsigned int m_Front; ///< slot read by the consumer
+  };
+} // namespace mitk
+
+#endif /* MITKLOCKFREETRIPLEBUFFER_H_HEADER_INCLUDED_ */
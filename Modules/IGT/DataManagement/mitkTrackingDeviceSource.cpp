@@ -19,9 +19,13 @@ found in the LICENSE file.
 #include "mitkIGTException.h"
 #include "mitkIGTHardwareException.h"
 
+#include <algorithm>
+#include <cmath>
+
 mitk::TrackingDeviceSource::TrackingDeviceSource()
   : mitk::NavigationDataSource(), m_TrackingDevice(nullptr)
 {
+  this->ResetLatencyStatistics();
 }
 
 mitk::TrackingDeviceSource::~TrackingDeviceSource()
@@ -60,8 +64,40 @@ void mitk::TrackingDeviceSource::GenerateData()
       << m_TrackingDevice->GetToolCount() << " tools available in the tracking device.";
     throw std::out_of_range(ss.str());
   }
-  /* update outputs with tracking data from tools */
   unsigned int toolCount = m_TrackingDevice->GetToolCount();
+
+  /* update outputs with the newest frame of the tracking thread */
+  if (m_TrackingDevice->IsPublishingToolStates())
+  {
+    if (!m_TrackingDevice->GetLatestToolStates(m_ToolStates))
+      return; // no new frame since the last update, the outputs are up to date
+
+    if (m_ToolStates.size() == toolCount) // tools added during tracking are not in the frame yet
+    {
+      for (unsigned int i = 0; i < toolCount; ++i)
+      {
+        mitk::NavigationData* nd = this->GetOutput(i);
+        assert(nd);
+        const mitk::TrackingDevice::ToolState& state = m_ToolStates[i];
+
+        if ((state.Enabled == false) || (state.DataValid == false))
+        {
+          nd->SetDataValid(false);
+          continue;
+        }
+        nd->SetDataValid(true);
+        nd->SetPosition(state.Position);
+        nd->SetOrientation(state.Orientation);
+        nd->SetOrientationAccuracy(state.TrackingError);
+        nd->SetPositionAccuracy(state.TrackingError);
+        nd->SetIGTTimeStamp(state.IGTTimeStamp);
+      }
+      this->UpdateLatencyStatistics();
+      return;
+    }
+  }
+
+  /* update outputs with tracking data from tools */
   for (unsigned int i = 0; i < toolCount; ++i)
   {
     mitk::NavigationData* nd = this->GetOutput(i);
@@ -89,6 +125,53 @@ void mitk::TrackingDeviceSource::GenerateData()
     //for backward compatibility: check if the timestamp was set, if not create a default timestamp
     if (nd->GetIGTTimeStamp()==0) nd->SetIGTTimeStamp(mitk::IGTTimeStamp::GetInstance()->GetElapsed());
   }
+  this->UpdateLatencyStatistics();
+}
+
+void mitk::TrackingDeviceSource::UpdateLatencyStatistics()
+{
+  const double now = mitk::IGTTimeStamp::GetInstance()->GetElapsed();
+  if (now < 0) // the clock was not started
+    return;
+
+  const unsigned int outputCount = this->GetNumberOfIndexedOutputs();
+  m_LastIGTTimeStamps.resize(outputCount, 0.0);
+  for (unsigned int i = 0; i < outputCount; ++i)
+  {
+    const mitk::NavigationData* nd = this->GetOutput(i);
+    if (!nd->IsDataValid() || nd->GetIGTTimeStamp() == m_LastIGTTimeStamps[i])
+      continue;
+    m_LastIGTTimeStamps[i] = nd->GetIGTTimeStamp();
+
+    // running mean and variance (Welford)
+    const double latency = now - nd->GetIGTTimeStamp();
+    LatencyStatistics& statistics = m_LatencyStatistics;
+    ++statistics.NumberOfSamples;
+    const double delta = latency - statistics.Mean;
+    statistics.Mean += delta / statistics.NumberOfSamples;
+    m_LatencySumOfSquaredDifferences += delta * (latency - statistics.Mean);
+    statistics.StandardDeviation = statistics.NumberOfSamples > 1
+      ? std::sqrt(m_LatencySumOfSquaredDifferences / (statistics.NumberOfSamples - 1)) : 0.0;
+    statistics.Minimum = statistics.NumberOfSamples > 1 ? std::min(statistics.Minimum, latency) : latency;
+    statistics.Maximum = statistics.NumberOfSamples > 1 ? std::max(statistics.Maximum, latency) : latency;
+    statistics.Last = latency;
+  }
+}
+
+mitk::TrackingDeviceSource::LatencyStatistics mitk::TrackingDeviceSource::GetLatencyStatistics() const
+{
+  return m_LatencyStatistics;
+}
+
+void mitk::TrackingDeviceSource::ResetLatencyStatistics()
+{
+  m_LatencyStatistics.NumberOfSamples = 0;
+  m_LatencyStatistics.Mean = 0.0;
+  m_LatencyStatistics.StandardDeviation = 0.0;
+  m_LatencyStatistics.Minimum = 0.0;
+  m_LatencyStatistics.Maximum = 0.0;
+  m_LatencyStatistics.Last = 0.0;
+  m_LatencySumOfSquaredDifferences = 0.0;
 }
 
 void mitk::TrackingDeviceSource::SetTrackingDevice( mitk::TrackingDevice* td )
@@ -161,6 +244,7 @@ void mitk::TrackingDeviceSource::StartTracking()
     return;
   if (m_TrackingDevice->StartTracking() == false)
     throw std::runtime_error("mitk::TrackingDeviceSource: Could not start tracking");
+  this->ResetLatencyStatistics();
 }
 
 void mitk::TrackingDeviceSource::Disconnect()
@@ -33,6 +33,12 @@ namespace mitk {
   * \warning If a tool is removed from the tracking device, there will be a mismatch between
   * the outputs and the tool number!
   *
+  * If the tracking device publishes its frames (see mitk::TrackingDevice::IsPublishingToolStates()),
+  * the outputs are updated from the newest frame of its lock-free ring buffer, so the tracking thread
+  * and the pipeline do not wait for each other and all outputs belong to the same frame. Otherwise
+  * the tools are queried one by one. The time from the IGT time stamp of a tool to the update of
+  * the output is measured and provided by GetLatencyStatistics().
+  *
   * \ingroup IGT
   */
   class MITKIGT_EXPORT TrackingDeviceSource : public NavigationDataSource
@@ -104,6 +110,28 @@ namespace mitk {
     */
     void UpdateOutputInformation() override;
 
+    /**
+    * \brief End-to-end latency from the IGT time stamp of the tracking data to the output of this filter
+    *
+    * All times are in milliseconds. Every new tracking sample of a valid output counts once.
+    */
+    struct LatencyStatistics
+    {
+      unsigned long NumberOfSamples;
+      double Mean;
+      double StandardDeviation;
+      double Minimum;
+      double Maximum;
+      double Last;
+    };
+
+    /**
+    * \brief Returns the latency measured since tracking started or ResetLatencyStatistics() was called.
+    */
+    LatencyStatistics GetLatencyStatistics() const;
+
+    void ResetLatencyStatistics();
+
   protected:
     TrackingDeviceSource();
     ~TrackingDeviceSource() override;
@@ -125,7 +153,17 @@ namespace mitk {
     **/
     void CreateOutputs();
 
+    /**
+    * \brief Updates the latency statistics with all outputs that received a new time stamp.
+    */
+    void UpdateLatencyStatistics();
+
     mitk::TrackingDevice::Pointer m_TrackingDevice;  ///< the tracking device that is used as a source for this filter object
+
+    mitk::TrackingDevice::ToolStateFrame m_ToolStates; ///< newest frame taken from the tracking device, reused for every update
+    std::vector<double> m_LastIGTTimeStamps;          ///< time stamps of the outputs at the last update, to count every sample once
+    LatencyStatistics m_LatencyStatistics;
+    double m_LatencySumOfSquaredDifferences;          ///< for the running standard deviation
   };
 } // namespace mitk
 #endif /* MITKTrackingDeviceSource_H_HEADER_INCLUDED_ */
@@ -54,7 +54,7 @@ void mitk::NavigationDataPlayer::GenerateData()
   // imediatly with the first navigation data (not to wait till the first time
   // stamp is reached)
   TimeStampType timeStampSinceStartWithOffset = m_TimeStampSinceStart
-      + m_NavigationDataSet->Begin()->at(0)->GetIGTTimeStamp();
+      + m_NavigationDataSet->GetIGTTimeStampForIndex(0, 0);
 
   // iterate through all NavigationData objects of the given tool index
   // till the timestamp of the NavigationData is greater then the given timestamp
@@ -62,7 +62,7 @@ void mitk::NavigationDataPlayer::GenerateData()
   {
     // test if the timestamp of the successor is greater than the time stamp
     if ( m_NavigationDataSetIterator+1 == m_NavigationDataSet->End() ||
-        (m_NavigationDataSetIterator+1)->at(0)->GetIGTTimeStamp() > timeStampSinceStartWithOffset )
+        m_NavigationDataSet->GetIGTTimeStampForIndex(m_NavigationDataSetIterator.GetIndex() + 1, 0) > timeStampSinceStartWithOffset )
     {
       break;
     }
@@ -73,7 +73,7 @@ void mitk::NavigationDataPlayer::GenerateData()
     mitk::NavigationData* output = this->GetOutput(index);
     if( !output ) { mitkThrowException(mitk::IGTException) << "Output of index "<<index<<" is null."; }
 
-    output->Graft(m_NavigationDataSetIterator->at(index));
+    m_NavigationDataSet->GetNavigationDataForIndex(m_NavigationDataSetIterator.GetIndex(), index, output);
   }
 
   // stop playing if the last NavigationData objects were grafted
@@ -145,6 +145,44 @@ void mitk::NavigationDataPlayer::Resume()
   }
 }
 
+void mitk::NavigationDataPlayer::Seek(TimeStampType timeStampSinceStart)
+{
+  if (m_CurPlayerState == PlayerStopped)
+  {
+    MITK_ERROR << "Player is not started!" << std::endl;
+    return;
+  }
+  if (m_NavigationDataSet->Size() == 0)
+    return;
+
+  // search the first time step after the position, the time stamps of a recording increase
+  TimeStampType timeStamp = timeStampSinceStart + m_NavigationDataSet->GetIGTTimeStampForIndex(0, 0);
+  unsigned int first = 0;
+  unsigned int count = m_NavigationDataSet->Size();
+  while (count > 0)
+  {
+    unsigned int step = count / 2;
+    if (m_NavigationDataSet->GetIGTTimeStampForIndex(first + step, 0) <= timeStamp)
+    {
+      first += step + 1;
+      count -= step + 1;
+    }
+    else
+    {
+      count = step;
+    }
+  }
+  m_NavigationDataSetIterator = m_NavigationDataSet->Begin() + (first > 0 ? first - 1 : 0);
+
+  // GenerateData() and Resume() continue from the new position
+  m_TimeStampSinceStart = timeStampSinceStart;
+  if (m_CurPlayerState == PlayerPaused)
+    m_StartPlayingTimeStamp = m_PauseTimeStamp - timeStampSinceStart;
+  else
+    m_StartPlayingTimeStamp = mitk::IGTTimeStamp::GetInstance()->GetElapsed() - timeStampSinceStart;
+  this->Modified();
+}
+
 mitk::NavigationDataPlayer::PlayerState mitk::NavigationDataPlayer::GetCurrentPlayerState()
 {
   return m_CurPlayerState;
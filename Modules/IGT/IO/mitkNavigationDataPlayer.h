@@ -67,6 +67,15 @@ namespace mitk {
     */
     void Resume();
 
+    /**
+    * \brief Moves the running or paused player to the given time since the start of playing.
+    *
+    * The outputs are set to the last NavigationData objects recorded at or before this time, playing
+    * continues from there. The time step is found by a binary search, so any position of long
+    * recordings can be reached directly.
+    */
+    void Seek(TimeStampType timeStampSinceStart);
+
     PlayerState GetCurrentPlayerState();
 
     TimeStampType GetTimeStampSinceStart();
@@ -35,8 +35,14 @@ void mitk::NavigationDataRecorder::GenerateData()
   // get each input, lookup the associated BaseData and transfer the data
   DataObjectPointerArray inputs = this->GetIndexedInputs(); //get all inputs
 
-  //This vector will hold the NavigationDatas that are copied from the inputs
-  std::vector< mitk::NavigationData::Pointer > clonedDatas;
+  //This vector holds the NavigationDatas that are copied from the inputs; the set copies their values,
+  //so the objects are reused for every time step
+  if (m_RecordedDatas.size() != inputs.size())
+  {
+    m_RecordedDatas.clear();
+    for (unsigned int index = 0; index < inputs.size(); index++)
+      m_RecordedDatas.push_back(mitk::NavigationData::New());
+  }
 
   bool atLeastOneInputIsInvalid = false;
 
@@ -54,15 +60,13 @@ void mitk::NavigationDataRecorder::GenerateData()
        atLeastOneInputIsInvalid = true;
     }
 
-    // Clone a Navigation Data
-    mitk::NavigationData::Pointer clone = mitk::NavigationData::New();
-    clone->Graft(this->GetInput(index));
-    clonedDatas.push_back(clone);
+    // Copy the Navigation Data
+    m_RecordedDatas[index]->Graft(this->GetInput(index));
 
     if (m_StandardizeTime)
     {
       mitk::NavigationData::TimeStampType igtTimestamp = mitk::IGTTimeStamp::GetInstance()->GetElapsed(this);
-      clonedDatas[index]->SetIGTTimeStamp(igtTimestamp);
+      m_RecordedDatas[index]->SetIGTTimeStamp(igtTimestamp);
     }
   }
 
@@ -74,8 +78,9 @@ void mitk::NavigationDataRecorder::GenerateData()
   // We can skip the rest of the method, if we read only valid data
   if (m_RecordOnlyValidData && atLeastOneInputIsInvalid) return;
 
-  // Add data to set
-  m_NavigationDataSet->AddNavigationDatas(clonedDatas);
+  // Add data to set and to the stream file
+  if (m_NavigationDataSet->AddNavigationDatas(m_RecordedDatas) && m_StreamWriter.IsNotNull())
+    m_StreamWriter->AddTimeStep(m_RecordedDatas);
 }
 
 void mitk::NavigationDataRecorder::StartRecording()
@@ -94,6 +99,12 @@ void mitk::NavigationDataRecorder::StartRecording()
 
   if (m_NavigationDataSet.IsNull())
     m_NavigationDataSet = mitk::NavigationDataSet::New(GetNumberOfIndexedInputs());
+
+  if (!m_StreamFileName.empty() && m_StreamWriter.IsNull())
+  {
+    m_StreamWriter = mitk::NavigationDataStreamWriter::New();
+    m_StreamWriter->Open(m_StreamFileName);
+  }
 }
 
 void mitk::NavigationDataRecorder::StopRecording()
@@ -104,16 +115,32 @@ void mitk::NavigationDataRecorder::StopRecording()
     return;
   }
   m_Recording = false;
+
+  if (m_StreamWriter.IsNotNull())
+    m_StreamWriter->Flush();
 }
 
 void mitk::NavigationDataRecorder::ResetRecording()
 {
   m_NavigationDataSet = mitk::NavigationDataSet::New(GetNumberOfIndexedInputs());
 
+  // the next recording is written to a new file
+  if (m_StreamWriter.IsNotNull())
+  {
+    m_StreamWriter->Close();
+    m_StreamWriter = nullptr;
+  }
+
   if (m_Recording)
   {
     mitk::IGTTimeStamp::GetInstance()->Stop(this);
     mitk::IGTTimeStamp::GetInstance()->Start(this);
+
+    if (!m_StreamFileName.empty())
+    {
+      m_StreamWriter = mitk::NavigationDataStreamWriter::New();
+      m_StreamWriter->Open(m_StreamFileName);
+    }
   }
 }
 
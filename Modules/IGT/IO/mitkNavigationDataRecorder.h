@@ -16,6 +16,7 @@ found in the LICENSE file.
 #include "mitkNavigationDataToNavigationDataFilter.h"
 #include "mitkNavigationData.h"
 #include "mitkNavigationDataSet.h"
+#include "mitkNavigationDataStreamWriter.h"
 
 namespace mitk
 {
@@ -27,6 +28,10 @@ namespace mitk
   * With StopRecording() the stream is stopped, but can be resumed anytime.
   * To start recording to a new NavigationDataSet, call ResetRecording();
   *
+  * If a stream file name is set, every recorded time step is additionally appended to this file in the
+  * binary format of mitk::NavigationDataStreamWriter, so the recording is on disk as soon as it is
+  * recorded and does not have to be saved afterwards.
+  *
   * \warning Do not add inputs while the recorder ist recording. The recorder can't handle that and will cause a nullpointer exception.
   * \ingroup IGT
   */
@@ -78,6 +83,19 @@ namespace mitk
     */
     itkGetMacro(RecordOnlyValidData, bool);
 
+    /**
+    * \brief If set, the recorded time steps are also written to this binary file (*.nds).
+    *
+    * The file is created by StartRecording() and closed by ResetRecording(); an existing file is overwritten.
+    * An empty name (default) disables the streaming.
+    */
+    itkSetStringMacro(StreamFileName);
+
+    /**
+    * \brief Returns the name of the binary file the recorded time steps are written to.
+    */
+    itkGetStringMacro(StreamFileName);
+
     /**
     * \brief Starts recording NavigationData into the NavigationDataSet
     */
@@ -125,6 +143,10 @@ namespace mitk
     int m_RecordCountLimit; ///< limits the number of frames, recording will be stopped if the limit is reached. -1 disables the limit
 
     bool m_RecordOnlyValidData; ///< indicates whether only valid data is recorded
+
+    std::vector<mitk::NavigationData::Pointer> m_RecordedDatas; ///< holds the copies of the inputs, reused for every time step
+    std::string m_StreamFileName; ///< binary file the recording is written to, empty if disabled
+    mitk::NavigationDataStreamWriter::Pointer m_StreamWriter;
   };
 }
 #endif // #define _MITK_POINT_SET_SOURCE_H
@@ -19,6 +19,8 @@ set(MODULE_TESTS
    mitkClaronToolTest.cpp
    mitkClaronTrackingDeviceTest.cpp
    mitkNavigationDataDisplacementFilterTest.cpp
+   mitkNavigationDataFilterChainTest.cpp
+  mitkPivotCalibrationTest.cpp
    mitkNavigationDataLandmarkTransformFilterTest.cpp
    mitkNavigationDataObjectVisualizationFilterTest.cpp
    mitkNavigationDataSetTest.cpp
@@ -28,6 +30,7 @@ set(MODULE_TESTS
    mitkNavigationDataSequentialPlayerTest.cpp
    mitkNavigationDataSetReaderWriterXMLTest.cpp
    mitkNavigationDataSetReaderWriterCSVTest.cpp
+   mitkNavigationDataSetReaderWriterBinaryTest.cpp
    mitkNavigationDataSourceTest.cpp
    mitkNavigationDataToMessageFilterTest.cpp
    mitkNavigationDataToNavigationDataFilterTest.cpp
@@ -45,6 +48,8 @@ set(MODULE_TESTS
    # mitkNavigationDataPlayerTest.cpp # random fails see bug 16485.
    # We decided to won't fix because of complete restructuring via bug 15959.
    mitkTrackingDeviceSourceTest.cpp
+   mitkLockFreeRingBufferTest.cpp
+   mitkLockFreeTripleBufferTest.cpp
    mitkTrackingDeviceSourceConfiguratorTest.cpp
    mitkNavigationDataEvaluationFilterTest.cpp
    mitkTrackingTypesTest.cpp
@@ -0,0 +1,171 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+//testing headers
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+#include <mitkLockFreeRingBuffer.h>
+
+#include <thread>
+#include <vector>
+
+class mitkLockFreeRingBufferTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkLockFreeRingBufferTestSuite);
+  MITK_TEST(TestPushAndPop);
+  MITK_TEST(TestFullBufferRejectsElements);
+  MITK_TEST(TestPopLatestDrainsBuffer);
+  MITK_TEST(TestSlotsAreReused);
+  MITK_TEST(TestPopInPlace);
+  MITK_TEST(TestTwoThreads);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+
+  void TestPushAndPop()
+  {
+    mitk::LockFreeRingBuffer<int> buffer(4);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(4), buffer.GetCapacity());
+    CPPUNIT_ASSERT(buffer.IsEmpty());
+
+    int value = 0;
+    CPPUNIT_ASSERT_MESSAGE("Testing pop from an empty buffer", !buffer.Pop(value));
+
+    // wrap around several times
+    for (int i = 0; i < 10; ++i)
+    {
+      CPPUNIT_ASSERT(buffer.Push(2 * i));
+      CPPUNIT_ASSERT(buffer.Push(2 * i + 1));
+      CPPUNIT_ASSERT_EQUAL(std::size_t(2), buffer.GetSize());
+      CPPUNIT_ASSERT(buffer.Pop(value));
+      CPPUNIT_ASSERT_EQUAL(2 * i, value);
+      CPPUNIT_ASSERT(buffer.Pop(value));
+      CPPUNIT_ASSERT_EQUAL(2 * i + 1, value);
+    }
+    CPPUNIT_ASSERT(buffer.IsEmpty());
+  }
+
+  void TestFullBufferRejectsElements()
+  {
+    mitk::LockFreeRingBuffer<int> buffer(3);
+    CPPUNIT_ASSERT(buffer.Push(1));
+    CPPUNIT_ASSERT(buffer.Push(2));
+    CPPUNIT_ASSERT(buffer.Push(3));
+    CPPUNIT_ASSERT_MESSAGE("Testing push to a full buffer", !buffer.Push(4));
+    CPPUNIT_ASSERT(buffer.BeginPush() == nullptr);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(3), buffer.GetSize());
+
+    int value = 0;
+    CPPUNIT_ASSERT(buffer.Pop(value));
+    CPPUNIT_ASSERT_EQUAL(1, value);
+    CPPUNIT_ASSERT(buffer.Push(4));
+  }
+
+  void TestPopLatestDrainsBuffer()
+  {
+    mitk::LockFreeRingBuffer<int> buffer(8);
+    int value = 0;
+    CPPUNIT_ASSERT(!buffer.PopLatest(value));
+
+    for (int round = 0; round < 5; ++round)
+    {
+      for (int i = 0; i < 5; ++i)
+        CPPUNIT_ASSERT(buffer.Push(10 * round + i));
+      CPPUNIT_ASSERT(buffer.PopLatest(value));
+      CPPUNIT_ASSERT_EQUAL(10 * round + 4, value);
+      CPPUNIT_ASSERT(buffer.IsEmpty());
+      CPPUNIT_ASSERT(!buffer.PopLatest(value));
+    }
+  }
+
+  void TestSlotsAreReused()
+  {
+    mitk::LockFreeRingBuffer<std::vector<double>> buffer(2);
+    for (int i = 0; i < 3; ++i)
+    {
+      std::vector<double>* slot = buffer.BeginPush();
+      CPPUNIT_ASSERT(slot != nullptr);
+      slot->resize(3);
+      (*slot)[2] = i;
+      buffer.EndPush();
+
+      std::vector<double> frame;
+      CPPUNIT_ASSERT(buffer.PopLatest(frame));
+      CPPUNIT_ASSERT_EQUAL(std::size_t(3), frame.size());
+      CPPUNIT_ASSERT_EQUAL(double(i), frame[2]);
+    }
+
+    // every slot was filled once, so their memory is kept
+    std::vector<double>* slot = buffer.BeginPush();
+    CPPUNIT_ASSERT(slot != nullptr);
+    CPPUNIT_ASSERT(slot->capacity() >= 3);
+  }
+
+  void TestPopInPlace()
+  {
+    mitk::LockFreeRingBuffer<std::vector<double>> buffer(2);
+    CPPUNIT_ASSERT_MESSAGE("Testing pop from an empty buffer", buffer.BeginPop() == nullptr);
+
+    for (int i = 0; i < 2; ++i)
+    {
+      std::vector<double>* slot = buffer.BeginPush();
+      slot->assign(4, i);
+      buffer.EndPush();
+    }
+
+    for (int i = 0; i < 2; ++i)
+    {
+      std::vector<double>* slot = buffer.BeginPop();
+      CPPUNIT_ASSERT(slot != nullptr);
+      CPPUNIT_ASSERT_EQUAL(double(i), (*slot)[3]);
+      CPPUNIT_ASSERT_MESSAGE("Testing if the element stays until EndPop()", slot == buffer.BeginPop());
+      buffer.EndPop();
+    }
+    CPPUNIT_ASSERT(buffer.IsEmpty());
+  }
+
+  void TestTwoThreads()
+  {
+    const int numberOfElements = 200000;
+    mitk::LockFreeRingBuffer<int> buffer(16);
+
+    std::thread producer([&buffer, numberOfElements]()
+    {
+      for (int i = 0; i < numberOfElements; ++i)
+        while (!buffer.Push(i))
+          std::this_thread::yield();
+    });
+
+    bool inOrder = true;
+    int expected = 0;
+    int value = 0;
+    while (expected < numberOfElements)
+    {
+      if (buffer.Pop(value))
+      {
+        inOrder = inOrder && value == expected;
+        ++expected;
+      }
+      else
+      {
+        std::this_thread::yield();
+      }
+    }
+    producer.join();
+
+    CPPUNIT_ASSERT_MESSAGE("Testing if all elements arrive in order", inOrder);
+    CPPUNIT_ASSERT(buffer.IsEmpty());
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkLockFreeRingBuffer)
@@ -0,0 +1,138 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+//testing headers
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+#include <mitkLockFreeTripleBuffer.h>
+
+#include <thread>
+#include <vector>
+
+class mitkLockFreeTripleBufferTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkLockFreeTripleBufferTestSuite);
+  MITK_TEST(TestPublishAndTake);
+  MITK_TEST(TestNewestValueIsKept);
+  MITK_TEST(TestClear);
+  MITK_TEST(TestSlotsAreReused);
+  MITK_TEST(TestTwoThreads);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+
+  void TestPublishAndTake()
+  {
+    mitk::LockFreeTripleBuffer<int> buffer;
+    int value = 0;
+    CPPUNIT_ASSERT_MESSAGE("Testing take from an empty buffer", !buffer.TakeLatest(value));
+    CPPUNIT_ASSERT(!buffer.HasNewValue());
+
+    for (int i = 0; i < 10; ++i)
+    {
+      CPPUNIT_ASSERT_MESSAGE("Testing if no value is replaced", buffer.Publish(i));
+      CPPUNIT_ASSERT(buffer.HasNewValue());
+      CPPUNIT_ASSERT(buffer.TakeLatest(value));
+      CPPUNIT_ASSERT_EQUAL(i, value);
+      CPPUNIT_ASSERT_MESSAGE("Testing if a value is taken only once", !buffer.TakeLatest(value));
+    }
+  }
+
+  void TestNewestValueIsKept()
+  {
+    mitk::LockFreeTripleBuffer<int> buffer;
+    CPPUNIT_ASSERT(buffer.Publish(1));
+    for (int i = 2; i < 100; ++i)
+      CPPUNIT_ASSERT_MESSAGE("Testing if an untaken value is reported as replaced", !buffer.Publish(i));
+
+    const int* latest = buffer.TakeLatest();
+    CPPUNIT_ASSERT(latest != nullptr);
+    CPPUNIT_ASSERT_EQUAL(99, *latest);
+
+    CPPUNIT_ASSERT(buffer.Publish(100));
+    CPPUNIT_ASSERT_MESSAGE("Testing if the taken value stays valid while the producer publishes", *latest == 99);
+    CPPUNIT_ASSERT_EQUAL(100, *buffer.TakeLatest());
+  }
+
+  void TestClear()
+  {
+    mitk::LockFreeTripleBuffer<int> buffer;
+    buffer.Publish(1);
+    buffer.Clear();
+    int value = 0;
+    CPPUNIT_ASSERT_MESSAGE("Testing if a cleared value is not delivered", !buffer.TakeLatest(value));
+
+    CPPUNIT_ASSERT(buffer.Publish(2));
+    CPPUNIT_ASSERT(buffer.TakeLatest(value));
+    CPPUNIT_ASSERT_EQUAL(2, value);
+  }
+
+  void TestSlotsAreReused()
+  {
+    mitk::LockFreeTripleBuffer<std::vector<double>> buffer;
+    for (int i = 0; i < 3; ++i)
+    {
+      std::vector<double>* slot = buffer.GetBackSlot();
+      slot->resize(3);
+      (*slot)[2] = i;
+      buffer.Publish();
+
+      const std::vector<double>* frame = buffer.TakeLatest();
+      CPPUNIT_ASSERT(frame != nullptr);
+      CPPUNIT_ASSERT_EQUAL(std::size_t(3), frame->size());
+      CPPUNIT_ASSERT_EQUAL(double(i), (*frame)[2]);
+    }
+
+    // every slot was filled once, so their memory is kept
+    CPPUNIT_ASSERT(buffer.GetBackSlot()->capacity() >= 3);
+  }
+
+  void TestTwoThreads()
+  {
+    const int numberOfValues = 200000;
+    mitk::LockFreeTripleBuffer<std::vector<int>> buffer;
+
+    std::thread producer([&buffer, numberOfValues]()
+    {
+      for (int i = 1; i <= numberOfValues; ++i)
+      {
+        buffer.GetBackSlot()->assign(8, i);
+        buffer.Publish();
+      }
+    });
+
+    bool consistent = true;
+    bool increasing = true;
+    int last = 0;
+    while (last < numberOfValues)
+    {
+      const std::vector<int>* frame = buffer.TakeLatest();
+      if (frame == nullptr)
+      {
+        std::this_thread::yield();
+        continue;
+      }
+      for (int value : *frame)
+        consistent = consistent && value == frame->front();
+      increasing = increasing && frame->front() > last;
+      last = frame->front();
+    }
+    producer.join();
+
+    CPPUNIT_ASSERT_MESSAGE("Testing if values are never torn", consistent);
+    CPPUNIT_ASSERT_MESSAGE("Testing if only newer values arrive", increasing);
+    CPPUNIT_ASSERT_EQUAL(numberOfValues, last);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkLockFreeTripleBuffer)
@@ -0,0 +1,241 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+//testing headers
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+#include <mitkNavigationDataFilterChain.h>
+#include <mitkNavigationDataTransformFilter.h>
+#include <mitkNavigationDataLandmarkTransformFilter.h>
+#include <mitkNavigationDataDisplacementFilter.h>
+#include <mitkNavigationDataSmoothingFilter.h>
+#include <mitkNavigationDataPassThroughFilter.h>
+#include <mitkIGTException.h>
+
+#include <cmath>
+#include <vector>
+
+class mitkNavigationDataFilterChainTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkNavigationDataFilterChainTestSuite);
+  MITK_TEST(TestChainEqualsFilterPipeline);
+  MITK_TEST(TestOutputsAreReused);
+  MITK_TEST(TestInvalidInputs);
+  MITK_TEST(TestUnsupportedFilters);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  static const unsigned int NumberOfTools = 7;
+
+  std::vector<mitk::NavigationData::Pointer> m_Inputs;
+  mitk::NavigationDataTransformFilter::Pointer m_PostTransformFilter;
+  mitk::NavigationDataLandmarkTransformFilter::Pointer m_LandmarkFilter;
+  mitk::NavigationDataDisplacementFilter::Pointer m_DisplacementFilter;
+  mitk::NavigationDataTransformFilter::Pointer m_PreTransformFilter;
+  mitk::NavigationDataSmoothingFilter::Pointer m_SmoothingFilter;
+
+  mitk::NavigationDataTransformFilter::TransformType::Pointer CreateTransform(double angle, double tx, double ty, double tz)
+  {
+    mitk::NavigationDataTransformFilter::TransformType::Pointer transform = mitk::NavigationDataTransformFilter::TransformType::New();
+    mitk::NavigationDataTransformFilter::TransformType::VersorType versor;
+    mitk::NavigationDataTransformFilter::TransformType::AxisType axis;
+    axis[0] = 1.0;
+    axis[1] = 2.0;
+    axis[2] = -0.5;
+    versor.Set(axis, angle);
+    transform->SetRotation(versor);
+    mitk::NavigationDataTransformFilter::TransformType::OutputVectorType translation;
+    translation[0] = tx;
+    translation[1] = ty;
+    translation[2] = tz;
+    transform->SetTranslation(translation);
+    return transform;
+  }
+
+  /** moves the tools a bit in every frame */
+  void SetInputPoses(unsigned int frame)
+  {
+    for (unsigned int i = 0; i < NumberOfTools; ++i)
+    {
+      mitk::NavigationData::PositionType position;
+      mitk::FillVector3D(position, 10.0 * i + frame, -3.0 * i + 0.5 * frame, 100.0 + i * frame);
+      m_Inputs[i]->SetPosition(position);
+
+      const double angle = 0.1 * i + 0.05 * frame;
+      mitk::NavigationData::OrientationType orientation(std::sin(angle) * 0.6, std::sin(angle) * 0.8, 0.0, std::cos(angle));
+      m_Inputs[i]->SetOrientation(orientation);
+    }
+  }
+
+  void AssertPosesEqual(const mitk::NavigationData* expected, const mitk::NavigationData* actual)
+  {
+    CPPUNIT_ASSERT_MESSAGE("Testing the position", mitk::Equal(expected->GetPosition(), actual->GetPosition(), 1e-6));
+
+    // q and -q describe the same rotation
+    const mitk::NavigationData::OrientationType q1 = expected->GetOrientation();
+    const mitk::NavigationData::OrientationType q2 = actual->GetOrientation();
+    const double dot = q1.x() * q2.x() + q1.y() * q2.y() + q1.z() * q2.z() + q1.r() * q2.r();
+    CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Testing the orientation", 1.0, std::fabs(dot), 1e-9);
+  }
+
+public:
+
+  void setUp() override
+  {
+    m_Inputs.clear();
+    for (unsigned int i = 0; i < NumberOfTools; ++i)
+    {
+      mitk::NavigationData::Pointer nd = mitk::NavigationData::New();
+      nd->SetName("Tool " + std::to_string(i));
+      nd->SetDataValid(true);
+      m_Inputs.push_back(nd);
+    }
+    this->SetInputPoses(0);
+
+    m_PostTransformFilter = mitk::NavigationDataTransformFilter::New();
+    m_PostTransformFilter->SetRigid3DTransform(this->CreateTransform(0.3, 5.0, -2.0, 1.0));
+
+    // the target landmarks are the source landmarks moved by a rigid transform
+    mitk::NavigationDataTransformFilter::TransformType::Pointer landmarkTransform = this->CreateTransform(-0.7, 12.0, 3.0, -8.0);
+    mitk::PointSet::Pointer sourcePoints = mitk::PointSet::New();
+    mitk::PointSet::Pointer targetPoints = mitk::PointSet::New();
+    const double coordinates[4][3] = { { 0, 0, 0 }, { 50, 0, 0 }, { 0, 80, 0 }, { 0, 0, 30 } };
+    for (int i = 0; i < 4; ++i)
+    {
+      mitk::Point3D point;
+      mitk::FillVector3D(point, coordinates[i][0], coordinates[i][1], coordinates[i][2]);
+      sourcePoints->SetPoint(i, point);
+      targetPoints->SetPoint(i, landmarkTransform->TransformPoint(point));
+    }
+    m_LandmarkFilter = mitk::NavigationDataLandmarkTransformFilter::New();
+    m_LandmarkFilter->SetSourceLandmarks(sourcePoints);
+    m_LandmarkFilter->SetTargetLandmarks(targetPoints);
+
+    m_DisplacementFilter = mitk::NavigationDataDisplacementFilter::New();
+    mitk::Vector3D offset;
+    mitk::FillVector3D(offset, 1.5, -2.5, 3.5);
+    m_DisplacementFilter->SetOffset(offset);
+
+    m_PreTransformFilter = mitk::NavigationDataTransformFilter::New();
+    m_PreTransformFilter->SetRigid3DTransform(this->CreateTransform(1.1, 0.0, 0.0, 150.0));
+    m_PreTransformFilter->PrecomposeOn();
+
+    m_SmoothingFilter = mitk::NavigationDataSmoothingFilter::New();
+    m_SmoothingFilter->SetNumerOfValues(3);
+  }
+
+  void tearDown() override
+  {
+    m_Inputs.clear();
+    m_PostTransformFilter = nullptr;
+    m_LandmarkFilter = nullptr;
+    m_DisplacementFilter = nullptr;
+    m_PreTransformFilter = nullptr;
+    m_SmoothingFilter = nullptr;
+  }
+
+  void TestChainEqualsFilterPipeline()
+  {
+    // classic pipeline
+    for (unsigned int i = 0; i < NumberOfTools; ++i)
+      m_PostTransformFilter->SetInput(i, m_Inputs[i]);
+    m_LandmarkFilter->ConnectTo(m_PostTransformFilter);
+    m_DisplacementFilter->ConnectTo(m_LandmarkFilter);
+    m_PreTransformFilter->ConnectTo(m_DisplacementFilter);
+    m_SmoothingFilter->ConnectTo(m_PreTransformFilter);
+
+    // the same filters as configuration of the chain
+    mitk::NavigationDataFilterChain::Pointer chain = mitk::NavigationDataFilterChain::New();
+    chain->AddFilter(m_PostTransformFilter);
+    chain->AddFilter(m_LandmarkFilter);
+    chain->AddFilter(m_DisplacementFilter);
+    chain->AddFilter(m_PreTransformFilter);
+    chain->AddFilter(m_SmoothingFilter);
+    CPPUNIT_ASSERT_EQUAL(5u, chain->GetNumberOfFilters());
+    for (unsigned int i = 0; i < NumberOfTools; ++i)
+      chain->SetInput(i, m_Inputs[i]);
+
+    for (unsigned int frame = 0; frame < 10; ++frame)
+    {
+      this->SetInputPoses(frame);
+      m_SmoothingFilter->Update();
+      chain->Update();
+
+      for (unsigned int i = 0; i < NumberOfTools; ++i)
+      {
+        CPPUNIT_ASSERT(chain->GetOutput(i)->IsDataValid());
+        CPPUNIT_ASSERT_EQUAL(m_Inputs[i]->GetName(), std::string(chain->GetOutput(i)->GetName()));
+        this->AssertPosesEqual(m_SmoothingFilter->GetOutput(i), chain->GetOutput(i));
+      }
+    }
+  }
+
+  void TestOutputsAreReused()
+  {
+    mitk::NavigationDataFilterChain::Pointer chain = mitk::NavigationDataFilterChain::New();
+    chain->AddFilter(m_PostTransformFilter);
+    for (unsigned int i = 0; i < NumberOfTools; ++i)
+      chain->SetInput(i, m_Inputs[i]);
+
+    chain->Update();
+    std::vector<mitk::NavigationData*> outputs;
+    for (unsigned int i = 0; i < NumberOfTools; ++i)
+      outputs.push_back(chain->GetOutput(i));
+
+    for (unsigned int frame = 1; frame < 5; ++frame)
+    {
+      this->SetInputPoses(frame);
+      chain->Update();
+      for (unsigned int i = 0; i < NumberOfTools; ++i)
+        CPPUNIT_ASSERT_MESSAGE("Testing if the outputs are reused", outputs[i] == chain->GetOutput(i));
+    }
+
+    // without stages the outputs are copies of the inputs
+    chain->RemoveAllFilters();
+    chain->Update();
+    for (unsigned int i = 0; i < NumberOfTools; ++i)
+      this->AssertPosesEqual(m_Inputs[i], chain->GetOutput(i));
+  }
+
+  void TestInvalidInputs()
+  {
+    mitk::NavigationDataFilterChain::Pointer chain = mitk::NavigationDataFilterChain::New();
+    chain->AddFilter(m_PostTransformFilter);
+    chain->AddFilter(m_DisplacementFilter);
+    for (unsigned int i = 0; i < NumberOfTools; ++i)
+      chain->SetInput(i, m_Inputs[i]);
+
+    m_Inputs[2]->SetDataValid(false);
+    chain->Update();
+    CPPUNIT_ASSERT_MESSAGE("Testing if an invalid input results in an invalid output", !chain->GetOutput(2)->IsDataValid());
+    CPPUNIT_ASSERT(chain->GetOutput(1)->IsDataValid());
+    CPPUNIT_ASSERT(chain->GetOutput(3)->IsDataValid());
+  }
+
+  void TestUnsupportedFilters()
+  {
+    mitk::NavigationDataFilterChain::Pointer chain = mitk::NavigationDataFilterChain::New();
+    mitk::NavigationDataPassThroughFilter::Pointer passThroughFilter = mitk::NavigationDataPassThroughFilter::New();
+    CPPUNIT_ASSERT_THROW(chain->AddFilter(passThroughFilter), mitk::IGTException);
+    CPPUNIT_ASSERT_EQUAL(0u, chain->GetNumberOfFilters());
+
+    // the 6DOF mode of the displacement filter combines several tools
+    m_DisplacementFilter->SetTransform6DOF(true);
+    chain->AddFilter(m_DisplacementFilter);
+    for (unsigned int i = 0; i < NumberOfTools; ++i)
+      chain->SetInput(i, m_Inputs[i]);
+    CPPUNIT_ASSERT_THROW(chain->Update(), itk::ExceptionObject);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkNavigationDataFilterChain)
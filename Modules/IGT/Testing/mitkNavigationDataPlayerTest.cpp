@@ -246,6 +246,41 @@ class mitkNavigationDataPlayerTestClass
     MITK_TEST_CONDITION_REQUIRED(player->IsAtEnd(), "Testing method IsAtEnd() #2");
     }
 
+    static void TestSeek()
+    {
+    // one time step every 10 ms, starting at 500 ms
+    mitk::NavigationDataSet::Pointer navigationDataSet = mitk::NavigationDataSet::New(1);
+    for (unsigned int i = 0; i < 1000; ++i)
+    {
+      mitk::NavigationData::Pointer nd = mitk::NavigationData::New();
+      mitk::Point3D position;
+      mitk::FillVector3D(position, i, 0.0, 0.0);
+      nd->SetPosition(position);
+      nd->SetIGTTimeStamp(500.0 + 10.0 * i);
+      nd->SetDataValid(true);
+      navigationDataSet->AddNavigationDatas(std::vector<mitk::NavigationData::Pointer>(1, nd));
+    }
+
+    mitk::NavigationDataPlayer::Pointer player = mitk::NavigationDataPlayer::New();
+    player->SetNavigationDataSet(navigationDataSet);
+    player->StartPlaying();
+    player->Pause();
+    player->Seek(2500.0);
+    player->Resume();
+    player->Update();
+    double x = player->GetOutput()->GetPosition()[0];
+    MITK_TEST_CONDITION_REQUIRED(x >= 250.0 && x < 260.0, "Testing Seek() forwards while paused");
+
+    player->Seek(100.0);
+    player->Update();
+    x = player->GetOutput()->GetPosition()[0];
+    MITK_TEST_CONDITION_REQUIRED(x >= 10.0 && x < 20.0, "Testing Seek() backwards while running");
+
+    player->Seek(20000.0);
+    player->Update();
+    MITK_TEST_CONDITION_REQUIRED(player->GetOutput()->GetPosition()[0] == 999.0, "Testing Seek() behind the end");
+    }
+
     static void TestInvalidStream()
     {
     MITK_TEST_OUTPUT(<<"#### Testing invalid input data: errors are expected. ####");
@@ -564,6 +599,7 @@ int mitkNavigationDataPlayerTest(int /* argc */, char* /*argv*/[])
   mitkNavigationDataPlayerTestClass::TestSetStreamExceptions();
   //mitkNavigationDataPlayerTestClass::TestStartPlayingExceptions();
   mitkNavigationDataPlayerTestClass::TestPauseAndResume();
+  mitkNavigationDataPlayerTestClass::TestSeek();
   //mitkNavigationDataPlayerTestClass::TestInvalidStream();
 
   // always end with this!
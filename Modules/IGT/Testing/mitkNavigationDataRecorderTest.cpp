@@ -17,6 +17,9 @@ found in the LICENSE file.
 #include <mitkTestingMacros.h>
 #include <mitkTestFixture.h>
 #include <mitkIOUtil.h>
+#include <mitkNavigationDataStreamReader.h>
+
+#include <cstdio>
 
 //for exceptions
 #include "mitkIGTException.h"
@@ -28,6 +31,7 @@ class mitkNavigationDataRecorderTestSuite : public mitk::TestFixture
   MITK_TEST(TestRecording);
   MITK_TEST(TestStopRecording);
   MITK_TEST(TestLimiting);
+  MITK_TEST(TestStreamingToFile);
 
   CPPUNIT_TEST_SUITE_END();
 
@@ -113,6 +117,28 @@ public:
     MITK_TEST_CONDITION_REQUIRED(m_Recorder->GetNavigationDataSet()->Size() == 30, "Test if SetRecordCountLimit works as intended.");
   }
 
+  void TestStreamingToFile()
+  {
+    std::string fileName = mitk::IOUtil::CreateTemporaryFile("NavigationDataRecorderTest_XXXXXX.nds");
+    m_Recorder->SetStreamFileName(fileName);
+    m_Recorder->StartRecording();
+    while (!m_Player->IsAtEnd())
+    {
+      m_Recorder->Update();
+      m_Player->GoToNextSnapshot();
+    }
+    m_Recorder->StopRecording();
+
+    mitk::NavigationDataStreamReader::Pointer reader = mitk::NavigationDataStreamReader::New();
+    reader->Open(fileName);
+    MITK_TEST_CONDITION_REQUIRED(reader->GetNumberOfTimeSteps() == m_NavigationDataSet->Size(), "Test if all recorded time steps were written to the file");
+    MITK_TEST_CONDITION_REQUIRED(compareDataSet(reader->Read()), "Test streamed dataset for equality with reference");
+
+    reader->Close();
+    m_Recorder->ResetRecording();
+    std::remove(fileName.c_str());
+  }
+
 private:
 
   /*
@@ -0,0 +1,187 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+//testing headers
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+#include <mitkIOUtil.h>
+#include <mitkNavigationData.h>
+#include <mitkNavigationDataSet.h>
+#include <mitkNavigationDataStreamReader.h>
+#include <mitkNavigationDataStreamWriter.h>
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+//for exceptions
+#include "mitkIGTIOException.h"
+
+class mitkNavigationDataSetReaderWriterBinaryTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkNavigationDataSetReaderWriterBinaryTestSuite);
+  MITK_TEST(TestReadWrite);
+  MITK_TEST(TestReadSingleTimeSteps);
+  MITK_TEST(TestIncompleteTimeStepIsIgnored);
+  MITK_TEST(TestWrongFileThrowsException);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+
+  const unsigned int NUMBER_OF_TOOLS = 3;
+  const unsigned int NUMBER_OF_TIME_STEPS = 500;
+
+  mitk::NavigationDataSet::Pointer m_Set;
+  std::string m_FileName;
+
+  mitk::NavigationDataSet::Pointer CreateSet()
+  {
+    mitk::NavigationDataSet::Pointer set = mitk::NavigationDataSet::New(NUMBER_OF_TOOLS);
+
+    std::vector<mitk::NavigationData::Pointer> timeStep;
+    for (unsigned int tool = 0; tool < NUMBER_OF_TOOLS; tool++)
+    {
+      timeStep.push_back(mitk::NavigationData::New());
+      timeStep.back()->SetName(("Tool " + std::to_string(tool)).c_str());
+    }
+
+    for (unsigned int i = 0; i < NUMBER_OF_TIME_STEPS; i++)
+    {
+      for (unsigned int tool = 0; tool < NUMBER_OF_TOOLS; tool++)
+      {
+        mitk::NavigationData::PositionType position;
+        position[0] = 0.1 * i;
+        position[1] = tool;
+        position[2] = -1.0 / (i + 1);
+        timeStep[tool]->SetPosition(position);
+        timeStep[tool]->SetOrientation(mitk::NavigationData::OrientationType(std::sin(0.001 * i), 0.0, 0.0, std::cos(0.001 * i)));
+        timeStep[tool]->SetIGTTimeStamp(1000.0 + 16.6 * i + 0.01 * tool);
+        timeStep[tool]->SetDataValid((i + tool) % 7 != 0);
+        timeStep[tool]->SetHasOrientation(tool != 1);
+        timeStep[tool]->SetPositionAccuracy(0.25 * (tool + 1));
+        timeStep[tool]->SetOrientationAccuracy(0.5);
+      }
+      set->AddNavigationDatas(timeStep);
+    }
+    return set;
+  }
+
+  bool CompareSets(mitk::NavigationDataSet::Pointer reference, mitk::NavigationDataSet::Pointer set)
+  {
+    if (reference->Size() != set->Size() || reference->GetNumberOfTools() != set->GetNumberOfTools())
+      return false;
+
+    for (unsigned int i = 0; i < reference->Size(); i++)
+    {
+      for (unsigned int tool = 0; tool < reference->GetNumberOfTools(); tool++)
+      {
+        mitk::NavigationData::Pointer ref = reference->GetNavigationDataForIndex(i, tool);
+        mitk::NavigationData::Pointer nd = set->GetNavigationDataForIndex(i, tool);
+        if (!mitk::Equal(*ref, *nd) || ref->IsDataValid() != nd->IsDataValid()
+          || ref->GetHasPosition() != nd->GetHasPosition() || ref->GetHasOrientation() != nd->GetHasOrientation())
+          return false;
+      }
+    }
+    return true;
+  }
+
+public:
+
+  void setUp() override
+  {
+    m_Set = CreateSet();
+    m_FileName = mitk::IOUtil::CreateTemporaryFile("NavigationDataSetReaderWriterBinaryTest_XXXXXX.nds");
+  }
+
+  void tearDown() override
+  {
+    std::remove(m_FileName.c_str());
+    m_Set = nullptr;
+  }
+
+  void TestReadWrite()
+  {
+    mitk::IOUtil::Save(m_Set, m_FileName);
+    mitk::NavigationDataSet::Pointer set = mitk::IOUtil::Load<mitk::NavigationDataSet>(m_FileName);
+
+    CPPUNIT_ASSERT_MESSAGE("Testing whether something was read at all", set.IsNotNull());
+    CPPUNIT_ASSERT_MESSAGE("Testing if read/write cycle creates identical sets", CompareSets(m_Set, set));
+  }
+
+  void TestReadSingleTimeSteps()
+  {
+    std::stringstream stream;
+    mitk::NavigationDataStreamWriter::Pointer writer = mitk::NavigationDataStreamWriter::New();
+    writer->Open(&stream);
+    writer->AddTimeSteps(m_Set);
+    writer->Close();
+    CPPUNIT_ASSERT_EQUAL(NUMBER_OF_TIME_STEPS, writer->GetNumberOfTimeSteps());
+
+    mitk::NavigationDataStreamReader::Pointer reader = mitk::NavigationDataStreamReader::New();
+    reader->Open(&stream);
+    CPPUNIT_ASSERT_EQUAL(NUMBER_OF_TOOLS, reader->GetNumberOfTools());
+    CPPUNIT_ASSERT_EQUAL(NUMBER_OF_TIME_STEPS, reader->GetNumberOfTimeSteps());
+    CPPUNIT_ASSERT_EQUAL(std::string("Tool 2"), reader->GetToolName(2));
+
+    std::vector<mitk::NavigationData::Pointer> timeStep;
+    for (unsigned int tool = 0; tool < NUMBER_OF_TOOLS; tool++)
+      timeStep.push_back(mitk::NavigationData::New());
+
+    for (unsigned int i : { 0u, 499u, 17u, 250u })
+    {
+      CPPUNIT_ASSERT(reader->ReadTimeStep(i, timeStep));
+      for (unsigned int tool = 0; tool < NUMBER_OF_TOOLS; tool++)
+        CPPUNIT_ASSERT(mitk::Equal(*m_Set->GetNavigationDataForIndex(i, tool), *timeStep[tool]));
+    }
+    CPPUNIT_ASSERT(!reader->ReadTimeStep(NUMBER_OF_TIME_STEPS, timeStep));
+
+    CPPUNIT_ASSERT_EQUAL(0u, reader->FindTimeStep(0.0));
+    CPPUNIT_ASSERT_EQUAL(123u, reader->FindTimeStep(m_Set->GetIGTTimeStampForIndex(123, 0)));
+    CPPUNIT_ASSERT_EQUAL(123u, reader->FindTimeStep(m_Set->GetIGTTimeStampForIndex(123, 0) + 1.0));
+    CPPUNIT_ASSERT_EQUAL(NUMBER_OF_TIME_STEPS - 1, reader->FindTimeStep(1e12));
+  }
+
+  void TestIncompleteTimeStepIsIgnored()
+  {
+    mitk::NavigationDataStreamWriter::Pointer writer = mitk::NavigationDataStreamWriter::New();
+    writer->Open(m_FileName);
+    writer->AddTimeSteps(m_Set);
+    writer->Close();
+
+    // simulate a recording that was interrupted while writing a time step
+    {
+      std::ofstream file(m_FileName.c_str(), std::ios::out | std::ios::binary | std::ios::app);
+      file.write("incomplete", 10);
+    }
+
+    mitk::NavigationDataStreamReader::Pointer reader = mitk::NavigationDataStreamReader::New();
+    reader->Open(m_FileName);
+    CPPUNIT_ASSERT_EQUAL(NUMBER_OF_TIME_STEPS, reader->GetNumberOfTimeSteps());
+    CPPUNIT_ASSERT(CompareSets(m_Set, reader->Read()));
+  }
+
+  void TestWrongFileThrowsException()
+  {
+    {
+      std::ofstream file(m_FileName.c_str());
+      file << "TimeStamp_Tool0;Valid_Tool0;X_Tool0;Y_Tool0;Z_Tool0;QX_Tool0;QY_Tool0;QZ_Tool0;QR_Tool0;\n";
+    }
+
+    mitk::NavigationDataStreamReader::Pointer reader = mitk::NavigationDataStreamReader::New();
+    CPPUNIT_ASSERT_THROW(reader->Open(m_FileName), mitk::IGTIOException);
+    CPPUNIT_ASSERT(!reader->IsOpen());
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkNavigationDataSetReaderWriterBinary)
@@ -14,6 +14,8 @@ found in the LICENSE file.
 #include "mitkNavigationData.h"
 #include "mitkNavigationDataSet.h"
 
+#include <cmath>
+
 static void TestEmptySet()
 {
   mitk::NavigationDataSet::Pointer navigationDataSet = mitk::NavigationDataSet::New(1);
@@ -59,22 +61,78 @@ static void TestSetAndGet()
   MITK_TEST_CONDITION_REQUIRED(!(navigationDataSet->AddNavigationDatas(step3)),
     "Adding an invalid third set, should be unsusuccessful.");
 
-  MITK_TEST_CONDITION_REQUIRED(navigationDataSet->GetNavigationDataForIndex(0, 0) == nd11,
+  // the set stores the values, so the returned objects are equal copies of the added ones
+  MITK_TEST_CONDITION_REQUIRED(mitk::Equal(*navigationDataSet->GetNavigationDataForIndex(0, 0), *nd11),
     "First NavigationData object for tool 0 should be the same as added previously.");
-  MITK_TEST_CONDITION_REQUIRED(navigationDataSet->GetNavigationDataForIndex(0, 1) == nd21,
+  MITK_TEST_CONDITION_REQUIRED(mitk::Equal(*navigationDataSet->GetNavigationDataForIndex(0, 1), *nd21),
     "Second NavigationData object for tool 0 should be the same as added previously.");
-  MITK_TEST_CONDITION_REQUIRED(navigationDataSet->GetNavigationDataForIndex(1, 0) == nd12,
+  MITK_TEST_CONDITION_REQUIRED(mitk::Equal(*navigationDataSet->GetNavigationDataForIndex(1, 0), *nd12),
     "First NavigationData object for tool 0 should be the same as added previously.");
-  MITK_TEST_CONDITION_REQUIRED(navigationDataSet->GetNavigationDataForIndex(1, 1) == nd22,
+  MITK_TEST_CONDITION_REQUIRED(mitk::Equal(*navigationDataSet->GetNavigationDataForIndex(1, 1), *nd22),
     "Second NavigationData object for tool 0 should be the same as added previously.");
 
   std::vector<mitk::NavigationData::Pointer> result = navigationDataSet->GetTimeStep(1);
-  MITK_TEST_CONDITION_REQUIRED(nd12 == result[0],"Comparing returned datas from GetTimeStep().");
-  MITK_TEST_CONDITION_REQUIRED(nd22 == result[1],"Comparing returned datas from GetTimeStep().");
+  MITK_TEST_CONDITION_REQUIRED(mitk::Equal(*nd12, *result[0]),"Comparing returned datas from GetTimeStep().");
+  MITK_TEST_CONDITION_REQUIRED(mitk::Equal(*nd22, *result[1]),"Comparing returned datas from GetTimeStep().");
 
   result = navigationDataSet->GetDataStreamForTool(1);
-  MITK_TEST_CONDITION_REQUIRED(nd21 == result[0],"Comparing returned datas from GetStreamForTool().");
-  MITK_TEST_CONDITION_REQUIRED(nd22 == result[1],"Comparing returned datas from GetStreamForTool().");
+  MITK_TEST_CONDITION_REQUIRED(mitk::Equal(*nd21, *result[0]),"Comparing returned datas from GetStreamForTool().");
+  MITK_TEST_CONDITION_REQUIRED(mitk::Equal(*nd22, *result[1]),"Comparing returned datas from GetStreamForTool().");
+
+  MITK_TEST_CONDITION_REQUIRED(navigationDataSet->GetIGTTimeStampForIndex(1, 1) == nd22->GetIGTTimeStamp(),
+    "Comparing time stamp returned by GetIGTTimeStampForIndex().");
+}
+
+static void TestColumnarStorage()
+{
+  mitk::NavigationDataSet::Pointer navigationDataSet = mitk::NavigationDataSet::New(1);
+
+  mitk::NavigationData::Pointer nd = mitk::NavigationData::New();
+  nd->SetName("Tool");
+  mitk::NavigationData::PositionType position;
+  for (int i = 0; i < 100; i++)
+  {
+    position[0] = i;
+    position[1] = 2 * i;
+    position[2] = -i;
+    nd->SetPosition(position);
+    nd->SetOrientation(mitk::NavigationData::OrientationType(0.0, 0.0, std::sin(0.01 * i), std::cos(0.01 * i)));
+    nd->SetIGTTimeStamp(i + 1);
+    nd->SetDataValid(i % 3 != 0);
+    nd->SetHasOrientation(i % 2 == 0);
+    nd->SetPositionAccuracy(i < 50 ? 0.1 : 0.2);
+    // the same object is reused, the set has to copy the values
+    navigationDataSet->AddNavigationDatas(std::vector<mitk::NavigationData::Pointer>(1, nd));
+  }
+
+  MITK_TEST_CONDITION_REQUIRED(navigationDataSet->Size() == 100, "Testing size of set after adding a reused NavigationData.");
+
+  mitk::NavigationData::Pointer output = mitk::NavigationData::New();
+  bool allEqual = true;
+  for (unsigned int i = 0; i < 100; i++)
+  {
+    navigationDataSet->GetNavigationDataForIndex(i, 0, output);
+    allEqual = allEqual
+      && output->GetPosition()[1] == 2.0 * i
+      && output->GetIGTTimeStamp() == i + 1
+      && output->IsDataValid() == (i % 3 != 0)
+      && output->GetHasOrientation() == (i % 2 == 0)
+      && output->GetCovErrorMatrix()[0][0] == (i < 50 ? 0.1 * 0.1 : 0.2 * 0.2)
+      && std::string(output->GetName()) == "Tool";
+  }
+  MITK_TEST_CONDITION_REQUIRED(allEqual, "Testing values of all time steps.");
+
+  MITK_TEST_CONDITION_REQUIRED(!navigationDataSet->GetNavigationDataForIndex(100, 0, output),
+    "Reading behind the last time step should fail.");
+
+  unsigned int numberOfTimeSteps = 0;
+  for (auto it = navigationDataSet->Begin(); it != navigationDataSet->End(); ++it)
+  {
+    if (it->at(0)->GetIGTTimeStamp() == it.GetIndex() + 1)
+      numberOfTimeSteps++;
+  }
+  MITK_TEST_CONDITION_REQUIRED(numberOfTimeSteps == 100, "Testing iteration over all time steps.");
+  MITK_TEST_CONDITION_REQUIRED(navigationDataSet->End() - navigationDataSet->Begin() == 100, "Testing iterator difference.");
 }
 
 /**
@@ -86,6 +144,7 @@ int mitkNavigationDataSetTest(int /* argc */, char* /*argv*/[])
 
   TestEmptySet();
   TestSetAndGet();
+  TestColumnarStorage();
 
   MITK_TEST_END();
 }
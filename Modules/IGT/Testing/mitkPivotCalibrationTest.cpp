@@ -0,0 +1,159 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+//testing headers
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+#include <mitkPivotCalibration.h>
+
+#include <cmath>
+#include <random>
+
+class mitkPivotCalibrationTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkPivotCalibrationTestSuite);
+  MITK_TEST(TestExactPoses);
+  MITK_TEST(TestResultAfterEachPose);
+  MITK_TEST(TestInvalidPosesAreSkipped);
+  MITK_TEST(TestRobustEstimation);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  mitk::Point3D m_PivotPoint;   ///< pivot point in tracking coordinates
+  mitk::Point3D m_ToolTip;      ///< tool tip in tool coordinates
+  std::mt19937 m_RandomGenerator;
+
+  /** creates a pose of the tool rotated around the pivot point, the tool tip is moved by the given offset */
+  mitk::NavigationData::Pointer CreatePose(double noise, double offset)
+  {
+    std::uniform_real_distribution<double> angle(-0.6, 0.6);
+    std::normal_distribution<double> normal(0.0, 1.0);
+
+    vnl_vector_fixed<double, 3> axis(angle(m_RandomGenerator), angle(m_RandomGenerator), 0.2 * angle(m_RandomGenerator));
+    const double rotationAngle = axis.magnitude();
+    axis.normalize();
+    mitk::Quaternion orientation(axis, rotationAngle);
+
+    vnl_vector_fixed<double, 3> toolTip(m_ToolTip[0], m_ToolTip[1], m_ToolTip[2]);
+    vnl_vector_fixed<double, 3> rotatedToolTip = orientation.rotate(toolTip);
+    mitk::Point3D position;
+    for (int i = 0; i < 3; ++i)
+      position[i] = m_PivotPoint[i] - rotatedToolTip[i] + noise * normal(m_RandomGenerator);
+    position[0] += offset;
+
+    mitk::NavigationData::Pointer pose = mitk::NavigationData::New();
+    pose->SetOrientation(orientation);
+    pose->SetPosition(position);
+    pose->SetDataValid(true);
+    return pose;
+  }
+
+public:
+
+  void setUp() override
+  {
+    mitk::FillVector3D(m_PivotPoint, 100.0, -50.0, 200.0);
+    mitk::FillVector3D(m_ToolTip, 10.0, 20.0, -150.0);
+    m_RandomGenerator.seed(42);
+  }
+
+  void tearDown() override
+  {
+  }
+
+  void TestExactPoses()
+  {
+    mitk::PivotCalibration::Pointer calibration = mitk::PivotCalibration::New();
+    for (int i = 0; i < 20; ++i)
+      calibration->AddNavigationData(this->CreatePose(0.0, 0.0));
+
+    CPPUNIT_ASSERT(calibration->ComputePivotResult());
+    CPPUNIT_ASSERT_MESSAGE("Testing the tool tip", mitk::Equal(m_ToolTip, calibration->GetResultPivotPoint(), 1e-6));
+    CPPUNIT_ASSERT_MESSAGE("Testing the pivot point", mitk::Equal(m_PivotPoint, calibration->GetResultPivotPointInTrackingCoordinates(), 1e-6));
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, calibration->GetResultRMSError(), 1e-6);
+  }
+
+  void TestResultAfterEachPose()
+  {
+    mitk::PivotCalibration::Pointer calibration = mitk::PivotCalibration::New();
+    CPPUNIT_ASSERT_MESSAGE("Testing calibration without poses", !calibration->ComputePivotResult());
+
+    calibration->AddNavigationData(this->CreatePose(0.1, 0.0));
+    CPPUNIT_ASSERT_MESSAGE("Testing calibration with one pose", !calibration->ComputePivotResult());
+
+    for (int i = 1; i < 20000; ++i)
+    {
+      calibration->AddNavigationData(this->CreatePose(0.1, 0.0));
+      if (i % 1000 == 0)
+      {
+        CPPUNIT_ASSERT(calibration->ComputePivotResult());
+        CPPUNIT_ASSERT(calibration->GetResultRMSError() < 0.2);
+      }
+    }
+    CPPUNIT_ASSERT(calibration->ComputePivotResult());
+    CPPUNIT_ASSERT(mitk::Equal(m_ToolTip, calibration->GetResultPivotPoint(), 0.05));
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.1, calibration->GetResultRMSError(), 0.01);
+
+    calibration->Reset();
+    CPPUNIT_ASSERT_EQUAL(0u, calibration->GetNumberOfPoses());
+    CPPUNIT_ASSERT(!calibration->ComputePivotResult());
+  }
+
+  void TestInvalidPosesAreSkipped()
+  {
+    mitk::PivotCalibration::Pointer calibration = mitk::PivotCalibration::New();
+    for (int i = 0; i < 10; ++i)
+    {
+      mitk::NavigationData::Pointer pose = this->CreatePose(0.0, i % 2 == 0 ? 0.0 : 50.0);
+      pose->SetDataValid(i % 2 == 0);
+      calibration->AddNavigationData(pose);
+    }
+    CPPUNIT_ASSERT_EQUAL(5u, calibration->GetNumberOfPoses());
+    CPPUNIT_ASSERT(calibration->ComputePivotResult());
+    CPPUNIT_ASSERT(mitk::Equal(m_ToolTip, calibration->GetResultPivotPoint(), 1e-6));
+  }
+
+  void TestRobustEstimation()
+  {
+    mitk::PivotCalibration::Pointer calibration = mitk::PivotCalibration::New();
+    unsigned int numberOfOutliers = 0;
+    for (int i = 0; i < 10000; ++i)
+    {
+      // every tenth pose is off by 20 mm
+      bool outlier = (i % 10 == 3);
+      numberOfOutliers += outlier ? 1 : 0;
+      calibration->AddNavigationData(this->CreatePose(0.1, outlier ? 20.0 : 0.0));
+    }
+
+    CPPUNIT_ASSERT(calibration->ComputePivotResult());
+    const double leastSquaresError = calibration->GetResultRMSError();
+    CPPUNIT_ASSERT_MESSAGE("Testing if the outliers disturb the least squares result",
+      !mitk::Equal(m_PivotPoint, calibration->GetResultPivotPointInTrackingCoordinates(), 1.0));
+
+    calibration->RobustEstimationOn();
+    calibration->SetNumberOfThreads(1);
+    CPPUNIT_ASSERT(calibration->ComputePivotResult());
+    mitk::Point3D singleThreadedResult = calibration->GetResultPivotPoint();
+    CPPUNIT_ASSERT(mitk::Equal(m_ToolTip, calibration->GetResultPivotPoint(), 0.3));
+    CPPUNIT_ASSERT(mitk::Equal(m_PivotPoint, calibration->GetResultPivotPointInTrackingCoordinates(), 0.3));
+    CPPUNIT_ASSERT_EQUAL(numberOfOutliers, calibration->GetNumberOfOutliers());
+    CPPUNIT_ASSERT(calibration->GetResultRMSError() < leastSquaresError);
+
+    calibration->SetNumberOfThreads(4);
+    CPPUNIT_ASSERT(calibration->ComputePivotResult());
+    CPPUNIT_ASSERT_MESSAGE("Testing if the result does not depend on the number of threads",
+      mitk::Equal(singleThreadedResult, calibration->GetResultPivotPoint(), 1e-12));
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkPivotCalibration)
@@ -105,7 +105,17 @@ int mitkTrackingDeviceSourceTest(int /* argc */, char* /*argv*/[])
     MITK_TEST_CONDITION(mitk::Equal(newPos, pos) == false, "Testing if output changes on each update");
   }
 
+  MITK_TEST_CONDITION(tracker->IsPublishingToolStates(), "Testing if the virtual tracking device publishes its frames");
+  mitk::TrackingDeviceSource::LatencyStatistics latency = mySource->GetLatencyStatistics();
+  MITK_TEST_CONDITION(latency.NumberOfSamples > 0, "Testing if the latency is measured");
+  MITK_TEST_CONDITION(latency.Minimum >= 0 && latency.Minimum <= latency.Mean && latency.Mean <= latency.Maximum, "Testing latency statistics");
+  mySource->ResetLatencyStatistics();
+  MITK_TEST_CONDITION(mySource->GetLatencyStatistics().NumberOfSamples == 0, "Testing ResetLatencyStatistics()");
+
   mySource->StopTracking();
+  MITK_TEST_CONDITION(!tracker->IsPublishingToolStates(), "Testing if a stopped tracking device falls back to the tools");
+  mitk::TrackingDevice::ToolStateFrame frame;
+  MITK_TEST_CONDITION(!tracker->GetLatestToolStates(frame), "Testing if no frame of the stopped session is delivered");
   mySource->Disconnect();
 
   tracker = mitk::VirtualTrackingDevice::New();
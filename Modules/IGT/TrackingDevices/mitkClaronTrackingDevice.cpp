@@ -286,6 +286,7 @@ void mitk::ClaronTrackingDevice::TrackTools()
           currentTool->SetDataValid(false);
         }
       }
+      this->PublishToolStates();
       /* Update the local copy of m_StopTracking */
       this->m_StopTrackingMutex->Lock();
       localStopTracking = m_StopTracking;
@@ -389,6 +389,7 @@ void mitk::MicroBirdTrackingDevice::TrackTools()
         HandleError(errorCode);
       }
     }
+    this->PublishToolStates();
 
     /// @todo : is there any synchronisation?
     // Average timestamp: timeStamp/nOfAttachedSensors
@@ -758,6 +758,7 @@ void mitk::NDITrackingDevice::TrackTools()
       if (returnvalue != NDIOKAY)
         break;
     }
+    this->PublishToolStates();
     /* Update the local copy of m_StopTracking */
     this->m_StopTrackingMutex->Lock();
     localStopTracking = m_StopTracking;
@@ -844,6 +845,7 @@ void mitk::NDITrackingDevice::TrackToolsAndMarkers()
     {
       std::cout << "Error in TX: could not read data. Possibly no markers present." << std::endl;
     }
+    this->PublishToolStates();
     /* Update the local copy of m_StopTracking */
     this->m_StopTrackingMutex->Lock();
     localStopTracking = m_StopTracking;
@@ -352,6 +352,7 @@ void mitk::OpenIGTLinkTrackingDevice::UpdateTools()
       }
     }
   }
+  this->PublishToolStates();
 }
 
 bool mitk::OpenIGTLinkTrackingDevice::StartTracking()
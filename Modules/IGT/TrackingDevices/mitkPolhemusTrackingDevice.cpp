@@ -220,6 +220,7 @@ void mitk::PolhemusTrackingDevice::TrackTools()
           currentTool->SetOrientation(lastData.at(i).rot);
           currentTool->SetIGTTimeStamp(mitk::IGTTimeStamp::GetInstance()->GetElapsed());
         }
+        this->PublishToolStates();
       }
       /* Update the local copy of m_StopTracking */
       this->m_StopTrackingMutex->Lock();
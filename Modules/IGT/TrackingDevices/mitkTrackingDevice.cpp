@@ -29,7 +29,10 @@ mitk::TrackingDevice::TrackingDevice() :
   m_State(mitk::TrackingDevice::Setup),
   m_Data(mitk::UnspecifiedTrackingTypeInformation::GetDeviceDataUnspecified()),
   m_StopTracking(false),
-  m_RotationMode(mitk::TrackingDevice::RotationStandard)
+  m_RotationMode(mitk::TrackingDevice::RotationStandard),
+  m_ToolStates(new LockFreeTripleBuffer<ToolStateFrame>()),
+  m_PublishingToolStates(false),
+  m_DroppedToolStates(0)
 
 {
   m_StopTrackingMutex = itk::FastMutexLock::New();
@@ -82,6 +85,11 @@ void mitk::TrackingDevice::SetState( TrackingDeviceState state )
   {
     return;
   }
+  // frames of a previous tracking session must neither be delivered nor keep the consumer on the published path
+  if (m_State == Tracking || state == Tracking)
+  {
+    this->ResetToolStates();
+  }
   m_State = state;
   this->Modified();
 }
@@ -151,3 +159,51 @@ std::string mitk::TrackingDevice::GetTrackingDeviceName()
 {
   return this->GetData().Line;
 }
+
+bool mitk::TrackingDevice::IsPublishingToolStates() const
+{
+  return m_PublishingToolStates.load();
+}
+
+bool mitk::TrackingDevice::GetLatestToolStates(ToolStateFrame& frame)
+{
+  return m_ToolStates->TakeLatest(frame);
+}
+
+unsigned long mitk::TrackingDevice::GetNumberOfDroppedToolStates() const
+{
+  return m_DroppedToolStates.load();
+}
+
+void mitk::TrackingDevice::ResetToolStates()
+{
+  m_PublishingToolStates = false;
+  m_ToolStates->Clear();
+  m_DroppedToolStates = 0;
+}
+
+void mitk::TrackingDevice::PublishToolStates()
+{
+  ToolStateFrame* frame = m_ToolStates->GetBackSlot();
+
+  const double now = mitk::IGTTimeStamp::GetInstance()->GetElapsed();
+  const unsigned int toolCount = this->GetToolCount();
+  frame->resize(toolCount);
+  for (unsigned int i = 0; i < toolCount; ++i)
+  {
+    mitk::TrackingTool* tool = this->GetTool(i);
+    ToolState& state = (*frame)[i];
+    tool->GetPosition(state.Position);
+    tool->GetOrientation(state.Orientation);
+    state.TrackingError = tool->GetTrackingError();
+    state.Enabled = tool->IsEnabled();
+    state.DataValid = tool->IsDataValid();
+    state.IGTTimeStamp = tool->GetIGTTimeStamp() != 0 ? tool->GetIGTTimeStamp() : now;
+  }
+
+  if (!m_ToolStates->Publish())
+  {
+    ++m_DroppedToolStates;
+  }
+  m_PublishingToolStates = true;
+}
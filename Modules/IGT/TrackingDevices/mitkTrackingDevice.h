@@ -20,6 +20,12 @@ found in the LICENSE file.
 #include "mitkTrackingTypes.h"
 #include "itkFastMutexLock.h"
 #include "mitkNavigationToolStorage.h"
+#include "mitkLockFreeTripleBuffer.h"
+#include <mitkNumericTypes.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
 
 
 namespace mitk {
@@ -179,15 +185,62 @@ namespace mitk {
      */
     virtual mitk::NavigationToolStorage::Pointer AutoDetectTools();
 
+    /** \brief State of one tool in one frame published by the tracking thread, see PublishToolStates() */
+    struct ToolState
+    {
+      Point3D Position;
+      Quaternion Orientation;
+      float TrackingError;
+      bool Enabled;
+      bool DataValid;
+      double IGTTimeStamp; ///< time at which the tracking data was recorded (milliseconds)
+    };
+    typedef std::vector<ToolState> ToolStateFrame; ///< states of all tools, ordered like GetTool()
+
+    /**
+     * \brief Returns true if the tracking thread of this device publishes its frames with PublishToolStates().
+     *
+     * Consumers of such devices should use GetLatestToolStates() instead of the locked getters of the tools.
+     * The flag is reset whenever tracking starts or stops, so a stopped device is read via the tools again.
+     */
+    bool IsPublishingToolStates() const;
+
+    /**
+     * \brief Takes the newest frame published by the tracking thread.
+     *
+     * The frames are handed over by a lock-free single producer / single consumer triple buffer, in which
+     * a new frame replaces an older one that was not taken yet. Thus only one consumer (usually the
+     * mitk::TrackingDeviceSource of this device) may call this method.
+     * @return false if no frame was published since the last call
+     */
+    bool GetLatestToolStates(ToolStateFrame& frame);
+
+    /**
+     * \brief Returns the number of frames that were replaced by a newer frame before the consumer took them,
+     * counted since tracking was started.
+     */
+    unsigned long GetNumberOfDroppedToolStates() const;
+
     private:
       TrackingDeviceState m_State; ///< current object state (Setup, Ready or Tracking)
     protected:
 
       /**
       * \brief  change object state
+      *
+      * Changing to or from Tracking discards the tool states published by PublishToolStates().
       */
       void SetState(TrackingDeviceState state);
 
+      /**
+      * \brief Publishes the current state of all tools as one frame. Call this from the tracking thread
+      * after all tools were updated.
+      *
+      * Tools without an IGT time stamp are stamped with the current time. If the previous frame was not
+      * taken yet, it is replaced and counted by GetNumberOfDroppedToolStates().
+      */
+      void PublishToolStates();
+
 
       TrackingDevice();
       ~TrackingDevice() override;
@@ -199,6 +252,14 @@ namespace mitk {
       itk::FastMutexLock::Pointer m_TrackingFinishedMutex; ///< mutex to manage control flow of StopTracking()
       itk::FastMutexLock::Pointer m_StateMutex; ///< mutex to control access to m_State
       RotationMode m_RotationMode; ///< defines the rotation mode Standard or Transposed, Standard is default
+
+    private:
+      /** \brief Discards published tool states and falls back to the tools until the next PublishToolStates(). */
+      void ResetToolStates();
+
+      std::unique_ptr<LockFreeTripleBuffer<ToolStateFrame>> m_ToolStates; ///< frames handed from the tracking thread to the consumer
+      std::atomic<bool> m_PublishingToolStates; ///< true after the first call of PublishToolStates() since tracking started
+      std::atomic<unsigned long> m_DroppedToolStates; ///< number of frames replaced before the consumer took them
     };
 } // namespace mitk
 
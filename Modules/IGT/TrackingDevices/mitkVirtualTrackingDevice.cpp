@@ -265,6 +265,7 @@ void mitk::VirtualTrackingDevice::TrackTools()
       currentTool->SetDataValid(true);
       currentTool->Modified();
     }
+    this->PublishToolStates();
     itksys::SystemTools::Delay(m_RefreshRate);
     /* Update the local copy of m_StopTracking */
     this->m_StopTrackingMutex->Lock();
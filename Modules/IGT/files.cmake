@@ -5,6 +5,7 @@ set(CPP_FILES
   Algorithms/mitkNavigationDataDelayFilter.cpp
   Algorithms/mitkNavigationDataDisplacementFilter.cpp
   Algorithms/mitkNavigationDataEvaluationFilter.cpp
+  Algorithms/mitkNavigationDataFilterChain.cpp
   Algorithms/mitkNavigationDataLandmarkTransformFilter.cpp
   Algorithms/mitkNavigationDataPassThroughFilter.cpp
   Algorithms/mitkNavigationDataReferenceTransformFilter.cpp
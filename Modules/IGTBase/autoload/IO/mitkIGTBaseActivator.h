@@ -35,6 +35,8 @@ private:
   std::unique_ptr<IFileWriter> m_NavigationDataSetWriterCSV;
   std::unique_ptr<IFileReader> m_NavigationDataReaderXML;
   std::unique_ptr<IFileReader> m_NavigationDataReaderCSV;
+  std::unique_ptr<IFileWriter> m_NavigationDataSetWriterBinary;
+  std::unique_ptr<IFileReader> m_NavigationDataReaderBinary;
 };
 
 }
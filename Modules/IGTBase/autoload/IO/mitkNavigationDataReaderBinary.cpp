@@ -0,0 +1,54 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+// MITK
+#include "mitkNavigationDataReaderBinary.h"
+#include <mitkIGTMimeTypes.h>
+#include <mitkNavigationDataStreamReader.h>
+
+mitk::NavigationDataReaderBinary::NavigationDataReaderBinary() : AbstractFileReader(
+  mitk::IGTMimeTypes::NAVIGATIONDATASETBINARY_MIMETYPE(),
+  "MITK NavigationData Reader (binary)")
+{
+  RegisterService();
+}
+
+mitk::NavigationDataReaderBinary::NavigationDataReaderBinary(const mitk::NavigationDataReaderBinary& other) : AbstractFileReader(other)
+{
+}
+
+mitk::NavigationDataReaderBinary::~NavigationDataReaderBinary()
+{
+}
+
+mitk::NavigationDataReaderBinary* mitk::NavigationDataReaderBinary::Clone() const
+{
+  return new NavigationDataReaderBinary(*this);
+}
+
+std::vector<itk::SmartPointer<mitk::BaseData>> mitk::NavigationDataReaderBinary::Read()
+{
+  mitk::NavigationDataStreamReader::Pointer reader = mitk::NavigationDataStreamReader::New();
+  std::istream* in = GetInputStream();
+  if (in == nullptr)
+  {
+    reader->Open(GetInputLocation());
+  }
+  else
+  {
+    reader->Open(in);
+  }
+
+  std::vector<mitk::BaseData::Pointer> result;
+  result.push_back(reader->Read().GetPointer());
+  return result;
+}
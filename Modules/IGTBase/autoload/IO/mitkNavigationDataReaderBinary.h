@@ -0,0 +1,42 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef MITKNavigationDataReaderBinary_H_HEADER_INCLUDED_
+#define MITKNavigationDataReaderBinary_H_HEADER_INCLUDED_
+
+#include <MitkIGTIOExports.h>
+
+#include <mitkAbstractFileReader.h>
+#include <mitkNavigationDataSet.h>
+
+namespace mitk {
+  /** This class reads navigation data sets that were written in the binary format of
+   *  mitk::NavigationDataStreamWriter, e.g. by mitk::NavigationDataRecorder while recording.
+   */
+  class MITKIGTIO_EXPORT NavigationDataReaderBinary : public AbstractFileReader
+  {
+  public:
+
+    NavigationDataReaderBinary();
+    ~NavigationDataReaderBinary() override;
+
+    using AbstractFileReader::Read;
+    std::vector<itk::SmartPointer<BaseData>> Read() override;
+
+  protected:
+
+    NavigationDataReaderBinary(const NavigationDataReaderBinary& other);
+    mitk::NavigationDataReaderBinary* Clone() const override;
+  };
+}
+
+#endif // MITKNavigationDataReaderBinary_H_HEADER_INCLUDED_
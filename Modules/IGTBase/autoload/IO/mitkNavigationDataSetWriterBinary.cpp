@@ -0,0 +1,53 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "mitkNavigationDataSetWriterBinary.h"
+#include <mitkIGTMimeTypes.h>
+#include <mitkNavigationDataStreamWriter.h>
+
+mitk::NavigationDataSetWriterBinary::NavigationDataSetWriterBinary() : AbstractFileWriter(NavigationDataSet::GetStaticNameOfClass(),
+  mitk::IGTMimeTypes::NAVIGATIONDATASETBINARY_MIMETYPE(),
+  "MITK NavigationDataSet Writer (binary)")
+{
+  RegisterService();
+}
+
+mitk::NavigationDataSetWriterBinary::~NavigationDataSetWriterBinary()
+{}
+
+mitk::NavigationDataSetWriterBinary::NavigationDataSetWriterBinary(const mitk::NavigationDataSetWriterBinary& other) : AbstractFileWriter(other)
+{
+}
+
+mitk::NavigationDataSetWriterBinary* mitk::NavigationDataSetWriterBinary::Clone() const
+{
+  return new NavigationDataSetWriterBinary(*this);
+}
+
+void mitk::NavigationDataSetWriterBinary::Write()
+{
+  mitk::NavigationDataSet::ConstPointer data = dynamic_cast<const NavigationDataSet*> (this->GetInput());
+
+  mitk::NavigationDataStreamWriter::Pointer writer = mitk::NavigationDataStreamWriter::New();
+  std::ostream* out = GetOutputStream();
+  if (out == nullptr)
+  {
+    writer->Open(GetOutputLocation());
+  }
+  else
+  {
+    writer->Open(out);
+  }
+
+  writer->AddTimeSteps(data);
+  writer->Close();
+}
@@ -0,0 +1,40 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef MITKNavigationDataSetWriterBinary_H_HEADER_INCLUDED_
+#define MITKNavigationDataSetWriterBinary_H_HEADER_INCLUDED_
+
+#include <MitkIGTIOExports.h>
+
+#include <mitkNavigationDataSet.h>
+#include <mitkAbstractFileWriter.h>
+
+namespace mitk {
+  /** Writes navigation data sets in the binary format of mitk::NavigationDataStreamWriter.
+   */
+  class MITKIGTIO_EXPORT NavigationDataSetWriterBinary : public AbstractFileWriter
+  {
+  public:
+    NavigationDataSetWriterBinary();
+    ~NavigationDataSetWriterBinary() override;
+
+    using AbstractFileWriter::Write;
+    void Write() override;
+
+  protected:
+    NavigationDataSetWriterBinary(const NavigationDataSetWriterBinary& other);
+
+    mitk::NavigationDataSetWriterBinary* Clone() const override;
+  };
+}
+
+#endif // MITKNavigationDataSetWriterBinary_H_HEADER_INCLUDED_
@@ -4,6 +4,8 @@ set(CPP_FILES
   mitkRealTimeClock.cpp
   mitkNavigationData.cpp
   mitkNavigationDataSet.cpp
+  mitkNavigationDataStreamReader.cpp
+  mitkNavigationDataStreamWriter.cpp
   mitkStaticIGTHelperFunctions.cpp
   mitkQuaternionAveraging.cpp
   mitkIGTMimeTypes.cpp
@@ -17,6 +17,10 @@ found in the LICENSE file.
 #include "mitkBaseData.h"
 #include "mitkNavigationData.h"
 
+#include <iterator>
+#include <string>
+#include <vector>
+
 namespace mitk {
   /**
   * \brief Data structure which stores streams of mitk::NavigationData for
@@ -25,26 +29,85 @@ namespace mitk {
   * Use mitk::NavigationDataRecorder to create these sets easily from pipelines.
   * Use mitk::NavigationDataPlayer to stream from these sets easily.
   *
+  * The data is not stored as mitk::NavigationData objects, but column by column for every tool:
+  * contiguous arrays of time stamps, positions, orientations and flags (valid, has position,
+  * has orientation). Covariance matrices and names rarely change during a recording, so each tool
+  * stores a table of the distinct combinations and one index per time step. All methods which
+  * return mitk::NavigationData objects create them on demand, i.e. the returned objects are copies
+  * of the stored values and changing them does not change the set.
   */
   class MITKIGTBASE_EXPORT NavigationDataSet : public BaseData
   {
   public:
 
     /**
-    * \brief This iterator iterates over the distinct time steps in this set.
+    * \brief This iterator iterates over the distinct time steps in this set. And is const.
     *
-    * It returns an array of the length equal to GetNumberOfTools(), containing a
-    * mitk::NavigationData for each tool..
+    * Dereferencing returns an array of the length equal to GetNumberOfTools(), containing a
+    * mitk::NavigationData for each tool. The array is created on demand, so use GetIndex() together with
+    * GetNavigationDataForIndex() or GetIGTTimeStampForIndex() if only single values are needed.
     */
-    typedef std::vector< std::vector<mitk::NavigationData::Pointer> >::iterator NavigationDataSetIterator;
+    class NavigationDataSetConstIterator
+    {
+    public:
+      typedef std::random_access_iterator_tag iterator_category;
+      typedef std::vector<mitk::NavigationData::Pointer> value_type;
+      typedef std::ptrdiff_t difference_type;
+      typedef const value_type* pointer;
+      typedef value_type reference;
+
+      /**
+      * \brief Holds the time step created by operator->() as long as the expression is evaluated.
+      */
+      class ArrowProxy
+      {
+      public:
+        ArrowProxy(value_type&& timeStep) : m_TimeStep(std::move(timeStep)) {}
+        const value_type* operator->() const { return &m_TimeStep; }
+      private:
+        value_type m_TimeStep;
+      };
+
+      NavigationDataSetConstIterator() : m_Set(nullptr), m_Index(0) {}
+      NavigationDataSetConstIterator(const NavigationDataSet* set, difference_type index) : m_Set(set), m_Index(index) {}
+
+      /**
+      * \brief Returns the index of the time step this iterator points to.
+      */
+      unsigned int GetIndex() const { return static_cast<unsigned int>(m_Index); }
+
+      reference operator*() const { return m_Set->GetTimeStep(this->GetIndex()); }
+      ArrowProxy operator->() const { return ArrowProxy(m_Set->GetTimeStep(this->GetIndex())); }
+      reference operator[](difference_type offset) const { return *(*this + offset); }
+
+      NavigationDataSetConstIterator& operator++() { ++m_Index; return *this; }
+      NavigationDataSetConstIterator operator++(int) { NavigationDataSetConstIterator it = *this; ++m_Index; return it; }
+      NavigationDataSetConstIterator& operator--() { --m_Index; return *this; }
+      NavigationDataSetConstIterator operator--(int) { NavigationDataSetConstIterator it = *this; --m_Index; return it; }
+      NavigationDataSetConstIterator& operator+=(difference_type offset) { m_Index += offset; return *this; }
+      NavigationDataSetConstIterator& operator-=(difference_type offset) { m_Index -= offset; return *this; }
+      NavigationDataSetConstIterator operator+(difference_type offset) const { return NavigationDataSetConstIterator(m_Set, m_Index + offset); }
+      NavigationDataSetConstIterator operator-(difference_type offset) const { return NavigationDataSetConstIterator(m_Set, m_Index - offset); }
+      difference_type operator-(const NavigationDataSetConstIterator& other) const { return m_Index - other.m_Index; }
+
+      bool operator==(const NavigationDataSetConstIterator& other) const { return m_Set == other.m_Set && m_Index == other.m_Index; }
+      bool operator!=(const NavigationDataSetConstIterator& other) const { return !(*this == other); }
+      bool operator<(const NavigationDataSetConstIterator& other) const { return m_Index < other.m_Index; }
+      bool operator>(const NavigationDataSetConstIterator& other) const { return m_Index > other.m_Index; }
+      bool operator<=(const NavigationDataSetConstIterator& other) const { return m_Index <= other.m_Index; }
+      bool operator>=(const NavigationDataSetConstIterator& other) const { return m_Index >= other.m_Index; }
+
+    private:
+      const NavigationDataSet* m_Set;
+      difference_type m_Index;
+    };
 
     /**
-    * \brief This iterator iterates over the distinct time steps in this set. And is const.
+    * \brief This iterator iterates over the distinct time steps in this set.
     *
-    * It returns an array of the length equal to GetNumberOfTools(), containing a
-    * mitk::NavigationData for each tool..
+    * The time steps are created on demand, so there is no difference to NavigationDataSetConstIterator anymore.
     */
-    typedef std::vector< std::vector<mitk::NavigationData::Pointer> >::const_iterator NavigationDataSetConstIterator;
+    typedef NavigationDataSetConstIterator NavigationDataSetIterator;
 
     mitkClassMacro(NavigationDataSet, BaseData);
 
@@ -53,21 +116,42 @@ namespace mitk {
     /**
     * \brief Add mitk::NavigationData of the given tool to the Set.
     *
+    * The values of the navigation datas are copied into the set, so the objects can be reused afterwards.
+    *
     * @param navigationDatas vector of mitk::NavigationData objects to be added. Make sure that the size of the
     * vector equals the number of tools given in the constructor
     * @return true if object was be added to the set successfully, false otherwise
     */
     bool AddNavigationDatas( std::vector<mitk::NavigationData::Pointer> navigationDatas );
 
+    /**
+    * \brief Reserves memory for the given number of time steps, e.g. before a file is read.
+    */
+    void Reserve( unsigned int numberOfTimeSteps );
+
     /**
     * \brief Get mitk::NavigationData from the given tool at given index.
     *
     * @param toolIndex Index of the tool from which mitk::NavigationData should be returned.
     * @param index Index of the mitk::NavigationData object that should be returned.
-    * @return mitk::NavigationData at the specified indices, 0 if there is no object at the indices.
+    * @return new mitk::NavigationData with the values at the specified indices, 0 if there is no object at the indices.
     */
     NavigationData::Pointer GetNavigationDataForIndex( unsigned int index, unsigned int toolIndex ) const;
 
+    /**
+    * \brief Copies the values of the given tool at given index into an existing mitk::NavigationData.
+    *
+    * This avoids the allocation of a new object, e.g. when a player updates its outputs.
+    *
+    * @return false if there is no data at the indices; the output is not changed then.
+    */
+    bool GetNavigationDataForIndex( unsigned int index, unsigned int toolIndex, NavigationData* output ) const;
+
+    /**
+    * \brief Returns the time stamp of the given tool at given index without creating a mitk::NavigationData.
+    */
+    NavigationData::TimeStampType GetIGTTimeStampForIndex( unsigned int index, unsigned int toolIndex ) const;
+
     ///**
     //* \brief Get last mitk::Navigation object for given tool whose timestamp is less than the given timestamp.
     //* @param toolIndex Index of the tool from which mitk::NavigationData should be returned.
@@ -153,12 +237,38 @@ namespace mitk {
     ~NavigationDataSet( ) override;
 
     /**
-    * \brief Holds all the mitk::NavigationData objects managed by this class.
-    *
-    * The first dimension is the index of the navigation data, the second is the
-    * tool to which this data belongs. i.e. the first dimension is usually the longer one.
+    * \brief Covariance matrix and name of a tool; stored once per distinct combination.
+    */
+    struct ToolAttributes
+    {
+      NavigationData::CovarianceMatrixType CovErrorMatrix;
+      std::string Name;
+    };
+
+    /**
+    * \brief Holds the data of one tool column by column.
+    */
+    struct ToolColumns
+    {
+      std::vector<NavigationData::TimeStampType> TimeStamps;
+      std::vector<ScalarType> Positions;    ///< x, y, z per time step
+      std::vector<ScalarType> Orientations; ///< x, y, z, r per time step
+      std::vector<unsigned char> Flags;     ///< combination of the Flag values per time step
+      std::vector<unsigned int> AttributeIndices;
+      std::vector<ToolAttributes> Attributes;
+    };
+
+    enum Flag
+    {
+      DataValid = 1,
+      HasPosition = 2,
+      HasOrientation = 4
+    };
+
+    /**
+    * \brief Holds the data of all tools; the index is the tool index.
     */
-    std::vector<std::vector<NavigationData::Pointer> > m_NavigationDataVectors;
+    std::vector<ToolColumns> m_Tools;
 
     /**
     * \brief The Number of Tools that this class is going to support.
@@ -0,0 +1,112 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef MITKNAVIGATIONDATASTREAMREADER_H_HEADER_INCLUDED_
+#define MITKNAVIGATIONDATASTREAMREADER_H_HEADER_INCLUDED_
+
+#include <MitkIGTBaseExports.h>
+#include <itkObject.h>
+#include <itkObjectFactory.h>
+#include <mitkCommon.h>
+
+#include "mitkNavigationDataSet.h"
+
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace mitk {
+  /**Documentation
+  * \brief Reads binary recordings written by mitk::NavigationDataStreamWriter.
+  *
+  * Single time steps are read directly from the file with ReadTimeStep(), so long recordings
+  * can be played without loading them completely. Read() loads the whole recording into a
+  * mitk::NavigationDataSet in large blocks.
+  *
+  * \ingroup IGT
+  */
+  class MITKIGTBASE_EXPORT NavigationDataStreamReader : public itk::Object
+  {
+  public:
+    mitkClassMacroItkParent(NavigationDataStreamReader, itk::Object);
+    itkFactorylessNewMacro(Self);
+
+    /**
+    * \brief Decodes one record written by NavigationDataStreamWriter::EncodeToolRecord() into the output.
+    * The name of the output is not changed.
+    */
+    static void DecodeToolRecord(const char* buffer, mitk::NavigationData* output);
+
+    /**
+    * \brief Opens the file and reads the header.
+    * @throw mitk::IGTIOException if the file cannot be opened or is no binary navigation data recording.
+    */
+    void Open(const std::string& fileName);
+
+    /**
+    * \brief Reads from the given stream, which has to be seekable and stay valid until Close() is called.
+    */
+    void Open(std::istream* stream);
+
+    void Close();
+
+    bool IsOpen() const;
+
+    itkGetConstMacro(NumberOfTools, unsigned int);
+    itkGetConstMacro(NumberOfTimeSteps, unsigned int);
+
+    std::string GetToolName(unsigned int toolIndex) const;
+
+    /**
+    * \brief Reads the time step at the given index into the outputs, one output per tool.
+    * @return false if there is no time step at the index or the number of outputs is wrong.
+    */
+    bool ReadTimeStep(unsigned int index, const std::vector<mitk::NavigationData::Pointer>& outputs);
+
+    /**
+    * \brief Returns the time stamp of the given tool at the given time step.
+    */
+    mitk::NavigationData::TimeStampType ReadIGTTimeStamp(unsigned int index, unsigned int toolIndex = 0);
+
+    /**
+    * \brief Returns the index of the last time step whose time stamp of the first tool is not greater than
+    * the given time stamp, or 0 if there is no such time step. Needs about log2(GetNumberOfTimeSteps()) reads.
+    */
+    unsigned int FindTimeStep(mitk::NavigationData::TimeStampType timeStamp);
+
+    /**
+    * \brief Reads all time steps into a new mitk::NavigationDataSet.
+    */
+    mitk::NavigationDataSet::Pointer Read();
+
+  protected:
+    NavigationDataStreamReader();
+    ~NavigationDataStreamReader() override;
+
+    void ReadHeader();
+    void Seek(unsigned int index, unsigned int toolIndex = 0);
+
+    std::unique_ptr<std::istream> m_FileStream;
+    std::istream* m_Stream;
+    unsigned int m_NumberOfTools;
+    unsigned int m_NumberOfTimeSteps;
+    unsigned int m_ToolRecordSize;
+    unsigned long long m_HeaderSize;
+    std::vector<std::string> m_ToolNames;
+
+    /** \brief Holds the encoded time steps, reused for every read */
+    std::vector<char> m_Buffer;
+  };
+} // namespace mitk
+
+#endif // MITKNAVIGATIONDATASTREAMREADER_H_HEADER_INCLUDED_
@@ -0,0 +1,124 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef MITKNAVIGATIONDATASTREAMWRITER_H_HEADER_INCLUDED_
+#define MITKNAVIGATIONDATASTREAMWRITER_H_HEADER_INCLUDED_
+
+#include <MitkIGTBaseExports.h>
+#include <itkObject.h>
+#include <itkObjectFactory.h>
+#include <mitkCommon.h>
+
+#include "mitkNavigationDataSet.h"
+
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace mitk {
+  /**Documentation
+  * \brief Appends time steps of mitk::NavigationData to a binary recording.
+  *
+  * The binary format is append-only and seekable, so a recording can be written while it
+  * is recorded (see mitk::NavigationDataRecorder::SetStreamFileName()) and a reader can
+  * jump to any time step without parsing the time steps before. All values are stored
+  * little endian:
+  *
+  *  - header: the magic number "MITKNDS" followed by a zero byte, then the unsigned 32 bit
+  *    integers format version, number of tools, size of one tool record and size of the whole
+  *    header, followed by the name of every tool (32 bit length and characters)
+  *  - time steps: one tool record per tool, each consisting of the time stamp, position (x, y, z),
+  *    orientation (x, y, z, r) and the diagonal of the covariance matrix as doubles and one byte
+  *    of flags (1: data valid, 2: has position, 4: has orientation)
+  *
+  * The number of time steps follows from the file size, i.e. a recording that was interrupted
+  * remains readable up to the last complete time step. The tool names are taken from the first
+  * time step. Like the CSV format, only the diagonal of the covariance matrix is stored.
+  *
+  * \ingroup IGT
+  */
+  class MITKIGTBASE_EXPORT NavigationDataStreamWriter : public itk::Object
+  {
+  public:
+    mitkClassMacroItkParent(NavigationDataStreamWriter, itk::Object);
+    itkFactorylessNewMacro(Self);
+
+    /** \brief Version of the binary format written by this class */
+    static const unsigned int FormatVersion = 1;
+
+    /** \brief Size of the data of one tool in one time step in bytes */
+    static const unsigned int ToolRecordSize = 113;
+
+    /** \brief Returns the magic number at the start of every recording (8 bytes including the zero byte) */
+    static const char* GetMagicNumber();
+
+    /**
+    * \brief Encodes one navigation data into ToolRecordSize bytes at the buffer, e.g. for other recording formats.
+    * @return position behind the record
+    */
+    static char* EncodeToolRecord(const mitk::NavigationData* navigationData, char* buffer);
+
+    /**
+    * \brief Creates the file, an existing file is overwritten.
+    * @throw mitk::IGTIOException if the file cannot be opened.
+    */
+    void Open(const std::string& fileName);
+
+    /**
+    * \brief Writes to the given stream, which has to stay valid until Close() is called.
+    */
+    void Open(std::ostream* stream);
+
+    /**
+    * \brief Appends one time step. The header is written with the first time step.
+    * @throw mitk::IGTIOException if the number of navigation datas changes or writing fails.
+    */
+    void AddTimeStep(const std::vector<mitk::NavigationData::Pointer>& navigationDatas);
+
+    /**
+    * \brief Appends all time steps of the set; writes the header even if the set is empty.
+    */
+    void AddTimeSteps(const mitk::NavigationDataSet* navigationDataSet);
+
+    /**
+    * \brief Writes buffered time steps to the file, e.g. when a recording is paused.
+    */
+    void Flush();
+
+    /**
+    * \brief Flushes and closes the file. Called by the destructor as well.
+    */
+    void Close();
+
+    bool IsOpen() const;
+
+    itkGetConstMacro(NumberOfTimeSteps, unsigned int);
+
+  protected:
+    NavigationDataStreamWriter();
+    ~NavigationDataStreamWriter() override;
+
+    void WriteHeader(const std::vector<std::string>& toolNames);
+
+    std::unique_ptr<std::ostream> m_FileStream;
+    std::ostream* m_Stream;
+    bool m_HeaderWritten;
+    unsigned int m_NumberOfTools;
+    unsigned int m_NumberOfTimeSteps;
+
+    /** \brief Holds one encoded time step, reused for every time step */
+    std::vector<char> m_Buffer;
+  };
+} // namespace mitk
+
+#endif // MITKNAVIGATIONDATASTREAMWRITER_H_HEADER_INCLUDED_
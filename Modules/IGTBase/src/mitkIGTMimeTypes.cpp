@@ -33,6 +33,16 @@ mitk::CustomMimeType mitk::IGTMimeTypes::NAVIGATIONDATASETCSV_MIMETYPE()
   return mimeType;
 }
 
+mitk::CustomMimeType mitk::IGTMimeTypes::NAVIGATIONDATASETBINARY_MIMETYPE()
+{
+  mitk::CustomMimeType mimeType(IOMimeTypes::DEFAULT_BASE_NAME() + ".NavigationDataSet.nds");
+  std::string category = "NavigationDataSet";
+  mimeType.SetComment("NavigationDataSet (binary)");
+  mimeType.SetCategory(category);
+  mimeType.AddExtension("nds");
+  return mimeType;
+}
+
 mitk::CustomMimeType mitk::IGTMimeTypes::USDEVICEINFORMATIONXML_MIMETYPE()
 {
   mitk::CustomMimeType mimeType(IOMimeTypes::DEFAULT_BASE_NAME() + ".USDeviceInformation.xml");
@@ -15,7 +15,7 @@ found in the LICENSE file.
 #include "mitkBaseRenderer.h"
 
 mitk::NavigationDataSet::NavigationDataSet( unsigned int numberOfTools )
-  : m_NavigationDataVectors(std::vector<std::vector<mitk::NavigationData::Pointer> >()), m_NumberOfTools(numberOfTools)
+  : m_Tools(numberOfTools), m_NumberOfTools(numberOfTools)
 {
 }
 
@@ -33,35 +33,110 @@ bool mitk::NavigationDataSet::AddNavigationDatas( std::vector<mitk::NavigationDa
   }
 
   // test for consistent timestamp
-  if ( m_NavigationDataVectors.size() > 0)
+  if ( this->Size() > 0)
   {
     for (std::vector<mitk::NavigationData::Pointer>::size_type i = 0; i < navigationDatas.size(); i++)
-      if (navigationDatas[i]->GetIGTTimeStamp() <= m_NavigationDataVectors.back()[i]->GetIGTTimeStamp())
+      if (navigationDatas[i]->GetIGTTimeStamp() <= m_Tools[i].TimeStamps.back())
       {
         MITK_WARN("NavigationDataSet") << "IGTTimeStamp of new NavigationData should be newer than timestamp of last NavigationData.";
         return false;
       }
   }
 
-  m_NavigationDataVectors.push_back(navigationDatas);
+  for (std::vector<mitk::NavigationData::Pointer>::size_type i = 0; i < navigationDatas.size(); i++)
+  {
+    const mitk::NavigationData* nd = navigationDatas[i];
+    ToolColumns& tool = m_Tools[i];
+
+    tool.TimeStamps.push_back(nd->GetIGTTimeStamp());
+    for (int j = 0; j < 3; ++j)
+      tool.Positions.push_back(nd->GetPosition()[j]);
+    for (int j = 0; j < 4; ++j)
+      tool.Orientations.push_back(nd->GetOrientation()[j]);
+    tool.Flags.push_back((nd->IsDataValid() ? DataValid : 0)
+      | (nd->GetHasPosition() ? HasPosition : 0)
+      | (nd->GetHasOrientation() ? HasOrientation : 0));
+
+    // covariance and name usually stay the same, so only a change adds a new entry
+    if (tool.Attributes.empty()
+      || tool.Attributes.back().CovErrorMatrix != nd->GetCovErrorMatrix()
+      || tool.Attributes.back().Name != nd->GetName())
+    {
+      ToolAttributes attributes;
+      attributes.CovErrorMatrix = nd->GetCovErrorMatrix();
+      attributes.Name = nd->GetName();
+      tool.Attributes.push_back(attributes);
+    }
+    tool.AttributeIndices.push_back(tool.Attributes.size() - 1);
+  }
+
   return true;
 }
 
+void mitk::NavigationDataSet::Reserve( unsigned int numberOfTimeSteps )
+{
+  for (auto& tool : m_Tools)
+  {
+    tool.TimeStamps.reserve(numberOfTimeSteps);
+    tool.Positions.reserve(3 * numberOfTimeSteps);
+    tool.Orientations.reserve(4 * numberOfTimeSteps);
+    tool.Flags.reserve(numberOfTimeSteps);
+    tool.AttributeIndices.reserve(numberOfTimeSteps);
+  }
+}
+
 mitk::NavigationData::Pointer mitk::NavigationDataSet::GetNavigationDataForIndex( unsigned int index, unsigned int toolIndex ) const
 {
-  if ( index >= m_NavigationDataVectors.size() )
+  mitk::NavigationData::Pointer nd = mitk::NavigationData::New();
+  if ( !this->GetNavigationDataForIndex(index, toolIndex, nd) )
+    return nullptr;
+
+  return nd;
+}
+
+bool mitk::NavigationDataSet::GetNavigationDataForIndex( unsigned int index, unsigned int toolIndex, mitk::NavigationData* output ) const
+{
+  if ( index >= this->Size() )
   {
     MITK_WARN("NavigationDataSet") << "There is no NavigationData available at index " << index << ".";
-    return nullptr;
+    return false;
   }
 
-  if ( toolIndex >= m_NavigationDataVectors.at(index).size() )
+  if ( toolIndex >= m_NumberOfTools )
   {
     MITK_WARN("NavigationDataSet") << "There is NavigatitionData available at index " << index << " for tool " << toolIndex << ".";
-    return nullptr;
+    return false;
+  }
+
+  const ToolColumns& tool = m_Tools[toolIndex];
+
+  mitk::NavigationData::PositionType position;
+  for (int j = 0; j < 3; ++j)
+    position[j] = tool.Positions[3 * index + j];
+
+  const ScalarType* orientation = &tool.Orientations[4 * index];
+  const ToolAttributes& attributes = tool.Attributes[tool.AttributeIndices[index]];
+
+  output->SetIGTTimeStamp(tool.TimeStamps[index]);
+  output->SetPosition(position);
+  output->SetOrientation(mitk::NavigationData::OrientationType(orientation[0], orientation[1], orientation[2], orientation[3]));
+  output->SetDataValid((tool.Flags[index] & DataValid) != 0);
+  output->SetHasPosition((tool.Flags[index] & HasPosition) != 0);
+  output->SetHasOrientation((tool.Flags[index] & HasOrientation) != 0);
+  output->SetCovErrorMatrix(attributes.CovErrorMatrix);
+  output->SetName(attributes.Name);
+
+  return true;
+}
+
+mitk::NavigationData::TimeStampType mitk::NavigationDataSet::GetIGTTimeStampForIndex( unsigned int index, unsigned int toolIndex ) const
+{
+  if ( index >= this->Size() || toolIndex >= m_NumberOfTools )
+  {
+    mitkThrow() << "There is no NavigationData available at index " << index << " for tool " << toolIndex << ".";
   }
 
-  return m_NavigationDataVectors.at(index).at(toolIndex);
+  return m_Tools[toolIndex].TimeStamps[index];
 }
 
 // Method not yet supported, code below compiles but delivers wrong results
@@ -104,16 +179,23 @@ std::vector< mitk::NavigationData::Pointer > mitk::NavigationDataSet::GetDataStr
   }
 
   std::vector< mitk::NavigationData::Pointer > result;
+  result.reserve(this->Size());
 
-  for(std::vector<std::vector<NavigationData::Pointer> >::size_type i = 0; i < m_NavigationDataVectors.size(); i++)
-    result.push_back(m_NavigationDataVectors[i][toolIndex]);
+  for (unsigned int i = 0; i < this->Size(); i++)
+    result.push_back(this->GetNavigationDataForIndex(i, toolIndex));
 
   return result;
 }
 
 std::vector< mitk::NavigationData::Pointer > mitk::NavigationDataSet::GetTimeStep(unsigned int index) const
 {
-  return m_NavigationDataVectors[index];
+  std::vector< mitk::NavigationData::Pointer > result;
+  result.reserve(m_NumberOfTools);
+
+  for (unsigned int toolIndex = 0; toolIndex < m_NumberOfTools; toolIndex++)
+    result.push_back(this->GetNavigationDataForIndex(index, toolIndex));
+
+  return result;
 }
 
 unsigned int mitk::NavigationDataSet::GetNumberOfTools() const
@@ -123,7 +205,7 @@ unsigned int mitk::NavigationDataSet::GetNumberOfTools() const
 
 unsigned int mitk::NavigationDataSet::Size() const
 {
-  return m_NavigationDataVectors.size();
+  return m_Tools.empty() ? 0 : m_Tools[0].TimeStamps.size();
 }
 
 // ---> methods necessary for BaseData
@@ -157,10 +239,14 @@ void mitk::NavigationDataSet::ConvertNavigationDataToPointSet() const
   {
     mitk::PointSet::Pointer _tempPointSet = mitk::PointSet::New();
     //iterate over all time steps
-    for (unsigned int time = 0; time < m_NavigationDataVectors.size(); time++)
+    const std::vector<ScalarType>& positions = m_Tools[toolIndex].Positions;
+    for (unsigned int time = 0; time < this->Size(); time++)
     {
-      _tempPointSet->InsertPoint(time,m_NavigationDataVectors[time][toolIndex]->GetPosition());
-      MITK_DEBUG << m_NavigationDataVectors[time][toolIndex]->GetPosition() << " --- " << _tempPointSet->GetPoint(time);
+      mitk::Point3D position;
+      for (int j = 0; j < 3; ++j)
+        position[j] = positions[3 * time + j];
+      _tempPointSet->InsertPoint(time, position);
+      MITK_DEBUG << position << " --- " << _tempPointSet->GetPoint(time);
     }
     mitk::DataNode::Pointer dn = mitk::DataNode::New();
     std::stringstream str;
@@ -177,10 +263,10 @@ void mitk::NavigationDataSet::ConvertNavigationDataToPointSet() const
 
 mitk::NavigationDataSet::NavigationDataSetConstIterator mitk::NavigationDataSet::Begin() const
 {
-  return m_NavigationDataVectors.cbegin();
+  return NavigationDataSetConstIterator(this, 0);
 }
 
 mitk::NavigationDataSet::NavigationDataSetConstIterator mitk::NavigationDataSet::End() const
 {
-  return m_NavigationDataVectors.cend();
+  return NavigationDataSetConstIterator(this, this->Size());
 }
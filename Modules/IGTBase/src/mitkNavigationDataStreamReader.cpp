@@ -0,0 +1,293 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "mitkNavigationDataStreamReader.h"
+#include "mitkNavigationDataStreamWriter.h"
+#include "mitkIGTIOException.h"
+
+#include <itkByteSwapper.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+  template <typename T>
+  T ReadValue(const char*& buffer)
+  {
+    T value;
+    std::memcpy(&value, buffer, sizeof(T));
+    itk::ByteSwapper<T>::SwapFromSystemToLittleEndian(&value);
+    buffer += sizeof(T);
+    return value;
+  }
+}
+
+mitk::NavigationDataStreamReader::NavigationDataStreamReader()
+  : m_Stream(nullptr), m_NumberOfTools(0), m_NumberOfTimeSteps(0), m_ToolRecordSize(0), m_HeaderSize(0)
+{
+}
+
+mitk::NavigationDataStreamReader::~NavigationDataStreamReader()
+{
+}
+
+void mitk::NavigationDataStreamReader::DecodeToolRecord(const char* buffer, mitk::NavigationData* output)
+{
+  output->SetIGTTimeStamp(ReadValue<double>(buffer));
+
+  mitk::NavigationData::PositionType position;
+  for (int i = 0; i < 3; ++i)
+    position[i] = ReadValue<double>(buffer);
+  output->SetPosition(position);
+
+  mitk::NavigationData::OrientationType orientation;
+  for (int i = 0; i < 4; ++i)
+    orientation[i] = ReadValue<double>(buffer);
+  output->SetOrientation(orientation);
+
+  mitk::NavigationData::CovarianceMatrixType covariance;
+  covariance.Fill(0.0);
+  for (int i = 0; i < 6; ++i)
+    covariance[i][i] = ReadValue<double>(buffer);
+  output->SetCovErrorMatrix(covariance);
+
+  const char flags = *buffer;
+  output->SetDataValid((flags & 1) != 0);
+  output->SetHasPosition((flags & 2) != 0);
+  output->SetHasOrientation((flags & 4) != 0);
+}
+
+void mitk::NavigationDataStreamReader::Open(const std::string& fileName)
+{
+  this->Close();
+
+  m_FileStream.reset(new std::ifstream(fileName.c_str(), std::ios::in | std::ios::binary));
+  if (!m_FileStream->good())
+  {
+    m_FileStream.reset();
+    mitkThrowException(mitk::IGTIOException) << "Cannot open file " << fileName << " for reading.";
+  }
+  this->Open(m_FileStream.get());
+}
+
+void mitk::NavigationDataStreamReader::Open(std::istream* stream)
+{
+  if (stream != m_FileStream.get())
+    this->Close();
+
+  m_Stream = stream;
+  try
+  {
+    this->ReadHeader();
+  }
+  catch (const mitk::IGTIOException&)
+  {
+    this->Close();
+    throw;
+  }
+}
+
+void mitk::NavigationDataStreamReader::ReadHeader()
+{
+  char header[8 + 4 * sizeof(uint32_t)];
+  m_Stream->seekg(0, std::ios::beg);
+  m_Stream->read(header, sizeof(header));
+  if (!m_Stream->good() || std::memcmp(header, NavigationDataStreamWriter::GetMagicNumber(), 8) != 0)
+  {
+    mitkThrowException(mitk::IGTIOException) << "The file is no binary navigation data recording.";
+  }
+
+  const char* position = header + 8;
+  unsigned int version = ReadValue<uint32_t>(position);
+  m_NumberOfTools = ReadValue<uint32_t>(position);
+  m_ToolRecordSize = ReadValue<uint32_t>(position);
+  m_HeaderSize = ReadValue<uint32_t>(position);
+
+  // later versions may only append values to the tool records
+  if (version > NavigationDataStreamWriter::FormatVersion)
+  {
+    MITK_WARN("NavigationDataStreamReader") << "The recording was written with format version " << version
+      << ", reading it as version " << NavigationDataStreamWriter::FormatVersion << ".";
+  }
+  if (m_ToolRecordSize < NavigationDataStreamWriter::ToolRecordSize || m_HeaderSize < sizeof(header))
+  {
+    mitkThrowException(mitk::IGTIOException) << "The header of the binary navigation data recording is corrupt.";
+  }
+
+  std::vector<char> names(m_HeaderSize - sizeof(header));
+  m_Stream->read(names.data(), names.size());
+  if (!m_Stream->good())
+  {
+    mitkThrowException(mitk::IGTIOException) << "The header of the binary navigation data recording is incomplete.";
+  }
+
+  m_ToolNames.clear();
+  position = names.data();
+  for (unsigned int toolIndex = 0; toolIndex < m_NumberOfTools; ++toolIndex)
+  {
+    if (position + sizeof(uint32_t) > names.data() + names.size())
+    {
+      mitkThrowException(mitk::IGTIOException) << "The tool names of the binary navigation data recording are corrupt.";
+    }
+    uint32_t length = ReadValue<uint32_t>(position);
+    if (position + length > names.data() + names.size())
+    {
+      mitkThrowException(mitk::IGTIOException) << "The tool names of the binary navigation data recording are corrupt.";
+    }
+    m_ToolNames.push_back(std::string(position, length));
+    position += length;
+  }
+
+  // the number of time steps follows from the file size; an incomplete last time step is ignored
+  m_Stream->seekg(0, std::ios::end);
+  unsigned long long dataSize = static_cast<unsigned long long>(m_Stream->tellg()) - m_HeaderSize;
+  unsigned long long timeStepSize = static_cast<unsigned long long>(m_NumberOfTools) * m_ToolRecordSize;
+  m_NumberOfTimeSteps = timeStepSize > 0 ? static_cast<unsigned int>(dataSize / timeStepSize) : 0;
+  if (timeStepSize > 0 && dataSize % timeStepSize != 0)
+  {
+    MITK_WARN("NavigationDataStreamReader") << "The last time step of the recording is incomplete and is ignored.";
+  }
+  m_Buffer.resize(timeStepSize);
+}
+
+void mitk::NavigationDataStreamReader::Close()
+{
+  m_Stream = nullptr;
+  m_FileStream.reset();
+  m_NumberOfTools = 0;
+  m_NumberOfTimeSteps = 0;
+  m_ToolNames.clear();
+}
+
+bool mitk::NavigationDataStreamReader::IsOpen() const
+{
+  return m_Stream != nullptr;
+}
+
+std::string mitk::NavigationDataStreamReader::GetToolName(unsigned int toolIndex) const
+{
+  return toolIndex < m_ToolNames.size() ? m_ToolNames[toolIndex] : std::string();
+}
+
+void mitk::NavigationDataStreamReader::Seek(unsigned int index, unsigned int toolIndex)
+{
+  m_Stream->clear();
+  m_Stream->seekg(m_HeaderSize + (static_cast<unsigned long long>(index) * m_NumberOfTools + toolIndex) * m_ToolRecordSize, std::ios::beg);
+}
+
+bool mitk::NavigationDataStreamReader::ReadTimeStep(unsigned int index, const std::vector<mitk::NavigationData::Pointer>& outputs)
+{
+  if (m_Stream == nullptr || index >= m_NumberOfTimeSteps || outputs.size() != m_NumberOfTools)
+    return false;
+
+  this->Seek(index);
+  m_Stream->read(m_Buffer.data(), m_Buffer.size());
+  if (!m_Stream->good())
+  {
+    mitkThrowException(mitk::IGTIOException) << "Reading time step " << index << " failed.";
+  }
+
+  for (unsigned int toolIndex = 0; toolIndex < m_NumberOfTools; ++toolIndex)
+  {
+    DecodeToolRecord(m_Buffer.data() + toolIndex * m_ToolRecordSize, outputs[toolIndex]);
+    outputs[toolIndex]->SetName(m_ToolNames[toolIndex]);
+  }
+  return true;
+}
+
+mitk::NavigationData::TimeStampType mitk::NavigationDataStreamReader::ReadIGTTimeStamp(unsigned int index, unsigned int toolIndex)
+{
+  if (m_Stream == nullptr || index >= m_NumberOfTimeSteps || toolIndex >= m_NumberOfTools)
+  {
+    mitkThrowException(mitk::IGTIOException) << "There is no time step " << index << " for tool " << toolIndex << ".";
+  }
+
+  char buffer[sizeof(double)];
+  this->Seek(index, toolIndex);
+  m_Stream->read(buffer, sizeof(buffer));
+  if (!m_Stream->good())
+  {
+    mitkThrowException(mitk::IGTIOException) << "Reading time step " << index << " failed.";
+  }
+
+  const char* position = buffer;
+  return ReadValue<double>(position);
+}
+
+unsigned int mitk::NavigationDataStreamReader::FindTimeStep(mitk::NavigationData::TimeStampType timeStamp)
+{
+  // time stamps increase, so search the first time step that is greater
+  unsigned int first = 0;
+  unsigned int count = m_NumberOfTimeSteps;
+  while (count > 0)
+  {
+    unsigned int step = count / 2;
+    if (this->ReadIGTTimeStamp(first + step) <= timeStamp)
+    {
+      first += step + 1;
+      count -= step + 1;
+    }
+    else
+    {
+      count = step;
+    }
+  }
+  return first > 0 ? first - 1 : 0;
+}
+
+mitk::NavigationDataSet::Pointer mitk::NavigationDataStreamReader::Read()
+{
+  if (m_Stream == nullptr)
+  {
+    mitkThrowException(mitk::IGTIOException) << "Cannot read, the reader is not open.";
+  }
+
+  mitk::NavigationDataSet::Pointer navigationDataSet = mitk::NavigationDataSet::New(m_NumberOfTools);
+  navigationDataSet->Reserve(m_NumberOfTimeSteps);
+  if (m_NumberOfTimeSteps == 0)
+    return navigationDataSet;
+
+  std::vector<mitk::NavigationData::Pointer> timeStep;
+  for (unsigned int toolIndex = 0; toolIndex < m_NumberOfTools; ++toolIndex)
+  {
+    timeStep.push_back(mitk::NavigationData::New());
+    timeStep.back()->SetName(m_ToolNames[toolIndex]);
+  }
+
+  // read blocks of about 1 MB instead of single time steps
+  const std::size_t timeStepSize = static_cast<std::size_t>(m_NumberOfTools) * m_ToolRecordSize;
+  const unsigned int timeStepsPerBlock = std::max<std::size_t>(1, (1 << 20) / timeStepSize);
+  std::vector<char> block(timeStepsPerBlock * timeStepSize);
+
+  this->Seek(0);
+  for (unsigned int index = 0; index < m_NumberOfTimeSteps; index += timeStepsPerBlock)
+  {
+    unsigned int timeSteps = std::min(timeStepsPerBlock, m_NumberOfTimeSteps - index);
+    m_Stream->read(block.data(), timeSteps * timeStepSize);
+    if (!m_Stream->good())
+    {
+      mitkThrowException(mitk::IGTIOException) << "Reading time step " << index << " failed.";
+    }
+
+    for (unsigned int step = 0; step < timeSteps; ++step)
+    {
+      for (unsigned int toolIndex = 0; toolIndex < m_NumberOfTools; ++toolIndex)
+        DecodeToolRecord(block.data() + step * timeStepSize + toolIndex * m_ToolRecordSize, timeStep[toolIndex]);
+      navigationDataSet->AddNavigationDatas(timeStep);
+    }
+  }
+
+  return navigationDataSet;
+}
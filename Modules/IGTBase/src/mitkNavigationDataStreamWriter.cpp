@@ -0,0 +1,189 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "mitkNavigationDataStreamWriter.h"
+#include "mitkIGTIOException.h"
+
+#include <itkByteSwapper.h>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+  template <typename T>
+  void WriteValue(char*& buffer, T value)
+  {
+    itk::ByteSwapper<T>::SwapFromSystemToLittleEndian(&value);
+    std::memcpy(buffer, &value, sizeof(T));
+    buffer += sizeof(T);
+  }
+}
+
+const unsigned int mitk::NavigationDataStreamWriter::FormatVersion;
+const unsigned int mitk::NavigationDataStreamWriter::ToolRecordSize;
+
+const char* mitk::NavigationDataStreamWriter::GetMagicNumber()
+{
+  return "MITKNDS";
+}
+
+char* mitk::NavigationDataStreamWriter::EncodeToolRecord(const mitk::NavigationData* navigationData, char* buffer)
+{
+  WriteValue<double>(buffer, navigationData->GetIGTTimeStamp());
+  for (int i = 0; i < 3; ++i)
+    WriteValue<double>(buffer, navigationData->GetPosition()[i]);
+  for (int i = 0; i < 4; ++i)
+    WriteValue<double>(buffer, navigationData->GetOrientation()[i]);
+  for (int i = 0; i < 6; ++i)
+    WriteValue<double>(buffer, navigationData->GetCovErrorMatrix()[i][i]);
+  *buffer++ = static_cast<char>((navigationData->IsDataValid() ? 1 : 0) | (navigationData->GetHasPosition() ? 2 : 0)
+    | (navigationData->GetHasOrientation() ? 4 : 0));
+  return buffer;
+}
+
+mitk::NavigationDataStreamWriter::NavigationDataStreamWriter()
+  : m_Stream(nullptr), m_HeaderWritten(false), m_NumberOfTools(0), m_NumberOfTimeSteps(0)
+{
+}
+
+mitk::NavigationDataStreamWriter::~NavigationDataStreamWriter()
+{
+  this->Close();
+}
+
+void mitk::NavigationDataStreamWriter::Open(const std::string& fileName)
+{
+  this->Close();
+
+  m_FileStream.reset(new std::ofstream(fileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc));
+  if (!m_FileStream->good())
+  {
+    m_FileStream.reset();
+    mitkThrowException(mitk::IGTIOException) << "Cannot open file " << fileName << " for writing.";
+  }
+  this->Open(m_FileStream.get());
+}
+
+void mitk::NavigationDataStreamWriter::Open(std::ostream* stream)
+{
+  if (stream != m_FileStream.get())
+    this->Close();
+
+  m_Stream = stream;
+  m_HeaderWritten = false;
+  m_NumberOfTools = 0;
+  m_NumberOfTimeSteps = 0;
+}
+
+void mitk::NavigationDataStreamWriter::WriteHeader(const std::vector<std::string>& toolNames)
+{
+  m_NumberOfTools = toolNames.size();
+
+  unsigned int headerSize = 8 + 4 * sizeof(uint32_t);
+  for (const auto& name : toolNames)
+    headerSize += sizeof(uint32_t) + name.size();
+
+  std::vector<char> header(headerSize, 0);
+  std::memcpy(header.data(), GetMagicNumber(), 8);
+  char* position = header.data() + 8;
+  WriteValue<uint32_t>(position, FormatVersion);
+  WriteValue<uint32_t>(position, m_NumberOfTools);
+  WriteValue<uint32_t>(position, ToolRecordSize);
+  WriteValue<uint32_t>(position, headerSize);
+  for (const auto& name : toolNames)
+  {
+    WriteValue<uint32_t>(position, name.size());
+    std::memcpy(position, name.data(), name.size());
+    position += name.size();
+  }
+
+  m_Stream->write(header.data(), header.size());
+  m_Buffer.resize(m_NumberOfTools * ToolRecordSize);
+  m_HeaderWritten = true;
+}
+
+void mitk::NavigationDataStreamWriter::AddTimeStep(const std::vector<mitk::NavigationData::Pointer>& navigationDatas)
+{
+  if (m_Stream == nullptr)
+  {
+    mitkThrowException(mitk::IGTIOException) << "Cannot add a time step, the writer is not open.";
+  }
+
+  if (!m_HeaderWritten)
+  {
+    std::vector<std::string> toolNames;
+    for (const auto& nd : navigationDatas)
+      toolNames.push_back(nd->GetName());
+    this->WriteHeader(toolNames);
+  }
+  else if (navigationDatas.size() != m_NumberOfTools)
+  {
+    mitkThrowException(mitk::IGTIOException) << "Cannot add a time step with " << navigationDatas.size()
+      << " navigation datas to a recording of " << m_NumberOfTools << " tools.";
+  }
+
+  char* position = m_Buffer.data();
+  for (const auto& nd : navigationDatas)
+    position = EncodeToolRecord(nd, position);
+
+  m_Stream->write(m_Buffer.data(), m_Buffer.size());
+  if (!m_Stream->good())
+  {
+    mitkThrowException(mitk::IGTIOException) << "Writing time step " << m_NumberOfTimeSteps << " failed.";
+  }
+  ++m_NumberOfTimeSteps;
+}
+
+void mitk::NavigationDataStreamWriter::AddTimeSteps(const mitk::NavigationDataSet* navigationDataSet)
+{
+  if (m_Stream == nullptr)
+  {
+    mitkThrowException(mitk::IGTIOException) << "Cannot add time steps, the writer is not open.";
+  }
+
+  if (!m_HeaderWritten && navigationDataSet->Size() == 0)
+  {
+    this->WriteHeader(std::vector<std::string>(navigationDataSet->GetNumberOfTools()));
+    return;
+  }
+
+  std::vector<mitk::NavigationData::Pointer> timeStep;
+  for (unsigned int toolIndex = 0; toolIndex < navigationDataSet->GetNumberOfTools(); ++toolIndex)
+    timeStep.push_back(mitk::NavigationData::New());
+
+  for (unsigned int index = 0; index < navigationDataSet->Size(); ++index)
+  {
+    for (unsigned int toolIndex = 0; toolIndex < timeStep.size(); ++toolIndex)
+      navigationDataSet->GetNavigationDataForIndex(index, toolIndex, timeStep[toolIndex]);
+    this->AddTimeStep(timeStep);
+  }
+}
+
+void mitk::NavigationDataStreamWriter::Flush()
+{
+  if (m_Stream != nullptr)
+    m_Stream->flush();
+}
+
+void mitk::NavigationDataStreamWriter::Close()
+{
+  this->Flush();
+  m_Stream = nullptr;
+  m_FileStream.reset();
+}
+
+bool mitk::NavigationDataStreamWriter::IsOpen() const
+{
+  return m_Stream != nullptr;
+}
@@ -19,6 +19,9 @@ found in the LICENSE file.
 
 #include <mitkPlanarFigureMaskGenerator.h>
 #include <mitkImageMaskGenerator.h>
+#include <mitkMultiLabelMaskGenerator.h>
+#include <mitkLabelSetImage.h>
+#include <mitkImageWriteAccessor.h>
 #include <mitkImageStatisticsConstants.h>
 
 /**
@@ -54,6 +57,8 @@ class mitkImageStatisticsCalculatorTestSuite : public mitk::TestFixture
   MITK_TEST(TestUS4DCroppedPlanarFigureTimeStep1);
   MITK_TEST(TestUS4DCroppedAllTimesteps);
   MITK_TEST(TestUS4DCropped3DMask);
+  MITK_TEST(TestUS4DCroppedMultiLabelMaskGenerator);
+  MITK_TEST(TestUS4DCroppedMultiLabelIncrementalUpdate);
   CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -84,6 +89,8 @@ public:
   void TestUS4DCroppedPlanarFigureTimeStep1();
   void TestUS4DCroppedAllTimesteps();
   void TestUS4DCropped3DMask();
+  void TestUS4DCroppedMultiLabelMaskGenerator();
+  void TestUS4DCroppedMultiLabelIncrementalUpdate();
 private:
 	mitk::Image::ConstPointer m_TestImage;
 
@@ -1026,6 +1033,183 @@ void mitkImageStatisticsCalculatorTestSuite::TestUS4DCropped3DMask()
 		expected_maxIndex);
 }
 
+void mitkImageStatisticsCalculatorTestSuite::TestUS4DCroppedMultiLabelMaskGenerator()
+{
+	MITK_INFO << std::endl << "Test US4D cropped with multi label mask generator (all labels, all timesteps):-----------------------------------------------------------------------------------";
+
+	std::string US4DCroppedFile = this->GetTestDataFilePath("ImageStatisticsTestData/US4D_cropped.nrrd");
+	m_US4DCroppedImage = mitk::IOUtil::Load<mitk::Image>(US4DCroppedFile);
+	CPPUNIT_ASSERT_MESSAGE("Failed loading US4D_cropped", m_US4DCroppedImage.IsNotNull());
+
+	std::string US4DCroppedMultilabelMaskFile = this->GetTestDataFilePath("ImageStatisticsTestData/US4D_croppedMultilabelMask.nrrd");
+	m_US4DCroppedMultilabelMask = mitk::IOUtil::Load<mitk::Image>(US4DCroppedMultilabelMaskFile);
+	CPPUNIT_ASSERT_MESSAGE("Failed loading US4D multilabel mask", m_US4DCroppedMultilabelMask.IsNotNull());
+
+	mitk::LabelSetImage::Pointer labelSetImage = mitk::LabelSetImage::New();
+	labelSetImage->InitializeByLabeledImage(m_US4DCroppedMultilabelMask);
+
+	mitk::MultiLabelMaskGenerator::Pointer multiLabelMaskGen = mitk::MultiLabelMaskGenerator::New();
+	multiLabelMaskGen->SetLabelSetImage(labelSetImage);
+	CPPUNIT_ASSERT_MESSAGE("Multi label mask generator does not select any label", !multiLabelMaskGen->GetSelectedLabels().empty());
+
+	mitk::ImageStatisticsCalculator::Pointer multiLabelCalculator = mitk::ImageStatisticsCalculator::New();
+	multiLabelCalculator->SetInputImage(m_US4DCroppedImage);
+	multiLabelCalculator->SetMask(multiLabelMaskGen.GetPointer());
+
+	//same ground truth as in TestUS4DCroppedMultilabelMaskTimeStep1
+	mitk::ImageStatisticsContainer::IndexType expected_minIndex;
+	expected_minIndex.set_size(3);
+	expected_minIndex[0] = 0;
+	expected_minIndex[1] = 0;
+	expected_minIndex[2] = 2;
+
+	mitk::ImageStatisticsContainer::IndexType expected_maxIndex;
+	expected_maxIndex.set_size(3);
+	expected_maxIndex[0] = 0;
+	expected_maxIndex[1] = 0;
+	expected_maxIndex[2] = 1;
+
+	mitk::ImageStatisticsContainer::Pointer statisticsContainer;
+	CPPUNIT_ASSERT_NO_THROW(statisticsContainer = multiLabelCalculator->GetStatistics(1));
+	VerifyStatistics(statisticsContainer->GetStatisticsForTimeStep(1),
+		4,
+		159.75,
+		159.75,
+		-0.004329226115093,
+		1.0432484564918287,
+		1292.187500000000227,
+		35.947009611371016,
+		120,
+		199,
+		163.74446555532802,
+		expected_minIndex,
+		expected_maxIndex);
+
+	//all labels and time steps have to match the time step wise computation
+	mitk::ImageMaskGenerator::Pointer imgMaskGen = mitk::ImageMaskGenerator::New();
+	imgMaskGen->SetInputImage(m_US4DCroppedImage);
+	imgMaskGen->SetImageMask(m_US4DCroppedMultilabelMask);
+
+	mitk::ImageStatisticsCalculator::Pointer referenceCalculator = mitk::ImageStatisticsCalculator::New();
+	referenceCalculator->SetInputImage(m_US4DCroppedImage);
+	referenceCalculator->SetMask(imgMaskGen.GetPointer());
+
+	for (auto label : multiLabelMaskGen->GetSelectedLabels())
+	{
+		auto reference = referenceCalculator->GetStatistics(label);
+		auto result = multiLabelCalculator->GetStatistics(label);
+
+		for (unsigned int timeStep = 0; timeStep < m_US4DCroppedImage->GetTimeSteps(); ++timeStep)
+		{
+			CPPUNIT_ASSERT_EQUAL_MESSAGE("Time steps of multi label statistics differ", reference->TimeStepExists(timeStep), result->TimeStepExists(timeStep));
+			if (!reference->TimeStepExists(timeStep))
+			{
+				continue;
+			}
+
+			auto referenceStats = reference->GetStatisticsForTimeStep(timeStep);
+			auto resultStats = result->GetStatisticsForTimeStep(timeStep);
+			for (const auto& name : { mitk::ImageStatisticsConstants::MEAN(), mitk::ImageStatisticsConstants::STANDARDDEVIATION(),
+				mitk::ImageStatisticsConstants::MINIMUM(), mitk::ImageStatisticsConstants::MAXIMUM(), mitk::ImageStatisticsConstants::MEDIAN(),
+				mitk::ImageStatisticsConstants::ENTROPY(), mitk::ImageStatisticsConstants::UNIFORMITY() })
+			{
+				CPPUNIT_ASSERT_MESSAGE("Multi label statistic differs from time step wise computation: " + name,
+					std::abs(referenceStats.GetValueConverted<mitk::ImageStatisticsContainer::RealType>(name) - resultStats.GetValueConverted<mitk::ImageStatisticsContainer::RealType>(name)) < mitk::eps);
+			}
+
+			//the quantile sketches are published by both computations
+			for (const auto& stats : { referenceStats, resultStats })
+			{
+				auto quantile25 = stats.GetValueConverted<mitk::ImageStatisticsContainer::RealType>(mitk::ImageStatisticsConstants::QUANTILE25());
+				auto quantile50 = stats.GetValueConverted<mitk::ImageStatisticsContainer::RealType>(mitk::ImageStatisticsConstants::QUANTILE50());
+				auto quantile75 = stats.GetValueConverted<mitk::ImageStatisticsContainer::RealType>(mitk::ImageStatisticsConstants::QUANTILE75());
+				CPPUNIT_ASSERT_MESSAGE("Quantiles are not ordered", quantile25 <= quantile50 && quantile50 <= quantile75);
+				CPPUNIT_ASSERT_MESSAGE("Quantiles are not within value range",
+					stats.GetValueConverted<mitk::ImageStatisticsContainer::RealType>(mitk::ImageStatisticsConstants::MINIMUM()) <= quantile25 &&
+					quantile75 <= stats.GetValueConverted<mitk::ImageStatisticsContainer::RealType>(mitk::ImageStatisticsConstants::MAXIMUM()));
+				CPPUNIT_ASSERT_MESSAGE("Interquartile range is inconsistent",
+					std::abs(quantile75 - quantile25 - stats.GetValueConverted<mitk::ImageStatisticsContainer::RealType>(mitk::ImageStatisticsConstants::INTERQUARTILERANGE())) < mitk::eps);
+			}
+		}
+	}
+}
+
+void mitkImageStatisticsCalculatorTestSuite::TestUS4DCroppedMultiLabelIncrementalUpdate()
+{
+	MITK_INFO << std::endl << "Test US4D cropped multi label statistics after editing one slice:-----------------------------------------------------------------------------------";
+
+	std::string US4DCroppedFile = this->GetTestDataFilePath("ImageStatisticsTestData/US4D_cropped.nrrd");
+	m_US4DCroppedImage = mitk::IOUtil::Load<mitk::Image>(US4DCroppedFile);
+	CPPUNIT_ASSERT_MESSAGE("Failed loading US4D_cropped", m_US4DCroppedImage.IsNotNull());
+
+	std::string US4DCroppedMultilabelMaskFile = this->GetTestDataFilePath("ImageStatisticsTestData/US4D_croppedMultilabelMask.nrrd");
+	m_US4DCroppedMultilabelMask = mitk::IOUtil::Load<mitk::Image>(US4DCroppedMultilabelMaskFile);
+	CPPUNIT_ASSERT_MESSAGE("Failed loading US4D multilabel mask", m_US4DCroppedMultilabelMask.IsNotNull());
+
+	mitk::LabelSetImage::Pointer labelSetImage = mitk::LabelSetImage::New();
+	labelSetImage->InitializeByLabeledImage(m_US4DCroppedMultilabelMask);
+
+	mitk::MultiLabelMaskGenerator::Pointer multiLabelMaskGen = mitk::MultiLabelMaskGenerator::New();
+	multiLabelMaskGen->SetLabelSetImage(labelSetImage);
+
+	mitk::ImageStatisticsCalculator::Pointer calculator = mitk::ImageStatisticsCalculator::New();
+	calculator->SetInputImage(m_US4DCroppedImage);
+	calculator->SetMask(multiLabelMaskGen.GetPointer());
+
+	const unsigned int timeSteps = m_US4DCroppedImage->GetTimeSteps();
+	const unsigned int numberOfBricks = timeSteps * m_US4DCroppedImage->GetDimension(2);
+	CPPUNIT_ASSERT_NO_THROW(calculator->GetStatistics(1));
+	CPPUNIT_ASSERT_EQUAL_MESSAGE("Initial computation has to compute all bricks", numberOfBricks, calculator->GetNumberOfRecomputedBricks());
+
+	// remove the voxel (0,0,2) of time step 1 from label 1 (it is the minimum of label 1 in this time step)
+	{
+		mitk::ImageWriteAccessor accessor(labelSetImage, labelSetImage->GetVolumeData(1));
+		auto data = static_cast<mitk::LabelSetImage::PixelType*>(accessor.GetData());
+		const auto sliceSize = labelSetImage->GetDimension(0) * labelSetImage->GetDimension(1);
+		CPPUNIT_ASSERT_EQUAL_MESSAGE("Unexpected test data", static_cast<mitk::LabelSetImage::PixelType>(1), data[2 * sliceSize]);
+		data[2 * sliceSize] = 0;
+	}
+	labelSetImage->Modified();
+
+	mitk::ImageStatisticsContainer::Pointer statisticsContainer;
+	CPPUNIT_ASSERT_NO_THROW(statisticsContainer = calculator->GetStatistics(1));
+	const unsigned int expectedRecomputedBricks = labelSetImage->GetTimeSteps() == 1 ? timeSteps : 1;
+	CPPUNIT_ASSERT_EQUAL_MESSAGE("Only the edited brick has to be recomputed", expectedRecomputedBricks, calculator->GetNumberOfRecomputedBricks());
+
+	// the incrementally updated statistics have to match a computation from scratch
+	mitk::ImageStatisticsCalculator::Pointer referenceCalculator = mitk::ImageStatisticsCalculator::New();
+	referenceCalculator->SetInputImage(m_US4DCroppedImage);
+	referenceCalculator->SetMask(multiLabelMaskGen.GetPointer());
+
+	for (auto label : multiLabelMaskGen->GetSelectedLabels())
+	{
+		auto reference = referenceCalculator->GetStatistics(label);
+		auto result = calculator->GetStatistics(label);
+
+		for (unsigned int timeStep = 0; timeStep < timeSteps; ++timeStep)
+		{
+			CPPUNIT_ASSERT_EQUAL_MESSAGE("Time steps of incrementally updated statistics differ", reference->TimeStepExists(timeStep), result->TimeStepExists(timeStep));
+			if (!reference->TimeStepExists(timeStep))
+			{
+				continue;
+			}
+
+			auto referenceStats = reference->GetStatisticsForTimeStep(timeStep);
+			auto resultStats = result->GetStatisticsForTimeStep(timeStep);
+			CPPUNIT_ASSERT_EQUAL_MESSAGE("Incrementally updated voxel count differs from computation from scratch",
+				referenceStats.GetValueConverted<mitk::ImageStatisticsContainer::VoxelCountType>(mitk::ImageStatisticsConstants::NUMBEROFVOXELS()),
+				resultStats.GetValueConverted<mitk::ImageStatisticsContainer::VoxelCountType>(mitk::ImageStatisticsConstants::NUMBEROFVOXELS()));
+			for (const auto& name : { mitk::ImageStatisticsConstants::MEAN(), mitk::ImageStatisticsConstants::STANDARDDEVIATION(),
+				mitk::ImageStatisticsConstants::MINIMUM(), mitk::ImageStatisticsConstants::MAXIMUM(), mitk::ImageStatisticsConstants::MEDIAN(),
+				mitk::ImageStatisticsConstants::ENTROPY(), mitk::ImageStatisticsConstants::UNIFORMITY() })
+			{
+				CPPUNIT_ASSERT_MESSAGE("Incrementally updated statistic differs from computation from scratch: " + name,
+					std::abs(referenceStats.GetValueConverted<mitk::ImageStatisticsContainer::RealType>(name) - resultStats.GetValueConverted<mitk::ImageStatisticsContainer::RealType>(name)) < mitk::eps);
+			}
+		}
+	}
+}
+
 mitk::PlanarPolygon::Pointer mitkImageStatisticsCalculatorTestSuite::GeneratePlanarPolygon(mitk::PlaneGeometry::Pointer geometry, std::vector <mitk::Point2D> points)
 {
 	mitk::PlanarPolygon::Pointer figure = mitk::PlanarPolygon::New();
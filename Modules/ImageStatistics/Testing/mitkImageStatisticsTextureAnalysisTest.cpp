@@ -187,6 +187,22 @@ public:
     MITK_TEST_CONDITION( calculatedUppLowerLimit && calculatedUppUpperLimit, "expected UPP: " << expectedUPP << " actual Value: " << StatisticsFilter->GetUPP() );
   }
 
+  //test that the quantile sketches accumulated by both filters match the two gray values of the test images
+  void TestofQuantileSketches(LabelStatisticsFilterType::Pointer labelStatisticsFilter, StatisticsFilterType::Pointer StatisticsFilter, double lowerQuantile, double upperQuantile)
+  {
+    const mitk::QuantileSketch* labelQuantileSketch = labelStatisticsFilter->GetQuantileSketch( 1 );
+    MITK_TEST_CONDITION_REQUIRED( labelQuantileSketch != nullptr, "Quantile sketch of label 1 exists" );
+    MITK_TEST_CONDITION( labelStatisticsFilter->GetQuantileSketch( 2 ) == nullptr, "No quantile sketch for the absent label 2" );
+    MITK_TEST_CONDITION( labelQuantileSketch->GetCount() == 1000000, "expected count: 1000000 actual Value: " << labelQuantileSketch->GetCount() );
+    MITK_TEST_CONDITION( labelQuantileSketch->GetQuantile( lowerQuantile ) == 2, "expected lower quantile: 2 actual Value: " << labelQuantileSketch->GetQuantile( lowerQuantile ) );
+    MITK_TEST_CONDITION( labelQuantileSketch->GetQuantile( upperQuantile ) == 3, "expected upper quantile: 3 actual Value: " << labelQuantileSketch->GetQuantile( upperQuantile ) );
+
+    const mitk::QuantileSketch& quantileSketch = StatisticsFilter->GetQuantileSketch();
+    MITK_TEST_CONDITION( quantileSketch.GetCount() == 1000000, "expected count: 1000000 actual Value: " << quantileSketch.GetCount() );
+    MITK_TEST_CONDITION( quantileSketch.GetQuantile( lowerQuantile ) == 2, "expected lower quantile: 2 actual Value: " << quantileSketch.GetQuantile( lowerQuantile ) );
+    MITK_TEST_CONDITION( quantileSketch.GetQuantile( upperQuantile ) == 3, "expected upper quantile: 3 actual Value: " << quantileSketch.GetQuantile( upperQuantile ) );
+  }
+
 
 };
 
@@ -226,5 +242,9 @@ int mitkImageStatisticsTextureAnalysisTest(int, char* [])
 
   testclassInstance.TestofEntropyUniformityAndUppForUnmaskedImages( mitkFilter2, 0.811278, 0.625, 0.625);
 
+  //test the quantile sketches of both filters
+  testclassInstance.TestofQuantileSketches(mitkLabelFilter, mitkFilter, 0.25, 0.75);
+  testclassInstance.TestofQuantileSketches(mitkLabelFilter2, mitkFilter2, 0.1, 0.9);
+
   MITK_TEST_END()
 }
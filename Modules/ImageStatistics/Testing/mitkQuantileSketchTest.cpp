@@ -0,0 +1,94 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <mitkQuantileSketch.h>
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+#include <algorithm>
+#include <random>
+
+class mitkQuantileSketchTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkQuantileSketchTestSuite);
+  MITK_TEST(TestEmptySketch);
+  MITK_TEST(TestExactQuantiles);
+  MITK_TEST(TestApproximateQuantiles);
+  MITK_TEST(TestMergeWithDifferentAccuracy);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void TestEmptySketch()
+  {
+    mitk::QuantileSketch sketch;
+    CPPUNIT_ASSERT_EQUAL(mitk::QuantileSketch::CountType(0), sketch.GetCount());
+    CPPUNIT_ASSERT_THROW(sketch.GetQuantile(0.5), mitk::Exception);
+  }
+
+  void TestExactQuantiles()
+  {
+    mitk::QuantileSketch sketch;
+    for (int i = 10; i >= 1; --i)
+    {
+      sketch.Add(i);
+    }
+
+    CPPUNIT_ASSERT_MESSAGE("Small sketch is not exact", sketch.IsExact());
+    CPPUNIT_ASSERT_EQUAL(1., sketch.GetQuantile(0.));
+    CPPUNIT_ASSERT_EQUAL(3., sketch.GetQuantile(0.25));
+    CPPUNIT_ASSERT_EQUAL(5., sketch.GetQuantile(0.5));
+    CPPUNIT_ASSERT_EQUAL(8., sketch.GetQuantile(0.75));
+    CPPUNIT_ASSERT_EQUAL(10., sketch.GetQuantile(1.));
+  }
+
+  void TestApproximateQuantiles()
+  {
+    std::mt19937 generator(42);
+    std::normal_distribution<double> distribution(100., 20.);
+
+    // fill several sketches (like threads or bricks would do) and merge them
+    std::vector<double> values;
+    std::vector<mitk::QuantileSketch> partialSketches(4);
+    for (unsigned int i = 0; i < 200000; ++i)
+    {
+      values.push_back(distribution(generator));
+      partialSketches[i % partialSketches.size()].Add(values.back());
+    }
+
+    mitk::QuantileSketch sketch;
+    for (const auto &partialSketch : partialSketches)
+    {
+      sketch.Merge(partialSketch);
+    }
+    std::sort(values.begin(), values.end());
+
+    CPPUNIT_ASSERT_EQUAL(mitk::QuantileSketch::CountType(values.size()), sketch.GetCount());
+    CPPUNIT_ASSERT_MESSAGE("Sketch does not bound its memory", sketch.GetNumberOfRetainedValues() < 5 * sketch.GetAccuracy());
+
+    for (const double quantile : { 0.05, 0.25, 0.5, 0.75, 0.95 })
+    {
+      const auto estimate = sketch.GetQuantile(quantile);
+      const double rank = static_cast<double>(std::lower_bound(values.begin(), values.end(), estimate) - values.begin()) / values.size();
+      CPPUNIT_ASSERT_MESSAGE("Rank error of quantile estimate exceeds bound", std::abs(rank - quantile) <= 2 * sketch.GetNormalizedRankError());
+    }
+  }
+
+  void TestMergeWithDifferentAccuracy()
+  {
+    mitk::QuantileSketch sketch(100);
+    mitk::QuantileSketch otherSketch(200);
+    otherSketch.Add(1.);
+    CPPUNIT_ASSERT_THROW(sketch.Merge(otherSketch), mitk::Exception);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkQuantileSketch)
@@ -18,6 +18,7 @@ set(CPP_FILES
   mitkStatisticsToImageRelationRule.cpp
   mitkStatisticsToMaskRelationRule.cpp
   mitkImageStatisticsConstants.cpp
+  mitkQuantileSketch.cpp
 )
 
 set(H_FILES
@@ -44,4 +45,5 @@ set(H_FILES
   mitkStatisticsToImageRelationRule.h
   mitkStatisticsToMaskRelationRule.h
   mitkImageStatisticsConstants.h
+  mitkQuantileSketch.h
 )
@@ -13,6 +13,7 @@ found in the LICENSE file.
 #define __mitkExtendedLabelStatisticsImageFilter
 
 #include "itkLabelStatisticsImageFilter.h"
+#include <mitkQuantileSketch.h>
 
 namespace itk
 {
@@ -172,6 +173,7 @@ namespace itk
         m_PositivePixelCount = l.m_PositivePixelCount;
         m_SumOfCubes = l.m_SumOfCubes;
         m_SumOfQuadruples = l.m_SumOfQuadruples;
+        m_QuantileSketch = l.m_QuantileSketch;
       }
 
       // added for completeness
@@ -200,6 +202,7 @@ namespace itk
           m_PositivePixelCount = l.m_PositivePixelCount;
           m_SumOfCubes = l.m_SumOfCubes;
           m_SumOfQuadruples = l.m_SumOfQuadruples;
+          m_QuantileSketch = l.m_QuantileSketch;
           }
         return *this;
       }
@@ -225,6 +228,7 @@ namespace itk
       RealType        m_SumOfQuadruples;
       typename Superclass::BoundingBoxType m_BoundingBox;
       typename HistogramType::Pointer m_Histogram;
+      mitk::QuantileSketch m_QuantileSketch;
     };
 
     /** Type of the map used to store data per label */
@@ -266,6 +270,9 @@ namespace itk
     /** Return the histogram for a label */
     HistogramType::Pointer GetHistogram(LabelPixelType label) const;
 
+    /** Return the quantile sketch of a label (e.g. to estimate its quartiles) or nullptr if the label does not exist. */
+    const mitk::QuantileSketch* GetQuantileSketch(LabelPixelType label) const;
+
     /*getter method for the new statistics*/
     RealType GetSkewness(LabelPixelType label) const;
     RealType GetKurtosis(LabelPixelType label) const;
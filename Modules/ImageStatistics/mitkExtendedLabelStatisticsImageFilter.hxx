@@ -408,6 +408,25 @@ namespace itk
 
 
 
+  template< typename TInputImage, typename TLabelImage >
+  const mitk::QuantileSketch*
+  ExtendedLabelStatisticsImageFilter< TInputImage, TLabelImage >
+  ::GetQuantileSketch(LabelPixelType label) const
+  {
+    StatisticsMapConstIterator mapIt;
+
+    mapIt = m_LabelStatistics.find(label);
+    if ( mapIt == m_LabelStatistics.end() )
+      {
+      // label does not exist, return a default value
+      return ITK_NULLPTR;
+      }
+    else
+      {
+      return &( *mapIt ).second.m_QuantileSketch;
+      }
+  }
+
   template< typename TInputImage, typename TLabelImage >
   void
   ExtendedLabelStatisticsImageFilter< TInputImage, TLabelImage >
@@ -474,6 +493,12 @@ namespace itk
 
     typedef typename MapType::value_type MapValueType;
 
+    // Unsigned integral labels of up to 16 bit index a table of the statistics of this thread, so only the first
+    // voxel of a label needs a lookup in the map. The map does not move its entries, thus the pointers stay valid.
+    const bool useLabelTable = NumericTraits< LabelPixelType >::is_integer && !NumericTraits< LabelPixelType >::is_signed
+                               && sizeof( LabelPixelType ) <= 2;
+    std::vector< LabelStatistics* > labelTable;
+
     // do the work
     while ( !it.IsAtEnd() )
       {
@@ -483,61 +508,80 @@ namespace itk
 
         const LabelPixelType & label = labelIt.Get();
 
-        // is the label already in this thread?
-        mapIt = m_LabelStatisticsPerThread[threadId].find(label);
-        if ( mapIt == m_LabelStatisticsPerThread[threadId].end() )
-          {
-          // if global histogram parameters are set and preferred then use them
-          if ( m_PreferGlobalHistogramParameters && m_GlobalHistogramParametersSet )
-            {
-            mapIt = m_LabelStatisticsPerThread[threadId].insert( MapValueType( label,
-                                                                               LabelStatistics(m_NumBins[0], m_LowerBound,
-                                                                                               m_UpperBound) ) ).first;
-            }
-          // if we have label histogram parameters then use them. If we encounter a label that has no parameters then use global settings if available
-          else if(!m_PreferGlobalHistogramParameters && m_LabelHistogramParametersSet)
+        LabelStatistics* labelStatsPointer = ITK_NULLPTR;
+        if ( useLabelTable && static_cast< std::size_t >( label ) < labelTable.size() )
           {
-            typename std::map<LabelPixelType, PixelType>::iterator lbIt, ubIt;
-            typename std::map<LabelPixelType, unsigned int>::iterator nbIt;
-
-            lbIt = m_LabelMin.find(label);
-            ubIt = m_LabelMax.find(label);
-            nbIt = m_LabelNBins.find(label);
+          labelStatsPointer = labelTable[static_cast< std::size_t >( label )];
+          }
 
-            // if any of the parameters is lacking for the current label but global histogram params are available, use the global parameters
-            if ((lbIt == m_LabelMin.end() || ubIt == m_LabelMax.end() || nbIt == m_LabelNBins.end()) && m_GlobalHistogramParametersSet)
+        if ( labelStatsPointer == ITK_NULLPTR )
+          {
+          // is the label already in this thread?
+          mapIt = m_LabelStatisticsPerThread[threadId].find(label);
+          if ( mapIt == m_LabelStatisticsPerThread[threadId].end() )
             {
+            // if global histogram parameters are set and preferred then use them
+            if ( m_PreferGlobalHistogramParameters && m_GlobalHistogramParametersSet )
+              {
               mapIt = m_LabelStatisticsPerThread[threadId].insert( MapValueType( label,
                                                                                  LabelStatistics(m_NumBins[0], m_LowerBound,
                                                                                                  m_UpperBound) ) ).first;
-            }
-            // if any of the parameters is lacking for the current label and global histogram params are not available, dont use histograms for this label
-            else if ((lbIt == m_LabelMin.end() || ubIt == m_LabelMax.end() || nbIt == m_LabelNBins.end()) && !m_GlobalHistogramParametersSet)
+              }
+            // if we have label histogram parameters then use them. If we encounter a label that has no parameters then use global settings if available
+            else if(!m_PreferGlobalHistogramParameters && m_LabelHistogramParametersSet)
             {
-              mapIt = m_LabelStatisticsPerThread[threadId].insert( MapValueType( label,
-                                                                                 LabelStatistics() ) ).first;
+              typename std::map<LabelPixelType, PixelType>::iterator lbIt, ubIt;
+              typename std::map<LabelPixelType, unsigned int>::iterator nbIt;
+
+              lbIt = m_LabelMin.find(label);
+              ubIt = m_LabelMax.find(label);
+              nbIt = m_LabelNBins.find(label);
+
+              // if any of the parameters is lacking for the current label but global histogram params are available, use the global parameters
+              if ((lbIt == m_LabelMin.end() || ubIt == m_LabelMax.end() || nbIt == m_LabelNBins.end()) && m_GlobalHistogramParametersSet)
+              {
+                mapIt = m_LabelStatisticsPerThread[threadId].insert( MapValueType( label,
+                                                                                   LabelStatistics(m_NumBins[0], m_LowerBound,
+                                                                                                   m_UpperBound) ) ).first;
+              }
+              // if any of the parameters is lacking for the current label and global histogram params are not available, dont use histograms for this label
+              else if ((lbIt == m_LabelMin.end() || ubIt == m_LabelMax.end() || nbIt == m_LabelNBins.end()) && !m_GlobalHistogramParametersSet)
+              {
+                mapIt = m_LabelStatisticsPerThread[threadId].insert( MapValueType( label,
+                                                                                   LabelStatistics() ) ).first;
+              }
+              // label histogram parameters are available, use them!
+              else
+              {
+                PixelType lowerBound, upperBound;
+                unsigned int nBins;
+                lowerBound = (*lbIt).second;
+                upperBound = (*ubIt).second;
+                nBins = (*nbIt).second;
+                mapIt = m_LabelStatisticsPerThread[threadId].insert( MapValueType( label,
+                                                                                   LabelStatistics(nBins, lowerBound, upperBound) ) ).first;
+              }
             }
-            // label histogram parameters are available, use them!
+            // neither global nor label specific histogram parameters are set -> don't use histograms
             else
-            {
-              PixelType lowerBound, upperBound;
-              unsigned int nBins;
-              lowerBound = (*lbIt).second;
-              upperBound = (*ubIt).second;
-              nBins = (*nbIt).second;
+              {
               mapIt = m_LabelStatisticsPerThread[threadId].insert( MapValueType( label,
-                                                                                 LabelStatistics(nBins, lowerBound, upperBound) ) ).first;
+                                                                                 LabelStatistics() ) ).first;
+              }
             }
-          }
-          // neither global nor label specific histogram parameters are set -> don't use histograms
-          else
+
+          labelStatsPointer = &( *mapIt ).second;
+          if ( useLabelTable )
             {
-            mapIt = m_LabelStatisticsPerThread[threadId].insert( MapValueType( label,
-                                                                               LabelStatistics() ) ).first;
+            if ( static_cast< std::size_t >( label ) >= labelTable.size() )
+              {
+              labelTable.resize(static_cast< std::size_t >( label ) + 1, ITK_NULLPTR);
+              }
+            labelTable[static_cast< std::size_t >( label )] = labelStatsPointer;
             }
           }
 
-        typename MapType::mapped_type &labelStats = ( *mapIt ).second;
+        typename MapType::mapped_type &labelStats = *labelStatsPointer;
 
         // update the values for this label and this thread
         if ( value < labelStats.m_Minimum )
@@ -568,6 +612,7 @@ namespace itk
         labelStats.m_Count++;
         labelStats.m_SumOfCubes += std::pow(value, 3.);
         labelStats.m_SumOfQuadruples += std::pow(value, 4.);
+        labelStats.m_QuantileSketch.Add(value);
 
         if (value > 0)
         {
@@ -644,6 +689,7 @@ namespace itk
         labelStats.m_PositivePixelCount +=  ( *threadIt ).second.m_PositivePixelCount;
         labelStats.m_SumOfCubes +=  ( *threadIt ).second.m_SumOfCubes;
         labelStats.m_SumOfQuadruples +=  ( *threadIt ).second.m_SumOfQuadruples;
+        labelStats.m_QuantileSketch.Merge(( *threadIt ).second.m_QuantileSketch);
 
         if ( labelStats.m_Minimum > ( *threadIt ).second.m_Minimum )
           {
@@ -15,6 +15,7 @@ found in the LICENSE file.
 #include "itkStatisticsImageFilter.h"
 #include <mbilog.h>
 #include <mitkLogMacros.h>
+#include <mitkQuantileSketch.h>
 
 namespace itk
 {
@@ -124,6 +125,14 @@ namespace itk
       }
 
 
+      /**
+      * \brief Return the quantile sketch of all pixels, e.g. to estimate the quartiles.
+      */
+      const mitk::QuantileSketch& GetQuantileSketch() const
+      {
+        return m_QuantileSketch;
+      }
+
     /** specify Histogram parameters  */
     void SetHistogramParameters(const int numBins, RealType lowerBound,
                                 RealType upperBound);
@@ -190,6 +199,8 @@ private:
     Array< PixelType >      m_ThreadMax;
     std::vector< HistogramPointer > m_HistogramPerThread;
     HistogramPointer        m_Histogram;
+    std::vector< mitk::QuantileSketch > m_QuantileSketchPerThread;
+    mitk::QuantileSketch    m_QuantileSketch;
     bool                    m_UseHistogram;
     bool                    m_HistogramCalculated;
     RealType                m_LowerBound, m_UpperBound;
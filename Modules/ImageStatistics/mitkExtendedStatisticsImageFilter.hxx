@@ -241,6 +241,9 @@ namespace itk
       }
     }
 
+    m_QuantileSketchPerThread.assign(numberOfThreads, mitk::QuantileSketch());
+    m_QuantileSketch.Clear();
+
     // Resize the thread temporaries
     m_Count.SetSize(numberOfThreads);
     m_SumOfSquares.SetSize(numberOfThreads);
@@ -294,6 +297,7 @@ namespace itk
     PixelType max = NumericTraits< PixelType >::NonpositiveMin();
 
     ImageScanlineConstIterator< TInputImage > it (this->GetInput(),  outputRegionForThread);
+    mitk::QuantileSketch& quantileSketch = m_QuantileSketchPerThread[threadId];
 
     // support progress methods/callbacks
     const size_t numberOfLinesToProcess = outputRegionForThread.GetNumberOfPixels() / size0;
@@ -328,6 +332,8 @@ namespace itk
           ++countOfPositivePixels;
         }
 
+        quantileSketch.Add(realValue);
+
         sum += realValue;
         sumOfSquares += ( realValue * realValue );
         sumOfCubes += std::pow(realValue, 3.);
@@ -392,6 +398,7 @@ namespace itk
       sumOfQuadruples += m_SumOfQuadruples[i];
       sumOfPositivePixels += m_ThreadSumOfPositivePixels[i];
       countOfPositivePixels += m_PositivePixelCount[i];
+      m_QuantileSketch.Merge(m_QuantileSketchPerThread[i]);
 
       if ( m_ThreadMin[i] < minimum )
         {
@@ -22,10 +22,240 @@ found in the LICENSE file.
 #include <mitkMaskUtilities.h>
 #include <mitkMinMaxImageFilterWithIndex.h>
 #include <mitkMinMaxLabelmageFilterWithIndex.h>
+#include <mitkMultiLabelMaskGenerator.h>
+#include <mitkPixelTypeMultiplex.h>
+#include <mitkImageReadAccessor.h>
+#include <mitkHistogramStatisticsCalculator.h>
+#include <mitkQuantileSketch.h>
 #include <mitkitkMaskImageFilter.h>
 
+#include <itkMultiThreader.h>
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <memory>
+
+namespace
+{
+  /** Moments, extrema and quantile sketch of the voxels of one label in one time step.*/
+  struct LabelAccumulator
+  {
+    LabelAccumulator()
+      : Count(0),
+        Sum(0.),
+        SumOfSquares(0.),
+        SumOfCubes(0.),
+        SumOfQuadruples(0.),
+        PositivePixelCount(0),
+        SumOfPositivePixels(0.),
+        Minimum(std::numeric_limits<double>::max()),
+        Maximum(std::numeric_limits<double>::lowest()),
+        MinimumOffset(0),
+        MaximumOffset(0)
+    {
+    }
+
+    void Add(double value, std::size_t offset)
+    {
+      ++Count;
+      Sum += value;
+      const double square = value * value;
+      SumOfSquares += square;
+      SumOfCubes += square * value;
+      SumOfQuadruples += square * square;
+
+      if (value > 0)
+      {
+        ++PositivePixelCount;
+        SumOfPositivePixels += value;
+      }
+
+      Quantiles.Add(value);
+
+      if (value < Minimum)
+      {
+        Minimum = value;
+        MinimumOffset = offset;
+      }
+      if (value > Maximum)
+      {
+        Maximum = value;
+        MaximumOffset = offset;
+      }
+    }
+
+    /** Ties of the extrema are resolved by the offset, so the result does not depend on the thread scheduling.*/
+    void Merge(const LabelAccumulator &other)
+    {
+      if (other.Count == 0)
+      {
+        return;
+      }
+
+      Count += other.Count;
+      Sum += other.Sum;
+      SumOfSquares += other.SumOfSquares;
+      SumOfCubes += other.SumOfCubes;
+      SumOfQuadruples += other.SumOfQuadruples;
+      PositivePixelCount += other.PositivePixelCount;
+      SumOfPositivePixels += other.SumOfPositivePixels;
+      Quantiles.Merge(other.Quantiles);
+
+      if (other.Minimum < Minimum || (other.Minimum == Minimum && other.MinimumOffset < MinimumOffset))
+      {
+        Minimum = other.Minimum;
+        MinimumOffset = other.MinimumOffset;
+      }
+      if (other.Maximum > Maximum || (other.Maximum == Maximum && other.MaximumOffset < MaximumOffset))
+      {
+        Maximum = other.Maximum;
+        MaximumOffset = other.MaximumOffset;
+      }
+    }
+
+    unsigned long Count;
+    double Sum;
+    double SumOfSquares;
+    double SumOfCubes;
+    double SumOfQuadruples;
+    unsigned long PositivePixelCount;
+    double SumOfPositivePixels;
+    double Minimum;
+    double Maximum;
+    std::size_t MinimumOffset;
+    std::size_t MaximumOffset;
+    mitk::QuantileSketch Quantiles;
+  };
+
+  /** Adds the quartiles and the interquartile range estimated by the passed sketch. The histogram based median
+   * (ImageStatisticsConstants::MEDIAN()) is not touched.*/
+  void AddQuantileStatistics(mitk::ImageStatisticsContainer::ImageStatisticsObject &statObj, const mitk::QuantileSketch &sketch)
+  {
+    const double quantile25 = sketch.GetQuantile(0.25);
+    const double quantile75 = sketch.GetQuantile(0.75);
+    statObj.AddStatistic(mitk::ImageStatisticsConstants::QUANTILE25(), quantile25);
+    statObj.AddStatistic(mitk::ImageStatisticsConstants::QUANTILE50(), sketch.GetQuantile(0.5));
+    statObj.AddStatistic(mitk::ImageStatisticsConstants::QUANTILE75(), quantile75);
+    statObj.AddStatistic(mitk::ImageStatisticsConstants::INTERQUARTILERANGE(), quantile75 - quantile25);
+  }
+
+  /** Returns the ID of the label image slice that masks the passed brick (z slice of one time step of the image).*/
+  std::size_t ComputeMaskSliceID(std::size_t brickID, std::size_t dimZ, unsigned int labelTimeSteps)
+  {
+    const std::size_t timeStep = std::min<std::size_t>(brickID / dimZ, labelTimeSteps - 1);
+    return timeStep * dimZ + brickID % dimZ;
+  }
+
+  template <typename TFunction>
+  struct ParallelForEachItemData
+  {
+    const TFunction *Function;
+    std::size_t ItemCount;
+    std::atomic<std::size_t> NextItem;
+  };
+
+  template <typename TFunction>
+  ITK_THREAD_RETURN_TYPE ParallelForEachItemCallback(void *arg)
+  {
+    auto *infoStruct = static_cast<itk::MultiThreader::ThreadInfoStruct *>(arg);
+    auto *data = static_cast<ParallelForEachItemData<TFunction> *>(infoStruct->UserData);
+    for (std::size_t item = data->NextItem++; item < data->ItemCount; item = data->NextItem++)
+    {
+      (*data->Function)(infoStruct->ThreadID, item);
+    }
+    return ITK_THREAD_RETURN_VALUE;
+  }
+
+  /** Calls func(threadID, item) for every item in [0, itemCount) with the threads of an itk::MultiThreader. The items
+   * are distributed dynamically over the threads; every thread processes its items in ascending order.
+   * numberOfThreads is limited by the item count; threadID is always smaller than the passed numberOfThreads.*/
+  template <typename TFunction>
+  void ParallelForEachItem(unsigned int numberOfThreads, std::size_t itemCount, const TFunction &func)
+  {
+    if (itemCount == 0)
+    {
+      return;
+    }
+
+    ParallelForEachItemData<TFunction> data;
+    data.Function = &func;
+    data.ItemCount = itemCount;
+    data.NextItem = 0;
+
+    itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+    threader->SetNumberOfThreads(static_cast<itk::ThreadIdType>(std::max<std::size_t>(1, std::min<std::size_t>(numberOfThreads, itemCount))));
+    threader->SetSingleMethod(ParallelForEachItemCallback<TFunction>, &data);
+    threader->SingleMethodExecute();
+  }
+}
+
 namespace mitk
 {
+  /** Partial aggregates of the last multi label computation. A brick is one z slice of one time step; its
+   * aggregates stay valid as long as the image is not modified and the slice of the label image is unchanged.*/
+  struct ImageStatisticsCalculator::MultiLabelBrickCache
+  {
+    struct HistogramParameters
+    {
+      HistogramParameters() : NBins(0), Minimum(0.), Maximum(0.) {}
+
+      bool operator==(const HistogramParameters &other) const
+      {
+        return NBins == other.NBins && Minimum == other.Minimum && Maximum == other.Maximum;
+      }
+
+      unsigned int NBins;
+      double Minimum;
+      double Maximum;
+    };
+
+    struct Brick
+    {
+      Brick() : MaskHash(0), IsValid(false) {}
+
+      std::uint64_t MaskHash;
+      bool IsValid;
+      /** Slots of the labels present in the brick; the following vectors are parallel to it.*/
+      std::vector<unsigned int> Labels;
+      std::vector<LabelAccumulator> Accumulators;
+      /** Parameters of the histograms the frequencies were binned for.*/
+      std::vector<HistogramParameters> BinningParameters;
+      std::vector<std::vector<unsigned long>> Frequencies;
+    };
+
+    MultiLabelBrickCache() : InputImage(nullptr), ImageMTime(0), LabelImage(nullptr), DimZ(0), SliceSize(0), TimeSteps(0) {}
+
+    const mitk::Image *InputImage;
+    itk::ModifiedTimeType ImageMTime;
+    const mitk::Image *LabelImage;
+    MultiLabelMaskGenerator::LabelVectorType Labels;
+    std::size_t DimZ;
+    std::size_t SliceSize;
+    unsigned int TimeSteps;
+    std::vector<Brick> Bricks;
+  };
+
+  ImageStatisticsCalculator::ImageStatisticsCalculator()
+    : m_nBinsForHistogramStatistics(100),
+      m_binSizeForHistogramStatistics(10),
+      m_UseBinSizeOverNBins(false),
+      m_NumberOfRecomputedBricks(0)
+  {
+  }
+
+  ImageStatisticsCalculator::~ImageStatisticsCalculator()
+  {
+  }
+
+  unsigned int ImageStatisticsCalculator::GetNumberOfRecomputedBricks() const
+  {
+    return m_NumberOfRecomputedBricks;
+  }
+
   void ImageStatisticsCalculator::SetInputImage(const mitk::Image *image)
   {
     if (image != m_Image)
@@ -102,7 +332,7 @@ namespace mitk
       mitkThrow() << "Image not initialized!";
     }
 
-    if (IsUpdateRequired(label))
+    if (IsUpdateRequired(label) && !this->CalculateMultiLabelStatistics())
     {
       auto timeGeometry = m_Image->GetTimeGeometry();
       // always compute statistics on all timesteps
@@ -274,12 +504,418 @@ namespace mitk
     statObj.AddStatistic(mitk::ImageStatisticsConstants::MPP(), statisticsFilter->GetMPP());
     statObj.AddStatistic(mitk::ImageStatisticsConstants::ENTROPY(), statisticsFilter->GetEntropy());
     statObj.AddStatistic(mitk::ImageStatisticsConstants::MEDIAN(), statisticsFilter->GetMedian());
+
+    AddQuantileStatistics(statObj, statisticsFilter->GetQuantileSketch());
+
     statObj.AddStatistic(mitk::ImageStatisticsConstants::UNIFORMITY(), statisticsFilter->GetUniformity());
     statObj.AddStatistic(mitk::ImageStatisticsConstants::UPP(), statisticsFilter->GetUPP());
     statObj.m_Histogram = statisticsFilter->GetHistogram().GetPointer();
     statisticContainerForImage->SetStatisticsForTimeStep(timeStep, statObj);
   }
 
+  bool ImageStatisticsCalculator::CalculateMultiLabelStatistics()
+  {
+    auto maskGenerator = dynamic_cast<const MultiLabelMaskGenerator *>(m_MaskGenerator.GetPointer());
+    if (nullptr == maskGenerator || m_SecondaryMaskGenerator.IsNotNull())
+    {
+      return false;
+    }
+
+    if (nullptr == maskGenerator->GetLabelSetImage())
+    {
+      mitkThrow() << "Cannot compute multi label statistics. Label set image of mask generator is not set.";
+    }
+
+    if (maskGenerator->GetLayer() >= maskGenerator->GetLabelSetImage()->GetNumberOfLayers())
+    {
+      mitkThrow() << "Cannot compute multi label statistics. Invalid layer: " << maskGenerator->GetLayer();
+    }
+
+    const Image *labelImage = maskGenerator->GetLabelImage();
+    if (nullptr == labelImage || labelImage->GetPixelType().GetComponentType() != itk::ImageIOBase::USHORT ||
+        m_Image->GetPixelType().GetNumberOfComponents() != 1 || m_Image->GetDimension() > 4)
+    {
+      return false;
+    }
+
+    // the single pass works directly on the buffers, thus the label image has to cover exactly the image grid
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+      if (m_Image->GetDimension(i) != labelImage->GetDimension(i))
+      {
+        return false;
+      }
+    }
+
+    if (!mitk::Equal(*(m_Image->GetGeometry()), *(labelImage->GetGeometry()), 0.001, false))
+    {
+      return false;
+    }
+
+    m_InternalImageForStatistics = m_Image;
+    mitkPixelTypeMultiplex1(InternalCalculateMultiLabelStatistics, m_Image->GetPixelType(), maskGenerator);
+    return true;
+  }
+
+  template <typename TPixel>
+  void ImageStatisticsCalculator::InternalCalculateMultiLabelStatistics(const PixelType &,
+                                                                        const MultiLabelMaskGenerator *maskGenerator)
+  {
+    typedef MultiLabelMaskGenerator::LabelPixelType LabelPixelType;
+    typedef MultiLabelBrickCache::Brick BrickType;
+
+    const auto labels = maskGenerator->GetSelectedLabels();
+    const Image *labelImage = maskGenerator->GetLabelImage();
+
+    const std::size_t dimX = m_Image->GetDimension(0);
+    const std::size_t dimY = m_Image->GetDimension(1);
+    const std::size_t dimZ = m_Image->GetDimension(2);
+    const std::size_t sliceSize = dimX * dimY;
+    const unsigned int timeSteps = m_Image->GetTimeSteps();
+    const unsigned int labelTimeSteps = labelImage->GetTimeSteps();
+    const std::size_t labelCount = labels.size();
+
+    std::vector<int> labelSlots(static_cast<std::size_t>(std::numeric_limits<LabelPixelType>::max()) + 1, -1);
+    for (std::size_t i = 0; i < labelCount; ++i)
+    {
+      labelSlots[labels[i]] = static_cast<int>(i);
+    }
+
+    // access the volumes of all time steps directly (no time selection, no copies)
+    std::vector<std::unique_ptr<ImageReadAccessor>> accessors;
+    std::vector<const TPixel *> imageData;
+    std::vector<const LabelPixelType *> labelData;
+    for (unsigned int t = 0; t < timeSteps; ++t)
+    {
+      accessors.emplace_back(new ImageReadAccessor(m_Image, m_Image->GetVolumeData(t)));
+      imageData.push_back(static_cast<const TPixel *>(accessors.back()->GetData()));
+    }
+    for (unsigned int t = 0; t < labelTimeSteps; ++t)
+    {
+      accessors.emplace_back(new ImageReadAccessor(labelImage, labelImage->GetVolumeData(t)));
+      labelData.push_back(static_cast<const LabelPixelType *>(accessors.back()->GetData()));
+    }
+
+    const unsigned int numberOfThreads = std::max(1u, itk::MultiThreader::GetGlobalDefaultNumberOfThreads());
+
+    // the bricks of the last computation can only be reused if nothing but the content of the label image changed
+    auto &cache = m_MultiLabelBrickCache;
+    if (cache == nullptr || cache->InputImage != m_Image.GetPointer() || cache->ImageMTime != m_Image->GetMTime() ||
+        cache->LabelImage != labelImage || cache->Labels != labels || cache->DimZ != dimZ ||
+        cache->SliceSize != sliceSize || cache->TimeSteps != timeSteps)
+    {
+      cache.reset(new MultiLabelBrickCache);
+      cache->InputImage = m_Image.GetPointer();
+      cache->ImageMTime = m_Image->GetMTime();
+      cache->LabelImage = labelImage;
+      cache->Labels = labels;
+      cache->DimZ = dimZ;
+      cache->SliceSize = sliceSize;
+      cache->TimeSteps = timeSteps;
+      cache->Bricks.resize(timeSteps * dimZ);
+    }
+
+    // 1) fingerprint and bounding box of the selected labels for every slice of the label image
+    struct MaskSliceInfo
+    {
+      std::uint64_t Hash;
+      std::size_t Bounds[4];
+    };
+    std::vector<MaskSliceInfo> maskSlices(labelTimeSteps * dimZ);
+    ParallelForEachItem(numberOfThreads, maskSlices.size(), [&](unsigned int, std::size_t item) {
+      const LabelPixelType *slice = labelData[item / dimZ] + (item % dimZ) * sliceSize;
+      auto &info = maskSlices[item];
+      info.Hash = 14695981039346656037ULL; // FNV-1a
+      info.Bounds[0] = dimX;
+      info.Bounds[1] = 0;
+      info.Bounds[2] = dimY;
+      info.Bounds[3] = 0;
+      for (std::size_t y = 0; y < dimY; ++y)
+      {
+        for (std::size_t x = 0; x < dimX; ++x)
+        {
+          const LabelPixelType value = slice[y * dimX + x];
+          info.Hash = (info.Hash ^ value) * 1099511628211ULL;
+          if (labelSlots[value] >= 0)
+          {
+            info.Bounds[0] = std::min(info.Bounds[0], x);
+            info.Bounds[1] = std::max(info.Bounds[1], x);
+            info.Bounds[2] = std::min(info.Bounds[2], y);
+            info.Bounds[3] = std::max(info.Bounds[3], y);
+          }
+        }
+      }
+    });
+
+    // 2) recompute the moments and extrema of all bricks whose mask slice changed
+    std::vector<std::size_t> dirtyBricks;
+    for (std::size_t brickID = 0; brickID < cache->Bricks.size(); ++brickID)
+    {
+      const auto &brick = cache->Bricks[brickID];
+      const auto &maskSlice = maskSlices[ComputeMaskSliceID(brickID, dimZ, labelTimeSteps)];
+      if (!brick.IsValid || brick.MaskHash != maskSlice.Hash)
+      {
+        dirtyBricks.push_back(brickID);
+      }
+    }
+    m_NumberOfRecomputedBricks = static_cast<unsigned int>(dirtyBricks.size());
+
+    std::vector<std::vector<LabelAccumulator>> threadAccumulators(numberOfThreads,
+                                                                 std::vector<LabelAccumulator>(labelCount));
+    ParallelForEachItem(numberOfThreads, dirtyBricks.size(), [&](unsigned int threadID, std::size_t item) {
+      const std::size_t brickID = dirtyBricks[item];
+      const std::size_t t = brickID / dimZ;
+      const std::size_t z = brickID % dimZ;
+      const auto &maskSlice = maskSlices[ComputeMaskSliceID(brickID, dimZ, labelTimeSteps)];
+      const TPixel *values = imageData[t];
+      const LabelPixelType *mask = labelData[std::min<std::size_t>(t, labelTimeSteps - 1)];
+      auto &accumulators = threadAccumulators[threadID];
+
+      for (std::size_t y = maskSlice.Bounds[2]; y <= maskSlice.Bounds[3]; ++y)
+      {
+        const std::size_t lineOffset = z * sliceSize + y * dimX;
+        for (std::size_t x = maskSlice.Bounds[0]; x <= maskSlice.Bounds[1]; ++x)
+        {
+          const int slot = labelSlots[mask[lineOffset + x]];
+          if (slot >= 0)
+          {
+            accumulators[slot].Add(static_cast<double>(values[lineOffset + x]), lineOffset + x);
+          }
+        }
+      }
+
+      BrickType &brick = cache->Bricks[brickID];
+      brick = BrickType();
+      for (std::size_t slot = 0; slot < labelCount; ++slot)
+      {
+        if (accumulators[slot].Count > 0)
+        {
+          brick.Labels.push_back(static_cast<unsigned int>(slot));
+          brick.Accumulators.push_back(std::move(accumulators[slot]));
+          accumulators[slot] = LabelAccumulator();
+        }
+      }
+      brick.MaskHash = maskSlice.Hash;
+      brick.IsValid = true;
+    });
+    threadAccumulators.clear();
+
+    std::vector<LabelAccumulator> accumulators(timeSteps * labelCount);
+    for (std::size_t brickID = 0; brickID < cache->Bricks.size(); ++brickID)
+    {
+      const auto &brick = cache->Bricks[brickID];
+      const std::size_t t = brickID / dimZ;
+      for (std::size_t i = 0; i < brick.Labels.size(); ++i)
+      {
+        accumulators[t * labelCount + brick.Labels[i]].Merge(brick.Accumulators[i]);
+      }
+    }
+
+    // 3) histograms. The bin ranges depend on the extrema of each label, therefore the bin frequencies of a brick
+    // have to be recomputed if the extrema of one of its labels changed.
+    std::vector<HistogramType::Pointer> histograms(accumulators.size());
+    std::vector<MultiLabelBrickCache::HistogramParameters> histogramParameters(accumulators.size());
+    for (std::size_t i = 0; i < accumulators.size(); ++i)
+    {
+      const auto &acc = accumulators[i];
+      if (acc.Count == 0)
+      {
+        continue;
+      }
+
+      unsigned int nBinsForHistogram;
+      if (m_UseBinSizeOverNBins)
+      {
+        nBinsForHistogram = std::max(static_cast<double>(std::ceil(acc.Maximum - acc.Minimum)) /
+                                       m_binSizeForHistogramStatistics,
+                                     10.); // do not allow less than 10 bins
+      }
+      else
+      {
+        nBinsForHistogram = m_nBinsForHistogramStatistics;
+      }
+
+      histogramParameters[i].NBins = nBinsForHistogram;
+      histogramParameters[i].Minimum = acc.Minimum;
+      histogramParameters[i].Maximum = acc.Maximum;
+
+      HistogramType::SizeType size(1);
+      HistogramType::MeasurementVectorType lowerBound(1);
+      HistogramType::MeasurementVectorType upperBound(1);
+      size[0] = nBinsForHistogram;
+      lowerBound[0] = acc.Minimum;
+      upperBound[0] = acc.Maximum;
+
+      histograms[i] = HistogramType::New();
+      histograms[i]->SetMeasurementVectorSize(1);
+      histograms[i]->Initialize(size, lowerBound, upperBound);
+    }
+
+    std::vector<std::size_t> histogramBricks;
+    for (std::size_t brickID = 0; brickID < cache->Bricks.size(); ++brickID)
+    {
+      const auto &brick = cache->Bricks[brickID];
+      const std::size_t t = brickID / dimZ;
+      bool isUpToDate = brick.BinningParameters.size() == brick.Labels.size();
+      for (std::size_t i = 0; isUpToDate && i < brick.Labels.size(); ++i)
+      {
+        isUpToDate = brick.BinningParameters[i] == histogramParameters[t * labelCount + brick.Labels[i]];
+      }
+
+      if (!isUpToDate)
+      {
+        histogramBricks.push_back(brickID);
+      }
+    }
+
+    ParallelForEachItem(numberOfThreads, histogramBricks.size(), [&](unsigned int, std::size_t item) {
+      const std::size_t brickID = histogramBricks[item];
+      const std::size_t t = brickID / dimZ;
+      const std::size_t z = brickID % dimZ;
+      const auto &maskSlice = maskSlices[ComputeMaskSliceID(brickID, dimZ, labelTimeSteps)];
+      const TPixel *values = imageData[t];
+      const LabelPixelType *mask = labelData[std::min<std::size_t>(t, labelTimeSteps - 1)];
+      BrickType &brick = cache->Bricks[brickID];
+
+      std::vector<int> brickSlots(labelCount, -1);
+      brick.BinningParameters.resize(brick.Labels.size());
+      brick.Frequencies.resize(brick.Labels.size());
+      for (std::size_t i = 0; i < brick.Labels.size(); ++i)
+      {
+        const std::size_t histogramID = t * labelCount + brick.Labels[i];
+        brickSlots[brick.Labels[i]] = static_cast<int>(i);
+        brick.BinningParameters[i] = histogramParameters[histogramID];
+        brick.Frequencies[i].assign(histograms[histogramID]->Size(), 0);
+      }
+
+      HistogramType::MeasurementVectorType measurement(1);
+      HistogramType::IndexType histogramIndex(1);
+
+      for (std::size_t y = maskSlice.Bounds[2]; y <= maskSlice.Bounds[3]; ++y)
+      {
+        const std::size_t lineOffset = z * sliceSize + y * dimX;
+        for (std::size_t x = maskSlice.Bounds[0]; x <= maskSlice.Bounds[1]; ++x)
+        {
+          const int slot = labelSlots[mask[lineOffset + x]];
+          if (slot < 0)
+          {
+            continue;
+          }
+
+          const HistogramType *histogram = histograms[t * labelCount + slot].GetPointer();
+          measurement[0] = static_cast<double>(values[lineOffset + x]);
+          if (histogram->GetIndex(measurement, histogramIndex))
+          {
+            ++brick.Frequencies[brickSlots[slot]][histogram->GetInstanceIdentifier(histogramIndex)];
+          }
+        }
+      }
+    });
+
+    for (std::size_t brickID = 0; brickID < cache->Bricks.size(); ++brickID)
+    {
+      const auto &brick = cache->Bricks[brickID];
+      const std::size_t t = brickID / dimZ;
+      for (std::size_t i = 0; i < brick.Labels.size(); ++i)
+      {
+        auto &histogram = histograms[t * labelCount + brick.Labels[i]];
+        for (std::size_t bin = 0; bin < brick.Frequencies[i].size(); ++bin)
+        {
+          histogram->IncreaseFrequency(bin, brick.Frequencies[i][bin]);
+        }
+      }
+    }
+
+    // 4) one statistics container per label
+    double voxelVolume = 1.;
+    const auto spacing = m_Image->GetGeometry()->GetSpacing();
+    for (unsigned int i = 0; i < std::min(m_Image->GetDimension(), 3u); ++i)
+    {
+      voxelVolume *= spacing[i];
+    }
+
+    auto timeGeometry = m_Image->GetTimeGeometry();
+    auto offsetToIndex = [dimX, sliceSize](std::size_t offset) {
+      vnl_vector<int> index(3);
+      index[0] = static_cast<int>(offset % dimX);
+      index[1] = static_cast<int>((offset % sliceSize) / dimX);
+      index[2] = static_cast<int>(offset / sliceSize);
+      return index;
+    };
+
+    for (std::size_t slot = 0; slot < labelCount; ++slot)
+    {
+      ImageStatisticsContainer::Pointer statisticContainerForLabelImage;
+
+      for (unsigned int t = 0; t < timeSteps; ++t)
+      {
+        const auto &acc = accumulators[t * labelCount + slot];
+        if (acc.Count == 0)
+        {
+          continue;
+        }
+
+        if (statisticContainerForLabelImage.IsNull())
+        {
+          statisticContainerForLabelImage = ImageStatisticsContainer::New();
+          statisticContainerForLabelImage->SetTimeGeometry(const_cast<mitk::TimeGeometry *>(timeGeometry));
+        }
+
+        const double count = static_cast<double>(acc.Count);
+        const double mean = acc.Sum / count;
+        const double variance = (acc.SumOfSquares - acc.Sum * acc.Sum / count) / count;
+        const double secondMoment = acc.SumOfSquares / count;
+        const double thirdMoment = acc.SumOfCubes / count;
+        const double fourthMoment = acc.SumOfQuadruples / count;
+        const double skewness = (thirdMoment - 3. * secondMoment * mean + 2. * std::pow(mean, 3.)) /
+                                std::pow(secondMoment - std::pow(mean, 2.), 1.5);
+        const double kurtosis = (fourthMoment - 4. * thirdMoment * mean + 6. * secondMoment * std::pow(mean, 2.) -
+                                 3. * std::pow(mean, 4.)) /
+                                std::pow(secondMoment - std::pow(mean, 2.), 2.);
+        const double sigma = std::sqrt(variance);
+
+        HistogramStatisticsCalculator histStatCalc;
+        histStatCalc.SetHistogram(histograms[t * labelCount + slot]);
+        histStatCalc.CalculateStatistics();
+
+        ImageStatisticsContainer::ImageStatisticsObject statObj;
+        statObj.AddStatistic(mitk::ImageStatisticsConstants::MINIMUMPOSITION(), offsetToIndex(acc.MinimumOffset));
+        statObj.AddStatistic(mitk::ImageStatisticsConstants::MAXIMUMPOSITION(), offsetToIndex(acc.MaximumOffset));
+        statObj.AddStatistic(mitk::ImageStatisticsConstants::NUMBEROFVOXELS(),
+                             static_cast<ImageStatisticsContainer::VoxelCountType>(acc.Count));
+        statObj.AddStatistic(mitk::ImageStatisticsConstants::VOLUME(), count * voxelVolume);
+        statObj.AddStatistic(mitk::ImageStatisticsConstants::MEAN(), mean);
+        statObj.AddStatistic(mitk::ImageStatisticsConstants::MINIMUM(), acc.Minimum);
+        statObj.AddStatistic(mitk::ImageStatisticsConstants::MAXIMUM(), acc.Maximum);
+        statObj.AddStatistic(mitk::ImageStatisticsConstants::STANDARDDEVIATION(), sigma);
+        statObj.AddStatistic(mitk::ImageStatisticsConstants::VARIANCE(), sigma * sigma);
+        statObj.AddStatistic(mitk::ImageStatisticsConstants::SKEWNESS(), skewness);
+        statObj.AddStatistic(mitk::ImageStatisticsConstants::KURTOSIS(), kurtosis);
+        statObj.AddStatistic(mitk::ImageStatisticsConstants::RMS(), std::sqrt(mean * mean + variance));
+        statObj.AddStatistic(mitk::ImageStatisticsConstants::MPP(),
+                             acc.SumOfPositivePixels / static_cast<double>(acc.PositivePixelCount));
+        statObj.AddStatistic(mitk::ImageStatisticsConstants::ENTROPY(), histStatCalc.GetEntropy());
+        statObj.AddStatistic(mitk::ImageStatisticsConstants::MEDIAN(), histStatCalc.GetMedian());
+        AddQuantileStatistics(statObj, acc.Quantiles);
+        statObj.AddStatistic(mitk::ImageStatisticsConstants::UNIFORMITY(), histStatCalc.GetUniformity());
+        statObj.AddStatistic(mitk::ImageStatisticsConstants::UPP(), histStatCalc.GetUPP());
+        statObj.m_Histogram = histograms[t * labelCount + slot].GetPointer();
+
+        statisticContainerForLabelImage->SetStatisticsForTimeStep(t, statObj);
+      }
+
+      if (statisticContainerForLabelImage.IsNotNull())
+      {
+        // containers are replaced instead of reset, SetStatisticsForTimeStep() does not overwrite existing time steps
+        m_StatisticContainers[labels[slot]] = statisticContainerForLabelImage;
+      }
+      else
+      {
+        m_StatisticContainers.erase(labels[slot]);
+      }
+    }
+  }
+
   template <typename TPixel, unsigned int VImageDimension>
   double ImageStatisticsCalculator::GetVoxelVolume(typename itk::Image<TPixel, VImageDimension> *image) const
   {
@@ -490,6 +1126,11 @@ namespace mitk
       statObj.AddStatistic(mitk::ImageStatisticsConstants::MPP(), imageStatisticsFilter->GetMPP(*it));
       statObj.AddStatistic(mitk::ImageStatisticsConstants::ENTROPY(), imageStatisticsFilter->GetEntropy(*it));
       statObj.AddStatistic(mitk::ImageStatisticsConstants::MEDIAN(), imageStatisticsFilter->GetMedian(*it));
+      const mitk::QuantileSketch *quantileSketch = imageStatisticsFilter->GetQuantileSketch(static_cast<LabelPixelType>(*it));
+      if (nullptr != quantileSketch)
+      {
+        AddQuantileStatistics(statObj, *quantileSketch);
+      }
       statObj.AddStatistic(mitk::ImageStatisticsConstants::UNIFORMITY(), imageStatisticsFilter->GetUniformity(*it));
       statObj.AddStatistic(mitk::ImageStatisticsConstants::UPP(), imageStatisticsFilter->GetUPP(*it));
       statObj.m_Histogram = imageStatisticsFilter->GetHistogram(*it).GetPointer();
@@ -18,8 +18,12 @@ found in the LICENSE file.
 #include <mitkMaskGenerator.h>
 #include <mitkImageStatisticsContainer.h>
 
+#include <memory>
+
 namespace mitk
 {
+    class MultiLabelMaskGenerator;
+
     class MITKIMAGESTATISTICS_EXPORT ImageStatisticsCalculator: public itk::Object
     {
     public:
@@ -73,15 +77,24 @@ namespace mitk
         /**Documentation
         @brief Returns the statistics for label @a label. If these requested statistics are not computed yet the computation is done as well.
         For performance reasons, statistics for all labels in the image are computed at once.
+        If the mask is a MultiLabelMaskGenerator (and no secondary mask is set), the statistics of all selected labels and all
+        time steps are computed in one multi-threaded traversal of the bounding box of the labels.
+        The median is always taken from the histogram. Additionally all computations estimate the quartiles (Quantile25,
+        Quantile50, Quantile75) and the interquartile range by a mergeable quantile sketch (see QuantileSketch), which does
+        not depend on the bin count of the histogram.
          */
         ImageStatisticsContainer* GetStatistics(LabelIndex label=1);
 
+        /**Documentation
+        @brief Returns the number of bricks (z slices of one time step) whose partial aggregates were recomputed by the last
+        multi label computation (see GetStatistics()). The aggregates of all other bricks were reused, because the image
+        and the respective slices of the label image were unchanged. Thus editing a few slices of a segmentation only
+        requires the recomputation of these slices.*/
+        unsigned int GetNumberOfRecomputedBricks() const;
+
     protected:
-        ImageStatisticsCalculator(){
-            m_nBinsForHistogramStatistics = 100;
-            m_binSizeForHistogramStatistics = 10;
-            m_UseBinSizeOverNBins = false;
-        };
+        ImageStatisticsCalculator();
+        ~ImageStatisticsCalculator() override;
 
 
     private:
@@ -93,6 +106,13 @@ namespace mitk
                 typename itk::Image< TPixel, VImageDimension >* image, const TimeGeometry* timeGeometry,
                 unsigned int timeStep);
 
+        /** Computes the statistics of all labels and time steps of a MultiLabelMaskGenerator at once.
+        @return false if the image/mask combination is not supported by this path; statistics have to be computed time step wise then.*/
+        bool CalculateMultiLabelStatistics();
+
+        template < typename TPixel > void InternalCalculateMultiLabelStatistics(
+                const PixelType& pixelType, const MultiLabelMaskGenerator* maskGenerator);
+
         template < typename TPixel, unsigned int VImageDimension >
         double GetVoxelVolume(typename itk::Image<TPixel, VImageDimension>* image) const;
 
@@ -113,6 +133,10 @@ namespace mitk
         bool m_UseBinSizeOverNBins;
 
         std::map<LabelIndex,ImageStatisticsContainer::Pointer> m_StatisticContainers;
+
+        struct MultiLabelBrickCache;
+        std::unique_ptr<MultiLabelBrickCache> m_MultiLabelBrickCache;
+        unsigned int m_NumberOfRecomputedBricks;
     };
 
 }
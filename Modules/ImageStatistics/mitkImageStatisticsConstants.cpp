@@ -63,3 +63,15 @@ const std::string mitk::ImageStatisticsConstants::MPP() {
 const std::string mitk::ImageStatisticsConstants::UPP() {
   return "UPP";
 }
+const std::string mitk::ImageStatisticsConstants::QUANTILE25() {
+  return "Quantile25";
+}
+const std::string mitk::ImageStatisticsConstants::QUANTILE50() {
+  return "Quantile50";
+}
+const std::string mitk::ImageStatisticsConstants::QUANTILE75() {
+  return "Quantile75";
+}
+const std::string mitk::ImageStatisticsConstants::INTERQUARTILERANGE() {
+  return "InterquartileRange";
+}
@@ -40,6 +40,10 @@ namespace mitk
     static const std::string ENTROPY();
     static const std::string MPP();
     static const std::string UPP();
+    static const std::string QUANTILE25();
+    static const std::string QUANTILE50();
+    static const std::string QUANTILE75();
+    static const std::string INTERQUARTILERANGE();
 
   };
 }
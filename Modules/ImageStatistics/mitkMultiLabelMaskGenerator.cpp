@@ -11,3 +11,199 @@ found in the LICENSE file.
 ============================================================================*/
 
 #include <mitkMultiLabelMaskGenerator.h>
+#include <mitkImageTimeSelector.h>
+#include <mitkImageWriteAccessor.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace mitk
+{
+
+MultiLabelMaskGenerator::MultiLabelMaskGenerator() : Superclass(), m_Layer(0), m_InternalMaskUpdateTime(0)
+{
+}
+
+void MultiLabelMaskGenerator::SetLabelSetImage(const mitk::LabelSetImage* labelSetImage)
+{
+    if (m_LabelSetImage != labelSetImage)
+    {
+        m_LabelSetImage = labelSetImage;
+        this->Modified();
+    }
+}
+
+const mitk::LabelSetImage* MultiLabelMaskGenerator::GetLabelSetImage() const
+{
+    return m_LabelSetImage;
+}
+
+void MultiLabelMaskGenerator::SetLayer(unsigned int layer)
+{
+    if (m_Layer != layer)
+    {
+        m_Layer = layer;
+        this->Modified();
+    }
+}
+
+unsigned int MultiLabelMaskGenerator::GetLayer() const
+{
+    return m_Layer;
+}
+
+void MultiLabelMaskGenerator::SetSelectedLabels(const LabelVectorType& labels)
+{
+    if (m_SelectedLabels != labels)
+    {
+        m_SelectedLabels = labels;
+        this->Modified();
+    }
+}
+
+void MultiLabelMaskGenerator::AddLabel(LabelPixelType label)
+{
+    if (std::find(m_SelectedLabels.begin(), m_SelectedLabels.end(), label) == m_SelectedLabels.end())
+    {
+        m_SelectedLabels.push_back(label);
+        this->Modified();
+    }
+}
+
+void MultiLabelMaskGenerator::RemoveLabel(LabelPixelType label)
+{
+    auto pos = std::find(m_SelectedLabels.begin(), m_SelectedLabels.end(), label);
+    if (pos != m_SelectedLabels.end())
+    {
+        m_SelectedLabels.erase(pos);
+        this->Modified();
+    }
+}
+
+MultiLabelMaskGenerator::LabelVectorType MultiLabelMaskGenerator::GetSelectedLabels() const
+{
+    if (!m_SelectedLabels.empty() || m_LabelSetImage.IsNull())
+    {
+        return m_SelectedLabels;
+    }
+
+    LabelVectorType result;
+    const LabelSet* labelSet = m_LabelSetImage->GetLabelSet(m_Layer);
+    for (auto iter = labelSet->IteratorConstBegin(); iter != labelSet->IteratorConstEnd(); ++iter)
+    {
+        if (iter->first != 0)
+        {
+            result.push_back(iter->first);
+        }
+    }
+    return result;
+}
+
+const mitk::Image* MultiLabelMaskGenerator::GetLabelImage() const
+{
+    if (m_LabelSetImage.IsNull())
+    {
+        return nullptr;
+    }
+
+    // the label set image itself holds the data of the active layer
+    if (m_LabelSetImage->GetActiveLayer() == m_Layer)
+    {
+        return m_LabelSetImage;
+    }
+    return m_LabelSetImage->GetLayerImage(m_Layer);
+}
+
+void MultiLabelMaskGenerator::SetTimeStep(unsigned int timeStep)
+{
+    if (timeStep != m_TimeStep)
+    {
+        m_TimeStep = timeStep;
+        this->Modified();
+    }
+}
+
+unsigned long MultiLabelMaskGenerator::GetMTime() const
+{
+    unsigned long result = Superclass::GetMTime();
+    if (m_LabelSetImage.IsNotNull())
+    {
+        result = std::max(result, m_LabelSetImage->GetMTime());
+    }
+    return result;
+}
+
+bool MultiLabelMaskGenerator::IsUpdateRequired() const
+{
+    return m_InternalMask.IsNull() || this->GetMTime() > m_InternalMaskUpdateTime;
+}
+
+void MultiLabelMaskGenerator::UpdateInternalMask()
+{
+    const mitk::Image* labelImage = this->GetLabelImage();
+
+    unsigned int timeStepForExtraction = m_TimeStep;
+    if (m_TimeStep >= labelImage->GetTimeSteps())
+    {
+        MITK_WARN << "Warning: time step > number of time steps in label image, using last time step";
+        timeStepForExtraction = labelImage->GetTimeSteps() - 1;
+    }
+
+    ImageTimeSelector::Pointer imageTimeSelector = ImageTimeSelector::New();
+    imageTimeSelector->SetInput(labelImage);
+    imageTimeSelector->SetTimeNr(timeStepForExtraction);
+    imageTimeSelector->UpdateLargestPossibleRegion();
+
+    m_InternalMask = imageTimeSelector->GetOutput();
+    m_InternalMask->DisconnectPipeline();
+
+    // mask out all labels that are not selected
+    std::vector<bool> isSelected(static_cast<size_t>(std::numeric_limits<LabelPixelType>::max()) + 1, false);
+    for (auto label : this->GetSelectedLabels())
+    {
+        isSelected[label] = true;
+    }
+
+    {
+        ImageWriteAccessor accessor(m_InternalMask);
+        auto* data = static_cast<LabelPixelType*>(accessor.GetData());
+        const auto* dimensions = m_InternalMask->GetDimensions();
+        size_t numberOfVoxels = 1;
+        for (unsigned int i = 0; i < m_InternalMask->GetDimension(); ++i)
+        {
+            numberOfVoxels *= dimensions[i];
+        }
+
+        for (size_t i = 0; i < numberOfVoxels; ++i)
+        {
+            if (!isSelected[data[i]])
+            {
+                data[i] = 0;
+            }
+        }
+    }
+
+    m_InternalMaskUpdateTime = this->GetMTime();
+}
+
+mitk::Image::Pointer MultiLabelMaskGenerator::GetMask()
+{
+    if (m_LabelSetImage.IsNull())
+    {
+        mitkThrow() << "Cannot generate multi label mask. Label set image is not set.";
+    }
+
+    if (m_Layer >= m_LabelSetImage->GetNumberOfLayers())
+    {
+        mitkThrow() << "Cannot generate multi label mask. Invalid layer: " << m_Layer;
+    }
+
+    if (IsUpdateRequired())
+    {
+        UpdateInternalMask();
+    }
+
+    return m_InternalMask;
+}
+
+}
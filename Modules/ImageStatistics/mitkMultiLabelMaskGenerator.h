@@ -18,36 +18,72 @@ found in the LICENSE file.
 #include <mitkImage.h>
 #include <mitkLabelSetImage.h>
 
+#include <vector>
 
 namespace mitk
 {
 /**
- * @brief The MultiLabelMaskGenerator class NOT IMPLEMENTED YET!
+ * @brief The MultiLabelMaskGenerator class provides a label mask that contains several labels of one layer of a
+ * LabelSetImage. In contrast to the other mask generators the mask is not binary; every voxel keeps its label value,
+ * voxels of labels that are not selected are set to 0.
+ *
+ * If this generator is set as mask of the ImageStatisticsCalculator, the calculator computes the statistics of all
+ * selected labels and all time steps in one traversal of the image (see ImageStatisticsCalculator::GetStatistics()).
  */
 class MITKIMAGESTATISTICS_EXPORT MultiLabelMaskGenerator: public MaskGenerator
 {
 public:
-   /* void setLabelSetImage(mitk::LabelSetImage::Pointer labelSetImage);
+    /** Standard Self typedef */
+    typedef MultiLabelMaskGenerator             Self;
+    typedef MaskGenerator                       Superclass;
+    typedef itk::SmartPointer< Self >           Pointer;
+    typedef itk::SmartPointer< const Self >     ConstPointer;
 
-    void addLabel(LabelSetImage::PixelType, std::vector<mitk::Image::Pointer>::size_type layer=0);
-    void removeLabel(LabelSetImage::PixelType, std::vector<mitk::Image::Pointer>::size_type layer=0);
+    /** Method for creation through the object factory. */
+    itkNewMacro(Self); /** Runtime information support. */
+    itkTypeMacro(MultiLabelMaskGenerator, MaskGenerator);
 
-    void addLabels(std::pair<std::vector<mitk::Image::Pointer>::size_type, std::vector<unsigned int>> labelsToAdd);
-    void removeLabels(std::pair<std::vector<mitk::Image::Pointer>::size_type, std::vector<unsigned int>> labelsToAdd);
+    typedef LabelSetImage::PixelType LabelPixelType;
+    typedef std::vector<LabelPixelType> LabelVectorType;
 
-    void addLabels(std::vector<LabelSetImage::PixelType> labels, std::vector<mitk::Image::Pointer>::size_type layer=0);
-    void removeLabels(std::vector<LabelSetImage::PixelType> labels, std::vector<mitk::Image::Pointer>::size_type layer=0);
+    void SetLabelSetImage(const mitk::LabelSetImage* labelSetImage);
+    const mitk::LabelSetImage* GetLabelSetImage() const;
 
-    void removeLayer(std::vector<mitk::Image::Pointer>::size_type layer);
+    /** Sets the layer of the label set image that should be used. Default is 0.*/
+    void SetLayer(unsigned int layer);
+    unsigned int GetLayer() const;
 
-    mitk::Image::Pointer GetMask();
+    /** Restricts the mask to the passed labels. If no labels are selected explicitly (default), all labels of
+     * the layer (except the exterior label 0) are used.*/
+    void SetSelectedLabels(const LabelVectorType& labels);
+    void AddLabel(LabelPixelType label);
+    void RemoveLabel(LabelPixelType label);
+
+    /** Returns the labels that are effectively part of the mask.*/
+    LabelVectorType GetSelectedLabels() const;
+
+    /** Returns the image of the layer (all time steps) the mask is based on. Voxels of labels that are not selected
+     * are not masked out in this image, use GetSelectedLabels() to filter them.*/
+    const mitk::Image* GetLabelImage() const;
+
+    mitk::Image::Pointer GetMask() override;
+
+    void SetTimeStep(unsigned int timeStep) override;
+
+    /** The modification time also reflects changes of the label set image.*/
+    unsigned long GetMTime() const override;
 
 protected:
+    MultiLabelMaskGenerator();
 
 private:
-    mitk::LabelSetImage::Pointer m_LabelSetImage;
-    std::vector<std::vector<LabelSetImage::PixelType>> m_selectedLabels;*/
+    bool IsUpdateRequired() const;
+    void UpdateInternalMask();
 
+    mitk::LabelSetImage::ConstPointer m_LabelSetImage;
+    unsigned int m_Layer;
+    LabelVectorType m_SelectedLabels;
+    unsigned long m_InternalMaskUpdateTime;
 };
 
 }
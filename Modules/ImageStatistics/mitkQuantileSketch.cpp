@@ -0,0 +1,211 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <mitkQuantileSketch.h>
+#include <mitkExceptionMacro.h>
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace mitk
+{
+
+namespace
+{
+    /** Ratio of the capacities of two successive levels.*/
+    const double LEVEL_CAPACITY_RATIO = 2. / 3.;
+    const std::size_t MINIMAL_LEVEL_CAPACITY = 8;
+}
+
+QuantileSketch::QuantileSketch(unsigned int accuracy) : m_Accuracy(std::max(accuracy, 8u)), m_Count(0), m_RetainedValues(0), m_Capacity(0)
+{
+    m_Levels.resize(1);
+    m_CompactionOffsets.resize(1, false);
+    this->UpdateCapacities();
+}
+
+void QuantileSketch::Clear()
+{
+    m_Count = 0;
+    m_RetainedValues = 0;
+    m_Levels.assign(1, std::vector<ValueType>());
+    m_CompactionOffsets.assign(1, false);
+    this->UpdateCapacities();
+}
+
+QuantileSketch::CountType QuantileSketch::GetCount() const
+{
+    return m_Count;
+}
+
+unsigned int QuantileSketch::GetAccuracy() const
+{
+    return m_Accuracy;
+}
+
+bool QuantileSketch::IsExact() const
+{
+    return m_Levels.size() == 1;
+}
+
+double QuantileSketch::GetNormalizedRankError() const
+{
+    return this->IsExact() ? 0. : 1.65 / m_Accuracy;
+}
+
+std::size_t QuantileSketch::GetNumberOfRetainedValues() const
+{
+    return m_RetainedValues;
+}
+
+void QuantileSketch::UpdateCapacities()
+{
+    m_LevelCapacities.resize(m_Levels.size());
+    m_Capacity = 0;
+    for (std::size_t level = 0; level < m_Levels.size(); ++level)
+    {
+        const auto depth = m_Levels.size() - 1 - level;
+        const auto capacity = static_cast<std::size_t>(std::ceil(m_Accuracy * std::pow(LEVEL_CAPACITY_RATIO, static_cast<double>(depth))));
+        m_LevelCapacities[level] = std::max(capacity, MINIMAL_LEVEL_CAPACITY);
+        m_Capacity += m_LevelCapacities[level];
+    }
+}
+
+void QuantileSketch::Add(ValueType value)
+{
+    m_Levels[0].push_back(value);
+    ++m_Count;
+    ++m_RetainedValues;
+
+    if (m_RetainedValues >= m_Capacity)
+    {
+        this->Compress();
+    }
+}
+
+void QuantileSketch::Merge(const QuantileSketch& other)
+{
+    if (other.m_Accuracy != m_Accuracy)
+    {
+        mitkThrow() << "Cannot merge quantile sketches with different accuracy (" << m_Accuracy << " vs. " << other.m_Accuracy << ").";
+    }
+
+    if (other.m_Count == 0)
+    {
+        return;
+    }
+
+    if (other.m_Levels.size() > m_Levels.size())
+    {
+        m_Levels.resize(other.m_Levels.size());
+        m_CompactionOffsets.resize(other.m_Levels.size(), false);
+        this->UpdateCapacities();
+    }
+
+    for (std::size_t level = 0; level < other.m_Levels.size(); ++level)
+    {
+        m_Levels[level].insert(m_Levels[level].end(), other.m_Levels[level].begin(), other.m_Levels[level].end());
+    }
+
+    m_Count += other.m_Count;
+    m_RetainedValues += other.m_RetainedValues;
+
+    if (m_RetainedValues >= m_Capacity)
+    {
+        this->Compress();
+    }
+}
+
+void QuantileSketch::Compress()
+{
+    for (std::size_t level = 0; level < m_Levels.size(); ++level)
+    {
+        if (m_Levels[level].size() < m_LevelCapacities[level])
+        {
+            continue;
+        }
+
+        if (level + 1 == m_Levels.size())
+        {
+            m_Levels.emplace_back();
+            m_CompactionOffsets.push_back(false);
+            this->UpdateCapacities();
+        }
+
+        auto& values = m_Levels[level];
+        std::sort(values.begin(), values.end());
+
+        // an odd value stays in this level
+        const bool hasOddValue = values.size() % 2 == 1;
+        const ValueType oddValue = hasOddValue ? values.back() : 0.;
+        const std::size_t pairedSize = hasOddValue ? values.size() - 1 : values.size();
+
+        const std::size_t offset = m_CompactionOffsets[level] ? 1 : 0;
+        m_CompactionOffsets[level] = !m_CompactionOffsets[level];
+
+        auto& nextLevel = m_Levels[level + 1];
+        for (std::size_t i = offset; i < pairedSize; i += 2)
+        {
+            nextLevel.push_back(values[i]);
+        }
+
+        m_RetainedValues -= pairedSize / 2;
+        values.clear();
+        if (hasOddValue)
+        {
+            values.push_back(oddValue);
+        }
+
+        if (m_RetainedValues < m_Capacity)
+        {
+            break;
+        }
+    }
+}
+
+QuantileSketch::ValueType QuantileSketch::GetQuantile(double quantile) const
+{
+    if (m_Count == 0)
+    {
+        mitkThrow() << "Cannot compute quantile of empty quantile sketch.";
+    }
+
+    std::vector<std::pair<ValueType, CountType>> weightedValues;
+    weightedValues.reserve(m_RetainedValues);
+    for (std::size_t level = 0; level < m_Levels.size(); ++level)
+    {
+        const CountType weight = CountType(1) << level;
+        for (const auto value : m_Levels[level])
+        {
+            weightedValues.emplace_back(value, weight);
+        }
+    }
+    std::sort(weightedValues.begin(), weightedValues.end());
+
+    quantile = std::min(std::max(quantile, 0.), 1.);
+    const CountType rank = std::max<CountType>(1, static_cast<CountType>(std::ceil(quantile * m_Count)));
+
+    CountType cumulativeWeight = 0;
+    for (const auto& weightedValue : weightedValues)
+    {
+        cumulativeWeight += weightedValue.second;
+        if (cumulativeWeight >= rank)
+        {
+            return weightedValue.first;
+        }
+    }
+
+    return weightedValues.back().first;
+}
+
+}
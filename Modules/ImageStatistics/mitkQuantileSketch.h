@@ -0,0 +1,85 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef MITKQUANTILESKETCH_H
+#define MITKQUANTILESKETCH_H
+
+#include <MitkImageStatisticsExports.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace mitk
+{
+    /**
+     * @brief Streaming quantile sketch (deterministic variant of the KLL sketch) to estimate median, percentiles
+     * and interquartile range in one pass without a predefined bin count.
+     *
+     * Values are kept in a hierarchy of compactors; level i holds values with weight 2^i. If the sketch exceeds its
+     * capacity, the lowest full level is sorted and every second value is promoted to the next level. As long as
+     * no compaction was necessary (see IsExact()) all values are kept and quantiles are exact.
+     * The rank error of a quantile is bounded by about GetNormalizedRankError() * GetCount().
+     * Sketches with the same accuracy can be merged, e.g. to combine the results of several threads or image bricks.
+     */
+    class MITKIMAGESTATISTICS_EXPORT QuantileSketch
+    {
+    public:
+        typedef double ValueType;
+        typedef std::uint64_t CountType;
+
+        /** @param accuracy Capacity of the top level compactor (k). Larger values reduce the error and
+         * increase the memory footprint (about 3*k values).*/
+        explicit QuantileSketch(unsigned int accuracy = 200);
+
+        void Add(ValueType value);
+
+        /** Merges the values of other into this sketch.
+         * @exception mitk::Exception if the accuracy of the sketches differs.*/
+        void Merge(const QuantileSketch& other);
+
+        /** Returns the value with the (estimated) rank ceil(quantile * GetCount()), i.e. the lower median for
+         * an even number of values. quantile is clamped to [0, 1].
+         * @exception mitk::Exception if the sketch is empty.*/
+        ValueType GetQuantile(double quantile) const;
+
+        CountType GetCount() const;
+        unsigned int GetAccuracy() const;
+
+        /** Indicates that all added values are retained and quantiles are exact.*/
+        bool IsExact() const;
+
+        /** Approximate upper bound of the normalized rank error (about 1.65/k).*/
+        double GetNormalizedRankError() const;
+
+        /** Number of values currently retained by the sketch.*/
+        std::size_t GetNumberOfRetainedValues() const;
+
+        void Clear();
+
+    private:
+        /** Recomputes the level capacities. They only change if a level is added.*/
+        void UpdateCapacities();
+        void Compress();
+
+        unsigned int m_Accuracy;
+        CountType m_Count;
+        std::size_t m_RetainedValues;
+        /** Capacity of every level and their sum (see UpdateCapacities()).*/
+        std::vector<std::size_t> m_LevelCapacities;
+        std::size_t m_Capacity;
+        std::vector<std::vector<ValueType>> m_Levels;
+        /** Offset used by the next compaction of a level; alternates to avoid a systematic bias.*/
+        std::vector<bool> m_CompactionOffsets;
+    };
+}
+
+#endif
@@ -8,6 +8,8 @@ set(CPP_FILES
   Common/mitkModelFitParameter.cpp
   Common/mitkModelFitCmdAppsHelper.cpp
   Common/mitkParameterFitImageGeneratorBase.cpp
+  Common/mitkParameterFitChunkCheckpoint.cpp
+  Common/mitkModelFitWarmStartCache.cpp
   Common/mitkPixelBasedParameterFitImageGenerator.cpp
   Common/mitkROIBasedParameterFitImageGenerator.cpp
   Common/mitkModelFitInfo.cpp
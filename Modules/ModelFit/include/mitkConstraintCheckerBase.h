@@ -13,6 +13,8 @@ found in the LICENSE file.
 #ifndef CONSTRAINT_CHECKER_BASE_H
 #define CONSTRAINT_CHECKER_BASE_H
 
+#include <string>
+
 #include <itkObject.h>
 #include <itkMacro.h>
 
@@ -37,6 +39,8 @@ public:
     typedef itk::SmartPointer< Self >                            Pointer;
     typedef itk::SmartPointer< const Self >                      ConstPointer;
 
+    itkTypeMacro(ConstraintCheckerBase, itk::Object);
+
     typedef Superclass::PenaltyValueType PenaltyValueType;
     typedef Superclass::PenaltyArrayType PenaltyArrayType;
     typedef Superclass::SignalType SignalType;
@@ -44,6 +48,11 @@ public:
 
     PenaltyValueType GetPenaltySum(const ParametersType &parameters) const override;
 
+    /** Returns a one line description of all settings of the checker that influence the penalties.
+     It is used to identify a fit setup, e.g. if a checkpoint of a fit is resumed. Derived checkers
+     with own settings must extend it.*/
+    virtual std::string GetSettingsSignature() const;
+
 protected:
 
     ConstraintCheckerBase()
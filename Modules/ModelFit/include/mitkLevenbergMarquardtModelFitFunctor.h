@@ -60,6 +60,8 @@ namespace mitk
 
     ParameterNamesType GetCriterionNames() const override;
 
+    std::string GetSettingsSignature() const override;
+
   protected:
 
     typedef Superclass::ParametersType ParametersType;
@@ -54,6 +54,18 @@ namespace mitk
     OutputPixelArrayType Compute(const InputPixelArrayType& value, const ModelBase* model,
                                  const ModelBase::ParametersType& initialParameters) const;
 
+    /** Same as Compute(value, model, initialParameters), but additionally returns the number of iterations the
+     * optimizer of the functor needed for the fit.
+     * @param [out] iterations Number of iterations. Will be -1 if the functor does not report its iterations
+     * (see ITERATIONS_DEBUG_PARAMETER_NAME).*/
+    OutputPixelArrayType Compute(const InputPixelArrayType& value, const ModelBase* model,
+                                 const ModelBase::ParametersType& initialParameters, ParameterImagePixelType& iterations) const;
+
+    /** Name of the debug parameter that is used by iterative functors to report the number of iterations.
+     * Functors should always (independent of DebugParameterMaps) return this value via the debug parameter map
+     * in DoModelFit(), if they are able to determine it.*/
+    static const std::string ITERATIONS_DEBUG_PARAMETER_NAME;
+
     /** Returns the number of outputs the fit functor will return if compute is called.
      * The number depends in parts on the passed model.
      * @exception Exception will be thrown if no valid model is passed.*/
@@ -80,6 +92,11 @@ namespace mitk
     itkSetMacro(DebugParameterMaps, bool);
     itkGetConstMacro(DebugParameterMaps, bool);
 
+    /** Returns a one line description of all settings of the functor that influence the fit results
+     (e.g. optimizer settings, constraints, evaluation parameters). It is used to identify a fit setup,
+     e.g. if a checkpoint of a fit is resumed. Derived functors with own settings must extend it.*/
+    virtual std::string GetSettingsSignature() const;
+
   protected:
 
     typedef ModelBase::ParametersType ParametersType;
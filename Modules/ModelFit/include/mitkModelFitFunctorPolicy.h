@@ -15,6 +15,7 @@ found in the LICENSE file.
 
 #include "itkIndex.h"
 #include "mitkModelFitFunctorBase.h"
+#include "mitkModelFitWarmStartCache.h"
 #include "MitkModelFitExports.h"
 
 namespace mitk
@@ -32,6 +33,9 @@ namespace mitk
     typedef ModelFitFunctorBase               FunctorType;
     typedef ModelFitFunctorBase::ConstPointer FunctorConstPointer;
 
+    typedef ModelFitWarmStartCache WarmStartCacheType;
+    typedef WarmStartCacheType::Pointer WarmStartCachePointer;
+
     typedef itk::Index<3> IndexType;
 
     ModelFitFunctorPolicy()
@@ -72,6 +76,15 @@ namespace mitk
       m_ModelParameterizer = parameterizer;
     }
 
+    /** Sets the (optional) warm start cache. If set, the policy registers the statistics of every fit
+     in the cache. If the cache also stores parameters, every fit is seeded with the best converged
+     parameters of its neighbours (if they fit the signal better than the initial parameterization of
+     the parameterizer) and the fitted parameters are stored in the cache.*/
+    void SetWarmStartCache(WarmStartCacheType* cache)
+    {
+      m_WarmStartCache = cache;
+    }
+
     bool operator!=(const ModelFitFunctorPolicy& other) const
     {
       return !(*this == other);
@@ -80,7 +93,8 @@ namespace mitk
     bool operator==(const ModelFitFunctorPolicy& other) const
     {
       return (this->m_Functor == other.m_Functor) &&
-             (this->m_ModelParameterizer == other.m_ModelParameterizer);
+             (this->m_ModelParameterizer == other.m_ModelParameterizer) &&
+             (this->m_WarmStartCache == other.m_WarmStartCache);
     }
 
     inline OutputPixelArrayType operator()(const InputPixelArrayType& value,
@@ -100,7 +114,29 @@ namespace mitk
         m_ModelParameterizer->GenerateParameterizedModel(currentIndex);
       ParameterizerType::ParametersType initialParams = m_ModelParameterizer->GetInitialParameterization(
             currentIndex);
-      OutputPixelArrayType result = m_Functor->Compute(value, parameterizedModel, initialParams);
+
+      if (m_WarmStartCache.IsNull())
+      {
+        return m_Functor->Compute(value, parameterizedModel, initialParams);
+      }
+
+      const bool warmStarted = m_WarmStartCache->SelectInitialParameters(currentIndex, parameterizedModel, value, initialParams);
+
+      ModelFitFunctorBase::ParameterImagePixelType iterations = -1;
+      OutputPixelArrayType result = m_Functor->Compute(value, parameterizedModel, initialParams, iterations);
+
+      m_WarmStartCache->RegisterFit(currentIndex, warmStarted, iterations);
+
+      if (m_WarmStartCache->IsStoringParameters())
+      {
+        //the fitted parameters are the first values of the result (see ModelFitFunctorBase::Compute())
+        ParameterizerType::ParametersType fittedParams(initialParams.GetSize());
+        for (ParameterizerType::ParametersType::SizeValueType i = 0; i < fittedParams.GetSize(); ++i)
+        {
+          fittedParams[i] = result[i];
+        }
+        m_WarmStartCache->SetConvergedParameters(currentIndex, fittedParams);
+      }
 
       return result;
     }
@@ -109,6 +145,7 @@ namespace mitk
 
     FunctorConstPointer m_Functor;
     ParameterizerConstPointer m_ModelParameterizer;
+    WarmStartCachePointer m_WarmStartCache;
   };
 
 }
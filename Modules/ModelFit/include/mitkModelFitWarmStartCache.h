@@ -0,0 +1,132 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef __MITK_MODEL_FIT_WARM_START_CACHE_H_
+#define __MITK_MODEL_FIT_WARM_START_CACHE_H_
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <itkObject.h>
+#include <itkImageRegion.h>
+
+#include <mitkCommon.h>
+
+#include "mitkModelBase.h"
+
+#include "MitkModelFitExports.h"
+
+namespace mitk
+{
+  /** Cache that is used by pixel based fits to warm start the fit of a voxel with the converged
+   * parameters of already fitted neighbour voxels. Additionally the cache collects statistics about
+   * the number of optimizer iterations needed by warm and cold started fits, to quantify the
+   * benefit of warm starting.
+   * The cache is thread safe. Parameters of a voxel are published via an atomic flag, thus
+   * concurrent fits of neighbouring voxels (e.g. at the border of two thread regions) will just
+   * not see each other and fall back to the parameterizer.
+   * @remark Warm started fits are not deterministic: which neighbours have already converged when a
+   * voxel is fitted depends on how the region is split across the threads (and on their timing).
+   * The fit may therefore converge to slightly different values (or, for models with several local
+   * minima, to a different minimum) if the number of threads changes or between two runs. If
+   * reproducible results are required, warm starting must be deactivated.
+   * The statistics are recorded per voxel without locking and only aggregated by GetStatistics().*/
+  class MITKMODELFIT_EXPORT ModelFitWarmStartCache : public ::itk::Object
+  {
+  public:
+    mitkClassMacroItkParent(ModelFitWarmStartCache, ::itk::Object);
+    itkFactorylessNewMacro(Self);
+
+    using ParametersType = ModelBase::ParametersType;
+    using SignalType = std::vector<ScalarType>;
+    using IndexType = ::itk::Index<3>;
+    using RegionType = ::itk::ImageRegion<3>;
+
+    /** Statistics of all fits registered since the last Initialize() call.*/
+    struct FitStatistics
+    {
+      FitStatistics() : FitCount(0), WarmStartCount(0), ColdStartIterations(0), WarmStartIterations(0) {};
+
+      /** Number of fits (including fits of functors that do not report iterations).*/
+      unsigned long long FitCount;
+      /** Number of fits that were seeded with the parameters of a neighbour.*/
+      unsigned long long WarmStartCount;
+      /** Sum of optimizer iterations of all fits seeded by the parameterizer.*/
+      double ColdStartIterations;
+      /** Sum of optimizer iterations of all fits seeded by a neighbour.*/
+      double WarmStartIterations;
+
+      double GetMeanColdStartIterations() const;
+      double GetMeanWarmStartIterations() const;
+      double GetMeanIterations() const;
+    };
+
+    /** Resets the cache for a fit of the passed region.
+     * @param region Region (of the frame images) that will be fitted.
+     * @param parameterCount Number of parameters of the fitted model.
+     * @param storeParameters If false, only statistics are collected and no warm start is possible.*/
+    void Initialize(const RegionType& region, unsigned int parameterCount, bool storeParameters);
+
+    bool IsStoringParameters() const;
+
+    /** Checks the converged parameters of all direct (6-connected) neighbours of the passed index
+     * and replaces initialParameters with the candidate that fits the passed sample best (sum of squared
+     * differences of the model signal), if it is better than initialParameters.
+     * @return Indicates if initialParameters were replaced by the parameters of a neighbour.*/
+    bool SelectInitialParameters(const IndexType& index, const ModelBase* model, const SignalType& sample,
+      ParametersType& initialParameters) const;
+
+    /** Stores the converged parameters of the passed index. Parameters that are not finite are ignored.*/
+    void SetConvergedParameters(const IndexType& index, const ParametersType& parameters);
+
+    /** Registers a finished fit of the passed index for the statistics.
+     * @param warmStarted Indicates if the fit was seeded by a neighbour.
+     * @param iterations Number of optimizer iterations. Negative values indicate that the functor does not report iterations.*/
+    void RegisterFit(const IndexType& index, bool warmStarted, ScalarType iterations);
+
+    /** Aggregates the statistics of all fits registered since the last Initialize() call.
+     * Should not be called while fitting, as voxels that are just registered may be missed.*/
+    FitStatistics GetStatistics() const;
+
+  protected:
+    ModelFitWarmStartCache();
+    ~ModelFitWarmStartCache() override;
+
+    double ComputeSquaredDifferences(const ModelBase* model, const SignalType& sample, const ParametersType& parameters) const;
+
+  private:
+    RegionType::SizeValueType ComputeLinearIndex(const IndexType& index) const;
+
+    RegionType m_Region;
+    unsigned int m_ParameterCount;
+    bool m_StoreParameters;
+
+    std::vector<ParametersType::ValueType> m_Parameters;
+    std::unique_ptr<std::atomic<bool>[]> m_ConvergedFlags;
+
+    enum FitState : unsigned char
+    {
+      NotFitted = 0,
+      ColdStarted,
+      WarmStarted
+    };
+
+    /** Statistics records per voxel. Every voxel is only written by the thread that fits it, thus
+     no synchronisation is needed while fitting.*/
+    std::vector<unsigned char> m_FitStates;
+    std::vector<ScalarType> m_FitIterations;
+  };
+
+}
+
+#endif // __MITK_MODEL_FIT_WARM_START_CACHE_H_
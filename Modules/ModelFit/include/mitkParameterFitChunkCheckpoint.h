@@ -0,0 +1,83 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef __MITK_PARAMETER_FIT_CHUNK_CHECKPOINT_H_
+#define __MITK_PARAMETER_FIT_CHUNK_CHECKPOINT_H_
+
+#include <string>
+#include <vector>
+
+#include <mitkNumericConstants.h>
+
+#include "MitkModelFitExports.h"
+
+namespace mitk
+{
+  /** Helper class that persists the results of a chunked parameter fit on disk, so that an interrupted
+   * fit can be resumed with the first chunk that was not finished.
+   * The checkpoint directory contains a manifest file that stores the signature of the fit (identifying
+   * model, input geometry, outputs and chunk layout) and one binary file per finished chunk. A chunk file
+   * contains the values of all outputs (parameters, derived parameters, criteria, evaluation and debug
+   * parameters) of the chunk region in output order. Chunk files are first written to a temporary file and
+   * then renamed, thus a chunk is either completely stored or not at all.
+   * @remark The class does not interpret the stored values. The caller is responsible for using the same
+   * output order and voxel order for storing and loading a chunk.*/
+  class MITKMODELFIT_EXPORT ParameterFitChunkCheckpoint
+  {
+  public:
+    using ValueType = ScalarType;
+    /** Values of one chunk. Outer vector: outputs; inner vector: voxels of the chunk.*/
+    using ChunkValuesType = std::vector<std::vector<ValueType> >;
+    using ChunkIDType = unsigned int;
+
+    explicit ParameterFitChunkCheckpoint(const std::string& directory);
+    ~ParameterFitChunkCheckpoint() = default;
+
+    /** Prepares the checkpoint directory for a fit with the passed signature and chunk count.
+     * If the directory already contains a checkpoint with the same signature, all chunks stored there
+     * are regarded as completed. Otherwise the old content of the checkpoint is removed.
+     * @pre directory must be set.
+     * @exception mitk::Exception if the directory cannot be created or the manifest cannot be written.*/
+    void Initialize(const std::string& signature, ChunkIDType chunkCount);
+
+    /** Indicates if the passed chunk is already stored in the checkpoint.*/
+    bool IsChunkCompleted(ChunkIDType chunkID) const;
+
+    /** Returns the number of chunks that are already stored in the checkpoint.*/
+    ChunkIDType GetNumberOfCompletedChunks() const;
+
+    /** Stores the values of the passed chunk and marks it as completed.
+     * @exception mitk::Exception if the chunk file cannot be written.*/
+    void StoreChunk(ChunkIDType chunkID, const ChunkValuesType& values);
+
+    /** Loads the values of a completed chunk.
+     * @exception mitk::Exception if the chunk is not completed or the chunk file is invalid.*/
+    ChunkValuesType LoadChunk(ChunkIDType chunkID) const;
+
+    /** Removes the manifest and all chunk files of the checkpoint (e.g. after a fit was completed and
+     * the results are stored elsewhere).*/
+    void Clear();
+
+    const std::string& GetDirectory() const;
+
+  private:
+    std::string GetManifestFilePath() const;
+    std::string GetChunkFilePath(ChunkIDType chunkID) const;
+    bool IsValidChunkFile(ChunkIDType chunkID) const;
+
+    std::string m_Directory;
+    std::vector<bool> m_CompletedChunks;
+  };
+
+}
+
+#endif // __MITK_PARAMETER_FIT_CHUNK_CHECKPOINT_H_
@@ -13,6 +13,7 @@ found in the LICENSE file.
 #ifndef __MITK_PIXEL_BASED_PARAMETER_FIT_IMAGE_GENERATOR_H_
 #define __MITK_PIXEL_BASED_PARAMETER_FIT_IMAGE_GENERATOR_H_
 
+#include <chrono>
 #include <map>
 
 #include <mitkImage.h>
@@ -20,6 +21,7 @@ found in the LICENSE file.
 #include "mitkModelParameterizerBase.h"
 #include "mitkModelFitFunctorBase.h"
 #include "mitkParameterFitImageGeneratorBase.h"
+#include "mitkModelFitWarmStartCache.h"
 
 #include "MitkModelFitExports.h"
 
@@ -71,8 +73,47 @@ public:
     itkGetMacro(TimeGridByParameterizer, bool);
     itkBooleanMacro(TimeGridByParameterizer);
 
+    /** Number of slices (last spatial dimension) that are fitted in one chunk. 0 (default) fits the whole image
+     in one go. Chunking allows to resume an interrupted fit (see SetCheckpointDirectory()) and to report the progress
+     per chunk. It does not lower the peak memory: the result images always have full size, and a chunked fit
+     additionally holds the fit filter outputs of one chunk, which are released after the chunk was copied.*/
+    itkSetMacro(ChunkSliceCount, unsigned int);
+    itkGetConstMacro(ChunkSliceCount, unsigned int);
+
+    /** Directory used to store finished chunks. A chunked fit with the same inputs, global parameterization and
+     functor settings restores the stored chunks instead of fitting them again. Initial values or static parameters
+     that are defined per voxel (e.g. by image based parameterizers) are not checked; if they change, the
+     checkpoint directory must be cleared.*/
+    itkSetStringMacro(CheckpointDirectory);
+    itkGetStringMacro(CheckpointDirectory);
+
+    /** If activated, every voxel fit is seeded with the converged parameters of an already fitted
+     neighbour voxel, if they match the signal of the voxel better than the initial parameterization
+     of the parameterizer (which stays the fallback). Voxels are visited in scanline order per thread
+     region, thus most voxels have converged neighbours.
+     @remark Warm started fits are not deterministic, because the available neighbours depend on the
+     split of the image across the threads (see ModelFitWarmStartCache). Deactivate it if results
+     must be reproducible.*/
+    itkSetMacro(WarmStart, bool);
+    itkGetConstMacro(WarmStart, bool);
+    itkBooleanMacro(WarmStart);
+
+    using FitStatisticsType = ModelFitWarmStartCache::FitStatistics;
+
+    /** Returns the statistics (e.g. iterations to convergence) of the current/last fit.
+     The statistics are collected independent of the warm start setting, to allow a comparison of both modes.*/
+    FitStatisticsType GetFitStatistics() const;
+
     double GetProgress() const override;
 
+    /** Returns the fitting speed (fitted voxels per second) measured during the current/last fit.
+     Voxels restored from a checkpoint are not taken into account. Returns 0 if no speed could be measured yet.*/
+    double GetVoxelsPerSecond() const;
+
+    /** Returns the estimated remaining time (in seconds) of the current fit, based on the measured
+     fitting speed. Returns -1 if no estimation is possible yet.*/
+    double GetEstimatedRemainingTime() const;
+
     ParameterNamesType GetParameterNames() const override;
 
     ParameterNamesType GetDerivedParameterNames() const override;
@@ -82,8 +123,10 @@ public:
     ParameterNamesType GetEvaluationParameterNames() const override;
 
 protected:
-  PixelBasedParameterFitImageGenerator() : m_Progress(0), m_TimeGridByParameterizer(false)
+  PixelBasedParameterFitImageGenerator() : m_Progress(0), m_TimeGridByParameterizer(false), m_ChunkSliceCount(0), m_WarmStart(false),
+    m_ChunkProgressOffset(0), m_ChunkProgressScale(1), m_TotalVoxels(0), m_RestoredVoxels(0), m_VoxelsPerSecond(0)
   {
+    m_WarmStartCache = ModelFitWarmStartCache::New();
     m_InternalMask = nullptr;
     m_Mask = nullptr;
     m_DynamicImage = nullptr;
@@ -97,8 +140,19 @@ protected:
     template <typename TPixel, unsigned int VDim>
     void DoPrepareMask(itk::Image<TPixel, VDim>* image);
 
+    /** Generates the outputs of the passed fit filter chunk by chunk (slabs of m_ChunkSliceCount slices along
+     the last image dimension) and assembles them in newly allocated full size images. The fit filter outputs
+     only cover the current chunk and are released after it was copied. If m_CheckpointDirectory is set,
+     every finished chunk is stored there and chunks of a previous (interrupted) run with identical settings
+     are restored instead of fitted again.*/
+    template <typename TFitFilter>
+    void DoChunkedFit(TFitFilter* fitFilter, const std::string& fitSignature, std::vector<typename TFitFilter::OutputImageType::Pointer>& outputs);
+
     void onFitProgressEvent(::itk::Object* caller, const ::itk::EventObject& eventObject);
 
+    /** Updates the measured fitting speed according to the current progress.*/
+    void UpdateFitSpeed();
+
     bool HasOutdatedResult() const override;
     void CheckValidInputs() const override;
     void DoFitAndGetResults(ParameterImageMapType& parameterImages, ParameterImageMapType& derivedParameterImages, ParameterImageMapType& criterionImages, ParameterImageMapType& evaluationParameterImages) override;
@@ -123,6 +177,27 @@ private:
     /**Indicates if the time grid defined in the parameterizer should be used (True)
     or if the filter should extract the time grid from the input image (False).*/
     bool m_TimeGridByParameterizer;
+
+    /**Number of slices (last spatial dimension) that are fitted in one chunk. 0 indicates
+    that the whole image is fitted in one go (default).*/
+    unsigned int m_ChunkSliceCount;
+    /**Directory used to store finished chunks. If empty, chunks are not persisted.
+    Only used if m_ChunkSliceCount is greater 0.*/
+    std::string m_CheckpointDirectory;
+
+    bool m_WarmStart;
+    ModelFitWarmStartCache::Pointer m_WarmStartCache;
+
+    /**Offset and scale used to map the progress of the fit filter (that only processes the current chunk)
+    onto the progress of the whole fit.*/
+    double m_ChunkProgressOffset;
+    double m_ChunkProgressScale;
+
+    double m_TotalVoxels;
+    /**Number of voxels that have been restored from the checkpoint and therefore not been fitted.*/
+    double m_RestoredVoxels;
+    double m_VoxelsPerSecond;
+    std::chrono::steady_clock::time_point m_FitStartTime;
 };
 
 }
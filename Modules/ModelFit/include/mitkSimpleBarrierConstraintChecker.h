@@ -48,6 +48,7 @@ namespace mitk
     typedef itk::SmartPointer< const Self >                      ConstPointer;
 
     itkFactorylessNewMacro(Self);
+    itkTypeMacro(SimpleBarrierConstraintChecker, ConstraintCheckerBase);
 
     typedef Superclass::PenaltyValueType PenaltyValueType;
     typedef Superclass::PenaltyArrayType PenaltyArrayType;
@@ -75,6 +76,8 @@ namespace mitk
 
     PenaltyValueType GetFailedConstraintValue() const override;
 
+    std::string GetSettingsSignature() const override;
+
     /** Sets a lower barrier for one parameter*/
     void SetLowerBarrier(ParameterIndexType parameterID, BarrierValueType barrier,
                          BarrierWidthType width = 0.0);
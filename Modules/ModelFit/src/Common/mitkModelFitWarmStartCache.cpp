@@ -0,0 +1,237 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "mitkModelFitWarmStartCache.h"
+
+#include <cmath>
+#include <limits>
+
+double
+mitk::ModelFitWarmStartCache::FitStatistics::GetMeanColdStartIterations() const
+{
+  const auto coldStartCount = FitCount - WarmStartCount;
+  return coldStartCount > 0 ? ColdStartIterations / coldStartCount : 0.;
+};
+
+double
+mitk::ModelFitWarmStartCache::FitStatistics::GetMeanWarmStartIterations() const
+{
+  return WarmStartCount > 0 ? WarmStartIterations / WarmStartCount : 0.;
+};
+
+double
+mitk::ModelFitWarmStartCache::FitStatistics::GetMeanIterations() const
+{
+  return FitCount > 0 ? (ColdStartIterations + WarmStartIterations) / FitCount : 0.;
+};
+
+mitk::ModelFitWarmStartCache::ModelFitWarmStartCache() : m_ParameterCount(0), m_StoreParameters(false)
+{
+};
+
+mitk::ModelFitWarmStartCache::~ModelFitWarmStartCache()
+{
+};
+
+void
+mitk::ModelFitWarmStartCache::Initialize(const RegionType& region, unsigned int parameterCount, bool storeParameters)
+{
+  m_Region = region;
+  m_ParameterCount = parameterCount;
+  m_StoreParameters = storeParameters;
+
+  m_Parameters.clear();
+  m_ConvergedFlags.reset();
+
+  const auto voxelCount = region.GetNumberOfPixels();
+  m_FitStates.assign(voxelCount, NotFitted);
+  m_FitIterations.assign(voxelCount, -1.);
+
+  if (m_StoreParameters)
+  {
+    m_Parameters.assign(voxelCount * parameterCount, 0.);
+    m_ConvergedFlags.reset(new std::atomic<bool>[voxelCount]);
+    for (RegionType::SizeValueType i = 0; i < voxelCount; ++i)
+    {
+      m_ConvergedFlags[i].store(false, std::memory_order_relaxed);
+    }
+  }
+
+  this->Modified();
+};
+
+bool
+mitk::ModelFitWarmStartCache::IsStoringParameters() const
+{
+  return m_StoreParameters;
+};
+
+mitk::ModelFitWarmStartCache::RegionType::SizeValueType
+mitk::ModelFitWarmStartCache::ComputeLinearIndex(const IndexType& index) const
+{
+  RegionType::SizeValueType result = 0;
+  for (int dim = RegionType::ImageDimension - 1; dim >= 0; --dim)
+  {
+    result = result * m_Region.GetSize(dim) + (index[dim] - m_Region.GetIndex(dim));
+  }
+  return result;
+};
+
+double
+mitk::ModelFitWarmStartCache::ComputeSquaredDifferences(const ModelBase* model, const SignalType& sample, const ParametersType& parameters) const
+{
+  ModelBase::ModelResultType signal;
+  try
+  {
+    signal = model->GetSignal(parameters);
+  }
+  catch (...)
+  {
+    return std::numeric_limits<double>::max();
+  }
+
+  if (signal.GetSize() != sample.size())
+  {
+    return std::numeric_limits<double>::max();
+  }
+
+  double result = 0.;
+  for (SignalType::size_type i = 0; i < sample.size(); ++i)
+  {
+    const double diff = signal[i] - sample[i];
+    result += diff * diff;
+  }
+
+  return std::isfinite(result) ? result : std::numeric_limits<double>::max();
+};
+
+bool
+mitk::ModelFitWarmStartCache::SelectInitialParameters(const IndexType& index, const ModelBase* model, const SignalType& sample,
+  ParametersType& initialParameters) const
+{
+  if (!m_StoreParameters || !model || initialParameters.GetSize() != m_ParameterCount || !m_Region.IsInside(index))
+  {
+    return false;
+  }
+
+  bool result = false;
+  double bestDifference = this->ComputeSquaredDifferences(model, sample, initialParameters);
+  ParametersType candidate(m_ParameterCount);
+
+  for (unsigned int dim = 0; dim < RegionType::ImageDimension; ++dim)
+  {
+    for (const auto offset : { -1, 1 })
+    {
+      IndexType neighbour = index;
+      neighbour[dim] += offset;
+
+      if (!m_Region.IsInside(neighbour))
+      {
+        continue;
+      }
+
+      const auto pos = this->ComputeLinearIndex(neighbour);
+      if (!m_ConvergedFlags[pos].load(std::memory_order_acquire))
+      {
+        continue;
+      }
+
+      for (unsigned int i = 0; i < m_ParameterCount; ++i)
+      {
+        candidate[i] = m_Parameters[pos * m_ParameterCount + i];
+      }
+
+      const double difference = this->ComputeSquaredDifferences(model, sample, candidate);
+      if (difference < bestDifference)
+      {
+        bestDifference = difference;
+        initialParameters = candidate;
+        result = true;
+      }
+    }
+  }
+
+  return result;
+};
+
+void
+mitk::ModelFitWarmStartCache::SetConvergedParameters(const IndexType& index, const ParametersType& parameters)
+{
+  if (!m_StoreParameters || parameters.GetSize() != m_ParameterCount || !m_Region.IsInside(index))
+  {
+    return;
+  }
+
+  for (unsigned int i = 0; i < m_ParameterCount; ++i)
+  {
+    if (!std::isfinite(parameters[i]))
+    {
+      return;
+    }
+  }
+
+  const auto pos = this->ComputeLinearIndex(index);
+  for (unsigned int i = 0; i < m_ParameterCount; ++i)
+  {
+    m_Parameters[pos * m_ParameterCount + i] = parameters[i];
+  }
+  m_ConvergedFlags[pos].store(true, std::memory_order_release);
+};
+
+void
+mitk::ModelFitWarmStartCache::RegisterFit(const IndexType& index, bool warmStarted, ScalarType iterations)
+{
+  if (!m_Region.IsInside(index))
+  {
+    return;
+  }
+
+  const auto pos = this->ComputeLinearIndex(index);
+  m_FitStates[pos] = warmStarted ? WarmStarted : ColdStarted;
+  m_FitIterations[pos] = iterations;
+};
+
+mitk::ModelFitWarmStartCache::FitStatistics
+mitk::ModelFitWarmStartCache::GetStatistics() const
+{
+  FitStatistics result;
+
+  for (std::vector<unsigned char>::size_type pos = 0; pos < m_FitStates.size(); ++pos)
+  {
+    if (m_FitStates[pos] == NotFitted)
+    {
+      continue;
+    }
+
+    ++result.FitCount;
+    const bool warmStarted = m_FitStates[pos] == WarmStarted;
+    if (warmStarted)
+    {
+      ++result.WarmStartCount;
+    }
+
+    const ScalarType iterations = m_FitIterations[pos];
+    if (iterations >= 0)
+    {
+      if (warmStarted)
+      {
+        result.WarmStartIterations += iterations;
+      }
+      else
+      {
+        result.ColdStartIterations += iterations;
+      }
+    }
+  }
+
+  return result;
+};
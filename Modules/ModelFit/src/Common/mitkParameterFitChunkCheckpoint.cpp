@@ -0,0 +1,242 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "mitkParameterFitChunkCheckpoint.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include <itksys/SystemTools.hxx>
+
+#include <mitkExceptionMacro.h>
+#include <mitkLogMacros.h>
+
+namespace
+{
+  const std::string MANIFEST_FILE_NAME = "fit_checkpoint.manifest";
+  const std::string MANIFEST_HEADER = "MITK_PARAMETER_FIT_CHECKPOINT 1";
+  const std::uint32_t CHUNK_FILE_MAGIC = 0x4D464331; // "MFC1"
+
+  struct ChunkFileHeader
+  {
+    std::uint32_t magic;
+    std::uint32_t chunkID;
+    std::uint32_t outputCount;
+    std::uint64_t valueCount;
+  };
+}
+
+mitk::ParameterFitChunkCheckpoint::ParameterFitChunkCheckpoint(const std::string& directory) : m_Directory(directory)
+{
+};
+
+const std::string&
+mitk::ParameterFitChunkCheckpoint::GetDirectory() const
+{
+  return m_Directory;
+};
+
+std::string
+mitk::ParameterFitChunkCheckpoint::GetManifestFilePath() const
+{
+  return m_Directory + "/" + MANIFEST_FILE_NAME;
+};
+
+std::string
+mitk::ParameterFitChunkCheckpoint::GetChunkFilePath(ChunkIDType chunkID) const
+{
+  std::ostringstream stream;
+  stream << m_Directory << "/chunk_" << chunkID << ".bin";
+  return stream.str();
+};
+
+bool
+mitk::ParameterFitChunkCheckpoint::IsValidChunkFile(ChunkIDType chunkID) const
+{
+  std::ifstream file(this->GetChunkFilePath(chunkID), std::ios::binary);
+  if (!file.is_open())
+  {
+    return false;
+  }
+
+  ChunkFileHeader header;
+  file.read(reinterpret_cast<char*>(&header), sizeof(ChunkFileHeader));
+  if (!file || header.magic != CHUNK_FILE_MAGIC || header.chunkID != chunkID)
+  {
+    return false;
+  }
+
+  const auto expectedSize = sizeof(ChunkFileHeader) + header.outputCount * header.valueCount * sizeof(ValueType);
+  file.seekg(0, std::ios::end);
+  return static_cast<std::uint64_t>(file.tellg()) == expectedSize;
+};
+
+void
+mitk::ParameterFitChunkCheckpoint::Initialize(const std::string& signature, ChunkIDType chunkCount)
+{
+  if (m_Directory.empty())
+  {
+    mitkThrow() << "Cannot initialize parameter fit checkpoint. Checkpoint directory is not set.";
+  }
+
+  if (!itksys::SystemTools::MakeDirectory(m_Directory))
+  {
+    mitkThrow() << "Cannot initialize parameter fit checkpoint. Unable to create checkpoint directory: " << m_Directory;
+  }
+
+  m_CompletedChunks.assign(chunkCount, false);
+
+  bool isResumable = false;
+  std::ifstream manifest(this->GetManifestFilePath());
+  if (manifest.is_open())
+  {
+    std::string header;
+    std::string storedSignature;
+    ChunkIDType storedChunkCount = 0;
+    std::getline(manifest, header);
+    std::getline(manifest, storedSignature);
+    manifest >> storedChunkCount;
+
+    isResumable = manifest && header == MANIFEST_HEADER && storedSignature == signature && storedChunkCount == chunkCount;
+    manifest.close();
+  }
+
+  if (isResumable)
+  {
+    for (ChunkIDType chunkID = 0; chunkID < chunkCount; ++chunkID)
+    {
+      m_CompletedChunks[chunkID] = this->IsValidChunkFile(chunkID);
+    }
+    MITK_INFO << "Parameter fit checkpoint found in " << m_Directory << ". Resuming fit; completed chunks: " << this->GetNumberOfCompletedChunks() << "/" << chunkCount;
+  }
+  else
+  {
+    this->Clear();
+    m_CompletedChunks.assign(chunkCount, false);
+
+    std::ofstream newManifest(this->GetManifestFilePath(), std::ios::trunc);
+    newManifest << MANIFEST_HEADER << std::endl << signature << std::endl << chunkCount << std::endl;
+    if (!newManifest)
+    {
+      mitkThrow() << "Cannot initialize parameter fit checkpoint. Unable to write manifest file: " << this->GetManifestFilePath();
+    }
+  }
+};
+
+bool
+mitk::ParameterFitChunkCheckpoint::IsChunkCompleted(ChunkIDType chunkID) const
+{
+  return chunkID < m_CompletedChunks.size() && m_CompletedChunks[chunkID];
+};
+
+mitk::ParameterFitChunkCheckpoint::ChunkIDType
+mitk::ParameterFitChunkCheckpoint::GetNumberOfCompletedChunks() const
+{
+  ChunkIDType result = 0;
+  for (const auto completed : m_CompletedChunks)
+  {
+    if (completed)
+    {
+      ++result;
+    }
+  }
+  return result;
+};
+
+void
+mitk::ParameterFitChunkCheckpoint::StoreChunk(ChunkIDType chunkID, const ChunkValuesType& values)
+{
+  if (chunkID >= m_CompletedChunks.size())
+  {
+    mitkThrow() << "Cannot store chunk in parameter fit checkpoint. Invalid chunk ID: " << chunkID << "; chunk count: " << m_CompletedChunks.size();
+  }
+
+  ChunkFileHeader header;
+  header.magic = CHUNK_FILE_MAGIC;
+  header.chunkID = chunkID;
+  header.outputCount = static_cast<std::uint32_t>(values.size());
+  header.valueCount = values.empty() ? 0 : values.front().size();
+
+  const std::string filePath = this->GetChunkFilePath(chunkID);
+  const std::string tempFilePath = filePath + ".tmp";
+
+  {
+    std::ofstream file(tempFilePath, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(ChunkFileHeader));
+    for (const auto& outputValues : values)
+    {
+      if (outputValues.size() != header.valueCount)
+      {
+        mitkThrow() << "Cannot store chunk in parameter fit checkpoint. Outputs of chunk have different sizes.";
+      }
+      file.write(reinterpret_cast<const char*>(outputValues.data()), outputValues.size() * sizeof(ValueType));
+    }
+
+    if (!file)
+    {
+      mitkThrow() << "Cannot store chunk in parameter fit checkpoint. Unable to write file: " << tempFilePath;
+    }
+  }
+
+  std::remove(filePath.c_str());
+  if (std::rename(tempFilePath.c_str(), filePath.c_str()) != 0)
+  {
+    mitkThrow() << "Cannot store chunk in parameter fit checkpoint. Unable to rename file " << tempFilePath << " to " << filePath;
+  }
+
+  m_CompletedChunks[chunkID] = true;
+};
+
+mitk::ParameterFitChunkCheckpoint::ChunkValuesType
+mitk::ParameterFitChunkCheckpoint::LoadChunk(ChunkIDType chunkID) const
+{
+  if (!this->IsChunkCompleted(chunkID))
+  {
+    mitkThrow() << "Cannot load chunk from parameter fit checkpoint. Chunk is not completed. Chunk ID: " << chunkID;
+  }
+
+  std::ifstream file(this->GetChunkFilePath(chunkID), std::ios::binary);
+  ChunkFileHeader header;
+  file.read(reinterpret_cast<char*>(&header), sizeof(ChunkFileHeader));
+  if (!file || header.magic != CHUNK_FILE_MAGIC || header.chunkID != chunkID)
+  {
+    mitkThrow() << "Cannot load chunk from parameter fit checkpoint. Invalid chunk file: " << this->GetChunkFilePath(chunkID);
+  }
+
+  ChunkValuesType result(header.outputCount, std::vector<ValueType>(header.valueCount));
+  for (auto& outputValues : result)
+  {
+    file.read(reinterpret_cast<char*>(outputValues.data()), outputValues.size() * sizeof(ValueType));
+  }
+
+  if (!file)
+  {
+    mitkThrow() << "Cannot load chunk from parameter fit checkpoint. Chunk file is truncated: " << this->GetChunkFilePath(chunkID);
+  }
+
+  return result;
+};
+
+void
+mitk::ParameterFitChunkCheckpoint::Clear()
+{
+  for (ChunkIDType chunkID = 0; chunkID < m_CompletedChunks.size(); ++chunkID)
+  {
+    std::remove(this->GetChunkFilePath(chunkID).c_str());
+    std::remove((this->GetChunkFilePath(chunkID) + ".tmp").c_str());
+  }
+  std::remove(this->GetManifestFilePath().c_str());
+
+  m_CompletedChunks.assign(m_CompletedChunks.size(), false);
+};
@@ -10,7 +10,14 @@ found in the LICENSE file.
 
 ============================================================================*/
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <sstream>
+
 #include "itkCommand.h"
+#include "itkImageRegionIterator.h"
 #include "itkMultiOutputNaryFunctorImageFilter.h"
 
 #include "mitkPixelBasedParameterFitImageGenerator.h"
@@ -20,6 +27,35 @@ found in the LICENSE file.
 #include "mitkModelFitFunctorPolicy.h"
 
 #include "mitkExtractTimeGrid.h"
+#include "mitkParameterFitChunkCheckpoint.h"
+
+namespace
+{
+  const std::uint64_t SIGNATURE_HASH_SEED = 14695981039346656037ULL;
+
+  /** Folds a memory block into a FNV-1a like hash (processed in 64 bit words). It is used to identify the
+   content of the fit inputs in the signature of a chunked fit.*/
+  std::uint64_t HashBuffer(const void* buffer, std::size_t size, std::uint64_t hash)
+  {
+    const std::uint64_t prime = 1099511628211ULL;
+    const auto* bytes = static_cast<const unsigned char*>(buffer);
+
+    std::size_t pos = 0;
+    for (; pos + sizeof(std::uint64_t) <= size; pos += sizeof(std::uint64_t))
+    {
+      std::uint64_t word;
+      std::memcpy(&word, bytes + pos, sizeof(word));
+      hash = (hash ^ word) * prime;
+      hash ^= hash >> 32;
+    }
+    for (; pos < size; ++pos)
+    {
+      hash = (hash ^ bytes[pos]) * prime;
+    }
+
+    return hash;
+  }
+}
 
 void
   mitk::PixelBasedParameterFitImageGenerator::
@@ -30,7 +66,20 @@ void
   auto* process = dynamic_cast<itk::ProcessObject*>(caller);
   if (process)
   {
-    this->m_Progress = process->GetProgress();
+    this->m_Progress = this->m_ChunkProgressOffset + this->m_ChunkProgressScale * process->GetProgress();
+    this->UpdateFitSpeed();
+  }
+};
+
+void
+  mitk::PixelBasedParameterFitImageGenerator::UpdateFitSpeed()
+{
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - this->m_FitStartTime;
+  const double fittedVoxels = this->m_Progress * this->m_TotalVoxels - this->m_RestoredVoxels;
+
+  if (elapsed.count() > 0 && fittedVoxels > 0)
+  {
+    this->m_VoxelsPerSecond = fittedVoxels / elapsed.count();
   }
 };
 
@@ -77,6 +126,150 @@ mitk::PixelBasedParameterFitImageGenerator::ParameterImageMapType StoreResultIma
   return result;
 }
 
+template<typename TImage>
+mitk::PixelBasedParameterFitImageGenerator::ParameterImageMapType StoreResultImages(mitk::ModelFitFunctorBase::ParameterNamesType &paramNames, const std::vector<typename TImage::Pointer>& outputs, mitk::ModelFitFunctorBase::ParameterNamesType::size_type startPos, mitk::ModelFitFunctorBase::ParameterNamesType::size_type& endPos)
+{
+  mitk::PixelBasedParameterFitImageGenerator::ParameterImageMapType result;
+  for (mitk::ModelFitFunctorBase::ParameterNamesType::size_type j = 0; j < paramNames.size(); ++j)
+  {
+    if (outputs.size() <= startPos + j)
+    {
+      mitkThrow() << "Error while generating fitted parameter images. Number of chunk outputs is too low and does not match expected parameter number. Output size: " << outputs.size() << "; number of param names: " << paramNames.size() << ";source start pos: " << startPos;
+    }
+
+    mitk::Image::Pointer paramImage = mitk::Image::New();
+    mitk::CastToMitkImage(outputs[startPos + j], paramImage);
+
+    result.insert(std::make_pair(paramNames[j], paramImage));
+  }
+
+  endPos = startPos + paramNames.size();
+
+  return result;
+}
+
+template <typename TFitFilter>
+void
+  mitk::PixelBasedParameterFitImageGenerator::DoChunkedFit(TFitFilter* fitFilter, const std::string& fitSignature, std::vector<typename TFitFilter::OutputImageType::Pointer>& outputs)
+{
+  using OutputImageType = typename TFitFilter::OutputImageType;
+  using RegionType = typename OutputImageType::RegionType;
+  using SizeValueType = typename RegionType::SizeValueType;
+  //chunks are slabs along the slowest (last) dimension, thus every chunk is a contiguous memory block.
+  const unsigned int chunkDim = OutputImageType::ImageDimension - 1;
+
+  fitFilter->UpdateOutputInformation();
+  const RegionType largestRegion = fitFilter->GetOutput()->GetLargestPossibleRegion();
+  const SizeValueType sliceCount = largestRegion.GetSize(chunkDim);
+  const auto chunkCount = static_cast<ParameterFitChunkCheckpoint::ChunkIDType>((sliceCount + m_ChunkSliceCount - 1) / m_ChunkSliceCount);
+  const auto outputCount = fitFilter->GetNumberOfIndexedOutputs();
+
+  //The assembled outputs have full size. They are not initialized, because every voxel is written by exactly one chunk.
+  outputs.clear();
+  for (unsigned int i = 0; i < outputCount; ++i)
+  {
+    typename OutputImageType::Pointer output = OutputImageType::New();
+    output->CopyInformation(fitFilter->GetOutput(i));
+    output->SetRegions(largestRegion);
+    output->Allocate();
+    outputs.push_back(output);
+  }
+
+  std::unique_ptr<ParameterFitChunkCheckpoint> checkpoint;
+  if (!m_CheckpointDirectory.empty())
+  {
+    checkpoint.reset(new ParameterFitChunkCheckpoint(m_CheckpointDirectory));
+    checkpoint->Initialize(fitSignature, chunkCount);
+  }
+
+  double processedVoxels = 0;
+
+  for (ParameterFitChunkCheckpoint::ChunkIDType chunkID = 0; chunkID < chunkCount; ++chunkID)
+  {
+    const SizeValueType chunkStart = chunkID * m_ChunkSliceCount;
+    RegionType chunkRegion = largestRegion;
+    chunkRegion.SetIndex(chunkDim, largestRegion.GetIndex(chunkDim) + chunkStart);
+    chunkRegion.SetSize(chunkDim, std::min<SizeValueType>(m_ChunkSliceCount, sliceCount - chunkStart));
+    const auto chunkVoxels = chunkRegion.GetNumberOfPixels();
+
+    if (checkpoint && checkpoint->IsChunkCompleted(chunkID))
+    {
+      ParameterFitChunkCheckpoint::ChunkValuesType values = checkpoint->LoadChunk(chunkID);
+
+      if (values.size() != outputCount)
+      {
+        mitkThrow() << "Cannot restore chunk #" << chunkID << " from checkpoint. Number of stored outputs does not match the fit. Stored outputs: " << values.size() << "; expected: " << outputCount;
+      }
+
+      for (unsigned int i = 0; i < outputCount; ++i)
+      {
+        if (values[i].size() != chunkVoxels)
+        {
+          mitkThrow() << "Cannot restore chunk #" << chunkID << " from checkpoint. Number of stored voxels does not match the chunk region. Stored voxels: " << values[i].size() << "; expected: " << chunkVoxels;
+        }
+
+        itk::ImageRegionIterator<OutputImageType> outputIt(outputs[i], chunkRegion);
+        for (auto valueIt = values[i].cbegin(); !outputIt.IsAtEnd(); ++outputIt, ++valueIt)
+        {
+          outputIt.Set(*valueIt);
+        }
+      }
+
+      this->m_RestoredVoxels += chunkVoxels;
+    }
+    else
+    {
+      this->m_ChunkProgressOffset = processedVoxels / this->m_TotalVoxels;
+      this->m_ChunkProgressScale = chunkVoxels / this->m_TotalVoxels;
+
+      fitFilter->GetOutput()->SetRequestedRegion(chunkRegion);
+      fitFilter->GetOutput()->Update();
+
+      ParameterFitChunkCheckpoint::ChunkValuesType values(outputCount);
+      for (unsigned int i = 0; i < outputCount; ++i)
+      {
+        itk::ImageRegionConstIterator<OutputImageType> chunkIt(fitFilter->GetOutput(i), chunkRegion);
+        itk::ImageRegionIterator<OutputImageType> outputIt(outputs[i], chunkRegion);
+
+        if (checkpoint)
+        {
+          values[i].reserve(chunkVoxels);
+        }
+
+        for (; !chunkIt.IsAtEnd(); ++chunkIt, ++outputIt)
+        {
+          outputIt.Set(chunkIt.Get());
+          if (checkpoint)
+          {
+            values[i].push_back(chunkIt.Get());
+          }
+        }
+      }
+
+      //the chunk is copied, thus the chunk sized buffers of the fit filter are released
+      for (unsigned int i = 0; i < outputCount; ++i)
+      {
+        fitFilter->GetOutput(i)->ReleaseData();
+      }
+
+      if (checkpoint)
+      {
+        checkpoint->StoreChunk(chunkID, values);
+      }
+    }
+
+    processedVoxels += chunkVoxels;
+    this->m_Progress = processedVoxels / this->m_TotalVoxels;
+    this->UpdateFitSpeed();
+    this->InvokeEvent(::itk::ProgressEvent());
+
+    MITK_DEBUG << "Parameter Fit Generator. Finished chunk " << chunkID + 1 << "/" << chunkCount << "; voxels/s: " << this->GetVoxelsPerSecond() << "; estimated remaining time (s): " << this->GetEstimatedRemainingTime();
+  }
+
+  this->m_ChunkProgressOffset = 0;
+  this->m_ChunkProgressScale = 1;
+}
+
 template <typename TPixel, unsigned int VDim>
 void
   mitk::PixelBasedParameterFitImageGenerator::DoParameterFit(itk::Image<TPixel, VDim>* /*image*/)
@@ -122,21 +315,21 @@ void
     this->m_ModelParameterizer->SetDefaultTimeGrid(timeGrid);
   }
 
+  ModelBaseType::Pointer refModel = this->m_ModelParameterizer->GenerateParameterizedModel();
+
+  this->m_WarmStartCache->Initialize(fitFilter->GetInput(0)->GetLargestPossibleRegion(), refModel->GetNumberOfParameters(), this->m_WarmStart);
+
   ModelFitFunctorPolicy functor;
 
   functor.SetModelFitFunctor(this->m_FitFunctor);
   functor.SetModelParameterizer(this->m_ModelParameterizer);
+  functor.SetWarmStartCache(this->m_WarmStartCache);
   fitFilter->SetFunctor(functor);
   if (this->m_InternalMask.IsNotNull())
   {
     fitFilter->SetMask(this->m_InternalMask);
   }
 
-  //generate the fits
-  fitFilter->Update();
-
-  //convert the outputs into mitk images and fill the parameter image map
-  ModelBaseType::Pointer refModel = this->m_ModelParameterizer->GenerateParameterizedModel();
   ModelFitFunctorBase::ParameterNamesType paramNames = refModel->GetParameterNames();
   ModelFitFunctorBase::ParameterNamesType derivedParamNames = refModel->GetDerivedParameterNames();
   ModelFitFunctorBase::ParameterNamesType criterionNames = this->m_FitFunctor->GetCriterionNames();
@@ -149,13 +342,82 @@ void
   }
 
   ModelFitFunctorBase::ParameterNamesType::size_type resultPos = 0;
-  this->m_TempResultMap = StoreResultImages<ParameterImageType>(paramNames,fitFilter,resultPos, resultPos);
-  this->m_TempDerivedResultMap = StoreResultImages<ParameterImageType>(derivedParamNames,fitFilter,resultPos, resultPos);
-  this->m_TempCriterionResultMap = StoreResultImages<ParameterImageType>(criterionNames,fitFilter,resultPos, resultPos);
-  this->m_TempEvaluationResultMap = StoreResultImages<ParameterImageType>(evaluationParamNames,fitFilter,resultPos, resultPos);
-  //also add debug params (if generated) to the evaluation result map
-  mitk::PixelBasedParameterFitImageGenerator::ParameterImageMapType debugMap = StoreResultImages<ParameterImageType>(debugParamNames, fitFilter, resultPos, resultPos);
-  this->m_TempEvaluationResultMap.insert(debugMap.begin(), debugMap.end());
+
+  if (this->m_ChunkSliceCount == 0)
+  {
+    //generate the fits
+    fitFilter->Update();
+
+    //convert the outputs into mitk images and fill the parameter image map
+    this->m_TempResultMap = StoreResultImages<ParameterImageType>(paramNames,fitFilter,resultPos, resultPos);
+    this->m_TempDerivedResultMap = StoreResultImages<ParameterImageType>(derivedParamNames,fitFilter,resultPos, resultPos);
+    this->m_TempCriterionResultMap = StoreResultImages<ParameterImageType>(criterionNames,fitFilter,resultPos, resultPos);
+    this->m_TempEvaluationResultMap = StoreResultImages<ParameterImageType>(evaluationParamNames,fitFilter,resultPos, resultPos);
+    //also add debug params (if generated) to the evaluation result map
+    mitk::PixelBasedParameterFitImageGenerator::ParameterImageMapType debugMap = StoreResultImages<ParameterImageType>(debugParamNames, fitFilter, resultPos, resultPos);
+    this->m_TempEvaluationResultMap.insert(debugMap.begin(), debugMap.end());
+  }
+  else
+  {
+    //the signature identifies the fit setup, to ensure that only chunks of an identical fit are resumed.
+    //It covers the content of the inputs, the global parameterization and all settings of the functor; it must
+    //be one line, as it is stored as one line in the checkpoint manifest. Parameterizations defined per voxel
+    //are not covered (see SetCheckpointDirectory()).
+    std::ostringstream signature;
+    signature.precision(17);
+    signature << "model=" << refModel->GetClassID() << ";functor=" << this->m_FitFunctor->GetSettingsSignature()
+      << ";size=" << m_DynamicImage->GetDimension(0) << "x" << m_DynamicImage->GetDimension(1) << "x" << m_DynamicImage->GetDimension(2)
+      << "x" << m_DynamicImage->GetTimeSteps() << ";chunkSlices=" << m_ChunkSliceCount << ";masked=" << m_InternalMask.IsNotNull() << ";outputs=";
+    for (const auto& names : { paramNames, derivedParamNames, criterionNames, evaluationParamNames, debugParamNames })
+    {
+      for (const auto& name : names)
+      {
+        signature << name << ",";
+      }
+    }
+
+    std::uint64_t contentHash = SIGNATURE_HASH_SEED;
+    for (unsigned int i = 0; i < fitFilter->GetNumberOfIndexedInputs(); ++i)
+    {
+      const InputFrameImageType* frame = fitFilter->GetInput(i);
+      contentHash = HashBuffer(frame->GetBufferPointer(), frame->GetBufferedRegion().GetNumberOfPixels() * sizeof(TPixel), contentHash);
+    }
+    if (this->m_InternalMask.IsNotNull())
+    {
+      contentHash = HashBuffer(this->m_InternalMask->GetBufferPointer(), this->m_InternalMask->GetBufferedRegion().GetNumberOfPixels() * sizeof(InternalMaskType::PixelType), contentHash);
+    }
+    signature << ";content=" << std::hex << contentHash << std::dec;
+
+    signature << ";timeGrid=";
+    for (const double timePoint : this->m_ModelParameterizer->GetDefaultTimeGrid())
+    {
+      signature << timePoint << ",";
+    }
+
+    signature << ";parameterizer=" << this->m_ModelParameterizer->GetNameOfClass() << "(";
+    for (const auto& staticParam : this->m_ModelParameterizer->GetGlobalStaticParameters())
+    {
+      signature << staticParam.first << ":";
+      for (const double value : staticParam.second)
+      {
+        signature << value << ",";
+      }
+      signature << ";";
+    }
+
+    signature << ")";
+
+    std::vector<typename ParameterImageType::Pointer> outputs;
+    this->DoChunkedFit(fitFilter.GetPointer(), signature.str(), outputs);
+
+    this->m_TempResultMap = StoreResultImages<ParameterImageType>(paramNames, outputs, resultPos, resultPos);
+    this->m_TempDerivedResultMap = StoreResultImages<ParameterImageType>(derivedParamNames, outputs, resultPos, resultPos);
+    this->m_TempCriterionResultMap = StoreResultImages<ParameterImageType>(criterionNames, outputs, resultPos, resultPos);
+    this->m_TempEvaluationResultMap = StoreResultImages<ParameterImageType>(evaluationParamNames, outputs, resultPos, resultPos);
+    //also add debug params (if generated) to the evaluation result map
+    mitk::PixelBasedParameterFitImageGenerator::ParameterImageMapType debugMap = StoreResultImages<ParameterImageType>(debugParamNames, outputs, resultPos, resultPos);
+    this->m_TempEvaluationResultMap.insert(debugMap.begin(), debugMap.end());
+  }
 }
 
 bool
@@ -214,6 +476,12 @@ void
 void mitk::PixelBasedParameterFitImageGenerator::DoFitAndGetResults(ParameterImageMapType& parameterImages, ParameterImageMapType& derivedParameterImages, ParameterImageMapType& criterionImages, ParameterImageMapType& evaluationParameterImages)
 {
   this->m_Progress = 0;
+  this->m_ChunkProgressOffset = 0;
+  this->m_ChunkProgressScale = 1;
+  this->m_TotalVoxels = static_cast<double>(m_DynamicImage->GetDimension(0)) * m_DynamicImage->GetDimension(1) * m_DynamicImage->GetDimension(2);
+  this->m_RestoredVoxels = 0;
+  this->m_VoxelsPerSecond = 0;
+  this->m_FitStartTime = std::chrono::steady_clock::now();
 
   if(this->m_Mask.IsNotNull())
   {
@@ -226,6 +494,10 @@ void mitk::PixelBasedParameterFitImageGenerator::DoFitAndGetResults(ParameterIma
 
   AccessFixedDimensionByItk(m_DynamicImage, mitk::PixelBasedParameterFitImageGenerator::DoParameterFit, 4);
 
+  const FitStatisticsType statistics = this->GetFitStatistics();
+  MITK_DEBUG << "Parameter Fit Generator. Fitted voxels: " << statistics.FitCount << "; warm started: " << statistics.WarmStartCount
+    << "; mean iterations (cold start): " << statistics.GetMeanColdStartIterations() << "; mean iterations (warm start): " << statistics.GetMeanWarmStartIterations();
+
   parameterImages = this->m_TempResultMap;
   derivedParameterImages = this->m_TempDerivedResultMap;
   criterionImages = this->m_TempCriterionResultMap;
@@ -239,6 +511,29 @@ double
   return m_Progress;
 };
 
+mitk::PixelBasedParameterFitImageGenerator::FitStatisticsType
+  mitk::PixelBasedParameterFitImageGenerator::GetFitStatistics() const
+{
+  return m_WarmStartCache->GetStatistics();
+};
+
+double
+  mitk::PixelBasedParameterFitImageGenerator::GetVoxelsPerSecond() const
+{
+  return m_VoxelsPerSecond;
+};
+
+double
+  mitk::PixelBasedParameterFitImageGenerator::GetEstimatedRemainingTime() const
+{
+  if (m_VoxelsPerSecond <= 0)
+  {
+    return -1;
+  }
+
+  return (1. - m_Progress) * m_TotalVoxels / m_VoxelsPerSecond;
+};
+
 mitk::PixelBasedParameterFitImageGenerator::ParameterNamesType
 mitk::PixelBasedParameterFitImageGenerator::GetParameterNames() const
 {
@@ -26,3 +26,9 @@ mitk::ConstraintCheckerBase::PenaltyValueType
 
   return result;
 };
+
+std::string
+  mitk::ConstraintCheckerBase::GetSettingsSignature() const
+{
+  return this->GetNameOfClass();
+};
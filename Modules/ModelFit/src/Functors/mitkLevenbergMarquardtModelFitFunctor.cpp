@@ -15,6 +15,7 @@ found in the LICENSE file.
 #include "mitkSquaredDifferencesFitCostFunction.h"
 #include "mitkSumOfSquaredDifferencesFitCostFunction.h"
 #include <chrono>
+#include <sstream>
 #include <mitkExceptionMacro.h>
 
 mitk::LevenbergMarquardtModelFitFunctor::
@@ -36,6 +37,29 @@ GetCriterionNames() const
   return names;
 };
 
+std::string
+mitk::LevenbergMarquardtModelFitFunctor::
+GetSettingsSignature() const
+{
+  std::ostringstream signature;
+  signature.precision(17);
+  signature << Superclass::GetSettingsSignature() << "(epsilon=" << m_Epsilon << ";gradientTolerance=" << m_GradientTolerance
+    << ";valueTolerance=" << m_ValueTolerance << ";iterations=" << m_Iterations << ";derivativeStepLength=" << m_DerivativeStepLength
+    << ";scales=";
+  for (const auto& scale : m_Scales)
+  {
+    signature << scale << ",";
+  }
+  signature << ";failureThreshold=" << m_ActivateFailureThreshold << ";constraints=";
+  if (m_ConstraintChecker.IsNotNull())
+  {
+    signature << m_ConstraintChecker->GetSettingsSignature();
+  }
+  signature << ")";
+
+  return signature.str();
+};
+
 mitk::LevenbergMarquardtModelFitFunctor::OutputPixelArrayType
 mitk::LevenbergMarquardtModelFitFunctor::
 GetCriteria(const ModelBase* model, const ParametersType& parameters,
@@ -85,7 +109,7 @@ mitk::LevenbergMarquardtModelFitFunctor::DefineDebugParameterNames() const
 {
   ParameterNamesType result;
   result.push_back("optimization_time");
-  result.push_back("nr_of_iterations");
+  result.push_back(ITERATIONS_DEBUG_PARAMETER_NAME);
   result.push_back("stop_condition");
   if (m_ConstraintChecker.IsNotNull())
   {
@@ -141,26 +165,29 @@ DoModelFit(const SignalType& value, const ModelBase* model,
   std::chrono::time_point<std::chrono::system_clock> stopTime;
   stopTime = std::chrono::system_clock::now();
   debugParameters.clear();
+
+  //the iterations are always reported (see ModelFitFunctorBase::ITERATIONS_DEBUG_PARAMETER_NAME)
+  const ParameterImagePixelType iterations = optimizer->GetOptimizer()->get_num_iterations();
+  debugParameters.insert(std::make_pair(ITERATIONS_DEBUG_PARAMETER_NAME, iterations));
+
   if (this->GetDebugParameterMaps())
   {
     const auto timeDiff = std::chrono::duration_cast<std::chrono::milliseconds>(stopTime - startTime).count();
     debugParameters.insert(std::make_pair("optimization_time", timeDiff));
 
-    ParameterImagePixelType value = optimizer->GetOptimizer()->get_num_iterations();
-    debugParameters.insert(std::make_pair("nr_of_iterations", value));
-    value = optimizer->GetOptimizer()->get_failure_code();
-    debugParameters.insert(std::make_pair("stop_condition", value));
+    ParameterImagePixelType debugValue = optimizer->GetOptimizer()->get_failure_code();
+    debugParameters.insert(std::make_pair("stop_condition", debugValue));
 
 
     const ::mitk::MVConstrainedCostFunctionDecorator* decorator = dynamic_cast<const ::mitk::MVConstrainedCostFunctionDecorator*>(metric.GetPointer());
     if (decorator)
     {
-      value = decorator->GetPenaltyRatio();
-      debugParameters.insert(std::make_pair("constraint_penalty_ratio", value));
-      value = decorator->GetFailureRatio();
-      debugParameters.insert(std::make_pair("constraint_failure_ratio", value));
-      value = decorator->GetFailedParameter();
-      debugParameters.insert(std::make_pair("constraint_last_failed_parameter", value));
+      debugValue = decorator->GetPenaltyRatio();
+      debugParameters.insert(std::make_pair("constraint_penalty_ratio", debugValue));
+      debugValue = decorator->GetFailureRatio();
+      debugParameters.insert(std::make_pair("constraint_failure_ratio", debugValue));
+      debugValue = decorator->GetFailedParameter();
+      debugParameters.insert(std::make_pair("constraint_last_failed_parameter", debugValue));
     }
     else
     {
@@ -12,10 +12,23 @@ found in the LICENSE file.
 
 #include "mitkModelFitFunctorBase.h"
 
+#include <sstream>
+
+const std::string mitk::ModelFitFunctorBase::ITERATIONS_DEBUG_PARAMETER_NAME = "nr_of_iterations";
+
 mitk::ModelFitFunctorBase::OutputPixelArrayType
 mitk::ModelFitFunctorBase::
 Compute(const InputPixelArrayType& value, const ModelBase* model,
         const ModelBase::ParametersType& initialParameters) const
+{
+  ParameterImagePixelType iterations;
+  return this->Compute(value, model, initialParameters, iterations);
+};
+
+mitk::ModelFitFunctorBase::OutputPixelArrayType
+mitk::ModelFitFunctorBase::
+Compute(const InputPixelArrayType& value, const ModelBase* model,
+        const ModelBase::ParametersType& initialParameters, ParameterImagePixelType& iterations) const
 {
   if (!model)
   {
@@ -44,6 +57,9 @@ Compute(const InputPixelArrayType& value, const ModelBase* model,
 
   ParametersType fittedParameters = DoModelFit(sample, model, initialParameters, debugParams);
 
+  DebugParameterMapType::const_iterator iterationsPos = debugParams.find(ITERATIONS_DEBUG_PARAMETER_NAME);
+  iterations = iterationsPos != debugParams.end() ? iterationsPos->second : -1;
+
   OutputPixelArrayType derivedParameters = this->GetDerivedParameters(model, fittedParameters);
 
   OutputPixelArrayType criteria = this->GetCriteria(model, fittedParameters, sample);
@@ -239,3 +255,25 @@ mitk::ModelFitFunctorBase::GetEvaluationParameters(const ModelBase* model,
 
   return result;
 };
+
+std::string
+mitk::ModelFitFunctorBase::GetSettingsSignature() const
+{
+  std::ostringstream signature;
+  signature.precision(17);
+  signature << this->GetNameOfClass() << "(debug=" << m_DebugParameterMaps << ";evaluation=";
+
+  m_Mutex.Lock();
+
+  for (CostFunctionMapType::const_iterator pos = m_CostFunctionMap.begin();
+       pos != m_CostFunctionMap.end(); ++pos)
+  {
+    signature << pos->first << ":" << pos->second->GetNameOfClass() << ",";
+  }
+
+  m_Mutex.Unlock();
+
+  signature << ")";
+
+  return signature.str();
+};
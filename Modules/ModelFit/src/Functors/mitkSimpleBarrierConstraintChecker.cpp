@@ -13,6 +13,7 @@ found in the LICENSE file.
 #include "mitkSimpleBarrierConstraintChecker.h"
 
 #include <algorithm>
+#include <sstream>
 
 #include "mitkExceptionMacro.h"
 
@@ -43,6 +44,25 @@ mitk::SimpleBarrierConstraintChecker::GetFailedConstraintValue() const
   return m_MaxConstraintPenalty;
 };
 
+std::string mitk::SimpleBarrierConstraintChecker::GetSettingsSignature() const
+{
+  std::ostringstream signature;
+  signature.precision(17);
+  signature << Superclass::GetSettingsSignature() << "(maxPenalty=" << m_MaxConstraintPenalty << ";";
+  for (const auto& constraint : m_Constraints)
+  {
+    signature << (constraint.upperBarrier ? "upper" : "lower") << "[";
+    for (const auto& parameter : constraint.parameters)
+    {
+      signature << parameter << ",";
+    }
+    signature << "]" << constraint.barrier << "/" << constraint.width << ";";
+  }
+  signature << ")";
+
+  return signature.str();
+};
+
 void mitk::SimpleBarrierConstraintChecker::SetLowerBarrier(ParameterIndexType parameterID,
     BarrierValueType barrier, BarrierWidthType width)
 {
@@ -13,10 +13,13 @@ found in the LICENSE file.
 #include <iostream>
 
 #include "itkImageRegionIterator.h"
+#include "itksys/SystemTools.hxx"
 
 #include "mitkTestingMacros.h"
 #include "mitkImage.h"
 #include "mitkImagePixelReadAccessor.h"
+#include "mitkImageWriteAccessor.h"
+#include "mitkIOUtil.h"
 
 #include "mitkPixelBasedParameterFitImageGenerator.h"
 #include "mitkLinearModelParameterizer.h"
@@ -151,5 +154,125 @@ int mitkPixelBasedParameterFitImageGeneratorTest(int  /*argc*/, char*[] /*argv[]
     testValue = offsetAccessor2.GetPixelByIndex(testIndex6);
     MITK_TEST_CONDITION_REQUIRED(mitk::Equal(0,testValue, 1e-5, true)==true, "Check param #2 (offset) at index #6");
 
+    //Test warm start
+    generator->SetMask(nullptr);
+    generator->WarmStartOn();
+
+    generator->Generate();
+
+    mitk::PixelBasedParameterFitImageGenerator::FitStatisticsType statistics = generator->GetFitStatistics();
+    CPPUNIT_ASSERT_MESSAGE("Check number of fits of warm started fit", 27 == statistics.FitCount);
+    MITK_TEST_CONDITION(statistics.WarmStartCount > 0, "Check if voxels were warm started.");
+    MITK_TEST_CONDITION(statistics.ColdStartIterations + statistics.WarmStartIterations > 0, "Check if iterations were reported.");
+
+    resultImages = generator->GetParameterImages();
+    mitk::ImagePixelReadAccessor<mitk::ScalarType,3> slopeAccessorWarm(resultImages["slope"]);
+    mitk::ImagePixelReadAccessor<mitk::ScalarType,3> offsetAccessorWarm(resultImages["offset"]);
+
+    testValue = slopeAccessorWarm.GetPixelByIndex(testIndex2);
+    MITK_TEST_CONDITION_REQUIRED(mitk::Equal(2000,testValue, 1e-4, true)==true, "Check param #1 (slope) at index #2 (warm start)");
+    testValue = slopeAccessorWarm.GetPixelByIndex(testIndex4);
+    MITK_TEST_CONDITION_REQUIRED(mitk::Equal(8000,testValue, 1e-4, true)==true, "Check param #1 (slope) at index #4 (warm start)");
+    testValue = offsetAccessorWarm.GetPixelByIndex(testIndex3);
+    MITK_TEST_CONDITION_REQUIRED(mitk::Equal(20,testValue, 1e-5, true)==true, "Check param #2 (offset) at index #3 (warm start)");
+
+    generator->WarmStartOff();
+
+    //Test chunked fit with checkpoint
+    std::string checkpointDir = mitk::IOUtil::CreateTemporaryDirectory("ModelFitCheckpointTest_XXXXXX");
+    generator->SetChunkSliceCount(2);
+    generator->SetCheckpointDirectory(checkpointDir);
+
+    generator->Generate();
+
+    MITK_TEST_CONDITION(mitk::Equal(1.0, generator->GetProgress(), 1e-5, true), "Check progress of chunked fit.");
+    MITK_TEST_CONDITION(generator->GetVoxelsPerSecond() > 0, "Check if fitting speed of chunked fit was measured.");
+    MITK_TEST_CONDITION(mitk::Equal(0.0, generator->GetEstimatedRemainingTime(), 1e-5, true), "Check estimated remaining time of finished chunked fit.");
+
+    resultImages = generator->GetParameterImages();
+    CPPUNIT_ASSERT_MESSAGE("Check number of parameter images of chunked fit", 2 == resultImages.size());
+
+    mitk::ImagePixelReadAccessor<mitk::ScalarType,3> slopeAccessor3(resultImages["slope"]);
+    mitk::ImagePixelReadAccessor<mitk::ScalarType,3> offsetAccessor3(resultImages["offset"]);
+
+    testValue = slopeAccessor3.GetPixelByIndex(testIndex2);
+    MITK_TEST_CONDITION_REQUIRED(mitk::Equal(2000,testValue, 1e-4, true)==true, "Check param #1 (slope) at index #2 (chunked fit)");
+    testValue = slopeAccessor3.GetPixelByIndex(testIndex3);
+    MITK_TEST_CONDITION_REQUIRED(mitk::Equal(4000,testValue, 1e-4, true)==true, "Check param #1 (slope) at index #3 (chunked fit)");
+    testValue = offsetAccessor3.GetPixelByIndex(testIndex2);
+    MITK_TEST_CONDITION_REQUIRED(mitk::Equal(10,testValue, 1e-5, true)==true, "Check param #2 (offset) at index #2 (chunked fit)");
+    testValue = offsetAccessor3.GetPixelByIndex(testIndex3);
+    MITK_TEST_CONDITION_REQUIRED(mitk::Equal(20,testValue, 1e-5, true)==true, "Check param #2 (offset) at index #3 (chunked fit)");
+
+    //Test resuming from the checkpoint: all chunks are restored, so the results must be identical
+    mitk::PixelBasedParameterFitImageGenerator::Pointer resumeGenerator = mitk::PixelBasedParameterFitImageGenerator::New();
+    resumeGenerator->SetDynamicImage(dynamicImage);
+    resumeGenerator->SetModelParameterizer(parameterizer);
+    resumeGenerator->SetFitFunctor(testFunctor);
+    resumeGenerator->SetChunkSliceCount(2);
+    resumeGenerator->SetCheckpointDirectory(checkpointDir);
+
+    resumeGenerator->Generate();
+
+    MITK_TEST_CONDITION(mitk::Equal(0.0, resumeGenerator->GetVoxelsPerSecond(), 1e-5, true), "Check that no voxel was fitted when resuming a completed checkpoint.");
+
+    resultImages = resumeGenerator->GetParameterImages();
+    mitk::ImagePixelReadAccessor<mitk::ScalarType,3> slopeAccessor4(resultImages["slope"]);
+    testValue = slopeAccessor4.GetPixelByIndex(testIndex3);
+    MITK_TEST_CONDITION_REQUIRED(mitk::Equal(4000,testValue, 1e-4, true)==true, "Check param #1 (slope) at index #3 (resumed fit)");
+    testValue = slopeAccessor4.GetPixelByIndex(testIndex4);
+    MITK_TEST_CONDITION_REQUIRED(mitk::Equal(8000,testValue, 1e-4, true)==true, "Check param #1 (slope) at index #4 (resumed fit)");
+
+    //Test that a changed input invalidates the checkpoint: the signal is doubled, so the slopes must double as well
+    mitk::Image::Pointer changedImage = dynamicImage->Clone();
+    {
+      mitk::ImageWriteAccessor changedAccessor(changedImage);
+      auto* changedValues = static_cast<double*>(changedAccessor.GetData());
+      std::size_t valueCount = 1;
+      for (unsigned int i = 0; i < changedImage->GetDimension(); ++i)
+      {
+        valueCount *= changedImage->GetDimension(i);
+      }
+      for (std::size_t i = 0; i < valueCount; ++i)
+      {
+        changedValues[i] *= 2;
+      }
+    }
+
+    mitk::PixelBasedParameterFitImageGenerator::Pointer changedGenerator = mitk::PixelBasedParameterFitImageGenerator::New();
+    changedGenerator->SetDynamicImage(changedImage);
+    changedGenerator->SetModelParameterizer(parameterizer);
+    changedGenerator->SetFitFunctor(testFunctor);
+    changedGenerator->SetChunkSliceCount(2);
+    changedGenerator->SetCheckpointDirectory(checkpointDir);
+
+    changedGenerator->Generate();
+
+    MITK_TEST_CONDITION(changedGenerator->GetVoxelsPerSecond() > 0, "Check that the checkpoint of a different input image is not resumed.");
+
+    resultImages = changedGenerator->GetParameterImages();
+    mitk::ImagePixelReadAccessor<mitk::ScalarType,3> slopeAccessor5(resultImages["slope"]);
+    testValue = slopeAccessor5.GetPixelByIndex(testIndex3);
+    MITK_TEST_CONDITION_REQUIRED(mitk::Equal(8000,testValue, 1e-4, true)==true, "Check param #1 (slope) at index #3 (changed input)");
+    testValue = slopeAccessor5.GetPixelByIndex(testIndex4);
+    MITK_TEST_CONDITION_REQUIRED(mitk::Equal(16000,testValue, 1e-4, true)==true, "Check param #1 (slope) at index #4 (changed input)");
+
+    //Test that changed functor settings invalidate the checkpoint
+    mitk::LevenbergMarquardtModelFitFunctor::Pointer changedFunctor = mitk::LevenbergMarquardtModelFitFunctor::New();
+    changedFunctor->SetIterations(500);
+
+    mitk::PixelBasedParameterFitImageGenerator::Pointer changedFunctorGenerator = mitk::PixelBasedParameterFitImageGenerator::New();
+    changedFunctorGenerator->SetDynamicImage(changedImage);
+    changedFunctorGenerator->SetModelParameterizer(parameterizer);
+    changedFunctorGenerator->SetFitFunctor(changedFunctor);
+    changedFunctorGenerator->SetChunkSliceCount(2);
+    changedFunctorGenerator->SetCheckpointDirectory(checkpointDir);
+
+    changedFunctorGenerator->Generate();
+
+    MITK_TEST_CONDITION(changedFunctorGenerator->GetVoxelsPerSecond() > 0, "Check that the checkpoint of different functor settings is not resumed.");
+
+    itksys::SystemTools::RemoveADirectory(checkpointDir);
+
   MITK_TEST_END()
 }
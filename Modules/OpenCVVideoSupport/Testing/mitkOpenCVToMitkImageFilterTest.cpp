@@ -18,6 +18,7 @@ found in the LICENSE file.
 #include <itkMultiThreader.h>
 #include <itksys/SystemTools.hxx>
 #include <mitkIOUtil.h>
+#include <mitkImagePixelReadAccessor.h>
 #include <opencv2/imgproc.hpp>
 #include <opencv2/imgcodecs.hpp>
 
@@ -121,6 +122,7 @@ class mitkOpenCVToMitkImageFilterTestSuite : public mitk::TestFixture
   CPPUNIT_TEST_SUITE(mitkOpenCVToMitkImageFilterTestSuite);
   MITK_TEST(TestInitialization);
   MITK_TEST(TestThreadSafety);
+  MITK_TEST(TestConversion);
 
   CPPUNIT_TEST_SUITE_END();
 
@@ -224,6 +226,51 @@ public:
 
   }
 
+  void TestConversion()
+  {
+    // a region of a larger image, so the rows of the input are not continuous
+    cv::Mat colourImage(20, 30, CV_8UC3);
+    for (int y = 0; y < colourImage.rows; ++y)
+      for (int x = 0; x < colourImage.cols; ++x)
+        colourImage.at<cv::Vec3b>(y, x) = cv::Vec3b(x, y, x + y);
+    cv::Mat region = colourImage(cv::Rect(5, 3, 16, 10));
+
+    testFilter->SetOpenCVMat(region);
+    testFilter->Update();
+    mitk::Image::Pointer result = testFilter->GetOutput();
+    CPPUNIT_ASSERT_EQUAL(16u, result->GetDimension(0));
+    CPPUNIT_ASSERT_EQUAL(10u, result->GetDimension(1));
+    mitk::ImagePixelReadAccessor<mitk::OpenCVToMitkImageFilter::UCRGBPixelType, 2> colourAccess(result);
+    for (int y = 0; y < region.rows; ++y)
+    {
+      for (int x = 0; x < region.cols; ++x)
+      {
+        itk::Index<2> index = { { x, y } };
+        const cv::Vec3b bgr = region.at<cv::Vec3b>(y, x);
+        const mitk::OpenCVToMitkImageFilter::UCRGBPixelType rgb = colourAccess.GetPixelByIndex(index);
+        CPPUNIT_ASSERT_MESSAGE("Testing if BGR is converted to RGB", rgb[0] == bgr[2] && rgb[1] == bgr[1] && rgb[2] == bgr[0]);
+      }
+    }
+
+    cv::Mat grayImage(7, 9, CV_32FC1);
+    for (int y = 0; y < grayImage.rows; ++y)
+      for (int x = 0; x < grayImage.cols; ++x)
+        grayImage.at<float>(y, x) = 0.5f * x - 3.0f * y;
+
+    testFilter->SetOpenCVMat(grayImage);
+    testFilter->Update();
+    result = testFilter->GetOutput();
+    mitk::ImagePixelReadAccessor<float, 2> grayAccess(result);
+    for (int y = 0; y < grayImage.rows; ++y)
+    {
+      for (int x = 0; x < grayImage.cols; ++x)
+      {
+        itk::Index<2> index = { { x, y } };
+        CPPUNIT_ASSERT_EQUAL(grayImage.at<float>(y, x), grayAccess.GetPixelByIndex(index));
+      }
+    }
+  }
+
 
 private:
 
@@ -13,6 +13,7 @@ found in the LICENSE file.
 #include "mitkMovieGeneratorOpenCV.h"
 //#include <GL/gl.h>
 #include "mitkGL.h"
+#include <algorithm>
 #include <iostream>
 
 
@@ -24,6 +25,15 @@ mitk::MovieGeneratorOpenCV::MovieGeneratorOpenCV()
 
   m_FourCCCodec = nullptr;
   m_RemoveColouredFrame = true;
+
+  m_currentFrame = nullptr;
+  m_MaximumNumberOfQueuedFrames = 8;
+  m_StopWriting = false;
+}
+
+mitk::MovieGeneratorOpenCV::~MovieGeneratorOpenCV()
+{
+  this->TerminateGenerator();
 }
 
 
@@ -57,6 +67,8 @@ bool mitk::MovieGeneratorOpenCV::InitGenerator()
   m_width -= m_width % 4; // some video codecs have prerequisites to the image dimensions
   m_height -= m_height % 4;
 
+  if (m_currentFrame)
+    cvReleaseImage(&m_currentFrame);
   m_currentFrame = cvCreateImage(cvSize(m_width,m_height),8,3); // creating image with widget size, 8 bit per pixel and 3 channel r,g,b
   m_currentFrame->origin = 1; // avoid building a video with bottom up
 
@@ -108,24 +120,103 @@ bool mitk::MovieGeneratorOpenCV::InitGenerator()
     return false;
   }
 
+  // encoding takes longer than rendering a frame, so it is done by a separate thread
+  if (m_MaximumNumberOfQueuedFrames > 0)
+  {
+    m_StopWriting = false;
+    m_WriterThread = std::thread(&MovieGeneratorOpenCV::WriteQueuedFrames, this);
+  }
+
   return true;
 }
 
 
 bool mitk::MovieGeneratorOpenCV::AddFrame( void *data )
 {
-  //cvSetImageData(m_currentFrame,data,m_width*3);
-  memcpy(m_currentFrame->imageData,data,m_width*m_height*3);
-  cvWriteFrame(m_aviWriter,m_currentFrame);
+  if (!m_WriterThread.joinable())
+  {
+    //cvSetImageData(m_currentFrame,data,m_width*3);
+    memcpy(m_currentFrame->imageData,data,m_width*m_height*3);
+    cvWriteFrame(m_aviWriter,m_currentFrame);
+    return true;
+  }
+
+  IplImage* frame = nullptr;
+  {
+    std::unique_lock<std::mutex> lock(m_FramesMutex);
+    // the writer thread is too far behind if the queue is full, frames are never dropped
+    const std::size_t maximumNumberOfQueuedFrames = std::max(m_MaximumNumberOfQueuedFrames, 1u);
+    m_FramesChanged.wait(lock, [&] { return m_QueuedFrames.size() < maximumNumberOfQueuedFrames; });
+    if (!m_FreeFrames.empty())
+    {
+      frame = m_FreeFrames.back();
+      m_FreeFrames.pop_back();
+    }
+  }
+  if (frame == nullptr)
+  {
+    frame = cvCreateImage(cvSize(m_width,m_height),8,3);
+    frame->origin = 1; // avoid building a video with bottom up
+  }
+
+  // data is reused by the caller for the next frame
+  memcpy(frame->imageData,data,m_width*m_height*3);
+
+  {
+    std::lock_guard<std::mutex> lock(m_FramesMutex);
+    m_QueuedFrames.push_back(frame);
+  }
+  m_FramesChanged.notify_all();
   return true;
 }
 
 
+void mitk::MovieGeneratorOpenCV::WriteQueuedFrames()
+{
+  std::unique_lock<std::mutex> lock(m_FramesMutex);
+  while (true)
+  {
+    m_FramesChanged.wait(lock, [this] { return !m_QueuedFrames.empty() || m_StopWriting; });
+    // all queued frames are written before the thread stops
+    if (m_QueuedFrames.empty())
+      break;
+
+    IplImage* frame = m_QueuedFrames.front();
+    lock.unlock();
+    cvWriteFrame(m_aviWriter,frame);
+    lock.lock();
+
+    m_QueuedFrames.pop_front();
+    m_FreeFrames.push_back(frame);
+    m_FramesChanged.notify_all();
+  }
+}
+
+
 bool mitk::MovieGeneratorOpenCV::TerminateGenerator()
 {
+  if (m_WriterThread.joinable())
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_FramesMutex);
+      m_StopWriting = true;
+    }
+    m_FramesChanged.notify_all();
+    m_WriterThread.join();
+  }
+  for (IplImage* frame : m_FreeFrames)
+  {
+    cvReleaseImage(&frame);
+  }
+  m_FreeFrames.clear();
+
   if (m_aviWriter)
   {
     cvReleaseVideoWriter(&m_aviWriter);
   }
+  if (m_currentFrame)
+  {
+    cvReleaseImage(&m_currentFrame);
+  }
   return true;
 }
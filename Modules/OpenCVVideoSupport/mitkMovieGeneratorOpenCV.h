@@ -17,6 +17,11 @@ found in the LICENSE file.
 #include <MitkOpenCVVideoSupportExports.h>
 #include <memory.h>
 #include <cstring>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 // OpenCV includes
 #include "cv.h"
@@ -50,9 +55,23 @@ public:
   /// default: true
   ///
   void SetRemoveColouredFrame(bool);
+
+  ///
+  /// maximum number of frames that are queued for encoding by a separate thread,
+  /// AddFrame() waits if the queue is full, so no frame is dropped.
+  /// 0 encodes the frames synchronously in AddFrame()
+  /// has to be set before the first frame is added
+  /// default: 8
+  ///
+  void SetMaximumNumberOfQueuedFrames(unsigned int number)
+  {
+    m_MaximumNumberOfQueuedFrames = number;
+  }
+
 protected:
 
   MovieGeneratorOpenCV();
+  ~MovieGeneratorOpenCV() override;
 
   //! called directly before the first frame is added
   bool InitGenerator() override;
@@ -60,9 +79,12 @@ protected:
   //! used to add a frame
   bool AddFrame( void *data ) override;
 
-  //! called after the last frame is added
+  //! called after the last frame is added, waits until all queued frames are written
   bool TerminateGenerator() override;
 
+  //! main function of the thread encoding the queued frames
+  void WriteQueuedFrames();
+
   //! name of output file
   std::string m_sFile;
 
@@ -78,6 +100,14 @@ private:
   char *            m_FourCCCodec;
 
   bool m_RemoveColouredFrame;
+
+  unsigned int m_MaximumNumberOfQueuedFrames;
+  std::thread m_WriterThread;
+  bool m_StopWriting;
+  std::deque<IplImage*> m_QueuedFrames; ///< frames to be encoded, the first one is encoded at the moment
+  std::vector<IplImage*> m_FreeFrames;  ///< encoded frames that are reused by AddFrame()
+  std::mutex m_FramesMutex;
+  std::condition_variable m_FramesChanged;
 };
 
 } // namespace mitk
@@ -12,11 +12,8 @@ found in the LICENSE file.
 
 #include "mitkOpenCVToMitkImageFilter.h"
 
-#include <itkImportImageFilter.h>
 #include <itkRGBPixel.h>
-#include <mitkITKImageImport.txx>
-#include <itkOpenCVImageBridge.h>
-#include <itkImageFileWriter.h>
+#include <mitkImageReadAccessor.h>
 
 #include "mitkImageToOpenCVImageFilter.h"
 
@@ -95,6 +92,7 @@ namespace mitk{
       }
       else
       {
+        m_ImageMutex->Unlock();
         MITK_WARN << "Unknown image depth and/or pixel type. Cannot convert OpenCV to MITK image.";
         return;
       }
@@ -121,9 +119,30 @@ namespace mitk{
   {
     typedef itk::Image< TPixel, VImageDimension > ImageType;
 
-    typename ImageType::Pointer output = itk::OpenCVImageBridge::CVMatToITKImage<ImageType>(input);
+    // The pixels are written in one pass into memory that is handed over to the mitk::Image,
+    // instead of converting the mat to an IplImage and an itk::Image first.
+    auto *buffer = new unsigned char[input.total() * input.elemSize()];
+    cv::Mat output(input.rows, input.cols, input.type(), buffer);
+    if (input.channels() == 3)
+    {
+      // OpenCV stores colour images as BGR
+      const int fromTo[] = { 0, 2, 1, 1, 2, 0 };
+      cv::mixChannels(&input, 1, &output, 1, fromTo, 3);
+    }
+    else
+    {
+      input.copyTo(output);
+    }
+
+    unsigned int dimensions[VImageDimension];
+    dimensions[0] = input.cols;
+    dimensions[1] = input.rows;
+    for (unsigned int i = 2; i < VImageDimension; ++i)
+      dimensions[i] = 1;
+
     Image::Pointer mitkImage = Image::New();
-    mitkImage = GrabItkImageMemory(output);
+    mitkImage->Initialize(MakePixelType<ImageType>(), VImageDimension, dimensions);
+    mitkImage->SetImportVolume(buffer, 0, 0, Image::ManageMemory);
 
     return mitkImage;
   }
@@ -41,7 +41,8 @@ namespace mitk
     typedef itk::RGBPixel< double > DoubleRGBPixelType;
 
     ///
-    /// the static function for the conversion
+    /// the static function for the conversion. The pixels are copied in one pass into the memory
+    /// of the new image, colour images are converted from BGR to RGB on the way.
     ///
     template <typename TPixel, unsigned int VImageDimension>
     static Image::Pointer ConvertCVMatToMitkImage(const cv::Mat input);
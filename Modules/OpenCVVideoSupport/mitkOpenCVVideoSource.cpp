@@ -24,7 +24,9 @@ mitk::OpenCVVideoSource::OpenCVVideoSource()
   m_UseCVCAMLib(false),
   m_UndistortImage(false),
   m_FlipXAxisEnabled(false),
-  m_FlipYAxisEnabled(false)
+  m_FlipYAxisEnabled(false),
+  m_DecodeAheadQueueSize(0),
+  m_StopDecoding(false)
 {
 }
 
@@ -61,12 +63,43 @@ void mitk::OpenCVVideoSource::SetVideoCameraInput(int cameraindex, bool /*useCVC
 
 double mitk::OpenCVVideoSource::GetVideoCaptureProperty(int property_id)
 {
+  std::lock_guard<std::mutex> lock(m_VideoCaptureMutex);
   return cvGetCaptureProperty(m_VideoCapture, property_id);
 }
 
 int mitk::OpenCVVideoSource::SetVideoCaptureProperty(int property_id, double value)
 {
-  return cvSetCaptureProperty(m_VideoCapture, property_id, value);
+  // frames that were decoded ahead do not match the new property, e.g. the new position in the video file
+  const bool decoding = m_DecoderThread.joinable();
+  this->StopDecoding();
+  {
+    std::lock_guard<std::mutex> lock(m_DecodedFramesMutex);
+    m_DecodedFrames.clear();
+  }
+
+  int result = cvSetCaptureProperty(m_VideoCapture, property_id, value);
+
+  if(decoding)
+    this->StartDecoding();
+  return result;
+}
+
+void mitk::OpenCVVideoSource::SetDecodeAheadQueueSize(unsigned int size)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_DecodedFramesMutex);
+    if(m_DecodeAheadQueueSize == size)
+      return;
+    m_DecodeAheadQueueSize = size;
+  }
+  // the decoder might wait for space in the queue
+  m_DecodedFramesChanged.notify_all();
+
+  if(size == 0)
+    this->StopDecoding();
+  else if(m_CapturingInProcess)
+    this->StartDecoding();
+  this->Modified();
 }
 
 //method extended for "static video feature" if enabled
@@ -120,18 +153,32 @@ void mitk::OpenCVVideoSource::FetchFrame()
   {
     if(m_VideoCapture) // we use highgui
     {
+      // the decoder thread already restarts the video file if necessary
+      bool decodedAhead = m_DecoderThread.joinable();
+      if(!decodedAhead)
+      {
+        std::lock_guard<std::mutex> lock(m_DecodedFramesMutex);
+        decodedAhead = !m_DecodedFrames.empty();
+      }
       if(!m_CapturePaused)
       {
-        // release old image here
-        m_CurrentImage = cvQueryFrame(m_VideoCapture);
         ++m_FrameCount;
+        if(decodedAhead)
+        {
+          this->PopDecodedFrame();
+        }
+        else
+        {
+          // release old image here
+          m_CurrentImage = cvQueryFrame(m_VideoCapture);
+        }
       }
 
       if(m_CurrentImage == nullptr) // do we need to repeat the video if it is from video file?
       {
         double framePos = this->GetVideoCaptureProperty(CV_CAP_PROP_POS_AVI_RATIO);
         MITK_DEBUG << "End of video file found. framePos: " << framePos;
-        if(m_RepeatVideo && framePos >= 0.99)
+        if(m_RepeatVideo && framePos >= 0.99 && !decodedAhead)
         {
           MITK_DEBUG << "Restarting video file playback.";
           this->SetVideoCaptureProperty(CV_CAP_PROP_POS_AVI_RATIO, 0);
@@ -165,6 +212,97 @@ void mitk::OpenCVVideoSource::FetchFrame()
   }
 }
 
+void mitk::OpenCVVideoSource::PopDecodedFrame()
+{
+  std::unique_lock<std::mutex> lock(m_DecodedFramesMutex);
+  m_DecodedFramesChanged.wait(lock, [this] { return !m_DecodedFrames.empty(); });
+
+  DecodedFrame frame = m_DecodedFrames.front();
+  if(frame.Image.empty())
+  {
+    // the end of the video file stays in the queue, so that it is reported by every further call
+    m_CurrentImage = nullptr;
+    return;
+  }
+  m_DecodedFrames.pop_front();
+  lock.unlock();
+  m_DecodedFramesChanged.notify_all();
+
+  if(frame.Restarted)
+    m_FrameCount = 0;
+  m_DecodedFrame = frame.Image;
+  m_DecodedFrameHeader = static_cast<IplImage>(m_DecodedFrame);
+  m_CurrentImage = &m_DecodedFrameHeader;
+}
+
+void mitk::OpenCVVideoSource::StartDecoding()
+{
+  if(m_DecoderThread.joinable() || m_VideoCapture == nullptr || m_VideoFileName.empty())
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock(m_DecodedFramesMutex);
+    if(m_DecodeAheadQueueSize == 0)
+      return;
+    // there is nothing left to decode if the end of the video file is already queued
+    if(!m_DecodedFrames.empty() && m_DecodedFrames.back().Image.empty())
+      return;
+    m_StopDecoding = false;
+  }
+  m_DecoderThread = std::thread(&OpenCVVideoSource::DecodeFrames, this);
+}
+
+void mitk::OpenCVVideoSource::StopDecoding()
+{
+  if(!m_DecoderThread.joinable())
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock(m_DecodedFramesMutex);
+    m_StopDecoding = true;
+  }
+  m_DecodedFramesChanged.notify_all();
+  m_DecoderThread.join();
+}
+
+void mitk::OpenCVVideoSource::DecodeFrames()
+{
+  std::unique_lock<std::mutex> lock(m_DecodedFramesMutex);
+  while(!m_StopDecoding)
+  {
+    if(m_DecodedFrames.size() >= m_DecodeAheadQueueSize)
+    {
+      m_DecodedFramesChanged.wait(lock);
+      continue;
+    }
+    const bool repeatVideo = m_RepeatVideo;
+    lock.unlock();
+
+    DecodedFrame frame;
+    frame.Restarted = false;
+    {
+      std::lock_guard<std::mutex> captureLock(m_VideoCaptureMutex);
+      IplImage* image = cvQueryFrame(m_VideoCapture);
+      if(image == nullptr && repeatVideo && cvGetCaptureProperty(m_VideoCapture, CV_CAP_PROP_POS_AVI_RATIO) >= 0.99)
+      {
+        MITK_DEBUG << "Restarting video file playback.";
+        cvSetCaptureProperty(m_VideoCapture, CV_CAP_PROP_POS_AVI_RATIO, 0);
+        image = cvQueryFrame(m_VideoCapture);
+        frame.Restarted = true;
+      }
+      // the image returned by cvQueryFrame() is overwritten by the next call
+      if(image != nullptr)
+        frame.Image = cv::cvarrToMat(image, true);
+    }
+
+    lock.lock();
+    m_DecodedFrames.push_back(frame);
+    m_DecodedFramesChanged.notify_all();
+    if(frame.Image.empty())
+      break;
+  }
+}
+
 void mitk::OpenCVVideoSource::UpdateVideoTexture()
 {  //write the grabbed frame into an opengl compatible array, that means flip it and swap channel order
   if(!m_CurrentImage)
@@ -212,6 +350,9 @@ void mitk::OpenCVVideoSource::StartCapturing()
     m_CapturingInProcess = true;
   else
     m_CapturingInProcess = false;
+
+  if(m_CapturingInProcess)
+    this->StartDecoding();
 }
 
 void mitk::OpenCVVideoSource::StopCapturing()
@@ -389,6 +530,12 @@ void mitk::OpenCVVideoSource::Reset()
   // set capturing to false
   this->StopCapturing();
   this->m_FrameCount = 0;
+  this->StopDecoding();
+  {
+    std::lock_guard<std::mutex> lock(m_DecodedFramesMutex);
+    m_DecodedFrames.clear();
+  }
+  m_DecodedFrame.release();
   if(m_VideoCapture)
     cvReleaseCapture(&m_VideoCapture);
   m_VideoCapture = nullptr;
@@ -27,6 +27,11 @@ found in the LICENSE file.
 #include "itkImageRegionIterator.h"
 #include "mitkOpenCVImageSource.h"
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
 namespace mitk
 {
  /**
@@ -35,6 +40,7 @@ namespace mitk
  * At the moment, OPENCV includes two separated modules for this grabbing, but only HighGui is
  * used here.
  * Initialize via SetVideoFileInput() or SetVideoCameraInput(), start processing with StartCapturing();
+ * Frames of a video file can be decoded ahead by a separate thread, see SetDecodeAheadQueueSize().
  */
   class MITKOPENCVVIDEOSUPPORT_EXPORT OpenCVVideoSource :
       virtual public VideoSource, virtual public OpenCVImageSource
@@ -135,6 +141,16 @@ namespace mitk
     itkGetMacro( RepeatVideo, bool );
     itkSetMacro( RepeatVideo, bool );
 
+    ////##Documentation
+    ////## @brief Sets the maximum number of frames of a video file that are decoded ahead by a separate thread.
+    ////## While the current frame is processed, the next frames are already decoded, so that a recorded video
+    ////## can be replayed at its full frame rate. 0 (default) decodes each frame in FetchFrame().
+    ////## Frames of a camera are never decoded ahead, as this would only add latency.
+    ////## Notice: while frames are decoded ahead, GetVideoCaptureProperty() refers to the last decoded frame
+    ////## instead of the current one.
+    virtual void SetDecodeAheadQueueSize(unsigned int size);
+    itkGetConstMacro( DecodeAheadQueueSize, unsigned int );
+
 
   protected:
     OpenCVVideoSource();
@@ -150,6 +166,24 @@ namespace mitk
     ////## so that GetVideoTexture() can be used.
     void UpdateVideoTexture();
 
+    ///
+    /// Starts the thread decoding frames ahead if a video file is used and the queue size is not 0
+    ///
+    void StartDecoding();
+    ///
+    /// Stops the thread decoding frames ahead, decoded frames stay in the queue
+    ///
+    void StopDecoding();
+    ///
+    /// Main function of the thread decoding frames ahead
+    ///
+    void DecodeFrames();
+    ///
+    /// Sets m_CurrentImage to the next frame of the queue, waits until it is decoded if necessary.
+    /// m_CurrentImage is nullptr at the end of the video file.
+    ///
+    void PopDecodedFrame();
+
     // Helper functions
     void sleep(unsigned int ms);
     void RGBtoHSV(float r, float g, float b, float &h, float &s, float &v);
@@ -190,6 +224,24 @@ namespace mitk
     * Flag to enable or disable video flipping by Y Axis.
     **/
     bool m_FlipYAxisEnabled;
+
+    struct DecodedFrame
+    {
+      cv::Mat Image; ///< empty at the end of the video file
+      bool Restarted; ///< true for the first frame after the video file was restarted
+    };
+
+    unsigned int m_DecodeAheadQueueSize;
+    std::thread m_DecoderThread;
+    bool m_StopDecoding;
+    std::deque<DecodedFrame> m_DecodedFrames;
+    std::mutex m_DecodedFramesMutex; ///< guards m_DecodedFrames, m_StopDecoding and m_DecodeAheadQueueSize
+    std::condition_variable m_DecodedFramesChanged;
+    std::mutex m_VideoCaptureMutex; ///< guards m_VideoCapture while frames are decoded ahead
+
+    // decoded frame m_CurrentImage points to
+    cv::Mat m_DecodedFrame;
+    IplImage m_DecodedFrameHeader;
   };
 }
 #endif // Header
@@ -41,11 +41,24 @@ void mitk::IGTL2DImageDeviceSource::GenerateData()
   /* update output with message from the device */
   IGTLMessage* msgOut = this->GetOutput();
   assert(msgOut);
-  igtl::MessageBase::Pointer msgIn = dynamic_cast<igtl::MessageBase*>(m_IGTLDevice->GetNextImage2dMessage().GetPointer());
+  igtl::ImageMessage::Pointer msgIn = m_IGTLDevice->GetNextImage2dMessage();
   if (msgIn.IsNotNull())
   {
-    assert(msgIn);
-    msgOut->SetMessage(msgIn);
-    msgOut->SetName(msgIn->GetDeviceName());
+    igtl::ImageMessage::Pointer image = m_Decoder.Decode(msgIn);
+    if (image.IsNull())
+      return;
+    msgOut->SetMessage(image.GetPointer());
+    msgOut->SetName(image->GetDeviceName());
   }
 }
+
+const mitk::IGTLImageStreamStatistics& mitk::IGTL2DImageDeviceSource::GetStreamStatistics() const
+{
+  return m_Decoder.GetStatistics();
+}
+
+void mitk::IGTL2DImageDeviceSource::ResetStream()
+{
+  m_Decoder.Reset();
+  m_Decoder.ResetStatistics();
+}
@@ -14,6 +14,7 @@ found in the LICENSE file.
 #define IGTL3DIMAGEDEVICESOURCE_H_HEADER_INCLUDED_
 
 #include "mitkIGTLDeviceSource.h"
+#include "mitkIGTLImageStreamCodec.h"
 
 namespace mitk {
   /**
@@ -33,6 +34,17 @@ namespace mitk {
     itkFactorylessNewMacro(Self);
     itkCloneMacro(Self);
 
+    /**
+    * \brief Returns the bandwidth and latency of the received image stream
+    */
+    const IGTLImageStreamStatistics& GetStreamStatistics() const;
+
+    /**
+    * \brief Forgets the last image and resets the statistics, e.g. after
+    * connecting to another device
+    */
+    void ResetStream();
+
   protected:
     IGTL3DImageDeviceSource();
     ~IGTL3DImageDeviceSource() override;
@@ -46,6 +58,9 @@ namespace mitk {
     * the OpenIGTLink device after it was set as input for this filter
     */
     void GenerateData() override;
+
+    /** decodes compressed images and sub-volumes into the last received image */
+    IGTLImageStreamDecoder m_Decoder;
   };
 } // namespace mitk
 #endif /* MITKIGTLDeviceSource_H_HEADER_INCLUDED_ */
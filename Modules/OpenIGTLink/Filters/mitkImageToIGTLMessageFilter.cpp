@@ -16,11 +16,17 @@ found in the LICENSE file.
 #include "igtlImageMessage.h"
 
 mitk::ImageToIGTLMessageFilter::ImageToIGTLMessageFilter()
+  : m_Upstream(nullptr),
+    m_CompressionEnabled(false),
+    m_CompressionLevel(1),
+    m_ChangedRegionOnly(false),
+    m_KeyFrameInterval(25)
 {
   mitk::IGTLMessage::Pointer output = mitk::IGTLMessage::New();
   this->SetNumberOfRequiredOutputs(1);
   this->SetNthOutput(0, output.GetPointer());
   this->SetNumberOfRequiredInputs(1);
+  m_Encoders.resize(1);
 }
 
 void mitk::ImageToIGTLMessageFilter::GenerateData()
@@ -192,14 +198,18 @@ void mitk::ImageToIGTLMessageFilter::GenerateData()
       break;
     }
 
-    //copy timestamp of mitk image
+    // the modification time of the image is no time, use the time of sending
+    // so that the receiver can measure the latency
     igtl::TimeStamp::Pointer timestamp = igtl::TimeStamp::New();
-    timestamp->SetTime(img->GetMTime() / 1000, (int)(img->GetMTime()) % 1000);
+    timestamp->GetTime();
     imgMsg->SetTimeStamp(timestamp);
 
-    imgMsg->Pack();
-
-    output->SetMessage(imgMsg.GetPointer());
+    IGTLImageStreamEncoder& encoder = m_Encoders[i];
+    encoder.SetCompressionEnabled(m_CompressionEnabled);
+    encoder.SetCompressionLevel(m_CompressionLevel);
+    encoder.SetChangedRegionOnly(m_ChangedRegionOnly);
+    encoder.SetKeyFrameInterval(m_KeyFrameInterval);
+    output->SetMessage(encoder.Encode(imgMsg));
   }
 }
 
@@ -242,10 +252,29 @@ void mitk::ImageToIGTLMessageFilter::ConnectTo(mitk::ImageSource* upstream)
   }
 }
 
+const mitk::IGTLImageStreamStatistics& mitk::ImageToIGTLMessageFilter::GetStreamStatistics(unsigned int idx) const
+{
+  if (idx >= m_Encoders.size())
+  {
+    mitkThrow() << "There is no output with the index " << idx << ".";
+  }
+  return m_Encoders[idx].GetStatistics();
+}
+
+void mitk::ImageToIGTLMessageFilter::ResetStreams()
+{
+  for (auto& encoder : m_Encoders)
+  {
+    encoder.Reset();
+    encoder.ResetStatistics();
+  }
+}
+
 void mitk::ImageToIGTLMessageFilter::CreateOutputsForAllInputs()
 {
   // create one message output for all image inputs
   this->SetNumberOfIndexedOutputs(this->GetNumberOfIndexedInputs());
+  m_Encoders.resize(this->GetNumberOfIndexedOutputs());
 
   for (size_t idx = 0; idx < this->GetNumberOfIndexedOutputs(); ++idx)
   {
@@ -17,6 +17,9 @@ found in the LICENSE file.
 #include <mitkIGTLMessageSource.h>
 #include <mitkImage.h>
 #include <mitkImageSource.h>
+#include <mitkIGTLImageStreamCodec.h>
+
+#include <vector>
 
 namespace mitk
 {
@@ -24,6 +27,12 @@ namespace mitk
  *
  * \brief This filter creates IGTL messages from mitk::Image objects
  *
+ * Every output is encoded as an image stream, see mitk::IGTLImageStreamEncoder.
+ * By default whole uncompressed IMAGE messages are sent. To reduce the
+ * bandwidth, the images can be compressed and/or only the changed regions
+ * can be sent as sub-volumes. The receiving side decodes such streams with
+ * IGTL2DImageDeviceSource or IGTL3DImageDeviceSource.
+ *
  * \ingroup OpenIGTLink
  *
  */
@@ -77,6 +86,35 @@ class MITKOPENIGTLINK_EXPORT ImageToIGTLMessageFilter : public IGTLMessageSource
    */
   virtual void ConnectTo(mitk::ImageSource* UpstreamFilter);
 
+  /** \brief Compresses the images with zlib (default off) */
+  itkSetMacro(CompressionEnabled, bool);
+  itkGetConstMacro(CompressionEnabled, bool);
+  itkBooleanMacro(CompressionEnabled);
+
+  /** \brief zlib compression level from 1 (fastest, default) to 9 (smallest) */
+  itkSetClampMacro(CompressionLevel, int, 1, 9);
+  itkGetConstMacro(CompressionLevel, int);
+
+  /** \brief Sends only the region that changed since the last image (default off). The frames are
+   * sent as numbered ZIMAGE messages, so receivers can skip sub-volumes after a lost frame. */
+  itkSetMacro(ChangedRegionOnly, bool);
+  itkGetConstMacro(ChangedRegionOnly, bool);
+  itkBooleanMacro(ChangedRegionOnly);
+
+  /** \brief Number of frames between two whole images if only changed regions are sent (default 25) */
+  itkSetMacro(KeyFrameInterval, unsigned int);
+  itkGetConstMacro(KeyFrameInterval, unsigned int);
+
+  /**
+   * \brief Returns the bandwidth and encoding time of the output at the given index
+   */
+  const IGTLImageStreamStatistics& GetStreamStatistics(unsigned int idx) const;
+
+  /**
+   * \brief Forces whole images with the next update and resets the statistics
+   */
+  void ResetStreams();
+
  protected:
   ImageToIGTLMessageFilter();
 
@@ -88,6 +126,14 @@ class MITKOPENIGTLINK_EXPORT ImageToIGTLMessageFilter : public IGTLMessageSource
   virtual void CreateOutputsForAllInputs();
 
   mitk::ImageSource* m_Upstream;
+
+  bool m_CompressionEnabled;
+  int m_CompressionLevel;
+  bool m_ChangedRegionOnly;
+  unsigned int m_KeyFrameInterval;
+
+  /** one encoder per output, the encoders keep the last image of their stream */
+  std::vector<IGTLImageStreamEncoder> m_Encoders;
 };
 }  // namespace mitk
 
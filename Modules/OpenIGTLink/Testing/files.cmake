@@ -1,5 +1,7 @@
 set(MODULE_TESTS
    mitkOpenIGTLinkClientServerTest.cpp
+   mitkOpenIGTLinkLoopbackTest.cpp
+   mitkOpenIGTLinkImageStreamCodecTest.cpp
    mitkOpenIGTLinkImageFactoryTest.cpp
    mitkOpenIGTLinkIGTLImageMessageFilterTest.cpp
 )
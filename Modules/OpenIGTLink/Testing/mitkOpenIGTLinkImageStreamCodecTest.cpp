@@ -0,0 +1,278 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+//TEST
+#include <mitkTestingMacros.h>
+#include <mitkTestFixture.h>
+
+//STD
+#include <cstring>
+#include <vector>
+
+//MITK
+#include "mitkIGTLImageStreamCodec.h"
+#include "mitkIGTLCompressedImageMessage.h"
+#include "mitkIGTLMessageFactory.h"
+#include "mitkIGTLMessageQueue.h"
+
+//IGTL
+#include "igtlImageMessage.h"
+#include "igtl_header.h"
+
+class mitkOpenIGTLinkImageStreamCodecTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkOpenIGTLinkImageStreamCodecTestSuite);
+  MITK_TEST(TestUncompressedWholeImages);
+  MITK_TEST(TestChangedRegionRoundtrip);
+  MITK_TEST(TestCompressedChangedRegionRoundtrip);
+  MITK_TEST(TestKeyFrameInterval);
+  MITK_TEST(TestSubVolumeBeforeWholeImageIsSkipped);
+  MITK_TEST(TestLostFrameSkipsSubVolumesUntilKeyFrame);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  mitk::IGTLMessageFactory::Pointer m_Factory;
+
+  igtl::ImageMessage::Pointer CreateImage(unsigned short value)
+  {
+    int dimensions[3] = { 64, 48, 4 };
+    igtl::ImageMessage::Pointer image = igtl::ImageMessage::New();
+    image->SetDeviceName("Codec");
+    image->SetDimensions(dimensions);
+    image->SetScalarTypeToUint16();
+    image->SetEndian(igtl::ImageMessage::ENDIAN_LITTLE);
+    image->AllocatePack();
+    image->AllocateScalars();
+    unsigned short* scalars = static_cast<unsigned short*>(image->GetScalarPointer());
+    std::fill(scalars, scalars + dimensions[0] * dimensions[1] * dimensions[2], value);
+    return image;
+  }
+
+  void SetVoxel(igtl::ImageMessage* image, int x, int y, int z, unsigned short value)
+  {
+    int dimensions[3];
+    image->GetDimensions(dimensions);
+    static_cast<unsigned short*>(image->GetScalarPointer())[(z * dimensions[1] + y) * dimensions[0] + x] = value;
+  }
+
+  /** simulates the transfer, the receiver only knows the packed message */
+  igtl::ImageMessage::Pointer Transfer(igtl::MessageBase* message)
+  {
+    igtl::MessageHeader::Pointer header = igtl::MessageHeader::New();
+    header->InitPack();
+    std::memcpy(header->GetPackPointer(), message->GetPackPointer(), IGTL_HEADER_SIZE);
+    header->Unpack();
+
+    igtl::MessageBase::Pointer received = m_Factory->CreateInstance(header);
+    CPPUNIT_ASSERT_MESSAGE("The message type is not registered", received.IsNotNull());
+    received->SetMessageHeader(header);
+    received->AllocatePack();
+    std::memcpy(received->GetPackBodyPointer(), message->GetPackBodyPointer(), received->GetPackBodySize());
+    received->Unpack(1);
+    return dynamic_cast<igtl::ImageMessage*>(received.GetPointer());
+  }
+
+  bool IsSubVolume(igtl::MessageBase* message)
+  {
+    igtl::ImageMessage* image = dynamic_cast<igtl::ImageMessage*>(message);
+    int dimensions[3], size[3], offset[3];
+    image->GetDimensions(dimensions);
+    image->GetSubVolume(size, offset);
+    return !std::equal(size, size + 3, dimensions);
+  }
+
+  bool Equals(igtl::ImageMessage* first, igtl::ImageMessage* second)
+  {
+    return first->GetImageSize() == second->GetImageSize()
+      && std::memcmp(first->GetScalarPointer(), second->GetScalarPointer(), first->GetImageSize()) == 0;
+  }
+
+public:
+
+  void setUp() override
+  {
+    m_Factory = mitk::IGTLMessageFactory::New();
+  }
+
+  void tearDown() override
+  {
+    m_Factory = nullptr;
+  }
+
+  void TestUncompressedWholeImages()
+  {
+    mitk::IGTLImageStreamEncoder encoder;
+    mitk::IGTLImageStreamDecoder decoder;
+
+    igtl::ImageMessage::Pointer image = this->CreateImage(7);
+    igtl::MessageBase::Pointer message = encoder.Encode(image);
+    CPPUNIT_ASSERT_MESSAGE("Testing if the image itself is sent", message.GetPointer() == image.GetPointer());
+
+    igtl::ImageMessage::Pointer decoded = decoder.Decode(this->Transfer(message));
+    CPPUNIT_ASSERT(decoded.IsNotNull());
+    CPPUNIT_ASSERT(this->Equals(image, decoded));
+    CPPUNIT_ASSERT_EQUAL(1ull, encoder.GetStatistics().NumberOfMessages);
+    CPPUNIT_ASSERT_EQUAL(1ull, decoder.GetStatistics().NumberOfMessages);
+  }
+
+  void TestChangedRegionRoundtrip()
+  {
+    mitk::IGTLImageStreamEncoder encoder;
+    encoder.SetChangedRegionOnly(true);
+    mitk::IGTLImageStreamDecoder decoder;
+
+    igtl::ImageMessage::Pointer image = this->CreateImage(0);
+    igtl::MessageBase::Pointer message = encoder.Encode(image);
+    CPPUNIT_ASSERT_MESSAGE("Testing if the first image is sent as a whole", !this->IsSubVolume(message));
+    CPPUNIT_ASSERT(decoder.Decode(this->Transfer(message)).IsNotNull());
+
+    igtl::ImageMessage::Pointer changedImage = this->CreateImage(0);
+    this->SetVoxel(changedImage, 10, 20, 1, 100);
+    this->SetVoxel(changedImage, 14, 22, 2, 200);
+    message = encoder.Encode(changedImage);
+    CPPUNIT_ASSERT_MESSAGE("Testing if only the changed region is sent", this->IsSubVolume(message));
+    CPPUNIT_ASSERT(message->GetPackSize() < image->GetPackSize() / 10);
+
+    int size[3], offset[3];
+    static_cast<igtl::ImageMessage*>(message.GetPointer())->GetSubVolume(size, offset);
+    CPPUNIT_ASSERT(size[0] == 5 && size[1] == 3 && size[2] == 2);
+    CPPUNIT_ASSERT(offset[0] == 10 && offset[1] == 20 && offset[2] == 1);
+
+    igtl::ImageMessage::Pointer decoded = decoder.Decode(this->Transfer(message));
+    CPPUNIT_ASSERT(decoded.IsNotNull());
+    CPPUNIT_ASSERT_MESSAGE("Testing if the decoded image equals the changed image", this->Equals(changedImage, decoded));
+
+    // an unchanged image results in a single voxel
+    message = encoder.Encode(changedImage);
+    static_cast<igtl::ImageMessage*>(message.GetPointer())->GetSubVolume(size, offset);
+    CPPUNIT_ASSERT(size[0] == 1 && size[1] == 1 && size[2] == 1);
+    decoded = decoder.Decode(this->Transfer(message));
+    CPPUNIT_ASSERT(this->Equals(changedImage, decoded));
+  }
+
+  void TestCompressedChangedRegionRoundtrip()
+  {
+    mitk::IGTLImageStreamEncoder encoder;
+    encoder.SetChangedRegionOnly(true);
+    encoder.SetCompressionEnabled(true);
+    mitk::IGTLImageStreamDecoder decoder;
+
+    igtl::ImageMessage::Pointer image = this->CreateImage(3);
+    igtl::MessageBase::Pointer message = encoder.Encode(image);
+    CPPUNIT_ASSERT_EQUAL(std::string("ZIMAGE"), std::string(message->GetDeviceType()));
+    CPPUNIT_ASSERT_MESSAGE("Testing if a uniform image is compressed", message->GetPackSize() < image->GetPackSize() / 10);
+    CPPUNIT_ASSERT(decoder.Decode(this->Transfer(message)).IsNotNull());
+
+    for (int frame = 1; frame < 5; ++frame)
+    {
+      igtl::ImageMessage::Pointer changedImage = this->CreateImage(3);
+      for (int x = 0; x < 8 * frame; ++x)
+        this->SetVoxel(changedImage, x, frame, frame % 4, x * frame);
+      message = encoder.Encode(changedImage);
+
+      igtl::ImageMessage::Pointer received = this->Transfer(message);
+      CPPUNIT_ASSERT(dynamic_cast<mitk::IGTLCompressedImageMessage*>(received.GetPointer()) != nullptr);
+      igtl::ImageMessage::Pointer decoded = decoder.Decode(received);
+      CPPUNIT_ASSERT(decoded.IsNotNull());
+      CPPUNIT_ASSERT(this->Equals(changedImage, decoded));
+    }
+
+    CPPUNIT_ASSERT_EQUAL(5ull, decoder.GetStatistics().NumberOfMessages);
+    CPPUNIT_ASSERT(encoder.GetStatistics().GetCompressionRatio() > 10.0);
+    CPPUNIT_ASSERT_EQUAL(encoder.GetStatistics().MessageBytes, decoder.GetStatistics().MessageBytes);
+  }
+
+  void TestKeyFrameInterval()
+  {
+    mitk::IGTLImageStreamEncoder encoder;
+    encoder.SetChangedRegionOnly(true);
+    encoder.SetKeyFrameInterval(3);
+
+    igtl::ImageMessage::Pointer image = this->CreateImage(1);
+    CPPUNIT_ASSERT(!this->IsSubVolume(encoder.Encode(image)));
+    CPPUNIT_ASSERT(this->IsSubVolume(encoder.Encode(image)));
+    CPPUNIT_ASSERT(this->IsSubVolume(encoder.Encode(image)));
+    CPPUNIT_ASSERT_MESSAGE("Testing if every third image is sent as a whole", !this->IsSubVolume(encoder.Encode(image)));
+
+    encoder.Reset();
+    CPPUNIT_ASSERT_MESSAGE("Testing if Reset() forces a whole image", !this->IsSubVolume(encoder.Encode(image)));
+  }
+
+  void TestSubVolumeBeforeWholeImageIsSkipped()
+  {
+    mitk::IGTLImageStreamEncoder encoder;
+    encoder.SetChangedRegionOnly(true);
+    encoder.Encode(this->CreateImage(0));
+
+    igtl::ImageMessage::Pointer changedImage = this->CreateImage(0);
+    this->SetVoxel(changedImage, 1, 1, 1, 1);
+    igtl::MessageBase::Pointer message = encoder.Encode(changedImage);
+    CPPUNIT_ASSERT(this->IsSubVolume(message));
+
+    mitk::IGTLImageStreamDecoder decoder;
+    CPPUNIT_ASSERT_MESSAGE("Testing if a sub-volume without a whole image is skipped",
+      decoder.Decode(this->Transfer(message)).IsNull());
+  }
+
+  void TestLostFrameSkipsSubVolumesUntilKeyFrame()
+  {
+    mitk::IGTLImageStreamEncoder encoder;
+    encoder.SetChangedRegionOnly(true);
+    encoder.SetKeyFrameInterval(4);
+    mitk::IGTLImageStreamDecoder decoder;
+    mitk::IGTLMessageQueue::Pointer queue = mitk::IGTLMessageQueue::New();
+    queue->SetBackpressurePolicy(mitk::IGTLMessageQueue::Image3dQueue, mitk::IGTLBackpressurePolicy::KeepLatest);
+
+    std::vector<igtl::ImageMessage::Pointer> images;
+    std::vector<igtl::MessageBase::Pointer> messages;
+    for (int frame = 0; frame < 6; ++frame)
+    {
+      images.push_back(this->CreateImage(0));
+      this->SetVoxel(images.back(), frame, frame, frame % 4, 10 + frame);
+      messages.push_back(encoder.Encode(images.back()));
+    }
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Testing if changed-region streams are numbered", std::string("ZIMAGE"), std::string(messages[1]->GetDeviceType()));
+    for (std::size_t frame = 0; frame < messages.size(); ++frame)
+    {
+      mitk::IGTLCompressedImageMessage* compressedMessage = dynamic_cast<mitk::IGTLCompressedImageMessage*>(messages[frame].GetPointer());
+      CPPUNIT_ASSERT_EQUAL(static_cast<igtlUint32>(frame + 1), compressedMessage->GetFrameNumber());
+    }
+    CPPUNIT_ASSERT(!this->IsSubVolume(messages[0]) && this->IsSubVolume(messages[1]) && this->IsSubVolume(messages[2]));
+    CPPUNIT_ASSERT(this->IsSubVolume(messages[3]) && !this->IsSubVolume(messages[4]) && this->IsSubVolume(messages[5]));
+
+    queue->PushMessage(this->Transfer(messages[0]).GetPointer());
+    CPPUNIT_ASSERT(this->Equals(images[0], decoder.Decode(queue->PullImage3dMessage())));
+
+    // the receiver is too slow, the queue keeps the latest frame and drops the first sub-volume
+    queue->PushMessage(this->Transfer(messages[1]).GetPointer());
+    queue->PushMessage(this->Transfer(messages[2]).GetPointer());
+    CPPUNIT_ASSERT_MESSAGE("Testing if a sub-volume after a lost frame is skipped",
+      decoder.Decode(queue->PullImage3dMessage()).IsNull());
+    CPPUNIT_ASSERT_EQUAL(1ull, decoder.GetNumberOfSkippedFrames());
+
+    queue->PushMessage(this->Transfer(messages[3]).GetPointer());
+    CPPUNIT_ASSERT_MESSAGE("Testing if sub-volumes are skipped until the next key frame",
+      decoder.Decode(queue->PullImage3dMessage()).IsNull());
+    CPPUNIT_ASSERT_EQUAL(2ull, decoder.GetNumberOfSkippedFrames());
+
+    queue->PushMessage(this->Transfer(messages[4]).GetPointer());
+    igtl::ImageMessage::Pointer decoded = decoder.Decode(queue->PullImage3dMessage());
+    CPPUNIT_ASSERT(decoded.IsNotNull() && this->Equals(images[4], decoded));
+
+    queue->PushMessage(this->Transfer(messages[5]).GetPointer());
+    decoded = decoder.Decode(queue->PullImage3dMessage());
+    CPPUNIT_ASSERT_MESSAGE("Testing if the stream recovers after the key frame", decoded.IsNotNull() && this->Equals(images[5], decoded));
+    CPPUNIT_ASSERT_EQUAL(2ull, decoder.GetNumberOfSkippedFrames());
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkOpenIGTLinkImageStreamCodec)
@@ -0,0 +1,257 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+//TEST
+#include <mitkTestingMacros.h>
+#include <mitkTestFixture.h>
+
+//STD
+#include <thread>
+#include <chrono>
+#include <vector>
+
+//MITK
+#include "mitkIGTLBoundedQueue.h"
+#include "mitkIGTLServer.h"
+#include "mitkIGTLClient.h"
+#include "mitkIGTLMessageFactory.h"
+
+//IGTL
+#include "igtlStatusMessage.h"
+#include "igtlStringMessage.h"
+
+static const int PORT = 35353;
+static const std::string HOSTNAME = "localhost";
+
+class mitkOpenIGTLinkLoopbackTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkOpenIGTLinkLoopbackTestSuite);
+  MITK_TEST(TestBoundedQueueDropOldest);
+  MITK_TEST(TestBoundedQueueKeepLatest);
+  MITK_TEST(TestBoundedQueueSeveralProducers);
+  MITK_TEST(TestMessageQueueBackpressurePolicies);
+  MITK_TEST(TestLoopbackThroughputAndLatency);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  mitk::IGTLServer::Pointer m_Server;
+  mitk::IGTLClient::Pointer m_Client;
+
+  template <typename TCondition>
+  bool WaitFor(TCondition condition, int timeoutMsec)
+  {
+    auto start = std::chrono::steady_clock::now();
+    while (!condition())
+    {
+      if (std::chrono::steady_clock::now() - start > std::chrono::milliseconds(timeoutMsec))
+        return false;
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+  }
+
+  igtl::MessageBase::Pointer CreateStringMessage(int index)
+  {
+    igtl::StringMessage::Pointer message = igtl::StringMessage::New();
+    message->SetDeviceName("Loopback");
+    message->SetString(std::to_string(index).c_str());
+    return message.GetPointer();
+  }
+
+public:
+
+  void setUp() override
+  {
+    m_Server = mitk::IGTLServer::New(true);
+    m_Server->SetName("Loopback Server");
+    m_Server->SetHostname(HOSTNAME);
+    m_Server->SetPortNumber(PORT);
+
+    m_Client = mitk::IGTLClient::New(true);
+    m_Client->SetName("Loopback Client");
+    m_Client->SetHostname(HOSTNAME);
+    m_Client->SetPortNumber(PORT);
+  }
+
+  void tearDown() override
+  {
+    m_Client = nullptr;
+    m_Server = nullptr;
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  }
+
+  void TestBoundedQueueDropOldest()
+  {
+    mitk::IGTLBoundedQueue<int> queue(5);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(8), queue.GetCapacity());
+
+    std::size_t dropped = 0;
+    for (int i = 0; i < 20; ++i)
+      dropped += queue.Push(i);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(12), dropped);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(8), queue.GetSize());
+
+    int value = -1;
+    for (int i = 12; i < 20; ++i)
+    {
+      CPPUNIT_ASSERT(queue.TryPop(value));
+      CPPUNIT_ASSERT_EQUAL(i, value);
+    }
+    CPPUNIT_ASSERT_MESSAGE("Testing pop from an empty queue", !queue.TryPop(value));
+  }
+
+  void TestBoundedQueueKeepLatest()
+  {
+    mitk::IGTLBoundedQueue<int> queue(8, mitk::IGTLBackpressurePolicy::KeepLatest);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(0), queue.Push(1));
+    CPPUNIT_ASSERT_EQUAL(std::size_t(1), queue.Push(2));
+    CPPUNIT_ASSERT_EQUAL(std::size_t(1), queue.Push(3));
+    CPPUNIT_ASSERT_EQUAL(std::size_t(1), queue.GetSize());
+
+    int value = -1;
+    CPPUNIT_ASSERT(queue.TryPop(value));
+    CPPUNIT_ASSERT_EQUAL(3, value);
+    CPPUNIT_ASSERT(!queue.TryPop(value));
+  }
+
+  void TestBoundedQueueSeveralProducers()
+  {
+    const int numberOfProducers = 4;
+    const int numberOfElements = 50000;
+    mitk::IGTLBoundedQueue<int> queue(64);
+
+    std::vector<std::thread> producers;
+    for (int producer = 0; producer < numberOfProducers; ++producer)
+    {
+      producers.emplace_back([&queue, producer, numberOfElements]()
+      {
+        for (int i = 0; i < numberOfElements; ++i)
+          while (!queue.TryPush(producer * numberOfElements + i))
+            std::this_thread::yield();
+      });
+    }
+
+    // the elements of every producer arrive in order
+    std::vector<int> next(numberOfProducers, 0);
+    bool inOrder = true;
+    int value = 0;
+    for (int received = 0; received < numberOfProducers * numberOfElements;)
+    {
+      if (queue.TryPop(value))
+      {
+        int producer = value / numberOfElements;
+        inOrder = inOrder && value % numberOfElements == next[producer];
+        ++next[producer];
+        ++received;
+      }
+      else
+      {
+        std::this_thread::yield();
+      }
+    }
+    for (auto& producer : producers)
+      producer.join();
+
+    CPPUNIT_ASSERT_MESSAGE("Testing if the elements of every producer arrive in order", inOrder);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(0), queue.GetSize());
+  }
+
+  void TestMessageQueueBackpressurePolicies()
+  {
+    mitk::IGTLMessageQueue::Pointer queue = mitk::IGTLMessageQueue::New();
+    queue->EnableNoBufferingMode(false);
+    queue->SetBackpressurePolicy(mitk::IGTLMessageQueue::TrackingDataQueue, mitk::IGTLBackpressurePolicy::KeepLatest);
+
+    for (int i = 0; i < 10; ++i)
+    {
+      queue->PushMessage(this->CreateStringMessage(i));
+      igtl::TrackingDataMessage::Pointer trackingData = igtl::TrackingDataMessage::New();
+      trackingData->SetDeviceName(std::to_string(i).c_str());
+      queue->PushMessage(trackingData.GetPointer());
+    }
+
+    CPPUNIT_ASSERT_EQUAL(11, queue->GetSize());
+    CPPUNIT_ASSERT_EQUAL(9ull, queue->GetNumberOfDroppedMessages());
+    CPPUNIT_ASSERT_EQUAL(std::string("9"), std::string(queue->PullTrackingMessage()->GetDeviceName()));
+    CPPUNIT_ASSERT(queue->PullTrackingMessage().IsNull());
+    for (int i = 0; i < 10; ++i)
+      CPPUNIT_ASSERT_EQUAL(std::to_string(i), std::string(queue->PullStringMessage()->GetString()));
+
+    // more messages than the queue can hold, the oldest ones are dropped
+    const unsigned int numberOfMessages = mitk::IGTLMessageQueue::QueueCapacity + 10;
+    for (unsigned int i = 0; i < numberOfMessages; ++i)
+      queue->PushMessage(this->CreateStringMessage(i));
+    CPPUNIT_ASSERT_EQUAL(19ull, queue->GetNumberOfDroppedMessages());
+    CPPUNIT_ASSERT_EQUAL(std::string("10"), std::string(queue->PullStringMessage()->GetString()));
+  }
+
+  void TestLoopbackThroughputAndLatency()
+  {
+    const unsigned int numberOfMessages = 2000;
+
+    CPPUNIT_ASSERT_MESSAGE("Could not open Connection with Server", m_Server->OpenConnection());
+    CPPUNIT_ASSERT_MESSAGE("Could not start communication with server", m_Server->StartCommunication());
+    CPPUNIT_ASSERT_MESSAGE("Could not connect to Server with client", m_Client->OpenConnection());
+    CPPUNIT_ASSERT_MESSAGE("Could not start communication with client", m_Client->StartCommunication());
+    CPPUNIT_ASSERT_MESSAGE("Server did not accept the client",
+      this->WaitFor([this]() { return m_Server->GetNumberOfConnections() > 0; }, 2000));
+
+    // the statistics count every message, the test only pulls the last one
+    m_Client->EnableNoBufferingMode(true);
+    m_Server->EnableNoBufferingMode(false);
+
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < numberOfMessages; ++i)
+    {
+      igtl::StatusMessage::Pointer message = igtl::StatusMessage::New();
+      message->SetDeviceName("Loopback");
+      message->SetStatusString(std::to_string(i).c_str());
+      igtl::TimeStamp::Pointer timeStamp = igtl::TimeStamp::New();
+      timeStamp->GetTime();
+      message->SetTimeStamp(timeStamp);
+      m_Server->SendMessage(mitk::IGTLMessage::New(message.GetPointer()));
+
+      // do not overrun the send queue, this test measures the transfer and not the queue
+      if (!this->WaitFor([this]() { return m_Server->GetMessageQueue()->GetSendQueueSize() < 128; }, 2000))
+        break;
+    }
+
+    bool allReceived = this->WaitFor([this, numberOfMessages]()
+    {
+      return m_Client->GetCommunicationStatistics().ReceivedMessages >= numberOfMessages;
+    }, 10000);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    mitk::IGTLDevice::CommunicationStatistics sent = m_Server->GetCommunicationStatistics();
+    mitk::IGTLDevice::CommunicationStatistics received = m_Client->GetCommunicationStatistics();
+    MITK_INFO << "Loopback: " << received.ReceivedMessages << " messages (" << received.ReceivedBytes << " bytes) in "
+      << seconds << " s, " << received.ReceivedMessages / seconds << " messages/s, mean latency "
+      << received.MeanLatency * 1000.0 << " ms, maximum latency " << received.MaximumLatency * 1000.0 << " ms";
+
+    igtl::MessageBase::Pointer lastMessage = m_Client->GetNextMiscMessage();
+
+    CPPUNIT_ASSERT(m_Client->CloseConnection());
+    CPPUNIT_ASSERT(m_Server->CloseConnection());
+
+    CPPUNIT_ASSERT_MESSAGE("Not all messages were received", allReceived);
+    CPPUNIT_ASSERT_EQUAL((unsigned long long)numberOfMessages, sent.SentMessages);
+    CPPUNIT_ASSERT_EQUAL(sent.SentBytes, received.ReceivedBytes);
+    CPPUNIT_ASSERT_EQUAL((unsigned long long)0, sent.DroppedMessages);
+    CPPUNIT_ASSERT(received.MeanLatency >= 0.0 && received.MeanLatency <= received.MaximumLatency);
+
+    igtl::StatusMessage::Pointer lastStatus = dynamic_cast<igtl::StatusMessage*>(lastMessage.GetPointer());
+    CPPUNIT_ASSERT_MESSAGE("The client did not keep the latest message", lastStatus.IsNotNull());
+    CPPUNIT_ASSERT_EQUAL(std::to_string(numberOfMessages - 1), std::string(lastStatus->GetStatusString()));
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkOpenIGTLinkLoopback)
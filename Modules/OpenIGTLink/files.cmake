@@ -9,7 +9,10 @@ set(CPP_FILES
   mitkIGTLMessageFactory.cpp
   mitkIGTLMessageCloneHandler.h
   mitkIGTLDummyMessage.cpp
+  mitkIGTLCompressedImageMessage.cpp
+  mitkIGTLImageStreamCodec.cpp
   mitkIGTLMessageQueue.cpp
+  mitkIGTLIOReactor.cpp
   mitkIGTLMessageProvider.cpp
   mitkIGTLMeasurements.cpp
   mitkIGTLModuleActivator.cpp
@@ -0,0 +1,196 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef MITKIGTLBOUNDEDQUEUE_H
+#define MITKIGTLBOUNDEDQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace mitk {
+  /**
+  * \brief What a full IGTLBoundedQueue does with a new element: DropOldest
+  * removes the oldest elements until it fits, KeepLatest keeps only the new one.
+  *
+  * \ingroup OpenIGTLink
+  */
+  enum class IGTLBackpressurePolicy { DropOldest, KeepLatest };
+
+  /**
+  * \class IGTLBoundedQueue
+  * \brief Bounded queue without locks that can be used by any number of
+  * producer and consumer threads.
+  *
+  * Every slot carries a sequence number that tells producers and consumers
+  * whether it is free or filled, so a thread only has to win one
+  * compare-and-swap on the enqueue or dequeue position to own a slot. The
+  * capacity is rounded up to a power of two.
+  *
+  * When the queue is full, Push() applies the backpressure policy: DropOldest
+  * removes the oldest elements until the new one fits, KeepLatest removes all
+  * elements so that only the newest one is queued. Removed elements are
+  * reset to a default constructed value, so queued smart pointers release
+  * their messages as soon as they leave the queue.
+  *
+  * \ingroup OpenIGTLink
+  */
+  template <typename T>
+  class IGTLBoundedQueue
+  {
+  public:
+    typedef IGTLBackpressurePolicy BackpressurePolicy;
+
+    explicit IGTLBoundedQueue(std::size_t capacity, BackpressurePolicy policy = BackpressurePolicy::DropOldest)
+      : m_Policy(policy), m_EnqueuePosition(0), m_DequeuePosition(0)
+    {
+      std::size_t size = 2;
+      while (size < capacity)
+        size *= 2;
+      m_Mask = size - 1;
+      m_Cells.reset(new Cell[size]);
+      for (std::size_t i = 0; i < size; ++i)
+        m_Cells[i].Sequence.store(i, std::memory_order_relaxed);
+    }
+
+    IGTLBoundedQueue(const IGTLBoundedQueue&) = delete;
+    IGTLBoundedQueue& operator=(const IGTLBoundedQueue&) = delete;
+
+    std::size_t GetCapacity() const
+    {
+      return m_Mask + 1;
+    }
+
+    void SetBackpressurePolicy(BackpressurePolicy policy)
+    {
+      m_Policy.store(policy, std::memory_order_relaxed);
+    }
+
+    BackpressurePolicy GetBackpressurePolicy() const
+    {
+      return m_Policy.load(std::memory_order_relaxed);
+    }
+
+    /**
+    * \brief Adds the value and returns the number of elements that were
+    * dropped to make room for it.
+    */
+    std::size_t Push(const T& value)
+    {
+      std::size_t dropped = 0;
+      if (this->GetBackpressurePolicy() == BackpressurePolicy::KeepLatest)
+        dropped += this->Clear();
+
+      T discarded;
+      while (!this->TryPush(value))
+      {
+        if (this->TryPop(discarded))
+          ++dropped;
+      }
+      return dropped;
+    }
+
+    /** \brief Adds the value, returns false without blocking if the queue is full. */
+    bool TryPush(const T& value)
+    {
+      std::size_t position = m_EnqueuePosition.load(std::memory_order_relaxed);
+      for (;;)
+      {
+        Cell& cell = m_Cells[position & m_Mask];
+        const std::size_t sequence = cell.Sequence.load(std::memory_order_acquire);
+        const std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+        if (difference == 0)
+        {
+          if (m_EnqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+          {
+            cell.Value = value;
+            cell.Sequence.store(position + 1, std::memory_order_release);
+            return true;
+          }
+        }
+        else if (difference < 0)
+        {
+          return false;
+        }
+        else
+        {
+          position = m_EnqueuePosition.load(std::memory_order_relaxed);
+        }
+      }
+    }
+
+    /** \brief Removes the oldest element, returns false if the queue is empty. */
+    bool TryPop(T& value)
+    {
+      std::size_t position = m_DequeuePosition.load(std::memory_order_relaxed);
+      for (;;)
+      {
+        Cell& cell = m_Cells[position & m_Mask];
+        const std::size_t sequence = cell.Sequence.load(std::memory_order_acquire);
+        const std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1);
+        if (difference == 0)
+        {
+          if (m_DequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+          {
+            value = cell.Value;
+            cell.Value = T();
+            cell.Sequence.store(position + m_Mask + 1, std::memory_order_release);
+            return true;
+          }
+        }
+        else if (difference < 0)
+        {
+          return false;
+        }
+        else
+        {
+          position = m_DequeuePosition.load(std::memory_order_relaxed);
+        }
+      }
+    }
+
+    /** \brief Removes all elements and returns how many were removed. */
+    std::size_t Clear()
+    {
+      std::size_t removed = 0;
+      T discarded;
+      while (this->TryPop(discarded))
+        ++removed;
+      return removed;
+    }
+
+    /** \brief Returns the number of elements; only a snapshot while other threads use the queue. */
+    std::size_t GetSize() const
+    {
+      const std::size_t dequeuePosition = m_DequeuePosition.load(std::memory_order_acquire);
+      const std::size_t enqueuePosition = m_EnqueuePosition.load(std::memory_order_acquire);
+      return enqueuePosition > dequeuePosition ? enqueuePosition - dequeuePosition : 0;
+    }
+
+  private:
+    struct Cell
+    {
+      std::atomic<std::size_t> Sequence;
+      T Value;
+    };
+
+    std::unique_ptr<Cell[]> m_Cells;
+    std::size_t m_Mask;
+    std::atomic<BackpressurePolicy> m_Policy;
+    char m_Padding0[64]; ///< keeps the positions on different cache lines, producers and consumers write only one of them
+    std::atomic<std::size_t> m_EnqueuePosition;
+    char m_Padding1[64];
+    std::atomic<std::size_t> m_DequeuePosition;
+  };
+}
+
+#endif
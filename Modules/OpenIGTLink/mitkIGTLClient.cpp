@@ -11,6 +11,7 @@ found in the LICENSE file.
 ============================================================================*/
 
 #include "mitkIGTLClient.h"
+#include "mitkIGTLIOReactor.h"
 //#include "mitkIGTTimeStamp.h"
 //#include "mitkIGTHardwareException.h"
 #include "igtlTrackingDataMessage.h"
@@ -112,6 +113,9 @@ void mitk::IGTLClient::StopCommunicationWithSocket(igtl::Socket* /*socket*/)
   m_StopCommunicationMutex->Lock();
   m_StopCommunication = true;
   m_StopCommunicationMutex->Unlock();
+  // the client has only one socket, so there is nothing left to communicate
+  if (this->IsUsingReactor())
+    IGTLIOReactor::GetInstance()->RemoveDevice(this);
 }
 
 unsigned int mitk::IGTLClient::GetNumberOfConnections()
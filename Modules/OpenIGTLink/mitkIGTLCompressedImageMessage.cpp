@@ -0,0 +1,191 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "mitkIGTLCompressedImageMessage.h"
+
+#include "igtl_header.h"
+
+#include <itkByteSwapper.h>
+#include <itk_zlib.h>
+
+#include <cstring>
+
+namespace
+{
+  template <typename T>
+  void WriteBigEndian(unsigned char*& buffer, T value)
+  {
+    itk::ByteSwapper<T>::SwapFromSystemToBigEndian(&value);
+    std::memcpy(buffer, &value, sizeof(T));
+    buffer += sizeof(T);
+  }
+
+  template <typename T>
+  T ReadBigEndian(const unsigned char*& buffer)
+  {
+    T value;
+    std::memcpy(&value, buffer, sizeof(T));
+    itk::ByteSwapper<T>::SwapFromSystemToBigEndian(&value);
+    buffer += sizeof(T);
+    return value;
+  }
+}
+
+const igtlUint16 mitk::IGTLCompressedImageMessage::ContentVersion;
+const unsigned int mitk::IGTLCompressedImageMessage::ContentHeaderSize;
+
+mitk::IGTLCompressedImageMessage::IGTLCompressedImageMessage() : ImageMessage(), m_UncompressedSize(0), m_FrameNumber(0)
+{
+  m_SendMessageType = "ZIMAGE";
+  m_Header = igtl::MessageHeader::New();
+}
+
+mitk::IGTLCompressedImageMessage::~IGTLCompressedImageMessage()
+{
+}
+
+void mitk::IGTLCompressedImageMessage::Compress(igtl::ImageMessage* image, int compressionLevel)
+{
+  int dimensions[3];
+  int size[3];
+  int offset[3];
+  image->GetDimensions(dimensions);
+  image->GetSubVolume(size, offset);
+  this->SetDimensions(dimensions);
+  this->SetSubVolume(size, offset);
+  this->SetDeviceName(image->GetDeviceName());
+  igtl::TimeStamp::Pointer timeStamp = igtl::TimeStamp::New();
+  image->GetTimeStamp(timeStamp);
+  this->SetTimeStamp(timeStamp);
+
+  // the vector keeps its capacity, so compressing frames of the same size does not allocate
+  m_UncompressedSize = image->GetPackSize();
+  uLongf compressedSize = compressBound(m_UncompressedSize);
+  m_CompressedData.resize(compressedSize);
+  if (compress2(m_CompressedData.data(), &compressedSize, static_cast<const Bytef*>(image->GetPackPointer()),
+    m_UncompressedSize, compressionLevel) != Z_OK)
+  {
+    m_CompressedData.clear();
+    m_UncompressedSize = 0;
+    return;
+  }
+  m_CompressedData.resize(compressedSize);
+  this->AllocatePack();
+}
+
+bool mitk::IGTLCompressedImageMessage::Decompress(igtl::ImageMessage* image)
+{
+  if (m_CompressedData.empty() || m_UncompressedSize < IGTL_HEADER_SIZE)
+    return false;
+
+  z_stream stream;
+  std::memset(&stream, 0, sizeof(stream));
+  stream.next_in = m_CompressedData.data();
+  stream.avail_in = m_CompressedData.size();
+  if (inflateInit(&stream) != Z_OK)
+    return false;
+
+  // inflate the header first, then the body directly into the buffer of the message
+  m_Header->InitPack();
+  stream.next_out = static_cast<Bytef*>(m_Header->GetPackPointer());
+  stream.avail_out = IGTL_HEADER_SIZE;
+  int result = inflate(&stream, Z_SYNC_FLUSH);
+  if ((result != Z_OK && result != Z_STREAM_END) || stream.avail_out != 0
+    || !(m_Header->Unpack() & igtl::MessageHeader::UNPACK_HEADER)
+    || IGTL_HEADER_SIZE + m_Header->GetBodySizeToRead() != m_UncompressedSize)
+  {
+    inflateEnd(&stream);
+    return false;
+  }
+
+  image->SetMessageHeader(m_Header);
+  image->AllocatePack();
+  stream.next_out = static_cast<Bytef*>(image->GetPackBodyPointer());
+  stream.avail_out = image->GetPackBodySize();
+  result = inflate(&stream, Z_FINISH);
+  inflateEnd(&stream);
+  if (result != Z_STREAM_END || stream.avail_out != 0)
+    return false;
+
+  return (image->Unpack(1) & igtl::MessageHeader::UNPACK_BODY) != 0;
+}
+
+unsigned int mitk::IGTLCompressedImageMessage::GetUncompressedSize() const
+{
+  return m_UncompressedSize;
+}
+
+unsigned int mitk::IGTLCompressedImageMessage::GetCompressedSize() const
+{
+  return m_CompressedData.size();
+}
+
+igtlUint64 mitk::IGTLCompressedImageMessage::CalculateContentBufferSize()
+{
+  return ContentHeaderSize + m_CompressedData.size();
+}
+
+int mitk::IGTLCompressedImageMessage::PackContent()
+{
+  // the buffer was allocated by Compress()
+  int dimensions[3];
+  int size[3];
+  int offset[3];
+  this->GetDimensions(dimensions);
+  this->GetSubVolume(size, offset);
+
+  unsigned char* content = m_Content;
+  WriteBigEndian<igtlUint16>(content, ContentVersion);
+  for (int i = 0; i < 3; ++i)
+    WriteBigEndian<igtlInt32>(content, dimensions[i]);
+  for (int i = 0; i < 3; ++i)
+    WriteBigEndian<igtlInt32>(content, size[i]);
+  for (int i = 0; i < 3; ++i)
+    WriteBigEndian<igtlInt32>(content, offset[i]);
+  WriteBigEndian<igtlUint32>(content, m_FrameNumber);
+  WriteBigEndian<igtlUint32>(content, m_UncompressedSize);
+  WriteBigEndian<igtlUint32>(content, m_CompressedData.size());
+  if (!m_CompressedData.empty())
+    std::memcpy(content, m_CompressedData.data(), m_CompressedData.size());
+  return 1;
+}
+
+int mitk::IGTLCompressedImageMessage::UnpackContent()
+{
+  if (this->GetPackBodySize() < ContentHeaderSize)
+    return 0;
+
+  const unsigned char* content = m_Content;
+  if (ReadBigEndian<igtlUint16>(content) != ContentVersion)
+    return 0;
+
+  int dimensions[3];
+  int size[3];
+  int offset[3];
+  for (int i = 0; i < 3; ++i)
+    dimensions[i] = ReadBigEndian<igtlInt32>(content);
+  for (int i = 0; i < 3; ++i)
+    size[i] = ReadBigEndian<igtlInt32>(content);
+  for (int i = 0; i < 3; ++i)
+    offset[i] = ReadBigEndian<igtlInt32>(content);
+  this->SetDimensions(dimensions);
+  if (!this->SetSubVolume(size, offset))
+    return 0;
+
+  m_FrameNumber = ReadBigEndian<igtlUint32>(content);
+  m_UncompressedSize = ReadBigEndian<igtlUint32>(content);
+  igtlUint32 compressedSize = ReadBigEndian<igtlUint32>(content);
+  if (ContentHeaderSize + compressedSize > this->GetPackBodySize())
+    return 0;
+  m_CompressedData.assign(content, content + compressedSize);
+  return 1;
+}
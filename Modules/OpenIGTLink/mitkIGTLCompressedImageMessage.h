@@ -0,0 +1,103 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef MITKIGTLCOMPRESSEDIMAGEMESSAGE_H
+#define MITKIGTLCOMPRESSEDIMAGEMESSAGE_H
+
+#include "MitkOpenIGTLinkExports.h"
+
+#include "igtlImageMessage.h"
+#include "igtlMessageHeader.h"
+
+#include <vector>
+
+namespace mitk
+{
+
+/**
+ * \class IGTLCompressedImageMessage
+ * \brief Image message whose content is a zlib compressed IMAGE message
+ *
+ * The message is sent with the device type ZIMAGE. It keeps the dimensions
+ * and the sub-volume of the compressed image uncompressed, so receive queues
+ * can sort it like an IMAGE message. Decompress() restores the original IMAGE
+ * message, including a sub-volume if the original message only contained one.
+ *
+ * Image streams that only send the changed regions number their frames, so
+ * that the receiver can detect a lost frame (see IGTLImageStreamDecoder).
+ *
+ * Compression is lossless, so it pays off for images with large uniform
+ * areas, e.g. ultrasound volumes with a masked out background.
+*/
+class MITKOPENIGTLINK_EXPORT IGTLCompressedImageMessage : public igtl::ImageMessage
+{
+public:
+  typedef IGTLCompressedImageMessage           Self;
+  typedef igtl::ImageMessage                   Superclass;
+  typedef igtl::SmartPointer<Self>             Pointer;
+  typedef igtl::SmartPointer<const Self>       ConstPointer;
+
+  igtlTypeMacro(mitk::IGTLCompressedImageMessage, igtl::ImageMessage);
+  igtlNewMacro(mitk::IGTLCompressedImageMessage);
+
+  /**
+   * \brief Compresses the given image message, which has to be packed.
+   * \param compressionLevel zlib compression level from 1 (fastest) to 9 (smallest),
+   * 0 stores the data uncompressed
+   */
+  void Compress(igtl::ImageMessage* image, int compressionLevel = 1);
+
+  /**
+   * \brief Restores the compressed image message into the given message.
+   * The buffer of the given message is reused if its size fits.
+   * \return false if the compressed data is corrupt
+   */
+  bool Decompress(igtl::ImageMessage* image);
+
+  /**
+   * \brief Returns the size of the packed image message before compression
+   */
+  unsigned int GetUncompressedSize() const;
+
+  /**
+   * \brief Returns the size of the compressed data
+   */
+  unsigned int GetCompressedSize() const;
+
+  /**
+   * \brief Number of the frame within its image stream, 0 if the stream is not numbered
+   */
+  void SetFrameNumber(igtlUint32 frameNumber) { m_FrameNumber = frameNumber; }
+  igtlUint32 GetFrameNumber() const { return m_FrameNumber; }
+
+protected:
+  IGTLCompressedImageMessage();
+  ~IGTLCompressedImageMessage() override;
+
+  igtlUint64 CalculateContentBufferSize() override;
+  int PackContent() override;
+  int UnpackContent() override;
+
+  /** version of the content layout */
+  static const igtlUint16 ContentVersion = 1;
+  /** version, dimensions, sub-volume size and offset, frame number, uncompressed and compressed size */
+  static const unsigned int ContentHeaderSize = 2 + 3 * 3 * 4 + 4 + 2 * 4;
+
+  std::vector<unsigned char> m_CompressedData;
+  igtlUint32 m_UncompressedSize;
+  igtlUint32 m_FrameNumber;
+  igtl::MessageHeader::Pointer m_Header;
+};
+
+} // namespace mitk
+
+#endif
@@ -11,6 +11,7 @@ found in the LICENSE file.
 ============================================================================*/
 
 #include "mitkIGTLDevice.h"
+#include "mitkIGTLIOReactor.h"
 //#include "mitkIGTException.h"
 //#include "mitkIGTTimeStamp.h"
 #include <itkMutexLockHolder.h>
@@ -37,7 +38,10 @@ m_StopCommunication(false),
 m_Hostname("127.0.0.1"),
 m_PortNumber(-1),
 m_LogMessages(false),
-m_MultiThreader(nullptr), m_SendThreadID(0), m_ReceiveThreadID(0), m_ConnectThreadID(0)
+m_MultiThreader(nullptr), m_SendThreadID(0), m_ReceiveThreadID(0), m_ConnectThreadID(0),
+m_UsingReactor(false),
+m_SentMessages(0), m_SentBytes(0), m_ReceivedMessages(0), m_ReceivedBytes(0), m_DroppedMessagesAtReset(0),
+m_NumberOfLatencies(0), m_LatencySum(0.0), m_MaximumLatency(0.0)
 {
   m_ReadFully = ReadFully;
   m_StopCommunicationMutex = itk::FastMutexLock::New();
@@ -163,6 +167,7 @@ unsigned int mitk::IGTLDevice::ReceivePrivate(igtl::Socket* socket)
 
       headerMsg->GetTimeStamp(ts);
       ts->GetTimeStamp(&sec, &nanosec);
+      double sentTime = ts->GetTimeStamp();
 
       //      std::cerr << "Time stamp: "
       //                << sec << "."
@@ -181,6 +186,7 @@ unsigned int mitk::IGTLDevice::ReceivePrivate(igtl::Socket* socket)
         std::strstr(curDevType, "STP_") != nullptr ||
         std::strstr(curDevType, "RTS_") != nullptr)
       {
+        this->AddReceivedMessage(headerMsg->GetPackSize(), sentTime);
         this->m_MessageQueue->PushCommandMessage(headerMsg);
         this->InvokeEvent(CommandReceivedEvent());
         return IGTL_STATUS_OK;
@@ -222,6 +228,7 @@ unsigned int mitk::IGTLDevice::ReceivePrivate(igtl::Socket* socket)
         //otherwise into the normal receive queue
         //STP_ commands are handled here because they implemented additional
         //member variables that are not stored in the header message
+        this->AddReceivedMessage(curMessage->GetPackSize(), sentTime);
         if (std::strstr(curDevType, "STT_") != nullptr)
         {
           this->m_MessageQueue->PushCommandMessage(curMessage);
@@ -259,9 +266,82 @@ unsigned int mitk::IGTLDevice::ReceivePrivate(igtl::Socket* socket)
   }
 }
 
+void mitk::IGTLDevice::AddReceivedMessage(unsigned long long size, double sentTime)
+{
+  ++m_ReceivedMessages;
+  m_ReceivedBytes += size;
+  if (sentTime <= 0.0)
+    return;
+
+  igtl::TimeStamp::Pointer now = igtl::TimeStamp::New();
+  now->GetTime();
+  double latency = now->GetTimeStamp() - sentTime;
+  m_LatencySum = m_LatencySum + latency;
+  if (latency > m_MaximumLatency)
+    m_MaximumLatency = latency;
+  ++m_NumberOfLatencies;
+}
+
+mitk::IGTLDevice::CommunicationStatistics mitk::IGTLDevice::GetCommunicationStatistics() const
+{
+  CommunicationStatistics statistics;
+  statistics.SentMessages = m_SentMessages;
+  statistics.SentBytes = m_SentBytes;
+  statistics.ReceivedMessages = m_ReceivedMessages;
+  statistics.ReceivedBytes = m_ReceivedBytes;
+  statistics.DroppedMessages = m_MessageQueue->GetNumberOfDroppedMessages() - m_DroppedMessagesAtReset;
+  unsigned long long numberOfLatencies = m_NumberOfLatencies;
+  statistics.MeanLatency = numberOfLatencies > 0 ? m_LatencySum / numberOfLatencies : 0.0;
+  statistics.MaximumLatency = m_MaximumLatency;
+  return statistics;
+}
+
+void mitk::IGTLDevice::ResetCommunicationStatistics()
+{
+  m_SentMessages = 0;
+  m_SentBytes = 0;
+  m_ReceivedMessages = 0;
+  m_ReceivedBytes = 0;
+  m_DroppedMessagesAtReset = m_MessageQueue->GetNumberOfDroppedMessages();
+  m_NumberOfLatencies = 0;
+  m_LatencySum = 0.0;
+  m_MaximumLatency = 0.0;
+}
+
+void mitk::IGTLDevice::ReceiveFromSocket(igtl::Socket* socket)
+{
+  unsigned int status = this->ReceivePrivate(socket);
+  if (status == IGTL_STATUS_NOT_PRESENT)
+  {
+    this->StopCommunicationWithSocket(socket);
+    //inform observers about loosing the connection to this socket
+    this->InvokeEvent(LostConnectionEvent());
+    MITK_WARN("IGTLDevice") << "Lost connection to a socket.";
+  }
+}
+
 void mitk::IGTLDevice::SendMessage(mitk::IGTLMessage::Pointer msg)
 {
   m_MessageQueue->PushSendMessage(msg);
+  if (m_UsingReactor)
+    IGTLIOReactor::GetInstance()->WakeUp();
+}
+
+void mitk::IGTLDevice::SendQueuedMessages()
+{
+  // only the messages queued so far, a fast producer must not block the other devices
+  for (int i = m_MessageQueue->GetSendQueueSize(); i > 0; --i)
+    this->Send();
+}
+
+void mitk::IGTLDevice::AddSocketsToReactor(IGTLIOReactor* reactor)
+{
+  reactor->AddSocket(this, m_Socket, false);
+}
+
+bool mitk::IGTLDevice::IsUsingReactor() const
+{
+  return m_UsingReactor;
 }
 
 unsigned int mitk::IGTLDevice::SendMessagePrivate(mitk::IGTLMessage::Pointer msg,
@@ -284,6 +364,8 @@ unsigned int mitk::IGTLDevice::SendMessagePrivate(mitk::IGTLMessage::Pointer msg
 
   if (sendSuccess)
   {
+    ++m_SentMessages;
+    m_SentBytes += sendMessage->GetPackSize();
     if (m_LogMessages) { MITK_INFO << "Send IGTL message: " << msg->ToString(); }
     this->InvokeEvent(MessageSentEvent());
     return IGTL_STATUS_OK;
@@ -357,6 +439,19 @@ bool mitk::IGTLDevice::StartCommunication()
   this->m_StopCommunication = false;
   this->m_StopCommunicationMutex->Unlock();
 
+  this->ResetCommunicationStatistics();
+
+  // let the shared communication thread wait for the sockets instead of
+  // polling them in three threads
+  if (IGTLIOReactor::IsSupported())
+  {
+    IGTLIOReactor* reactor = IGTLIOReactor::GetInstance();
+    m_UsingReactor = true;
+    reactor->AddDevice(this);
+    this->AddSocketsToReactor(reactor);
+    return true;
+  }
+
   // transfer the execution rights to tracking thread
   m_SendingFinishedMutex->Unlock();
   m_ReceivingFinishedMutex->Unlock();
@@ -382,6 +477,14 @@ bool mitk::IGTLDevice::StopCommunication()
     m_StopCommunicationMutex->Lock();
     m_StopCommunication = true;
     m_StopCommunicationMutex->Unlock();
+    if (m_UsingReactor)
+    {
+      // the reactor does not call into this device anymore when this returns
+      IGTLIOReactor::GetInstance()->RemoveDevice(this);
+      m_UsingReactor = false;
+      this->SetState(Ready);
+      return true;
+    }
     // we have to wait here that the other thread recognizes the STOP-command
     // and executes it
     m_SendingFinishedMutex->Lock();
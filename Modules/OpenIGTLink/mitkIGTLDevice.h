@@ -31,7 +31,11 @@ found in the LICENSE file.
 #include "mitkIGTLMessageQueue.h"
 #include "mitkIGTLMessage.h"
 
+#include <atomic>
+
 namespace mitk {
+  class IGTLIOReactor;
+
   /**
   * \brief Interface for all OpenIGTLink Devices
   *
@@ -47,7 +51,9 @@ namespace mitk {
   * OpenConnection() and arrive in the Ready state. From the Ready state you
   * call StartCommunication() to arrive in the Running state. Now the device
   * is continuosly checking for new connections, receiving messages and
-  * sending messages. This runs in a seperate thread. To stop the communication
+  * sending messages. This runs in a seperate thread. On Linux all devices
+  * share one event driven communication thread (see IGTLIOReactor), on other
+  * platforms every device runs its own threads. To stop the communication
   * call StopCommunication() (to arrive in Ready state) or CloseConnection()
   * (to arrive in the Setup state).
   *
@@ -61,6 +67,29 @@ namespace mitk {
 
       IGTLDevice(bool ReadFully);
 
+    /**
+    * \brief Throughput and latency of the communication since the
+    * communication was started or the statistics were reset.
+    *
+    * The latency is the time between the time stamp in the header of a
+    * received message and its arrival in the receive queue. Messages
+    * without a time stamp are not taken into account. The time stamps are
+    * only comparable if both devices run on the same host or use
+    * synchronized clocks.
+    */
+    struct CommunicationStatistics
+    {
+      unsigned long long SentMessages;
+      unsigned long long SentBytes;
+      unsigned long long ReceivedMessages;
+      unsigned long long ReceivedBytes;
+      /** messages dropped by the receive and send queues */
+      unsigned long long DroppedMessages;
+      /** latencies in seconds */
+      double MeanLatency;
+      double MaximumLatency;
+    };
+
     /**
      * \brief Type for state variable.
      * The IGTLDevice is always in one of these states.
@@ -248,7 +277,20 @@ namespace mitk {
     itkGetMacro(LogMessages, bool);
     itkSetMacro(LogMessages, bool);
 
+    /**
+    * \brief Returns the throughput and latency of the communication
+    */
+    CommunicationStatistics GetCommunicationStatistics() const;
+
+    /**
+    * \brief Resets the communication statistics, this is also done by
+    * StartCommunication()
+    */
+    void ResetCommunicationStatistics();
+
   protected:
+    friend class IGTLIOReactor;
+
     /**
      * \brief Sends a message.
      *
@@ -289,6 +331,29 @@ namespace mitk {
     */
     unsigned int ReceivePrivate(igtl::Socket* device);
 
+    /**
+    * \brief Receives a message from the given socket and stops the
+    * communication with the socket if it is not connected anymore.
+    */
+    virtual void ReceiveFromSocket(igtl::Socket* socket);
+
+    /**
+    * \brief Sends the messages that are currently in the send queue
+    */
+    void SendQueuedMessages();
+
+    /**
+    * \brief Adds the sockets of this device to the shared communication
+    * thread. The default implementation adds m_Socket.
+    */
+    virtual void AddSocketsToReactor(IGTLIOReactor* reactor);
+
+    /**
+    * \brief Returns true if the communication runs in the shared
+    * communication thread instead of the threads of this device.
+    */
+    bool IsUsingReactor() const;
+
     /**
     * \brief Call this method to send a message. The message will be read from
     * the queue.
@@ -353,6 +418,8 @@ namespace mitk {
     bool m_LogMessages;
 
   private:
+    /** updates the statistics for a received message with the given size and header time stamp */
+    void AddReceivedMessage(unsigned long long size, double sentTime);
 
     /** creates worker thread that continuously polls interface for new
     messages */
@@ -365,6 +432,19 @@ namespace mitk {
     int m_ConnectThreadID;
     /** Always try to read the full message. */
     bool m_ReadFully;
+    /** the communication runs in the shared communication thread */
+    std::atomic<bool> m_UsingReactor;
+
+    /** counters of the communication statistics */
+    std::atomic<unsigned long long> m_SentMessages;
+    std::atomic<unsigned long long> m_SentBytes;
+    std::atomic<unsigned long long> m_ReceivedMessages;
+    std::atomic<unsigned long long> m_ReceivedBytes;
+    std::atomic<unsigned long long> m_DroppedMessagesAtReset;
+    /** latencies are only written by the thread that receives the messages */
+    std::atomic<unsigned long long> m_NumberOfLatencies;
+    std::atomic<double> m_LatencySum;
+    std::atomic<double> m_MaximumLatency;
   };
 
   /**
@@ -0,0 +1,259 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "mitkIGTLIOReactor.h"
+#include "mitkIGTLDevice.h"
+
+#include <mitkLogMacros.h>
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstdint>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+  /** the thread wakes up at least this often to send messages that were queued without WakeUp() */
+  const int WAKE_UP_INTERVAL_MSEC = 100;
+  const int MAXIMUM_NUMBER_OF_EVENTS = 64;
+
+  /** igtl::Socket keeps its descriptor protected, a derived class may name it */
+  struct SocketDescriptorAccess : public igtl::Socket
+  {
+    static int Get(igtl::Socket* socket)
+    {
+      return socket->*(&SocketDescriptorAccess::m_SocketDescriptor);
+    }
+  };
+}
+
+mitk::IGTLIOReactor* mitk::IGTLIOReactor::GetInstance()
+{
+  // never destroyed, devices may still be stopped during static destruction
+  static IGTLIOReactor* instance = new IGTLIOReactor();
+  return instance;
+}
+
+bool mitk::IGTLIOReactor::IsSupported()
+{
+#ifdef __linux__
+  return true;
+#else
+  return false;
+#endif
+}
+
+mitk::IGTLIOReactor::IGTLIOReactor()
+  : m_PollDescriptor(-1), m_WakeUpDescriptor(-1), m_Stop(false)
+{
+#ifdef __linux__
+  m_PollDescriptor = epoll_create1(EPOLL_CLOEXEC);
+  m_WakeUpDescriptor = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (m_PollDescriptor < 0 || m_WakeUpDescriptor < 0)
+  {
+    MITK_ERROR("IGTLIOReactor") << "Could not create the descriptors of the communication thread.";
+    return;
+  }
+
+  epoll_event event = {};
+  event.events = EPOLLIN;
+  event.data.fd = m_WakeUpDescriptor;
+  epoll_ctl(m_PollDescriptor, EPOLL_CTL_ADD, m_WakeUpDescriptor, &event);
+
+  m_Thread = std::thread(&IGTLIOReactor::Run, this);
+#endif
+}
+
+mitk::IGTLIOReactor::~IGTLIOReactor()
+{
+  m_Stop = true;
+  this->WakeUp();
+  if (m_Thread.joinable())
+    m_Thread.join();
+#ifdef __linux__
+  if (m_WakeUpDescriptor >= 0)
+    close(m_WakeUpDescriptor);
+  if (m_PollDescriptor >= 0)
+    close(m_PollDescriptor);
+#endif
+}
+
+int mitk::IGTLIOReactor::GetSocketDescriptor(igtl::Socket* socket)
+{
+  return socket != nullptr ? SocketDescriptorAccess::Get(socket) : -1;
+}
+
+void mitk::IGTLIOReactor::AddDevice(IGTLDevice* device)
+{
+  std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+  m_Devices.insert(device);
+}
+
+void mitk::IGTLIOReactor::AddSocket(IGTLDevice* device, igtl::Socket* socket, bool listening)
+{
+#ifdef __linux__
+  int descriptor = GetSocketDescriptor(socket);
+  if (descriptor < 0)
+  {
+    MITK_WARN("IGTLIOReactor") << "Cannot watch a socket that is not connected.";
+    return;
+  }
+
+  std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+  epoll_event event = {};
+  event.events = EPOLLIN;
+  event.data.fd = descriptor;
+  if (epoll_ctl(m_PollDescriptor, EPOLL_CTL_ADD, descriptor, &event) != 0
+    && (errno != EEXIST || epoll_ctl(m_PollDescriptor, EPOLL_CTL_MOD, descriptor, &event) != 0))
+  {
+    MITK_ERROR("IGTLIOReactor") << "Could not watch socket " << descriptor << ", errno " << errno << ".";
+    return;
+  }
+  Registration registration = { device, socket, listening };
+  m_Registrations[descriptor] = registration;
+#else
+  (void)device;
+  (void)socket;
+  (void)listening;
+#endif
+}
+
+void mitk::IGTLIOReactor::RemoveSocket(igtl::Socket* socket)
+{
+  std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+  // search by pointer, the descriptor of a closed socket is not valid anymore
+  for (auto it = m_Registrations.begin(); it != m_Registrations.end(); ++it)
+  {
+    if (it->second.Socket.GetPointer() == socket)
+    {
+#ifdef __linux__
+      epoll_ctl(m_PollDescriptor, EPOLL_CTL_DEL, it->first, nullptr);
+#endif
+      m_Registrations.erase(it);
+      return;
+    }
+  }
+}
+
+void mitk::IGTLIOReactor::RemoveDevice(IGTLDevice* device)
+{
+  std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+  auto it = m_Registrations.begin();
+  while (it != m_Registrations.end())
+  {
+    if (it->second.Device == device)
+    {
+#ifdef __linux__
+      epoll_ctl(m_PollDescriptor, EPOLL_CTL_DEL, it->first, nullptr);
+#endif
+      it = m_Registrations.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+  m_Devices.erase(device);
+}
+
+void mitk::IGTLIOReactor::WakeUp()
+{
+#ifdef __linux__
+  if (m_WakeUpDescriptor < 0)
+    return;
+  uint64_t one = 1;
+  // if the counter is about to overflow the thread is awake anyway
+  ssize_t written = write(m_WakeUpDescriptor, &one, sizeof(one));
+  (void)written;
+#endif
+}
+
+void mitk::IGTLIOReactor::Run()
+{
+#ifdef __linux__
+  epoll_event events[MAXIMUM_NUMBER_OF_EVENTS];
+  while (!m_Stop)
+  {
+    int numberOfEvents = epoll_wait(m_PollDescriptor, events, MAXIMUM_NUMBER_OF_EVENTS, WAKE_UP_INTERVAL_MSEC);
+    if (numberOfEvents < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      MITK_ERROR("IGTLIOReactor") << "Waiting for the sockets failed, errno " << errno << ". Communication thread stopped.";
+      return;
+    }
+
+    for (int i = 0; i < numberOfEvents; ++i)
+    {
+      if (events[i].data.fd == m_WakeUpDescriptor)
+      {
+        uint64_t counter;
+        ssize_t read = ::read(m_WakeUpDescriptor, &counter, sizeof(counter));
+        (void)read;
+      }
+      else
+      {
+        this->Dispatch(events[i].data.fd);
+      }
+    }
+
+    // observers of the received messages may have queued answers, so always check the send queues
+    this->FlushSendQueues();
+  }
+#endif
+}
+
+void mitk::IGTLIOReactor::Dispatch(int descriptor)
+{
+  std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+  auto it = m_Registrations.find(descriptor);
+  if (it == m_Registrations.end())
+    return;
+
+  // the device may remove the registration while it handles the event
+  Registration registration = it->second;
+  try
+  {
+    if (registration.Listening)
+      registration.Device->Connect();
+    else
+      registration.Device->ReceiveFromSocket(registration.Socket);
+  }
+  catch (...)
+  {
+    MITK_ERROR("IGTLIOReactor") << "Error while communicating. Communication of " << registration.Device->GetName() << " stopped.";
+    registration.Device->StopCommunication();
+  }
+}
+
+void mitk::IGTLIOReactor::FlushSendQueues()
+{
+  std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+  m_DevicesToFlush.assign(m_Devices.begin(), m_Devices.end());
+  for (IGTLDevice* device : m_DevicesToFlush)
+  {
+    if (m_Devices.count(device) == 0)
+      continue;
+    try
+    {
+      device->SendQueuedMessages();
+    }
+    catch (...)
+    {
+      MITK_ERROR("IGTLIOReactor") << "Error while sending. Communication of " << device->GetName() << " stopped.";
+      device->StopCommunication();
+    }
+  }
+}
@@ -0,0 +1,130 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef MITKIGTLIOREACTOR_H
+#define MITKIGTLIOREACTOR_H
+
+#include "MitkOpenIGTLinkExports.h"
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+//igtl
+#include "igtlSocket.h"
+
+namespace mitk {
+  class IGTLDevice;
+
+  /**
+  * \brief Event driven communication thread that is shared by all IGTLDevices.
+  *
+  * Instead of running a send, a receive and a connect thread for every
+  * device, the devices register their sockets here. A single thread waits
+  * until one of the sockets is readable and lets the owning device accept
+  * the new connection or receive the message. Messages added to a send queue
+  * wake the thread up, so they are sent without polling.
+  *
+  * The reactor uses epoll and is only available on Linux. On other platforms
+  * IsSupported() returns false and the devices keep their own threads.
+  *
+  * All calls into the devices are made while the reactor mutex is held.
+  * Thus, after RemoveDevice() returned, the reactor does not call into the
+  * device anymore. Devices must not hold their own locks while calling the
+  * reactor.
+  *
+  * \ingroup OpenIGTLink
+  */
+  class MITKOPENIGTLINK_EXPORT IGTLIOReactor
+  {
+  public:
+    /**
+    * \brief Returns the reactor shared by all devices. It is created on the
+    * first call and lives until the process ends.
+    */
+    static IGTLIOReactor* GetInstance();
+
+    /**
+    * \brief Returns true if the reactor can be used on this platform
+    */
+    static bool IsSupported();
+
+    /**
+    * \brief Sends the queued messages of the device from now on. Its sockets
+    * have to be added with AddSocket().
+    */
+    void AddDevice(IGTLDevice* device);
+
+    /**
+    * \brief Watches the socket of the device for incoming data. For a
+    * listening socket the device accepts new connections, otherwise it
+    * receives messages.
+    */
+    void AddSocket(IGTLDevice* device, igtl::Socket* socket, bool listening);
+
+    /**
+    * \brief Stops watching the socket. Must be called before the socket is
+    * closed.
+    */
+    void RemoveSocket(igtl::Socket* socket);
+
+    /**
+    * \brief Stops watching all sockets of the device and stops sending its
+    * messages.
+    */
+    void RemoveDevice(IGTLDevice* device);
+
+    /**
+    * \brief Wakes the communication thread up to send the queued messages
+    */
+    void WakeUp();
+
+    IGTLIOReactor(const IGTLIOReactor&) = delete;
+    IGTLIOReactor& operator=(const IGTLIOReactor&) = delete;
+
+  private:
+    struct Registration
+    {
+      IGTLDevice* Device;
+      igtl::Socket::Pointer Socket;
+      bool Listening;
+    };
+
+    IGTLIOReactor();
+    ~IGTLIOReactor();
+
+    void Run();
+    void Dispatch(int descriptor);
+    void FlushSendQueues();
+
+    static int GetSocketDescriptor(igtl::Socket* socket);
+
+    /** guards the registrations and all calls into the devices */
+    std::recursive_mutex m_Mutex;
+    /** the registered sockets, indexed by their descriptor */
+    std::map<int, Registration> m_Registrations;
+    /** the devices whose messages are sent */
+    std::set<IGTLDevice*> m_Devices;
+    /** copy of m_Devices, devices may remove themselves while their messages are sent */
+    std::vector<IGTLDevice*> m_DevicesToFlush;
+
+    int m_PollDescriptor;
+    int m_WakeUpDescriptor;
+    std::atomic<bool> m_Stop;
+    std::thread m_Thread;
+  };
+} // namespace mitk
+
+#endif /* MITKIGTLIOREACTOR_H */
@@ -0,0 +1,372 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "mitkIGTLImageStreamCodec.h"
+#include "mitkIGTLCompressedImageMessage.h"
+
+#include <mitkLogMacros.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace
+{
+  double GetSeconds()
+  {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  void CopyTimeStamp(igtl::MessageBase* source, igtl::MessageBase* target)
+  {
+    igtl::TimeStamp::Pointer timeStamp = igtl::TimeStamp::New();
+    source->GetTimeStamp(timeStamp);
+    target->SetTimeStamp(timeStamp);
+  }
+
+  void CopyGeometry(igtl::ImageMessage* source, igtl::ImageMessage* target)
+  {
+    float matrix[4][4];
+    source->GetMatrix(matrix);
+    target->SetMatrix(matrix);
+    float spacing[3];
+    source->GetSpacing(spacing);
+    target->SetSpacing(spacing);
+  }
+
+  /** frame numbers skip 0, which marks streams without frame numbers */
+  igtlUint32 GetNextFrameNumber(igtlUint32 frameNumber)
+  {
+    return frameNumber + 1 == 0 ? 1 : frameNumber + 1;
+  }
+
+  /** copies the rows of the region from one image buffer of the given dimensions to another */
+  void CopyRegion(const char* source, char* target, const int dimensions[3], const int size[3], const int offset[3],
+    unsigned int pixelBytes, bool sourceIsRegion, bool targetIsRegion)
+  {
+    const std::size_t rowBytes = static_cast<std::size_t>(size[0]) * pixelBytes;
+    for (int z = 0; z < size[2]; ++z)
+    {
+      for (int y = 0; y < size[1]; ++y)
+      {
+        const std::size_t imageOffset = ((static_cast<std::size_t>(offset[2] + z) * dimensions[1] + offset[1] + y) * dimensions[0] + offset[0]) * pixelBytes;
+        const std::size_t regionOffset = (static_cast<std::size_t>(z) * size[1] + y) * rowBytes;
+        std::memcpy(target + (targetIsRegion ? regionOffset : imageOffset), source + (sourceIsRegion ? regionOffset : imageOffset), rowBytes);
+      }
+    }
+  }
+}
+
+mitk::IGTLImageStreamStatistics::IGTLImageStreamStatistics()
+{
+  this->Reset();
+}
+
+void mitk::IGTLImageStreamStatistics::Reset()
+{
+  NumberOfMessages = 0;
+  ImageBytes = 0;
+  MessageBytes = 0;
+  FirstMessageTime = 0.0;
+  LastMessageTime = 0.0;
+  ProcessingTime = 0.0;
+  NumberOfLatencies = 0;
+  LatencySum = 0.0;
+  MaximumLatency = 0.0;
+}
+
+void mitk::IGTLImageStreamStatistics::AddMessage(unsigned long long imageBytes, unsigned long long messageBytes, double processingTime)
+{
+  LastMessageTime = GetSeconds();
+  if (NumberOfMessages == 0)
+    FirstMessageTime = LastMessageTime;
+  ++NumberOfMessages;
+  ImageBytes += imageBytes;
+  MessageBytes += messageBytes;
+  ProcessingTime += processingTime;
+}
+
+void mitk::IGTLImageStreamStatistics::AddLatency(double latency)
+{
+  ++NumberOfLatencies;
+  LatencySum += latency;
+  MaximumLatency = std::max(MaximumLatency, latency);
+}
+
+double mitk::IGTLImageStreamStatistics::GetBandwidth() const
+{
+  double duration = LastMessageTime - FirstMessageTime;
+  return duration > 0.0 ? MessageBytes / duration : 0.0;
+}
+
+double mitk::IGTLImageStreamStatistics::GetCompressionRatio() const
+{
+  return MessageBytes > 0 ? static_cast<double>(ImageBytes) / MessageBytes : 0.0;
+}
+
+double mitk::IGTLImageStreamStatistics::GetMeanProcessingTime() const
+{
+  return NumberOfMessages > 0 ? ProcessingTime / NumberOfMessages : 0.0;
+}
+
+double mitk::IGTLImageStreamStatistics::GetMeanLatency() const
+{
+  return NumberOfLatencies > 0 ? LatencySum / NumberOfLatencies : 0.0;
+}
+
+mitk::IGTLImageStreamEncoder::IGTLImageStreamEncoder()
+  : m_CompressionEnabled(false), m_CompressionLevel(1), m_ChangedRegionOnly(false), m_KeyFrameInterval(25), m_FramesSinceKeyFrame(0), m_FrameNumber(0)
+{
+  this->Reset();
+}
+
+void mitk::IGTLImageStreamEncoder::Reset()
+{
+  m_PreviousImage.clear();
+  std::fill(m_PreviousDimensions, m_PreviousDimensions + 3, 0);
+  m_PreviousScalarType = -1;
+  m_PreviousNumberOfComponents = -1;
+  m_FramesSinceKeyFrame = 0;
+}
+
+igtl::MessageBase::Pointer mitk::IGTLImageStreamEncoder::Encode(igtl::ImageMessage* image)
+{
+  double start = GetSeconds();
+
+  igtl::ImageMessage::Pointer message = image;
+  if (m_ChangedRegionOnly)
+    message = this->ExtractChangedRegion(image);
+  message->Pack();
+
+  igtl::MessageBase::Pointer result = message.GetPointer();
+  if (m_CompressionEnabled || m_ChangedRegionOnly)
+  {
+    // changed regions need the frame number of the compressed message, level 0 only stores the data
+    IGTLCompressedImageMessage::Pointer compressedMessage = IGTLCompressedImageMessage::New();
+    compressedMessage->Compress(message, m_CompressionEnabled ? m_CompressionLevel : 0);
+    if (m_ChangedRegionOnly)
+    {
+      m_FrameNumber = GetNextFrameNumber(m_FrameNumber);
+      compressedMessage->SetFrameNumber(m_FrameNumber);
+    }
+    compressedMessage->Pack();
+    result = compressedMessage.GetPointer();
+  }
+
+  m_Statistics.AddMessage(image->GetImageSize(), result->GetPackSize(), GetSeconds() - start);
+  return result;
+}
+
+igtl::ImageMessage::Pointer mitk::IGTLImageStreamEncoder::ExtractChangedRegion(igtl::ImageMessage* image)
+{
+  int dimensions[3];
+  image->GetDimensions(dimensions);
+  const std::size_t imageBytes = image->GetImageSize();
+  const unsigned int pixelBytes = image->GetScalarSize() * image->GetNumComponents();
+  const char* data = static_cast<const char*>(image->GetScalarPointer());
+
+  bool keyFrame = m_PreviousImage.size() != imageBytes
+    || !std::equal(dimensions, dimensions + 3, m_PreviousDimensions)
+    || image->GetScalarType() != m_PreviousScalarType
+    || image->GetNumComponents() != m_PreviousNumberOfComponents
+    || (m_KeyFrameInterval > 0 && m_FramesSinceKeyFrame >= m_KeyFrameInterval);
+  if (keyFrame)
+  {
+    m_PreviousImage.assign(data, data + imageBytes);
+    std::copy(dimensions, dimensions + 3, m_PreviousDimensions);
+    m_PreviousScalarType = image->GetScalarType();
+    m_PreviousNumberOfComponents = image->GetNumComponents();
+    m_FramesSinceKeyFrame = 1;
+    return image;
+  }
+  ++m_FramesSinceKeyFrame;
+
+  // bounding box of the changed voxels, rows are compared with memcmp and
+  // only differing rows are searched for the changed columns
+  int minimum[3] = { dimensions[0], dimensions[1], dimensions[2] };
+  int maximum[3] = { -1, -1, -1 };
+  const std::size_t rowBytes = static_cast<std::size_t>(dimensions[0]) * pixelBytes;
+  for (int z = 0; z < dimensions[2]; ++z)
+  {
+    for (int y = 0; y < dimensions[1]; ++y)
+    {
+      const std::size_t rowOffset = (static_cast<std::size_t>(z) * dimensions[1] + y) * rowBytes;
+      const char* row = data + rowOffset;
+      const char* previousRow = m_PreviousImage.data() + rowOffset;
+      if (std::memcmp(row, previousRow, rowBytes) == 0)
+        continue;
+
+      std::size_t first = 0;
+      while (row[first] == previousRow[first])
+        ++first;
+      std::size_t last = rowBytes - 1;
+      while (row[last] == previousRow[last])
+        --last;
+
+      minimum[0] = std::min(minimum[0], static_cast<int>(first / pixelBytes));
+      maximum[0] = std::max(maximum[0], static_cast<int>(last / pixelBytes));
+      minimum[1] = std::min(minimum[1], y);
+      maximum[1] = std::max(maximum[1], y);
+      minimum[2] = std::min(minimum[2], z);
+      maximum[2] = std::max(maximum[2], z);
+    }
+  }
+
+  int size[3];
+  int offset[3];
+  for (int i = 0; i < 3; ++i)
+  {
+    // an unchanged image is sent as a single voxel, so the receiver still gets the time stamp
+    offset[i] = maximum[0] < 0 ? 0 : minimum[i];
+    size[i] = maximum[0] < 0 ? 1 : maximum[i] - minimum[i] + 1;
+  }
+
+  if (std::equal(size, size + 3, dimensions))
+  {
+    m_PreviousImage.assign(data, data + imageBytes);
+    return image;
+  }
+
+  igtl::ImageMessage::Pointer subVolume = igtl::ImageMessage::New();
+  subVolume->SetDeviceName(image->GetDeviceName());
+  CopyTimeStamp(image, subVolume);
+  subVolume->SetCoordinateSystem(image->GetCoordinateSystem());
+  subVolume->SetEndian(image->GetEndian());
+  subVolume->SetNumComponents(image->GetNumComponents());
+  subVolume->SetScalarType(image->GetScalarType());
+  CopyGeometry(image, subVolume);
+  subVolume->SetDimensions(dimensions);
+  subVolume->SetSubVolume(size, offset);
+  subVolume->AllocatePack();
+  subVolume->AllocateScalars();
+
+  CopyRegion(data, static_cast<char*>(subVolume->GetScalarPointer()), dimensions, size, offset, pixelBytes, false, true);
+  CopyRegion(data, m_PreviousImage.data(), dimensions, size, offset, pixelBytes, false, false);
+  return subVolume;
+}
+
+mitk::IGTLImageStreamDecoder::IGTLImageStreamDecoder()
+  : m_FrameNumber(0), m_NumberOfSkippedFrames(0)
+{
+}
+
+void mitk::IGTLImageStreamDecoder::Reset()
+{
+  m_Image = nullptr;
+  m_FrameNumber = 0;
+}
+
+igtl::ImageMessage::Pointer mitk::IGTLImageStreamDecoder::Decode(igtl::ImageMessage* message)
+{
+  double start = GetSeconds();
+
+  igtl::ImageMessage::Pointer image = message;
+  igtlUint32 frameNumber = 0;
+  IGTLCompressedImageMessage* compressedMessage = dynamic_cast<IGTLCompressedImageMessage*>(message);
+  if (compressedMessage != nullptr)
+  {
+    frameNumber = compressedMessage->GetFrameNumber();
+    // never decompress into the last whole image, the message may be a sub-volume of it
+    if (m_DecodedImage.IsNull() || m_DecodedImage == m_Image)
+      m_DecodedImage = igtl::ImageMessage::New();
+    if (!compressedMessage->Decompress(m_DecodedImage))
+    {
+      MITK_WARN("IGTLImageStreamDecoder") << "Could not decompress the image message of " << message->GetDeviceName() << ".";
+      return nullptr;
+    }
+    image = m_DecodedImage;
+  }
+
+  int dimensions[3];
+  int size[3];
+  int offset[3];
+  image->GetDimensions(dimensions);
+  image->GetSubVolume(size, offset);
+  if (std::equal(size, size + 3, dimensions) && offset[0] == 0 && offset[1] == 0 && offset[2] == 0)
+  {
+    if (compressedMessage != nullptr)
+      std::swap(m_Image, m_DecodedImage);
+    else
+      m_Image = image;
+  }
+  else
+  {
+    if (m_Image.IsNotNull() && frameNumber != 0 && frameNumber != GetNextFrameNumber(m_FrameNumber))
+    {
+      MITK_DEBUG("IGTLImageStreamDecoder") << "Frame " << GetNextFrameNumber(m_FrameNumber) << " of " << message->GetDeviceName()
+        << " was lost, skipping the sub-volumes until the next whole image.";
+      m_Image = nullptr;
+    }
+    if (!this->ApplySubVolume(image))
+    {
+      // the following sub-volumes cannot be applied either
+      m_Image = nullptr;
+      m_FrameNumber = 0;
+      ++m_NumberOfSkippedFrames;
+      return nullptr;
+    }
+  }
+  m_FrameNumber = frameNumber;
+
+  m_Statistics.AddMessage(m_Image->GetImageSize(), message->GetPackSize(), GetSeconds() - start);
+
+  igtl::TimeStamp::Pointer timeStamp = igtl::TimeStamp::New();
+  message->GetTimeStamp(timeStamp);
+  double sentTime = timeStamp->GetTimeStamp();
+  if (sentTime > 0.0)
+  {
+    timeStamp->GetTime();
+    m_Statistics.AddLatency(timeStamp->GetTimeStamp() - sentTime);
+  }
+
+  return m_Image;
+}
+
+bool mitk::IGTLImageStreamDecoder::ApplySubVolume(igtl::ImageMessage* subVolume)
+{
+  if (m_Image.IsNull())
+  {
+    MITK_DEBUG("IGTLImageStreamDecoder") << "Skipping a sub-volume that arrived before the first whole image.";
+    return false;
+  }
+
+  int dimensions[3];
+  int imageDimensions[3];
+  int size[3];
+  int offset[3];
+  subVolume->GetDimensions(dimensions);
+  m_Image->GetDimensions(imageDimensions);
+  subVolume->GetSubVolume(size, offset);
+  if (!std::equal(dimensions, dimensions + 3, imageDimensions)
+    || subVolume->GetScalarType() != m_Image->GetScalarType()
+    || subVolume->GetNumComponents() != m_Image->GetNumComponents()
+    || subVolume->GetEndian() != m_Image->GetEndian())
+  {
+    MITK_WARN("IGTLImageStreamDecoder") << "Skipping a sub-volume that does not fit to the last whole image.";
+    return false;
+  }
+  for (int i = 0; i < 3; ++i)
+  {
+    if (offset[i] < 0 || size[i] < 1 || offset[i] + size[i] > dimensions[i])
+    {
+      MITK_WARN("IGTLImageStreamDecoder") << "Skipping a sub-volume that exceeds the image.";
+      return false;
+    }
+  }
+
+  const unsigned int pixelBytes = subVolume->GetScalarSize() * subVolume->GetNumComponents();
+  CopyRegion(static_cast<const char*>(subVolume->GetScalarPointer()), static_cast<char*>(m_Image->GetScalarPointer()),
+    dimensions, size, offset, pixelBytes, true, false);
+  CopyTimeStamp(subVolume, m_Image);
+  CopyGeometry(subVolume, m_Image);
+  return true;
+}
@@ -0,0 +1,181 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef MITKIGTLIMAGESTREAMCODEC_H
+#define MITKIGTLIMAGESTREAMCODEC_H
+
+#include "MitkOpenIGTLinkExports.h"
+
+#include "igtlImageMessage.h"
+#include "igtlMessageBase.h"
+
+#include <vector>
+
+namespace mitk
+{
+  /**
+  * \brief Bandwidth and latency of an image stream.
+  *
+  * The sender counts the processing time of the encoding, the receiver the
+  * processing time of the decoding and the latency between the time stamp
+  * of a message and the end of its decoding. Times are in seconds.
+  *
+  * \ingroup OpenIGTLink
+  */
+  struct MITKOPENIGTLINK_EXPORT IGTLImageStreamStatistics
+  {
+    IGTLImageStreamStatistics();
+
+    void Reset();
+    void AddMessage(unsigned long long imageBytes, unsigned long long messageBytes, double processingTime);
+    void AddLatency(double latency);
+
+    /** \brief Transmitted bytes per second between the first and the last message */
+    double GetBandwidth() const;
+    /** \brief Size of the images in relation to the size of the transmitted messages */
+    double GetCompressionRatio() const;
+    double GetMeanProcessingTime() const;
+    double GetMeanLatency() const;
+
+    unsigned long long NumberOfMessages;
+    /** size of the full images */
+    unsigned long long ImageBytes;
+    /** size of the transmitted messages */
+    unsigned long long MessageBytes;
+    double FirstMessageTime;
+    double LastMessageTime;
+    double ProcessingTime;
+    unsigned long long NumberOfLatencies;
+    double LatencySum;
+    double MaximumLatency;
+  };
+
+  /**
+  * \brief Reduces the size of the IMAGE messages of one image stream.
+  *
+  * If only changed regions are sent, the encoder compares each image with
+  * the previous one and sends the bounding box of the changed voxels as a
+  * sub-volume. Every KeyFrameInterval frames, and whenever the layout of
+  * the image changes, the whole image is sent so that receivers can join
+  * the stream. If compression is enabled, the resulting message is sent as
+  * IGTLCompressedImageMessage.
+  *
+  * A sub-volume can only be applied to the frame before it, but the message
+  * queues drop frames when they are full or keep only the latest one. Streams
+  * of changed regions are therefore always sent as numbered
+  * IGTLCompressedImageMessage (uncompressed if compression is disabled), so
+  * the decoder can detect a lost frame.
+  *
+  * \ingroup OpenIGTLink
+  */
+  class MITKOPENIGTLINK_EXPORT IGTLImageStreamEncoder
+  {
+  public:
+    IGTLImageStreamEncoder();
+
+    void SetCompressionEnabled(bool enabled) { m_CompressionEnabled = enabled; }
+    bool GetCompressionEnabled() const { return m_CompressionEnabled; }
+
+    /** \brief zlib compression level from 1 (fastest, default) to 9 (smallest) */
+    void SetCompressionLevel(int level) { m_CompressionLevel = level; }
+    int GetCompressionLevel() const { return m_CompressionLevel; }
+
+    void SetChangedRegionOnly(bool changedRegionOnly) { m_ChangedRegionOnly = changedRegionOnly; }
+    bool GetChangedRegionOnly() const { return m_ChangedRegionOnly; }
+
+    /** \brief Number of frames between two whole images, 0 sends only the first one (default 25) */
+    void SetKeyFrameInterval(unsigned int interval) { m_KeyFrameInterval = interval; }
+    unsigned int GetKeyFrameInterval() const { return m_KeyFrameInterval; }
+
+    /**
+    * \brief Returns the packed message that is sent instead of the given
+    * image. The image has to contain the whole image with its scalars.
+    */
+    igtl::MessageBase::Pointer Encode(igtl::ImageMessage* image);
+
+    /** \brief Forces a whole image with the next call of Encode() */
+    void Reset();
+
+    const IGTLImageStreamStatistics& GetStatistics() const { return m_Statistics; }
+    void ResetStatistics() { m_Statistics.Reset(); }
+
+  private:
+    igtl::ImageMessage::Pointer ExtractChangedRegion(igtl::ImageMessage* image);
+
+    bool m_CompressionEnabled;
+    int m_CompressionLevel;
+    bool m_ChangedRegionOnly;
+    unsigned int m_KeyFrameInterval;
+    unsigned int m_FramesSinceKeyFrame;
+    igtlUint32 m_FrameNumber;
+
+    /** the previous image as it was received by the other side */
+    std::vector<char> m_PreviousImage;
+    int m_PreviousDimensions[3];
+    int m_PreviousScalarType;
+    int m_PreviousNumberOfComponents;
+
+    IGTLImageStreamStatistics m_Statistics;
+  };
+
+  /**
+  * \brief Restores the images of a stream that was encoded with
+  * IGTLImageStreamEncoder.
+  *
+  * Compressed messages are decompressed into a message that is reused for
+  * every frame. Sub-volumes are copied into the last whole image. Whole
+  * uncompressed images are returned without copying. The returned message
+  * is therefore only valid until the next call of Decode().
+  *
+  * If the frame numbers of a stream show that a frame was lost, e.g. dropped
+  * by a message queue, the following sub-volumes are skipped until the next
+  * whole image arrives, since they were calculated against a frame the
+  * decoder does not know.
+  *
+  * \ingroup OpenIGTLink
+  */
+  class MITKOPENIGTLINK_EXPORT IGTLImageStreamDecoder
+  {
+  public:
+    IGTLImageStreamDecoder();
+
+    /**
+    * \brief Returns the whole image, or nullptr if the message cannot be
+    * decoded, e.g. a sub-volume arrived before the first whole image.
+    */
+    igtl::ImageMessage::Pointer Decode(igtl::ImageMessage* message);
+
+    /** \brief Forgets the last whole image */
+    void Reset();
+
+    /** \brief Number of sub-volumes that were skipped because the frame before them is unknown, e.g. lost */
+    unsigned long long GetNumberOfSkippedFrames() const { return m_NumberOfSkippedFrames; }
+
+    const IGTLImageStreamStatistics& GetStatistics() const { return m_Statistics; }
+    void ResetStatistics() { m_Statistics.Reset(); }
+
+  private:
+    bool ApplySubVolume(igtl::ImageMessage* subVolume);
+
+    /** target of the decompression */
+    igtl::ImageMessage::Pointer m_DecodedImage;
+    /** the last whole image, sub-volumes are copied into it */
+    igtl::ImageMessage::Pointer m_Image;
+    /** frame number of m_Image, 0 if the stream is not numbered */
+    igtlUint32 m_FrameNumber;
+    unsigned long long m_NumberOfSkippedFrames;
+
+    IGTLImageStreamStatistics m_Statistics;
+  };
+} // namespace mitk
+
+#endif
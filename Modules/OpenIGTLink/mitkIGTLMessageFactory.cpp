@@ -33,6 +33,7 @@ found in the LICENSE file.
 
 //own types
 #include "mitkIGTLDummyMessage.h"
+#include "mitkIGTLCompressedImageMessage.h"
 
 #include "mitkIGTLMessageCommon.h"
 
@@ -154,6 +155,7 @@ mitk::IGTLMessageFactory::IGTLMessageFactory()
 
   //Own Types
   this->AddMessageNewMethod("DUMMY", (PointerToMessageBaseNew)&mitk::IGTLDummyMessage::New);
+  this->AddMessageNewMethod("ZIMAGE", (PointerToMessageBaseNew)&mitk::IGTLCompressedImageMessage::New);
 }
 
 mitk::IGTLMessageFactory::~IGTLMessageFactory()
@@ -14,204 +14,109 @@ found in the LICENSE file.
 #include <string>
 #include "igtlMessageBase.h"
 
-void mitk::IGTLMessageQueue::PushSendMessage(mitk::IGTLMessage::Pointer message)
+const unsigned int mitk::IGTLMessageQueue::QueueCapacity;
+
+void mitk::IGTLMessageQueue::Push(MessageQueueType& queue, igtl::MessageBase* message)
 {
-  this->m_Mutex->Lock();
-  if (this->m_BufferingType == IGTLMessageQueue::NoBuffering)
-    m_SendQueue.clear();
+  m_DroppedMessages += queue.Push(message);
+}
 
-  m_SendQueue.push_back(message);
-  this->m_Mutex->Unlock();
+template <typename TMessage>
+typename TMessage::Pointer mitk::IGTLMessageQueue::Pull(MessageQueueType& queue)
+{
+  igtl::MessageBase::Pointer message;
+  if (!queue.TryPop(message))
+    return nullptr;
+  return static_cast<TMessage*>(message.GetPointer());
 }
 
-void mitk::IGTLMessageQueue::PushCommandMessage(igtl::MessageBase::Pointer message)
+void mitk::IGTLMessageQueue::PushSendMessage(mitk::IGTLMessage::Pointer message)
 {
-  this->m_Mutex->Lock();
-  if (this->m_BufferingType == IGTLMessageQueue::NoBuffering)
-    m_CommandQueue.clear();
+  m_DroppedMessages += m_SendQueue.Push(message);
+}
 
-  m_CommandQueue.push_back(message);
-  this->m_Mutex->Unlock();
+void mitk::IGTLMessageQueue::PushCommandMessage(igtl::MessageBase::Pointer message)
+{
+  this->Push(m_CommandQueue, message);
 }
 
 void mitk::IGTLMessageQueue::PushMessage(igtl::MessageBase::Pointer msg)
 {
-  this->m_Mutex->Lock();
-
-  std::stringstream infolog;
-
-  infolog << "Received message of type ";
-
   if (dynamic_cast<igtl::TrackingDataMessage*>(msg.GetPointer()) != nullptr)
   {
-    if (this->m_BufferingType == IGTLMessageQueue::NoBuffering)
-      m_TrackingDataQueue.clear();
-
-    this->m_TrackingDataQueue.push_back(dynamic_cast<igtl::TrackingDataMessage*>(msg.GetPointer()));
-
-    infolog << "TDATA";
+    this->Push(m_TrackingDataQueue, msg);
   }
   else if (dynamic_cast<igtl::TransformMessage*>(msg.GetPointer()) != nullptr)
   {
-    if (this->m_BufferingType == IGTLMessageQueue::NoBuffering)
-      m_TransformQueue.clear();
-
-    this->m_TransformQueue.push_back(dynamic_cast<igtl::TransformMessage*>(msg.GetPointer()));
-
-    infolog << "TRANSFORM";
+    this->Push(m_TransformQueue, msg);
   }
   else if (dynamic_cast<igtl::StringMessage*>(msg.GetPointer()) != nullptr)
   {
-    if (this->m_BufferingType == IGTLMessageQueue::NoBuffering)
-      m_StringQueue.clear();
-
-    this->m_StringQueue.push_back(dynamic_cast<igtl::StringMessage*>(msg.GetPointer()));
-
-    infolog << "STRING";
+    this->Push(m_StringQueue, msg);
   }
   else if (dynamic_cast<igtl::ImageMessage*>(msg.GetPointer()) != nullptr)
   {
-    igtl::ImageMessage::Pointer imageMsg = dynamic_cast<igtl::ImageMessage*>(msg.GetPointer());
-    int* dim = new int[3];
-    imageMsg->GetDimensions(dim);
+    int dim[3];
+    static_cast<igtl::ImageMessage*>(msg.GetPointer())->GetDimensions(dim);
     if (dim[2] > 1)
     {
-      if (this->m_BufferingType == IGTLMessageQueue::NoBuffering)
-        m_Image3dQueue.clear();
-
-      this->m_Image3dQueue.push_back(dynamic_cast<igtl::ImageMessage*>(msg.GetPointer()));
-
-      infolog << "IMAGE3D";
+      this->Push(m_Image3dQueue, msg);
     }
     else
     {
-      if (this->m_BufferingType == IGTLMessageQueue::NoBuffering)
-        m_Image2dQueue.clear();
-
-      this->m_Image2dQueue.push_back(dynamic_cast<igtl::ImageMessage*>(msg.GetPointer()));
-
-      infolog << "IMAGE2D";
+      this->Push(m_Image2dQueue, msg);
     }
   }
   else
   {
-    if (this->m_BufferingType == IGTLMessageQueue::NoBuffering)
-      m_MiscQueue.clear();
-
-    this->m_MiscQueue.push_back(msg);
-
-    infolog << "OTHER";
+    this->Push(m_MiscQueue, msg);
   }
 
+  this->m_Mutex->Lock();
   m_Latest_Message = msg;
-
-  //MITK_INFO << infolog.str();
-
   this->m_Mutex->Unlock();
 }
 
 mitk::IGTLMessage::Pointer mitk::IGTLMessageQueue::PullSendMessage()
 {
   mitk::IGTLMessage::Pointer ret = nullptr;
-  this->m_Mutex->Lock();
-  if (this->m_SendQueue.size() > 0)
-  {
-    ret = this->m_SendQueue.front();
-    this->m_SendQueue.pop_front();
-  }
-  this->m_Mutex->Unlock();
+  m_SendQueue.TryPop(ret);
   return ret;
 }
 
 igtl::MessageBase::Pointer mitk::IGTLMessageQueue::PullMiscMessage()
 {
-  igtl::MessageBase::Pointer ret = nullptr;
-  this->m_Mutex->Lock();
-  if (this->m_MiscQueue.size() > 0)
-  {
-    ret = this->m_MiscQueue.front();
-    this->m_MiscQueue.pop_front();
-  }
-  this->m_Mutex->Unlock();
-  return ret;
+  return this->Pull<igtl::MessageBase>(m_MiscQueue);
 }
 
 igtl::ImageMessage::Pointer mitk::IGTLMessageQueue::PullImage2dMessage()
 {
-  igtl::ImageMessage::Pointer ret = nullptr;
-  this->m_Mutex->Lock();
-  if (this->m_Image2dQueue.size() > 0)
-  {
-    ret = this->m_Image2dQueue.front();
-    this->m_Image2dQueue.pop_front();
-  }
-  this->m_Mutex->Unlock();
-  return ret;
+  return this->Pull<igtl::ImageMessage>(m_Image2dQueue);
 }
 
 igtl::ImageMessage::Pointer mitk::IGTLMessageQueue::PullImage3dMessage()
 {
-  igtl::ImageMessage::Pointer ret = nullptr;
-  this->m_Mutex->Lock();
-  if (this->m_Image3dQueue.size() > 0)
-  {
-    ret = this->m_Image3dQueue.front();
-    this->m_Image3dQueue.pop_front();
-  }
-  this->m_Mutex->Unlock();
-  return ret;
+  return this->Pull<igtl::ImageMessage>(m_Image3dQueue);
 }
 
 igtl::TrackingDataMessage::Pointer mitk::IGTLMessageQueue::PullTrackingMessage()
 {
-  igtl::TrackingDataMessage::Pointer ret = nullptr;
-  this->m_Mutex->Lock();
-  if (this->m_TrackingDataQueue.size() > 0)
-  {
-    ret = this->m_TrackingDataQueue.front();
-    this->m_TrackingDataQueue.pop_front();
-  }
-  this->m_Mutex->Unlock();
-  return ret;
+  return this->Pull<igtl::TrackingDataMessage>(m_TrackingDataQueue);
 }
 
 igtl::MessageBase::Pointer mitk::IGTLMessageQueue::PullCommandMessage()
 {
-  igtl::MessageBase::Pointer ret = nullptr;
-  this->m_Mutex->Lock();
-  if (this->m_CommandQueue.size() > 0)
-  {
-    ret = this->m_CommandQueue.front();
-    this->m_CommandQueue.pop_front();
-  }
-  this->m_Mutex->Unlock();
-  return ret;
+  return this->Pull<igtl::MessageBase>(m_CommandQueue);
 }
 
 igtl::StringMessage::Pointer mitk::IGTLMessageQueue::PullStringMessage()
 {
-  igtl::StringMessage::Pointer ret = nullptr;
-  this->m_Mutex->Lock();
-  if (this->m_StringQueue.size() > 0)
-  {
-    ret = this->m_StringQueue.front();
-    this->m_StringQueue.pop_front();
-  }
-  this->m_Mutex->Unlock();
-  return ret;
+  return this->Pull<igtl::StringMessage>(m_StringQueue);
 }
 
 igtl::TransformMessage::Pointer mitk::IGTLMessageQueue::PullTransformMessage()
 {
-  igtl::TransformMessage::Pointer ret = nullptr;
-  this->m_Mutex->Lock();
-  if (this->m_TransformQueue.size() > 0)
-  {
-    ret = this->m_TransformQueue.front();
-    this->m_TransformQueue.pop_front();
-  }
-  this->m_Mutex->Unlock();
-  return ret;
+  return this->Pull<igtl::TransformMessage>(m_TransformQueue);
 }
 
 std::string mitk::IGTLMessageQueue::GetNextMsgInformationString()
@@ -282,27 +187,66 @@ std::string mitk::IGTLMessageQueue::GetLatestMsgDeviceType()
 
 int mitk::IGTLMessageQueue::GetSize()
 {
-  return (this->m_CommandQueue.size() + this->m_Image2dQueue.size() + this->m_Image3dQueue.size() + this->m_MiscQueue.size()
-    + this->m_StringQueue.size() + this->m_TrackingDataQueue.size() + this->m_TransformQueue.size());
+  return (this->m_CommandQueue.GetSize() + this->m_Image2dQueue.GetSize() + this->m_Image3dQueue.GetSize() + this->m_MiscQueue.GetSize()
+    + this->m_StringQueue.GetSize() + this->m_TrackingDataQueue.GetSize() + this->m_TransformQueue.GetSize());
+}
+
+int mitk::IGTLMessageQueue::GetSendQueueSize()
+{
+  return this->m_SendQueue.GetSize();
+}
+
+unsigned long long mitk::IGTLMessageQueue::GetNumberOfDroppedMessages() const
+{
+  return m_DroppedMessages;
 }
 
 void mitk::IGTLMessageQueue::EnableNoBufferingMode(bool enable)
 {
-  this->m_Mutex->Lock();
-  if (enable)
-    this->m_BufferingType = IGTLMessageQueue::BufferingType::NoBuffering;
-  else
-    this->m_BufferingType = IGTLMessageQueue::BufferingType::Infinit;
-  this->m_Mutex->Unlock();
+  BackpressurePolicy policy = enable ? BackpressurePolicy::KeepLatest : BackpressurePolicy::DropOldest;
+  for (int queue = CommandQueue; queue <= SendQueue; ++queue)
+    this->SetBackpressurePolicy(static_cast<QueueType>(queue), policy);
+}
+
+void mitk::IGTLMessageQueue::SetBackpressurePolicy(QueueType queue, BackpressurePolicy policy)
+{
+  switch (queue)
+  {
+  case CommandQueue: m_CommandQueue.SetBackpressurePolicy(policy); break;
+  case Image2dQueue: m_Image2dQueue.SetBackpressurePolicy(policy); break;
+  case Image3dQueue: m_Image3dQueue.SetBackpressurePolicy(policy); break;
+  case TransformQueue: m_TransformQueue.SetBackpressurePolicy(policy); break;
+  case TrackingDataQueue: m_TrackingDataQueue.SetBackpressurePolicy(policy); break;
+  case StringQueue: m_StringQueue.SetBackpressurePolicy(policy); break;
+  case MiscQueue: m_MiscQueue.SetBackpressurePolicy(policy); break;
+  case SendQueue: m_SendQueue.SetBackpressurePolicy(policy); break;
+  }
+}
+
+mitk::IGTLMessageQueue::BackpressurePolicy mitk::IGTLMessageQueue::GetBackpressurePolicy(QueueType queue) const
+{
+  switch (queue)
+  {
+  case CommandQueue: return m_CommandQueue.GetBackpressurePolicy();
+  case Image2dQueue: return m_Image2dQueue.GetBackpressurePolicy();
+  case Image3dQueue: return m_Image3dQueue.GetBackpressurePolicy();
+  case TransformQueue: return m_TransformQueue.GetBackpressurePolicy();
+  case TrackingDataQueue: return m_TrackingDataQueue.GetBackpressurePolicy();
+  case StringQueue: return m_StringQueue.GetBackpressurePolicy();
+  case MiscQueue: return m_MiscQueue.GetBackpressurePolicy();
+  default: return m_SendQueue.GetBackpressurePolicy();
+  }
 }
 
 mitk::IGTLMessageQueue::IGTLMessageQueue()
+  : m_CommandQueue(QueueCapacity), m_Image2dQueue(QueueCapacity), m_Image3dQueue(QueueCapacity),
+  m_TransformQueue(QueueCapacity), m_TrackingDataQueue(QueueCapacity), m_StringQueue(QueueCapacity),
+  m_MiscQueue(QueueCapacity), m_SendQueue(QueueCapacity), m_DroppedMessages(0)
 {
   this->m_Mutex = itk::FastMutexLock::New();
-  this->m_BufferingType = IGTLMessageQueue::NoBuffering;
+  this->EnableNoBufferingMode(true);
 }
 
 mitk::IGTLMessageQueue::~IGTLMessageQueue()
 {
-  this->m_Mutex->Unlock();
 }
@@ -19,8 +19,9 @@ found in the LICENSE file.
 #include "itkFastMutexLock.h"
 #include "mitkCommon.h"
 
-#include <deque>
+#include <atomic>
 #include <mitkIGTLMessage.h>
+#include "mitkIGTLBoundedQueue.h"
 
 //OpenIGTLink
 #include "igtlMessageBase.h"
@@ -34,6 +35,13 @@ namespace mitk {
   * \class IGTLMessageQueue
   * \brief Thread safe message queue to store OpenIGTLink messages.
   *
+  * Every message type has its own bounded queue that does not use locks, so
+  * the communication thread and the threads pulling messages do not block
+  * each other. When a queue is full the oldest message is dropped. In the
+  * NoBuffering mode a queue keeps only the latest message. The backpressure
+  * policy can also be set for each message type separately, e.g. to keep
+  * only the latest tracking data while buffering all commands.
+  *
   * \ingroup OpenIGTLink
   */
   class MITKOPENIGTLINK_EXPORT IGTLMessageQueue : public itk::Object
@@ -50,6 +58,14 @@ namespace mitk {
        */
     enum BufferingType { Infinit, NoBuffering };
 
+    typedef IGTLBackpressurePolicy BackpressurePolicy;
+
+    /** \brief The queues of the different message types */
+    enum QueueType { CommandQueue, Image2dQueue, Image3dQueue, TransformQueue, TrackingDataQueue, StringQueue, MiscQueue, SendQueue };
+
+    /** \brief Number of messages each queue can hold before messages are dropped */
+    static const unsigned int QueueCapacity = 256;
+
     void PushSendMessage(mitk::IGTLMessage::Pointer message);
 
     /**
@@ -78,6 +94,17 @@ namespace mitk {
     */
     int GetSize();
 
+    /**
+    * \brief Get the number of messages waiting to be sent
+    */
+    int GetSendQueueSize();
+
+    /**
+    * \brief Returns the number of messages that were dropped because a queue
+    * was full or kept only the latest message
+    */
+    unsigned long long GetNumberOfDroppedMessages() const;
+
     /**
     * \brief Returns a string with information about the oldest message in the
     * queue
@@ -101,38 +128,48 @@ namespace mitk {
     std::string GetLatestMsgDeviceType();
 
     /**
-     */
+    * \brief Keeps only the latest message of each type if enabled, otherwise
+    * the queues buffer messages until they are full.
+    */
     void EnableNoBufferingMode(bool enable);
 
+    /**
+    * \brief Sets how the queue of the given message type behaves when it is full
+    */
+    void SetBackpressurePolicy(QueueType queue, BackpressurePolicy policy);
+    BackpressurePolicy GetBackpressurePolicy(QueueType queue) const;
+
   protected:
     IGTLMessageQueue();
     ~IGTLMessageQueue() override;
 
   protected:
+    typedef IGTLBoundedQueue<igtl::MessageBase::Pointer> MessageQueueType;
+
+    void Push(MessageQueueType& queue, igtl::MessageBase* message);
+    template <typename TMessage> typename TMessage::Pointer Pull(MessageQueueType& queue);
+
     /**
-    * \brief Mutex to take car of the queue
+    * \brief Mutex to take care of the latest message, the queues themselves do not need it
     */
     itk::FastMutexLock::Pointer m_Mutex;
 
     /**
-    * \brief the queue that stores pointer to the inserted messages
+    * \brief the queues that store pointer to the inserted messages
     */
-    std::deque< igtl::MessageBase::Pointer > m_CommandQueue;
-    std::deque< igtl::ImageMessage::Pointer > m_Image2dQueue;
-    std::deque< igtl::ImageMessage::Pointer > m_Image3dQueue;
-    std::deque< igtl::TransformMessage::Pointer > m_TransformQueue;
-    std::deque< igtl::TrackingDataMessage::Pointer > m_TrackingDataQueue;
-    std::deque< igtl::StringMessage::Pointer > m_StringQueue;
-    std::deque< igtl::MessageBase::Pointer > m_MiscQueue;
+    MessageQueueType m_CommandQueue;
+    MessageQueueType m_Image2dQueue;
+    MessageQueueType m_Image3dQueue;
+    MessageQueueType m_TransformQueue;
+    MessageQueueType m_TrackingDataQueue;
+    MessageQueueType m_StringQueue;
+    MessageQueueType m_MiscQueue;
 
-    std::deque< mitk::IGTLMessage::Pointer > m_SendQueue;
+    IGTLBoundedQueue<mitk::IGTLMessage::Pointer> m_SendQueue;
 
     igtl::MessageBase::Pointer m_Latest_Message;
 
-    /**
-    * \brief defines the kind of buffering
-    */
-    BufferingType m_BufferingType;
+    std::atomic<unsigned long long> m_DroppedMessages;
   };
 }
 
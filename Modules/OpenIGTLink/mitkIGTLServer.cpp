@@ -11,6 +11,7 @@ found in the LICENSE file.
 ============================================================================*/
 
 #include "mitkIGTLServer.h"
+#include "mitkIGTLIOReactor.h"
 #include <cstdio>
 
 #include <itksys/SystemTools.hxx>
@@ -100,6 +101,8 @@ void mitk::IGTLServer::Connect()
     this->m_RegisteredClients.push_back(socket);
     m_SentListMutex->Unlock();
     m_ReceiveListMutex->Unlock();
+    if (this->IsUsingReactor())
+      IGTLIOReactor::GetInstance()->AddSocket(this, socket, false);
     //inform observers about this new client
     this->InvokeEvent(NewClientConnectionEvent());
     MITK_INFO("IGTLServer") << "Connected to a new client: " << socket;
@@ -182,6 +185,11 @@ void mitk::IGTLServer::StopCommunicationWithSocket(
 
 void mitk::IGTLServer::StopCommunicationWithSocket(igtl::Socket* client)
 {
+  // the reactor has to forget the socket before it is closed, this must not
+  // be done while holding the list mutexes
+  if (this->IsUsingReactor())
+    IGTLIOReactor::GetInstance()->RemoveSocket(client);
+
   m_SentListMutex->Lock();
   m_ReceiveListMutex->Lock();
   auto i = m_RegisteredClients.begin();
@@ -206,6 +214,17 @@ void mitk::IGTLServer::StopCommunicationWithSocket(igtl::Socket* client)
   m_ReceiveListMutex->Unlock();
 }
 
+void mitk::IGTLServer::AddSocketsToReactor(IGTLIOReactor* reactor)
+{
+  reactor->AddSocket(this, m_Socket, true);
+
+  m_ReceiveListMutex->Lock();
+  SocketListType registeredClients(m_RegisteredClients);
+  m_ReceiveListMutex->Unlock();
+  for (auto& client : registeredClients)
+    reactor->AddSocket(this, client, false);
+}
+
 unsigned int mitk::IGTLServer::GetNumberOfConnections()
 {
   return this->m_RegisteredClients.size();
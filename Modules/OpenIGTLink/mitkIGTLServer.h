@@ -109,6 +109,12 @@ namespace mitk
       */
     void StopCommunicationWithSocket(igtl::Socket* client) override;
 
+    /**
+    * \brief Adds the server socket and the sockets of all registered clients
+    * to the shared communication thread
+    */
+    void AddSocketsToReactor(IGTLIOReactor* reactor) override;
+
     /**
      * \brief A list with all registered clients
      */
@@ -11,7 +11,9 @@ found in the LICENSE file.
 ============================================================================*/
 
 #include <mitkCommon.h>
+#include <algorithm>
 #include <chrono>
+#include <vector>
 #include <mitkIOUtil.h>
 #include <mitkCommandLineParser.h>
 #include <mitkException.h>
@@ -30,6 +32,7 @@ struct InputParameters
   bool verbose;
   std::string settingsFile;
   std::string imageType;
+  int benchmarkRepetitions;
 };
 
 struct BandpassSettings
@@ -105,6 +108,10 @@ InputParameters parseInput(int argc, char* argv[])
   parser.addArgument(
     "verbose", "v", mitkCommandLineParser::Bool,
     "Verbose Output", "Whether to produce verbose, or rather debug output. (default: false)");
+  parser.addArgument(
+    "benchmark", "b", mitkCommandLineParser::Int,
+    "Benchmark repetitions", "Repeats the beamforming the given number of times and reports the run times. The first run includes the creation of the delay tables. (default: 0)",
+    us::Any(0));
   parser.endGroup();
 
   InputParameters input;
@@ -114,6 +121,7 @@ InputParameters parseInput(int argc, char* argv[])
     exit(-1);
 
   input.verbose = (bool)parsedArgs.count("verbose");
+  input.benchmarkRepetitions = parsedArgs.count("benchmark") ? us::any_cast<int>(parsedArgs["benchmark"]) : 0;
   MITK_INFO(input.verbose) << "### VERBOSE OUTPUT ENABLED ###";
 
   if (parsedArgs.count("inputImage"))
@@ -359,7 +367,37 @@ int main(int argc, char * argv[])
   if (processSettings.DoBeamforming)
   {
     MITK_INFO(input.verbose) << "Beamforming input image...";
-    output = m_FilterService->ApplyBeamforming(output, bfSettings);
+    if (input.benchmarkRepetitions > 0)
+    {
+      // the settings are shared by all runs, so only the first run has to create the delay tables
+      mitk::Image::Pointer beamformingInput = output;
+      std::vector<double> runTimes;
+      for (int run = 0; run < input.benchmarkRepetitions; ++run)
+      {
+        auto begin = std::chrono::high_resolution_clock::now();
+        output = m_FilterService->ApplyBeamforming(beamformingInput, bfSettings);
+        auto end = std::chrono::high_resolution_clock::now();
+        runTimes.push_back(std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count() / 1000.0);
+      }
+
+      double total = 0;
+      for (int run = 1; run < input.benchmarkRepetitions; ++run)
+        total += runTimes[run];
+      MITK_INFO << "Benchmark: " << (bfSettings->GetUseGPU() ? "GPU" : "CPU") << " beamforming of " << output->GetDimension(2)
+        << " slices (" << inputImage->GetDimension(0) << "x" << inputImage->GetDimension(1) << " -> "
+        << output->GetDimension(0) << "x" << output->GetDimension(1) << ")";
+      MITK_INFO << "Benchmark: first run " << runTimes[0] << " ms";
+      if (input.benchmarkRepetitions > 1)
+      {
+        double mean = total / (input.benchmarkRepetitions - 1);
+        MITK_INFO << "Benchmark: further runs " << mean << " ms (" << mean / output->GetDimension(2) << " ms per slice), minimum "
+          << *std::min_element(runTimes.begin() + 1, runTimes.end()) << " ms";
+      }
+    }
+    else
+    {
+      output = m_FilterService->ApplyBeamforming(output, bfSettings);
+    }
     MITK_INFO(input.verbose) << "Beamforming input image...[Done]";
   }
   if (processSettings.DoCropping)
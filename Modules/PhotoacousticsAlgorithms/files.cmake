@@ -10,6 +10,7 @@ set(CPP_FILES
   source/filters/mitkBandpassFilter.cpp
   source/OpenCLFilter/mitkPhotoacousticBModeFilter.cpp
   source/utils/mitkPhotoacousticFilterService.cpp
+  source/utils/mitkPhotoacousticStreamingPipeline.cpp
   source/utils/mitkBeamformingUtils.cpp
   source/mitkPhotoacousticMotionCorrectionFilter.cpp
 )
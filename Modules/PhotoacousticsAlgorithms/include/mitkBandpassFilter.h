@@ -17,9 +17,19 @@ found in the LICENSE file.
 #include "MitkPhotoacousticsAlgorithmsExports.h"
 #include "mitkPhotoacousticFilterService.h"
 
+#include <vnl/algo/vnl_fft_1d.h>
+
+#include <memory>
+#include <vector>
+
 namespace mitk {
   /*!
-  * \brief Class implementing an mitk::ImageToImageFilter for casting any mitk image to a float image
+  * \brief Class implementing an mitk::ImageToImageFilter for bandpass filtering float images along the y axis
+  *
+  * Every line of every slice is transformed with a 1D FFT, multiplied with a tukey window and transformed back.
+  * The lines are distributed over the GetNumberOfThreads() threads of an itk::MultiThreader. The FFT plans and the window are kept by the
+  * filter and only recomputed if the number of samples or the filter parameters change, so a filter instance
+  * should be reused for a series of images.
   */
 
   class MITKPHOTOACOUSTICSALGORITHMS_EXPORT BandpassFilter : public ImageToImageFilter
@@ -38,6 +48,16 @@ namespace mitk {
     itkSetMacro(TimeSpacing, float);
     itkSetMacro(IsBFImage, bool);
 
+    /** \brief Filters lines x samples x slices floats stored like the slices of an image, without the image pipeline
+    *
+    * This is what GenerateData() does for the input image, so a series of frames can be filtered without creating an
+    * mitk::Image per frame. Inputs whose number of samples is not a power of two are resampled like in GenerateData().
+    * Input and output may be the same buffer.
+    * @param sampleSpacing The spacing of the samples in mm, only used for beamformed images (see SetIsBFImage()).
+    */
+    void FilterBuffer(const float* input, float* output, unsigned int lines, unsigned int samples, unsigned int slices,
+      double sampleSpacing = 1);
+
   protected:
     BandpassFilter();
 
@@ -45,6 +65,15 @@ namespace mitk {
 
     void SanityCheckPreconditions();
 
+    /** \brief Returns the window for the given number of samples and cutoff frequencies in pixels, reusing the last one if possible
+    */
+    const std::vector<float>& GetWindow(unsigned int samples, float cutoffPixelHighPass, float cutoffPixelLowPass);
+
+    /** \brief Filters all lines of all slices with the window; samples needs to be a size vnl can transform
+    */
+    void FilterLines(const float* input, float* output, unsigned int lines, unsigned int samples, unsigned int slices,
+      const std::vector<float>& window);
+
     float m_SpeedOfSound;
     float m_TimeSpacing;
     bool m_IsBFImage;
@@ -54,6 +83,15 @@ namespace mitk {
     float m_LowPassAlpha;
     mitk::PhotoacousticFilterService::Pointer m_FilterService;
 
+    std::vector<float> m_Window;
+    unsigned int m_WindowSamples;
+    float m_WindowCutoffPixelHighPass;
+    float m_WindowCutoffPixelLowPass;
+    float m_WindowHighPassAlpha;
+    float m_WindowLowPassAlpha;
+    /** one FFT plan per thread*/
+    std::vector<std::unique_ptr<vnl_fft_1d<float>>> m_Transforms;
+
     void GenerateData() override;
   };
 } // namespace mitk
@@ -18,6 +18,9 @@ found in the LICENSE file.
 #include <mitkCommon.h>
 #include <MitkPhotoacousticsAlgorithmsExports.h>
 
+#include <mutex>
+#include <vector>
+
 namespace mitk {
   /*!
   * \brief Class holding the configuration data for the beamforming filters mitk::BeamformingFilter and mitk::PhotoacousticOCLBeamformingFilter
@@ -128,8 +131,29 @@ namespace mitk {
       return smartPtr;
     }
 
+    /** \brief Returns the first and the last+1 element used for every output sample, stored as pairs (minLine, maxLine) at
+    * 2 * (sample * ReconstructionLines + line). The table is created on the first call; this method is thread-safe.
+    */
     unsigned short* GetMinMaxLines();
 
+    /** \brief Returns the delays in input samples of the elements used for every output sample of the CPU beamforming.
+    *
+    * The delays of the output sample (sample, line) start at GetDelays()[GetDelayOffsets()[sample * ReconstructionLines + line]]
+    * and belong to the elements minLine to maxLine-1 as given by GetMinMaxLines(). The table is created on the first call
+    * and reused for all further slices and images with these settings; this method is thread-safe.
+    * Returns nullptr if the table would be larger than the maximum delay table size; the delays then have to be calculated
+    * by mitk::BeamformingUtils::SphericalDelays() for each output sample.
+    */
+    const short* GetDelays();
+
+    /** \brief Offsets into the table of GetDelays(), one per output sample. Returns nullptr if there is no delay table.
+    */
+    const std::size_t* GetDelayOffsets();
+
+    /** \brief Maximum number of entries of the delay table (default: 128M, i.e. 256 MB).
+    */
+    static const std::size_t MaximumDelayTableSize;
+
   protected:
 
     /**
@@ -239,6 +263,22 @@ namespace mitk {
     /**
     */
     unsigned short* m_MinMaxLines;
+
+    /** \brief Delays of all used elements of all output samples, see GetDelays()
+    */
+    std::vector<short> m_Delays;
+
+    /** \brief Start of the delays of each output sample in m_Delays
+    */
+    std::vector<std::size_t> m_DelayOffsets;
+
+    /** \brief Whether the creation of the delay table has already been attempted
+    */
+    bool m_DelaysInitialized;
+
+    /** \brief Guards the lazy creation of the min/max lines and the delay table, which are requested from the line threads
+    */
+    std::mutex m_TableMutex;
   };
 }
 #endif //MITK_BEAMFORMING_SETTINGS
@@ -27,11 +27,25 @@ namespace mitk {
   {
   public:
 
+    /** \brief Function to perform beamforming on CPU for all lines of a single slice
+    *
+    * Uses the line function of the algorithm set in config. The lines are distributed dynamically over the threads of an
+    * itk::MultiThreader, so that lines with many used elements do not stall the others. The min/max lines and the delay
+    * table of config are created before the threads are started.
+    * @param numberOfThreads the number of threads; 0 uses itk::MultiThreader::GetGlobalDefaultNumberOfThreads()
+    */
+    static void BeamformSlice(float* input, float* output, float inputDim[2], float outputDim[2], const mitk::BeamformingSettings::Pointer config, unsigned int numberOfThreads = 0);
+
     /** \brief Function to perform beamforming on CPU for a single line, using DAS and spherical delay
+    *
+    * The line functions overwrite the values of the line in output.
     */
     static void DASSphericalLine(float* input, float* output, float inputDim[2], float outputDim[2], const short& line, const mitk::BeamformingSettings::Pointer config);
 
     /** \brief Function to perform beamforming on CPU for a single line, using DMAS and spherical delay
+    *
+    * The sum over all pairs of elements is calculated in linear time: with b = sign(s) * sqrt(|s|) of the apodized
+    * samples s, the sum of sign(s_i*s_j) * sqrt(|s_i*s_j|) over all pairs i < j equals ((sum b)^2 - sum b^2) / 2.
     */
     static void DMASSphericalLine(float* input, float* output, float inputDim[2], float outputDim[2], const short& line, const mitk::BeamformingSettings::Pointer config);
 
@@ -58,6 +72,13 @@ namespace mitk {
     */
     static unsigned short* MinMaxLines(const mitk::BeamformingSettings::Pointer config);
 
+    /** \brief Calculates the spherical delays in input samples of the elements minLine to maxLine-1
+    * @param delays array receiving maxLine-minLine delays
+    * @param s_i the depth of the output sample in input samples
+    * @param l_p the horizontal position of the output line in [m]
+    */
+    static void SphericalDelays(short* delays, float s_i, float l_p, short minLine, short maxLine, const mitk::BeamformingSettings* config);
+
   protected:
     BeamformingUtils();
 
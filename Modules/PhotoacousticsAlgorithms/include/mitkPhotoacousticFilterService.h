@@ -23,6 +23,8 @@ found in the LICENSE file.
 #include "MitkPhotoacousticsAlgorithmsExports.h"
 
 namespace mitk {
+  class BandpassFilter;
+
   /*!
   * \brief Class holding methods to apply all Filters within the Photoacoustics Algorithms Module
   *
@@ -119,6 +121,11 @@ namespace mitk {
     */
     mitk::BeamformingFilter::Pointer m_BeamformingFilter;
 
+    /** \brief
+      The Bandpass filter is kept as well, so its FFT plans and window are reused for images of the same size.
+    */
+    itk::SmartPointer<mitk::BandpassFilter> m_BandpassFilter;
+
     mitk::Image::Pointer ConvertToFloat(mitk::Image::Pointer);
   };
 } // namespace mitk
@@ -0,0 +1,210 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef mitkPhotoacousticStreamingPipeline_H_HEADER_INCLUDED
+#define mitkPhotoacousticStreamingPipeline_H_HEADER_INCLUDED
+
+#include "itkObject.h"
+#include "mitkCommon.h"
+#include "mitkImage.h"
+
+#include "mitkBandpassFilter.h"
+#include "mitkBeamformingSettings.h"
+#include "mitkPhotoacousticFilterService.h"
+#include "MitkPhotoacousticsAlgorithmsExports.h"
+
+#include <vnl/algo/vnl_fft_1d.h>
+
+#include <chrono>
+#include <complex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mitk {
+  /*!
+  * \brief Processes a stream of 2D frames with beamforming, cropping, bandpass and B-mode filtering in one pass
+  *
+  * In contrast to the methods of PhotoacousticFilterService, which run one filter and allocate one mitk::Image per
+  * stage, this pipeline works on raw float buffers which are allocated once and reused for all frames of the same
+  * size. Frames are either processed synchronously with ProcessFrame(), or pushed into a bounded queue with
+  * PushFrame() and processed by a worker thread that is started with Start(). If the queue is full, PushFrame()
+  * rejects the frame and counts it as dropped, so the acquisition is never blocked by the processing.
+  *
+  * The stages are:
+  *  - beamforming with BeamformingUtils::BeamformSlice(), if beamforming settings are set
+  *  - cropping of rows and columns
+  *  - bandpass filtering of every line with BandpassFilter::FilterBuffer(), the results equal those of
+  *    PhotoacousticFilterService::ApplyBandpassFilter()
+  *  - B-mode filtering: absolute value or envelope detection, optionally followed by a logarithm. The results
+  *    equal those of PhotoacousticFilterService::ApplyBmodeFilter().
+  *
+  * Frames are stored row by row, i.e. the value of line l and sample s is data[s * lines + l], which is the
+  * memory layout of an mitk::Image slice. The latency of every stage is measured for every frame.
+  */
+  class MITKPHOTOACOUSTICSALGORITHMS_EXPORT PhotoacousticStreamingPipeline : public itk::Object
+  {
+  public:
+    mitkClassMacroItkParent(mitk::PhotoacousticStreamingPipeline, itk::Object);
+    itkFactorylessNewMacro(Self);
+
+    /** \brief Latencies of the processing stages in milliseconds
+    *
+    * Queue is the time a frame waited in the queue; it is zero for frames processed with ProcessFrame().
+    * Total is the processing time of the frame without the time in the queue.
+    */
+    struct StageLatencies
+    {
+      double Queue = 0;
+      double Beamforming = 0;
+      double Cropping = 0;
+      double Bandpass = 0;
+      double BMode = 0;
+      double Total = 0;
+    };
+
+    /** \brief Called by the worker thread for every processed frame
+    *
+    * The data is row by row with dimensions[0] lines and dimensions[1] samples. It is only valid during the call.
+    * The callback must not change the settings of the pipeline.
+    */
+    typedef std::function<void(const float* data, const unsigned int* dimensions, unsigned long frameNumber)> FrameCallback;
+
+    /** \brief Sets the beamforming settings; nullptr (default) skips the beamforming for already beamformed frames
+    */
+    void SetBeamformingSettings(BeamformingSettings::Pointer settings);
+    BeamformingSettings::Pointer GetBeamformingSettings() const;
+
+    /** \brief Sets how many samples are cut from the top and bottom and how many lines from the left and right side
+    */
+    void SetCropping(unsigned int above, unsigned int below, unsigned int left, unsigned int right);
+
+    /** \brief Enables the B-mode filter
+    * @param method The kind of B-Mode Filter to be used.
+    * @param useLogFilter Setting this to true will apply a logarithm, as PhotoacousticFilterService::ApplyBmodeFilter() does.
+    */
+    void SetBModeFilter(bool useBModeFilter, PhotoacousticFilterService::BModeMethod method = PhotoacousticFilterService::BModeMethod::Abs, bool useLogFilter = false);
+
+    /** \brief Enables the bandpass filter, the parameters are those of PhotoacousticFilterService::ApplyBandpassFilter()
+    * @param highPass The high pass cutoff frequency in Hz.
+    * @param lowPass The low pass cutoff frequency in Hz.
+    * @param timeSpacing The time between two samples in s of frames that are not beamformed by the pipeline. Frames
+    * beamformed by the pipeline are filtered as beamformed images with the spacing and speed of sound of the beamforming settings.
+    */
+    void SetBandpassFilter(bool useBandpassFilter, float highPass = 0, float lowPass = 50, float highPassAlpha = 1, float lowPassAlpha = 1,
+      float timeSpacing = 0);
+
+    /** \brief Number of threads used for beamforming and bandpass filtering; 0 (default) uses the global default of ITK
+    */
+    void SetNumberOfThreads(unsigned int numberOfThreads);
+
+    /** \brief Number of frames that can wait for processing (default 4); only changeable while stopped
+    */
+    void SetQueueSize(unsigned int queueSize);
+    unsigned int GetQueueSize() const;
+
+    void SetFrameProcessedCallback(FrameCallback callback);
+
+    /** \brief Starts the worker thread that processes the frames pushed with PushFrame()
+    */
+    void Start();
+
+    /** \brief Processes the frames remaining in the queue and stops the worker thread
+    */
+    void Stop();
+
+    bool IsRunning() const;
+
+    /** \brief Copies the frame into the queue
+    * @return false if the queue was full or the pipeline is not running; the frame is dropped then.
+    */
+    bool PushFrame(const float* data, unsigned int lines, unsigned int samples);
+
+    /** \brief Copies the given slice of a float image into the queue
+    */
+    bool PushFrame(mitk::Image::Pointer frame, unsigned int slice = 0);
+
+    /** \brief Processes one frame in the calling thread
+    * @return The processed frame with the dimensions GetOutputDimensions(). The buffer is reused for the next frame.
+    */
+    const float* ProcessFrame(const float* data, unsigned int lines, unsigned int samples);
+
+    /** \brief Lines and samples of the last processed frame
+    */
+    const unsigned int* GetOutputDimensions() const;
+
+    unsigned long GetNumberOfProcessedFrames() const;
+    unsigned long GetNumberOfDroppedFrames() const;
+    StageLatencies GetLastLatencies() const;
+    StageLatencies GetMeanLatencies() const;
+    void ResetStatistics();
+
+  protected:
+    PhotoacousticStreamingPipeline();
+    ~PhotoacousticStreamingPipeline() override;
+
+    struct Frame
+    {
+      std::vector<float> Data;
+      unsigned int Lines = 0;
+      unsigned int Samples = 0;
+      unsigned long Number = 0;
+      std::chrono::high_resolution_clock::time_point PushTime;
+    };
+
+    void Run();
+    const float* ProcessFrame(const float* data, unsigned int lines, unsigned int samples, StageLatencies& latencies);
+    void ApplyEnvelopeDetection(float* data, unsigned int lines, unsigned int samples);
+
+    BeamformingSettings::Pointer m_BeamformingSettings;
+    unsigned int m_CropAbove;
+    unsigned int m_CropBelow;
+    unsigned int m_CropLeft;
+    unsigned int m_CropRight;
+    bool m_UseBandpassFilter;
+    float m_BandpassTimeSpacing;
+    BandpassFilter::Pointer m_BandpassFilter;
+    bool m_UseBModeFilter;
+    PhotoacousticFilterService::BModeMethod m_BModeMethod;
+    bool m_UseLogFilter;
+    unsigned int m_NumberOfThreads;
+    FrameCallback m_FrameProcessedCallback;
+
+    /** Locked while a frame is processed and while the settings change*/
+    mutable std::mutex m_ProcessingMutex;
+    std::vector<float> m_BeamformedBuffer;
+    std::vector<float> m_OutputBuffer;
+    unsigned int m_OutputDimensions[2];
+    vnl_vector<std::complex<float>> m_EnvelopeBuffer;
+    std::unique_ptr<vnl_fft_1d<float>> m_EnvelopeTransform;
+
+    mutable std::mutex m_QueueMutex;
+    std::condition_variable m_QueueCondition;
+    std::vector<Frame> m_Queue;
+    unsigned int m_QueueHead;
+    unsigned int m_QueueCount;
+    unsigned long m_NextFrameNumber;
+    bool m_Running;
+    std::thread m_Worker;
+
+    mutable std::mutex m_StatisticsMutex;
+    unsigned long m_ProcessedFrames;
+    unsigned long m_DroppedFrames;
+    StageLatencies m_LastLatencies;
+    StageLatencies m_SumLatencies;
+  };
+} // namespace mitk
+
+#endif /* mitkPhotoacousticStreamingPipeline_H_HEADER_INCLUDED */
@@ -15,20 +15,73 @@ found in the LICENSE file.
 
 #include "mitkBandpassFilter.h"
 
-#include "../ITKFilter/ITKUltrasound/itkFFT1DComplexConjugateToRealImageFilter.h"
-#include "../ITKFilter/ITKUltrasound/itkFFT1DRealToComplexConjugateImageFilter.h"
-#include "itkComplexToModulusImageFilter.h"
-#include "itkMultiplyImageFilter.h"
-#include "mitkIOUtil.h"
-#include "mitkITKImageImport.h"
-#include "mitkImageCast.h"
+#include "mitkImageReadAccessor.h"
+#include <itkMath.h>
+#include <itkMultiThreader.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+  /** \brief Shared state of the threads of mitk::BandpassFilter::FilterLines(), which take the lines one by one */
+  struct FilterLinesData
+  {
+    const float* Input;
+    float* Output;
+    unsigned int Lines;
+    unsigned int Samples;
+    unsigned int TotalLines;
+    const std::vector<float>* Window;
+    std::vector<std::unique_ptr<vnl_fft_1d<float>>>* Transforms;
+    std::atomic<unsigned int> NextLine;
+  };
+
+  ITK_THREAD_RETURN_TYPE FilterLinesCallback(void* arg)
+  {
+    typedef itk::MultiThreader::ThreadInfoStruct ThreadInfoType;
+    ThreadInfoType* infoStruct = static_cast<ThreadInfoType*>(arg);
+    FilterLinesData* data = static_cast<FilterLinesData*>(infoStruct->UserData);
+
+    const unsigned int lines = data->Lines;
+    const unsigned int samples = data->Samples;
+    const std::vector<float>& window = *data->Window;
+    vnl_fft_1d<float>& transform = *(*data->Transforms)[infoStruct->ThreadID];
+    vnl_vector<std::complex<float>> buffer(samples);
+    std::complex<float>* bufferData = buffer.data_block();
+
+    for (unsigned int index = data->NextLine++; index < data->TotalLines; index = data->NextLine++)
+    {
+      const std::size_t offset = (std::size_t)(index / lines) * lines * samples + index % lines;
+      for (unsigned int sample = 0; sample < samples; ++sample)
+        bufferData[sample] = data->Input[offset + (std::size_t)sample * lines];
+
+      // same transforms as itk::VnlFFT1DRealToComplexConjugateImageFilter and itk::VnlFFT1DComplexConjugateToRealImageFilter
+      transform.bwd_transform(buffer);
+      for (unsigned int sample = 0; sample < samples; ++sample)
+        bufferData[sample] *= window[sample];
+      transform.fwd_transform(buffer);
+
+      for (unsigned int sample = 0; sample < samples; ++sample)
+        data->Output[offset + (std::size_t)sample * lines] = bufferData[sample].real() / samples;
+    }
+    return ITK_THREAD_RETURN_VALUE;
+  }
+}
 
 mitk::BandpassFilter::BandpassFilter()
   : m_HighPass(0),
     m_LowPass(50),
     m_HighPassAlpha(1),
     m_LowPassAlpha(1),
-    m_FilterService(mitk::PhotoacousticFilterService::New())
+    m_FilterService(mitk::PhotoacousticFilterService::New()),
+    m_WindowSamples(0),
+    m_WindowCutoffPixelHighPass(0),
+    m_WindowCutoffPixelLowPass(0),
+    m_WindowHighPassAlpha(0),
+    m_WindowLowPassAlpha(0)
 {
   MITK_INFO << "Instantiating BandpassFilter...";
   SetNumberOfIndexedInputs(1);
@@ -58,203 +111,182 @@ void mitk::BandpassFilter::SanityCheckPreconditions()
   }
 }
 
-itk::Image<float, 3U>::Pointer BPFunction(mitk::Image::Pointer reference,
-                                          float cutoffFrequencyPixelHighPass,
-                                          float cutoffFrequencyPixelLowPass,
-                                          float alphaHighPass,
-                                          float alphaLowPass)
+std::vector<float> BPFunction(unsigned int samples,
+                              float cutoffFrequencyPixelHighPass,
+                              float cutoffFrequencyPixelLowPass,
+                              float alphaHighPass,
+                              float alphaLowPass)
 {
-  float *imageData = new float[reference->GetDimension(0) * reference->GetDimension(1)];
+  // the window is the same for all lines, so only one line is computed
+  std::vector<float> window(samples, 0.f);
 
   float width = cutoffFrequencyPixelLowPass - cutoffFrequencyPixelHighPass;
   float center = cutoffFrequencyPixelHighPass + width / 2.f;
 
-  for (unsigned int n = 0; n < reference->GetDimension(1); ++n)
-  {
-    imageData[reference->GetDimension(0) * n] = 0;
-  }
   for (int n = 0; n < width; ++n)
   {
-    imageData[reference->GetDimension(0) * (int)(n + center - (width / 2.f))] = 1;
+    window[(int)(n + center - (width / 2.f))] = 1;
     if (n <= (alphaHighPass * (width - 1)) / 2.f)
     {
       if (alphaHighPass > 0.00001f)
       {
-        imageData[reference->GetDimension(0) * (int)(n + center - (width / 2.f))] =
+        window[(int)(n + center - (width / 2.f))] =
           (1 + cos(itk::Math::pi * (2 * n / (alphaHighPass * (width - 1)) - 1))) / 2;
       }
       else
       {
-        imageData[reference->GetDimension(0) * (int)(n + center - (width / 2.f))] = 1;
+        window[(int)(n + center - (width / 2.f))] = 1;
       }
     }
     else if (n >= (width - 1) * (1 - alphaLowPass / 2.f))
     {
       if (alphaLowPass > 0.00001f)
       {
-        imageData[reference->GetDimension(0) * (int)(n + center - (width / 2.f))] =
+        window[(int)(n + center - (width / 2.f))] =
           (1 + cos(itk::Math::pi * (2 * n / (alphaLowPass * (width - 1)) + 1 - 2 / alphaLowPass))) / 2;
       }
       else
       {
-        imageData[reference->GetDimension(0) * (int)(n + center - (width / 2.f))] = 1;
+        window[(int)(n + center - (width / 2.f))] = 1;
       }
     }
   }
 
-  for (unsigned int n = reference->GetDimension(1) / 2; n < reference->GetDimension(1); ++n)
+  for (unsigned int n = samples / 2; n < samples; ++n)
   {
-    imageData[reference->GetDimension(0) * n] =
-      imageData[(reference->GetDimension(1) - (n + 1)) * reference->GetDimension(0)];
+    window[n] = window[samples - (n + 1)];
   }
 
-  for (unsigned int line = 1; line < reference->GetDimension(0); ++line)
+  return window;
+}
+
+const std::vector<float>& mitk::BandpassFilter::GetWindow(unsigned int samples, float cutoffPixelHighPass, float cutoffPixelLowPass)
+{
+  if (m_WindowSamples != samples ||
+    m_WindowCutoffPixelHighPass != cutoffPixelHighPass || m_WindowCutoffPixelLowPass != cutoffPixelLowPass ||
+    m_WindowHighPassAlpha != m_HighPassAlpha || m_WindowLowPassAlpha != m_LowPassAlpha)
   {
-    for (unsigned int sample = 0; sample < reference->GetDimension(1); ++sample)
-    {
-      imageData[reference->GetDimension(0) * sample + line] = imageData[reference->GetDimension(0) * sample];
-    }
+    m_Window = BPFunction(samples, cutoffPixelHighPass, cutoffPixelLowPass, m_HighPassAlpha, m_LowPassAlpha);
+    m_WindowSamples = samples;
+    m_WindowCutoffPixelHighPass = cutoffPixelHighPass;
+    m_WindowCutoffPixelLowPass = cutoffPixelLowPass;
+    m_WindowHighPassAlpha = m_HighPassAlpha;
+    m_WindowLowPassAlpha = m_LowPassAlpha;
   }
+  return m_Window;
+}
 
-  typedef itk::Image<float, 3U> ImageType;
-  ImageType::RegionType region;
-  ImageType::IndexType start;
-  start.Fill(0);
-
-  region.SetIndex(start);
-
-  ImageType::SizeType size;
-  size[0] = reference->GetDimension(0);
-  size[1] = reference->GetDimension(1);
-  size[2] = reference->GetDimension(2);
-
-  region.SetSize(size);
-
-  ImageType::SpacingType SpacingItk;
-  SpacingItk[0] = reference->GetGeometry()->GetSpacing()[0];
-  SpacingItk[1] = reference->GetGeometry()->GetSpacing()[1];
-  SpacingItk[2] = reference->GetGeometry()->GetSpacing()[2];
-
-  ImageType::Pointer image = ImageType::New();
-  image->SetRegions(region);
-  image->Allocate();
-  image->FillBuffer(itk::NumericTraits<float>::Zero);
-  image->SetSpacing(SpacingItk);
-
-  ImageType::IndexType pixelIndex;
+void mitk::BandpassFilter::FilterLines(const float* input, float* output, unsigned int lines, unsigned int samples, unsigned int slices,
+  const std::vector<float>& window)
+{
+  const unsigned int totalLines = lines * slices;
+  unsigned int numberOfThreads = this->GetNumberOfThreads();
+  numberOfThreads = std::max(1u, std::min(numberOfThreads, totalLines));
 
-  for (unsigned int slice = 0; slice < reference->GetDimension(2); ++slice)
+  if (m_Transforms.size() < numberOfThreads)
+    m_Transforms.resize(numberOfThreads);
+  for (unsigned int thread = 0; thread < numberOfThreads; ++thread)
   {
-    for (unsigned int line = 0; line < reference->GetDimension(0); ++line)
-    {
-      for (unsigned int sample = 0; sample < reference->GetDimension(1); ++sample)
-      {
-        pixelIndex[0] = line;
-        pixelIndex[1] = sample;
-        pixelIndex[2] = slice;
-
-        image->SetPixel(pixelIndex, imageData[line + sample * reference->GetDimension(0)]);
-      }
-    }
+    if (!m_Transforms[thread] || (unsigned int)m_Transforms[thread]->size() != samples)
+      m_Transforms[thread].reset(new vnl_fft_1d<float>(samples));
   }
 
-  delete[] imageData;
-
-  return image;
+  // the lines of all slices are handed out one by one
+  FilterLinesData data;
+  data.Input = input;
+  data.Output = output;
+  data.Lines = lines;
+  data.Samples = samples;
+  data.TotalLines = totalLines;
+  data.Window = &window;
+  data.Transforms = &m_Transforms;
+  data.NextLine = 0;
+
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->SetNumberOfThreads(numberOfThreads);
+  threader->SetSingleMethod(FilterLinesCallback, &data);
+  threader->SingleMethodExecute();
 }
 
-void mitk::BandpassFilter::GenerateData()
+void mitk::BandpassFilter::FilterBuffer(const float* input, float* output, unsigned int lines, unsigned int samples, unsigned int slices,
+  double sampleSpacing)
 {
-  SanityCheckPreconditions();
-  auto input = GetInput();
-  auto output = GetOutput();
-  mitk::Image::Pointer resampledInput = input;
+  if (m_HighPass > m_LowPass)
+    mitkThrow() << "High pass frequency higher than low pass frequency, abort";
 
-  double powerOfTwo = std::log2(input->GetDimension(1));
-  int finalSize = 0;
+  double powerOfTwo = std::log2(samples);
+  unsigned int finalSize = samples;
   double spacingResize = 1;
+  mitk::Image::Pointer resampledInput;
 
   // check if this is a power of two by checking that log2 is int
   if (std::fmod(powerOfTwo, 1.0) >= std::numeric_limits<double>::epsilon())
   {
-    finalSize = (int)pow(2, std::ceil(powerOfTwo));
-    double dim[2] = {(double)input->GetDimension(0), (double)finalSize };
-    resampledInput = m_FilterService->ApplyResamplingToDim(input, dim);
-    spacingResize = (double)input->GetDimension(1) / finalSize;
+    finalSize = (unsigned int)pow(2, std::ceil(powerOfTwo));
+    unsigned int dimensions[3] = { lines, samples, slices };
+    mitk::Image::Pointer inputImage = mitk::Image::New();
+    inputImage->Initialize(mitk::MakeScalarPixelType<float>(), 3, dimensions);
+    inputImage->SetImportVolume(const_cast<float*>(input), 0, 0, mitk::Image::ImportMemoryManagementType::CopyMemory);
+    double dim[2] = { (double)lines, (double)finalSize };
+    resampledInput = m_FilterService->ApplyResamplingToDim(inputImage, dim);
+    spacingResize = (double)samples / finalSize;
   }
 
-  // do a fourier transform, multiply with an appropriate window for the filter, and transform back
-  typedef itk::Image<float, 3> RealImageType;
-  RealImageType::Pointer image;
-  mitk::CastToItkImage(resampledInput, image);
-  typedef itk::FFT1DRealToComplexConjugateImageFilter<RealImageType> ForwardFFTFilterType;
-  typedef ForwardFFTFilterType::OutputImageType ComplexImageType;
-  ForwardFFTFilterType::Pointer forwardFFTFilter = ForwardFFTFilterType::New();
-  forwardFFTFilter->SetInput(image);
-  forwardFFTFilter->SetDirection(1);
-
-  try
+  float singleVoxel = spacingResize / (m_TimeSpacing * finalSize); // [Hz]
+  if (m_IsBFImage)
+    singleVoxel = spacingResize / (sampleSpacing * spacingResize / 1e3 / m_SpeedOfSound * finalSize); // [Hz]
+  float cutoffPixelHighPass = std::min((m_HighPass / singleVoxel), (float)finalSize / 2.0f);
+  float cutoffPixelLowPass = std::min((m_LowPass / singleVoxel), (float)finalSize / 2.0f);
+
+  MITK_DEBUG << "SingleVoxel: " << singleVoxel;
+  MITK_DEBUG << "cutoffPixelHighPass: " << cutoffPixelHighPass;
+  MITK_DEBUG << "cutoffPixelLowPass: " << cutoffPixelLowPass;
+
+  // do a fourier transform of every line, multiply with an appropriate window for the filter, and transform back
+  const std::vector<float>& window = GetWindow(finalSize, cutoffPixelHighPass, cutoffPixelLowPass);
+
+  if (resampledInput.IsNull())
   {
-    forwardFFTFilter->UpdateOutputInformation();
+    FilterLines(input, output, lines, samples, slices, window);
+    return;
   }
-  catch (itk::ExceptionObject &error)
+
+  mitk::Image::Pointer filteredImage = mitk::Image::New();
+  filteredImage->Initialize(resampledInput);
   {
-    std::cerr << "Error: " << error << std::endl;
-    MITK_ERROR << "Bandpass could not be applied";
-    mitkThrow() << "bandpass error";
+    ImageReadAccessor inputAccessor(resampledInput);
+    std::vector<float> filteredData((std::size_t)lines * finalSize * slices);
+    FilterLines((const float*)inputAccessor.GetData(), filteredData.data(), lines, finalSize, slices, window);
+    filteredImage->SetImportVolume(filteredData.data());
   }
 
-  if (m_HighPass > m_LowPass)
-    mitkThrow() << "High pass frequency higher than low pass frequency, abort";
+  double dim[2] = { (double)lines, (double)samples };
+  auto resampledOutput = m_FilterService->ApplyResamplingToDim(filteredImage, dim);
+  ImageReadAccessor outputAccessor(resampledOutput);
+  std::memcpy(output, outputAccessor.GetData(), (std::size_t)lines * samples * slices * sizeof(float));
+}
 
-  float singleVoxel = spacingResize / (m_TimeSpacing * resampledInput->GetDimension(1)); // [Hz]
-  if(m_IsBFImage)
-    singleVoxel = spacingResize / (resampledInput->GetGeometry()->GetSpacing()[1] / 1e3 / m_SpeedOfSound * resampledInput->GetDimension(1)); // [Hz]
-  float cutoffPixelHighPass = std::min((m_HighPass / singleVoxel), (float)resampledInput->GetDimension(1) / 2.0f);
-  float cutoffPixelLowPass = std::min((m_LowPass / singleVoxel), (float)resampledInput->GetDimension(1) / 2.0f);
+void mitk::BandpassFilter::GenerateData()
+{
+  SanityCheckPreconditions();
+  auto input = GetInput();
+  auto output = GetOutput();
 
-  MITK_INFO << "SingleVoxel: " << singleVoxel;
   MITK_INFO << "HighPass: " << m_HighPass;
   MITK_INFO << "LowPass: " << m_LowPass;
 
-  MITK_INFO << "cutoffPixelHighPass: " << cutoffPixelHighPass;
-  MITK_INFO << "cutoffPixelLowPass: " << cutoffPixelLowPass;
-
-  RealImageType::Pointer fftMultiplicator =
-    BPFunction(resampledInput, cutoffPixelHighPass, cutoffPixelLowPass, m_HighPassAlpha, m_LowPassAlpha);
-
-  typedef itk::MultiplyImageFilter<ComplexImageType, RealImageType, ComplexImageType> MultiplyFilterType;
-  MultiplyFilterType::Pointer multiplyFilter = MultiplyFilterType::New();
-  multiplyFilter->SetInput1(forwardFFTFilter->GetOutput());
-  multiplyFilter->SetInput2(fftMultiplicator);
-
-  /*
-  GrabItkImageMemory(fftMultiplicator, output);
-  mitk::IOUtil::Save(output, "D:/fftImage.nrrd");
+  const unsigned int lines = input->GetDimension(0);
+  const unsigned int samples = input->GetDimension(1);
+  const unsigned int slices = input->GetDimension() > 2 ? input->GetDimension(2) : 1;
 
-  typedef itk::ComplexToModulusImageFilter< ComplexImageType, RealImageType > modulusType;
-  modulusType::Pointer modul = modulusType::New();
-
-  modul->SetInput(multiplyFilter->GetOutput());
-  GrabItkImageMemory(modul->GetOutput(), output);
-  mitk::IOUtil::Save(output, "D:/fftout.nrrd");
-
-  modul->SetInput(forwardFFTFilter->GetOutput());
-  GrabItkImageMemory(modul->GetOutput(), output);
-  mitk::IOUtil::Save(output, "D:/fftin.nrrd");*/
-
-  typedef itk::FFT1DComplexConjugateToRealImageFilter<ComplexImageType, RealImageType> InverseFilterType;
-  InverseFilterType::Pointer inverseFFTFilter = InverseFilterType::New();
-  inverseFFTFilter->SetInput(multiplyFilter->GetOutput());
-  inverseFFTFilter->SetDirection(1);
-
-  GrabItkImageMemory(inverseFFTFilter->GetOutput(), output);
-
-  double dim[2] = { (double)input->GetDimension(0), (double)input->GetDimension(1) };
-  auto resampledOutput = m_FilterService->ApplyResamplingToDim(output, dim);
+  std::vector<float> filteredData((std::size_t)lines * samples * slices);
+  {
+    ImageReadAccessor inputAccessor(input);
+    FilterBuffer((const float*)inputAccessor.GetData(), filteredData.data(), lines, samples, slices,
+      input->GetGeometry()->GetSpacing()[1]);
+  }
 
   output->Initialize(mitk::MakeScalarPixelType<float>(), 3, input->GetDimensions());
-  output->SetSpacing(resampledOutput->GetGeometry()->GetSpacing());
-  ImageReadAccessor copy(resampledOutput);
-  output->SetImportVolume(copy.GetData());
+  output->SetSpacing(input->GetGeometry()->GetSpacing());
+  output->SetImportVolume(filteredData.data());
 }
@@ -15,7 +15,6 @@ found in the LICENSE file.
 #include <algorithm>
 #include <itkImageIOBase.h>
 #include <chrono>
-#include <thread>
 #include <itkImageIOBase.h>
 #include "mitkImageCast.h"
 #include "mitkBeamformingFilter.h"
@@ -120,47 +119,8 @@ void mitk::BeamformingFilter::GenerateData()
 
       m_OutputData = new float[m_Conf->GetReconstructionLines()*m_Conf->GetSamplesPerLine()];
 
-      // fill the image with zeros
-      for (int l = 0; l < outputDim[0]; ++l)
-      {
-        for (int s = 0; s < outputDim[1]; ++s)
-        {
-          m_OutputData[l*(short)outputDim[1] + s] = 0;
-        }
-      }
-
-      std::thread *threads = new std::thread[(short)outputDim[0]];
-
-      // every line will be beamformed in a seperate thread
-      if (m_Conf->GetAlgorithm() == BeamformingSettings::BeamformingAlgorithm::DAS)
-      {
-        for (short line = 0; line < outputDim[0]; ++line)
-        {
-          threads[line] = std::thread(&BeamformingUtils::DASSphericalLine, m_InputData,
-            m_OutputData, inputDim, outputDim, line, m_Conf);
-        }
-      }
-      else if (m_Conf->GetAlgorithm() == BeamformingSettings::BeamformingAlgorithm::DMAS)
-      {
-        for (short line = 0; line < outputDim[0]; ++line)
-        {
-          threads[line] = std::thread(&BeamformingUtils::DMASSphericalLine, m_InputData,
-            m_OutputData, inputDim, outputDim, line, m_Conf);
-        }
-      }
-      else if (m_Conf->GetAlgorithm() == BeamformingSettings::BeamformingAlgorithm::sDMAS)
-      {
-        for (short line = 0; line < outputDim[0]; ++line)
-        {
-          threads[line] = std::thread(&BeamformingUtils::sDMASSphericalLine, m_InputData,
-            m_OutputData, inputDim, outputDim, line, m_Conf);
-        }
-      }
-      // wait for all lines to finish
-      for (short line = 0; line < outputDim[0]; ++line)
-      {
-        threads[line].join();
-      }
+      // the lines are distributed over a pool of worker threads; every line function writes all samples of its line
+      BeamformingUtils::BeamformSlice(m_InputData, m_OutputData, inputDim, outputDim, m_Conf);
 
       output->SetSlice(m_OutputData, i);
 
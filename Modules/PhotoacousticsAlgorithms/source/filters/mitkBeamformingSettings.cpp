@@ -12,7 +12,8 @@ found in the LICENSE file.
 
 #include "mitkBeamformingSettings.h"
 #include "mitkBeamformingUtils.h"
-#include "itkMutexLock.h"
+
+const std::size_t mitk::BeamformingSettings::MaximumDelayTableSize = 128 * 1024 * 1024;
 
 mitk::BeamformingSettings::BeamformingSettings(float pitchInMeters,
   float speedOfSound,
@@ -46,7 +47,8 @@ mitk::BeamformingSettings::BeamformingSettings(float pitchInMeters,
   m_Algorithm(algorithm),
   m_Geometry(geometry),
   m_ProbeRadius(probeRadius),
-  m_MinMaxLines(nullptr)
+  m_MinMaxLines(nullptr),
+  m_DelaysInitialized(false)
 {
   if (inputDim == nullptr)
   {
@@ -131,7 +133,63 @@ mitk::BeamformingSettings::~BeamformingSettings()
 
 unsigned short* mitk::BeamformingSettings::GetMinMaxLines()
 {
+  std::lock_guard<std::mutex> lock(m_TableMutex);
   if (!m_MinMaxLines)
     m_MinMaxLines = mitk::BeamformingUtils::MinMaxLines(this);
   return m_MinMaxLines;
 }
+
+const short* mitk::BeamformingSettings::GetDelays()
+{
+  unsigned short* minMaxLines = GetMinMaxLines();
+
+  std::lock_guard<std::mutex> lock(m_TableMutex);
+  if (!m_DelaysInitialized)
+  {
+    m_DelaysInitialized = true;
+
+    const unsigned int outputL = m_ReconstructionLines;
+    const unsigned int outputS = m_SamplesPerLine;
+
+    std::size_t tableSize = 0;
+    for (std::size_t i = 0; i < (std::size_t)outputL * outputS; ++i)
+    {
+      tableSize += minMaxLines[2 * i + 1] - minMaxLines[2 * i];
+    }
+    if (tableSize > MaximumDelayTableSize)
+    {
+      MITK_WARN << "Delay table would need " << tableSize * sizeof(short) / (1024 * 1024) << " MB; delays are calculated during beamforming.";
+      return nullptr;
+    }
+
+    m_Delays.resize(tableSize);
+    m_DelayOffsets.resize((std::size_t)outputL * outputS);
+
+    float totalSamples_i = (float)(m_ReconstructionDepth) / (float)(m_SpeedOfSound * m_TimeSpacing);
+    totalSamples_i = totalSamples_i <= m_InputDim[1] ? totalSamples_i : m_InputDim[1];
+
+    std::size_t offset = 0;
+    for (unsigned int sample = 0; sample < outputS; ++sample)
+    {
+      const float s_i = (float)sample / (float)outputS * totalSamples_i;
+      for (unsigned int line = 0; line < outputL; ++line)
+      {
+        const float l_p = (float)line / (float)outputL * m_HorizontalExtent;
+        const std::size_t index = (std::size_t)sample * outputL + line;
+        const short minLine = minMaxLines[2 * index];
+        const short maxLine = minMaxLines[2 * index + 1];
+
+        m_DelayOffsets[index] = offset;
+        mitk::BeamformingUtils::SphericalDelays(m_Delays.data() + offset, s_i, l_p, minLine, maxLine, this);
+        offset += maxLine - minLine;
+      }
+    }
+  }
+  return m_DelayOffsets.empty() ? nullptr : m_Delays.data();
+}
+
+const std::size_t* mitk::BeamformingSettings::GetDelayOffsets()
+{
+  GetDelays();
+  return m_DelayOffsets.empty() ? nullptr : m_DelayOffsets.data();
+}
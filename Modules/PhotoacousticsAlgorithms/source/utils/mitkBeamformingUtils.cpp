@@ -14,12 +14,165 @@ found in the LICENSE file.
 #include "mitkImageReadAccessor.h"
 #include <algorithm>
 #include <itkImageIOBase.h>
+#include <itkMultiThreader.h>
+#include <atomic>
+#include <cmath>
 #include <chrono>
-#include <thread>
-#include <itkImageIOBase.h>
+#include <vector>
 #include "mitkImageCast.h"
 #include "mitkBeamformingUtils.h"
 
+namespace
+{
+  typedef void(*BeamformLineFunction)(float*, float*, float*, float*, const short&, const mitk::BeamformingSettings::Pointer);
+
+  /** \brief Shared state of the threads of mitk::BeamformingUtils::BeamformSlice(), which take the lines one by one */
+  struct BeamformSliceData
+  {
+    BeamformLineFunction BeamformLine;
+    float* Input;
+    float* Output;
+    float* InputDim;
+    float* OutputDim;
+    mitk::BeamformingSettings::Pointer Config;
+    short Lines;
+    std::atomic<int> NextLine;
+  };
+
+  ITK_THREAD_RETURN_TYPE BeamformSliceCallback(void* arg)
+  {
+    typedef itk::MultiThreader::ThreadInfoStruct ThreadInfoType;
+    ThreadInfoType* infoStruct = static_cast<ThreadInfoType*>(arg);
+    BeamformSliceData* data = static_cast<BeamformSliceData*>(infoStruct->UserData);
+
+    for (int line = data->NextLine++; line < data->Lines; line = data->NextLine++)
+    {
+      data->BeamformLine(data->Input, data->Output, data->InputDim, data->OutputDim, (short)line, data->Config);
+    }
+    return ITK_THREAD_RETURN_VALUE;
+  }
+
+  /** \brief Provides the used elements and their delays for the output samples of one line
+  *
+  * Takes the delays from the delay table of the settings if it exists and matches the given dimensions, otherwise
+  * they are calculated for each output sample.
+  */
+  class SphericalLineDelays
+  {
+  public:
+    SphericalLineDelays(const float inputDim[2], const float outputDim[2], short line, mitk::BeamformingSettings* config) :
+      m_Config(config),
+      m_Line(line),
+      m_OutputL((short)outputDim[0]),
+      m_OutputS(outputDim[1])
+    {
+      m_MinMaxLines = config->GetMinMaxLines();
+      m_Delays = config->GetDelays();
+      m_DelayOffsets = config->GetDelayOffsets();
+
+      if ((unsigned int)outputDim[0] != config->GetReconstructionLines() ||
+        (unsigned int)outputDim[1] != config->GetSamplesPerLine() ||
+        (unsigned int)inputDim[1] != config->GetInputDim()[1])
+      {
+        m_DelayOffsets = nullptr;
+      }
+
+      m_TotalSamples = (float)(config->GetReconstructionDepth()) / (float)(config->GetSpeedOfSound() * config->GetTimeSpacing());
+      m_TotalSamples = m_TotalSamples <= inputDim[1] ? m_TotalSamples : inputDim[1];
+      m_LinePosition = (float)line / outputDim[0] * config->GetHorizontalExtent();
+    }
+
+    /** \brief Returns the delays of the elements minLine to maxLine-1 used for the given output sample
+    */
+    const short* Get(short sample, short& minLine, short& maxLine)
+    {
+      const std::size_t index = (std::size_t)sample * m_OutputL + m_Line;
+      minLine = m_MinMaxLines[2 * index];
+      maxLine = m_MinMaxLines[2 * index + 1];
+
+      if (m_DelayOffsets != nullptr)
+        return m_Delays + m_DelayOffsets[index];
+
+      m_Buffer.resize(maxLine - minLine);
+      float s_i = (float)sample / m_OutputS * m_TotalSamples;
+      mitk::BeamformingUtils::SphericalDelays(m_Buffer.data(), s_i, m_LinePosition, minLine, maxLine, m_Config);
+      return m_Buffer.data();
+    }
+
+  private:
+    const mitk::BeamformingSettings* m_Config;
+    short m_Line;
+    short m_OutputL;
+    float m_OutputS;
+    float m_TotalSamples;
+    float m_LinePosition;
+    const unsigned short* m_MinMaxLines;
+    const short* m_Delays;
+    const std::size_t* m_DelayOffsets;
+    std::vector<short> m_Buffer;
+  };
+
+  /** \brief DMAS and signed DMAS for a single line, see mitk::BeamformingUtils::DMASSphericalLine()
+  */
+  void DelayMultiplyAndSumLine(float* input, float* output, float inputDim[2], float outputDim[2],
+    short line, const mitk::BeamformingSettings::Pointer config, bool signedDMAS)
+  {
+    const float* apodisation = config->GetApodizationFunction();
+    const short apodArraySize = config->GetApodizationArraySize();
+
+    float& inputS = inputDim[1];
+    float& inputL = inputDim[0];
+
+    float& outputS = outputDim[1];
+    float& outputL = outputDim[0];
+
+    short maxLine = 0;
+    short minLine = 0;
+
+    SphericalLineDelays lineDelays(inputDim, outputDim, line, config);
+
+    for (short sample = 0; sample < outputS; ++sample)
+    {
+      const short* delays = lineDelays.Get(sample, minLine, maxLine);
+      const short elements = maxLine - minLine;
+
+      short usedLines = elements;
+      float apod_mult = (float)apodArraySize / (float)usedLines;
+
+      // sum and sum of squares of sign(s) * sqrt(|s|) of the apodized samples
+      double sum = 0;
+      double squaredSum = 0;
+      float sign = 0;
+
+      for (short l_s = 0; l_s < elements; ++l_s)
+      {
+        // the last element is never the first element of a pair, so it does not change usedLines or the sign
+        const bool isFirstOfPair = l_s < elements - 1;
+        if (delays[l_s] >= inputS || delays[l_s] < 0)
+        {
+          if (isFirstOfPair)
+            --usedLines;
+          continue;
+        }
+
+        const float s = input[l_s + minLine + delays[l_s] * (short)inputL];
+        const float apodized = s * apodisation[(int)(l_s * apod_mult)];
+        sum += std::sqrt(std::fabs((double)apodized)) * ((apodized > 0) - (apodized < 0));
+        squaredSum += std::fabs((double)apodized);
+
+        if (isFirstOfPair)
+          sign += s;
+      }
+
+      float value = (float)((sum * sum - squaredSum) / 2) / (float)(pow(usedLines, 2) - (usedLines - 1));
+      if (signedDMAS)
+        value *= ((sign > 0) - (sign < 0));
+
+      output[sample*(short)outputL + line] = value;
+    }
+  }
+}
+
 mitk::BeamformingUtils::BeamformingUtils()
 {
 }
@@ -180,74 +333,74 @@ unsigned short* mitk::BeamformingUtils::MinMaxLines(const mitk::BeamformingSetti
   return dDest;
 }
 
-void mitk::BeamformingUtils::DASSphericalLine(
-  float* input, float* output, float inputDim[2], float outputDim[2],
-  const short& line, const mitk::BeamformingSettings::Pointer config)
+void mitk::BeamformingUtils::SphericalDelays(short* delays, float s_i, float l_p, short minLine, short maxLine, const mitk::BeamformingSettings* config)
 {
-  const float* apodisation = config->GetApodizationFunction();
-  const short apodArraySize = config->GetApodizationArraySize();
-
   const float* elementHeights = config->GetElementHeights();
   const float* elementPositions = config->GetElementPositions();
 
-  float& inputS = inputDim[1];
-  float& inputL = inputDim[0];
-
-  float& outputS = outputDim[1];
-  float& outputL = outputDim[0];
-
-  short AddSample = 0;
-  short maxLine = 0;
-  short minLine = 0;
-  float l_p = 0;
-  float s_i = 0;
-
-  float apod_mult = 1;
-
-  short usedLines = (maxLine - minLine);
-
-  float totalSamples_i = (float)(config->GetReconstructionDepth()) / (float)(config->GetSpeedOfSound() * config->GetTimeSpacing());
-  totalSamples_i = totalSamples_i <= inputS ? totalSamples_i : inputS;
-
-  l_p = (float)line / outputL * config->GetHorizontalExtent();
+  const float speedOfSound = config->GetSpeedOfSound();
+  const float timeSpacing = config->GetTimeSpacing();
+  const int isPhotoacousticImage = config->GetIsPhotoacousticImage();
 
-  for (short sample = 0; sample < outputS; ++sample)
+  for (short l_s = minLine; l_s < maxLine; ++l_s)
   {
-    s_i = (float)sample / outputS * totalSamples_i;
-
-    minLine = config->GetMinMaxLines()[2*sample*(short)outputL + 2*line];
-    maxLine = config->GetMinMaxLines()[2*sample*(short)outputL + 2*line + 1];
-    usedLines = (maxLine - minLine);
-
-    apod_mult = (float)apodArraySize / (float)usedLines;
+    delays[l_s - minLine] = (int)sqrt(
+      pow(s_i - elementHeights[l_s] / (speedOfSound*timeSpacing), 2)
+      +
+      pow((1 / (timeSpacing*speedOfSound)) * (l_p - elementPositions[l_s]), 2)
+    ) + (1 - isPhotoacousticImage)*s_i;
+  }
+}
 
-    for (short l_s = minLine; l_s < maxLine; ++l_s)
-    {
-      AddSample = (int)sqrt(
-        pow(s_i-elementHeights[l_s]/(config->GetSpeedOfSound()*config->GetTimeSpacing()), 2)
-        +
-        pow((1 / (config->GetTimeSpacing()*config->GetSpeedOfSound())) * (l_p - elementPositions[l_s]), 2)
-      ) + (1 - config->GetIsPhotoacousticImage())*s_i;
-      if (AddSample < inputS && AddSample >= 0)
-        output[sample*(short)outputL + line] += input[l_s + AddSample*(short)inputL] *
-        apodisation[(short)((l_s - minLine)*apod_mult)];
-      else
-        --usedLines;
-    }
-    output[sample*(short)outputL + line] = output[sample*(short)outputL + line] / usedLines;
+void mitk::BeamformingUtils::BeamformSlice(float* input, float* output, float inputDim[2], float outputDim[2],
+  const mitk::BeamformingSettings::Pointer config, unsigned int numberOfThreads)
+{
+  BeamformLineFunction beamformLine = &DASSphericalLine;
+  switch (config->GetAlgorithm())
+  {
+  case BeamformingSettings::BeamformingAlgorithm::DMAS:
+    beamformLine = &DMASSphericalLine;
+    break;
+  case BeamformingSettings::BeamformingAlgorithm::sDMAS:
+    beamformLine = &sDMASSphericalLine;
+    break;
+  case BeamformingSettings::BeamformingAlgorithm::DAS:
+  default:
+    beamformLine = &DASSphericalLine;
+    break;
   }
+
+  // create the lookup tables once, before the lines are distributed
+  config->GetMinMaxLines();
+  config->GetDelays();
+
+  BeamformSliceData data;
+  data.BeamformLine = beamformLine;
+  data.Input = input;
+  data.Output = output;
+  data.InputDim = inputDim;
+  data.OutputDim = outputDim;
+  data.Config = config;
+  data.Lines = (short)outputDim[0];
+  data.NextLine = 0;
+
+  if (numberOfThreads == 0)
+    numberOfThreads = itk::MultiThreader::GetGlobalDefaultNumberOfThreads();
+  numberOfThreads = std::max(1u, std::min(numberOfThreads, (unsigned int)std::max<short>(data.Lines, 1)));
+
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->SetNumberOfThreads(numberOfThreads);
+  threader->SetSingleMethod(BeamformSliceCallback, &data);
+  threader->SingleMethodExecute();
 }
 
-void mitk::BeamformingUtils::DMASSphericalLine(
+void mitk::BeamformingUtils::DASSphericalLine(
   float* input, float* output, float inputDim[2], float outputDim[2],
   const short& line, const mitk::BeamformingSettings::Pointer config)
 {
   const float* apodisation = config->GetApodizationFunction();
   const short apodArraySize = config->GetApodizationArraySize();
 
-  const float* elementHeights = config->GetElementHeights();
-  const float* elementPositions = config->GetElementPositions();
-
   float& inputS = inputDim[1];
   float& inputL = inputDim[0];
 
@@ -256,153 +409,43 @@ void mitk::BeamformingUtils::DMASSphericalLine(
 
   short maxLine = 0;
   short minLine = 0;
-  float l_p = 0;
-  float s_i = 0;
-
-  float apod_mult = 1;
-
-  float mult = 0;
-
-  short usedLines = (maxLine - minLine);
 
-  float totalSamples_i = (float)(config->GetReconstructionDepth()) /
-    (float)(config->GetSpeedOfSound() * config->GetTimeSpacing());
-  totalSamples_i = totalSamples_i <= inputS ? totalSamples_i : inputS;
-
-  l_p = (float)line / outputL * config->GetHorizontalExtent();
+  SphericalLineDelays lineDelays(inputDim, outputDim, line, config);
 
   for (short sample = 0; sample < outputS; ++sample)
   {
-    s_i = (float)sample / outputS * totalSamples_i;
-
-    minLine = config->GetMinMaxLines()[2 * sample*(short)outputL + 2 * line];
-    maxLine = config->GetMinMaxLines()[2 * sample*(short)outputL + 2 * line + 1];
-    usedLines = (maxLine - minLine);
+    const short* delays = lineDelays.Get(sample, minLine, maxLine);
+    const short elements = maxLine - minLine;
 
-    apod_mult = (float)apodArraySize / (float)usedLines;
+    short usedLines = elements;
+    float apod_mult = (float)apodArraySize / (float)usedLines;
 
-    //calculate the AddSamples beforehand to save some time
-    short* AddSample = new short[maxLine - minLine];
-    for (short l_s = 0; l_s < maxLine - minLine; ++l_s)
+    // branch free, so that the loop only consists of the gather and the accumulation; elements with a delay outside
+    // of the input read the first sample of their column and are weighted with zero
+    float sum = 0;
+    for (short l_s = 0; l_s < elements; ++l_s)
     {
-      AddSample[l_s] = (int)sqrt(
-        pow(s_i - elementHeights[l_s + minLine] / (config->GetSpeedOfSound()*config->GetTimeSpacing()), 2)
-        +
-        pow((1 / (config->GetTimeSpacing()*config->GetSpeedOfSound())) * (l_p - elementPositions[l_s + minLine]), 2)
-      ) + (1 - config->GetIsPhotoacousticImage())*s_i;
-    }
-
-    float s_1 = 0;
-    float s_2 = 0;
-
-    for (short l_s1 = minLine; l_s1 < maxLine - 1; ++l_s1)
-    {
-      if (AddSample[l_s1 - minLine] < inputS && AddSample[l_s1 - minLine] >= 0)
-      {
-        for (short l_s2 = l_s1 + 1; l_s2 < maxLine; ++l_s2)
-        {
-          if (AddSample[l_s2 - minLine] < inputS && AddSample[l_s2 - minLine] >= 0)
-          {
-            s_2 = input[l_s2 + AddSample[l_s2 - minLine] * (short)inputL];
-            s_1 = input[l_s1 + AddSample[l_s1 - minLine] * (short)inputL];
-
-            mult = s_2 * apodisation[(int)((l_s2 - minLine)*apod_mult)] * s_1 * apodisation[(int)((l_s1 - minLine)*apod_mult)];
-            output[sample*(short)outputL + line] += sqrt(fabs(mult)) * ((mult > 0) - (mult < 0));
-          }
-        }
-      }
-      else
-        --usedLines;
+      const short delay = delays[l_s];
+      const bool isValid = delay < inputS && delay >= 0;
+      const float value = input[l_s + minLine + (isValid ? delay : 0) * (short)inputL] *
+        apodisation[(short)(l_s * apod_mult)];
+      sum += isValid ? value : 0.f;
+      usedLines -= !isValid;
     }
-
-    output[sample*(short)outputL + line] = output[sample*(short)outputL + line] / (float)(pow(usedLines, 2) - (usedLines - 1));
-
-    delete[] AddSample;
+    output[sample*(short)outputL + line] = sum / usedLines;
   }
 }
 
-void mitk::BeamformingUtils::sDMASSphericalLine(
+void mitk::BeamformingUtils::DMASSphericalLine(
   float* input, float* output, float inputDim[2], float outputDim[2],
   const short& line, const mitk::BeamformingSettings::Pointer config)
 {
-  const float* apodisation = config->GetApodizationFunction();
-  const short apodArraySize = config->GetApodizationArraySize();
-
-  const float* elementHeights = config->GetElementHeights();
-  const float* elementPositions = config->GetElementPositions();
-
-  float& inputS = inputDim[1];
-  float& inputL = inputDim[0];
-
-  float& outputS = outputDim[1];
-  float& outputL = outputDim[0];
-
-  short maxLine = 0;
-  short minLine = 0;
-  float l_p = 0;
-  float s_i = 0;
-
-  float apod_mult = 1;
-
-  float mult = 0;
-
-  short usedLines = (maxLine - minLine);
-
-  float totalSamples_i = (float)(config->GetReconstructionDepth()) /
-    (float)(config->GetSpeedOfSound() * config->GetTimeSpacing());
-  totalSamples_i = totalSamples_i <= inputS ? totalSamples_i : inputS;
-
-  l_p = (float)line / outputL * config->GetHorizontalExtent();
-
-  for (short sample = 0; sample < outputS; ++sample)
-  {
-    s_i = (float)sample / outputS * totalSamples_i;
-
-    minLine = config->GetMinMaxLines()[2 * sample*(short)outputL + 2 * line];
-    maxLine = config->GetMinMaxLines()[2 * sample*(short)outputL + 2 * line + 1];
-    usedLines = (maxLine - minLine);
-
-    apod_mult = (float)apodArraySize / (float)usedLines;
-
-    //calculate the AddSamples beforehand to save some time
-    short* AddSample = new short[maxLine - minLine];
-    for (short l_s = 0; l_s < maxLine - minLine; ++l_s)
-    {
-      AddSample[l_s] = (int)sqrt(
-        pow(s_i - elementHeights[l_s + minLine] / (config->GetSpeedOfSound()*config->GetTimeSpacing()), 2)
-        +
-        pow((1 / (config->GetTimeSpacing()*config->GetSpeedOfSound())) * (l_p - elementPositions[l_s + minLine]), 2)
-      ) + (1 - config->GetIsPhotoacousticImage())*s_i;
-    }
-
-    float s_1 = 0;
-    float s_2 = 0;
-    float sign = 0;
-
-    for (short l_s1 = minLine; l_s1 < maxLine - 1; ++l_s1)
-    {
-      if (AddSample[l_s1 - minLine] < inputS && AddSample[l_s1 - minLine] >= 0)
-      {
-        s_1 = input[l_s1 + AddSample[l_s1 - minLine] * (short)inputL];
-        sign += s_1;
-
-        for (short l_s2 = l_s1 + 1; l_s2 < maxLine; ++l_s2)
-        {
-          if (AddSample[l_s2 - minLine] < inputS && AddSample[l_s2 - minLine] >= 0)
-          {
-            s_2 = input[l_s2 + AddSample[l_s2 - minLine] * (short)inputL];
-
-            mult = s_2 * apodisation[(int)((l_s2 - minLine)*apod_mult)] * s_1 * apodisation[(int)((l_s1 - minLine)*apod_mult)];
-            output[sample*(short)outputL + line] += sqrt(fabs(mult)) * ((mult > 0) - (mult < 0));
-          }
-        }
-      }
-      else
-        --usedLines;
-    }
-
-    output[sample*(short)outputL + line] = output[sample*(short)outputL + line] / (float)(pow(usedLines, 2) - (usedLines - 1)) * ((sign > 0) - (sign < 0));
+  DelayMultiplyAndSumLine(input, output, inputDim, outputDim, line, config, false);
+}
 
-    delete[] AddSample;
-  }
+void mitk::BeamformingUtils::sDMASSphericalLine(
+  float* input, float* output, float inputDim[2], float outputDim[2],
+  const short& line, const mitk::BeamformingSettings::Pointer config)
+{
+  DelayMultiplyAndSumLine(input, output, inputDim, outputDim, line, config, true);
 }
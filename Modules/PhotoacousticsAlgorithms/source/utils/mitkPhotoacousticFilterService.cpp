@@ -265,17 +265,22 @@ mitk::Image::Pointer mitk::PhotoacousticFilterService::ApplyBandpassFilter(
   try
   {
     auto floatData = ConvertToFloat(data);
-    mitk::BandpassFilter::Pointer bandpassFilter = mitk::BandpassFilter::New();
-    bandpassFilter->SetInput(floatData);
-    bandpassFilter->SetHighPass(BPHighPass);
-    bandpassFilter->SetLowPass(BPLowPass);
-    bandpassFilter->SetHighPassAlpha(alphaHighPass);
-    bandpassFilter->SetLowPassAlpha(alphaLowPass);
-    bandpassFilter->SetSpeedOfSound(SpeedOfSound);
-    bandpassFilter->SetTimeSpacing(TimeSpacing);
-    bandpassFilter->SetIsBFImage(IsBFImage);
-    bandpassFilter->Update();
-    return bandpassFilter->GetOutput();
+    if (m_BandpassFilter.IsNull())
+      m_BandpassFilter = mitk::BandpassFilter::New();
+    m_BandpassFilter->SetInput(floatData);
+    m_BandpassFilter->SetHighPass(BPHighPass);
+    m_BandpassFilter->SetLowPass(BPLowPass);
+    m_BandpassFilter->SetHighPassAlpha(alphaHighPass);
+    m_BandpassFilter->SetLowPassAlpha(alphaLowPass);
+    m_BandpassFilter->SetSpeedOfSound(SpeedOfSound);
+    m_BandpassFilter->SetTimeSpacing(TimeSpacing);
+    m_BandpassFilter->SetIsBFImage(IsBFImage);
+    m_BandpassFilter->Update();
+
+    // the next call creates a new output, so the returned image stays valid
+    mitk::Image::Pointer output = m_BandpassFilter->GetOutput();
+    output->DisconnectPipeline();
+    return output;
   }
   catch (mitk::Exception &e)
   {
@@ -0,0 +1,440 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "mitkPhotoacousticStreamingPipeline.h"
+#include "mitkBeamformingUtils.h"
+
+#include <mitkImageReadAccessor.h>
+#include <itkMultiThreader.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+  double MillisecondsSince(std::chrono::high_resolution_clock::time_point start)
+  {
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+  }
+}
+
+mitk::PhotoacousticStreamingPipeline::PhotoacousticStreamingPipeline() :
+  m_BeamformingSettings(nullptr),
+  m_CropAbove(0),
+  m_CropBelow(0),
+  m_CropLeft(0),
+  m_CropRight(0),
+  m_UseBandpassFilter(false),
+  m_BandpassTimeSpacing(0),
+  m_BandpassFilter(BandpassFilter::New()),
+  m_UseBModeFilter(false),
+  m_BModeMethod(PhotoacousticFilterService::BModeMethod::Abs),
+  m_UseLogFilter(false),
+  m_NumberOfThreads(0),
+  m_Queue(4),
+  m_QueueHead(0),
+  m_QueueCount(0),
+  m_NextFrameNumber(0),
+  m_Running(false),
+  m_ProcessedFrames(0),
+  m_DroppedFrames(0)
+{
+  m_OutputDimensions[0] = 0;
+  m_OutputDimensions[1] = 0;
+}
+
+mitk::PhotoacousticStreamingPipeline::~PhotoacousticStreamingPipeline()
+{
+  Stop();
+}
+
+void mitk::PhotoacousticStreamingPipeline::SetBeamformingSettings(BeamformingSettings::Pointer settings)
+{
+  std::lock_guard<std::mutex> lock(m_ProcessingMutex);
+  m_BeamformingSettings = settings;
+}
+
+mitk::BeamformingSettings::Pointer mitk::PhotoacousticStreamingPipeline::GetBeamformingSettings() const
+{
+  std::lock_guard<std::mutex> lock(m_ProcessingMutex);
+  return m_BeamformingSettings;
+}
+
+void mitk::PhotoacousticStreamingPipeline::SetCropping(unsigned int above, unsigned int below, unsigned int left, unsigned int right)
+{
+  std::lock_guard<std::mutex> lock(m_ProcessingMutex);
+  m_CropAbove = above;
+  m_CropBelow = below;
+  m_CropLeft = left;
+  m_CropRight = right;
+}
+
+void mitk::PhotoacousticStreamingPipeline::SetBModeFilter(bool useBModeFilter, PhotoacousticFilterService::BModeMethod method, bool useLogFilter)
+{
+  std::lock_guard<std::mutex> lock(m_ProcessingMutex);
+  m_UseBModeFilter = useBModeFilter;
+  m_BModeMethod = method;
+  m_UseLogFilter = useLogFilter;
+}
+
+void mitk::PhotoacousticStreamingPipeline::SetBandpassFilter(bool useBandpassFilter, float highPass, float lowPass, float highPassAlpha,
+  float lowPassAlpha, float timeSpacing)
+{
+  std::lock_guard<std::mutex> lock(m_ProcessingMutex);
+  m_UseBandpassFilter = useBandpassFilter;
+  m_BandpassTimeSpacing = timeSpacing;
+  m_BandpassFilter->SetHighPass(highPass);
+  m_BandpassFilter->SetLowPass(lowPass);
+  m_BandpassFilter->SetHighPassAlpha(highPassAlpha);
+  m_BandpassFilter->SetLowPassAlpha(lowPassAlpha);
+}
+
+void mitk::PhotoacousticStreamingPipeline::SetNumberOfThreads(unsigned int numberOfThreads)
+{
+  std::lock_guard<std::mutex> lock(m_ProcessingMutex);
+  m_NumberOfThreads = numberOfThreads;
+  m_BandpassFilter->SetNumberOfThreads(numberOfThreads > 0 ? numberOfThreads : itk::MultiThreader::GetGlobalDefaultNumberOfThreads());
+}
+
+void mitk::PhotoacousticStreamingPipeline::SetQueueSize(unsigned int queueSize)
+{
+  std::lock_guard<std::mutex> lock(m_QueueMutex);
+  if (m_Running)
+    mitkThrow() << "The queue size cannot be changed while the pipeline is running.";
+  if (queueSize == 0)
+    mitkThrow() << "The queue needs to hold at least one frame.";
+  m_Queue.resize(queueSize);
+  m_QueueHead = 0;
+  m_QueueCount = 0;
+}
+
+unsigned int mitk::PhotoacousticStreamingPipeline::GetQueueSize() const
+{
+  std::lock_guard<std::mutex> lock(m_QueueMutex);
+  return (unsigned int)m_Queue.size();
+}
+
+void mitk::PhotoacousticStreamingPipeline::SetFrameProcessedCallback(FrameCallback callback)
+{
+  std::lock_guard<std::mutex> lock(m_ProcessingMutex);
+  m_FrameProcessedCallback = callback;
+}
+
+void mitk::PhotoacousticStreamingPipeline::Start()
+{
+  std::lock_guard<std::mutex> lock(m_QueueMutex);
+  if (m_Running)
+    return;
+  m_Running = true;
+  m_Worker = std::thread(&PhotoacousticStreamingPipeline::Run, this);
+}
+
+void mitk::PhotoacousticStreamingPipeline::Stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_QueueMutex);
+    if (!m_Running)
+      return;
+    m_Running = false;
+  }
+  m_QueueCondition.notify_all();
+  if (m_Worker.joinable())
+    m_Worker.join();
+}
+
+bool mitk::PhotoacousticStreamingPipeline::IsRunning() const
+{
+  std::lock_guard<std::mutex> lock(m_QueueMutex);
+  return m_Running;
+}
+
+bool mitk::PhotoacousticStreamingPipeline::PushFrame(const float* data, unsigned int lines, unsigned int samples)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_QueueMutex);
+    if (m_Running && m_QueueCount < m_Queue.size())
+    {
+      // the worker only reads the frame at the head of the queue, so this slot is free
+      Frame& frame = m_Queue[(m_QueueHead + m_QueueCount) % m_Queue.size()];
+      frame.Data.assign(data, data + (std::size_t)lines * samples);
+      frame.Lines = lines;
+      frame.Samples = samples;
+      frame.Number = m_NextFrameNumber++;
+      frame.PushTime = std::chrono::high_resolution_clock::now();
+      ++m_QueueCount;
+      m_QueueCondition.notify_one();
+      return true;
+    }
+    ++m_NextFrameNumber;
+  }
+
+  std::lock_guard<std::mutex> lock(m_StatisticsMutex);
+  ++m_DroppedFrames;
+  return false;
+}
+
+bool mitk::PhotoacousticStreamingPipeline::PushFrame(mitk::Image::Pointer frame, unsigned int slice)
+{
+  std::string type = frame->GetPixelType().GetTypeAsString();
+  if (!(type == "scalar (float)" || type == " (float)"))
+    mitkThrow() << "Pixel type of the frame needs to be float.";
+
+  mitk::ImageReadAccessor accessor(frame, frame->GetSliceData(slice));
+  return PushFrame((const float*)accessor.GetData(), frame->GetDimension(0), frame->GetDimension(1));
+}
+
+void mitk::PhotoacousticStreamingPipeline::Run()
+{
+  while (true)
+  {
+    Frame* frame = nullptr;
+    {
+      std::unique_lock<std::mutex> lock(m_QueueMutex);
+      m_QueueCondition.wait(lock, [this] { return m_QueueCount > 0 || !m_Running; });
+      if (m_QueueCount == 0)
+        return;
+      frame = &m_Queue[m_QueueHead];
+    }
+
+    StageLatencies latencies;
+    latencies.Queue = MillisecondsSince(frame->PushTime);
+    try
+    {
+      std::lock_guard<std::mutex> lock(m_ProcessingMutex);
+      const float* output = ProcessFrame(frame->Data.data(), frame->Lines, frame->Samples, latencies);
+      if (m_FrameProcessedCallback)
+        m_FrameProcessedCallback(output, m_OutputDimensions, frame->Number);
+    }
+    catch (std::exception &e)
+    {
+      // mitk::Exception is a std::exception as well; the callback may throw any standard exception
+      MITK_ERROR << "Could not process frame " << frame->Number << ": " << e.what();
+    }
+    catch (...)
+    {
+      MITK_ERROR << "Could not process frame " << frame->Number << ": unknown exception.";
+    }
+
+    std::lock_guard<std::mutex> lock(m_QueueMutex);
+    m_QueueHead = (m_QueueHead + 1) % m_Queue.size();
+    --m_QueueCount;
+  }
+}
+
+const float* mitk::PhotoacousticStreamingPipeline::ProcessFrame(const float* data, unsigned int lines, unsigned int samples)
+{
+  std::lock_guard<std::mutex> lock(m_ProcessingMutex);
+  StageLatencies latencies;
+  return ProcessFrame(data, lines, samples, latencies);
+}
+
+const float* mitk::PhotoacousticStreamingPipeline::ProcessFrame(const float* data, unsigned int lines, unsigned int samples, StageLatencies& latencies)
+{
+  auto frameStart = std::chrono::high_resolution_clock::now();
+  auto stageStart = frameStart;
+
+  const float* source = data;
+  // the spacing of the beamformed samples in mm as set by the BeamformingFilter, needed by the bandpass filter
+  double sampleSpacing = 1;
+  if (m_BeamformingSettings.IsNotNull())
+  {
+    const unsigned int* inputDim = m_BeamformingSettings->GetInputDim();
+    if (inputDim[0] != lines || inputDim[1] != samples)
+    {
+      mitkThrow() << "Frame dimensions " << lines << "x" << samples << " do not match the beamforming settings "
+        << inputDim[0] << "x" << inputDim[1] << ".";
+    }
+
+    const unsigned int reconstructionLines = m_BeamformingSettings->GetReconstructionLines();
+    const unsigned int samplesPerLine = m_BeamformingSettings->GetSamplesPerLine();
+    m_BeamformedBuffer.resize((std::size_t)reconstructionLines * samplesPerLine);
+
+    float inputDimensions[2] = { (float)lines, (float)samples };
+    float outputDimensions[2] = { (float)reconstructionLines, (float)samplesPerLine };
+    BeamformingUtils::BeamformSlice(const_cast<float*>(data), m_BeamformedBuffer.data(), inputDimensions, outputDimensions,
+      m_BeamformingSettings, m_NumberOfThreads);
+
+    float desiredSpacing = m_BeamformingSettings->GetReconstructionDepth() * 1000 / samplesPerLine;
+    float maxSpacing = m_BeamformingSettings->GetSpeedOfSound() * m_BeamformingSettings->GetTimeSpacing() * samples / samplesPerLine * 1000;
+    sampleSpacing = std::min(desiredSpacing, maxSpacing);
+
+    source = m_BeamformedBuffer.data();
+    lines = reconstructionLines;
+    samples = samplesPerLine;
+  }
+  latencies.Beamforming = MillisecondsSince(stageStart);
+  stageStart = std::chrono::high_resolution_clock::now();
+
+  if (m_CropLeft + m_CropRight >= lines || m_CropAbove + m_CropBelow >= samples)
+  {
+    mitkThrow() << "Cropping " << m_CropLeft << "+" << m_CropRight << " lines and " << m_CropAbove << "+" << m_CropBelow
+      << " samples leaves nothing of a " << lines << "x" << samples << " frame.";
+  }
+
+  m_OutputDimensions[0] = lines - m_CropLeft - m_CropRight;
+  m_OutputDimensions[1] = samples - m_CropAbove - m_CropBelow;
+  m_OutputBuffer.resize((std::size_t)m_OutputDimensions[0] * m_OutputDimensions[1]);
+  for (unsigned int sample = 0; sample < m_OutputDimensions[1]; ++sample)
+  {
+    std::memcpy(&m_OutputBuffer[(std::size_t)sample * m_OutputDimensions[0]],
+      &source[(std::size_t)(sample + m_CropAbove) * lines + m_CropLeft],
+      m_OutputDimensions[0] * sizeof(float));
+  }
+  latencies.Cropping = MillisecondsSince(stageStart);
+  stageStart = std::chrono::high_resolution_clock::now();
+
+  if (m_UseBandpassFilter)
+  {
+    const bool isBeamformed = m_BeamformingSettings.IsNotNull();
+    m_BandpassFilter->SetIsBFImage(isBeamformed);
+    m_BandpassFilter->SetTimeSpacing(m_BandpassTimeSpacing);
+    if (isBeamformed)
+      m_BandpassFilter->SetSpeedOfSound(m_BeamformingSettings->GetSpeedOfSound());
+    m_BandpassFilter->FilterBuffer(m_OutputBuffer.data(), m_OutputBuffer.data(), m_OutputDimensions[0], m_OutputDimensions[1], 1, sampleSpacing);
+  }
+  latencies.Bandpass = MillisecondsSince(stageStart);
+  stageStart = std::chrono::high_resolution_clock::now();
+
+  if (m_UseBModeFilter)
+  {
+    float* output = m_OutputBuffer.data();
+    const std::size_t size = m_OutputBuffer.size();
+    if (m_BModeMethod == PhotoacousticFilterService::BModeMethod::Abs)
+    {
+      if (!m_UseLogFilter)
+      {
+        for (std::size_t i = 0; i < size; ++i)
+          output[i] = std::abs(output[i]);
+      }
+      else
+      {
+        for (std::size_t i = 0; i < size; ++i)
+          output[i] = std::log(std::abs(output[i]));
+      }
+    }
+    else
+    {
+      ApplyEnvelopeDetection(output, m_OutputDimensions[0], m_OutputDimensions[1]);
+      if (m_UseLogFilter)
+      {
+        // itk::BModeImageFilter takes the logarithm of the envelope plus one
+        for (std::size_t i = 0; i < size; ++i)
+          output[i] = std::log10(output[i] + 1);
+      }
+    }
+  }
+  latencies.BMode = MillisecondsSince(stageStart);
+  latencies.Total = MillisecondsSince(frameStart);
+
+  std::lock_guard<std::mutex> lock(m_StatisticsMutex);
+  ++m_ProcessedFrames;
+  m_LastLatencies = latencies;
+  m_SumLatencies.Queue += latencies.Queue;
+  m_SumLatencies.Beamforming += latencies.Beamforming;
+  m_SumLatencies.Cropping += latencies.Cropping;
+  m_SumLatencies.Bandpass += latencies.Bandpass;
+  m_SumLatencies.BMode += latencies.BMode;
+  m_SumLatencies.Total += latencies.Total;
+
+  return m_OutputBuffer.data();
+}
+
+void mitk::PhotoacousticStreamingPipeline::ApplyEnvelopeDetection(float* data, unsigned int lines, unsigned int samples)
+{
+  // same as the analytic signal of itk::PhotoacousticBModeImageFilter: zero padding to a power of two, forward FFT,
+  // removal of the negative frequencies and inverse FFT. The transform is kept as long as the frame size does not change.
+  unsigned int transformSize = 1;
+  while (transformSize < samples)
+    transformSize *= 2;
+
+  if (!m_EnvelopeTransform || (unsigned int)m_EnvelopeTransform->size() != transformSize)
+  {
+    m_EnvelopeTransform.reset(new vnl_fft_1d<float>(transformSize));
+    m_EnvelopeBuffer.set_size(transformSize);
+  }
+
+  const bool even = transformSize % 2 == 0;
+  const unsigned int doubledFrequencies = even ? transformSize / 2 - 1 : (transformSize + 1) / 2 - 1;
+  std::complex<float>* buffer = m_EnvelopeBuffer.data_block();
+
+  for (unsigned int line = 0; line < lines; ++line)
+  {
+    for (unsigned int sample = 0; sample < samples; ++sample)
+      buffer[sample] = std::complex<float>(data[(std::size_t)sample * lines + line], 0.f);
+    for (unsigned int sample = samples; sample < transformSize; ++sample)
+      buffer[sample] = 0;
+
+    // vnl uses the opposite sign convention, see itk::VnlFFT1DComplexToComplexImageFilter
+    m_EnvelopeTransform->bwd_transform(m_EnvelopeBuffer);
+
+    unsigned int frequency = 1;
+    for (; frequency <= doubledFrequencies; ++frequency)
+      buffer[frequency] *= 2.f;
+    if (even)
+      ++frequency;
+    for (; frequency < transformSize; ++frequency)
+      buffer[frequency] = 0;
+
+    m_EnvelopeTransform->fwd_transform(m_EnvelopeBuffer);
+
+    for (unsigned int sample = 0; sample < samples; ++sample)
+      data[(std::size_t)sample * lines + line] = std::abs(buffer[sample]) / transformSize;
+  }
+}
+
+const unsigned int* mitk::PhotoacousticStreamingPipeline::GetOutputDimensions() const
+{
+  return m_OutputDimensions;
+}
+
+unsigned long mitk::PhotoacousticStreamingPipeline::GetNumberOfProcessedFrames() const
+{
+  std::lock_guard<std::mutex> lock(m_StatisticsMutex);
+  return m_ProcessedFrames;
+}
+
+unsigned long mitk::PhotoacousticStreamingPipeline::GetNumberOfDroppedFrames() const
+{
+  std::lock_guard<std::mutex> lock(m_StatisticsMutex);
+  return m_DroppedFrames;
+}
+
+mitk::PhotoacousticStreamingPipeline::StageLatencies mitk::PhotoacousticStreamingPipeline::GetLastLatencies() const
+{
+  std::lock_guard<std::mutex> lock(m_StatisticsMutex);
+  return m_LastLatencies;
+}
+
+mitk::PhotoacousticStreamingPipeline::StageLatencies mitk::PhotoacousticStreamingPipeline::GetMeanLatencies() const
+{
+  std::lock_guard<std::mutex> lock(m_StatisticsMutex);
+  StageLatencies mean;
+  if (m_ProcessedFrames == 0)
+    return mean;
+  mean.Queue = m_SumLatencies.Queue / m_ProcessedFrames;
+  mean.Beamforming = m_SumLatencies.Beamforming / m_ProcessedFrames;
+  mean.Cropping = m_SumLatencies.Cropping / m_ProcessedFrames;
+  mean.Bandpass = m_SumLatencies.Bandpass / m_ProcessedFrames;
+  mean.BMode = m_SumLatencies.BMode / m_ProcessedFrames;
+  mean.Total = m_SumLatencies.Total / m_ProcessedFrames;
+  return mean;
+}
+
+void mitk::PhotoacousticStreamingPipeline::ResetStatistics()
+{
+  std::lock_guard<std::mutex> lock(m_StatisticsMutex);
+  m_ProcessedFrames = 0;
+  m_DroppedFrames = 0;
+  m_LastLatencies = StageLatencies();
+  m_SumLatencies = StageLatencies();
+}
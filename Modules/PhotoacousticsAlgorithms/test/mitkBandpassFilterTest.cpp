@@ -18,6 +18,7 @@ found in the LICENSE file.
 #include <mitkImageReadAccessor.h>
 #include <mitkPhotoacousticFilterService.h>
 #include <random>
+#include <vector>
 #include <mitkIOUtil.h>
 
 #include "../ITKFilter/ITKUltrasound/itkFFT1DRealToComplexConjugateImageFilter.h"
@@ -30,6 +31,7 @@ class mitkBandpassFilterTestSuite : public mitk::TestFixture
   CPPUNIT_TEST_SUITE(mitkBandpassFilterTestSuite);
   MITK_TEST(testHighPass);
   MITK_TEST(testLowPass);
+  MITK_TEST(testReusedFilterKeepsPreviousOutputs);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -179,6 +181,41 @@ public:
     test(0, LOWPASS_FREQENCY, ALPHA, ALPHA, true, false);
   }
 
+  void testReusedFilterKeepsPreviousOutputs()
+  {
+    unsigned int dimension[3]{ 64, 256, 2 };
+    unsigned int size = dimension[0] * dimension[1] * dimension[2];
+    std::vector<float> data(size, 0);
+    addFrequency(LOWPASS_FREQENCY * 1.5f, TIME_SPACING, data.data(), dimension);
+
+    mitk::Image::Pointer inputImage = mitk::Image::New();
+    inputImage->Initialize(mitk::MakeScalarPixelType<float>(), 3, dimension);
+    inputImage->SetImportVolume(data.data(), 0, 0, mitk::Image::ImportMemoryManagementType::CopyMemory);
+
+    auto firstOutput = m_FilterService->ApplyBandpassFilter(inputImage, 0, LOWPASS_FREQENCY, ALPHA, ALPHA, TIME_SPACING / 1e6, 0, false);
+    std::vector<float> firstData(size);
+    {
+      mitk::ImageReadAccessor accessor(firstOutput);
+      std::copy((const float*)accessor.GetData(), (const float*)accessor.GetData() + size, firstData.begin());
+    }
+
+    // a second call with other data must neither change the first output nor give a different result for the same input
+    auto zeroImage = mitk::Image::New();
+    zeroImage->Initialize(mitk::MakeScalarPixelType<float>(), 3, dimension);
+    std::vector<float> zeros(size, 0);
+    zeroImage->SetImportVolume(zeros.data(), 0, 0, mitk::Image::ImportMemoryManagementType::CopyMemory);
+    m_FilterService->ApplyBandpassFilter(zeroImage, 0, LOWPASS_FREQENCY, ALPHA, ALPHA, TIME_SPACING / 1e6, 0, false);
+    auto thirdOutput = m_FilterService->ApplyBandpassFilter(inputImage, 0, LOWPASS_FREQENCY, ALPHA, ALPHA, TIME_SPACING / 1e6, 0, false);
+
+    mitk::ImageReadAccessor firstAccessor(firstOutput);
+    mitk::ImageReadAccessor thirdAccessor(thirdOutput);
+    for (unsigned int i = 0; i < size; ++i)
+    {
+      CPPUNIT_ASSERT_EQUAL(firstData[i], ((const float*)firstAccessor.GetData())[i]);
+      CPPUNIT_ASSERT_EQUAL(firstData[i], ((const float*)thirdAccessor.GetData())[i]);
+    }
+  }
+
   void tearDown() override
   {
     m_FilterService = nullptr;
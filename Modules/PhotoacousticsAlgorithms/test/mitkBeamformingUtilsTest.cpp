@@ -0,0 +1,184 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+#include <mitkBeamformingSettings.h>
+#include <mitkBeamformingUtils.h>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+class mitkBeamformingUtilsTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkBeamformingUtilsTestSuite);
+  MITK_TEST(testDMASEqualsPairwiseSum);
+  MITK_TEST(testSignedDMASEqualsPairwiseSum);
+  MITK_TEST(testDMASConcaveEqualsPairwiseSum);
+  MITK_TEST(testBeamformSliceEqualsLineFunction);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  const unsigned int ELEMENTS = 32;
+  const unsigned int SAMPLES = 800;
+  const unsigned int RECONSTRUCTED_SAMPLES = 128;
+  const unsigned int RECONSTRUCTED_LINES = 48;
+  const float SPEED_OF_SOUND = 1540; // m/s
+  const float PITCH = 0.0003f; // m
+  const float TIME_SPACING = 0.00625f / 1000000; // s
+
+  std::vector<float> m_Input;
+
+  mitk::BeamformingSettings::Pointer CreateSettings(mitk::BeamformingSettings::BeamformingAlgorithm algorithm,
+    mitk::BeamformingSettings::ProbeGeometry geometry = mitk::BeamformingSettings::ProbeGeometry::Linear)
+  {
+    unsigned int inputDim[3] = { ELEMENTS, SAMPLES, 1 };
+    return mitk::BeamformingSettings::New(PITCH,
+      SPEED_OF_SOUND,
+      TIME_SPACING,
+      27.f,
+      true,
+      RECONSTRUCTED_SAMPLES,
+      RECONSTRUCTED_LINES,
+      inputDim,
+      SPEED_OF_SOUND * TIME_SPACING * SAMPLES * 0.8f,
+      false,
+      1,
+      mitk::BeamformingSettings::Apodization::Hann,
+      RECONSTRUCTED_LINES,
+      algorithm,
+      geometry,
+      0.01f);
+  }
+
+  /** \brief Straightforward DMAS with a loop over all pairs of elements, as the line functions computed it before
+  */
+  std::vector<float> PairwiseDMAS(mitk::BeamformingSettings::Pointer config, bool useSign)
+  {
+    std::vector<float> output(RECONSTRUCTED_LINES * RECONSTRUCTED_SAMPLES, 0);
+    const float* apodisation = config->GetApodizationFunction();
+
+    float totalSamples = config->GetReconstructionDepth() / (SPEED_OF_SOUND * TIME_SPACING);
+    totalSamples = totalSamples <= SAMPLES ? totalSamples : SAMPLES;
+
+    for (unsigned int line = 0; line < RECONSTRUCTED_LINES; ++line)
+    {
+      float l_p = (float)line / RECONSTRUCTED_LINES * config->GetHorizontalExtent();
+      for (unsigned int sample = 0; sample < RECONSTRUCTED_SAMPLES; ++sample)
+      {
+        float s_i = (float)sample / RECONSTRUCTED_SAMPLES * totalSamples;
+        short minLine = config->GetMinMaxLines()[2 * (sample * RECONSTRUCTED_LINES + line)];
+        short maxLine = config->GetMinMaxLines()[2 * (sample * RECONSTRUCTED_LINES + line) + 1];
+        std::vector<short> delays(maxLine - minLine);
+        mitk::BeamformingUtils::SphericalDelays(delays.data(), s_i, l_p, minLine, maxLine, config);
+
+        short usedLines = maxLine - minLine;
+        float apod_mult = (float)config->GetApodizationArraySize() / (float)usedLines;
+        double sum = 0;
+        float sign = 0;
+        for (short l_s1 = minLine; l_s1 < maxLine - 1; ++l_s1)
+        {
+          short delay1 = delays[l_s1 - minLine];
+          if (delay1 < 0 || delay1 >= (short)SAMPLES)
+          {
+            --usedLines;
+            continue;
+          }
+          float s_1 = m_Input[l_s1 + delay1 * ELEMENTS];
+          sign += s_1;
+          for (short l_s2 = l_s1 + 1; l_s2 < maxLine; ++l_s2)
+          {
+            short delay2 = delays[l_s2 - minLine];
+            if (delay2 < 0 || delay2 >= (short)SAMPLES)
+              continue;
+            float s_2 = m_Input[l_s2 + delay2 * ELEMENTS];
+            float mult = s_2 * apodisation[(int)((l_s2 - minLine)*apod_mult)] * s_1 * apodisation[(int)((l_s1 - minLine)*apod_mult)];
+            sum += std::sqrt(std::fabs(mult)) * ((mult > 0) - (mult < 0));
+          }
+        }
+        float value = (float)sum / (float)(usedLines * usedLines - (usedLines - 1));
+        if (useSign)
+          value *= ((sign > 0) - (sign < 0));
+        output[sample * RECONSTRUCTED_LINES + line] = value;
+      }
+    }
+    return output;
+  }
+
+  void CheckDMAS(mitk::BeamformingSettings::BeamformingAlgorithm algorithm, mitk::BeamformingSettings::ProbeGeometry geometry)
+  {
+    auto config = CreateSettings(algorithm, geometry);
+    std::vector<float> output(RECONSTRUCTED_LINES * RECONSTRUCTED_SAMPLES, 0);
+    float inputDim[2] = { (float)ELEMENTS, (float)SAMPLES };
+    float outputDim[2] = { (float)RECONSTRUCTED_LINES, (float)RECONSTRUCTED_SAMPLES };
+
+    mitk::BeamformingUtils::BeamformSlice(m_Input.data(), output.data(), inputDim, outputDim, config, 3);
+    auto reference = PairwiseDMAS(config, algorithm == mitk::BeamformingSettings::BeamformingAlgorithm::sDMAS);
+
+    for (unsigned int i = 0; i < output.size(); ++i)
+    {
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(reference[i], output[i], 1e-4 * (std::fabs(reference[i]) + 1e-2));
+    }
+  }
+
+public:
+  void setUp() override
+  {
+    std::mt19937 generator(42);
+    std::normal_distribution<float> distribution(0, 1);
+    m_Input.resize(ELEMENTS * SAMPLES);
+    for (auto& value : m_Input)
+      value = distribution(generator);
+  }
+
+  void tearDown() override
+  {
+    m_Input.clear();
+  }
+
+  void testDMASEqualsPairwiseSum()
+  {
+    CheckDMAS(mitk::BeamformingSettings::BeamformingAlgorithm::DMAS, mitk::BeamformingSettings::ProbeGeometry::Linear);
+  }
+
+  void testSignedDMASEqualsPairwiseSum()
+  {
+    CheckDMAS(mitk::BeamformingSettings::BeamformingAlgorithm::sDMAS, mitk::BeamformingSettings::ProbeGeometry::Linear);
+  }
+
+  void testDMASConcaveEqualsPairwiseSum()
+  {
+    CheckDMAS(mitk::BeamformingSettings::BeamformingAlgorithm::DMAS, mitk::BeamformingSettings::ProbeGeometry::Concave);
+  }
+
+  void testBeamformSliceEqualsLineFunction()
+  {
+    auto config = CreateSettings(mitk::BeamformingSettings::BeamformingAlgorithm::DAS);
+    float inputDim[2] = { (float)ELEMENTS, (float)SAMPLES };
+    float outputDim[2] = { (float)RECONSTRUCTED_LINES, (float)RECONSTRUCTED_SAMPLES };
+
+    std::vector<float> reference(RECONSTRUCTED_LINES * RECONSTRUCTED_SAMPLES, 0);
+    for (short line = 0; line < (short)RECONSTRUCTED_LINES; ++line)
+      mitk::BeamformingUtils::DASSphericalLine(m_Input.data(), reference.data(), inputDim, outputDim, line, config);
+
+    for (unsigned int threads : { 1u, 4u, 0u })
+    {
+      std::vector<float> output(RECONSTRUCTED_LINES * RECONSTRUCTED_SAMPLES, 0);
+      mitk::BeamformingUtils::BeamformSlice(m_Input.data(), output.data(), inputDim, outputDim, config, threads);
+      CPPUNIT_ASSERT_MESSAGE("BeamformSlice with " + std::to_string(threads) + " threads differs from the line function", output == reference);
+    }
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkBeamformingUtils)
@@ -0,0 +1,208 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+#include <mitkPhotoacousticStreamingPipeline.h>
+#include <mitkPhotoacousticFilterService.h>
+#include <mitkBeamformingUtils.h>
+#include <mitkImageReadAccessor.h>
+
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+class mitkPhotoacousticStreamingPipelineTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkPhotoacousticStreamingPipelineTestSuite);
+  MITK_TEST(testCroppingAndAbsEqualsFilterService);
+  MITK_TEST(testEnvelopeDetectionEqualsFilterService);
+  MITK_TEST(testBandpassEqualsFilterService);
+  MITK_TEST(testBeamformingEqualsBeamformSlice);
+  MITK_TEST(testQueueProcessesFramesInOrder);
+  MITK_TEST(testFramesAreDroppedWhenNotRunning);
+  MITK_TEST(testWorkerContinuesAfterCallbackException);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  const unsigned int LINES = 24;
+  const unsigned int SAMPLES = 200;
+
+  mitk::PhotoacousticStreamingPipeline::Pointer m_Pipeline;
+  mitk::PhotoacousticFilterService::Pointer m_FilterService;
+  std::vector<float> m_Frame;
+
+  mitk::Image::Pointer CreateImage(const std::vector<float>& data, unsigned int lines, unsigned int samples)
+  {
+    unsigned int dimensions[3] = { lines, samples, 1 };
+    mitk::Image::Pointer image = mitk::Image::New();
+    image->Initialize(mitk::MakeScalarPixelType<float>(), 3, dimensions);
+    image->SetImportVolume(const_cast<float*>(data.data()), 0, 0, mitk::Image::ImportMemoryManagementType::CopyMemory);
+    return image;
+  }
+
+  void CheckOutputEqualsImage(const float* output, mitk::Image::Pointer reference, float relativeTolerance)
+  {
+    CPPUNIT_ASSERT_EQUAL(reference->GetDimension(0), m_Pipeline->GetOutputDimensions()[0]);
+    CPPUNIT_ASSERT_EQUAL(reference->GetDimension(1), m_Pipeline->GetOutputDimensions()[1]);
+
+    mitk::ImageReadAccessor accessor(reference);
+    const float* referenceData = (const float*)accessor.GetData();
+    for (unsigned int i = 0; i < reference->GetDimension(0) * reference->GetDimension(1); ++i)
+    {
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(referenceData[i], output[i], relativeTolerance * (std::fabs(referenceData[i]) + 1e-3));
+    }
+  }
+
+public:
+  void setUp() override
+  {
+    m_Pipeline = mitk::PhotoacousticStreamingPipeline::New();
+    m_FilterService = mitk::PhotoacousticFilterService::New();
+
+    std::mt19937 generator(42);
+    std::normal_distribution<float> distribution(0, 1);
+    m_Frame.resize(LINES * SAMPLES);
+    for (auto& value : m_Frame)
+      value = distribution(generator);
+  }
+
+  void tearDown() override
+  {
+    m_Pipeline = nullptr;
+    m_FilterService = nullptr;
+    m_Frame.clear();
+  }
+
+  void testCroppingAndAbsEqualsFilterService()
+  {
+    int errCode = 0;
+    auto reference = m_FilterService->ApplyCropping(CreateImage(m_Frame, LINES, SAMPLES), 10, 20, 3, 2, 0, 0, &errCode);
+    CPPUNIT_ASSERT_EQUAL(0, errCode);
+    reference = m_FilterService->ApplyBmodeFilter(reference, mitk::PhotoacousticFilterService::BModeMethod::Abs, false);
+
+    m_Pipeline->SetCropping(10, 20, 2, 3);
+    m_Pipeline->SetBModeFilter(true, mitk::PhotoacousticFilterService::BModeMethod::Abs, false);
+    CheckOutputEqualsImage(m_Pipeline->ProcessFrame(m_Frame.data(), LINES, SAMPLES), reference, 0);
+  }
+
+  void testEnvelopeDetectionEqualsFilterService()
+  {
+    for (bool useLogFilter : { false, true })
+    {
+      auto reference = m_FilterService->ApplyBmodeFilter(CreateImage(m_Frame, LINES, SAMPLES),
+        mitk::PhotoacousticFilterService::BModeMethod::EnvelopeDetection, useLogFilter);
+
+      m_Pipeline->SetBModeFilter(true, mitk::PhotoacousticFilterService::BModeMethod::EnvelopeDetection, useLogFilter);
+      CheckOutputEqualsImage(m_Pipeline->ProcessFrame(m_Frame.data(), LINES, SAMPLES), reference, 1e-3f);
+    }
+  }
+
+  void testBandpassEqualsFilterService()
+  {
+    // 200 samples are no power of two, so the bandpass filter resamples the lines
+    const float timeSpacing = 0.00625f / 1000000;
+    const float lowPass = 0.25f / timeSpacing / 2;
+    auto reference = m_FilterService->ApplyBandpassFilter(CreateImage(m_Frame, LINES, SAMPLES), 0, lowPass, 0.5f, 0.5f, timeSpacing, 0, false);
+    reference = m_FilterService->ApplyBmodeFilter(reference, mitk::PhotoacousticFilterService::BModeMethod::Abs, false);
+
+    m_Pipeline->SetBandpassFilter(true, 0, lowPass, 0.5f, 0.5f, timeSpacing);
+    m_Pipeline->SetBModeFilter(true, mitk::PhotoacousticFilterService::BModeMethod::Abs, false);
+    CheckOutputEqualsImage(m_Pipeline->ProcessFrame(m_Frame.data(), LINES, SAMPLES), reference, 1e-4f);
+    CPPUNIT_ASSERT(m_Pipeline->GetLastLatencies().Bandpass >= 0);
+  }
+
+  void testBeamformingEqualsBeamformSlice()
+  {
+    unsigned int inputDim[3] = { LINES, SAMPLES, 1 };
+    auto settings = mitk::BeamformingSettings::New(0.0003f, 1540.f, 0.00625f / 1000000, 27.f, true, 64, 32, inputDim,
+      1540.f * 0.00625f / 1000000 * SAMPLES, false, 1, mitk::BeamformingSettings::Apodization::Hann, 32,
+      mitk::BeamformingSettings::BeamformingAlgorithm::DAS, mitk::BeamformingSettings::ProbeGeometry::Linear, 0.01f);
+
+    std::vector<float> reference(32 * 64);
+    float inputDimensions[2] = { (float)LINES, (float)SAMPLES };
+    float outputDimensions[2] = { 32, 64 };
+    mitk::BeamformingUtils::BeamformSlice(m_Frame.data(), reference.data(), inputDimensions, outputDimensions, settings);
+
+    m_Pipeline->SetBeamformingSettings(settings);
+    m_Pipeline->SetNumberOfThreads(2);
+    const float* output = m_Pipeline->ProcessFrame(m_Frame.data(), LINES, SAMPLES);
+    CPPUNIT_ASSERT_EQUAL(32u, m_Pipeline->GetOutputDimensions()[0]);
+    CPPUNIT_ASSERT_EQUAL(64u, m_Pipeline->GetOutputDimensions()[1]);
+    CPPUNIT_ASSERT(std::vector<float>(output, output + reference.size()) == reference);
+
+    CPPUNIT_ASSERT_THROW(m_Pipeline->ProcessFrame(m_Frame.data(), LINES / 2, SAMPLES * 2), mitk::Exception);
+  }
+
+  void testQueueProcessesFramesInOrder()
+  {
+    const unsigned long numberOfFrames = 5;
+    std::vector<unsigned long> processedFrames;
+    std::vector<float> firstValues;
+    m_Pipeline->SetQueueSize(numberOfFrames);
+    m_Pipeline->SetBModeFilter(true);
+    m_Pipeline->SetFrameProcessedCallback([&](const float* data, const unsigned int*, unsigned long frameNumber)
+    {
+      processedFrames.push_back(frameNumber);
+      firstValues.push_back(data[0]);
+    });
+
+    m_Pipeline->Start();
+    for (unsigned long frame = 0; frame < numberOfFrames; ++frame)
+    {
+      m_Frame[0] = -(float)frame;
+      CPPUNIT_ASSERT(m_Pipeline->PushFrame(m_Frame.data(), LINES, SAMPLES));
+    }
+    m_Pipeline->Stop();
+
+    CPPUNIT_ASSERT_EQUAL(numberOfFrames, m_Pipeline->GetNumberOfProcessedFrames());
+    CPPUNIT_ASSERT_EQUAL(0ul, m_Pipeline->GetNumberOfDroppedFrames());
+    CPPUNIT_ASSERT_EQUAL((std::size_t)numberOfFrames, processedFrames.size());
+    for (unsigned long frame = 0; frame < numberOfFrames; ++frame)
+    {
+      CPPUNIT_ASSERT_EQUAL(frame, processedFrames[frame]);
+      CPPUNIT_ASSERT_EQUAL((float)frame, firstValues[frame]);
+    }
+    CPPUNIT_ASSERT(m_Pipeline->GetMeanLatencies().Total >= 0);
+  }
+
+  void testFramesAreDroppedWhenNotRunning()
+  {
+    CPPUNIT_ASSERT(!m_Pipeline->PushFrame(m_Frame.data(), LINES, SAMPLES));
+    CPPUNIT_ASSERT_EQUAL(1ul, m_Pipeline->GetNumberOfDroppedFrames());
+    CPPUNIT_ASSERT_EQUAL(0ul, m_Pipeline->GetNumberOfProcessedFrames());
+  }
+
+  void testWorkerContinuesAfterCallbackException()
+  {
+    std::vector<unsigned long> processedFrames;
+    m_Pipeline->SetQueueSize(3);
+    m_Pipeline->SetFrameProcessedCallback([&](const float*, const unsigned int*, unsigned long frameNumber)
+    {
+      processedFrames.push_back(frameNumber);
+      if (frameNumber == 0)
+        throw std::runtime_error("callback failed");
+    });
+
+    m_Pipeline->Start();
+    for (unsigned int frame = 0; frame < 3; ++frame)
+      CPPUNIT_ASSERT(m_Pipeline->PushFrame(m_Frame.data(), LINES, SAMPLES));
+    m_Pipeline->Stop();
+
+    CPPUNIT_ASSERT_EQUAL((std::size_t)3, processedFrames.size());
+    CPPUNIT_ASSERT_EQUAL(2ul, processedFrames[2]);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkPhotoacousticStreamingPipeline)
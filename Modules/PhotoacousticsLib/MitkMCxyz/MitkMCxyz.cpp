@@ -272,7 +272,7 @@ public:
    *      D.E. Knuth, "Seminumerical Algorithms," 2nd edition, vol. 2
    *      of "The Art of Computer Programming", Addison-Wesley, (1981).
    *
-   *      When Type is 0, sets Seed as the seed. Make sure 0<Seed<32000.
+   *      When Type is 0, sets Seed as the seed. Make sure 0<Seed<MSEED.
    *      When Type is 1, returns a random number.
    *      When Type is 2, gets the status of the generator.
    *      When Type is 3, restores the status of the generator.
@@ -619,6 +619,7 @@ bool simulatePVFC = false;
 int requestedNumberOfPhotons = 100000;
 float requestedSimulationTime = 0; // in minutes
 int concurentThreadsSupported = -1;
+int randomSeed = -1;
 float yOffset = 0; // in mm
 bool saveLegacy = false;
 std::string normalizationFilename;
@@ -671,6 +672,9 @@ int main(int argc, char * argv[]) {
   parser.addArgument(
     "jobs", "j", mitkCommandLineParser::Int,
     "Number of jobs", "Specifies the number of jobs for simutation (default: -1 which starts as many jobs as supported).");
+  parser.addArgument(
+    "seed", "s", mitkCommandLineParser::Int,
+    "Random seed", "Seeds the random number generator (default: -1 which seeds from the system time). When simulating a fixed number of photons, the result only depends on the seed and not on the number of jobs.");
   parser.addArgument(
     "probe-xml", "p", mitkCommandLineParser::File,
     "Xml definition of the probe", "Specifies the absolute path of the location of the xml definition file of the probe design.", us::Any(), true, false, false, mitkCommandLineParser::Input);
@@ -726,6 +730,10 @@ int main(int argc, char * argv[]) {
   {
     concurentThreadsSupported = us::any_cast<int>(parsedArgs["jobs"]);
   }
+  if (parsedArgs.count("seed"))
+  {
+    randomSeed = us::any_cast<int>(parsedArgs["seed"]);
+  }
   if (parsedArgs.count("probe-xml"))
   {
     std::string inputXmlProbeDesign = us::any_cast<std::string>(parsedArgs["probe-xml"]);
@@ -795,6 +803,9 @@ int main(int argc, char * argv[]) {
   if (simulatePVFC)
     threadHandler->SetPackageSize(1000);
 
+  if (randomSeed >= 0 && interpretAsTime)
+    std::cout << "Simulating on time basis. The seed is used per thread and the result will not be reproducible." << std::endl;
+
   if (verbose) std::cout << "\nStarting simulation ...\n" << std::endl;
 
   auto simulationStartTime = std::chrono::system_clock::now();
@@ -1039,16 +1050,31 @@ void runMonteCarlo(InputValues* inputValues, ReturnValues* returnValue, int thre
 
   /**** ======================== MAJOR CYCLE ============================ *****/
 
-  auto duration = std::chrono::system_clock::now().time_since_epoch();
-  returnValue->RandomGen(0, (std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() + thread) % 32000, nullptr); /* initiate with seed = 1, or any long integer. */
+  if (randomSeed < 0)
+  {
+    auto duration = std::chrono::system_clock::now().time_since_epoch();
+    returnValue->RandomGen(0, (std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() + thread) % 32000, nullptr); /* initiate with seed = 1, or any long integer. */
+  }
+  else if (interpretAsTime)
+  {
+    returnValue->RandomGen(0, mitk::pa::MonteCarloThreadHandler::GetWorkPackageSeed(randomSeed, -thread), nullptr);
+  }
   for (j = 0; j < inputValues->totalNumberOfVoxels; j++) returnValue->totalFluence[j] = 0; // ensure F[] starts empty.
 
   /**** RUN Launch N photons, initializing each one before progation. *****/
 
   long photonsToSimulate = 0;
+  long packageIndex = 0;
 
   do {
-    photonsToSimulate = threadHandler->GetNextWorkPackage();
+    photonsToSimulate = threadHandler->GetNextWorkPackage(packageIndex);
+    if (photonsToSimulate <= 0)
+      break;
+
+    /* Every package gets its own random stream, so the photons do not depend on which thread simulates them. */
+    if (randomSeed >= 0 && !interpretAsTime)
+      returnValue->RandomGen(0, mitk::pa::MonteCarloThreadHandler::GetWorkPackageSeed(randomSeed, packageIndex), nullptr);
+
     if (returnValue->detectorVoxel != nullptr)
     {
       photonsToSimulate = photonsToSimulate * returnValue->detectorVoxel->m_PhotonNormalizationValue;
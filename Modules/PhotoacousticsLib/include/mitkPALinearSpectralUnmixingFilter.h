@@ -92,6 +92,12 @@ namespace mitk {
       Eigen::VectorXf SpectralUnmixingAlgorithm(Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic> endmemberMatrix,
         Eigen::VectorXf inputVector) override;
 
+      /**
+      * \brief All Eigen solvers compute a (least squares) solution that depends linearly on the input vector, so the base class
+      * unmixes with one matrix for every algorithm.
+      */
+      bool IsLinearAlgorithm() const override;
+
     private:
       AlgortihmType algorithmName;
     };
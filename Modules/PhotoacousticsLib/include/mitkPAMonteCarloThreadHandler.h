@@ -15,6 +15,7 @@ found in the LICENSE file.
 
 #include <mitkCommon.h>
 #include <MitkPhotoacousticsLibExports.h>
+#include <atomic>
 #include <mutex>
 
 //Includes for smart pointer usage
@@ -38,6 +39,27 @@ namespace mitk {
 
       long GetNextWorkPackage();
 
+      /**
+       * @brief GetNextWorkPackage
+       * Same as GetNextWorkPackage(), but additionally returns the consecutive index of the package.
+       * When simulating a fixed number of photons, the n-th package always has the same index and size,
+       * regardless of the number of threads requesting packages. Simulations can use the index to seed
+       * their random number generator per package to get reproducible results.
+       * @param packageIndex is set to the index of the returned package
+       * @return the size of the package, 0 if there is nothing left to simulate
+       */
+      long GetNextWorkPackage(long& packageIndex);
+
+      /**
+       * @brief GetWorkPackageSeed
+       * Derives the seed of the random number generator for one work package from a user given seed.
+       * Uses the splitmix64 finalizer, so that neighbouring packages get uncorrelated seeds.
+       * @param seed the user given seed
+       * @param packageIndex the index returned by GetNextWorkPackage(long&)
+       * @return a seed in [1, 161803397], which is valid for the generator of mcxyz
+       */
+      static long GetWorkPackageSeed(long seed, long packageIndex);
+
       void SetPackageSize(long sizeInMilliseconsOrNumberOfPhotons);
 
       itkGetMacro(NumberPhotonsToSimulate, long);
@@ -55,6 +77,7 @@ namespace mitk {
       long m_Time;
       bool m_SimulateOnTimeBasis;
       bool m_Verbose;
+      std::atomic<long> m_NextWorkPackageIndex;
       std::mutex m_MutexRemainingPhotonsManipulation;
 
       /**
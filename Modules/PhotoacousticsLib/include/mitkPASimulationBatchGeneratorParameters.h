@@ -35,6 +35,8 @@ namespace mitk {
         itkSetMacro(YOffsetLowerThresholdInCentimeters, double);
         itkSetMacro(YOffsetUpperThresholdInCentimeters, double);
         itkSetMacro(YOffsetStepInCentimeters, double);
+        /** Seed passed to the simulation binary. The n-th simulation of the batch gets RandomSeed + n. -1 (default) lets the binary seed from the system time.*/
+        itkSetMacro(RandomSeed, long);
         itkGetMacro(VolumeIndex, unsigned int);
 
         itkGetMacro(NrrdFilePath, std::string);
@@ -46,6 +48,7 @@ namespace mitk {
         itkGetMacro(YOffsetLowerThresholdInCentimeters, double);
         itkGetMacro(YOffsetUpperThresholdInCentimeters, double);
         itkGetMacro(YOffsetStepInCentimeters, double);
+        itkGetMacro(RandomSeed, long);
 
     protected:
       SimulationBatchGeneratorParameters();
@@ -61,6 +64,7 @@ namespace mitk {
       double m_YOffsetLowerThresholdInCentimeters;
       double m_YOffsetUpperThresholdInCentimeters;
       double m_YOffsetStepInCentimeters;
+      long m_RandomSeed;
     };
   }
 }
@@ -44,6 +44,12 @@ namespace mitk {
     * sequences. Furthermore it is possible to creat an output image that contains the information about the relative error between unmixing result
     * and the input image.
     *
+    * Linear algorithms:
+    * If the subclass reports with IsLinearAlgorithm() that the unmixing result is a linear map of the input vector (e.g. the
+    * least squares solvers), the map is computed once as unmixing matrix from the endmember matrix and applied to all pixels of
+    * a sequence as one matrix product. The pixels of all sequences are split into blocks that are unmixed by several threads.
+    * Other algorithms are applied pixel by pixel.
+    *
     * Subclasses:
     * - mitkPASpectralUnmixingFilterVigra
     * - mitkPALinearSpectralUnmixingFilter (uses Eigen algorithms)
@@ -106,6 +112,12 @@ namespace mitk {
       */
       virtual void AddRelativeErrorSettings(int value);
 
+      /*
+      * \brief UseUnmixingMatrix activates the unmixing by one precomputed matrix for linear algorithms. Default value is true.
+      * @param useUnmixingMatrix is the boolian to activate the matrix unmixing; if false every pixel is unmixed by SpectralUnmixingAlgorithm
+      */
+      virtual void UseUnmixingMatrix(bool useUnmixingMatrix);
+
       ofstream myfile; // just for testing purposes; has to be removeed
 
     protected:
@@ -126,8 +138,15 @@ namespace mitk {
       virtual Eigen::VectorXf SpectralUnmixingAlgorithm(Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic> endmemberMatrix,
         Eigen::VectorXf inputVector) = 0;
 
+      /**
+      * \brief Subclasses return true if the result of SpectralUnmixingAlgorithm with the current settings depends linearly on the
+      * input vector, so that it can be replaced by the product of an unmixing matrix and the input vector. Default is false.
+      */
+      virtual bool IsLinearAlgorithm() const;
+
       bool m_Verbose = false;
       bool m_RelativeError = false;
+      bool m_UseUnmixingMatrix = true;
 
       std::vector<mitk::pa::PropertyCalculator::ChromophoreType> m_Chromophore;
       std::vector<int> m_Wavelength;
@@ -187,6 +206,25 @@ namespace mitk {
       float CalculateRelativeError(Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic> endmemberMatrix,
         Eigen::VectorXf inputVector, Eigen::VectorXf resultVector);
 
+      /*
+      * \brief Creates the matrix with number of chromophores rows and number of wavelengths columns that maps a multispectral pixel to
+      * the unmixing result. Column k is the result of "SpectralUnmixingAlgorithm" for the k-th unit vector, so the matrix factorisation
+      * of the algorithm is only done once per wavelength instead of once per pixel.
+      * @param endmemberMatrix is a Eigen matrix containing the endmember information
+      */
+      Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic> CalculateUnmixingMatrix(
+        const Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic>& endmemberMatrix);
+
+      /*
+      * \brief Unmixes all sequences with the unmixing matrix. The pixels are split into blocks which are distributed over
+      * the threads of an itk::MultiThreader, using the global default number of threads of ITK.
+      * @param inputDataArray the input image with all sequences
+      * @param outputBuffers the buffers of all outputs, including the relative error output if activated
+      */
+      void UnmixWithMatrix(const float* inputDataArray, const std::vector<float*>& outputBuffers, unsigned int pixelsPerImage,
+        unsigned int totalNumberOfSequences, const Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic>& endmemberMatrix,
+        const Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic>& unmixingMatrix);
+
       PropertyCalculator::Pointer m_PropertyCalculatorEigen;
     };
   }
@@ -95,6 +95,12 @@ namespace mitk {
       Eigen::VectorXf SpectralUnmixingAlgorithm(Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic> EndmemberMatrix,
         Eigen::VectorXf inputVector) override;
 
+      /**
+      * \brief WEIGHTED and LS are linear least squares solvers and can be applied as one unmixing matrix. LARS and GOLDFARB are
+      * constrained to nonnegative results and are solved pixel by pixel.
+      */
+      bool IsLinearAlgorithm() const override;
+
     private:
       std::vector<double> weightsvec;
       SpectralUnmixingFilterVigra::VigraAlgortihmType algorithmName;
@@ -50,13 +50,18 @@ std::string mitk::pa::SimulationBatchGenerator::CreateBatchSimulationString(
   std::string outputFolderName = GetOutputFolderName(parameters);
   std::string savePath = outputFolderName + ".nrrd";
   std::stringstream batchstring;
+  long simulationIndex = 0;
   for (double d = parameters->GetYOffsetLowerThresholdInCentimeters();
     d <= parameters->GetYOffsetUpperThresholdInCentimeters() + 1e-5;
     d += parameters->GetYOffsetStepInCentimeters())
   {
     batchstring << parameters->GetBinaryPath() << " -p PROBE_DESIGN.xml -i " << savePath << " -o " << outputFolderName << "/"
       << parameters->GetTissueName() << GetVolumeNumber(parameters) << "_yo" << round(d * 100) / 100 << ".nrrd" << " -yo " << round(d * 100) / 100 << " -n "
-      << parameters->GetNumberOfPhotons() << "\n";
+      << parameters->GetNumberOfPhotons();
+    if (parameters->GetRandomSeed() >= 0)
+      batchstring << " -s " << parameters->GetRandomSeed() + simulationIndex;
+    batchstring << "\n";
+    ++simulationIndex;
   }
   return batchstring.str();
 }
@@ -22,6 +22,7 @@ mitk::pa::SimulationBatchGeneratorParameters::SimulationBatchGeneratorParameters
   m_YOffsetLowerThresholdInCentimeters = 0;
   m_YOffsetUpperThresholdInCentimeters = 0;
   m_YOffsetStepInCentimeters = 0;
+  m_RandomSeed = -1;
 }
 
 mitk::pa::SimulationBatchGeneratorParameters::~SimulationBatchGeneratorParameters()
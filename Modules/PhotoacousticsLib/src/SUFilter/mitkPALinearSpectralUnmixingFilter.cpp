@@ -32,6 +32,11 @@ void mitk::pa::LinearSpectralUnmixingFilter::SetAlgorithm(mitk::pa::LinearSpectr
   algorithmName = inputAlgorithmName;
 }
 
+bool mitk::pa::LinearSpectralUnmixingFilter::IsLinearAlgorithm() const
+{
+  return true;
+}
+
 Eigen::VectorXf mitk::pa::LinearSpectralUnmixingFilter::SpectralUnmixingAlgorithm(
   Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic> endmemberMatrix, Eigen::VectorXf inputVector)
 {
@@ -20,6 +20,55 @@ found in the LICENSE file.
 #include <mitkImageReadAccessor.h>
 #include <mitkImageWriteAccessor.h>
 
+#include <itkMultiThreader.h>
+
+#include <algorithm>
+#include <atomic>
+
+namespace
+{
+  template <typename TFunction>
+  struct ParallelForEachItemData
+  {
+    const TFunction *Function;
+    std::size_t ItemCount;
+    std::atomic<std::size_t> NextItem;
+  };
+
+  template <typename TFunction>
+  ITK_THREAD_RETURN_TYPE ParallelForEachItemCallback(void *arg)
+  {
+    auto *infoStruct = static_cast<itk::MultiThreader::ThreadInfoStruct *>(arg);
+    auto *data = static_cast<ParallelForEachItemData<TFunction> *>(infoStruct->UserData);
+    for (std::size_t item = data->NextItem++; item < data->ItemCount; item = data->NextItem++)
+    {
+      (*data->Function)(infoStruct->ThreadID, item);
+    }
+    return ITK_THREAD_RETURN_VALUE;
+  }
+
+  /** Calls func(threadID, item) for every item in [0, itemCount) with the threads of an itk::MultiThreader. The items
+   * are distributed dynamically over the threads; threadID is always smaller than the passed numberOfThreads.*/
+  template <typename TFunction>
+  void ParallelForEachItem(unsigned int numberOfThreads, std::size_t itemCount, const TFunction &func)
+  {
+    if (itemCount == 0)
+    {
+      return;
+    }
+
+    ParallelForEachItemData<TFunction> data;
+    data.Function = &func;
+    data.ItemCount = itemCount;
+    data.NextItem = 0;
+
+    itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+    threader->SetNumberOfThreads(static_cast<itk::ThreadIdType>(std::max<std::size_t>(1, std::min<std::size_t>(numberOfThreads, itemCount))));
+    threader->SetSingleMethod(ParallelForEachItemCallback<TFunction>, &data);
+    threader->SingleMethodExecute();
+  }
+}
+
 mitk::pa::SpectralUnmixingFilterBase::SpectralUnmixingFilterBase()
 {
   m_PropertyCalculatorEigen = mitk::pa::PropertyCalculator::New();
@@ -64,6 +113,16 @@ void mitk::pa::SpectralUnmixingFilterBase::AddRelativeErrorSettings(int value)
   m_RelativeErrorSettings.push_back(value);
 }
 
+void mitk::pa::SpectralUnmixingFilterBase::UseUnmixingMatrix(bool useUnmixingMatrix)
+{
+  m_UseUnmixingMatrix = useUnmixingMatrix;
+}
+
+bool mitk::pa::SpectralUnmixingFilterBase::IsLinearAlgorithm() const
+{
+  return false;
+}
+
 void mitk::pa::SpectralUnmixingFilterBase::GenerateData()
 {
   MITK_INFO(m_Verbose) << "GENERATING DATA..";
@@ -110,38 +169,46 @@ void mitk::pa::SpectralUnmixingFilterBase::GenerateData()
     outputCounter -= 1;
   }
 
-  for (unsigned int sequenceCounter = 0; sequenceCounter < totalNumberOfSequences; ++sequenceCounter)
+  if (m_UseUnmixingMatrix && IsLinearAlgorithm())
   {
-    MITK_INFO(m_Verbose) << "SequenceCounter: " << sequenceCounter;
-    //loop over every pixel in XY-plane
-    for (unsigned int x = 0; x < xDim; x++)
+    auto unmixingMatrix = CalculateUnmixingMatrix(endmemberMatrix);
+    UnmixWithMatrix(inputDataArray, writteBufferVector, xDim*yDim, totalNumberOfSequences, endmemberMatrix, unmixingMatrix);
+  }
+  else
+  {
+    for (unsigned int sequenceCounter = 0; sequenceCounter < totalNumberOfSequences; ++sequenceCounter)
     {
-      for (unsigned int y = 0; y < yDim; y++)
+      MITK_INFO(m_Verbose) << "SequenceCounter: " << sequenceCounter;
+      //loop over every pixel in XY-plane
+      for (unsigned int x = 0; x < xDim; x++)
       {
-        Eigen::VectorXf inputVector(sequenceSize);
-        for (unsigned int z = 0; z < sequenceSize; z++)
+        for (unsigned int y = 0; y < yDim; y++)
         {
-          /**
-          * 'sequenceCounter*sequenceSize' has to be added to 'z' to ensure that one accesses the
-          * correct pixel, because the inputDataArray contains the information of all sequences and
-          * not just the one of the current sequence.
-          */
-          unsigned int pixelNumber = (xDim*yDim*(z+sequenceCounter*sequenceSize)) + x * yDim + y;
-          auto pixel = inputDataArray[pixelNumber];
-
-          inputVector[z] = pixel;
-        }
-        Eigen::VectorXf resultVector = SpectralUnmixingAlgorithm(endmemberMatrix, inputVector);
-
-        if (m_RelativeError == true)
-        {
-          float relativeError = CalculateRelativeError(endmemberMatrix, inputVector, resultVector);
-          writteBufferVector[outputCounter][(xDim*yDim * sequenceCounter) + x * yDim + y] = relativeError;
-        }
-
-        for (unsigned int outputIdx = 0; outputIdx < outputCounter; ++outputIdx)
-        {
-          writteBufferVector[outputIdx][(xDim*yDim * sequenceCounter) + x * yDim + y] = resultVector[outputIdx];
+          Eigen::VectorXf inputVector(sequenceSize);
+          for (unsigned int z = 0; z < sequenceSize; z++)
+          {
+            /**
+            * 'sequenceCounter*sequenceSize' has to be added to 'z' to ensure that one accesses the
+            * correct pixel, because the inputDataArray contains the information of all sequences and
+            * not just the one of the current sequence.
+            */
+            unsigned int pixelNumber = (xDim*yDim*(z+sequenceCounter*sequenceSize)) + x * yDim + y;
+            auto pixel = inputDataArray[pixelNumber];
+
+            inputVector[z] = pixel;
+          }
+          Eigen::VectorXf resultVector = SpectralUnmixingAlgorithm(endmemberMatrix, inputVector);
+
+          if (m_RelativeError == true)
+          {
+            float relativeError = CalculateRelativeError(endmemberMatrix, inputVector, resultVector);
+            writteBufferVector[outputCounter][(xDim*yDim * sequenceCounter) + x * yDim + y] = relativeError;
+          }
+
+          for (unsigned int outputIdx = 0; outputIdx < outputCounter; ++outputIdx)
+          {
+            writteBufferVector[outputIdx][(xDim*yDim * sequenceCounter) + x * yDim + y] = resultVector[outputIdx];
+          }
         }
       }
     }
@@ -233,3 +300,68 @@ float mitk::pa::SpectralUnmixingFilterBase::CalculateRelativeError(Eigen::Matrix
   }
   return relativeError;
 }
+
+
+Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic> mitk::pa::SpectralUnmixingFilterBase::CalculateUnmixingMatrix(
+  const Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic>& endmemberMatrix)
+{
+  unsigned int numberOfChromophores = endmemberMatrix.cols();
+  unsigned int numberOfWavelengths = endmemberMatrix.rows();
+  Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic> unmixingMatrix(numberOfChromophores, numberOfWavelengths);
+
+  for (unsigned int k = 0; k < numberOfWavelengths; ++k)
+  {
+    Eigen::VectorXf unitVector = Eigen::VectorXf::Unit(numberOfWavelengths, k);
+    unmixingMatrix.col(k) = SpectralUnmixingAlgorithm(endmemberMatrix, unitVector);
+  }
+  MITK_INFO(m_Verbose) << "GENERATING UNMIXING MATRIX [DONE]";
+  return unmixingMatrix;
+}
+
+void mitk::pa::SpectralUnmixingFilterBase::UnmixWithMatrix(const float* inputDataArray, const std::vector<float*>& outputBuffers,
+  unsigned int pixelsPerImage, unsigned int totalNumberOfSequences, const Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic>& endmemberMatrix,
+  const Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic>& unmixingMatrix)
+{
+  typedef Eigen::Map<const Eigen::MatrixXf, 0, Eigen::OuterStride<>> InputBlockType;
+
+  const unsigned int numberOfChromophores = unmixingMatrix.rows();
+  const unsigned int sequenceSize = unmixingMatrix.cols();
+
+  // a block of a sequence is unmixed by one matrix product; the blocks are small enough to be distributed over all threads
+  const unsigned int blockSize = 16384;
+  const unsigned int blocksPerImage = (pixelsPerImage + blockSize - 1) / blockSize;
+  const unsigned int numberOfBlocks = blocksPerImage * totalNumberOfSequences;
+
+  const unsigned int numberOfThreads = std::max(1u, std::min(itk::MultiThreader::GetGlobalDefaultNumberOfThreads(), numberOfBlocks));
+  MITK_INFO(m_Verbose) << "Unmixing " << numberOfBlocks << " blocks with " << numberOfThreads << " threads";
+
+  // every thread keeps its result block, so it is only allocated once
+  std::vector<Eigen::MatrixXf> resultBlocks(numberOfThreads);
+  ParallelForEachItem(numberOfThreads, numberOfBlocks, [&](unsigned int threadID, std::size_t block)
+  {
+    Eigen::MatrixXf& resultBlock = resultBlocks[threadID];
+    const unsigned int sequenceCounter = static_cast<unsigned int>(block / blocksPerImage);
+    const unsigned int firstPixel = static_cast<unsigned int>(block % blocksPerImage) * blockSize;
+    const unsigned int numberOfPixels = std::min(blockSize, pixelsPerImage - firstPixel);
+
+    // the images of the wavelengths of one sequence are the columns of the block
+    InputBlockType inputBlock(inputDataArray + (std::size_t)pixelsPerImage * sequenceCounter * sequenceSize + firstPixel,
+      numberOfPixels, sequenceSize, Eigen::OuterStride<>(pixelsPerImage));
+    resultBlock.noalias() = inputBlock * unmixingMatrix.transpose();
+
+    const std::size_t outputOffset = (std::size_t)pixelsPerImage * sequenceCounter + firstPixel;
+    for (unsigned int outputIdx = 0; outputIdx < numberOfChromophores; ++outputIdx)
+    {
+      Eigen::Map<Eigen::VectorXf>(outputBuffers[outputIdx] + outputOffset, numberOfPixels) = resultBlock.col(outputIdx);
+    }
+
+    if (m_RelativeError == true)
+    {
+      for (unsigned int pixel = 0; pixel < numberOfPixels; ++pixel)
+      {
+        outputBuffers[numberOfChromophores][outputOffset + pixel] = CalculateRelativeError(endmemberMatrix,
+          inputBlock.row(pixel).transpose(), resultBlock.row(pixel).transpose());
+      }
+    }
+  });
+}
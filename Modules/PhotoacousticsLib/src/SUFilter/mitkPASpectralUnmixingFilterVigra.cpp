@@ -40,6 +40,12 @@ void mitk::pa::SpectralUnmixingFilterVigra::AddWeight(unsigned int weight)
   weightsvec.push_back(value);
 }
 
+bool mitk::pa::SpectralUnmixingFilterVigra::IsLinearAlgorithm() const
+{
+  return mitk::pa::SpectralUnmixingFilterVigra::VigraAlgortihmType::WEIGHTED == algorithmName ||
+    mitk::pa::SpectralUnmixingFilterVigra::VigraAlgortihmType::LS == algorithmName;
+}
+
 Eigen::VectorXf mitk::pa::SpectralUnmixingFilterVigra::SpectralUnmixingAlgorithm(
   Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic> endmemberMatrix, Eigen::VectorXf inputVector)
 {
@@ -25,6 +25,7 @@ mitk::pa::MonteCarloThreadHandler::MonteCarloThreadHandler(long timInMillisecond
   m_Time = 0;
   m_NumberPhotonsToSimulate = 0;
   m_NumberPhotonsRemaining = 0;
+  m_NextWorkPackageIndex = 0;
 
   if (m_SimulateOnTimeBasis)
   {
@@ -43,14 +44,22 @@ mitk::pa::MonteCarloThreadHandler::~MonteCarloThreadHandler()
 }
 
 long mitk::pa::MonteCarloThreadHandler::GetNextWorkPackage()
+{
+  long packageIndex;
+  return GetNextWorkPackage(packageIndex);
+}
+
+long mitk::pa::MonteCarloThreadHandler::GetNextWorkPackage(long& packageIndex)
 {
   long workPackageSize = 0;
+  packageIndex = -1;
   if (m_SimulateOnTimeBasis)
   {
     long now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
     if (now - m_Time <= m_SimulationTime)
     {
       workPackageSize = m_WorkPackageSize;
+      packageIndex = m_NextWorkPackageIndex++;
       if (m_Verbose)
       {
         std::cout << "<filter-progress-text progress='" << ((double)(now - m_Time) / m_SimulationTime) << "'></filter-progress-text>" << std::endl;
@@ -71,6 +80,8 @@ long mitk::pa::MonteCarloThreadHandler::GetNextWorkPackage()
     }
 
     m_NumberPhotonsRemaining -= workPackageSize;
+    if (workPackageSize > 0)
+      packageIndex = m_NextWorkPackageIndex++;
     m_MutexRemainingPhotonsManipulation.unlock();
 
     if (m_Verbose)
@@ -82,6 +93,15 @@ long mitk::pa::MonteCarloThreadHandler::GetNextWorkPackage()
   return workPackageSize;
 }
 
+long mitk::pa::MonteCarloThreadHandler::GetWorkPackageSeed(long seed, long packageIndex)
+{
+  unsigned long long z = (unsigned long long)seed * 0x9E3779B97F4A7C15ULL + (unsigned long long)packageIndex + 1;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  z = z ^ (z >> 31);
+  return (long)(z % 161803397ULL) + 1;
+}
+
 void mitk::pa::MonteCarloThreadHandler::SetPackageSize(long sizeInMilliseconsOrNumberOfPhotons)
 {
   m_WorkPackageSize = sizeInMilliseconsOrNumberOfPhotons;
@@ -29,6 +29,7 @@ set(MODULE_TESTS
   # mitkSpectralUnmixingTest.cpp (See T27024)
   mitkPhotoacousticVesselMeanderStrategyTest.cpp
   mitkPhotoacousticVesselTest.cpp
+  mitkMCSeedTest.cpp
 )
 
 set(RESOURCE_FILES
@@ -0,0 +1,162 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+#include <mitkPAMonteCarloThreadHandler.h>
+
+#include <cmath>
+#include <random>
+#include <thread>
+#include <vector>
+
+/**
+ * Runs a small absorbing and isotropically scattering random walk the same way MCxyz schedules its photons:
+ * every thread requests work packages, reseeds its generator per package and accumulates into its own fluence grid.
+ */
+class MonteCarloSeedTestSimulation
+{
+public:
+  static const int Dimension = 6;
+
+  static void RunThread(mitk::pa::MonteCarloThreadHandler::Pointer threadHandler, long seed, std::vector<double>* fluence)
+  {
+    fluence->assign(Dimension * Dimension * Dimension, 0);
+    std::mt19937 generator;
+    auto random = [&generator]() { return (generator() + 0.5) / 4294967296.0; };
+
+    long packageIndex = 0;
+    long photonsToSimulate = 0;
+    while ((photonsToSimulate = threadHandler->GetNextWorkPackage(packageIndex)) > 0)
+    {
+      generator.seed(mitk::pa::MonteCarloThreadHandler::GetWorkPackageSeed(seed, packageIndex));
+      for (long photon = 0; photon < photonsToSimulate; ++photon)
+      {
+        double x = Dimension / 2.0, y = Dimension / 2.0, z = 0;
+        double ux = 0, uy = 0, uz = 1;
+        double weight = 1;
+        while (weight > 0)
+        {
+          const double step = -std::log(random());
+          x += step * ux;
+          y += step * uy;
+          z += step * uz;
+          if (x < 0 || y < 0 || z < 0 || x >= Dimension || y >= Dimension || z >= Dimension)
+            break;
+
+          const int index = (int)x + Dimension * ((int)y + Dimension * (int)z);
+          const double absorbed = weight * 0.1;
+          (*fluence)[index] += absorbed;
+          weight -= absorbed;
+
+          const double cosTheta = 2 * random() - 1;
+          const double sinTheta = std::sqrt(1 - cosTheta * cosTheta);
+          const double phi = 2 * 3.14159265358979 * random();
+          ux = sinTheta * std::cos(phi);
+          uy = sinTheta * std::sin(phi);
+          uz = cosTheta;
+
+          if (weight < 0.01)
+            weight = (random() <= 0.1) ? weight / 0.1 : 0;
+        }
+      }
+    }
+  }
+
+  static std::vector<double> Run(int numberOfThreads, long seed, long numberOfPhotons)
+  {
+    auto threadHandler = mitk::pa::MonteCarloThreadHandler::New(numberOfPhotons, false, false);
+    threadHandler->SetPackageSize(100);
+
+    std::vector<std::vector<double>> threadFluences(numberOfThreads);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < numberOfThreads; ++i)
+      threads.push_back(std::thread(RunThread, threadHandler, seed, &threadFluences[i]));
+    for (auto& thread : threads)
+      thread.join();
+
+    std::vector<double> fluence(Dimension * Dimension * Dimension, 0);
+    for (const auto& threadFluence : threadFluences)
+      for (std::size_t i = 0; i < fluence.size(); ++i)
+        fluence[i] += threadFluence[i];
+    return fluence;
+  }
+};
+
+class mitkMCSeedTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkMCSeedTestSuite);
+  MITK_TEST(testWorkPackageSeedsAreValid);
+  MITK_TEST(testSameSeedGivesSameFluenceForDifferentNumberOfThreads);
+  MITK_TEST(testDifferentSeedsGiveDifferentFluence);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+
+  long m_NumberOfPhotons = 5050;
+
+public:
+
+  void setUp() override
+  {
+  }
+
+  void testWorkPackageSeedsAreValid()
+  {
+    for (long seed : { 0L, 1L, 4711L })
+    {
+      for (long packageIndex = -8; packageIndex < 1000; ++packageIndex)
+      {
+        long packageSeed = mitk::pa::MonteCarloThreadHandler::GetWorkPackageSeed(seed, packageIndex);
+        CPPUNIT_ASSERT(packageSeed >= 1 && packageSeed <= 161803397);
+        CPPUNIT_ASSERT_EQUAL(packageSeed, mitk::pa::MonteCarloThreadHandler::GetWorkPackageSeed(seed, packageIndex));
+      }
+    }
+    CPPUNIT_ASSERT(mitk::pa::MonteCarloThreadHandler::GetWorkPackageSeed(1, 0) != mitk::pa::MonteCarloThreadHandler::GetWorkPackageSeed(1, 1));
+    CPPUNIT_ASSERT(mitk::pa::MonteCarloThreadHandler::GetWorkPackageSeed(1, 0) != mitk::pa::MonteCarloThreadHandler::GetWorkPackageSeed(2, 0));
+  }
+
+  void testSameSeedGivesSameFluenceForDifferentNumberOfThreads()
+  {
+    auto expected = MonteCarloSeedTestSimulation::Run(1, 42, m_NumberOfPhotons);
+    double totalFluence = 0;
+    for (double value : expected)
+      totalFluence += value;
+    CPPUNIT_ASSERT_MESSAGE("Testing if the photons deposit energy", totalFluence > 0);
+
+    for (int numberOfThreads : { 2, 3, 8 })
+    {
+      auto actual = MonteCarloSeedTestSimulation::Run(numberOfThreads, 42, m_NumberOfPhotons);
+      CPPUNIT_ASSERT_EQUAL(expected.size(), actual.size());
+      // Only the summation order of the thread grids depends on the number of threads
+      for (std::size_t i = 0; i < expected.size(); ++i)
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(expected[i], actual[i], 1e-12 * (1 + expected[i]));
+    }
+  }
+
+  void testDifferentSeedsGiveDifferentFluence()
+  {
+    auto fluence1 = MonteCarloSeedTestSimulation::Run(2, 42, m_NumberOfPhotons);
+    auto fluence2 = MonteCarloSeedTestSimulation::Run(2, 43, m_NumberOfPhotons);
+    double difference = 0;
+    for (std::size_t i = 0; i < fluence1.size(); ++i)
+      difference += std::abs(fluence1[i] - fluence2[i]);
+    CPPUNIT_ASSERT(difference > 1e-6);
+  }
+
+  void tearDown() override
+  {
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkMCSeed)
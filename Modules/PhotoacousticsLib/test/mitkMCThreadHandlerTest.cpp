@@ -32,6 +32,7 @@ class mitkMCThreadHandlerTestSuite : public mitk::TestFixture
   MITK_TEST(testCorrectNumberOfPhotons);
   MITK_TEST(testCorrectNumberOfPhotonsWithUnevenPackageSize);
   MITK_TEST(testCorrectNumberOfPhotonsWithTooLargePackageSize);
+  MITK_TEST(testPackageIndicesAreConsecutive);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -92,6 +93,21 @@ public:
     CPPUNIT_ASSERT(numberOfPhotonsSimulated == m_NumberOrTime);
   }
 
+  void testPackageIndicesAreConsecutive()
+  {
+    m_MonteCarloThreadHandler = mitk::pa::MonteCarloThreadHandler::New(m_NumberOrTime, false, false);
+    m_MonteCarloThreadHandler->SetPackageSize(77);
+    long expectedPackageIndex = 0;
+    long packageIndex = 0;
+    while (m_MonteCarloThreadHandler->GetNextWorkPackage(packageIndex) > 0)
+    {
+      CPPUNIT_ASSERT_EQUAL(expectedPackageIndex, packageIndex);
+      ++expectedPackageIndex;
+    }
+    CPPUNIT_ASSERT_EQUAL(-1L, packageIndex);
+    CPPUNIT_ASSERT_EQUAL(7L, expectedPackageIndex);
+  }
+
   void tearDown() override
   {
     m_MonteCarloThreadHandler = nullptr;
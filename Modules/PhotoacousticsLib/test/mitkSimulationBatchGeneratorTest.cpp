@@ -21,6 +21,7 @@ class mitkSimulationBatchGeneratorTestSuite : public mitk::TestFixture
   CPPUNIT_TEST_SUITE(mitkSimulationBatchGeneratorTestSuite);
   MITK_TEST(testGenerateBatchFileString);
   MITK_TEST(testGenerateBatchFileAndSaveFile);
+  MITK_TEST(testGenerateBatchFileStringWithSeed);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -67,6 +68,18 @@ public:
     CPPUNIT_ASSERT(!batchGenerationString.empty());
   }
 
+  void testGenerateBatchFileStringWithSeed()
+  {
+    std::string batchGenerationString = mitk::pa::SimulationBatchGenerator::CreateBatchSimulationString(m_Parameters);
+    CPPUNIT_ASSERT(batchGenerationString.find(" -s ") == std::string::npos);
+
+    m_Parameters->SetRandomSeed(5);
+    batchGenerationString = mitk::pa::SimulationBatchGenerator::CreateBatchSimulationString(m_Parameters);
+    CPPUNIT_ASSERT(batchGenerationString.find(" -s 5\n") != std::string::npos);
+    CPPUNIT_ASSERT(batchGenerationString.find(" -s 9\n") != std::string::npos);
+    CPPUNIT_ASSERT(batchGenerationString.find(" -s 10\n") == std::string::npos);
+  }
+
   void testGenerateBatchFileAndSaveFile()
   {
     mitk::pa::SimulationBatchGenerator::WriteBatchFileAndSaveTissueVolume(m_Parameters, m_Test3DVolume->AsMitkImage());
@@ -33,6 +33,7 @@ class mitkSpectralUnmixingTestSuite : public mitk::TestFixture
   MITK_TEST(testAddOutput);
   MITK_TEST(testWeightsError);
   MITK_TEST(testOutputs);
+  MITK_TEST(testUnmixingMatrixEqualsPixelwiseUnmixing);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -634,6 +635,62 @@ public:
     }
   }
 
+  std::vector<mitk::Image::Pointer> UnmixLargeImage(mitk::Image::Pointer image, bool useUnmixingMatrix)
+  {
+    auto m_SpectralUnmixingFilter = mitk::pa::LinearSpectralUnmixingFilter::New();
+    m_SpectralUnmixingFilter->Verbose(false);
+    m_SpectralUnmixingFilter->RelativeError(false);
+    m_SpectralUnmixingFilter->UseUnmixingMatrix(useUnmixingMatrix);
+    m_SpectralUnmixingFilter->SetInput(image);
+    m_SpectralUnmixingFilter->AddOutputs(2);
+
+    for (unsigned int imageIndex = 0; imageIndex < m_inputWavelengths.size(); imageIndex++)
+      m_SpectralUnmixingFilter->AddWavelength(m_inputWavelengths[imageIndex]);
+
+    m_SpectralUnmixingFilter->AddChromophore(
+      mitk::pa::PropertyCalculator::ChromophoreType::OXYGENATED);
+    m_SpectralUnmixingFilter->AddChromophore(
+      mitk::pa::PropertyCalculator::ChromophoreType::DEOXYGENATED);
+
+    m_SpectralUnmixingFilter->SetAlgorithm(mitk::pa::LinearSpectralUnmixingFilter::AlgortihmType::COLPIVHOUSEHOLDERQR);
+    m_SpectralUnmixingFilter->Update();
+
+    return { m_SpectralUnmixingFilter->GetOutput(0), m_SpectralUnmixingFilter->GetOutput(1) };
+  }
+
+  // Tests that unmixing with the precomputed matrix of a linear algorithm gives the pixelwise results
+  void testUnmixingMatrixEqualsPixelwiseUnmixing()
+  {
+    MITK_INFO << "START UNMIXING MATRIX TEST ... ";
+    // Three sequences of two wavelengths, large enough for several blocks
+    unsigned int dimensions[3] = { 150, 120, 6 };
+    unsigned int numberOfPixels = dimensions[0] * dimensions[1] * dimensions[2];
+    std::vector<float> data(numberOfPixels);
+    for (unsigned int i = 0; i < numberOfPixels; ++i)
+      data[i] = (float)((i * 7919) % 1000) + 1;
+
+    mitk::Image::Pointer image = mitk::Image::New();
+    image->Initialize(mitk::MakeScalarPixelType<float>(), 3, dimensions);
+    image->SetImportVolume(data.data(), mitk::Image::ImportMemoryManagementType::CopyMemory);
+
+    auto matrixResults = UnmixLargeImage(image, true);
+    auto pixelwiseResults = UnmixLargeImage(image, false);
+
+    for (int outputIdx = 0; outputIdx < 2; ++outputIdx)
+    {
+      CPPUNIT_ASSERT(3 == matrixResults[outputIdx]->GetDimensions()[2]);
+
+      mitk::ImageReadAccessor matrixAccess(matrixResults[outputIdx]);
+      mitk::ImageReadAccessor pixelwiseAccess(pixelwiseResults[outputIdx]);
+      const float* matrixData = (const float*)matrixAccess.GetData();
+      const float* pixelwiseData = (const float*)pixelwiseAccess.GetData();
+
+      for (unsigned int i = 0; i < dimensions[0] * dimensions[1] * 3; ++i)
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(pixelwiseData[i], matrixData[i], 1e-4 * (std::abs(pixelwiseData[i]) + 1));
+    }
+    MITK_INFO << "UNMIXING MATRIX TEST SUCCESFULL :)";
+  }
+
   // TEST TEMPLATE:
   /*
   // Test exceptions for
@@ -10,6 +10,7 @@ set(MODULE_TESTS
   mitkToFImageWriterTest.cpp
   mitkToFNrrdImageWriterTest.cpp
   mitkToFOpenCVImageGrabberTest.cpp
+  mitkToFPlayerProcessingBenchmarkTest.cpp
 )
 
 set(MODULE_CUSTOM_TESTS
@@ -0,0 +1,113 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <mitkTestingMacros.h>
+#include <mitkTestFixture.h>
+
+#include <mitkToFImageGrabber.h>
+#include <mitkToFCameraMITKPlayerDevice.h>
+#include <mitkToFCompositeFilter.h>
+#include <mitkToFDistanceImageToSurfaceFilter.h>
+#include <mitkToFConfig.h>
+
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+
+#include <chrono>
+
+/**
+ * @brief Replays a recorded Kinect distance image with the MITK player and measures the ToF processing chain
+ * (composite filter and distance image to surface conversion) per frame.
+ *
+ * The times are only reported, because they depend on the machine. The test checks that every replayed frame
+ * results in a new surface with the same number of points.
+ */
+class mitkToFPlayerProcessingBenchmarkTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkToFPlayerProcessingBenchmarkTestSuite);
+  MITK_TEST(Replay_KinectData_EveryFrameIsProcessed);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+
+  mitk::ToFImageGrabber::Pointer m_ToFImageGrabber;
+  unsigned int m_NumberOfFrames = 50;
+
+public:
+
+  void setUp() override
+  {
+    std::string dirName = MITK_TOF_DATA_DIR;
+    m_ToFImageGrabber = mitk::ToFImageGrabber::New();
+    m_ToFImageGrabber->SetCameraDevice(mitk::ToFCameraMITKPlayerDevice::New());
+    m_ToFImageGrabber->SetProperty("DistanceImageFileName",
+      mitk::StringProperty::New(GetTestDataFilePath(dirName + "/Kinect_Lego_Phantom_DistanceImage.nrrd")));
+    m_ToFImageGrabber->ConnectCamera();
+    m_ToFImageGrabber->StartCamera();
+  }
+
+  void tearDown() override
+  {
+    if(m_ToFImageGrabber->IsCameraActive())
+    {
+      m_ToFImageGrabber->StopCamera();
+      m_ToFImageGrabber->DisconnectCamera();
+    }
+    m_ToFImageGrabber = nullptr;
+  }
+
+  void Replay_KinectData_EveryFrameIsProcessed()
+  {
+    mitk::ToFCompositeFilter::Pointer compositeFilter = mitk::ToFCompositeFilter::New();
+    compositeFilter->SetInput(m_ToFImageGrabber->GetOutput());
+    compositeFilter->SetApplyTemporalMedianFilter(true);
+    compositeFilter->SetApplyBilateralFilter(true);
+
+    mitk::ToFDistanceImageToSurfaceFilter::Pointer surfaceFilter = mitk::ToFDistanceImageToSurfaceFilter::New();
+    surfaceFilter->SetInput(compositeFilter->GetOutput());
+    surfaceFilter->SetReconstructionMode(mitk::ToFDistanceImageToSurfaceFilter::Kinect);
+
+    double compositeFilterTime = 0;
+    double surfaceFilterTime = 0;
+    vtkIdType numberOfPoints = -1;
+    vtkSmartPointer<vtkPolyData> lastPolyData;
+    for (unsigned int frame = 0; frame < m_NumberOfFrames; ++frame)
+    {
+      m_ToFImageGrabber->Modified();
+      m_ToFImageGrabber->Update();
+
+      auto startTime = std::chrono::steady_clock::now();
+      compositeFilter->Update();
+      auto compositeTime = std::chrono::steady_clock::now();
+      surfaceFilter->Update();
+      auto stopTime = std::chrono::steady_clock::now();
+      compositeFilterTime += std::chrono::duration<double, std::milli>(compositeTime - startTime).count();
+      surfaceFilterTime += std::chrono::duration<double, std::milli>(stopTime - compositeTime).count();
+
+      vtkPolyData* polyData = surfaceFilter->GetOutput()->GetVtkPolyData();
+      CPPUNIT_ASSERT_MESSAGE("Every frame should produce a new surface.", polyData != nullptr && polyData != lastPolyData.GetPointer());
+      CPPUNIT_ASSERT(polyData->GetNumberOfPoints() > 0);
+      if (frame > 0)
+      {
+        CPPUNIT_ASSERT_EQUAL_MESSAGE("The replayed frame should always give the same number of points.", numberOfPoints, polyData->GetNumberOfPoints());
+      }
+      numberOfPoints = polyData->GetNumberOfPoints();
+      lastPolyData = polyData;
+    }
+
+    MITK_INFO << "ToF player replay of " << m_NumberOfFrames << " frames: composite filter "
+              << compositeFilterTime / m_NumberOfFrames << " ms/frame, distance image to surface "
+              << surfaceFilterTime / m_NumberOfFrames << " ms/frame";
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkToFPlayerProcessingBenchmark)
@@ -3,6 +3,7 @@ set(MODULE_TESTS
   mitkToFDistanceImageToSurfaceFilterTest.cpp
   mitkToFCompositeFilterTest.cpp
   mitkToFProcessingCommonTest.cpp
+  mitkToFRayDirectionTableTest.cpp
 )
 
 set(MODULE_CUSTOM_TESTS
@@ -375,6 +375,27 @@ int mitkToFDistanceImageToSurfaceFilterTest(int /* argc */, char* /*argv*/[])
   }
   MITK_TEST_CONDITION_REQUIRED(compareToInput,"Testing backward transformation compared to original image with interpixeldistance");
 
+  //A surface that was handed out must not change when the following frames are processed
+  vtkSmartPointer<vtkPolyData> keptPolyData = filter->GetOutput()->GetVtkPolyData();
+  vtkSmartPointer<vtkPoints> keptPoints = vtkSmartPointer<vtkPoints>::New();
+  keptPoints->DeepCopy(keptPolyData->GetPoints());
+  vtkIdType keptNumberOfPolys = keptPolyData->GetNumberOfPolys();
+  for (int frame = 0; frame < 3; frame++)
+  {
+    filter->SetInput(mitk::ImageGenerator::GenerateRandomImage<float>(dimX,dimY));
+    filter->Update();
+    MITK_TEST_CONDITION_REQUIRED(filter->GetOutput()->GetVtkPolyData() != keptPolyData.GetPointer(),"Testing if every frame gets a new surface");
+  }
+  bool keptSurfaceUnchanged = keptPolyData->GetNumberOfPoints() == keptPoints->GetNumberOfPoints()
+    && keptPolyData->GetNumberOfPolys() == keptNumberOfPolys;
+  for (vtkIdType i = 0; keptSurfaceUnchanged && i < keptPoints->GetNumberOfPoints(); i++)
+  {
+    double* keptPoint = keptPoints->GetPoint(i);
+    double* surfacePoint = keptPolyData->GetPoint(i);
+    keptSurfaceUnchanged = keptPoint[0] == surfacePoint[0] && keptPoint[1] == surfacePoint[1] && keptPoint[2] == surfacePoint[2];
+  }
+  MITK_TEST_CONDITION_REQUIRED(keptSurfaceUnchanged,"Testing if a kept surface is not overwritten by later frames");
+
   //clean up
   delete[] point;
   //  expectedResult->Delete();
@@ -0,0 +1,141 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <mitkTestingMacros.h>
+#include <mitkToFRayDirectionTable.h>
+#include <mitkToFProcessingCommon.h>
+
+#include <mitkNumericTypes.h>
+
+#include <cstdlib>
+#include <vector>
+
+typedef mitk::ToFProcessingCommon::ToFPoint2D ToFPoint2D;
+typedef mitk::ToFProcessingCommon::ToFPoint3D ToFPoint3D;
+
+/** compares the table with the per-pixel conversion of ToFProcessingCommon */
+static bool ConversionEqualsToFProcessingCommon(mitk::ToFRayDirectionTable::CameraModel model, const std::vector<float>& distances,
+  unsigned int dimX, unsigned int dimY, mitk::CameraIntrinsics* cameraIntrinsics, const ToFPoint2D& interPixelDistance,
+  const mitk::Point3D& origin, const mitk::Vector3D& spacing)
+{
+  mitk::ToFRayDirectionTable table;
+  table.Update(model, dimX, dimY, cameraIntrinsics, interPixelDistance, origin, spacing);
+
+  std::vector<double> x(distances.size()), y(distances.size()), z(distances.size());
+  unsigned int numberOfValidPixels = table.ConvertToCartesianCoordinates(distances.data(), x.data(), y.data(), z.data());
+
+  ToFPoint2D focalLength;
+  focalLength[0] = cameraIntrinsics->GetFocalLengthX();
+  focalLength[1] = cameraIntrinsics->GetFocalLengthY();
+  ToFPoint2D principalPoint;
+  principalPoint[0] = cameraIntrinsics->GetPrincipalPointX();
+  principalPoint[1] = cameraIntrinsics->GetPrincipalPointY();
+  double focalLengthInMm = (focalLength[0]*interPixelDistance[0]+focalLength[1]*interPixelDistance[1])/2.0;
+
+  unsigned int expectedNumberOfValidPixels = 0;
+  for (unsigned int j=0; j<dimY; j++)
+  {
+    for (unsigned int i=0; i<dimX; i++)
+    {
+      unsigned int pixelID = i+j*dimX;
+      double distance = distances[pixelID];
+      unsigned int completeIndexX = i*spacing[0]+origin[0];
+      unsigned int completeIndexY = j*spacing[1]+origin[1];
+
+      ToFPoint3D expected;
+      switch (model)
+      {
+      case mitk::ToFRayDirectionTable::PinholeInPixelUnits:
+        expected = mitk::ToFProcessingCommon::IndexToCartesianCoordinates(completeIndexX,completeIndexY,distance,focalLength,principalPoint);
+        break;
+      case mitk::ToFRayDirectionTable::PinholeWithInterPixelDistance:
+        expected = mitk::ToFProcessingCommon::IndexToCartesianCoordinatesWithInterpixdist(completeIndexX,completeIndexY,distance,focalLengthInMm,interPixelDistance,principalPoint);
+        break;
+      case mitk::ToFRayDirectionTable::Kinect:
+        expected = mitk::ToFProcessingCommon::KinectIndexToCartesianCoordinates(completeIndexX,completeIndexY,distance,focalLength,principalPoint);
+        break;
+      }
+      ToFPoint3D result;
+      result[0] = x[pixelID];
+      result[1] = y[pixelID];
+      result[2] = z[pixelID];
+      if (!mitk::Equal(expected,result))
+      {
+        MITK_INFO<<"expected: "<<expected;
+        MITK_INFO<<"result: "<<result;
+        return false;
+      }
+      if (distance>mitk::eps)
+      {
+        expectedNumberOfValidPixels++;
+      }
+    }
+  }
+  return numberOfValidPixels==expectedNumberOfValidPixels;
+}
+
+/**Documentation
+ *  test for the class "ToFRayDirectionTable".
+ */
+int mitkToFRayDirectionTableTest(int /* argc */, char* /*argv*/[])
+{
+  MITK_TEST_BEGIN("ToFRayDirectionTable");
+
+  unsigned int dimX = 160;
+  unsigned int dimY = 120;
+  std::vector<float> distances(dimX*dimY);
+  std::srand(42);
+  for (unsigned int i=0; i<distances.size(); i++)
+  {
+    // every seventh pixel is invalid
+    distances[i] = (i%7==0) ? 0.0f : 500.0f + 1000.0f*std::rand()/RAND_MAX;
+  }
+
+  mitk::CameraIntrinsics::Pointer cameraIntrinsics = mitk::CameraIntrinsics::New();
+  cameraIntrinsics->SetFocalLength(295.78960,296.348535);
+  cameraIntrinsics->SetPrincipalPoint(83.576546,60.1532);
+  ToFPoint2D interPixelDistance;
+  interPixelDistance[0] = 0.04564;
+  interPixelDistance[1] = 0.0451564;
+  mitk::Point3D origin;
+  origin.Fill(0.0);
+  mitk::Vector3D spacing;
+  spacing.Fill(1.0);
+
+  MITK_TEST_CONDITION_REQUIRED(ConversionEqualsToFProcessingCommon(mitk::ToFRayDirectionTable::PinholeInPixelUnits,
+    distances,dimX,dimY,cameraIntrinsics,interPixelDistance,origin,spacing),"Testing conversion without interpixeldistance");
+  MITK_TEST_CONDITION_REQUIRED(ConversionEqualsToFProcessingCommon(mitk::ToFRayDirectionTable::PinholeWithInterPixelDistance,
+    distances,dimX,dimY,cameraIntrinsics,interPixelDistance,origin,spacing),"Testing conversion with interpixeldistance");
+  MITK_TEST_CONDITION_REQUIRED(ConversionEqualsToFProcessingCommon(mitk::ToFRayDirectionTable::Kinect,
+    distances,dimX,dimY,cameraIntrinsics,interPixelDistance,origin,spacing),"Testing Kinect conversion");
+
+  // image cropped from and downsampled by 2 of a larger image
+  origin[0] = 10;
+  origin[1] = 4;
+  spacing[0] = 2;
+  spacing[1] = 2;
+  MITK_TEST_CONDITION_REQUIRED(ConversionEqualsToFProcessingCommon(mitk::ToFRayDirectionTable::PinholeInPixelUnits,
+    distances,dimX,dimY,cameraIntrinsics,interPixelDistance,origin,spacing),"Testing conversion of a cropped and resampled image");
+
+  // the table is only computed again if a parameter changes
+  mitk::ToFRayDirectionTable table;
+  MITK_TEST_CONDITION_REQUIRED(table.Update(mitk::ToFRayDirectionTable::Kinect,dimX,dimY,cameraIntrinsics,interPixelDistance,origin,spacing),"Testing first Update()");
+  MITK_TEST_CONDITION_REQUIRED(table.GetNumberOfPixels()==dimX*dimY,"Testing GetNumberOfPixels()");
+  MITK_TEST_CONDITION_REQUIRED(!table.Update(mitk::ToFRayDirectionTable::Kinect,dimX,dimY,cameraIntrinsics,interPixelDistance,origin,spacing),"Testing Update() with unchanged parameters");
+  cameraIntrinsics->SetPrincipalPoint(80.0,60.0);
+  MITK_TEST_CONDITION_REQUIRED(table.Update(mitk::ToFRayDirectionTable::Kinect,dimX,dimY,cameraIntrinsics,interPixelDistance,origin,spacing),"Testing Update() with changed intrinsics");
+  MITK_TEST_CONDITION_REQUIRED(table.Update(mitk::ToFRayDirectionTable::PinholeInPixelUnits,dimX,dimY,cameraIntrinsics,interPixelDistance,origin,spacing),"Testing Update() with changed camera model");
+  MITK_TEST_CONDITION_REQUIRED(table.Update(mitk::ToFRayDirectionTable::PinholeInPixelUnits,dimX/2,dimY,cameraIntrinsics,interPixelDistance,origin,spacing),"Testing Update() with changed image size");
+  MITK_TEST_CONDITION_REQUIRED(table.GetXDimension()==dimX/2 && table.GetYDimension()==dimY,"Testing GetXDimension() and GetYDimension()");
+
+  MITK_TEST_END();
+}
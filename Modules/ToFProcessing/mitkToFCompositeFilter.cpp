@@ -18,10 +18,12 @@ found in the LICENSE file.
 
 #include "opencv2/imgproc.hpp"
 
+#include <algorithm>
+
 mitk::ToFCompositeFilter::ToFCompositeFilter() : m_SegmentationMask(nullptr), m_ImageWidth(0), m_ImageHeight(0), m_ImageSize(0),
 m_IplDistanceImage(nullptr), m_IplOutputImage(nullptr), m_ItkInputImage(nullptr), m_ApplyTemporalMedianFilter(false), m_ApplyAverageFilter(false),
-  m_ApplyMedianFilter(false), m_ApplyThresholdFilter(false), m_ApplyMaskSegmentation(false), m_ApplyBilateralFilter(false), m_DataBuffer(nullptr),
-m_DataBufferCurrentIndex(0), m_DataBufferMaxSize(0), m_TemporalMedianFilterNumOfFrames(10), m_ThresholdFilterMin(1),
+  m_ApplyMedianFilter(false), m_ApplyThresholdFilter(false), m_ApplyMaskSegmentation(false), m_ApplyBilateralFilter(false),
+m_DataBufferCurrentIndex(0), m_DataBufferMaxSize(0), m_DataBufferNumberOfFrames(0), m_DataBufferImageSize(0), m_TemporalMedianFilterNumOfFrames(10), m_ThresholdFilterMin(1),
 m_ThresholdFilterMax(7000), m_BilateralFilterDomainSigma(2), m_BilateralFilterRangeSigma(60), m_BilateralFilterKernelRadius(0)
 {
 }
@@ -30,10 +32,6 @@ mitk::ToFCompositeFilter::~ToFCompositeFilter()
 {
   cvReleaseImage(&(this->m_IplDistanceImage));
   cvReleaseImage(&(this->m_IplOutputImage));
-  if (m_DataBuffer!=nullptr)
-  {
-    delete [] m_DataBuffer;
-  }
 }
 
 void mitk::ToFCompositeFilter::SetInput(  const InputImageType* distanceImage )
@@ -95,17 +93,20 @@ void mitk::ToFCompositeFilter::SetInput( unsigned int idx,  const InputImageType
 
 void mitk::ToFCompositeFilter::GenerateData()
 {
-  // copy input 1...n to output 1...n
+  // copy input 1...n to output 1...n, output 0 is written after processing
   for (unsigned int idx=0; idx<this->GetNumberOfOutputs(); idx++)
   {
     mitk::Image::Pointer outputImage = this->GetOutput(idx);
     mitk::Image::Pointer inputImage = this->GetInput(idx);
     if (outputImage.IsNotNull()&&inputImage.IsNotNull())
     {
-      ImageReadAccessor inputAcc(inputImage, inputImage->GetSliceData());
       outputImage->CopyInformation(inputImage);
       outputImage->Initialize(inputImage->GetPixelType(),inputImage->GetDimension(),inputImage->GetDimensions());
-      outputImage->SetSlice(inputAcc.GetData());
+      if (idx > 0)
+      {
+        ImageReadAccessor inputAcc(inputImage, inputImage->GetSliceData());
+        outputImage->SetSlice(inputAcc.GetData());
+      }
     }
   }
   //mitk::Image::Pointer outputDistanceImage = this->GetOutput();
@@ -133,15 +134,17 @@ void mitk::ToFCompositeFilter::GenerateData()
   }
   if (this->m_ApplyBilateralFilter)
   {
-      float* itkFloatData = this->m_ItkInputImage->GetBufferPointer();
-      memcpy(itkFloatData, this->m_IplDistanceImage->imageData, this->m_ImageSize );
-      ItkImageType2D::Pointer itkOutputImage = ProcessItkBilateralFilter(this->m_ItkInputImage);
-      memcpy( this->m_IplDistanceImage->imageData, itkOutputImage->GetBufferPointer(), this->m_ImageSize );
+    // m_ItkInputImage works on the buffer of m_IplDistanceImage, the result is written to the output directly
+    ItkImageType2D::Pointer itkOutputImage = ProcessItkBilateralFilter(this->m_ItkInputImage);
+    memcpy( outputDistanceFloatData, itkOutputImage->GetBufferPointer(), this->m_ImageSize );
 
     //ProcessCVBilateralFilter(this->m_IplDistanceImage, this->m_OutputIplImage, domainSigma, rangeSigma, kernelRadius);
     //memcpy( distanceFloatData, this->m_OutputIplImage->imageData, distanceImageSize );
   }
-  memcpy( outputDistanceFloatData, this->m_IplDistanceImage->imageData, this->m_ImageSize );
+  else
+  {
+    memcpy( outputDistanceFloatData, this->m_IplDistanceImage->imageData, this->m_ImageSize );
+  }
 }
 
 void mitk::ToFCompositeFilter::CreateOutputsForAllInputs()
@@ -185,43 +188,40 @@ void mitk::ToFCompositeFilter::ProcessSegmentation(IplImage* inputIplImage)
     segmentationMask = nullptr;
   }
   float *f = (float*)inputIplImage->imageData;
-  for(int i=0; i<this->m_ImageWidth*this->m_ImageHeight; i++)
+  const int numberOfPixels = this->m_ImageWidth*this->m_ImageHeight;
+  // one loop per operation without branches, so that the loops are vectorized
+  if (this->m_ApplyThresholdFilter)
   {
-    if (this->m_ApplyThresholdFilter)
+    const float thresholdMin = m_ThresholdFilterMin;
+    const float thresholdMax = m_ThresholdFilterMax;
+    for(int i=0; i<numberOfPixels; i++)
     {
-      if (f[i]<=m_ThresholdFilterMin)
-      {
-        f[i] = 0.0;
-      }
-      else if (f[i]>=m_ThresholdFilterMax)
-      {
-        f[i] = 0.0;
-      }
+      f[i] = (f[i]<=thresholdMin || f[i]>=thresholdMax) ? 0.0f : f[i];
     }
-    if (this->m_ApplyMaskSegmentation)
+  }
+  if (this->m_ApplyMaskSegmentation && segmentationMask)
+  {
+    for(int i=0; i<numberOfPixels; i++)
     {
-      if (segmentationMask)
-      {
-        if (segmentationMask[i]==0)
-        {
-          f[i] = 0.0;
-        }
-      }
+      f[i] = (segmentationMask[i]==0) ? 0.0f : f[i];
     }
   }
 }
 
 ItkImageType2D::Pointer mitk::ToFCompositeFilter::ProcessItkBilateralFilter(ItkImageType2D::Pointer inputItkImage)
 {
-  ItkImageType2D::Pointer outputItkImage;
-  BilateralFilterType::Pointer bilateralFilter = BilateralFilterType::New();
-  bilateralFilter->SetInput(inputItkImage);
-  bilateralFilter->SetDomainSigma(m_BilateralFilterDomainSigma);
-  bilateralFilter->SetRangeSigma(m_BilateralFilterRangeSigma);
-  //bilateralFilter->SetRadius(m_BilateralFilterKernelRadius);
-  outputItkImage = bilateralFilter->GetOutput();
-  outputItkImage->Update();
-  return outputItkImage;
+  if (m_BilateralFilter.IsNull())
+  {
+    m_BilateralFilter = BilateralFilterType::New();
+  }
+  // the buffer of the input image is changed in place
+  inputItkImage->Modified();
+  m_BilateralFilter->SetInput(inputItkImage);
+  m_BilateralFilter->SetDomainSigma(m_BilateralFilterDomainSigma);
+  m_BilateralFilter->SetRangeSigma(m_BilateralFilterRangeSigma);
+  //m_BilateralFilter->SetRadius(m_BilateralFilterKernelRadius);
+  m_BilateralFilter->Update();
+  return m_BilateralFilter->GetOutput();
 }
 
 void mitk::ToFCompositeFilter::ProcessCVBilateralFilter(IplImage* inputIplImage, IplImage* outputIplImage)
@@ -242,75 +242,63 @@ void mitk::ToFCompositeFilter::ProcessStreamedQuickSelectMedianImageFilter(IplIm
   float* data = (float*)inputIplImage->imageData;
 
   int imageSize = inputIplImage->width * inputIplImage->height;
-  float* tmpArray;
 
   if (this->m_TemporalMedianFilterNumOfFrames == 0)
   {
     return;
   }
 
-  if (m_TemporalMedianFilterNumOfFrames != this->m_DataBufferMaxSize) // reset
+  if (m_TemporalMedianFilterNumOfFrames != this->m_DataBufferMaxSize || imageSize != this->m_DataBufferImageSize) // reset
   {
-    //delete current buffer
-    for( int i=0; i<this->m_DataBufferMaxSize; i++ ) {
-      delete[] this->m_DataBuffer[i];
-    }
-    if (this->m_DataBuffer != nullptr)
-    {
-      delete[] this->m_DataBuffer;
-    }
-
     this->m_DataBufferMaxSize = m_TemporalMedianFilterNumOfFrames;
+    this->m_DataBufferImageSize = imageSize;
 
-    // create new buffer with current size
-    this->m_DataBuffer = new float*[this->m_DataBufferMaxSize];
-    for(int i=0; i<this->m_DataBufferMaxSize; i++)
-    {
-      this->m_DataBuffer[i] = nullptr;
-    }
+    // one block of m_DataBufferMaxSize values per pixel
+    this->m_DataBuffer.assign(static_cast<std::size_t>(imageSize) * this->m_DataBufferMaxSize, 0.0f);
+    this->m_MedianValues.resize(this->m_DataBufferMaxSize);
     this->m_DataBufferCurrentIndex = 0;
+    this->m_DataBufferNumberOfFrames = 0;
   }
 
-  int currentBufferSize = this->m_DataBufferMaxSize;
-  tmpArray = new float[this->m_DataBufferMaxSize];
-
-  // copy data to buffer
-  if (this->m_DataBuffer[this->m_DataBufferCurrentIndex] == nullptr)
+  // until the buffer is filled, only the frames received so far are used
+  if (this->m_DataBufferNumberOfFrames < this->m_DataBufferMaxSize)
   {
-    this->m_DataBuffer[this->m_DataBufferCurrentIndex] = new float[imageSize];
-    currentBufferSize = this->m_DataBufferCurrentIndex + 1;
+    this->m_DataBufferNumberOfFrames++;
   }
+  const int currentBufferSize = this->m_DataBufferNumberOfFrames;
+  const int maxSize = this->m_DataBufferMaxSize;
 
-  for(int j=0; j<imageSize; j++)
+  // copy data to buffer
+  float* buffer = this->m_DataBuffer.data();
+  for(int i=0; i<imageSize; i++)
   {
-    this->m_DataBuffer[this->m_DataBufferCurrentIndex][j] = data[j];
+    buffer[i*maxSize + this->m_DataBufferCurrentIndex] = data[i];
   }
 
-  float tmpValue = 0.0f;
-  for(int i=0; i<imageSize; i++)
+  if (m_ApplyAverageFilter)
   {
-    if (m_ApplyAverageFilter)
+    for(int i=0; i<imageSize; i++)
     {
-      tmpValue = 0.0f;
+      const float* values = buffer + i*maxSize;
+      float tmpValue = 0.0f;
       for(int j=0; j<currentBufferSize; j++)
       {
-          tmpValue+=this->m_DataBuffer[j][i];
+        tmpValue+=values[j];
       }
       data[i] = tmpValue/currentBufferSize;
     }
-    else if (m_ApplyTemporalMedianFilter)
+  }
+  else if (m_ApplyTemporalMedianFilter)
+  {
+    float* tmpArray = this->m_MedianValues.data();
+    for(int i=0; i<imageSize; i++)
     {
-      for(int j=0; j<currentBufferSize; j++)
-      {
-        tmpArray[j] = this->m_DataBuffer[j][i];
-      }
+      std::copy(buffer + i*maxSize, buffer + i*maxSize + currentBufferSize, tmpArray);
       data[i] = quick_select(tmpArray, currentBufferSize);
     }
   }
 
   this->m_DataBufferCurrentIndex = (this->m_DataBufferCurrentIndex + 1) % this->m_DataBufferMaxSize;
-
-  delete[] tmpArray;
 }
 
 #define ELEM_SWAP(a,b) { register float t=(a);(a)=(b);(b)=t; }
@@ -393,6 +381,7 @@ void mitk::ToFCompositeFilter::CreateItkImage(ItkImageType2D::Pointer &itkInputI
   region.SetSize( size );
   region.SetIndex( startIndex );
   itkInputImage->SetRegions( region );
-  itkInputImage->Allocate();
+  // no copy between the OpenCV and the ITK image
+  itkInputImage->GetPixelContainer()->SetImportPointer((float*)this->m_IplDistanceImage->imageData, this->m_ImageWidth*this->m_ImageHeight, false);
 
 }
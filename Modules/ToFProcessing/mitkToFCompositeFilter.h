@@ -18,6 +18,8 @@ found in the LICENSE file.
 #include <itkBilateralImageFilter.h>
 #include "opencv2/core.hpp"
 
+#include <vector>
+
 typedef itk::Image<float, 2> ItkImageType2D;
 typedef itk::Image<float, 3> ItkImageType3D;
 typedef itk::BilateralImageFilter<ItkImageType2D,ItkImageType2D> BilateralFilterType;
@@ -133,6 +135,7 @@ namespace mitk
     /*!
     \brief Applies the ITK bilateral filter to the input image
     See http://www.itk.org/Doxygen320/html/classitk_1_1BilateralImageFilter.html for more details.
+    The filter is kept between frames, the returned image is its output and valid until the next call.
     */
     ItkImageType2D::Pointer ProcessItkBilateralFilter(ItkImageType2D::Pointer inputItkImage);
     /*!
@@ -147,6 +150,7 @@ namespace mitk
     void ProcessCVMedianFilter(IplImage* inputIplImage, IplImage* outputIplImage, int radius = 3);
     /*!
     \brief Performs temporal median filter on an image given the number of frames to be considered
+    The last frames are kept in one buffer that is only allocated again if the number of frames or the image size changes.
     */
     void ProcessStreamedQuickSelectMedianImageFilter(IplImage* inputIplImage);
     /*!
@@ -158,7 +162,7 @@ namespace mitk
     */
     float quick_select(float arr[], int n);
     /*!
-    \brief Initialize and allocate a 2D ITK image of dimension m_ImageWidth*m_ImageHeight
+    \brief Initialize a 2D ITK image of dimension m_ImageWidth*m_ImageHeight that uses the buffer of m_IplDistanceImage
     */
     void CreateItkImage(ItkImageType2D::Pointer &itkInputImage);
 
@@ -171,7 +175,8 @@ namespace mitk
     IplImage* m_IplDistanceImage; ///< OpenCV-representation of the distance image
     IplImage* m_IplOutputImage; ///< OpenCV-representation of the output image
 
-    ItkImageType2D::Pointer m_ItkInputImage; ///< ITK representation of the distance image
+    ItkImageType2D::Pointer m_ItkInputImage; ///< ITK representation of the distance image, shares its buffer with m_IplDistanceImage
+    BilateralFilterType::Pointer m_BilateralFilter; ///< bilateral filter, created at the first use
 
     bool m_ApplyTemporalMedianFilter; ///< Flag indicating if the temporal median filter is currently active for processing the distance image
     bool m_ApplyAverageFilter; ///< Flag indicating if the average filter is currently active for processing the distance image
@@ -180,9 +185,12 @@ namespace mitk
     bool m_ApplyMaskSegmentation; ///< Flag indicating if a mask segmentation is performed
     bool m_ApplyBilateralFilter; ///< Flag indicating if the bilateral filter is currently active for processing the distance image
 
-    float** m_DataBuffer; ///< Buffer used for calculating the pixel-wise median over the last n (m_TemporalMedianFilterNumOfFrames) number of frames
+    std::vector<float> m_DataBuffer; ///< Buffer used for calculating the pixel-wise median over the last n (m_TemporalMedianFilterNumOfFrames) number of frames. The values of one pixel are stored next to each other
+    std::vector<float> m_MedianValues; ///< Values of one pixel, reordered by quick_select()
     int m_DataBufferCurrentIndex; ///< Current index in the buffer of the temporal median filter
     int m_DataBufferMaxSize; ///< Maximal size for the buffer of the temporal median filter (m_DataBuffer)
+    int m_DataBufferNumberOfFrames; ///< Number of frames currently stored in the buffer
+    int m_DataBufferImageSize; ///< Number of pixels of the frames in the buffer
 
     int m_TemporalMedianFilterNumOfFrames; ///< Number of frames to be used in the calculation of the temporal median
     int m_ThresholdFilterMin; ///< Lower threshold of the threshold filter. Pixels with values below will be assigned value 0 when applying the threshold filter
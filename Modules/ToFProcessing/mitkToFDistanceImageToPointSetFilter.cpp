@@ -15,6 +15,7 @@ found in the LICENSE file.
 #include "mitkImageDataItem.h"
 #include "mitkPointSet.h"
 #include <mitkImagePixelReadAccessor.h>
+#include <mitkImageReadAccessor.h>
 #include "mitkToFProcessingCommon.h"
 
 mitk::ToFDistanceImageToPointSetFilter::ToFDistanceImageToPointSetFilter()
@@ -162,31 +163,35 @@ void mitk::ToFDistanceImageToPointSetFilter::GenerateData()
   }
   else //compute PointSet holding cartesian coordinates for every image point
   {
-    int xDimension = (int)input->GetDimension(0);
-    int yDimension = (int)input->GetDimension(1);
+    unsigned int xDimension = input->GetDimension(0);
+    unsigned int yDimension = input->GetDimension(1);
+    mitk::Point3D origin;
+    origin.Fill(0.0);
+    mitk::Vector3D spacing;
+    spacing.Fill(1.0);
+    m_RayDirectionTable.Update(m_ReconstructionMode ? ToFRayDirectionTable::PinholeInPixelUnits : ToFRayDirectionTable::PinholeWithInterPixelDistance,
+      xDimension, yDimension, m_CameraIntrinsics, m_InterPixelDistance, origin, spacing);
+
+    unsigned int size = xDimension*yDimension;
+    m_PointsX.resize(size);
+    m_PointsY.resize(size);
+    m_PointsZ.resize(size);
+
+    mitk::ImageReadAccessor imageAcces(input, input->GetSliceData(0));
+    const float* distances = static_cast<const float*>(imageAcces.GetData());
+    m_RayDirectionTable.ConvertToCartesianCoordinates(distances, m_PointsX.data(), m_PointsY.data(), m_PointsZ.data());
+
     int pointCount = 0;
-    mitk::ImagePixelReadAccessor<float,2> imageAcces(input, input->GetSliceData(0));
-    for (int j=0; j<yDimension; j++)
+    for (unsigned int pixelID=0; pixelID<size; pixelID++)
     {
-      for (int i=0; i<xDimension; i++)
+      if (distances[pixelID]>mitk::eps)
       {
-        itk::Index<2> pixel;
-        pixel[0] = i;
-        pixel[1] = j;
-
-        mitk::ToFProcessingCommon::ToFScalarType distance = (double)imageAcces.GetPixelByIndex(pixel);
-
         mitk::Point3D currentPoint;
-        if (m_ReconstructionMode)
-          currentPoint = mitk::ToFProcessingCommon::IndexToCartesianCoordinates(i,j,distance,focalLengthInPixelUnits,principalPoint);
-        else
-          currentPoint = mitk::ToFProcessingCommon::IndexToCartesianCoordinatesWithInterpixdist(i,j,distance,focalLengthInMm,m_InterPixelDistance,principalPoint);
-
-        if (distance>mitk::eps)
-        {
-          output->InsertPoint( pointCount, currentPoint );
-          pointCount++;
-        }
+        currentPoint[0] = m_PointsX[pixelID];
+        currentPoint[1] = m_PointsY[pixelID];
+        currentPoint[2] = m_PointsZ[pixelID];
+        output->InsertPoint( pointCount, currentPoint );
+        pointCount++;
       }
     }
   }
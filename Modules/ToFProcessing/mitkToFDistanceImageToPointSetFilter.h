@@ -19,6 +19,7 @@ found in the LICENSE file.
 #include <mitkPointSetSource.h>
 #include "mitkImageSource.h"
 #include <mitkToFProcessingCommon.h>
+#include <mitkToFRayDirectionTable.h>
 #include <MitkToFProcessingExports.h>
 
 namespace mitk
@@ -130,6 +131,11 @@ namespace mitk
     mitk::CameraIntrinsics::Pointer m_CameraIntrinsics; ///< Member holding the intrinsic parameters needed for PointSet calculation
     ToFProcessingCommon::ToFPoint2D m_InterPixelDistance; ///< distance in mm between two adjacent pixels on the ToF camera chip
     bool m_ReconstructionMode; ///< true = Reconstruction without interpixeldistance and with focal lengths in pixel units. false = Reconstruction with interpixeldistance and with focal length in mm.
+
+    ToFRayDirectionTable m_RayDirectionTable; ///< Rays through the pixels of the distance image, recomputed only if the camera parameters change
+    std::vector<double> m_PointsX; ///< Cartesian coordinates of all pixels of the current frame
+    std::vector<double> m_PointsY;
+    std::vector<double> m_PointsZ;
   };
 } //END mitk namespace
 #endif
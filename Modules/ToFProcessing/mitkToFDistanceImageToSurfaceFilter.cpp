@@ -22,6 +22,7 @@ found in the LICENSE file.
 #include <vtkPolyData.h>
 #include <vtkPointData.h>
 #include <vtkFloatArray.h>
+#include <vtkDoubleArray.h>
 #include <vtkSmartPointer.h>
 #include <vtkIdList.h>
 
@@ -30,7 +31,7 @@ found in the LICENSE file.
 
 mitk::ToFDistanceImageToSurfaceFilter::ToFDistanceImageToSurfaceFilter() :
   m_IplScalarImage(nullptr), m_CameraIntrinsics(), m_TextureImageWidth(0), m_TextureImageHeight(0), m_InterPixelDistance(), m_TextureIndex(0),
-  m_GenerateTriangularMesh(true), m_TriangulationThreshold(0.0)
+  m_GenerateTriangularMesh(true), m_TriangulationThreshold(0.0), m_CurrentSurfaceBuffers(0)
 {
   m_InterPixelDistance.Fill(0.045);
   m_CameraIntrinsics = mitk::CameraIntrinsics::New();
@@ -95,29 +96,33 @@ void mitk::ToFDistanceImageToSurfaceFilter::GenerateData()
   int xDimension = input->GetDimension(0);
   int yDimension = input->GetDimension(1);
   unsigned int size = xDimension*yDimension; //size of the image-array
-  std::vector<bool> isPointValid;
-  isPointValid.resize(size);
-  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
-  points->SetDataTypeToDouble();
-  vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
-  vtkSmartPointer<vtkCellArray> vertices = vtkSmartPointer<vtkCellArray>::New();
-  vtkSmartPointer<vtkFloatArray> scalarArray = vtkSmartPointer<vtkFloatArray>::New();
-  vtkSmartPointer<vtkFloatArray> textureCoords = vtkSmartPointer<vtkFloatArray>::New();
-  textureCoords->SetNumberOfComponents(2);
-  textureCoords->Allocate(size);
 
-  //Make a vtkIdList to save the ID's of the polyData corresponding to the image
-  //pixel ID's. See below for more documentation.
-  m_VertexIdList = vtkSmartPointer<vtkIdList>::New();
-  //Allocate the object once else it would automatically allocate new memory
-  //for every vertex and perform a copy which is expensive.
-  m_VertexIdList->Allocate(size);
-  m_VertexIdList->SetNumberOfIds(size);
-  for(unsigned int i = 0; i < size; ++i)
+  ToFRayDirectionTable::CameraModel cameraModel;
+  switch (m_ReconstructionMode)
   {
-    m_VertexIdList->SetId(i, 0);
+  case WithOutInterPixelDistance:
+    cameraModel = ToFRayDirectionTable::PinholeInPixelUnits;
+    break;
+  case WithInterPixelDistance:
+    cameraModel = ToFRayDirectionTable::PinholeWithInterPixelDistance;
+    break;
+  case Kinect:
+    cameraModel = ToFRayDirectionTable::Kinect;
+    break;
+  default:
+    mitkThrow() << "Incorrect reconstruction mode!";
   }
 
+  /** Here we have to incorporate spacing and origin to allow processing of cropped/resampled images
+  * Usually origin will be [0, 0, 0] and spacing will be [1, 1, 1], but just in case the image is moved
+  * due to cropping or the spacing differes due to up- or downsampling.*/
+  mitk::Point3D origin = input->GetGeometry()->GetOrigin();
+  mitk::Vector3D spacing = input->GetGeometry()->GetSpacing();
+  m_RayDirectionTable.Update(cameraModel, xDimension, yDimension, m_CameraIntrinsics, m_InterPixelDistance, origin, spacing);
+
+  //The buffers are kept from the frame before the last one and only grow if the image gets larger.
+  SurfaceBuffers& buffers = this->InitializeBuffers(size);
+
   float* scalarFloatData = nullptr;
 
   if (this->m_IplScalarImage) // if scalar image is defined use it for texturing
@@ -132,35 +137,24 @@ void mitk::ToFDistanceImageToSurfaceFilter::GenerateData()
 
   ImageReadAccessor inputAcc(input, input->GetSliceData(0,0,0));
   float* inputFloatData = (float*)inputAcc.GetData();
-  //calculate world coordinates
-  mitk::ToFProcessingCommon::ToFPoint2D focalLengthInPixelUnits;
-  mitk::ToFProcessingCommon::ToFScalarType focalLengthInMm;
-  if((m_ReconstructionMode == WithOutInterPixelDistance) || (m_ReconstructionMode == Kinect))
-  {
-    focalLengthInPixelUnits[0] = m_CameraIntrinsics->GetFocalLengthX();
-    focalLengthInPixelUnits[1] = m_CameraIntrinsics->GetFocalLengthY();
-    focalLengthInMm = 0.0;
-  }
-  else if( m_ReconstructionMode == WithInterPixelDistance)
-  {
-    //convert focallength from pixel to mm
-    focalLengthInPixelUnits[0] = 0.0;
-    focalLengthInPixelUnits[1] = 0.0;
-    focalLengthInMm = (m_CameraIntrinsics->GetFocalLengthX()*m_InterPixelDistance[0]+m_CameraIntrinsics->GetFocalLengthY()*m_InterPixelDistance[1])/2.0;
-  }
-  else
-  {
-    focalLengthInPixelUnits[0] = 0.0;
-    focalLengthInPixelUnits[1] = 0.0;
-    focalLengthInMm = 0.0;
-  }
 
-  mitk::ToFProcessingCommon::ToFPoint2D principalPoint;
-  principalPoint[0] = m_CameraIntrinsics->GetPrincipalPointX();
-  principalPoint[1] = m_CameraIntrinsics->GetPrincipalPointY();
+  //calculate world coordinates of all pixels in one pass
+  double* pointX = m_PointsX.data();
+  double* pointY = m_PointsY.data();
+  double* pointZ = m_PointsZ.data();
+  const unsigned int numberOfValidPoints = m_RayDirectionTable.ConvertToCartesianCoordinates(inputFloatData, pointX, pointY, pointZ);
 
-  mitk::Point3D origin = input->GetGeometry()->GetOrigin();
-  mitk::Vector3D spacing = input->GetGeometry()->GetSpacing();
+  //VTK would insert empty points into the polydata if we use the pixelID as point ID.
+  //Thus the valid points are written one after another and their ID's are saved
+  //in the vertexIdList.
+  double* points = static_cast<vtkDoubleArray*>(buffers.Points->GetData())->WritePointer(0, 3*numberOfValidPoints);
+  float* scalars = scalarFloatData ? buffers.ScalarArray->WritePointer(0, numberOfValidPoints) : nullptr;
+  float* textureCoords = buffers.TextureCoords->WritePointer(0, 2*numberOfValidPoints);
+  vtkIdType* vertexIds = m_VertexIdList->GetPointer(0);
+
+  std::vector<unsigned char>& isPointValid = m_IsPointValid;
+  const bool useTriangulationThreshold = !mitk::Equal(m_TriangulationThreshold, 0.0);
+  vtkIdType pointCount = 0;
 
   for (int j=0; j<yDimension; j++)
   {
@@ -168,145 +162,160 @@ void mitk::ToFDistanceImageToSurfaceFilter::GenerateData()
     {
       unsigned int pixelID = i+j*xDimension;
 
-      mitk::ToFProcessingCommon::ToFScalarType distance = (double)inputFloatData[pixelID];
-
-      /** Here we have to incorporate spacing and origin to allow processing of cropped/resampled images
-      * Usually origin will be [0, 0, 0] and spacing will be [1, 1, 1], but just in case the image is moved
-      * due to cropping or the spacing differes due to up- or downsampling.*/
-      unsigned int completeIndexX = i*spacing[0]+origin[0];
-      unsigned int completeIndexY = j*spacing[1]+origin[1];
-
-      mitk::ToFProcessingCommon::ToFPoint3D cartesianCoordinates;
-      switch (m_ReconstructionMode)
-      {
-      case WithOutInterPixelDistance:
-      {
-        cartesianCoordinates = mitk::ToFProcessingCommon::IndexToCartesianCoordinates(completeIndexX,completeIndexY,distance,focalLengthInPixelUnits,principalPoint);
-        break;
-      }
-      case WithInterPixelDistance:
-      {
-        cartesianCoordinates = mitk::ToFProcessingCommon::IndexToCartesianCoordinatesWithInterpixdist(completeIndexX,completeIndexY,distance,focalLengthInMm,m_InterPixelDistance,principalPoint);
-        break;
-      }
-      case Kinect:
-      {
-        cartesianCoordinates = mitk::ToFProcessingCommon::KinectIndexToCartesianCoordinates(completeIndexX,completeIndexY,distance,focalLengthInPixelUnits,principalPoint);
-        break;
-      }
-      default:
-      {
-        MITK_ERROR << "Incorrect reconstruction mode!";
-      }
-      }
       //Epsilon here, because we may have small float values like 0.00000001 which in fact represents 0.
-      if (distance<=mitk::eps)
+      if (inputFloatData[pixelID]<=mitk::eps)
       {
         isPointValid[pixelID] = false;
+        vertexIds[pixelID] = 0;
+        continue;
       }
-      else
+      isPointValid[pixelID] = true;
+      vertexIds[pixelID] = pointCount;
+      points[3*pointCount] = pointX[pixelID];
+      points[3*pointCount+1] = pointY[pixelID];
+      points[3*pointCount+2] = pointZ[pixelID];
+
+      if (m_GenerateTriangularMesh)
       {
-        isPointValid[pixelID] = true;
-        //VTK would insert empty points into the polydata if we use
-        //points->InsertPoint(pixelID, cartesianCoordinates.GetDataPointer()).
-        //If we use points->InsertNextPoint(...) instead, the ID's do not
-        //correspond to the image pixel ID's. Thus, we have to save them
-        //in the vertexIdList.
-        m_VertexIdList->SetId(pixelID, points->InsertNextPoint(cartesianCoordinates.GetDataPointer()));
-
-        if (m_GenerateTriangularMesh)
+        if((i >= 1) && (j >= 1))
         {
-          if((i >= 1) && (j >= 1))
+          //This little piece of art explains the ID's:
+          //
+          // P(x_1y_1)---P(xy_1)
+          // |           |
+          // |           |
+          // |           |
+          // P(x_1y)-----P(xy)
+          //
+          //We can only start triangulation if we are at vertex (1,1),
+          //because we need the other 3 vertices near this one.
+          //To go one pixel line back in the image array, we have to
+          //subtract 1x xDimension.
+          vtkIdType xy = pixelID;
+          vtkIdType x_1y = pixelID-1;
+          vtkIdType xy_1 = pixelID-xDimension;
+          vtkIdType x_1y_1 = xy_1-1;
+
+          if (isPointValid[xy]&&isPointValid[x_1y]&&isPointValid[x_1y_1]&&isPointValid[xy_1]) // check if points of cell are valid
           {
-            //This little piece of art explains the ID's:
-            //
-            // P(x_1y_1)---P(xy_1)
-            // |           |
-            // |           |
-            // |           |
-            // P(x_1y)-----P(xy)
-            //
-            //We can only start triangulation if we are at vertex (1,1),
-            //because we need the other 3 vertices near this one.
-            //To go one pixel line back in the image array, we have to
-            //subtract 1x xDimension.
-            vtkIdType xy = pixelID;
-            vtkIdType x_1y = pixelID-1;
-            vtkIdType xy_1 = pixelID-xDimension;
-            vtkIdType x_1y_1 = xy_1-1;
-
             //Find the corresponding vertex ID's in the saved vertexIdList:
-            vtkIdType xyV = m_VertexIdList->GetId(xy);
-            vtkIdType x_1yV = m_VertexIdList->GetId(x_1y);
-            vtkIdType xy_1V = m_VertexIdList->GetId(xy_1);
-            vtkIdType x_1y_1V = m_VertexIdList->GetId(x_1y_1);
-
-            if (isPointValid[xy]&&isPointValid[x_1y]&&isPointValid[x_1y_1]&&isPointValid[xy_1]) // check if points of cell are valid
+            vtkIdType xyV = vertexIds[xy];
+            vtkIdType x_1yV = vertexIds[x_1y];
+            vtkIdType xy_1V = vertexIds[xy_1];
+            vtkIdType x_1y_1V = vertexIds[x_1y_1];
+
+            double pointXY[3] = { pointX[xy], pointY[xy], pointZ[xy] };
+            double pointX_1Y[3] = { pointX[x_1y], pointY[x_1y], pointZ[x_1y] };
+            double pointXY_1[3] = { pointX[xy_1], pointY[xy_1], pointZ[xy_1] };
+            double pointX_1Y_1[3] = { pointX[x_1y_1], pointY[x_1y_1], pointZ[x_1y_1] };
+
+            if( !useTriangulationThreshold || ((vtkMath::Distance2BetweenPoints(pointXY, pointX_1Y) <= m_TriangulationThreshold)
+                                              && (vtkMath::Distance2BetweenPoints(pointXY, pointXY_1) <= m_TriangulationThreshold)
+                                              && (vtkMath::Distance2BetweenPoints(pointX_1Y, pointX_1Y_1) <= m_TriangulationThreshold)
+                                              && (vtkMath::Distance2BetweenPoints(pointXY_1, pointX_1Y_1) <= m_TriangulationThreshold)))
             {
-              double pointXY[3], pointX_1Y[3], pointXY_1[3], pointX_1Y_1[3];
-
-              points->GetPoint(xyV, pointXY);
-              points->GetPoint(x_1yV, pointX_1Y);
-              points->GetPoint(xy_1V, pointXY_1);
-              points->GetPoint(x_1y_1V, pointX_1Y_1);
-
-              if( (mitk::Equal(m_TriangulationThreshold, 0.0)) || ((vtkMath::Distance2BetweenPoints(pointXY, pointX_1Y) <= m_TriangulationThreshold)
-                                                                   && (vtkMath::Distance2BetweenPoints(pointXY, pointXY_1) <= m_TriangulationThreshold)
-                                                                   && (vtkMath::Distance2BetweenPoints(pointX_1Y, pointX_1Y_1) <= m_TriangulationThreshold)
-                                                                   && (vtkMath::Distance2BetweenPoints(pointXY_1, pointX_1Y_1) <= m_TriangulationThreshold)))
-              {
-                polys->InsertNextCell(3);
-                polys->InsertCellPoint(x_1yV);
-                polys->InsertCellPoint(xyV);
-                polys->InsertCellPoint(x_1y_1V);
-
-                polys->InsertNextCell(3);
-                polys->InsertCellPoint(x_1y_1V);
-                polys->InsertCellPoint(xyV);
-                polys->InsertCellPoint(xy_1V);
-              }
-              else
-              {
-                //We dont want triangulation, but we want to keep the vertex
-                vertices->InsertNextCell(1);
-                vertices->InsertCellPoint(xyV);
-              }
+              buffers.Polys->InsertNextCell(3);
+              buffers.Polys->InsertCellPoint(x_1yV);
+              buffers.Polys->InsertCellPoint(xyV);
+              buffers.Polys->InsertCellPoint(x_1y_1V);
+
+              buffers.Polys->InsertNextCell(3);
+              buffers.Polys->InsertCellPoint(x_1y_1V);
+              buffers.Polys->InsertCellPoint(xyV);
+              buffers.Polys->InsertCellPoint(xy_1V);
+            }
+            else
+            {
+              //We dont want triangulation, but we want to keep the vertex
+              buffers.Vertices->InsertNextCell(1);
+              buffers.Vertices->InsertCellPoint(xyV);
             }
           }
         }
-        else
-        {
-          //We dont want triangulation, we only want vertices
-          vertices->InsertNextCell(1);
-          vertices->InsertCellPoint(m_VertexIdList->GetId(pixelID));
-        }
-        //Scalar values are necessary for mapping colors/texture onto the surface
-        if (scalarFloatData)
-        {
-          scalarArray->InsertTuple1(m_VertexIdList->GetId(pixelID), scalarFloatData[pixelID]);
-        }
-        //These Texture Coordinates will map color pixel and vertices 1:1 (e.g. for Kinect).
-        float xNorm = (((float)i)/xDimension);// correct video texture scale for kinect
-        float yNorm = ((float)j)/yDimension; //don't flip. we don't need to flip.
-        textureCoords->InsertTuple2(m_VertexIdList->GetId(pixelID), xNorm, yNorm);
       }
+      else
+      {
+        //We dont want triangulation, we only want vertices
+        buffers.Vertices->InsertNextCell(1);
+        buffers.Vertices->InsertCellPoint(pointCount);
+      }
+      //Scalar values are necessary for mapping colors/texture onto the surface
+      if (scalars)
+      {
+        scalars[pointCount] = scalarFloatData[pixelID];
+      }
+      //These Texture Coordinates will map color pixel and vertices 1:1 (e.g. for Kinect).
+      textureCoords[2*pointCount] = (((float)i)/xDimension);// correct video texture scale for kinect
+      textureCoords[2*pointCount+1] = ((float)j)/yDimension; //don't flip. we don't need to flip.
+      ++pointCount;
     }
   }
-
+  buffers.Points->Modified();
+  buffers.ScalarArray->Modified();
+  buffers.TextureCoords->Modified();
+  m_VertexIdList->Modified();
+
+  //The poly data is only a light-weight container of the buffers. A new one is created for every
+  //frame, so that the output surface recognizes the new frame. It shares the buffers with no other
+  //surface, because InitializeBuffers() never hands out buffers that are still referenced.
   vtkSmartPointer<vtkPolyData> mesh = vtkSmartPointer<vtkPolyData>::New();
-  mesh->SetPoints(points);
-  mesh->SetPolys(polys);
-  mesh->SetVerts(vertices);
+  mesh->SetPoints(buffers.Points);
+  mesh->SetPolys(buffers.Polys);
+  mesh->SetVerts(buffers.Vertices);
   //Pass the scalars to the polydata (if they were set).
-  if (scalarArray->GetNumberOfTuples()>0)
+  if (buffers.ScalarArray->GetNumberOfTuples()>0)
   {
-    mesh->GetPointData()->SetScalars(scalarArray);
+    mesh->GetPointData()->SetScalars(buffers.ScalarArray);
   }
   //Pass the TextureCoords to the polydata anyway (to save them).
-  mesh->GetPointData()->SetTCoords(textureCoords);
+  mesh->GetPointData()->SetTCoords(buffers.TextureCoords);
   output->SetVtkPolyData(mesh);
 }
 
+mitk::ToFDistanceImageToSurfaceFilter::SurfaceBuffers& mitk::ToFDistanceImageToSurfaceFilter::InitializeBuffers(unsigned int size)
+{
+  //Use the other set than the last frame, whose surface is still the output
+  m_CurrentSurfaceBuffers = 1 - m_CurrentSurfaceBuffers;
+  SurfaceBuffers& buffers = m_SurfaceBuffers[m_CurrentSurfaceBuffers];
+
+  //Someone kept the surface of the frame before the last one, so its buffers must not be overwritten
+  bool isReferenced = buffers.Points.GetPointer() != nullptr
+    && (buffers.Points->GetReferenceCount() > 1 || buffers.Polys->GetReferenceCount() > 1
+        || buffers.Vertices->GetReferenceCount() > 1 || buffers.ScalarArray->GetReferenceCount() > 1
+        || buffers.TextureCoords->GetReferenceCount() > 1);
+
+  if (buffers.Points.GetPointer() == nullptr || isReferenced)
+  {
+    buffers.Points = vtkSmartPointer<vtkPoints>::New();
+    buffers.Points->SetDataTypeToDouble();
+    buffers.Polys = vtkSmartPointer<vtkCellArray>::New();
+    buffers.Vertices = vtkSmartPointer<vtkCellArray>::New();
+    buffers.ScalarArray = vtkSmartPointer<vtkFloatArray>::New();
+    buffers.TextureCoords = vtkSmartPointer<vtkFloatArray>::New();
+    buffers.TextureCoords->SetNumberOfComponents(2);
+  }
+  //Reset() keeps the allocated memory
+  buffers.Points->Reset();
+  buffers.Polys->Reset();
+  buffers.Vertices->Reset();
+  buffers.ScalarArray->Reset();
+  buffers.TextureCoords->Reset();
+
+  m_PointsX.resize(size);
+  m_PointsY.resize(size);
+  m_PointsZ.resize(size);
+  m_IsPointValid.resize(size);
+
+  //Make a vtkIdList to save the ID's of the polyData corresponding to the image
+  //pixel ID's. The list is only allocated again if the image size changes.
+  if (m_VertexIdList.GetPointer() == nullptr)
+  {
+    m_VertexIdList = vtkSmartPointer<vtkIdList>::New();
+  }
+  m_VertexIdList->SetNumberOfIds(size);
+  return buffers;
+}
+
 void mitk::ToFDistanceImageToSurfaceFilter::CreateOutputsForAllInputs()
 {
   this->SetNumberOfIndexedOutputs(this->GetNumberOfInputs());  // create outputs for all inputs
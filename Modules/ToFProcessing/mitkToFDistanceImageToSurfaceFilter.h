@@ -17,12 +17,18 @@ found in the LICENSE file.
 #include <mitkSurfaceSource.h>
 #include <MitkToFProcessingExports.h>
 #include <mitkToFProcessingCommon.h>
+#include <mitkToFRayDirectionTable.h>
 #include <mitkCameraIntrinsics.h>
 #include "mitkCameraIntrinsics.h"
 #include <mitkPointSet.h>
 
 #include <vtkSmartPointer.h>
 #include <vtkIdList.h>
+#include <vtkPoints.h>
+#include <vtkCellArray.h>
+#include <vtkFloatArray.h>
+
+#include <vector>
 
 namespace mitk
 {
@@ -38,6 +44,10 @@ namespace mitk
   * The definition of the image plane and its coordinate systems (pixel and mm) is depicted in the following image
   * \image html ../Modules/ToFProcessing/Documentation/ImagePlane.png
   *
+  * The rays through the pixels are computed once (see ToFRayDirectionTable) and the point and cell arrays
+  * of the output are reused for every frame. Therefore the arrays of a surface are overwritten by the next
+  * update of the filter, clone the output if a frame has to be kept.
+  *
   * @ingroup SurfaceFilters
   * @ingroup ToFProcessing
   */
@@ -166,6 +176,24 @@ namespace mitk
     * \warning any additional outputs that exist before the method is called are deleted
     */
     void CreateOutputsForAllInputs();
+    /**
+    * \brief Point and cell buffers of one output surface
+    */
+    struct SurfaceBuffers
+    {
+      vtkSmartPointer<vtkPoints> Points;
+      vtkSmartPointer<vtkCellArray> Polys;
+      vtkSmartPointer<vtkCellArray> Vertices;
+      vtkSmartPointer<vtkFloatArray> ScalarArray;
+      vtkSmartPointer<vtkFloatArray> TextureCoords;
+    };
+    /**
+    * \brief Returns the reset point and cell buffers for a new frame of the given number of pixels
+    *
+    * Two sets of buffers are used alternately, so the surface of the previous frame stays untouched. A set keeps
+    * its memory between frames. It is replaced by a new set if a surface that was handed out still references it.
+    */
+    SurfaceBuffers& InitializeBuffers(unsigned int size);
 
     IplImage* m_IplScalarImage; ///< Scalar image used for surface texturing
 
@@ -184,6 +212,14 @@ namespace mitk
 
     double m_TriangulationThreshold;
 
+    ToFRayDirectionTable m_RayDirectionTable; ///< Rays through the pixels of the distance image, recomputed only if the camera parameters change
+    std::vector<double> m_PointsX; ///< Cartesian coordinates of all pixels of the current frame
+    std::vector<double> m_PointsY;
+    std::vector<double> m_PointsZ;
+    std::vector<unsigned char> m_IsPointValid; ///< Flags of the pixels with a valid distance
+    SurfaceBuffers m_SurfaceBuffers[2]; ///< Buffers of the output surface, used alternately for the frames
+    unsigned int m_CurrentSurfaceBuffers; ///< Index of the buffers of the last frame
+
   };
 } //END mitk namespace
 #endif
@@ -0,0 +1,170 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <mitkToFRayDirectionTable.h>
+
+#include <algorithm>
+#include <cmath>
+
+mitk::ToFRayDirectionTable::ToFRayDirectionTable() :
+  m_Model(PinholeInPixelUnits), m_XDimension(0), m_YDimension(0), m_RayZ(0.0), m_FocalLengthX(1.0), m_FocalLengthY(1.0)
+{
+  std::fill(m_Parameters, m_Parameters + 10, 0.0);
+}
+
+bool mitk::ToFRayDirectionTable::Update(CameraModel model, unsigned int xDimension, unsigned int yDimension, const CameraIntrinsics* cameraIntrinsics,
+  const ToFProcessingCommon::ToFPoint2D& interPixelDistance, const mitk::Point3D& origin, const mitk::Vector3D& spacing)
+{
+  const double parameters[10] = { cameraIntrinsics->GetFocalLengthX(), cameraIntrinsics->GetFocalLengthY(),
+    cameraIntrinsics->GetPrincipalPointX(), cameraIntrinsics->GetPrincipalPointY(),
+    interPixelDistance[0], interPixelDistance[1], origin[0], origin[1], spacing[0], spacing[1] };
+
+  if (model == m_Model && xDimension == m_XDimension && yDimension == m_YDimension
+    && std::equal(parameters, parameters + 10, m_Parameters))
+  {
+    return false;
+  }
+  m_Model = model;
+  m_XDimension = xDimension;
+  m_YDimension = yDimension;
+  std::copy(parameters, parameters + 10, m_Parameters);
+
+  const ToFProcessingCommon::ToFScalarType focalLengthX = parameters[0];
+  const ToFProcessingCommon::ToFScalarType focalLengthY = parameters[1];
+  const ToFProcessingCommon::ToFScalarType principalPointX = parameters[2];
+  const ToFProcessingCommon::ToFScalarType principalPointY = parameters[3];
+  // focal length in mm, as computed by the conversion filters
+  const ToFProcessingCommon::ToFScalarType focalLengthInMm = (focalLengthX*interPixelDistance[0]+focalLengthY*interPixelDistance[1])/2.0;
+
+  // The expressions below are the ones of ToFProcessingCommon, evaluated in the same order to get identical results.
+  // Usually origin will be [0, 0, 0] and spacing will be [1, 1, 1], but the image might be cropped or resampled.
+  m_RayX.resize(xDimension);
+  for (unsigned int i = 0; i < xDimension; ++i)
+  {
+    unsigned int completeIndexX = i*spacing[0]+origin[0];
+    switch (model)
+    {
+    case PinholeInPixelUnits:
+    case Kinect:
+      m_RayX[i] = completeIndexX - principalPointX;
+      break;
+    case PinholeWithInterPixelDistance:
+      m_RayX[i] = (completeIndexX - principalPointX) * interPixelDistance[0];
+      break;
+    }
+  }
+
+  m_RayY.resize(yDimension);
+  for (unsigned int j = 0; j < yDimension; ++j)
+  {
+    unsigned int completeIndexY = j*spacing[1]+origin[1];
+    switch (model)
+    {
+    case PinholeInPixelUnits:
+    {
+      ToFProcessingCommon::ToFScalarType imageY = completeIndexY - principalPointY;
+      m_RayY[j] = imageY * (focalLengthX / focalLengthY);
+      break;
+    }
+    case PinholeWithInterPixelDistance:
+      m_RayY[j] = (completeIndexY - principalPointY) * interPixelDistance[1];
+      break;
+    case Kinect:
+      m_RayY[j] = completeIndexY - principalPointY;
+      break;
+    }
+  }
+
+  m_FocalLengthX = focalLengthX;
+  m_FocalLengthY = focalLengthY;
+  m_RayZ = (model == PinholeWithInterPixelDistance) ? focalLengthInMm : focalLengthX;
+
+  if (model == Kinect)
+  {
+    m_RayLength.clear();
+  }
+  else
+  {
+    m_RayLength.resize(static_cast<std::size_t>(xDimension)*yDimension);
+    for (unsigned int j = 0; j < yDimension; ++j)
+    {
+      double* rayLength = &m_RayLength[static_cast<std::size_t>(j)*xDimension];
+      for (unsigned int i = 0; i < xDimension; ++i)
+      {
+        rayLength[i] = sqrt(m_RayX[i]*m_RayX[i] + m_RayY[j]*m_RayY[j] + m_RayZ*m_RayZ);
+      }
+    }
+  }
+  return true;
+}
+
+unsigned int mitk::ToFRayDirectionTable::ConvertToCartesianCoordinates(const float* distances, double* x, double* y, double* z) const
+{
+  // the inner loops have no branches and no calls so that they are vectorized
+  unsigned int numberOfValidPixels = 0;
+  const double* rayX = m_RayX.data();
+  const double rayZ = m_RayZ;
+  for (unsigned int j = 0; j < m_YDimension; ++j)
+  {
+    const std::size_t rowOffset = static_cast<std::size_t>(j)*m_XDimension;
+    const float* distanceRow = distances + rowOffset;
+    double* xRow = x + rowOffset;
+    double* yRow = y + rowOffset;
+    double* zRow = z + rowOffset;
+    const double rayY = m_RayY[j];
+
+    if (m_Model == Kinect)
+    {
+      const double focalLengthX = m_FocalLengthX;
+      const double focalLengthY = m_FocalLengthY;
+      for (unsigned int i = 0; i < m_XDimension; ++i)
+      {
+        const double distance = distanceRow[i];
+        xRow[i] = distance * rayX[i] / focalLengthX;
+        yRow[i] = distance * rayY / focalLengthY;
+        zRow[i] = distance;
+      }
+    }
+    else
+    {
+      const double* rayLength = m_RayLength.data() + rowOffset;
+      for (unsigned int i = 0; i < m_XDimension; ++i)
+      {
+        const double distance = distanceRow[i];
+        xRow[i] = distance * rayX[i] / rayLength[i];
+        yRow[i] = distance * rayY / rayLength[i];
+        zRow[i] = distance * rayZ / rayLength[i];
+      }
+    }
+
+    for (unsigned int i = 0; i < m_XDimension; ++i)
+    {
+      numberOfValidPixels += (distanceRow[i] <= mitk::eps) ? 0 : 1;
+    }
+  }
+  return numberOfValidPixels;
+}
+
+unsigned int mitk::ToFRayDirectionTable::GetXDimension() const
+{
+  return m_XDimension;
+}
+
+unsigned int mitk::ToFRayDirectionTable::GetYDimension() const
+{
+  return m_YDimension;
+}
+
+unsigned int mitk::ToFRayDirectionTable::GetNumberOfPixels() const
+{
+  return m_XDimension*m_YDimension;
+}
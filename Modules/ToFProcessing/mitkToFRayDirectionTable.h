@@ -0,0 +1,92 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef MITKTOFRAYDIRECTIONTABLE_H
+#define MITKTOFRAYDIRECTIONTABLE_H
+
+#include <MitkToFProcessingExports.h>
+#include <mitkCameraIntrinsics.h>
+#include <mitkToFProcessingCommon.h>
+
+#include <vector>
+
+namespace mitk
+{
+  /**
+  * @brief Precomputed per-pixel rays for converting complete ToF distance images to cartesian coordinates.
+  *
+  * The conversion functions of ToFProcessingCommon compute the ray through a pixel (including a square root)
+  * for every pixel of every frame, although the ray only depends on the camera parameters and the pixel index.
+  * This table computes the rays once with the same formulas and then only scales them with the measured distance,
+  * which is a single loop over the image that the compiler can vectorize. The results are identical to
+  * IndexToCartesianCoordinates(), IndexToCartesianCoordinatesWithInterpixdist() and KinectIndexToCartesianCoordinates().
+  *
+  * Update() has to be called before each conversion, it only recomputes the table if a parameter changed.
+  *
+  * @ingroup ToFProcessing
+  */
+  class MITKTOFPROCESSING_EXPORT ToFRayDirectionTable
+  {
+  public:
+    /**
+    * @brief Camera model used for the conversion, see ToFProcessingCommon
+    */
+    enum CameraModel
+    {
+      PinholeInPixelUnits,           ///< IndexToCartesianCoordinates()
+      PinholeWithInterPixelDistance, ///< IndexToCartesianCoordinatesWithInterpixdist()
+      Kinect                         ///< KinectIndexToCartesianCoordinates()
+    };
+
+    ToFRayDirectionTable();
+
+    /*!
+    \brief Recomputes the rays if the image size or one of the camera parameters changed.
+    \param model camera model of the conversion
+    \param xDimension x-dimension of the distance image
+    \param yDimension y-dimension of the distance image
+    \param cameraIntrinsics focal length and principal point of the camera
+    \param interPixelDistance distance in mm between two adjacent pixels, only used for PinholeWithInterPixelDistance
+    \param origin origin of the distance image, used to compute the index of cropped images
+    \param spacing spacing of the distance image, used to compute the index of resampled images
+    \return true if the table was recomputed
+    */
+    bool Update(CameraModel model, unsigned int xDimension, unsigned int yDimension, const CameraIntrinsics* cameraIntrinsics,
+      const ToFProcessingCommon::ToFPoint2D& interPixelDistance, const mitk::Point3D& origin, const mitk::Vector3D& spacing);
+
+    /*!
+    \brief Converts all pixels of a distance image to cartesian coordinates.
+    \param distances distance image of xDimension*yDimension pixels
+    \param x,y,z output coordinates, xDimension*yDimension values each
+    \return number of valid pixels, i.e. pixels whose distance is not <= mitk::eps
+    */
+    unsigned int ConvertToCartesianCoordinates(const float* distances, double* x, double* y, double* z) const;
+
+    unsigned int GetXDimension() const;
+    unsigned int GetYDimension() const;
+    unsigned int GetNumberOfPixels() const;
+
+  private:
+    CameraModel m_Model;
+    unsigned int m_XDimension;
+    unsigned int m_YDimension;
+    double m_Parameters[10]; ///< parameters the table was computed for
+
+    std::vector<double> m_RayX; ///< x-component of the ray per column
+    std::vector<double> m_RayY; ///< y-component of the ray per row
+    double m_RayZ; ///< z-component of the ray
+    std::vector<double> m_RayLength; ///< length of the ray per pixel, not used by the Kinect model
+    double m_FocalLengthX; ///< divisors of the Kinect model
+    double m_FocalLengthY;
+  };
+} //END mitk namespace
+#endif
@@ -13,6 +13,79 @@ found in the LICENSE file.
 #include "mitkUSVideoDevice.h"
 #include "mitkUSProbe.h"
 #include "mitkTestingMacros.h"
+#include "mitkImageReadAccessor.h"
+#include "mitkImageWriteAccessor.h"
+
+#include <cstring>
+
+namespace mitk
+{
+  /**
+  * \brief Image source which returns the same image for every frame, filled with the number of the frame.
+  * Reusing the image like a hardware source does makes sure that the device copies the frames.
+  */
+  class FakeUSImageSource : public USImageSource
+  {
+  public:
+    mitkClassMacro(FakeUSImageSource, USImageSource);
+    itkFactorylessNewMacro(Self);
+
+  protected:
+    FakeUSImageSource() : m_NumberOfFrames(0)
+    {
+      unsigned int dimensions[2] = { 8, 4 };
+      m_Image = mitk::Image::New();
+      m_Image->Initialize(mitk::MakeScalarPixelType<unsigned char>(), 2, dimensions);
+    }
+
+    using Superclass::GetNextRawImage;
+
+    void GetNextRawImage(std::vector<mitk::Image::Pointer>& imageVector) override
+    {
+      ++m_NumberOfFrames;
+      mitk::ImageWriteAccessor writeAccessor(m_Image);
+      std::memset(writeAccessor.GetData(), m_NumberOfFrames, 8 * 4);
+
+      imageVector.resize(1);
+      imageVector[0] = m_Image;
+    }
+
+  private:
+    mitk::Image::Pointer m_Image;
+    unsigned char m_NumberOfFrames;
+  };
+
+  /**
+  * \brief Device without hardware, images are acquired by calling GrabImage() directly.
+  */
+  class FakeUSDevice : public USDevice
+  {
+  public:
+    mitkClassMacro(FakeUSDevice, USDevice);
+    mitkNewMacro2Param(Self, std::string, std::string);
+
+    std::string GetDeviceClass() override { return "org.mitk.modules.us.FakeUSDevice"; }
+    USImageSource::Pointer GetUSImageSource() override { return m_ImageSource.GetPointer(); }
+    std::vector<mitk::USProbe::Pointer> GetAllProbes() override { return std::vector<mitk::USProbe::Pointer>(); }
+    mitk::USProbe::Pointer GetCurrentProbe() override { return nullptr; }
+    mitk::USProbe::Pointer GetProbeByName(std::string) override { return nullptr; }
+
+  protected:
+    FakeUSDevice(std::string manufacturer, std::string model)
+      : USDevice(manufacturer, model), m_ImageSource(FakeUSImageSource::New())
+    {
+    }
+
+    bool OnInitialization() override { return true; }
+    bool OnConnection() override { return true; }
+    bool OnDisconnection() override { return true; }
+    bool OnActivation() override { return true; }
+    bool OnDeactivation() override { return true; }
+
+  private:
+    FakeUSImageSource::Pointer m_ImageSource;
+  };
+}
 
 class mitkUSDeviceTestClass
 {
@@ -32,6 +105,68 @@ public:
   {
   }
 
+  static void TestFrameStatistics()
+  {
+    mitk::USVideoDevice::Pointer device = mitk::USVideoDevice::New("IllegalPath", "Manufacturer", "Model");
+    mitk::USDevice::FrameStatistics statistics = device->GetFrameStatistics();
+    MITK_TEST_CONDITION(statistics.AcquiredFrames == 0 && statistics.DeliveredFrames == 0 && statistics.DroppedFrames == 0,
+      "Frame counters should be zero after instantiation");
+
+    // nothing was acquired, so the outputs must not be touched
+    device->Update();
+    MITK_TEST_CONDITION(!device->GetOutput(0)->IsInitialized(), "Output should stay empty without acquired frames");
+    MITK_TEST_CONDITION(device->GetFrameStatistics().DeliveredFrames == 0, "No frame should be delivered without acquired frames");
+  }
+
+  static unsigned char GetFirstPixel(mitk::Image* image)
+  {
+    mitk::ImageReadAccessor readAccessor(image);
+    return *static_cast<const unsigned char*>(readAccessor.GetData());
+  }
+
+  static void TestFrameDelivery()
+  {
+    mitk::FakeUSDevice::Pointer device = mitk::FakeUSDevice::New("Manufacturer", "Model");
+
+    device->GrabImage();
+    device->Update();
+    mitk::Image::Pointer output = device->GetOutput(0);
+    MITK_TEST_CONDITION_REQUIRED(output->IsInitialized(), "Output should be initialized after the first frame");
+    MITK_TEST_CONDITION(GetFirstPixel(output) == 1, "Output should contain the first frame");
+    MITK_TEST_CONDITION(device->GetFrameStatistics().AcquiredFrames == 1 && device->GetFrameStatistics().DeliveredFrames == 1,
+      "First frame should be acquired and delivered");
+
+    // two frames without an update: the first of them is replaced by the second one before it is delivered
+    device->GrabImage();
+    device->GrabImage();
+    mitk::USDevice::FrameStatistics statistics = device->GetFrameStatistics();
+    MITK_TEST_CONDITION(statistics.AcquiredFrames == 3, "Three frames should be acquired");
+    MITK_TEST_CONDITION(statistics.DroppedFrames == 1, "Frame which was replaced before the update should be counted as dropped");
+    MITK_TEST_CONDITION(statistics.DeliveredFrames == 1, "No frame should be delivered without an update");
+    MITK_TEST_CONDITION(GetFirstPixel(output) == 1, "Frame referenced by the output must not be overwritten by the acquisition");
+
+    device->Update();
+    MITK_TEST_CONDITION(GetFirstPixel(device->GetOutput(0)) == 3, "Output should contain the latest frame after the update");
+    statistics = device->GetFrameStatistics();
+    MITK_TEST_CONDITION(statistics.DeliveredFrames == 2 && statistics.DroppedFrames == 1, "Latest frame should be delivered");
+
+    // further acquisitions must neither touch the delivered frame nor count frames which were delivered as dropped
+    for (unsigned int i = 0; i < 5; ++i)
+    {
+      device->GrabImage();
+      MITK_TEST_CONDITION(GetFirstPixel(device->GetOutput(0)) == 3 + i, "Delivered frame must not be overwritten");
+      device->Update();
+    }
+    statistics = device->GetFrameStatistics();
+    MITK_TEST_CONDITION(statistics.AcquiredFrames == 8 && statistics.DeliveredFrames == 7 && statistics.DroppedFrames == 1,
+      "Every frame followed by an update should be delivered");
+
+    device->ResetFrameStatistics();
+    statistics = device->GetFrameStatistics();
+    MITK_TEST_CONDITION(statistics.AcquiredFrames == 0 && statistics.DeliveredFrames == 0 && statistics.DroppedFrames == 0,
+      "Frame counters should be zero after a reset");
+  }
+
   static void TestActivateProbe()
   {
   }
@@ -46,6 +181,8 @@ int mitkUSDeviceTest(int /* argc */, char* /*argv*/[])
 
   mitkUSDeviceTestClass::TestInstantiation();
   mitkUSDeviceTestClass::TestAddProbe();
+  mitkUSDeviceTestClass::TestFrameStatistics();
+  mitkUSDeviceTestClass::TestFrameDelivery();
   mitkUSDeviceTestClass::TestActivateProbe();
 
   MITK_TEST_END();
@@ -13,6 +13,8 @@ found in the LICENSE file.
 #include "mitkUSDevice.h"
 #include "mitkImageReadAccessor.h"
 
+#include <algorithm>
+
 // US Control Interfaces
 #include "mitkUSControlInterfaceProbes.h"
 #include "mitkUSControlInterfaceBMode.h"
@@ -24,6 +26,25 @@ found in the LICENSE file.
 #include <usServiceProperties.h>
 #include <usModuleContext.h>
 
+const unsigned int mitk::USDevice::NewFrameFlag;
+
+namespace
+{
+  bool IsValidImage(const mitk::Image* image)
+  {
+    return image != nullptr && image->IsInitialized();
+  }
+
+  bool HasSameLayout(const mitk::Image* image, const mitk::Image* other)
+  {
+    return image->IsInitialized() &&
+      image->GetDimension(0) == other->GetDimension(0) &&
+      image->GetDimension(1) == other->GetDimension(1) &&
+      image->GetDimension(2) == other->GetDimension(2) &&
+      image->GetPixelType() == other->GetPixelType();
+  }
+}
+
 mitk::USDevice::PropertyKeys mitk::USDevice::GetPropertyKeys()
 {
   static mitk::USDevice::PropertyKeys propertyKeys;
@@ -51,6 +72,17 @@ mitk::USDevice::USDevice(std::string manufacturer, std::string model)
   m_ImageMutex(itk::FastMutexLock::New()),
   m_ThreadID(-1),
   m_ImageVector(),
+  m_FramePool(4),
+  m_PublishedFrame(0),
+  m_AcquisitionFrame(1),
+  m_OutputFrame(2),
+  m_SpareFrame(3),
+  m_NumberOfAcquiredFrames(0),
+  m_NumberOfDroppedFrames(0),
+  m_NumberOfDeliveredFrames(0),
+  m_SumOfLatencies(0),
+  m_LastLatency(0),
+  m_MaximumLatency(0),
   m_Spacing(),
   m_IGTLServer(nullptr),
   m_IGTLMessageProvider(nullptr),
@@ -89,6 +121,17 @@ mitk::USDevice::USDevice(mitk::USImageMetadata::Pointer metadata)
   m_ImageMutex(itk::FastMutexLock::New()),
   m_ThreadID(-1),
   m_ImageVector(),
+  m_FramePool(4),
+  m_PublishedFrame(0),
+  m_AcquisitionFrame(1),
+  m_OutputFrame(2),
+  m_SpareFrame(3),
+  m_NumberOfAcquiredFrames(0),
+  m_NumberOfDroppedFrames(0),
+  m_NumberOfDeliveredFrames(0),
+  m_SumOfLatencies(0),
+  m_LastLatency(0),
+  m_MaximumLatency(0),
   m_Spacing(),
   m_IGTLServer(nullptr),
   m_IGTLMessageProvider(nullptr),
@@ -568,10 +611,63 @@ output->Graft( graft );
 
 void mitk::USDevice::GrabImage()
 {
-  std::vector<mitk::Image::Pointer> image = this->GetUSImageSource()->GetNextImage();
-  m_ImageMutex->Lock();
-  this->SetImageVector(image);
-  m_ImageMutex->Unlock();
+  std::vector<mitk::Image::Pointer> images = this->GetUSImageSource()->GetNextImage();
+
+  // copy the images into the preallocated images of the frame, the source may reuse its images
+  Frame& frame = m_FramePool[m_AcquisitionFrame];
+  frame.Images.resize(images.size());
+  for (std::size_t i = 0; i < images.size(); ++i)
+  {
+    if (!IsValidImage(images[i]))
+    {
+      frame.Images[i] = nullptr;
+      continue;
+    }
+
+    mitk::Image::Pointer& frameImage = frame.Images[i];
+    if (frameImage.IsNull() || !HasSameLayout(frameImage, images[i]))
+    {
+      frameImage = mitk::Image::New();
+      frameImage->Initialize(images[i]->GetPixelType(), images[i]->GetDimension(), images[i]->GetDimensions());
+    }
+    mitk::ImageReadAccessor inputReadAccessor(images[i]);
+    frameImage->SetImportVolume(inputReadAccessor.GetData());
+    frameImage->SetGeometry(images[i]->GetGeometry());
+  }
+  frame.AcquisitionTime = std::chrono::steady_clock::now();
+
+  // publish the frame by exchanging it with the previously published one
+  unsigned int previous = m_PublishedFrame.exchange(m_AcquisitionFrame | NewFrameFlag);
+  if ((previous & NewFrameFlag) != 0)
+  {
+    ++m_NumberOfDroppedFrames;
+  }
+  m_AcquisitionFrame = previous & ~NewFrameFlag;
+  ++m_NumberOfAcquiredFrames;
+
+  this->Modified(); // the outputs need to be updated
+}
+
+mitk::USDevice::FrameStatistics mitk::USDevice::GetFrameStatistics() const
+{
+  FrameStatistics statistics;
+  statistics.AcquiredFrames = m_NumberOfAcquiredFrames;
+  statistics.DeliveredFrames = m_NumberOfDeliveredFrames;
+  statistics.DroppedFrames = m_NumberOfDroppedFrames;
+  statistics.LastLatency = m_LastLatency;
+  statistics.MeanLatency = m_NumberOfDeliveredFrames > 0 ? m_SumOfLatencies / m_NumberOfDeliveredFrames : 0.0;
+  statistics.MaximumLatency = m_MaximumLatency;
+  return statistics;
+}
+
+void mitk::USDevice::ResetFrameStatistics()
+{
+  m_NumberOfAcquiredFrames = 0;
+  m_NumberOfDroppedFrames = 0;
+  m_NumberOfDeliveredFrames = 0;
+  m_SumOfLatencies = 0;
+  m_LastLatency = 0;
+  m_MaximumLatency = 0;
 }
 
 //########### GETTER & SETTER ##################//
@@ -618,36 +714,52 @@ void mitk::USDevice::SetSpacing(double xSpacing, double ySpacing)
 
 void mitk::USDevice::GenerateData()
 {
-  m_ImageMutex->Lock();
+  if ((m_PublishedFrame.load() & NewFrameFlag) == 0)
+  {
+    return; // no new frame, the outputs still reference the current one
+  }
+
+  // take the published frame; the spare frame goes to the acquisition thread as no output references it
+  const unsigned int published = m_PublishedFrame.exchange(m_SpareFrame) & ~NewFrameFlag;
+  const Frame& frame = m_FramePool[published];
+  const Frame& previousFrame = m_FramePool[m_OutputFrame];
 
-  for (unsigned int i = 0; i < m_ImageVector.size() && i < this->GetNumberOfIndexedOutputs(); ++i)
+  for (unsigned int i = 0; i < this->GetNumberOfIndexedOutputs(); ++i)
   {
-    auto& image = m_ImageVector[i];
-    if (image.IsNull() || !image->IsInitialized())
+    mitk::Image::Pointer output = this->GetOutput(i);
+    if (i < frame.Images.size() && IsValidImage(frame.Images[i]))
     {
-      // skip image
-    }
-    else
-    {
-      mitk::Image::Pointer output = this->GetOutput(i);
-
-      if (!output->IsInitialized() ||
-        output->GetDimension(0) != image->GetDimension(0) ||
-        output->GetDimension(1) != image->GetDimension(1) ||
-        output->GetDimension(2) != image->GetDimension(2) ||
-        output->GetPixelType() != image->GetPixelType())
+      const mitk::Image::Pointer& image = frame.Images[i];
+      if (!HasSameLayout(output, image))
       {
-        output->Initialize(image->GetPixelType(), image->GetDimension(),
-          image->GetDimensions());
+        output->Initialize(image->GetPixelType(), image->GetDimension(), image->GetDimensions());
       }
 
-      // copy contents of the given image into the member variable
+      // reference the memory of the frame instead of copying it
       mitk::ImageReadAccessor inputReadAccessor(image);
-      output->SetImportVolume(inputReadAccessor.GetData());
+      output->SetImportVolume(const_cast<void*>(inputReadAccessor.GetData()), 0, 0, mitk::Image::ReferenceMemory);
       output->SetGeometry(image->GetGeometry());
     }
+    else if (i < previousFrame.Images.size() && IsValidImage(previousFrame.Images[i]))
+    {
+      // keep the last image of this output, the previous frame will be reused by the acquisition thread
+      mitk::ImageReadAccessor inputReadAccessor(previousFrame.Images[i]);
+      output->SetImportVolume(inputReadAccessor.GetData());
+    }
   }
+
+  m_SpareFrame = m_OutputFrame;
+  m_OutputFrame = published;
+
+  m_ImageMutex->Lock();
+  m_ImageVector = frame.Images;
   m_ImageMutex->Unlock();
+
+  const double latency = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frame.AcquisitionTime).count();
+  ++m_NumberOfDeliveredFrames;
+  m_SumOfLatencies += latency;
+  m_LastLatency = latency;
+  m_MaximumLatency = std::max(m_MaximumLatency, latency);
 };
 
 std::string mitk::USDevice::GetServicePropertyLabel()
@@ -14,6 +14,8 @@ found in the LICENSE file.
 #define MITKUSDevice_H_HEADER_INCLUDED_
 
 // STL
+#include <atomic>
+#include <chrono>
 #include <vector>
 
 // MitkUS
@@ -312,8 +314,34 @@ namespace mitk {
 
     itkGetMacro(ServiceProperties, us::ServiceProperties);
 
+    /**
+    * \brief Takes the next images from the image source and publishes them for the outputs.
+    *
+    * Called by the acquisition thread. The images are copied into a preallocated frame of the
+    * frame pool, which is then exchanged with the published frame. If the published frame was
+    * not delivered to the outputs yet, it is replaced and counted as dropped.
+    */
     void GrabImage();
 
+    /**
+    * \brief Counters of the frame delivery from the acquisition thread to the outputs.
+    * Latencies are in milliseconds from the end of GrabImage() to the update of the outputs.
+    */
+    struct FrameStatistics
+    {
+      unsigned long AcquiredFrames;
+      unsigned long DeliveredFrames;
+      unsigned long DroppedFrames;
+      double LastLatency;
+      double MeanLatency;
+      double MaximumLatency;
+    };
+
+    /** \brief Returns the frame statistics, call it from the thread that updates the outputs. */
+    FrameStatistics GetFrameStatistics() const;
+
+    void ResetFrameStatistics();
+
     /**
     * \brief Returns all probes for this device or an empty vector it no probes were set
     * Returns a std::vector of all probes that exist for this device if there were probes set while creating or modifying this USVideoDevice.
@@ -383,8 +411,37 @@ namespace mitk {
     static ITK_THREAD_RETURN_TYPE Acquire(void* pInfoStruct);
     static ITK_THREAD_RETURN_TYPE ConnectThread(void* pInfoStruct);
 
+    /**
+    * \brief The images currently delivered by the outputs. The outputs reference the memory of
+    * these images, which is not written by the acquisition thread until the next frame is delivered.
+    */
     std::vector<mitk::Image::Pointer> m_ImageVector;
 
+    /** \brief Images of one acquisition, kept for reuse in the frame pool */
+    struct Frame
+    {
+      std::vector<mitk::Image::Pointer> Images;
+      std::chrono::steady_clock::time_point AcquisitionTime;
+    };
+
+    /**
+    * \brief Frame pool of four frames: one is filled by the acquisition thread, one is published,
+    * one is referenced by the outputs and one is kept until no output references it anymore.
+    */
+    std::vector<Frame> m_FramePool;
+    std::atomic<unsigned int> m_PublishedFrame; ///< index of the published frame, NewFrameFlag is set until the outputs take it
+    unsigned int m_AcquisitionFrame;            ///< frame written by the acquisition thread
+    unsigned int m_OutputFrame;                 ///< frame referenced by the outputs
+    unsigned int m_SpareFrame;                  ///< frame that is handed back to the acquisition thread with the next delivery
+    static const unsigned int NewFrameFlag = 0x80000000;
+
+    std::atomic<unsigned long> m_NumberOfAcquiredFrames;
+    std::atomic<unsigned long> m_NumberOfDroppedFrames;
+    unsigned long m_NumberOfDeliveredFrames;
+    double m_SumOfLatencies;
+    double m_LastLatency;
+    double m_MaximumLatency;
+
     // Variables to determine if spacing was calibrated and needs to be applied to the incoming images
     mitk::Vector3D m_Spacing;
 
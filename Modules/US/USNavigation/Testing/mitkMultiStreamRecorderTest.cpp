@@ -0,0 +1,296 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <mitkTestingMacros.h>
+#include "mitkMultiStreamRecorder.h"
+#include "mitkMultiStreamRecordingReader.h"
+#include "mitkUSRecordingImageSource.h"
+
+#include <mitkIOUtil.h>
+#include <mitkImageReadAccessor.h>
+#include <mitkImageWriteAccessor.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <thread>
+
+class mitkMultiStreamRecorderTestClass
+{
+public:
+
+  static const unsigned int NumberOfNavigationDatas = 100;
+  static const unsigned int NumberOfImages = 20;
+
+  /*
+  * \brief Creates a 2D image of 10x8 pixels with all pixels set to the value.
+  */
+  static mitk::Image::Pointer CreateImage(unsigned char value)
+  {
+    unsigned int dimensions[2] = { 10, 8 };
+    mitk::Image::Pointer image = mitk::Image::New();
+    image->Initialize(mitk::MakeScalarPixelType<unsigned char>(), 2, dimensions);
+    mitk::Vector3D spacing;
+    mitk::FillVector3D(spacing, 0.5, 0.25, 1.0);
+    image->GetGeometry()->SetSpacing(spacing);
+
+    mitk::ImageWriteAccessor accessor(image);
+    auto* pixels = static_cast<unsigned char*>(accessor.GetData());
+    std::fill(pixels, pixels + 80, value);
+    return image;
+  }
+
+  /*
+  * \brief Records navigation data of two tools by a second thread and images, returns the file name.
+  */
+  static std::string TestRecording()
+  {
+    mitk::MultiStreamRecorder::Pointer recorder = mitk::MultiStreamRecorder::New();
+    recorder->SetQueueSize(256);
+    std::vector<std::string> toolNames = { "tool0", "tool1" };
+    unsigned int navigationStream = recorder->AddNavigationDataStream("tracking", toolNames);
+    unsigned int imageStream = recorder->AddImageStream("ultrasound");
+    MITK_TEST_CONDITION_REQUIRED(recorder->GetNumberOfStreams() == 2 && navigationStream == 0 && imageStream == 1, "Adding two streams.");
+
+    std::string fileName = mitk::IOUtil::CreateTemporaryFile("MultiStreamRecorderTest_XXXXXX.msr");
+    recorder->StartRecording(fileName);
+    MITK_TEST_CONDITION_REQUIRED(recorder->IsRecording(), "Recorder is recording.");
+
+    bool exceptionThrown = false;
+    try
+    {
+      recorder->AddImageStream("video");
+    }
+    catch (const mitk::Exception&)
+    {
+      exceptionThrown = true;
+    }
+    MITK_TEST_CONDITION(exceptionThrown, "Streams cannot be added while recording.");
+
+    std::thread trackingThread([recorder, navigationStream]() {
+      std::vector<mitk::NavigationData::Pointer> navigationDatas = { mitk::NavigationData::New(), mitk::NavigationData::New() };
+      for (unsigned int i = 0; i < NumberOfNavigationDatas; ++i)
+      {
+        mitk::NavigationData::PositionType position;
+        mitk::FillVector3D(position, i, 0.0, 0.0);
+        navigationDatas[0]->SetPosition(position);
+        navigationDatas[0]->SetDataValid(true);
+        mitk::FillVector3D(position, 0.0, i, 0.0);
+        navigationDatas[1]->SetPosition(position);
+        navigationDatas[1]->SetDataValid(i % 2 == 0);
+        recorder->RecordNavigationData(navigationStream, navigationDatas);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+    });
+    for (unsigned int i = 0; i < NumberOfImages; ++i)
+    {
+      recorder->RecordImage(imageStream, CreateImage(i));
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    trackingThread.join();
+    recorder->StopRecording();
+
+    MITK_TEST_CONDITION_REQUIRED(!recorder->IsRecording(), "Recorder stopped.");
+    MITK_TEST_CONDITION_REQUIRED(recorder->GetNumberOfRecordedSamples(navigationStream) == NumberOfNavigationDatas
+      && recorder->GetNumberOfDroppedSamples(navigationStream) == 0, "All navigation datas were recorded.");
+    MITK_TEST_CONDITION_REQUIRED(recorder->GetNumberOfRecordedSamples(imageStream) == NumberOfImages
+      && recorder->GetNumberOfDroppedSamples(imageStream) == 0, "All images were recorded.");
+    return fileName;
+  }
+
+  static void TestReading(const std::string& fileName)
+  {
+    mitk::MultiStreamRecordingReader::Pointer reader = mitk::MultiStreamRecordingReader::New();
+    reader->Open(fileName);
+    MITK_TEST_CONDITION_REQUIRED(reader->IsOpen() && !reader->IsIndexRecovered(), "Opening the recording.");
+    MITK_TEST_CONDITION_REQUIRED(reader->GetNumberOfStreams() == 2, "Recording has two streams.");
+    MITK_TEST_CONDITION_REQUIRED(reader->GetStreamIndex("ultrasound") == 1 && reader->GetStreamName(0) == "tracking", "Testing the stream names.");
+    MITK_TEST_CONDITION_REQUIRED(reader->GetStreamType(0) == mitk::MultiStreamRecorder::NavigationDataStream
+      && reader->GetStreamType(1) == mitk::MultiStreamRecorder::ImageStream, "Testing the stream types.");
+    MITK_TEST_CONDITION_REQUIRED(reader->GetToolNames(0).size() == 2 && reader->GetToolNames(0)[1] == "tool1", "Testing the tool names.");
+    MITK_TEST_CONDITION_REQUIRED(reader->GetNumberOfSamples(0) == NumberOfNavigationDatas
+      && reader->GetNumberOfSamples(1) == NumberOfImages, "Testing the number of samples.");
+
+    // navigation data
+    bool valuesEqual = true;
+    bool timeStampsIncrease = true;
+    std::vector<mitk::NavigationData::Pointer> navigationDatas;
+    for (unsigned int i = 0; i < NumberOfNavigationDatas; ++i)
+    {
+      reader->ReadNavigationData(0, i, navigationDatas);
+      valuesEqual = valuesEqual && navigationDatas.size() == 2
+        && navigationDatas[0]->GetPosition()[0] == i && navigationDatas[1]->GetPosition()[1] == i
+        && navigationDatas[0]->IsDataValid() && navigationDatas[1]->IsDataValid() == (i % 2 == 0)
+        && navigationDatas[1]->GetName() == std::string("tool1")
+        && navigationDatas[0]->GetIGTTimeStamp() == reader->GetTimeStamp(0, i);
+      if (i > 0)
+        timeStampsIncrease = timeStampsIncrease && reader->GetTimeStamp(0, i) >= reader->GetTimeStamp(0, i - 1);
+    }
+    MITK_TEST_CONDITION(valuesEqual, "Testing the recorded navigation datas.");
+    MITK_TEST_CONDITION(timeStampsIncrease, "Testing the order of the time stamps.");
+    MITK_TEST_CONDITION(reader->ReadNavigationDataSet(0)->Size() == NumberOfNavigationDatas, "Reading the navigation data set.");
+
+    // images
+    valuesEqual = true;
+    for (unsigned int i = 0; i < NumberOfImages; ++i)
+    {
+      mitk::Image::Pointer image = reader->ReadImage(1, i);
+      mitk::ImageReadAccessor accessor(image);
+      const auto* pixels = static_cast<const unsigned char*>(accessor.GetData());
+      valuesEqual = valuesEqual && image->GetDimension() == 2 && image->GetDimension(0) == 10 && image->GetDimension(1) == 8
+        && image->GetPixelType() == mitk::MakeScalarPixelType<unsigned char>()
+        && image->GetGeometry()->GetSpacing()[1] == 0.25
+        && std::count(pixels, pixels + 80, static_cast<unsigned char>(i)) == 80;
+    }
+    MITK_TEST_CONDITION(valuesEqual, "Testing the recorded images.");
+
+    // random access by time
+    MITK_TEST_CONDITION(reader->FindSample(1, reader->GetTimeStamp(1, 0) - 100.0) == 0, "Finding a sample before the recording.");
+    MITK_TEST_CONDITION(reader->FindSample(1, reader->GetTimeStamp(1, 7)) == 7, "Finding a sample by its time stamp.");
+    MITK_TEST_CONDITION(reader->FindSample(1, reader->GetTimeStamp(1, NumberOfImages - 1) + 100.0) == static_cast<int>(NumberOfImages) - 1,
+      "Finding a sample after the recording.");
+    const double timeStamp = reader->GetTimeStamp(1, 12);
+    const int navigationDataIndex = reader->FindSample(0, timeStamp);
+    MITK_TEST_CONDITION(reader->GetTimeStamp(0, navigationDataIndex) <= timeStamp
+      && (navigationDataIndex + 1 == static_cast<int>(NumberOfNavigationDatas) || reader->GetTimeStamp(0, navigationDataIndex + 1) > timeStamp),
+      "Finding the navigation data recorded with an image.");
+
+    bool exceptionThrown = false;
+    try
+    {
+      reader->ReadImage(0, 0);
+    }
+    catch (const mitk::Exception&)
+    {
+      exceptionThrown = true;
+    }
+    MITK_TEST_CONDITION(exceptionThrown, "Reading an image of a navigation data stream throws.");
+  }
+
+  static void TestImageSource(const std::string& fileName)
+  {
+    mitk::MultiStreamRecordingReader::Pointer reader = mitk::MultiStreamRecordingReader::New();
+    reader->Open(fileName);
+
+    mitk::USRecordingImageSource::Pointer imageSource = mitk::USRecordingImageSource::New();
+    imageSource->SetRecording(reader, 1);
+    MITK_TEST_CONDITION(imageSource->GetNextImage()[0].IsNull(), "No image before playing.");
+
+    imageSource->StartPlaying();
+    imageSource->Pause();
+    imageSource->Seek(reader->GetTimeStamp(1, 10) - reader->GetTimeStamp(1, 0));
+    std::vector<mitk::Image::Pointer> images = imageSource->GetNextImage();
+    MITK_TEST_CONDITION_REQUIRED(images.size() == 1 && images[0].IsNotNull(), "Image source returns an image.");
+    mitk::ImageReadAccessor accessor(images[0]);
+    MITK_TEST_CONDITION(imageSource->GetCurrentSampleIndex() == 10 && *static_cast<const unsigned char*>(accessor.GetData()) == 10,
+      "Seeking to an image of the recording.");
+
+    imageSource->Seek(100000.0);
+    imageSource->Resume();
+    imageSource->GetNextImage();
+    MITK_TEST_CONDITION(imageSource->GetCurrentSampleIndex() == static_cast<int>(NumberOfImages) - 1
+      && imageSource->GetCurrentPlayerState() == mitk::USRecordingImageSource::PlayerStopped, "Player stops after the last image.");
+  }
+
+  /*
+  * \brief Starts and stops the recording while another thread keeps recording images.
+  */
+  static void TestStartStopWhileRecording()
+  {
+    mitk::MultiStreamRecorder::Pointer recorder = mitk::MultiStreamRecorder::New();
+    unsigned int imageStream = recorder->AddImageStream("ultrasound");
+
+    bool exceptionThrown = false;
+    try
+    {
+      unsigned int dimensions[4] = { 2, 2, 2, 2 };
+      mitk::Image::Pointer image = mitk::Image::New();
+      image->Initialize(mitk::MakeScalarPixelType<unsigned char>(), 4, dimensions);
+      recorder->RecordImage(imageStream, image);
+    }
+    catch (const mitk::Exception&)
+    {
+      exceptionThrown = true;
+    }
+    MITK_TEST_CONDITION(exceptionThrown, "Images with a time dimension cannot be recorded.");
+
+    std::atomic<bool> stop(false);
+    std::thread imageThread([recorder, imageStream, &stop]() {
+      mitk::Image::Pointer image = CreateImage(1);
+      while (!stop)
+        recorder->RecordImage(imageStream, image);
+    });
+
+    std::string fileName = mitk::IOUtil::CreateTemporaryFile("MultiStreamRecorderTest_XXXXXX.msr");
+    bool complete = true;
+    for (int i = 0; i < 5; ++i)
+    {
+      recorder->StartRecording(fileName);
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      recorder->StopRecording();
+
+      mitk::MultiStreamRecordingReader::Pointer reader = mitk::MultiStreamRecordingReader::New();
+      reader->Open(fileName);
+      complete = complete && reader->IsOpen() && !reader->IsIndexRecovered()
+        && reader->GetNumberOfSamples(imageStream) == recorder->GetNumberOfRecordedSamples(imageStream);
+      reader->Close();
+    }
+    stop = true;
+    imageThread.join();
+    std::remove(fileName.c_str());
+    MITK_TEST_CONDITION(complete, "Every recording contains all samples accepted until it was stopped.");
+  }
+
+  static void TestIndexRecovery(const std::string& fileName)
+  {
+    // cut off the index and a part of the last chunk, as if the application crashed while recording
+    std::ifstream input(fileName.c_str(), std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    input.close();
+    const std::size_t indexSize = (NumberOfNavigationDatas + NumberOfImages) * 20 + 24;
+    std::string truncatedFileName = mitk::IOUtil::CreateTemporaryFile("MultiStreamRecorderTest_XXXXXX.msr");
+    std::ofstream output(truncatedFileName.c_str(), std::ios::binary | std::ios::trunc);
+    output.write(content.data(), content.size() - indexSize - 5);
+    output.close();
+
+    mitk::MultiStreamRecordingReader::Pointer reader = mitk::MultiStreamRecordingReader::New();
+    reader->Open(truncatedFileName);
+    MITK_TEST_CONDITION_REQUIRED(reader->IsIndexRecovered(), "Index of the truncated recording was rebuilt.");
+    MITK_TEST_CONDITION(reader->GetNumberOfSamples(0) + reader->GetNumberOfSamples(1) == NumberOfNavigationDatas + NumberOfImages - 1,
+      "All complete samples were found.");
+    std::vector<mitk::NavigationData::Pointer> navigationDatas;
+    reader->ReadNavigationData(0, 42, navigationDatas);
+    MITK_TEST_CONDITION(navigationDatas[0]->GetPosition()[0] == 42, "Reading a sample of the truncated recording.");
+    reader->Close();
+    std::remove(truncatedFileName.c_str());
+  }
+};
+
+/**
+* This function is testing the classes MultiStreamRecorder, MultiStreamRecordingReader and USRecordingImageSource.
+*/
+int mitkMultiStreamRecorderTest(int /* argc */, char* /*argv*/[])
+{
+  MITK_TEST_BEGIN("mitkMultiStreamRecorderTest");
+
+  std::string fileName = mitkMultiStreamRecorderTestClass::TestRecording();
+  mitkMultiStreamRecorderTestClass::TestReading(fileName);
+  mitkMultiStreamRecorderTestClass::TestImageSource(fileName);
+  mitkMultiStreamRecorderTestClass::TestIndexRecovery(fileName);
+  mitkMultiStreamRecorderTestClass::TestStartStopWhileRecording();
+  std::remove(fileName.c_str());
+
+  MITK_TEST_END();
+}
@@ -2,6 +2,9 @@ SET(CPP_FILES
   mitkUSCombinedModality.cpp
   mitkTrackedUltrasound.cpp
   mitkAbstractUltrasoundTrackerDevice.cpp
+  mitkMultiStreamRecorder.cpp
+  mitkMultiStreamRecordingReader.cpp
+  mitkUSRecordingImageSource.cpp
 
   Filter/mitkNodeDisplacementFilter.cpp
 )
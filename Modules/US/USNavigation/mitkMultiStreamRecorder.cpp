@@ -0,0 +1,417 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "mitkMultiStreamRecorder.h"
+
+#include <mitkExceptionMacro.h>
+#include <mitkIGTTimeStamp.h>
+#include <mitkImageReadAccessor.h>
+#include <mitkNavigationDataStreamWriter.h>
+
+#include <itkByteSwapper.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+
+namespace
+{
+  template <typename T>
+  void WriteValue(char*& buffer, T value)
+  {
+    itk::ByteSwapper<T>::SwapFromSystemToLittleEndian(&value);
+    std::memcpy(buffer, &value, sizeof(T));
+    buffer += sizeof(T);
+  }
+
+  template <typename T>
+  void WriteValue(std::vector<char>& buffer, T value)
+  {
+    buffer.resize(buffer.size() + sizeof(T));
+    char* position = buffer.data() + buffer.size() - sizeof(T);
+    WriteValue<T>(position, value);
+  }
+
+  void WriteString(std::vector<char>& buffer, const std::string& value)
+  {
+    WriteValue<uint32_t>(buffer, static_cast<uint32_t>(value.size()));
+    buffer.insert(buffer.end(), value.begin(), value.end());
+  }
+
+  /** size of the image description in front of the pixels of an image chunk */
+  const std::size_t ImageHeaderSize = 7 * sizeof(uint32_t) + 6 * sizeof(double);
+
+  /** size of the description in front of the data of every chunk */
+  const std::size_t ChunkHeaderSize = sizeof(uint32_t) + sizeof(double) + sizeof(uint64_t);
+
+  /** counts the threads that are recording a sample, so the queues are not drained or replaced meanwhile */
+  class ProducerGuard
+  {
+  public:
+    explicit ProducerGuard(std::atomic<unsigned int>& numberOfProducers) : m_NumberOfProducers(numberOfProducers)
+    {
+      ++m_NumberOfProducers;
+    }
+    ~ProducerGuard() { --m_NumberOfProducers; }
+
+  private:
+    std::atomic<unsigned int>& m_NumberOfProducers;
+  };
+}
+
+const char* mitk::MultiStreamRecorder::GetMagicNumber()
+{
+  return "MITKMSR";
+}
+
+const char* mitk::MultiStreamRecorder::GetIndexMagicNumber()
+{
+  return "MSRINDEX";
+}
+
+mitk::MultiStreamRecorder::MultiStreamRecorder()
+  : m_QueueSize(64), m_FileOffset(0), m_Recording(false), m_StopWriting(false), m_NumberOfProducers(0)
+{
+}
+
+mitk::MultiStreamRecorder::~MultiStreamRecorder()
+{
+  if (m_Recording)
+    this->StopRecording();
+}
+
+unsigned int mitk::MultiStreamRecorder::AddNavigationDataStream(const std::string& name, const std::vector<std::string>& toolNames)
+{
+  if (m_Recording)
+  {
+    mitkThrow() << "Cannot add a stream while recording.";
+  }
+  std::unique_ptr<Stream> stream(new Stream);
+  stream->Type = NavigationDataStream;
+  stream->Name = name;
+  stream->ToolNames = toolNames;
+  stream->NumberOfRecordedSamples = 0;
+  stream->NumberOfDroppedSamples = 0;
+  m_Streams.push_back(std::move(stream));
+  this->Modified();
+  return static_cast<unsigned int>(m_Streams.size() - 1);
+}
+
+unsigned int mitk::MultiStreamRecorder::AddImageStream(const std::string& name)
+{
+  if (m_Recording)
+  {
+    mitkThrow() << "Cannot add a stream while recording.";
+  }
+  std::unique_ptr<Stream> stream(new Stream);
+  stream->Type = ImageStream;
+  stream->Name = name;
+  stream->NumberOfRecordedSamples = 0;
+  stream->NumberOfDroppedSamples = 0;
+  m_Streams.push_back(std::move(stream));
+  this->Modified();
+  return static_cast<unsigned int>(m_Streams.size() - 1);
+}
+
+void mitk::MultiStreamRecorder::RemoveAllStreams()
+{
+  if (m_Recording)
+  {
+    mitkThrow() << "Cannot remove the streams while recording.";
+  }
+  m_Streams.clear();
+  this->Modified();
+}
+
+unsigned int mitk::MultiStreamRecorder::GetNumberOfStreams() const
+{
+  return static_cast<unsigned int>(m_Streams.size());
+}
+
+bool mitk::MultiStreamRecorder::IsRecording() const
+{
+  return m_Recording;
+}
+
+unsigned long mitk::MultiStreamRecorder::GetNumberOfRecordedSamples(unsigned int streamIndex) const
+{
+  return streamIndex < m_Streams.size() ? m_Streams[streamIndex]->NumberOfRecordedSamples.load() : 0;
+}
+
+unsigned long mitk::MultiStreamRecorder::GetNumberOfDroppedSamples(unsigned int streamIndex) const
+{
+  return streamIndex < m_Streams.size() ? m_Streams[streamIndex]->NumberOfDroppedSamples.load() : 0;
+}
+
+void mitk::MultiStreamRecorder::StartRecording(const std::string& fileName)
+{
+  if (m_Recording)
+  {
+    MITK_WARN << "Already recording, please stop the recording first.";
+    return;
+  }
+  if (m_Streams.empty())
+  {
+    mitkThrow() << "Cannot record without streams.";
+  }
+
+  m_File.open(fileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!m_File.is_open())
+  {
+    mitkThrow() << "Cannot open file " << fileName << " for writing.";
+  }
+
+  // producers that saw the last recording may still be leaving a record call
+  this->WaitForProducers();
+  const std::size_t queueSize = std::max(m_QueueSize, 1u);
+  for (auto& stream : m_Streams)
+  {
+    stream->Queue.reset(new mitk::LockFreeRingBuffer<Sample>(queueSize));
+    stream->NumberOfRecordedSamples = 0;
+    stream->NumberOfDroppedSamples = 0;
+  }
+  m_Index.clear();
+  m_FileOffset = 0;
+  this->WriteHeader();
+
+  // all devices and the recorder use the same clock
+  mitk::IGTTimeStamp::GetInstance()->Start(this);
+
+  m_StopWriting = false;
+  m_Recording = true;
+  m_WriterThread = std::thread(&MultiStreamRecorder::WriteQueuedSamples, this);
+}
+
+void mitk::MultiStreamRecorder::StopRecording()
+{
+  if (!m_Recording)
+    return;
+
+  // samples of producers that saw m_Recording before it was reset are written as well
+  m_Recording = false;
+  this->WaitForProducers();
+  m_StopWriting = true;
+  if (m_WriterThread.joinable())
+    m_WriterThread.join();
+
+  this->WriteIndex();
+  if (!m_File.good())
+  {
+    MITK_ERROR << "Writing the recording failed, the file is incomplete.";
+  }
+  m_File.close();
+
+  mitk::IGTTimeStamp::GetInstance()->Stop(this);
+}
+
+void mitk::MultiStreamRecorder::WaitForProducers() const
+{
+  while (m_NumberOfProducers > 0)
+    std::this_thread::yield();
+}
+
+mitk::MultiStreamRecorder::Stream* mitk::MultiStreamRecorder::GetStream(unsigned int streamIndex, StreamType type)
+{
+  if (streamIndex >= m_Streams.size() || m_Streams[streamIndex]->Type != type)
+  {
+    mitkThrow() << "Stream " << streamIndex << " does not exist or has the wrong type.";
+  }
+  return m_Streams[streamIndex].get();
+}
+
+bool mitk::MultiStreamRecorder::RecordNavigationData(unsigned int streamIndex, const std::vector<mitk::NavigationData::Pointer>& navigationDatas)
+{
+  Stream* stream = this->GetStream(streamIndex, NavigationDataStream);
+  if (navigationDatas.size() != stream->ToolNames.size())
+  {
+    mitkThrow() << "Stream " << streamIndex << " records " << stream->ToolNames.size() << " tools, but "
+      << navigationDatas.size() << " navigation datas were given.";
+  }
+  ProducerGuard guard(m_NumberOfProducers);
+  if (!m_Recording)
+    return false;
+
+  const double timeStamp = mitk::IGTTimeStamp::GetInstance()->GetElapsed();
+  Sample* sample = stream->Queue->BeginPush();
+  if (sample == nullptr)
+  {
+    ++stream->NumberOfDroppedSamples;
+    return false;
+  }
+
+  // the slot keeps its memory, so this does not allocate once the queue is filled
+  sample->TimeStamp = timeStamp;
+  sample->Data.resize(navigationDatas.size() * mitk::NavigationDataStreamWriter::ToolRecordSize);
+  char* position = sample->Data.data();
+  for (const auto& navigationData : navigationDatas)
+  {
+    char* record = position;
+    position = mitk::NavigationDataStreamWriter::EncodeToolRecord(navigationData, position);
+    // replace the time stamp of the device by the common time
+    WriteValue<double>(record, timeStamp);
+  }
+  stream->Queue->EndPush();
+  return true;
+}
+
+bool mitk::MultiStreamRecorder::RecordImage(unsigned int streamIndex, const mitk::Image* image)
+{
+  Stream* stream = this->GetStream(streamIndex, ImageStream);
+  if (image == nullptr || image->GetDimension() > 3)
+  {
+    mitkThrow() << "Only two and three dimensional images can be recorded.";
+  }
+  ProducerGuard guard(m_NumberOfProducers);
+  if (!m_Recording)
+    return false;
+
+  const double timeStamp = mitk::IGTTimeStamp::GetInstance()->GetElapsed();
+  Sample* sample = stream->Queue->BeginPush();
+  if (sample == nullptr)
+  {
+    ++stream->NumberOfDroppedSamples;
+    return false;
+  }
+
+  const mitk::PixelType pixelType = image->GetPixelType();
+  uint32_t size[3] = { 1, 1, 1 };
+  std::size_t numberOfBytes = pixelType.GetSize();
+  for (unsigned int i = 0; i < std::min(image->GetDimension(), 3u); ++i)
+  {
+    size[i] = image->GetDimension(i);
+    numberOfBytes *= size[i];
+  }
+
+  sample->TimeStamp = timeStamp;
+  sample->Data.resize(ImageHeaderSize + numberOfBytes);
+  char* position = sample->Data.data();
+  WriteValue<uint32_t>(position, static_cast<uint32_t>(pixelType.GetComponentType()));
+  WriteValue<uint32_t>(position, static_cast<uint32_t>(pixelType.GetPixelType()));
+  WriteValue<uint32_t>(position, static_cast<uint32_t>(pixelType.GetNumberOfComponents()));
+  WriteValue<uint32_t>(position, std::min(image->GetDimension(), 3u));
+  for (int i = 0; i < 3; ++i)
+    WriteValue<uint32_t>(position, size[i]);
+  const mitk::BaseGeometry* geometry = image->GetGeometry();
+  for (int i = 0; i < 3; ++i)
+    WriteValue<double>(position, geometry->GetSpacing()[i]);
+  for (int i = 0; i < 3; ++i)
+    WriteValue<double>(position, geometry->GetOrigin()[i]);
+
+  try
+  {
+    mitk::ImageReadAccessor accessor(const_cast<mitk::Image*>(image), image->GetVolumeData(0));
+    std::memcpy(position, accessor.GetData(), numberOfBytes);
+  }
+  catch (const mitk::Exception& e)
+  {
+    MITK_ERROR << "Cannot access the image: " << e.GetDescription();
+    ++stream->NumberOfDroppedSamples;
+    return false;
+  }
+  stream->Queue->EndPush();
+  return true;
+}
+
+void mitk::MultiStreamRecorder::WriteHeader()
+{
+  std::vector<char> header(GetMagicNumber(), GetMagicNumber() + 8);
+  WriteValue<uint32_t>(header, FormatVersion);
+  const std::size_t headerSizePosition = header.size();
+  WriteValue<uint32_t>(header, 0);
+  WriteValue<uint32_t>(header, static_cast<uint32_t>(m_Streams.size()));
+  for (const auto& stream : m_Streams)
+  {
+    WriteValue<uint32_t>(header, static_cast<uint32_t>(stream->Type));
+    WriteString(header, stream->Name);
+    if (stream->Type == NavigationDataStream)
+    {
+      WriteValue<uint32_t>(header, static_cast<uint32_t>(stream->ToolNames.size()));
+      for (const auto& toolName : stream->ToolNames)
+        WriteString(header, toolName);
+    }
+  }
+  char* headerSize = header.data() + headerSizePosition;
+  WriteValue<uint32_t>(headerSize, static_cast<uint32_t>(header.size()));
+
+  m_File.write(header.data(), header.size());
+  m_FileOffset = header.size();
+}
+
+void mitk::MultiStreamRecorder::WriteChunk(unsigned int streamIndex, const Sample& sample)
+{
+  char chunkHeader[ChunkHeaderSize];
+  char* position = chunkHeader;
+  WriteValue<uint32_t>(position, streamIndex);
+  WriteValue<double>(position, sample.TimeStamp);
+  WriteValue<uint64_t>(position, sample.Data.size());
+
+  m_File.write(chunkHeader, ChunkHeaderSize);
+  m_File.write(sample.Data.data(), sample.Data.size());
+
+  IndexEntry entry = { streamIndex, sample.TimeStamp, m_FileOffset };
+  m_Index.push_back(entry);
+  m_FileOffset += ChunkHeaderSize + sample.Data.size();
+}
+
+void mitk::MultiStreamRecorder::WriteIndex()
+{
+  const std::size_t entrySize = sizeof(uint32_t) + sizeof(double) + sizeof(uint64_t);
+  std::vector<char> index(m_Index.size() * entrySize + 2 * sizeof(uint64_t) + 8);
+  char* position = index.data();
+  for (const auto& entry : m_Index)
+  {
+    WriteValue<uint32_t>(position, entry.StreamIndex);
+    WriteValue<double>(position, entry.TimeStamp);
+    WriteValue<uint64_t>(position, entry.Offset);
+  }
+  WriteValue<uint64_t>(position, m_FileOffset);
+  WriteValue<uint64_t>(position, m_Index.size());
+  std::memcpy(position, GetIndexMagicNumber(), 8);
+
+  m_File.write(index.data(), index.size());
+  m_File.flush();
+}
+
+void mitk::MultiStreamRecorder::WriteQueuedSamples()
+{
+  while (true)
+  {
+    // the stop flag is read before the queues, so all samples pushed before stopping are written
+    const bool stop = m_StopWriting;
+
+    // write the oldest sample of all streams, so the chunks are ordered by time
+    unsigned int oldestStream = 0;
+    Sample* oldestSample = nullptr;
+    for (unsigned int i = 0; i < m_Streams.size(); ++i)
+    {
+      Sample* sample = m_Streams[i]->Queue->BeginPop();
+      if (sample != nullptr && (oldestSample == nullptr || sample->TimeStamp < oldestSample->TimeStamp))
+      {
+        oldestSample = sample;
+        oldestStream = i;
+      }
+    }
+
+    if (oldestSample == nullptr)
+    {
+      if (stop)
+        break;
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      continue;
+    }
+
+    this->WriteChunk(oldestStream, *oldestSample);
+    m_Streams[oldestStream]->Queue->EndPop();
+    ++m_Streams[oldestStream]->NumberOfRecordedSamples;
+  }
+}
@@ -0,0 +1,202 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef __mitkMultiStreamRecorder_h
+#define __mitkMultiStreamRecorder_h
+
+#include <MitkUSNavigationExports.h>
+#include <mitkCommon.h>
+#include <mitkImage.h>
+#include <mitkLockFreeRingBuffer.h>
+#include <mitkNavigationData.h>
+
+#include <itkObject.h>
+#include <itkObjectFactory.h>
+
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace mitk {
+
+  /**
+   * \brief Records navigation data, ultrasound images and video frames into one file with a common clock.
+   *
+   * Every stream is added before the recording starts, either as navigation data stream with a fixed
+   * number of tools or as image stream (ultrasound images, video frames, ToF images, ...). The samples
+   * are passed to RecordNavigationData() and RecordImage(), which stamp them with the time of
+   * mitk::IGTTimeStamp::GetElapsed(), encode them and hand them to a writer thread through one
+   * mitk::LockFreeRingBuffer per stream. So the threads of the devices never wait for the disk and
+   * all streams can be aligned by their time stamps. The time stamps of the navigation datas are
+   * replaced by this time, like mitk::NavigationDataRecorder::SetStandardizeTime() does.
+   * If the writer thread does not keep up, the samples are dropped and counted instead of blocking
+   * the devices.
+   *
+   * The samples of one stream have to be recorded by one thread at a time, different streams may
+   * be recorded by different threads. The recording may be started and stopped while other threads
+   * record samples: StopRecording() waits for the calls of RecordNavigationData() and RecordImage()
+   * that are in progress and writes their samples, later calls return false.
+   *
+   * The file consists of chunks, one per sample, and an index of all chunks that is appended by
+   * StopRecording(). Recordings without index, e.g. after a crash, can still be read up to the last
+   * complete chunk, see mitk::MultiStreamRecordingReader. All values are stored little endian:
+   *
+   *  - header: the magic number "MITKMSR" followed by a zero byte, the unsigned 32 bit integers format
+   *    version, size of the whole header and number of streams, then for every stream its type
+   *    (0: navigation data, 1: image), name and for navigation data streams the number of tools and the
+   *    tool names (strings are stored as 32 bit length and characters)
+   *  - chunks: stream index (32 bit), time stamp in ms (double), size of the data (64 bit) and the data.
+   *    Navigation data are stored as the tool records of mitk::NavigationDataStreamWriter. Images are
+   *    stored as component type and pixel type (itk::ImageIOBase), number of components, dimension and
+   *    size of the three dimensions (32 bit each), spacing and origin (3 doubles each) and the pixels of
+   *    the first time step
+   *  - index: stream index, time stamp and file offset of every chunk, followed by the offset of the index,
+   *    the number of entries (64 bit each) and the magic number "MSRINDEX"
+   */
+  class MITKUSNAVIGATION_EXPORT MultiStreamRecorder : public itk::Object
+  {
+  public:
+    mitkClassMacroItkParent(MultiStreamRecorder, itk::Object);
+    itkFactorylessNewMacro(Self);
+
+    enum StreamType
+    {
+      NavigationDataStream = 0,
+      ImageStream = 1
+    };
+
+    /** \brief Version of the format written by this class */
+    static const unsigned int FormatVersion = 1;
+
+    /** \brief Returns the magic number at the start of every recording (8 bytes including the zero byte) */
+    static const char* GetMagicNumber();
+
+    /** \brief Returns the magic number at the end of the index (8 bytes) */
+    static const char* GetIndexMagicNumber();
+
+    /**
+     * \brief Adds a stream for the given tools and returns its index.
+     * @throw mitk::Exception if the recorder is recording.
+     */
+    unsigned int AddNavigationDataStream(const std::string& name, const std::vector<std::string>& toolNames);
+
+    /**
+     * \brief Adds a stream for images and returns its index.
+     * @throw mitk::Exception if the recorder is recording.
+     */
+    unsigned int AddImageStream(const std::string& name);
+
+    /**
+     * \brief Removes all streams.
+     * @throw mitk::Exception if the recorder is recording.
+     */
+    void RemoveAllStreams();
+
+    unsigned int GetNumberOfStreams() const;
+
+    /**
+     * \brief Sets the number of samples per stream that can wait for the writer thread. Default is 64.
+     * Has to be set before StartRecording().
+     */
+    itkSetMacro(QueueSize, unsigned int);
+    itkGetConstMacro(QueueSize, unsigned int);
+
+    /**
+     * \brief Creates the file, writes the header and starts the writer thread. An existing file is overwritten.
+     * @throw mitk::Exception if there are no streams or the file cannot be opened.
+     */
+    void StartRecording(const std::string& fileName);
+
+    /**
+     * \brief Writes the samples that are still queued and the index and closes the file.
+     */
+    void StopRecording();
+
+    bool IsRecording() const;
+
+    /**
+     * \brief Records one time step of a navigation data stream, one navigation data per tool.
+     * @return false if the recorder is not recording or the sample was dropped.
+     * @throw mitk::Exception if the stream is no navigation data stream or the number of tools is wrong.
+     */
+    bool RecordNavigationData(unsigned int streamIndex, const std::vector<mitk::NavigationData::Pointer>& navigationDatas);
+
+    /**
+     * \brief Records the first time step of the image into an image stream. The pixels are copied,
+     * so the image can be changed after the call.
+     * @return false if the recorder is not recording or the sample was dropped.
+     * @throw mitk::Exception if the stream is no image stream or the image has more than three spatial dimensions.
+     */
+    bool RecordImage(unsigned int streamIndex, const mitk::Image* image);
+
+    /** \brief Returns the number of samples of the stream written by the current or last recording. */
+    unsigned long GetNumberOfRecordedSamples(unsigned int streamIndex) const;
+
+    /** \brief Returns the number of samples of the stream dropped by the current or last recording. */
+    unsigned long GetNumberOfDroppedSamples(unsigned int streamIndex) const;
+
+  protected:
+    MultiStreamRecorder();
+    ~MultiStreamRecorder() override;
+
+    /** \brief One encoded sample, the slots of the queues keep their memory */
+    struct Sample
+    {
+      double TimeStamp;
+      std::vector<char> Data;
+    };
+
+    struct Stream
+    {
+      StreamType Type;
+      std::string Name;
+      std::vector<std::string> ToolNames;
+      std::unique_ptr<mitk::LockFreeRingBuffer<Sample>> Queue;
+      std::atomic<unsigned long> NumberOfRecordedSamples;
+      std::atomic<unsigned long> NumberOfDroppedSamples;
+    };
+
+    struct IndexEntry
+    {
+      unsigned int StreamIndex;
+      double TimeStamp;
+      unsigned long long Offset;
+    };
+
+    Stream* GetStream(unsigned int streamIndex, StreamType type);
+    /** \brief Waits until no thread is inside of RecordNavigationData() or RecordImage() */
+    void WaitForProducers() const;
+    void WriteHeader();
+    void WriteChunk(unsigned int streamIndex, const Sample& sample);
+    void WriteIndex();
+
+    /** \brief Main function of the writer thread, writes the queued samples ordered by their time stamps */
+    void WriteQueuedSamples();
+
+    std::vector<std::unique_ptr<Stream>> m_Streams;
+    unsigned int m_QueueSize;
+
+    std::ofstream m_File;
+    unsigned long long m_FileOffset;
+    std::vector<IndexEntry> m_Index;
+
+    std::thread m_WriterThread;
+    std::atomic<bool> m_Recording;
+    std::atomic<bool> m_StopWriting;
+    std::atomic<unsigned int> m_NumberOfProducers;
+  };
+} // namespace mitk
+
+#endif // __mitkMultiStreamRecorder_h
@@ -0,0 +1,492 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "mitkMultiStreamRecordingReader.h"
+
+#include <mitkExceptionMacro.h>
+#include <mitkNavigationDataStreamReader.h>
+#include <mitkNavigationDataStreamWriter.h>
+
+#include <itkByteSwapper.h>
+#include <itkImageIOBase.h>
+#include <itkRGBAPixel.h>
+#include <itkRGBPixel.h>
+#include <itkVectorImage.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace
+{
+  template <typename T>
+  T ReadValue(const char*& buffer)
+  {
+    T value;
+    std::memcpy(&value, buffer, sizeof(T));
+    itk::ByteSwapper<T>::SwapFromSystemToLittleEndian(&value);
+    buffer += sizeof(T);
+    return value;
+  }
+
+  const std::size_t ChunkHeaderSize = sizeof(uint32_t) + sizeof(double) + sizeof(uint64_t);
+  const std::size_t ImageHeaderSize = 7 * sizeof(uint32_t) + 6 * sizeof(double);
+  const std::size_t IndexEntrySize = sizeof(uint32_t) + sizeof(double) + sizeof(uint64_t);
+  const std::size_t IndexTrailerSize = 2 * sizeof(uint64_t) + 8;
+
+  template <typename T>
+  mitk::PixelType MakePixelTypeOfComponent(unsigned int pixelType, unsigned int numberOfComponents)
+  {
+    switch (pixelType)
+    {
+    case itk::ImageIOBase::SCALAR:
+      return mitk::MakeScalarPixelType<T>();
+    case itk::ImageIOBase::RGB:
+      return mitk::MakePixelType<itk::Image<itk::RGBPixel<T>, 3>>();
+    case itk::ImageIOBase::RGBA:
+      return mitk::MakePixelType<itk::Image<itk::RGBAPixel<T>, 3>>();
+    default:
+      return mitk::MakePixelType<itk::VectorImage<T, 3>>(numberOfComponents);
+    }
+  }
+
+  mitk::PixelType MakePixelTypeOfDescription(unsigned int componentType, unsigned int pixelType, unsigned int numberOfComponents)
+  {
+    switch (componentType)
+    {
+    case itk::ImageIOBase::UCHAR:
+      return MakePixelTypeOfComponent<unsigned char>(pixelType, numberOfComponents);
+    case itk::ImageIOBase::CHAR:
+      return MakePixelTypeOfComponent<char>(pixelType, numberOfComponents);
+    case itk::ImageIOBase::USHORT:
+      return MakePixelTypeOfComponent<unsigned short>(pixelType, numberOfComponents);
+    case itk::ImageIOBase::SHORT:
+      return MakePixelTypeOfComponent<short>(pixelType, numberOfComponents);
+    case itk::ImageIOBase::UINT:
+      return MakePixelTypeOfComponent<unsigned int>(pixelType, numberOfComponents);
+    case itk::ImageIOBase::INT:
+      return MakePixelTypeOfComponent<int>(pixelType, numberOfComponents);
+    case itk::ImageIOBase::FLOAT:
+      return MakePixelTypeOfComponent<float>(pixelType, numberOfComponents);
+    case itk::ImageIOBase::DOUBLE:
+      return MakePixelTypeOfComponent<double>(pixelType, numberOfComponents);
+    default:
+      mitkThrow() << "Images with component type " << componentType << " are not supported.";
+    }
+  }
+}
+
+mitk::MultiStreamRecordingReader::MultiStreamRecordingReader()
+  : m_HeaderSize(0), m_IndexRecovered(false)
+{
+}
+
+mitk::MultiStreamRecordingReader::~MultiStreamRecordingReader()
+{
+}
+
+void mitk::MultiStreamRecordingReader::Open(const std::string& fileName)
+{
+  this->Close();
+
+  std::lock_guard<std::mutex> lock(m_FileMutex);
+  m_File.open(fileName.c_str(), std::ios::in | std::ios::binary);
+  if (!m_File.is_open())
+  {
+    mitkThrow() << "Cannot open file " << fileName << " for reading.";
+  }
+
+  try
+  {
+    this->ReadHeader();
+
+    m_File.seekg(0, std::ios::end);
+    const unsigned long long fileSize = static_cast<unsigned long long>(m_File.tellg());
+    m_IndexRecovered = !this->ReadIndex(fileSize);
+    if (m_IndexRecovered)
+    {
+      MITK_WARN << "The recording " << fileName << " has no index, it was probably not stopped. Rebuilding the index.";
+      for (auto& stream : m_Streams)
+      {
+        stream.TimeStamps.clear();
+        stream.Offsets.clear();
+      }
+      this->RecoverIndex(fileSize);
+    }
+  }
+  catch (...)
+  {
+    m_File.close();
+    m_Streams.clear();
+    throw;
+  }
+  this->Modified();
+}
+
+void mitk::MultiStreamRecordingReader::Close()
+{
+  std::lock_guard<std::mutex> lock(m_FileMutex);
+  if (m_File.is_open())
+    m_File.close();
+  m_File.clear();
+  m_Streams.clear();
+  m_HeaderSize = 0;
+  m_IndexRecovered = false;
+}
+
+bool mitk::MultiStreamRecordingReader::IsOpen() const
+{
+  return m_File.is_open();
+}
+
+bool mitk::MultiStreamRecordingReader::IsIndexRecovered() const
+{
+  return m_IndexRecovered;
+}
+
+void mitk::MultiStreamRecordingReader::ReadHeader()
+{
+  const std::size_t fixedSize = 8 + 3 * sizeof(uint32_t);
+  m_Buffer.resize(fixedSize);
+  m_File.read(m_Buffer.data(), fixedSize);
+  if (!m_File.good() || std::memcmp(m_Buffer.data(), mitk::MultiStreamRecorder::GetMagicNumber(), 8) != 0)
+  {
+    mitkThrow() << "The file is no multi-stream recording.";
+  }
+
+  const char* position = m_Buffer.data() + 8;
+  const uint32_t version = ReadValue<uint32_t>(position);
+  if (version > mitk::MultiStreamRecorder::FormatVersion)
+  {
+    mitkThrow() << "The recording has version " << version << ", only versions up to "
+      << mitk::MultiStreamRecorder::FormatVersion << " are supported.";
+  }
+  m_HeaderSize = ReadValue<uint32_t>(position);
+  const uint32_t numberOfStreams = ReadValue<uint32_t>(position);
+  // every stream needs at least its type and the length of its name
+  if (m_HeaderSize < fixedSize || numberOfStreams > (m_HeaderSize - fixedSize) / (2 * sizeof(uint32_t)))
+  {
+    mitkThrow() << "The header of the recording is invalid.";
+  }
+
+  m_Buffer.resize(m_HeaderSize);
+  m_File.read(m_Buffer.data() + fixedSize, m_HeaderSize - fixedSize);
+  if (!m_File.good())
+  {
+    mitkThrow() << "Reading the header of the recording failed.";
+  }
+
+  position = m_Buffer.data() + fixedSize;
+  const char* end = m_Buffer.data() + m_HeaderSize;
+  auto readString = [&position, end]() {
+    if (end - position < static_cast<std::ptrdiff_t>(sizeof(uint32_t)))
+      mitkThrow() << "The header of the recording is invalid.";
+    const uint32_t length = ReadValue<uint32_t>(position);
+    if (end - position < static_cast<std::ptrdiff_t>(length))
+      mitkThrow() << "The header of the recording is invalid.";
+    std::string value(position, length);
+    position += length;
+    return value;
+  };
+  auto readUInt = [&position, end]() {
+    if (end - position < static_cast<std::ptrdiff_t>(sizeof(uint32_t)))
+      mitkThrow() << "The header of the recording is invalid.";
+    return ReadValue<uint32_t>(position);
+  };
+
+  m_Streams.resize(numberOfStreams);
+  for (auto& stream : m_Streams)
+  {
+    const uint32_t type = readUInt();
+    if (type != mitk::MultiStreamRecorder::NavigationDataStream && type != mitk::MultiStreamRecorder::ImageStream)
+    {
+      mitkThrow() << "The recording contains a stream of unknown type " << type << ".";
+    }
+    stream.Type = static_cast<mitk::MultiStreamRecorder::StreamType>(type);
+    stream.Name = readString();
+    if (stream.Type == mitk::MultiStreamRecorder::NavigationDataStream)
+    {
+      const uint32_t numberOfTools = readUInt();
+      for (uint32_t i = 0; i < numberOfTools; ++i)
+        stream.ToolNames.push_back(readString());
+    }
+  }
+}
+
+bool mitk::MultiStreamRecordingReader::ReadIndex(unsigned long long fileSize)
+{
+  if (fileSize < m_HeaderSize + IndexTrailerSize)
+    return false;
+
+  char trailer[IndexTrailerSize];
+  m_File.seekg(fileSize - IndexTrailerSize);
+  m_File.read(trailer, IndexTrailerSize);
+  if (!m_File.good() || std::memcmp(trailer + 2 * sizeof(uint64_t), mitk::MultiStreamRecorder::GetIndexMagicNumber(), 8) != 0)
+  {
+    m_File.clear();
+    return false;
+  }
+
+  const char* position = trailer;
+  const uint64_t indexOffset = ReadValue<uint64_t>(position);
+  const uint64_t numberOfEntries = ReadValue<uint64_t>(position);
+  if (indexOffset < m_HeaderSize || indexOffset + numberOfEntries * IndexEntrySize + IndexTrailerSize != fileSize)
+    return false;
+
+  std::vector<char> index(numberOfEntries * IndexEntrySize);
+  m_File.seekg(indexOffset);
+  m_File.read(index.data(), index.size());
+  if (!m_File.good())
+  {
+    m_File.clear();
+    return false;
+  }
+
+  position = index.data();
+  for (uint64_t i = 0; i < numberOfEntries; ++i)
+  {
+    const uint32_t streamIndex = ReadValue<uint32_t>(position);
+    const double timeStamp = ReadValue<double>(position);
+    const uint64_t offset = ReadValue<uint64_t>(position);
+    if (streamIndex >= m_Streams.size() || offset < m_HeaderSize || offset >= indexOffset)
+      return false;
+    this->AddIndexEntry(streamIndex, timeStamp, offset);
+  }
+  return true;
+}
+
+void mitk::MultiStreamRecordingReader::RecoverIndex(unsigned long long fileSize)
+{
+  // the chunks follow each other, so they can be found by their sizes up to the first incomplete chunk
+  unsigned long long offset = m_HeaderSize;
+  char chunkHeader[ChunkHeaderSize];
+  while (offset + ChunkHeaderSize <= fileSize)
+  {
+    m_File.seekg(offset);
+    m_File.read(chunkHeader, ChunkHeaderSize);
+    if (!m_File.good())
+      break;
+
+    const char* position = chunkHeader;
+    const uint32_t streamIndex = ReadValue<uint32_t>(position);
+    const double timeStamp = ReadValue<double>(position);
+    const uint64_t dataSize = ReadValue<uint64_t>(position);
+    if (streamIndex >= m_Streams.size() || dataSize > fileSize - offset - ChunkHeaderSize)
+      break;
+
+    this->AddIndexEntry(streamIndex, timeStamp, offset);
+    offset += ChunkHeaderSize + dataSize;
+  }
+  m_File.clear();
+}
+
+void mitk::MultiStreamRecordingReader::AddIndexEntry(unsigned int streamIndex, double timeStamp, unsigned long long offset)
+{
+  m_Streams[streamIndex].TimeStamps.push_back(timeStamp);
+  m_Streams[streamIndex].Offsets.push_back(offset);
+}
+
+unsigned int mitk::MultiStreamRecordingReader::GetNumberOfStreams() const
+{
+  return static_cast<unsigned int>(m_Streams.size());
+}
+
+const mitk::MultiStreamRecordingReader::StreamInfo& mitk::MultiStreamRecordingReader::GetStreamInfo(unsigned int streamIndex) const
+{
+  if (streamIndex >= m_Streams.size())
+  {
+    mitkThrow() << "The recording has no stream " << streamIndex << ".";
+  }
+  return m_Streams[streamIndex];
+}
+
+const mitk::MultiStreamRecordingReader::StreamInfo& mitk::MultiStreamRecordingReader::GetStreamInfo(unsigned int streamIndex,
+  unsigned int sampleIndex, mitk::MultiStreamRecorder::StreamType type) const
+{
+  const StreamInfo& stream = this->GetStreamInfo(streamIndex);
+  if (stream.Type != type)
+  {
+    mitkThrow() << "Stream " << streamIndex << " has the wrong type.";
+  }
+  if (sampleIndex >= stream.Offsets.size())
+  {
+    mitkThrow() << "Stream " << streamIndex << " has no sample " << sampleIndex << ".";
+  }
+  return stream;
+}
+
+std::string mitk::MultiStreamRecordingReader::GetStreamName(unsigned int streamIndex) const
+{
+  return this->GetStreamInfo(streamIndex).Name;
+}
+
+mitk::MultiStreamRecorder::StreamType mitk::MultiStreamRecordingReader::GetStreamType(unsigned int streamIndex) const
+{
+  return this->GetStreamInfo(streamIndex).Type;
+}
+
+std::vector<std::string> mitk::MultiStreamRecordingReader::GetToolNames(unsigned int streamIndex) const
+{
+  return this->GetStreamInfo(streamIndex).ToolNames;
+}
+
+int mitk::MultiStreamRecordingReader::GetStreamIndex(const std::string& name) const
+{
+  for (std::size_t i = 0; i < m_Streams.size(); ++i)
+  {
+    if (m_Streams[i].Name == name)
+      return static_cast<int>(i);
+  }
+  return -1;
+}
+
+unsigned int mitk::MultiStreamRecordingReader::GetNumberOfSamples(unsigned int streamIndex) const
+{
+  return static_cast<unsigned int>(this->GetStreamInfo(streamIndex).Offsets.size());
+}
+
+double mitk::MultiStreamRecordingReader::GetTimeStamp(unsigned int streamIndex, unsigned int sampleIndex) const
+{
+  const StreamInfo& stream = this->GetStreamInfo(streamIndex);
+  if (sampleIndex >= stream.TimeStamps.size())
+  {
+    mitkThrow() << "Stream " << streamIndex << " has no sample " << sampleIndex << ".";
+  }
+  return stream.TimeStamps[sampleIndex];
+}
+
+int mitk::MultiStreamRecordingReader::FindSample(unsigned int streamIndex, double timeStamp) const
+{
+  const std::vector<double>& timeStamps = this->GetStreamInfo(streamIndex).TimeStamps;
+  if (timeStamps.empty())
+    return -1;
+  auto next = std::upper_bound(timeStamps.begin(), timeStamps.end(), timeStamp);
+  return next == timeStamps.begin() ? 0 : static_cast<int>(next - timeStamps.begin()) - 1;
+}
+
+void mitk::MultiStreamRecordingReader::ReadChunk(unsigned long long offset, std::vector<char>& data)
+{
+  char chunkHeader[ChunkHeaderSize];
+  m_File.seekg(offset);
+  m_File.read(chunkHeader, ChunkHeaderSize);
+  if (!m_File.good())
+  {
+    m_File.clear();
+    mitkThrow() << "Reading the chunk at " << offset << " failed.";
+  }
+  const char* position = chunkHeader + sizeof(uint32_t) + sizeof(double);
+  data.resize(ReadValue<uint64_t>(position));
+  m_File.read(data.data(), data.size());
+  if (!m_File.good())
+  {
+    m_File.clear();
+    mitkThrow() << "Reading the chunk at " << offset << " failed.";
+  }
+}
+
+void mitk::MultiStreamRecordingReader::ReadNavigationData(unsigned int streamIndex, unsigned int sampleIndex,
+  std::vector<mitk::NavigationData::Pointer>& outputs)
+{
+  const StreamInfo& stream = this->GetStreamInfo(streamIndex, sampleIndex, mitk::MultiStreamRecorder::NavigationDataStream);
+
+  std::lock_guard<std::mutex> lock(m_FileMutex);
+  this->ReadChunk(stream.Offsets[sampleIndex], m_Buffer);
+  const std::size_t numberOfTools = stream.ToolNames.size();
+  if (m_Buffer.size() != numberOfTools * mitk::NavigationDataStreamWriter::ToolRecordSize)
+  {
+    mitkThrow() << "Sample " << sampleIndex << " of stream " << streamIndex << " is invalid.";
+  }
+
+  outputs.resize(numberOfTools);
+  for (std::size_t i = 0; i < numberOfTools; ++i)
+  {
+    if (outputs[i].IsNull())
+      outputs[i] = mitk::NavigationData::New();
+    mitk::NavigationDataStreamReader::DecodeToolRecord(m_Buffer.data() + i * mitk::NavigationDataStreamWriter::ToolRecordSize, outputs[i]);
+    outputs[i]->SetName(stream.ToolNames[i]);
+  }
+}
+
+mitk::NavigationDataSet::Pointer mitk::MultiStreamRecordingReader::ReadNavigationDataSet(unsigned int streamIndex)
+{
+  const StreamInfo& stream = this->GetStreamInfo(streamIndex);
+  if (stream.Type != mitk::MultiStreamRecorder::NavigationDataStream)
+  {
+    mitkThrow() << "Stream " << streamIndex << " is no navigation data stream.";
+  }
+
+  mitk::NavigationDataSet::Pointer navigationDataSet = mitk::NavigationDataSet::New(static_cast<unsigned int>(stream.ToolNames.size()));
+  navigationDataSet->Reserve(stream.Offsets.size());
+  std::vector<mitk::NavigationData::Pointer> timeStep;
+  for (unsigned int i = 0; i < stream.Offsets.size(); ++i)
+  {
+    this->ReadNavigationData(streamIndex, i, timeStep);
+    navigationDataSet->AddNavigationDatas(timeStep);
+  }
+  return navigationDataSet;
+}
+
+mitk::Image::Pointer mitk::MultiStreamRecordingReader::ReadImage(unsigned int streamIndex, unsigned int sampleIndex)
+{
+  const StreamInfo& stream = this->GetStreamInfo(streamIndex, sampleIndex, mitk::MultiStreamRecorder::ImageStream);
+
+  std::lock_guard<std::mutex> lock(m_FileMutex);
+  const unsigned long long offset = stream.Offsets[sampleIndex];
+  char headers[ChunkHeaderSize + ImageHeaderSize];
+  m_File.seekg(offset);
+  m_File.read(headers, sizeof(headers));
+  if (!m_File.good())
+  {
+    m_File.clear();
+    mitkThrow() << "Reading sample " << sampleIndex << " of stream " << streamIndex << " failed.";
+  }
+
+  const char* position = headers + sizeof(uint32_t) + sizeof(double);
+  const uint64_t dataSize = ReadValue<uint64_t>(position);
+  const uint32_t componentType = ReadValue<uint32_t>(position);
+  const uint32_t pixelTypeId = ReadValue<uint32_t>(position);
+  const uint32_t numberOfComponents = ReadValue<uint32_t>(position);
+  const uint32_t dimension = ReadValue<uint32_t>(position);
+  unsigned int size[3];
+  for (int i = 0; i < 3; ++i)
+    size[i] = ReadValue<uint32_t>(position);
+  mitk::Vector3D spacing;
+  for (int i = 0; i < 3; ++i)
+    spacing[i] = ReadValue<double>(position);
+  mitk::Point3D origin;
+  for (int i = 0; i < 3; ++i)
+    origin[i] = ReadValue<double>(position);
+
+  const mitk::PixelType pixelType = MakePixelTypeOfDescription(componentType, pixelTypeId, numberOfComponents);
+  const uint64_t numberOfBytes = static_cast<uint64_t>(size[0]) * size[1] * size[2] * pixelType.GetSize();
+  if (dimension < 2 || dimension > 3 || dataSize != ImageHeaderSize + numberOfBytes)
+  {
+    mitkThrow() << "Sample " << sampleIndex << " of stream " << streamIndex << " is invalid.";
+  }
+
+  // the pixels are read directly into the memory the image takes over
+  auto* pixels = new unsigned char[numberOfBytes];
+  m_File.read(reinterpret_cast<char*>(pixels), numberOfBytes);
+  if (!m_File.good())
+  {
+    delete[] pixels;
+    m_File.clear();
+    mitkThrow() << "Reading sample " << sampleIndex << " of stream " << streamIndex << " failed.";
+  }
+
+  mitk::Image::Pointer image = mitk::Image::New();
+  image->Initialize(pixelType, dimension, size);
+  image->SetImportVolume(pixels, 0, 0, mitk::Image::ManageMemory);
+  image->GetGeometry()->SetSpacing(spacing);
+  image->GetGeometry()->SetOrigin(origin);
+  return image;
+}
@@ -0,0 +1,138 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef __mitkMultiStreamRecordingReader_h
+#define __mitkMultiStreamRecordingReader_h
+
+#include "mitkMultiStreamRecorder.h"
+
+#include <MitkUSNavigationExports.h>
+#include <mitkCommon.h>
+#include <mitkImage.h>
+#include <mitkNavigationData.h>
+#include <mitkNavigationDataSet.h>
+
+#include <itkObject.h>
+#include <itkObjectFactory.h>
+
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace mitk {
+
+  /**
+   * \brief Random access to the samples of a recording of mitk::MultiStreamRecorder.
+   *
+   * Open() reads the header and the index of the recording, so every sample can be read directly
+   * by its index or found by its time stamp (FindSample()) without reading the other samples.
+   * If the recording has no index, e.g. because it was not stopped, the index is rebuilt from the
+   * chunks up to the last complete one.
+   *
+   * The read methods may be called by several threads, e.g. by a mitk::USRecordingImageSource and the
+   * application.
+   */
+  class MITKUSNAVIGATION_EXPORT MultiStreamRecordingReader : public itk::Object
+  {
+  public:
+    mitkClassMacroItkParent(MultiStreamRecordingReader, itk::Object);
+    itkFactorylessNewMacro(Self);
+
+    /**
+     * \brief Opens the recording and reads its header and index.
+     * @throw mitk::Exception if the file cannot be opened or is no multi-stream recording.
+     */
+    void Open(const std::string& fileName);
+
+    void Close();
+
+    bool IsOpen() const;
+
+    /** \brief Returns true if the index was rebuilt because the recording did not contain it. */
+    bool IsIndexRecovered() const;
+
+    unsigned int GetNumberOfStreams() const;
+    std::string GetStreamName(unsigned int streamIndex) const;
+    mitk::MultiStreamRecorder::StreamType GetStreamType(unsigned int streamIndex) const;
+
+    /** \brief Returns the names of the tools of a navigation data stream. */
+    std::vector<std::string> GetToolNames(unsigned int streamIndex) const;
+
+    /** \brief Returns the index of the first stream with the given name or -1. */
+    int GetStreamIndex(const std::string& name) const;
+
+    unsigned int GetNumberOfSamples(unsigned int streamIndex) const;
+
+    /** \brief Returns the time stamp of a sample in ms on the clock of the recording. */
+    double GetTimeStamp(unsigned int streamIndex, unsigned int sampleIndex) const;
+
+    /**
+     * \brief Returns the index of the last sample recorded at or before the time stamp, the first sample
+     * if the time stamp is before all samples or -1 if the stream has no samples.
+     */
+    int FindSample(unsigned int streamIndex, double timeStamp) const;
+
+    /**
+     * \brief Reads one time step of a navigation data stream into the outputs, which are resized to the number of tools.
+     * The IGT time stamps of the navigation datas are the time stamp of the sample.
+     * @throw mitk::Exception if the stream is no navigation data stream, the index is invalid or reading fails.
+     */
+    void ReadNavigationData(unsigned int streamIndex, unsigned int sampleIndex, std::vector<mitk::NavigationData::Pointer>& outputs);
+
+    /**
+     * \brief Reads all time steps of a navigation data stream, e.g. for mitk::NavigationDataPlayer.
+     * @throw mitk::Exception if the stream is no navigation data stream or reading fails.
+     */
+    mitk::NavigationDataSet::Pointer ReadNavigationDataSet(unsigned int streamIndex);
+
+    /**
+     * \brief Reads one image of an image stream into a new image.
+     * @throw mitk::Exception if the stream is no image stream, the index is invalid or reading fails.
+     */
+    mitk::Image::Pointer ReadImage(unsigned int streamIndex, unsigned int sampleIndex);
+
+  protected:
+    MultiStreamRecordingReader();
+    ~MultiStreamRecordingReader() override;
+
+    struct StreamInfo
+    {
+      mitk::MultiStreamRecorder::StreamType Type;
+      std::string Name;
+      std::vector<std::string> ToolNames;
+      std::vector<double> TimeStamps;
+      std::vector<unsigned long long> Offsets;
+    };
+
+    const StreamInfo& GetStreamInfo(unsigned int streamIndex) const;
+    const StreamInfo& GetStreamInfo(unsigned int streamIndex, unsigned int sampleIndex, mitk::MultiStreamRecorder::StreamType type) const;
+
+    /** \brief Reads the header of the chunk at the offset and its data, the caller has to lock m_FileMutex */
+    void ReadChunk(unsigned long long offset, std::vector<char>& data);
+
+    void ReadHeader();
+    bool ReadIndex(unsigned long long fileSize);
+    void RecoverIndex(unsigned long long fileSize);
+    void AddIndexEntry(unsigned int streamIndex, double timeStamp, unsigned long long offset);
+
+    std::ifstream m_File;
+    std::mutex m_FileMutex;
+    std::vector<char> m_Buffer;
+
+    unsigned long long m_HeaderSize;
+    bool m_IndexRecovered;
+    std::vector<StreamInfo> m_Streams;
+  };
+} // namespace mitk
+
+#endif // __mitkMultiStreamRecordingReader_h
@@ -0,0 +1,204 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "mitkUSRecordingImageSource.h"
+
+#include <mitkExceptionMacro.h>
+#include <mitkIGTTimeStamp.h>
+
+mitk::USRecordingImageSource::USRecordingImageSource()
+  : m_StreamIndex(0),
+  m_StartTimeStamp(0.0), m_StartPlayingTime(0.0), m_PauseTime(0.0), m_TimeStampSinceStart(0.0),
+  m_Repeat(false), m_CurPlayerState(PlayerStopped), m_CurrentSampleIndex(-1)
+{
+  // to get a start time
+  mitk::IGTTimeStamp::GetInstance()->Start(this);
+}
+
+mitk::USRecordingImageSource::~USRecordingImageSource()
+{
+}
+
+void mitk::USRecordingImageSource::SetRecording(MultiStreamRecordingReader* reader, unsigned int streamIndex)
+{
+  if (reader != nullptr && reader->GetStreamType(streamIndex) != MultiStreamRecorder::ImageStream)
+  {
+    mitkThrow() << "Stream " << streamIndex << " is no image stream.";
+  }
+
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_Reader = reader;
+  m_StreamIndex = streamIndex;
+  m_StartTimeStamp = (reader != nullptr && reader->GetNumberOfSamples(streamIndex) > 0) ? reader->GetTimeStamp(streamIndex, 0) : 0.0;
+  m_CurPlayerState = PlayerStopped;
+  m_CurrentSampleIndex = -1;
+  m_CurrentImage = nullptr;
+}
+
+void mitk::USRecordingImageSource::SetStartTimeStamp(double timeStamp)
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_StartTimeStamp = timeStamp;
+}
+
+double mitk::USRecordingImageSource::GetStartTimeStamp() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_StartTimeStamp;
+}
+
+void mitk::USRecordingImageSource::SetRepeat(bool repeat)
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_Repeat = repeat;
+}
+
+bool mitk::USRecordingImageSource::GetRepeat() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_Repeat;
+}
+
+void mitk::USRecordingImageSource::StartPlaying()
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  if (m_Reader.IsNull())
+  {
+    MITK_ERROR << "Cannot play without recording." << std::endl;
+    return;
+  }
+  m_CurPlayerState = PlayerRunning;
+  m_PauseTime = 0;
+  m_TimeStampSinceStart = 0;
+  m_StartPlayingTime = mitk::IGTTimeStamp::GetInstance()->GetElapsed();
+}
+
+void mitk::USRecordingImageSource::StopPlaying()
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_CurPlayerState = PlayerStopped;
+}
+
+void mitk::USRecordingImageSource::Pause()
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  if (m_CurPlayerState == PlayerRunning)
+  {
+    m_CurPlayerState = PlayerPaused;
+    m_PauseTime = mitk::IGTTimeStamp::GetInstance()->GetElapsed();
+  }
+  else
+  {
+    MITK_ERROR << "Player is either not started or already is paused" << std::endl;
+  }
+}
+
+void mitk::USRecordingImageSource::Resume()
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  if (m_CurPlayerState == PlayerPaused)
+  {
+    m_CurPlayerState = PlayerRunning;
+    m_StartPlayingTime = mitk::IGTTimeStamp::GetInstance()->GetElapsed() - (m_PauseTime - m_StartPlayingTime);
+  }
+  else
+  {
+    MITK_ERROR << "Player is not paused!" << std::endl;
+  }
+}
+
+void mitk::USRecordingImageSource::Seek(double timeStampSinceStart)
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  if (m_CurPlayerState == PlayerStopped)
+  {
+    MITK_ERROR << "Player is not started!" << std::endl;
+    return;
+  }
+
+  m_TimeStampSinceStart = timeStampSinceStart;
+  if (m_CurPlayerState == PlayerPaused)
+    m_StartPlayingTime = m_PauseTime - timeStampSinceStart;
+  else
+    m_StartPlayingTime = mitk::IGTTimeStamp::GetInstance()->GetElapsed() - timeStampSinceStart;
+}
+
+mitk::USRecordingImageSource::PlayerState mitk::USRecordingImageSource::GetCurrentPlayerState() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_CurPlayerState;
+}
+
+double mitk::USRecordingImageSource::GetTimeStampSinceStart() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_TimeStampSinceStart;
+}
+
+int mitk::USRecordingImageSource::GetCurrentSampleIndex() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_CurrentSampleIndex;
+}
+
+void mitk::USRecordingImageSource::GetNextRawImage(std::vector<mitk::Image::Pointer>& image)
+{
+  if (image.size() != 1)
+    image.resize(1);
+
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  if (m_CurPlayerState == PlayerStopped || m_Reader.IsNull())
+  {
+    image[0] = nullptr;
+    return;
+  }
+
+  const unsigned int numberOfSamples = m_Reader->GetNumberOfSamples(m_StreamIndex);
+  if (numberOfSamples == 0)
+  {
+    image[0] = nullptr;
+    return;
+  }
+
+  if (m_CurPlayerState == PlayerRunning)
+    m_TimeStampSinceStart = mitk::IGTTimeStamp::GetInstance()->GetElapsed() - m_StartPlayingTime;
+
+  // the index is searched in memory, the image is only read if the position reached the next image
+  int sampleIndex = m_Reader->FindSample(m_StreamIndex, m_StartTimeStamp + m_TimeStampSinceStart);
+  if (sampleIndex != m_CurrentSampleIndex)
+  {
+    try
+    {
+      m_CurrentImage = m_Reader->ReadImage(m_StreamIndex, sampleIndex);
+      m_CurrentSampleIndex = sampleIndex;
+    }
+    catch (const mitk::Exception& e)
+    {
+      MITK_ERROR << "Cannot read image " << sampleIndex << " of the recording: " << e.GetDescription();
+    }
+  }
+  image[0] = m_CurrentImage;
+
+  // stop playing after the last image, start playing again if repeat is enabled
+  if (m_CurPlayerState == PlayerRunning && static_cast<unsigned int>(sampleIndex) + 1 == numberOfSamples)
+  {
+    if (m_Repeat)
+    {
+      m_TimeStampSinceStart = 0;
+      m_StartPlayingTime = mitk::IGTTimeStamp::GetInstance()->GetElapsed();
+    }
+    else
+    {
+      m_CurPlayerState = PlayerStopped;
+    }
+  }
+}
@@ -0,0 +1,111 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef MITKUSRECORDINGIMAGESOURCE_H_HEADER_INCLUDED_
+#define MITKUSRECORDINGIMAGESOURCE_H_HEADER_INCLUDED_
+
+#include "mitkMultiStreamRecordingReader.h"
+
+#include <MitkUSNavigationExports.h>
+#include <mitkUSImageSource.h>
+
+#include <mutex>
+
+namespace mitk {
+  /**
+  * \brief Image source that plays an image stream of a mitk::MultiStreamRecorder recording.
+  *
+  * The images are played in real time on the clock of mitk::IGTTimeStamp, like mitk::NavigationDataPlayer
+  * plays navigation data. GetNextRawImage() returns the last image recorded at or before the current
+  * position, which is found in the index of the recording, so only the images that are shown are read.
+  *
+  * The position is measured from a start time stamp of the recording, which is the time stamp of the first
+  * image by default. To play a navigation data stream of the same recording synchronously, set the start time
+  * stamp to the time stamp of the first navigation data, load the navigation data into a
+  * mitk::NavigationDataPlayer with mitk::MultiStreamRecordingReader::ReadNavigationDataSet() and call
+  * StartPlaying(), Pause(), Resume() and Seek() of both players together.
+  *
+  * \ingroup US
+  */
+  class MITKUSNAVIGATION_EXPORT USRecordingImageSource : public USImageSource
+  {
+  public:
+    mitkClassMacro(USRecordingImageSource, USImageSource);
+    itkFactorylessNewMacro(Self);
+    itkCloneMacro(Self);
+
+    enum PlayerState { PlayerStopped, PlayerRunning, PlayerPaused };
+
+    /**
+    * \brief Sets the recording and the index of its image stream. Stops playing.
+    * @throw mitk::Exception if the stream is no image stream.
+    */
+    void SetRecording(MultiStreamRecordingReader* reader, unsigned int streamIndex);
+
+    /**
+    * \brief Sets the time stamp of the recording that is played when playing starts.
+    * Is reset to the time stamp of the first image by SetRecording().
+    */
+    void SetStartTimeStamp(double timeStamp);
+    double GetStartTimeStamp() const;
+
+    /** \brief If repeat is on, the recording is played again after its last image. */
+    void SetRepeat(bool repeat);
+    bool GetRepeat() const;
+
+    void StartPlaying();
+    void StopPlaying();
+    void Pause();
+    void Resume();
+
+    /**
+    * \brief Continues playing at the given time in ms since the start time stamp.
+    * If the player is paused, it stays paused.
+    */
+    void Seek(double timeStampSinceStart);
+
+    PlayerState GetCurrentPlayerState() const;
+
+    /** \brief Returns the time in ms since the start time stamp that was played last. */
+    double GetTimeStampSinceStart() const;
+
+    /** \brief Returns the index of the image in the stream that was played last or -1. */
+    int GetCurrentSampleIndex() const;
+
+  protected:
+    USRecordingImageSource();
+    ~USRecordingImageSource() override;
+
+    /**
+    * \brief Returns the image at the current position. The same image object is returned until
+    * the position reaches the next image of the recording. No image is returned if the player is stopped.
+    */
+    void GetNextRawImage(std::vector<mitk::Image::Pointer>& image) override;
+
+    MultiStreamRecordingReader::Pointer m_Reader;
+    unsigned int m_StreamIndex;
+
+    double m_StartTimeStamp;
+    double m_StartPlayingTime;
+    double m_PauseTime;
+    double m_TimeStampSinceStart;
+    bool m_Repeat;
+    PlayerState m_CurPlayerState;
+
+    int m_CurrentSampleIndex;
+    mitk::Image::Pointer m_CurrentImage;
+
+    mutable std::mutex m_Mutex;
+  };
+} // namespace mitk
+
+#endif /* MITKUSRECORDINGIMAGESOURCE_H_HEADER_INCLUDED_ */